@@ -0,0 +1,93 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/core/io/atomic_file.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+
+#include "nui/core/basics/basics.h"
+
+namespace nui {
+
+namespace {
+
+bool WriteAll(int fd, const char* data, std::size_t size) {
+  // Large writes are split to stay below per-call limits.
+  constexpr std::size_t kMaxWrite = 1UL << 30;
+  while (size > 0) {
+    const ssize_t written = ::write(fd, data, std::min(size, kMaxWrite));
+    if (written <= 0) {
+      return false;
+    }
+    data += written;
+    size -= static_cast<std::size_t>(written);
+  }
+  return true;
+}
+
+}  // namespace
+
+bool WriteFileAtomically(
+    const std::string& path,
+    const std::vector<ByteChunk>& chunks) {
+  const std::string tmp_path =
+      fmt::format("{}.tmp.{}", path, static_cast<long>(::getpid()));
+  const int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+  bool ok = true;
+  for (const auto& chunk : chunks) {
+    ok = ok && WriteAll(fd, static_cast<const char*>(chunk.data), chunk.size);
+  }
+  ok = ok && (::fsync(fd) == 0);
+  ok = (::close(fd) == 0) && ok;
+  ok = ok && (std::rename(tmp_path.c_str(), path.c_str()) == 0);
+  if (!ok) {
+    std::remove(tmp_path.c_str());
+  }
+  return ok;
+}
+
+bool EnsureDirectory(const std::string& path) {
+  struct stat st;
+  if (::stat(path.c_str(), &st) == 0) {
+    return S_ISDIR(st.st_mode);
+  }
+  const auto slash = path.find_last_of('/');
+  if (slash != std::string::npos && slash > 0) {
+    EnsureDirectory(path.substr(0, slash));
+  }
+  return ::mkdir(path.c_str(), 0755) == 0 ||
+         (::stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode));
+}
+
+bool FileExists(const std::string& path) {
+  struct stat st;
+  return ::stat(path.c_str(), &st) == 0;
+}
+
+}  // namespace nui
@@ -0,0 +1,58 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_CORE_IO_ATOMIC_FILE_H_
+#define NUI_CORE_IO_ATOMIC_FILE_H_
+
+// IWYU pragma: private, include "nui/core/io/io.h"
+// IWYU pragma: friend "nui/core/io/.*\.h"
+
+#include "nui/core/basics/basics.h"
+
+namespace nui {
+
+// Contiguous chunk of bytes to be written.
+struct ByteChunk {
+  const void* data = nullptr;
+  std::size_t size = 0UL;
+};
+
+// Write chunks to path atomically.
+//
+// Data is written to a temporary file in the same directory, flushed to disk,
+// and renamed to path. Readers thus either see the old file or the complete
+// new one, never a partial write. Returns false on any I/O error.
+bool WriteFileAtomically(
+    const std::string& path,
+    const std::vector<ByteChunk>& chunks);
+
+// Create directory (and parents) if it does not exist.
+//
+// Returns true if directory exists afterwards.
+bool EnsureDirectory(const std::string& path);
+
+// Check if file exists.
+bool FileExists(const std::string& path);
+
+}  // namespace nui
+
+#endif  // NUI_CORE_IO_ATOMIC_FILE_H_
@@ -0,0 +1,157 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_CORE_IO_BINARY_STREAM_H_
+#define NUI_CORE_IO_BINARY_STREAM_H_
+
+// IWYU pragma: private, include "nui/core/io/io.h"
+// IWYU pragma: friend "nui/core/io/.*\.h"
+
+#include <cstring>
+#include <type_traits>
+
+#include "nui/core/basics/basics.h"
+
+namespace nui {
+
+// Append-only buffer of raw native-endian binary data.
+class BinaryWriter {
+ public:
+  // Append bytes.
+  void WriteBytes(const void* data, std::size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    buffer_.insert(buffer_.end(), bytes, bytes + size);
+  }
+
+  // Append trivially copyable value.
+  template <typename T>
+  void Write(const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    WriteBytes(&value, sizeof(T));
+  }
+
+  // Append string as size followed by characters.
+  void WriteString(std::string_view str) {
+    Write<std::uint64_t>(str.size());
+    WriteBytes(str.data(), str.size());
+  }
+
+  // Append vector of trivially copyable values as size followed by values.
+  template <typename T>
+  void WriteVector(const std::vector<T>& values) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    Write<std::uint64_t>(values.size());
+    WriteBytes(values.data(), values.size() * sizeof(T));
+  }
+
+  // Get buffer.
+  const std::vector<char>& Buffer() const { return buffer_; }
+
+  // Get size of buffer.
+  std::size_t Size() const { return buffer_.size(); }
+
+ private:
+  std::vector<char> buffer_;
+};
+
+// Bounds-checked reader of raw native-endian binary data.
+//
+// All reads return false (and leave the output unspecified) if not enough
+// data remains, so corrupt or truncated input never reads out of bounds.
+class BinaryReader {
+ public:
+  // Construct empty reader.
+  BinaryReader() {}
+
+  // Construct reader over size bytes of data (not owned).
+  BinaryReader(const char* data, std::size_t size)
+      : data_(data), size_(size) {}
+
+  // Read bytes.
+  bool ReadBytes(void* out, std::size_t size) {
+    if (size > Remaining()) {
+      return false;
+    }
+    if (size > 0) {
+      std::memcpy(out, data_ + pos_, size);
+      pos_ += size;
+    }
+    return true;
+  }
+
+  // Read trivially copyable value.
+  template <typename T>
+  bool Read(T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    return ReadBytes(&value, sizeof(T));
+  }
+
+  // Read string written by BinaryWriter::WriteString.
+  bool ReadString(std::string& str) {
+    std::uint64_t size = 0;
+    if (!Read(size) || size > Remaining()) {
+      return false;
+    }
+    str.assign(data_ + pos_, size);
+    pos_ += size;
+    return true;
+  }
+
+  // Read vector written by BinaryWriter::WriteVector.
+  template <typename T>
+  bool ReadVector(std::vector<T>& values) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    std::uint64_t size = 0;
+    if (!Read(size) || size > Remaining() / sizeof(T)) {
+      return false;
+    }
+    values.resize(size);
+    return ReadBytes(values.data(), size * sizeof(T));
+  }
+
+  // Get pointer to current position.
+  const char* Current() const { return data_ + pos_; }
+
+  // Skip bytes.
+  bool Skip(std::size_t size) {
+    if (size > Remaining()) {
+      return false;
+    }
+    pos_ += size;
+    return true;
+  }
+
+  // Get number of bytes not yet read.
+  std::size_t Remaining() const { return size_ - pos_; }
+
+  // Check if all bytes have been read.
+  bool AtEnd() const { return pos_ == size_; }
+
+ private:
+  const char* data_ = nullptr;
+  std::size_t size_ = 0UL;
+  std::size_t pos_ = 0UL;
+};
+
+}  // namespace nui
+
+#endif  // NUI_CORE_IO_BINARY_STREAM_H_
@@ -0,0 +1,89 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/core/io/checksum.h"
+
+#include <cstring>
+
+#include "nui/core/basics/basics.h"
+
+namespace nui {
+
+namespace {
+
+constexpr std::uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+constexpr std::uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+
+inline std::uint64_t Rotl(std::uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+inline std::uint64_t Mix(std::uint64_t h, std::uint64_t w) {
+  h ^= Rotl(w * kPrime2, 31) * kPrime1;
+  return Rotl(h, 27) * kPrime1 + kPrime2;
+}
+
+}  // namespace
+
+std::uint64_t Checksum64(
+    const void* data,
+    std::size_t size,
+    std::uint64_t seed) {
+  const char* bytes = static_cast<const char*>(data);
+  const std::size_t num_words = size / 8;
+
+  // Four independent lanes to hide multiply latency.
+  std::uint64_t lanes[4] = {
+      seed,
+      seed + kPrime1,
+      seed + kPrime2,
+      seed - kPrime1};
+  std::size_t i = 0;
+  for (; i + 4 <= num_words; i += 4) {
+    for (std::size_t lane = 0; lane < 4; lane += 1) {
+      std::uint64_t w = 0;
+      std::memcpy(&w, bytes + 8 * (i + lane), 8);
+      lanes[lane] = Mix(lanes[lane], w);
+    }
+  }
+  std::uint64_t h = Rotl(lanes[0], 1) + Rotl(lanes[1], 7) +
+                    Rotl(lanes[2], 12) + Rotl(lanes[3], 18);
+  for (; i < num_words; i += 1) {
+    std::uint64_t w = 0;
+    std::memcpy(&w, bytes + 8 * i, 8);
+    h = Mix(h, w);
+  }
+
+  if (size % 8 != 0) {
+    std::uint64_t tail = 0;
+    std::memcpy(&tail, bytes + 8 * num_words, size % 8);
+    h = Mix(h, tail);
+  }
+  h = Mix(h, static_cast<std::uint64_t>(size));
+
+  h ^= h >> 33;
+  h *= kPrime2;
+  h ^= h >> 29;
+  return h;
+}
+
+}  // namespace nui
@@ -0,0 +1,53 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_CORE_IO_CHECKSUM_H_
+#define NUI_CORE_IO_CHECKSUM_H_
+
+// IWYU pragma: private, include "nui/core/io/io.h"
+// IWYU pragma: friend "nui/core/io/.*\.h"
+
+#include "nui/core/basics/basics.h"
+
+namespace nui {
+
+// Default seed for checksums.
+constexpr std::uint64_t kChecksumSeed = 0xCBF29CE484222325ULL;
+
+// Get 64-bit checksum of bytes.
+//
+// Processes 8 bytes at a time with a multiply-xor-rotate mix, which is fast
+// enough to verify multi-GB files at memory bandwidth and detects truncation,
+// bit flips, and reordering of words. It is not cryptographic.
+std::uint64_t Checksum64(
+    const void* data,
+    std::size_t size,
+    std::uint64_t seed = kChecksumSeed);
+
+// Get 64-bit hash of string (used for cache keys).
+inline std::uint64_t Hash64(std::string_view str) {
+  return Checksum64(str.data(), str.size());
+}
+
+}  // namespace nui
+
+#endif  // NUI_CORE_IO_CHECKSUM_H_
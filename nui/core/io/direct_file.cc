@@ -0,0 +1,147 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/core/io/direct_file.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <new>
+
+#include "nui/core/basics/basics.h"
+
+namespace nui {
+
+namespace {
+
+bool WriteAllAt(int fd, const char* data, std::size_t size, off_t offset) {
+  while (size > 0) {
+    const ssize_t written = ::pwrite(fd, data, size, offset);
+    if (written <= 0) {
+      return false;
+    }
+    data += written;
+    size -= static_cast<std::size_t>(written);
+    offset += written;
+  }
+  return true;
+}
+
+}  // namespace
+
+DirectFileWriter::DirectFileWriter(std::size_t buffer_bytes)
+    : capacity_(
+          std::max(
+              (buffer_bytes + kDirectIOAlignment - 1) / kDirectIOAlignment,
+              std::size_t{1}) *
+          kDirectIOAlignment),
+      buffer_(static_cast<char*>(::operator new(
+          capacity_,
+          std::align_val_t(kDirectIOAlignment)))) {}
+
+DirectFileWriter::~DirectFileWriter() {
+  Abort();
+  ::operator delete(buffer_, std::align_val_t(kDirectIOAlignment));
+}
+
+bool DirectFileWriter::Open(const std::string& path, bool direct) {
+  Abort();
+  path_ = path;
+  tmp_path_ = fmt::format("{}.tmp.{}", path, static_cast<long>(::getpid()));
+  constexpr int kFlags = O_WRONLY | O_CREAT | O_TRUNC;
+  direct_ = false;
+#ifdef O_DIRECT
+  if (direct) {
+    fd_ = ::open(tmp_path_.c_str(), kFlags | O_DIRECT, 0644);
+    direct_ = fd_ >= 0;
+  }
+#endif
+  if (fd_ < 0) {
+    // Not all file systems (e.g., tmpfs) support O_DIRECT.
+    fd_ = ::open(tmp_path_.c_str(), kFlags, 0644);
+  }
+  fill_ = 0UL;
+  size_ = 0UL;
+  file_offset_ = 0UL;
+  ok_ = fd_ >= 0;
+  return ok_;
+}
+
+bool DirectFileWriter::Write(const void* data, std::size_t size) {
+  const char* bytes = static_cast<const char*>(data);
+  while (ok_ && size > 0) {
+    const std::size_t n = std::min(size, capacity_ - fill_);
+    std::memcpy(buffer_ + fill_, bytes, n);
+    fill_ += n;
+    size_ += n;
+    bytes += n;
+    size -= n;
+    if (fill_ == capacity_) {
+      ok_ = Flush(false);
+    }
+  }
+  return ok_;
+}
+
+bool DirectFileWriter::Flush(bool final) {
+  std::size_t bytes = fill_;
+  if (final && direct_) {
+    // O_DIRECT needs aligned sizes: pad, and truncate afterwards.
+    bytes = (fill_ + kDirectIOAlignment - 1) / kDirectIOAlignment *
+            kDirectIOAlignment;
+    std::memset(buffer_ + fill_, 0, bytes - fill_);
+  }
+  if (!WriteAllAt(fd_, buffer_, bytes, static_cast<off_t>(file_offset_))) {
+    return false;
+  }
+  file_offset_ += fill_;
+  fill_ = 0UL;
+  return true;
+}
+
+bool DirectFileWriter::Commit() {
+  if (fd_ < 0) {
+    return false;
+  }
+  bool ok = ok_ && Flush(true);
+  ok = ok && ::ftruncate(fd_, static_cast<off_t>(size_)) == 0;
+  ok = ok && ::fsync(fd_) == 0;
+  ok = (::close(fd_) == 0) && ok;
+  fd_ = -1;
+  ok = ok && std::rename(tmp_path_.c_str(), path_.c_str()) == 0;
+  if (!ok) {
+    std::remove(tmp_path_.c_str());
+  }
+  return ok;
+}
+
+void DirectFileWriter::Abort() {
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+    std::remove(tmp_path_.c_str());
+  }
+}
+
+}  // namespace nui
@@ -0,0 +1,95 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_CORE_IO_DIRECT_FILE_H_
+#define NUI_CORE_IO_DIRECT_FILE_H_
+
+// IWYU pragma: private, include "nui/core/io/io.h"
+// IWYU pragma: friend "nui/core/io/.*\.h"
+
+#include "nui/core/basics/basics.h"
+
+namespace nui {
+
+// Alignment of writes of DirectFileWriter (file offsets and buffer).
+constexpr std::size_t kDirectIOAlignment = 4096;
+
+// Sequential writer of large files with large aligned writes.
+//
+// Data is staged in an aligned buffer and written in full buffers, with
+// O_DIRECT (bypassing the page cache) where the file system supports it.
+// Like WriteFileAtomically(), data goes to a temporary file that is renamed
+// to path by Commit(), so readers never see a partial file.
+class DirectFileWriter {
+ public:
+  // Construct writer with staging buffer of buffer_bytes (rounded up to
+  // kDirectIOAlignment).
+  explicit DirectFileWriter(std::size_t buffer_bytes = 8UL << 20);
+
+  // Abort unfinished file.
+  ~DirectFileWriter();
+
+  DirectFileWriter(const DirectFileWriter&) = delete;
+  DirectFileWriter& operator=(const DirectFileWriter&) = delete;
+
+  // Start file at path. If direct, O_DIRECT is tried first.
+  //
+  // Returns false if the temporary file cannot be created.
+  bool Open(const std::string& path, bool direct = true);
+
+  // Append bytes. Returns false on error.
+  bool Write(const void* data, std::size_t size);
+
+  // Flush, sync, and rename to path. Returns false on error.
+  bool Commit();
+
+  // Remove unfinished file.
+  void Abort();
+
+  // Check if a file is open.
+  bool IsOpen() const { return fd_ >= 0; }
+
+  // Check if the open file bypasses the page cache.
+  bool IsDirect() const { return direct_; }
+
+  // Get bytes appended so far.
+  std::size_t Size() const { return size_; }
+
+ private:
+  // Write full staging buffer (or the padded tail if final).
+  bool Flush(bool final);
+
+  std::size_t capacity_ = 0UL;
+  char* buffer_ = nullptr;
+  std::size_t fill_ = 0UL;
+  std::size_t size_ = 0UL;
+  std::size_t file_offset_ = 0UL;
+  int fd_ = -1;
+  bool direct_ = false;
+  bool ok_ = true;
+  std::string path_;
+  std::string tmp_path_;
+};
+
+}  // namespace nui
+
+#endif  // NUI_CORE_IO_DIRECT_FILE_H_
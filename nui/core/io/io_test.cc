@@ -0,0 +1,242 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/core/io/io.h"
+
+#include <cstdio>
+
+#include "catch2/catch_test_macros.hpp"
+#include "nui/core/basics/basics.h"
+
+TEST_CASE("Checksum64, Test sensitivity.") {
+  std::vector<std::uint8_t> data(1000);
+  for (std::size_t i = 0; i < data.size(); i += 1) {
+    data[i] = static_cast<std::uint8_t>(i * 7);
+  }
+  const auto ref = nui::Checksum64(data.data(), data.size());
+  REQUIRE(ref == nui::Checksum64(data.data(), data.size()));
+  REQUIRE(ref != nui::Checksum64(data.data(), data.size() - 1));
+  REQUIRE(ref != nui::Checksum64(data.data(), data.size(), 1));
+
+  data[517] ^= 0x10;
+  REQUIRE(ref != nui::Checksum64(data.data(), data.size()));
+  data[517] ^= 0x10;
+
+  std::swap(data[0], data[8]);
+  REQUIRE(ref != nui::Checksum64(data.data(), data.size()));
+
+  REQUIRE(nui::Hash64("abc") != nui::Hash64("abd"));
+}
+
+TEST_CASE("BinaryReader, Test round trip.") {
+  nui::BinaryWriter writer;
+  writer.Write<int>(-5);
+  writer.Write<double>(2.5);
+  writer.WriteString("hello");
+  writer.WriteVector(std::vector<std::uint16_t>{1, 2, 3});
+
+  nui::BinaryReader reader(writer.Buffer().data(), writer.Size());
+  int i = 0;
+  double d = 0.0;
+  std::string str;
+  std::vector<std::uint16_t> vec;
+  REQUIRE(reader.Read(i));
+  REQUIRE(reader.Read(d));
+  REQUIRE(reader.ReadString(str));
+  REQUIRE(reader.ReadVector(vec));
+  REQUIRE(reader.AtEnd());
+  REQUIRE(i == -5);
+  REQUIRE(d == 2.5);
+  REQUIRE(str == "hello");
+  REQUIRE(vec == std::vector<std::uint16_t>{1, 2, 3});
+
+  REQUIRE_FALSE(reader.Read(i));
+}
+
+TEST_CASE("BinaryReader, Test truncated input.") {
+  nui::BinaryWriter writer;
+  writer.WriteVector(std::vector<double>(10, 1.0));
+
+  nui::BinaryReader reader(writer.Buffer().data(), writer.Size() - 1);
+  std::vector<double> vec;
+  REQUIRE_FALSE(reader.ReadVector(vec));
+}
+
+TEST_CASE("MappedFile, Test atomic write and map.") {
+  const nui::TempDirectory dir("nui_io_test");
+  const std::string path = dir.File("mapped");
+  const std::string a = "first chunk,";
+  const std::string b = "second chunk";
+  REQUIRE(nui::WriteFileAtomically(
+      path,
+      {{a.data(), a.size()}, {b.data(), b.size()}}));
+  REQUIRE(nui::FileExists(path));
+
+  nui::MappedFile file(path);
+  REQUIRE(file.IsValid());
+  REQUIRE(std::string(file.Data(), file.Size()) == a + b);
+  // Released pages are read again on access.
+  file.Release(a.size(), b.size());
+  REQUIRE(std::string(file.Data(), file.Size()) == a + b);
+
+  nui::MappedFile moved(std::move(file));
+  REQUIRE(moved.IsValid());
+  REQUIRE_FALSE(file.IsValid());
+
+  std::remove(path.c_str());
+  REQUIRE_FALSE(nui::MappedFile(path).IsValid());
+}
+
+TEST_CASE("DirectFileWriter, Test staged writes.") {
+  const nui::TempDirectory dir("nui_io_test");
+  const std::string path = dir.File("direct");
+  std::string expected;
+  for (std::size_t i = 0; i < 20000; i += 1) {
+    expected += static_cast<char>('a' + i % 23);
+  }
+  for (const bool direct : {true, false}) {
+    nui::DirectFileWriter writer(nui::kDirectIOAlignment);
+    REQUIRE(writer.Open(path, direct));
+    // Pieces smaller and larger than the staging buffer.
+    std::size_t pos = 0;
+    for (const std::size_t n : {100UL, 5000UL, 1UL, 12000UL}) {
+      REQUIRE(writer.Write(expected.data() + pos, n));
+      pos += n;
+    }
+    REQUIRE(writer.Write(expected.data() + pos, expected.size() - pos));
+    REQUIRE(writer.Size() == expected.size());
+    REQUIRE_FALSE(nui::FileExists(path));
+    REQUIRE(writer.Commit());
+
+    nui::MappedFile file(path);
+    REQUIRE(file.IsValid());
+    REQUIRE(std::string(file.Data(), file.Size()) == expected);
+    std::remove(path.c_str());
+  }
+
+  {
+    nui::DirectFileWriter writer;
+    REQUIRE(writer.Open(path));
+    REQUIRE(writer.Write(expected.data(), 10));
+  }
+  REQUIRE_FALSE(nui::FileExists(path));
+}
+
+TEST_CASE("EnsureDirectory, Test nested creation.") {
+  const nui::TempDirectory dir("nui_io_test");
+  const std::string nested = dir.File("nested/deeper");
+  REQUIRE(nui::EnsureDirectory(nested));
+  REQUIRE(nui::FileExists(nested));
+  REQUIRE(nui::EnsureDirectory(nested));
+}
+
+TEST_CASE("TempDirectory, Test removal of contents.") {
+  std::string path;
+  {
+    nui::TempDirectory dir("nui_io_test");
+    REQUIRE(dir.IsValid());
+    path = dir.Path();
+    REQUIRE(path.rfind(nui::TempDirectoryRoot() + "/nui_io_test_", 0) == 0);
+    REQUIRE(nui::EnsureDirectory(dir.File("a/b")));
+    const std::string text = "x";
+    REQUIRE(nui::WriteFileAtomically(dir.File("a/b/c"), {{text.data(), 1}}));
+    REQUIRE(nui::WriteFileAtomically(dir.File("d"), {{text.data(), 1}}));
+
+    // Directories are unique, and moves transfer ownership.
+    const nui::TempDirectory other("nui_io_test");
+    REQUIRE(other.Path() != path);
+    nui::TempDirectory moved(std::move(dir));
+    REQUIRE_FALSE(dir.IsValid());
+    REQUIRE(moved.Path() == path);
+    REQUIRE(nui::FileExists(moved.File("a/b/c")));
+  }
+  REQUIRE_FALSE(nui::FileExists(path));
+}
+
+TEST_CASE("SpillFile, Test positioned reads and writes.") {
+  const nui::TempDirectory dir("nui_io_test");
+  nui::SpillFile file(dir.Path());
+  REQUIRE(file.IsValid());
+  const std::vector<double> a = {1.0, 2.0, 3.0};
+  const std::vector<double> b = {4.0, 5.0};
+  REQUIRE(file.WriteAt(1UL << 20, a.data(), a.size() * sizeof(double)));
+  REQUIRE(file.WriteAt(0, b.data(), b.size() * sizeof(double)));
+
+  std::vector<double> out(3);
+  REQUIRE(file.ReadAt(1UL << 20, out.data(), out.size() * sizeof(double)));
+  REQUIRE(out == a);
+  REQUIRE(file.ReadAt(0, out.data(), 2 * sizeof(double)));
+  REQUIRE(out[1] == 5.0);
+  REQUIRE_FALSE(file.ReadAt(1UL << 21, out.data(), sizeof(double)));
+
+  REQUIRE_FALSE(nui::SpillFile("/nonexistent/dir").IsValid());
+}
+
+TEST_CASE("StreamNumbers, Test plain and gzip files.") {
+  const nui::TempDirectory dir("nui_io_test");
+  std::string text = "header line 1.0 x\n";
+  std::vector<double> expected;
+  for (std::size_t i = 0; i < 5000; i += 1) {
+    expected.push_back(std::ldexp(static_cast<double>(i) - 2500.0, -7));
+    text += fmt::format(
+        "{:.17g}{}",
+        expected.back(),
+        i % 10 == 9 ? "\n" : "   ");
+  }
+  const std::string plain = dir.File("numbers.txt");
+  const std::string gzip = dir.File("numbers.txt.gz");
+  REQUIRE(nui::WriteFileAtomically(plain, {{text.data(), text.size()}}));
+  REQUIRE(nui::WriteGzipFile(gzip, text, 6));
+
+  for (const auto& path : {plain, gzip}) {
+    // Tiny chunks split tokens and the header line across chunks.
+    for (const std::size_t chunk_bytes : {7UL, 1000UL, 1UL << 20}) {
+      nui::TextStreamOptions options;
+      options.chunk_bytes = chunk_bytes;
+      options.skip_lines = 1;
+      std::vector<double> values(expected.size() + 1, -1.0);
+      nui::TextStreamStats stats;
+      REQUIRE(nui::StreamNumbers(
+          path,
+          options,
+          [&](std::size_t first, const double* x, std::size_t n) {
+            std::copy(x, x + n, values.begin() + first);
+          },
+          &stats));
+      REQUIRE(stats.values == expected.size());
+      REQUIRE(stats.text_bytes == text.size());
+      values.pop_back();
+      REQUIRE(values == expected);
+    }
+  }
+}
+
+TEST_CASE("StreamNumbers, Test errors.") {
+  const nui::TempDirectory dir("nui_io_test");
+  const auto ignore = [](std::size_t, const double*, std::size_t) {};
+  REQUIRE_FALSE(nui::StreamNumbers(dir.File("missing"), {}, ignore));
+
+  const std::string path = dir.File("bad.txt");
+  const std::string text = "1.0 2.0 3.0x 4.0\n";
+  REQUIRE(nui::WriteFileAtomically(path, {{text.data(), text.size()}}));
+  REQUIRE_FALSE(nui::StreamNumbers(path, {}, ignore));
+}
@@ -0,0 +1,91 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_CORE_IO_MAPPED_FILE_H_
+#define NUI_CORE_IO_MAPPED_FILE_H_
+
+// IWYU pragma: private, include "nui/core/io/io.h"
+// IWYU pragma: friend "nui/core/io/.*\.h"
+
+#include "nui/core/basics/basics.h"
+
+namespace nui {
+
+// Read-only memory mapping of a whole file (POSIX mmap).
+//
+// The mapping is released on destruction. A file that cannot be opened or
+// mapped gives an invalid mapping (IsValid() == false) with Size() == 0.
+class MappedFile {
+ public:
+  // Construct invalid mapping.
+  MappedFile() {}
+
+  // Map file at path.
+  //
+  // If sequential, the kernel is advised to read ahead aggressively.
+  explicit MappedFile(const std::string& path, bool sequential = true);
+
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  MappedFile(MappedFile&& other) noexcept { swap(other); }
+  MappedFile& operator=(MappedFile&& other) noexcept {
+    MappedFile tmp(std::move(other));
+    swap(tmp);
+    return *this;
+  }
+
+  // Check if file was mapped successfully.
+  bool IsValid() const { return data_ != nullptr; }
+
+  // Get pointer to mapped bytes.
+  const char* Data() const { return static_cast<const char*>(data_); }
+
+  // Get size of mapped file.
+  std::size_t Size() const { return size_; }
+
+  // Drop the pages of bytes [offset, offset + size) from memory.
+  //
+  // The mapping stays valid, pages are read from the file again on the next
+  // access. Streaming readers use this to bound their resident memory.
+  void Release(std::size_t offset, std::size_t size) const;
+
+  // Swap with other mapping.
+  void swap(MappedFile& other) noexcept {
+    using std::swap;
+    swap(data_, other.data_);
+    swap(size_, other.size_);
+  }
+
+ private:
+  void* data_ = nullptr;
+  std::size_t size_ = 0UL;
+};
+
+// Swap two mappings.
+inline void swap(MappedFile& a, MappedFile& b) noexcept { a.swap(b); }
+
+}  // namespace nui
+
+#endif  // NUI_CORE_IO_MAPPED_FILE_H_
@@ -0,0 +1,80 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/core/io/spill_file.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdlib>
+
+#include "nui/core/basics/basics.h"
+
+namespace nui {
+
+SpillFile::SpillFile(const std::string& directory) {
+  std::string path = directory + "/nui_spill_XXXXXX";
+  fd_ = ::mkstemp(path.data());
+  if (fd_ >= 0) {
+    ::unlink(path.c_str());
+  }
+}
+
+SpillFile::~SpillFile() {
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+}
+
+bool SpillFile::WriteAt(
+    std::size_t offset,
+    const void* data,
+    std::size_t size) {
+  const char* bytes = static_cast<const char*>(data);
+  while (size > 0) {
+    const ssize_t written =
+        ::pwrite(fd_, bytes, size, static_cast<off_t>(offset));
+    if (written <= 0) {
+      return false;
+    }
+    bytes += written;
+    offset += static_cast<std::size_t>(written);
+    size -= static_cast<std::size_t>(written);
+  }
+  return true;
+}
+
+bool SpillFile::ReadAt(std::size_t offset, void* data, std::size_t size) const {
+  char* bytes = static_cast<char*>(data);
+  while (size > 0) {
+    const ssize_t read = ::pread(fd_, bytes, size, static_cast<off_t>(offset));
+    if (read <= 0) {
+      return false;
+    }
+    bytes += read;
+    offset += static_cast<std::size_t>(read);
+    size -= static_cast<std::size_t>(read);
+  }
+  return true;
+}
+
+}  // namespace nui
@@ -0,0 +1,83 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_CORE_IO_SPILL_FILE_H_
+#define NUI_CORE_IO_SPILL_FILE_H_
+
+// IWYU pragma: private, include "nui/core/io/io.h"
+// IWYU pragma: friend "nui/core/io/.*\.h"
+
+#include "nui/core/basics/basics.h"
+
+namespace nui {
+
+// Anonymous scratch file for data evicted from memory.
+//
+// The file is created in directory and unlinked right away, so it never
+// shows up in the directory and its space is released when the SpillFile is
+// destroyed (or the process dies). Data is accessed with positioned reads and
+// writes, and regions never written take no disk space (sparse file).
+class SpillFile {
+ public:
+  // Construct invalid spill file.
+  SpillFile() {}
+
+  // Create spill file in directory.
+  explicit SpillFile(const std::string& directory);
+
+  ~SpillFile();
+
+  SpillFile(const SpillFile&) = delete;
+  SpillFile& operator=(const SpillFile&) = delete;
+
+  SpillFile(SpillFile&& other) noexcept { swap(other); }
+  SpillFile& operator=(SpillFile&& other) noexcept {
+    SpillFile tmp(std::move(other));
+    swap(tmp);
+    return *this;
+  }
+
+  // Check if file was created successfully.
+  bool IsValid() const { return fd_ >= 0; }
+
+  // Write size bytes at offset. Returns false on error.
+  bool WriteAt(std::size_t offset, const void* data, std::size_t size);
+
+  // Read size bytes at offset. Returns false on error or short read.
+  bool ReadAt(std::size_t offset, void* data, std::size_t size) const;
+
+  // Swap with other spill file.
+  void swap(SpillFile& other) noexcept {
+    using std::swap;
+    swap(fd_, other.fd_);
+  }
+
+ private:
+  int fd_ = -1;
+};
+
+// Swap two spill files.
+inline void swap(SpillFile& a, SpillFile& b) noexcept { a.swap(b); }
+
+}  // namespace nui
+
+#endif  // NUI_CORE_IO_SPILL_FILE_H_
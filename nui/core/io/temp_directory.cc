@@ -0,0 +1,64 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/core/io/temp_directory.h"
+
+#include <ftw.h>
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "nui/core/basics/basics.h"
+
+namespace nui {
+
+namespace {
+
+int RemoveEntry(const char* path, const struct stat*, int, struct FTW*) {
+  return std::remove(path);
+}
+
+}  // namespace
+
+std::string TempDirectoryRoot() {
+  const char* root = std::getenv("TMPDIR");
+  return root != nullptr && root[0] != '\0' ? root : "/tmp";
+}
+
+TempDirectory::TempDirectory(
+    std::string_view prefix,
+    const std::string& parent) {
+  std::string path = parent + "/" + std::string(prefix) + "_XXXXXX";
+  if (::mkdtemp(path.data()) != nullptr) {
+    path_ = std::move(path);
+  }
+}
+
+TempDirectory::~TempDirectory() {
+  if (!path_.empty()) {
+    // Children are visited before their directory (FTW_DEPTH), and symbolic
+    // links are removed instead of followed (FTW_PHYS).
+    ::nftw(path_.c_str(), RemoveEntry, 16, FTW_DEPTH | FTW_PHYS);
+  }
+}
+
+}  // namespace nui
@@ -0,0 +1,89 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_CORE_IO_TEMP_DIRECTORY_H_
+#define NUI_CORE_IO_TEMP_DIRECTORY_H_
+
+// IWYU pragma: private, include "nui/core/io/io.h"
+// IWYU pragma: friend "nui/core/io/.*\.h"
+
+#include "nui/core/basics/basics.h"
+
+namespace nui {
+
+// Get directory for temporary files ($TMPDIR, or /tmp if it is not set).
+std::string TempDirectoryRoot();
+
+// Directory with a unique name for temporary files.
+//
+// The directory is created when the TempDirectory is constructed and removed
+// with everything in it when it is destroyed, so tests and benchmarks leave
+// nothing behind and concurrent processes never share files.
+class TempDirectory {
+ public:
+  // Construct invalid temporary directory.
+  TempDirectory() {}
+
+  // Create directory prefix_XXXXXX in parent.
+  explicit TempDirectory(
+      std::string_view prefix,
+      const std::string& parent = TempDirectoryRoot());
+
+  ~TempDirectory();
+
+  TempDirectory(const TempDirectory&) = delete;
+  TempDirectory& operator=(const TempDirectory&) = delete;
+
+  TempDirectory(TempDirectory&& other) noexcept { swap(other); }
+  TempDirectory& operator=(TempDirectory&& other) noexcept {
+    TempDirectory tmp(std::move(other));
+    swap(tmp);
+    return *this;
+  }
+
+  // Check if directory was created successfully.
+  bool IsValid() const { return !path_.empty(); }
+
+  // Get path of the directory.
+  const std::string& Path() const { return path_; }
+
+  // Get path of file name in the directory.
+  std::string File(std::string_view name) const {
+    return path_ + "/" + std::string(name);
+  }
+
+  // Swap with other temporary directory.
+  void swap(TempDirectory& other) noexcept {
+    using std::swap;
+    swap(path_, other.path_);
+  }
+
+ private:
+  std::string path_;
+};
+
+// Swap two temporary directories.
+inline void swap(TempDirectory& a, TempDirectory& b) noexcept { a.swap(b); }
+
+}  // namespace nui
+
+#endif  // NUI_CORE_IO_TEMP_DIRECTORY_H_
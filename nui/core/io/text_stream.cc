@@ -0,0 +1,325 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/core/io/text_stream.h"
+
+#include <omp.h>
+#include <sys/stat.h>
+#include <zlib.h>
+
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "nui/core/basics/basics.h"
+#include "nui/info/runtime/runtime.h"
+
+namespace nui {
+
+namespace {
+
+bool IsSpace(char c) {
+  return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\f' ||
+         c == '\v';
+}
+
+// Parse all numbers of text into values. Returns false on a bad token.
+bool ParseChunk(const std::vector<char>& text, std::vector<double>& values) {
+  values.clear();
+  const char* p = text.data();
+  const char* end = p + text.size();
+  while (true) {
+    while (p != end && IsSpace(*p)) {
+      p += 1;
+    }
+    if (p == end) {
+      return true;
+    }
+    if (*p == '+') {
+      p += 1;
+    }
+    double value = 0.0;
+    const auto result = std::from_chars(p, end, value);
+    if (result.ec != std::errc() ||
+        (result.ptr != end && !IsSpace(*result.ptr))) {
+      return false;
+    }
+    values.push_back(value);
+    p = result.ptr;
+  }
+}
+
+// Bounded queue of text chunks between the reader thread and the parsers.
+class ChunkQueue {
+ public:
+  explicit ChunkQueue(std::size_t capacity) : capacity_(capacity) {}
+
+  // Push chunk, waiting while the queue is full.
+  void Push(std::vector<char>&& chunk) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_full_.wait(lock, [this]() {
+      return chunks_.size() < capacity_ || cancelled_;
+    });
+    chunks_.push_back(std::move(chunk));
+    not_empty_.notify_one();
+  }
+
+  // Pop up to max_chunks, waiting for at least one unless the stream ended.
+  std::size_t Pop(std::size_t max_chunks, std::vector<std::vector<char>>& out) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_empty_.wait(lock, [this]() { return !chunks_.empty() || done_; });
+    std::size_t n = 0UL;
+    while (n < max_chunks && !chunks_.empty()) {
+      out[n].swap(chunks_.front());
+      chunks_.pop_front();
+      n += 1;
+    }
+    not_full_.notify_one();
+    return n;
+  }
+
+  // Get recycled buffer (or empty one).
+  std::vector<char> Recycled() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (free_.empty()) {
+      return {};
+    }
+    std::vector<char> buffer = std::move(free_.back());
+    free_.pop_back();
+    return buffer;
+  }
+
+  // Return buffer for reuse.
+  void Recycle(std::vector<char>&& buffer) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    buffer.clear();
+    free_.push_back(std::move(buffer));
+  }
+
+  // Mark end of stream (with or without read error).
+  void Finish(bool ok) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    done_ = true;
+    read_ok_ = ok;
+    not_empty_.notify_all();
+  }
+
+  // Stop reader after a parse error.
+  void Cancel() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    cancelled_ = true;
+    not_full_.notify_all();
+  }
+
+  bool IsCancelled() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return cancelled_;
+  }
+
+  bool ReadOk() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return read_ok_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable not_full_;
+  std::condition_variable not_empty_;
+  std::deque<std::vector<char>> chunks_;
+  std::vector<std::vector<char>> free_;
+  std::size_t capacity_ = 0UL;
+  bool done_ = false;
+  bool read_ok_ = true;
+  bool cancelled_ = false;
+};
+
+// Decompress file into chunks that end at whitespace.
+void ReadChunks(
+    gzFile file,
+    const TextStreamOptions& options,
+    ChunkQueue& queue,
+    std::size_t& text_bytes) {
+  const std::size_t chunk_bytes = std::max<std::size_t>(options.chunk_bytes, 1);
+  std::size_t lines_to_skip = options.skip_lines;
+  std::vector<char> carry;
+  bool ok = true;
+  while (!queue.IsCancelled()) {
+    std::vector<char> chunk = queue.Recycled();
+    chunk.swap(carry);
+    const std::size_t old_size = chunk.size();
+    chunk.resize(old_size + chunk_bytes);
+    const int read = gzread(
+        file,
+        chunk.data() + old_size,
+        static_cast<unsigned>(chunk_bytes));
+    if (read < 0) {
+      ok = false;
+      break;
+    }
+    chunk.resize(old_size + static_cast<std::size_t>(read));
+    text_bytes += static_cast<std::size_t>(read);
+    const bool eof = read == 0;
+
+    // Drop header lines.
+    std::size_t begin = 0UL;
+    while (lines_to_skip > 0 && begin < chunk.size()) {
+      const auto it = std::find(chunk.begin() + begin, chunk.end(), '\n');
+      if (it == chunk.end()) {
+        begin = chunk.size();
+        break;
+      }
+      begin = static_cast<std::size_t>(it - chunk.begin()) + 1;
+      lines_to_skip -= 1;
+    }
+    if (begin > 0) {
+      chunk.erase(chunk.begin(), chunk.begin() + begin);
+    }
+
+    // Keep trailing partial token for the next chunk.
+    if (!eof) {
+      std::size_t split = chunk.size();
+      while (split > 0 && !IsSpace(chunk[split - 1])) {
+        split -= 1;
+      }
+      carry.assign(chunk.begin() + split, chunk.end());
+      chunk.resize(split);
+    }
+    if (!chunk.empty()) {
+      queue.Push(std::move(chunk));
+    }
+    if (eof) {
+      break;
+    }
+  }
+  queue.Finish(ok);
+}
+
+}  // namespace
+
+bool StreamNumbers(
+    const std::string& path,
+    const TextStreamOptions& options,
+    const TextStreamScatter& scatter,
+    TextStreamStats* stats) {
+  const auto start = std::chrono::steady_clock::now();
+  TextStreamStats local_stats;
+  struct stat st;
+  if (::stat(path.c_str(), &st) == 0) {
+    local_stats.file_bytes = static_cast<std::size_t>(st.st_size);
+  }
+
+  gzFile file = gzopen(path.c_str(), "rb");
+  if (file == nullptr) {
+    if (stats != nullptr) {
+      *stats = local_stats;
+    }
+    return false;
+  }
+  gzbuffer(file, 1U << 18);
+
+  const std::size_t batch =
+      static_cast<std::size_t>(std::max(omp_get_max_threads(), 1));
+  const std::size_t read_ahead =
+      options.read_ahead > 0 ? options.read_ahead : 2 * batch;
+  ChunkQueue queue(read_ahead);
+  std::size_t text_bytes = 0UL;
+  std::thread reader(
+      [&]() { ReadChunks(file, options, queue, text_bytes); });
+
+  std::vector<std::vector<char>> chunks(batch);
+  std::vector<std::vector<double>> values(batch);
+  std::vector<std::size_t> firsts(batch + 1);
+  std::size_t position = 0UL;
+  bool parse_ok = true;
+  while (parse_ok) {
+    const std::size_t n = queue.Pop(batch, chunks);
+    if (n == 0) {
+      break;
+    }
+    const std::ptrdiff_t num_chunks = static_cast<std::ptrdiff_t>(n);
+#pragma omp parallel num_threads(NumParallelThreads())
+    {
+#pragma omp for schedule(dynamic) reduction(&& : parse_ok)
+      for (std::ptrdiff_t k = 0; k < num_chunks; k += 1) {
+        parse_ok = ParseChunk(chunks[k], values[k]) && parse_ok;
+        queue.Recycle(std::move(chunks[k]));
+      }
+#pragma omp single
+      {
+        firsts[0] = position;
+        for (std::size_t k = 0; k < n; k += 1) {
+          firsts[k + 1] = firsts[k] + values[k].size();
+        }
+      }
+      if (parse_ok) {
+#pragma omp for schedule(dynamic)
+        for (std::ptrdiff_t k = 0; k < num_chunks; k += 1) {
+          if (!values[k].empty()) {
+            scatter(firsts[k], values[k].data(), values[k].size());
+          }
+        }
+      }
+    }
+    position = firsts[n];
+  }
+  if (!parse_ok) {
+    queue.Cancel();
+    // Drain so that a reader blocked on a full queue can finish.
+    while (queue.Pop(batch, chunks) > 0) {
+    }
+  }
+  reader.join();
+  const bool read_ok = queue.ReadOk();
+  gzclose(file);
+
+  local_stats.text_bytes = text_bytes;
+  local_stats.values = position;
+  local_stats.seconds = std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+  if (stats != nullptr) {
+    *stats = local_stats;
+  }
+  return parse_ok && read_ok;
+}
+
+bool WriteGzipFile(const std::string& path, std::string_view text, int level) {
+  const std::string mode = fmt::format("wb{}", std::clamp(level, 1, 9));
+  gzFile file = gzopen(path.c_str(), mode.c_str());
+  if (file == nullptr) {
+    return false;
+  }
+  bool ok = true;
+  // gzwrite takes unsigned sizes, so write in pieces.
+  constexpr std::size_t kPiece = 1UL << 30;
+  for (std::size_t offset = 0; offset < text.size() && ok; offset += kPiece) {
+    const std::size_t size = std::min(kPiece, text.size() - offset);
+    ok = gzwrite(file, text.data() + offset, static_cast<unsigned>(size)) ==
+         static_cast<int>(size);
+  }
+  return gzclose(file) == Z_OK && ok;
+}
+
+}  // namespace nui
@@ -0,0 +1,85 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_CORE_IO_TEXT_STREAM_H_
+#define NUI_CORE_IO_TEXT_STREAM_H_
+
+// IWYU pragma: private, include "nui/core/io/io.h"
+// IWYU pragma: friend "nui/core/io/.*\.h"
+
+#include <functional>
+
+#include "nui/core/basics/basics.h"
+
+namespace nui {
+
+// Options for streaming numbers from text files.
+struct TextStreamOptions {
+  // Bytes of text per chunk.
+  std::size_t chunk_bytes = 4UL << 20;
+  // Maximum number of chunks read ahead (0 for twice the number of threads).
+  std::size_t read_ahead = 0UL;
+  // Number of header lines to skip.
+  std::size_t skip_lines = 0UL;
+};
+
+// Counters of a text stream.
+struct TextStreamStats {
+  // Bytes of the file on disk (compressed size for gzip files).
+  std::size_t file_bytes = 0UL;
+  // Bytes of (decompressed) text.
+  std::size_t text_bytes = 0UL;
+  // Numbers parsed.
+  std::size_t values = 0UL;
+  // Wall time in seconds.
+  double seconds = 0.0;
+};
+
+// Callback receiving values [first, first + count) of the stream.
+//
+// It is called concurrently from several threads with disjoint ranges, in
+// no particular order.
+using TextStreamScatter = std::function<
+    void(std::size_t first, const double* values, std::size_t count)>;
+
+// Stream whitespace-separated numbers from a plain or gzip-compressed text
+// file.
+//
+// The file is processed as a pipeline: a reader thread decompresses
+// chunks (split at whitespace) into a bounded queue, while the calling
+// thread's OpenMP team parses batches of chunks in parallel, assigns their
+// positions in the stream, and hands them to scatter in parallel.
+//
+// Returns false if the file cannot be read or holds a token that is not a
+// number. stats (if given) is filled in either case.
+bool StreamNumbers(
+    const std::string& path,
+    const TextStreamOptions& options,
+    const TextStreamScatter& scatter,
+    TextStreamStats* stats = nullptr);
+
+// Write text to a gzip-compressed file (level 1-9). Returns false on error.
+bool WriteGzipFile(const std::string& path, std::string_view text, int level);
+
+}  // namespace nui
+
+#endif  // NUI_CORE_IO_TEXT_STREAM_H_
@@ -0,0 +1,85 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_CORE_MEMORY_ALIGNED_H_
+#define NUI_CORE_MEMORY_ALIGNED_H_
+
+// IWYU pragma: private, include "nui/core/memory/memory.h"
+// IWYU pragma: friend "nui/core/memory/.*\.h"
+
+#include <new>
+
+#include "nui/core/basics/basics.h"
+
+namespace nui {
+
+// Alignment of all overaligned allocations (cache line, AVX-512 vector).
+constexpr std::size_t kDefaultAlignment = 64;
+
+// Round size up to multiple of alignment.
+constexpr std::size_t AlignUp(
+    std::size_t size,
+    std::size_t alignment = kDefaultAlignment) noexcept {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+// Allocate uninitialized bytes aligned to kDefaultAlignment.
+//
+// Returns nullptr for size == 0.
+void* AlignedAllocate(std::size_t size);
+
+// Free memory from AlignedAllocate.
+void AlignedFree(void* ptr) noexcept;
+
+// Standard allocator handing out memory aligned to kDefaultAlignment.
+template <typename T>
+class AlignedAllocator {
+ public:
+  using value_type = T;
+
+  AlignedAllocator() noexcept {}
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U>&) noexcept {}
+
+  T* allocate(std::size_t n) {
+    return static_cast<T*>(AlignedAllocate(n * sizeof(T)));
+  }
+  void deallocate(T* ptr, std::size_t) noexcept { AlignedFree(ptr); }
+};
+
+template <typename T, typename U>
+bool operator==(const AlignedAllocator<T>&, const AlignedAllocator<U>&) {
+  return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const AlignedAllocator<T>&, const AlignedAllocator<U>&) {
+  return false;
+}
+
+// Vector with storage aligned to kDefaultAlignment.
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+}  // namespace nui
+
+#endif  // NUI_CORE_MEMORY_ALIGNED_H_
@@ -0,0 +1,57 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/core/memory/aligned.h"
+
+#include "catch2/catch_test_macros.hpp"
+#include "nui/core/basics/basics.h"
+
+TEST_CASE("AlignedAllocate, Test alignment.") {
+  for (const std::size_t size : {1UL, 7UL, 64UL, 1000UL}) {
+    void* ptr = nui::AlignedAllocate(size);
+    REQUIRE(
+        reinterpret_cast<std::uintptr_t>(ptr) % nui::kDefaultAlignment == 0);
+    nui::AlignedFree(ptr);
+  }
+  REQUIRE(nui::AlignedAllocate(0) == nullptr);
+  nui::AlignedFree(nullptr);
+}
+
+TEST_CASE("AlignedVector, Test alignment.") {
+  nui::AlignedVector<double> vec(13, 1.0);
+  REQUIRE(
+      reinterpret_cast<std::uintptr_t>(vec.data()) % nui::kDefaultAlignment ==
+      0);
+  vec.resize(1000, 2.0);
+  REQUIRE(
+      reinterpret_cast<std::uintptr_t>(vec.data()) % nui::kDefaultAlignment ==
+      0);
+  REQUIRE(vec[12] == 1.0);
+  REQUIRE(vec[999] == 2.0);
+}
+
+TEST_CASE("AlignUp, Test rounding.") {
+  REQUIRE(nui::AlignUp(0) == 0);
+  REQUIRE(nui::AlignUp(1) == 64);
+  REQUIRE(nui::AlignUp(64) == 64);
+  REQUIRE(nui::AlignUp(65, 16) == 80);
+}
@@ -0,0 +1,142 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/info/profiling/hardware_counters.h"
+
+#if NUI_PERF_COUNTERS && defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#define NUI_PERF_COUNTERS_LINUX 1
+#else
+#define NUI_PERF_COUNTERS_LINUX 0
+#endif
+
+#include "nui/core/basics/basics.h"
+
+namespace nui {
+
+std::string_view ToString(HardwareCounter counter) {
+  switch (counter) {
+    case HardwareCounter::kCycles:
+      return "cycles";
+    case HardwareCounter::kInstructions:
+      return "instructions";
+    case HardwareCounter::kCacheMisses:
+      return "cache_misses";
+    case HardwareCounter::kFlops:
+      return "flops";
+  }
+  return "unknown";
+}
+
+#if NUI_PERF_COUNTERS_LINUX
+
+namespace {
+
+int OpenEvent(std::uint32_t type, std::uint64_t config, int group) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP;
+  // The leader starts disabled and enables the whole group at once.
+  attr.disabled = group == -1 ? 1 : 0;
+  const long fd = syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+  return static_cast<int>(fd);
+}
+
+}  // namespace
+
+HardwareCounters::HardwareCounters(HardwareCounterOptions options) {
+  const std::array<std::pair<std::uint32_t, std::uint64_t>, 4> events = {{
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+      {PERF_TYPE_RAW, options.flops_raw_event},
+  }};
+  for (std::size_t i = 0; i < kNumHardwareCounters; i += 1) {
+    if (events[i].first == PERF_TYPE_RAW && events[i].second == 0) {
+      continue;
+    }
+    const int fd = OpenEvent(events[i].first, events[i].second, leader_);
+    if (fd < 0) {
+      continue;
+    }
+    if (leader_ == -1) {
+      leader_ = fd;
+    }
+    fds_[i] = fd;
+    slots_[i] = num_open_;
+    num_open_ += 1;
+  }
+  if (leader_ != -1) {
+    ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+}
+
+HardwareCounters::~HardwareCounters() {
+  for (const int fd : fds_) {
+    if (fd != -1) {
+      close(fd);
+    }
+  }
+}
+
+HardwareCounterValues HardwareCounters::Read() const {
+  HardwareCounterValues values = {};
+  if (leader_ == -1) {
+    return values;
+  }
+  // Group read format: number of events followed by their values.
+  std::array<std::uint64_t, kNumHardwareCounters + 1> buffer = {};
+  const ssize_t bytes = read(leader_, buffer.data(), sizeof(buffer));
+  if (bytes < static_cast<ssize_t>(sizeof(std::uint64_t)) ||
+      buffer[0] != num_open_) {
+    return values;
+  }
+  for (std::size_t i = 0; i < kNumHardwareCounters; i += 1) {
+    if (slots_[i] != kNoSlot) {
+      values[i] = buffer[1 + slots_[i]];
+    }
+  }
+  return values;
+}
+
+#else
+
+HardwareCounters::HardwareCounters(HardwareCounterOptions) {}
+
+HardwareCounters::~HardwareCounters() {}
+
+HardwareCounterValues HardwareCounters::Read() const { return {}; }
+
+#endif
+
+}  // namespace nui
@@ -0,0 +1,107 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_INFO_PROFILING_HARDWARE_COUNTERS_H_
+#define NUI_INFO_PROFILING_HARDWARE_COUNTERS_H_
+
+// IWYU pragma: private, include "nui/info/profiling/profiling.h"
+// IWYU pragma: friend "nui/info/profiling/.*\.h"
+
+#include <array>
+
+#include "nui/core/basics/basics.h"
+
+// Hardware counters are compiled in unless NUI_PERF_COUNTERS is 0 (see the
+// CMake option NUI_ENABLE_PERF_COUNTERS). They need perf_event_open, so they
+// are only ever available on Linux.
+#ifndef NUI_PERF_COUNTERS
+#define NUI_PERF_COUNTERS 1
+#endif
+
+namespace nui {
+
+// Hardware events counted per thread.
+enum class HardwareCounter : std::uint8_t {
+  kCycles = 0,
+  kInstructions = 1,
+  kCacheMisses = 2,
+  kFlops = 3,
+};
+
+constexpr std::size_t kNumHardwareCounters = 4;
+
+// Short name of counter (e.g., "cycles").
+std::string_view ToString(HardwareCounter counter);
+
+// Counter values indexed by HardwareCounter.
+using HardwareCounterValues = std::array<std::uint64_t, kNumHardwareCounters>;
+
+struct HardwareCounterOptions {
+  // There is no generic perf event for floating-point operations. On CPUs
+  // that have one, pass its raw event code (PERF_TYPE_RAW config, e.g.,
+  // FP_ARITH_INST_RETIRED.* on recent Intel cores). 0 disables FLOPs.
+  std::uint64_t flops_raw_event = 0;
+};
+
+// Hardware counters of the calling thread.
+//
+// All available counters are opened as one perf event group on
+// construction, so they run for the same time and are read together with
+// one system call. Counters that cannot be opened (no kernel support,
+// perf_event_paranoid too strict, virtual machines without PMU, ...) are
+// skipped and read as 0. Only user-space events of the constructing thread
+// are counted, so objects must be used from the thread that created them.
+class HardwareCounters {
+ public:
+  explicit HardwareCounters(HardwareCounterOptions options = {});
+  ~HardwareCounters();
+
+  HardwareCounters(const HardwareCounters&) = delete;
+  HardwareCounters& operator=(const HardwareCounters&) = delete;
+  HardwareCounters(HardwareCounters&&) = delete;
+  HardwareCounters& operator=(HardwareCounters&&) = delete;
+
+  // Check if counter is counting.
+  bool Available(HardwareCounter counter) const {
+    return slots_[static_cast<std::size_t>(counter)] != kNoSlot;
+  }
+  // Check if any counter is counting.
+  bool AnyAvailable() const { return num_open_ > 0; }
+
+  // Current values since construction (0 for unavailable counters).
+  HardwareCounterValues Read() const;
+
+ private:
+  static constexpr std::size_t kNoSlot = SIZE_MAX;
+
+  // File descriptors of group leader and all opened events.
+  int leader_ = -1;
+  std::array<int, kNumHardwareCounters> fds_ = {-1, -1, -1, -1};
+  // Position of each counter in the group read.
+  std::array<std::size_t, kNumHardwareCounters> slots_ = {
+      kNoSlot, kNoSlot, kNoSlot, kNoSlot};
+  std::size_t num_open_ = 0;
+};
+
+}  // namespace nui
+
+#endif  // NUI_INFO_PROFILING_HARDWARE_COUNTERS_H_
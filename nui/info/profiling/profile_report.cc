@@ -0,0 +1,347 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/info/profiling/profile_report.h"
+
+#include "fmt/core.h"
+#include "nui/core/basics/basics.h"
+#include "nui/core/io/io.h"
+#include "nui/info/profiling/hardware_counters.h"
+#include "nui/info/profiling/profiler.h"
+
+namespace nui {
+
+namespace {
+
+constexpr std::size_t kNoNode = SIZE_MAX;
+
+// Node while aggregating, with times per thread.
+struct BuildNode {
+  std::string name;
+  std::size_t calls = 0;
+  std::vector<std::int64_t> thread_ns;
+  std::vector<std::size_t> thread_calls;
+  HardwareCounterValues counters = {};
+  std::vector<std::size_t> children;
+};
+
+std::size_t FindOrAddChild(
+    std::size_t parent,
+    const char* name,
+    std::size_t num_threads,
+    std::vector<BuildNode>& nodes) {
+  const std::string_view key = name != nullptr ? name : "?";
+  for (const std::size_t child : nodes[parent].children) {
+    if (nodes[child].name == key) {
+      return child;
+    }
+  }
+  BuildNode node;
+  node.name = std::string(key);
+  node.thread_ns.assign(num_threads, 0);
+  node.thread_calls.assign(num_threads, 0);
+  nodes.push_back(std::move(node));
+  nodes[parent].children.push_back(nodes.size() - 1);
+  return nodes.size() - 1;
+}
+
+ProfileNode Finalize(std::size_t index, const std::vector<BuildNode>& nodes) {
+  const BuildNode& build = nodes[index];
+  ProfileNode node;
+  node.name = build.name;
+  node.calls = build.calls;
+  node.counters = build.counters;
+  std::int64_t max_ns = 0;
+  std::int64_t total_ns = 0;
+  for (std::size_t t = 0; t < build.thread_ns.size(); t += 1) {
+    if (build.thread_calls[t] == 0) {
+      continue;
+    }
+    node.threads += 1;
+    total_ns += build.thread_ns[t];
+    max_ns = std::max(max_ns, build.thread_ns[t]);
+  }
+  node.inclusive = static_cast<double>(total_ns) * 1e-9;
+  node.max_thread_inclusive = static_cast<double>(max_ns) * 1e-9;
+  if (total_ns > 0) {
+    node.imbalance = static_cast<double>(max_ns) * node.threads /
+                         static_cast<double>(total_ns) -
+                     1.0;
+  }
+  double children = 0.0;
+  for (const std::size_t child : build.children) {
+    node.children.push_back(Finalize(child, nodes));
+    children += node.children.back().inclusive;
+  }
+  node.exclusive = std::max(0.0, node.inclusive - children);
+  std::stable_sort(
+      node.children.begin(),
+      node.children.end(),
+      [](const ProfileNode& a, const ProfileNode& b) {
+        return a.inclusive > b.inclusive;
+      });
+  return node;
+}
+
+std::string Escape(std::string_view s) {
+  std::string result;
+  result.reserve(s.size());
+  for (const char c : s) {
+    switch (c) {
+      case '"':
+        result += "\\\"";
+        break;
+      case '\\':
+        result += "\\\\";
+        break;
+      case '\n':
+        result += "\\n";
+        break;
+      case '\t':
+        result += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          result += fmt::format("\\u{:04x}", static_cast<int>(c));
+        } else {
+          result += c;
+        }
+    }
+  }
+  return result;
+}
+
+// Counters that counted anything as JSON object members.
+std::string CounterMembers(const HardwareCounterValues& counters) {
+  std::string result;
+  for (std::size_t i = 0; i < kNumHardwareCounters; i += 1) {
+    if (counters[i] == 0) {
+      continue;
+    }
+    result += fmt::format(
+        "{}\"{}\": {}",
+        result.empty() ? "" : ", ",
+        ToString(static_cast<HardwareCounter>(i)),
+        counters[i]);
+  }
+  return result;
+}
+
+void AppendText(
+    const ProfileNode& node,
+    std::size_t depth,
+    double total,
+    const std::vector<std::size_t>& counters,
+    std::string& out) {
+  const std::string name = std::string(2 * depth, ' ') + node.name;
+  out += fmt::format(
+      "{:<40} {:>10} {:>12.6f} {:>12.6f} {:>6.1f}% {:>7} {:>7.3f}",
+      name,
+      node.calls,
+      node.inclusive,
+      node.exclusive,
+      total > 0.0 ? 100.0 * node.inclusive / total : 0.0,
+      node.threads,
+      node.imbalance);
+  for (const std::size_t i : counters) {
+    out += fmt::format(" {:>14}", node.counters[i]);
+  }
+  out += '\n';
+  for (const ProfileNode& child : node.children) {
+    AppendText(child, depth + 1, total, counters, out);
+  }
+}
+
+void AppendJson(const ProfileNode& node, std::size_t depth, std::string& out) {
+  const std::string indent(2 * depth, ' ');
+  out += fmt::format(
+      "{}{{\"name\": \"{}\", \"calls\": {}, \"inclusive\": {}, "
+      "\"exclusive\": {}, \"threads\": {}, \"max_thread_inclusive\": {}, "
+      "\"imbalance\": {}, \"counters\": {{{}}}, \"children\": [",
+      indent,
+      Escape(node.name),
+      node.calls,
+      node.inclusive,
+      node.exclusive,
+      node.threads,
+      node.max_thread_inclusive,
+      node.imbalance,
+      CounterMembers(node.counters));
+  for (std::size_t i = 0; i < node.children.size(); i += 1) {
+    out += i == 0 ? "\n" : ",\n";
+    AppendJson(node.children[i], depth + 1, out);
+  }
+  if (!node.children.empty()) {
+    out += "\n" + indent;
+  }
+  out += "]}";
+}
+
+bool WriteString(const std::string& path, const std::string& content) {
+  return WriteFileAtomically(path, {{content.data(), content.size()}});
+}
+
+}  // namespace
+
+ProfileReport::ProfileReport(const std::vector<ThreadProfile>& profiles) {
+  const std::size_t num_threads = profiles.size();
+  std::vector<BuildNode> nodes(1);
+  nodes[0].name = "total";
+  nodes[0].thread_ns.assign(num_threads, 0);
+  nodes[0].thread_calls.assign(num_threads, 0);
+  std::vector<std::size_t> node_of;
+  for (std::size_t t = 0; t < num_threads; t += 1) {
+    const std::vector<ProfileEvent>& events = profiles[t].events;
+    node_of.assign(events.size(), kNoNode);
+    for (std::size_t i = 0; i < events.size(); i += 1) {
+      const ProfileEvent& event = events[i];
+      std::size_t parent = 0;
+      if (event.parent != kNoParentEvent && event.parent < i) {
+        parent = node_of[event.parent];
+      }
+      const std::size_t node =
+          FindOrAddChild(parent, event.name, num_threads, nodes);
+      node_of[i] = node;
+      if (event.end_ns < event.start_ns) {
+        continue;
+      }
+      const std::int64_t ns = event.end_ns - event.start_ns;
+      BuildNode& build = nodes[node];
+      build.calls += 1;
+      build.thread_ns[t] += ns;
+      build.thread_calls[t] += 1;
+      for (std::size_t c = 0; c < kNumHardwareCounters; c += 1) {
+        build.counters[c] += event.counters[c];
+      }
+      if (parent == 0) {
+        nodes[0].thread_ns[t] += ns;
+        nodes[0].thread_calls[t] += 1;
+        for (std::size_t c = 0; c < kNumHardwareCounters; c += 1) {
+          nodes[0].counters[c] += event.counters[c];
+        }
+      }
+    }
+  }
+  root_ = Finalize(0, nodes);
+  root_.calls = 0;
+}
+
+const ProfileNode* ProfileReport::Find(std::string_view path) const {
+  const ProfileNode* node = &root_;
+  while (!path.empty()) {
+    const std::size_t slash = path.find('/');
+    const std::string_view name = path.substr(0, slash);
+    const ProfileNode* next = nullptr;
+    for (const ProfileNode& child : node->children) {
+      if (child.name == name) {
+        next = &child;
+        break;
+      }
+    }
+    if (next == nullptr) {
+      return nullptr;
+    }
+    node = next;
+    path = slash == std::string_view::npos ? std::string_view()
+                                           : path.substr(slash + 1);
+  }
+  return node;
+}
+
+std::string ProfileReport::ToText() const {
+  std::vector<std::size_t> counters;
+  for (std::size_t i = 0; i < kNumHardwareCounters; i += 1) {
+    if (root_.counters[i] > 0) {
+      counters.push_back(i);
+    }
+  }
+  std::string out = fmt::format(
+      "{:<40} {:>10} {:>12} {:>12} {:>7} {:>7} {:>7}",
+      "region",
+      "calls",
+      "incl [s]",
+      "excl [s]",
+      "incl",
+      "threads",
+      "imbal");
+  for (const std::size_t i : counters) {
+    out += fmt::format(" {:>14}", ToString(static_cast<HardwareCounter>(i)));
+  }
+  out += '\n';
+  AppendText(root_, 0, root_.inclusive, counters, out);
+  return out;
+}
+
+std::string ProfileReport::ToJson() const {
+  std::string out;
+  AppendJson(root_, 0, out);
+  out += '\n';
+  return out;
+}
+
+std::string ToChromeTrace(const std::vector<ThreadProfile>& profiles) {
+  std::string out = "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+  bool first = true;
+  const auto separator = [&first]() {
+    const char* s = first ? "\n" : ",\n";
+    first = false;
+    return s;
+  };
+  for (const ThreadProfile& profile : profiles) {
+    out += fmt::format(
+        "{}{{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, "
+        "\"tid\": {}, \"args\": {{\"name\": \"thread {}\"}}}}",
+        separator(),
+        profile.thread,
+        profile.thread);
+    for (const ProfileEvent& event : profile.events) {
+      if (event.end_ns < event.start_ns) {
+        continue;
+      }
+      // Timestamps and durations are in microseconds.
+      out += fmt::format(
+          "{}{{\"name\": \"{}\", \"cat\": \"nui\", \"ph\": \"X\", "
+          "\"pid\": 0, \"tid\": {}, \"ts\": {:.3f}, \"dur\": {:.3f}, "
+          "\"args\": {{{}}}}}",
+          separator(),
+          Escape(event.name != nullptr ? event.name : "?"),
+          profile.thread,
+          static_cast<double>(event.start_ns) * 1e-3,
+          static_cast<double>(event.end_ns - event.start_ns) * 1e-3,
+          CounterMembers(event.counters));
+    }
+  }
+  out += "\n]}\n";
+  return out;
+}
+
+bool WriteProfile(
+    const std::string& prefix,
+    const std::vector<ThreadProfile>& profiles) {
+  const ProfileReport report(profiles);
+  bool ok = WriteString(prefix + ".txt", report.ToText());
+  ok = WriteString(prefix + ".json", report.ToJson()) && ok;
+  ok = WriteString(prefix + ".trace.json", ToChromeTrace(profiles)) && ok;
+  return ok;
+}
+
+}  // namespace nui
@@ -0,0 +1,99 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_INFO_PROFILING_PROFILE_REPORT_H_
+#define NUI_INFO_PROFILING_PROFILE_REPORT_H_
+
+// IWYU pragma: private, include "nui/info/profiling/profiling.h"
+// IWYU pragma: friend "nui/info/profiling/.*\.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/info/profiling/hardware_counters.h"
+#include "nui/info/profiling/profiler.h"
+
+namespace nui {
+
+// Region aggregated over all calls on all threads.
+//
+// Nodes are identified by the path of region names from the root, so the
+// same region entered from different parents shows up once per parent.
+struct ProfileNode {
+  std::string name;
+  std::size_t calls = 0;
+  // Time summed over calls and threads in seconds. Exclusive time is
+  // inclusive time minus the inclusive time of the children.
+  double inclusive = 0.0;
+  double exclusive = 0.0;
+  // Threads that entered the region, the largest inclusive time of one of
+  // them, and the imbalance max / mean - 1 over those threads.
+  std::size_t threads = 0;
+  double max_thread_inclusive = 0.0;
+  double imbalance = 0.0;
+  // Inclusive hardware counter increments summed over calls and threads.
+  HardwareCounterValues counters = {};
+  std::vector<ProfileNode> children;
+};
+
+// Tree report of recorded profiling events.
+//
+// The root is an artificial node "total" holding all top-level regions.
+// Children are sorted by decreasing inclusive time. Events that were still
+// open when the profile was taken are skipped.
+class ProfileReport {
+ public:
+  explicit ProfileReport(const std::vector<ThreadProfile>& profiles);
+
+  // Report of everything the global profiler recorded so far.
+  static ProfileReport Collect() {
+    return ProfileReport(Profiler::Global().Snapshot());
+  }
+
+  const ProfileNode& Root() const { return root_; }
+
+  // Find node by path of names below the root separated by '/' (e.g.,
+  // "flow/step/BCH"). Returns nullptr if there is no such node.
+  const ProfileNode* Find(std::string_view path) const;
+
+  // Indented table with one line per node.
+  std::string ToText() const;
+  // Tree as nested JSON objects.
+  std::string ToJson() const;
+
+ private:
+  ProfileNode root_;
+};
+
+// Events as Chrome trace ("Trace Event Format", complete events per thread)
+// to be viewed with chrome://tracing or https://ui.perfetto.dev.
+std::string ToChromeTrace(const std::vector<ThreadProfile>& profiles);
+
+// Write text report, JSON report, and Chrome trace of profiles to
+// prefix.txt, prefix.json, and prefix.trace.json.
+//
+// Files are written atomically. Returns false on any I/O error.
+bool WriteProfile(
+    const std::string& prefix,
+    const std::vector<ThreadProfile>& profiles);
+
+}  // namespace nui
+
+#endif  // NUI_INFO_PROFILING_PROFILE_REPORT_H_
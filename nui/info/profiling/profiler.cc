@@ -0,0 +1,183 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/info/profiling/profiler.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+#include "nui/core/basics/basics.h"
+#include "nui/info/profiling/hardware_counters.h"
+
+namespace nui {
+
+// Events of one thread in chunks that are never moved.
+struct Profiler::ThreadBuffer {
+  static constexpr std::size_t kChunkSize = 4096;
+
+  explicit ThreadBuffer(std::size_t thread_) : thread(thread_) {}
+
+  ProfileEvent& operator[](std::size_t i) {
+    return chunks[i / kChunkSize][i % kChunkSize];
+  }
+  const ProfileEvent& operator[](std::size_t i) const {
+    return chunks[i / kChunkSize][i % kChunkSize];
+  }
+
+  std::uint32_t Append() {
+    if (size == chunks.size() * kChunkSize) {
+      chunks.push_back(std::make_unique<ProfileEvent[]>(kChunkSize));
+    }
+    size += 1;
+    return static_cast<std::uint32_t>(size - 1);
+  }
+
+  void Clear() {
+    size = 0;
+    open.clear();
+  }
+
+  std::size_t thread = 0;
+  std::vector<std::unique_ptr<ProfileEvent[]>> chunks;
+  std::size_t size = 0;
+  // Open events, innermost last.
+  std::vector<std::uint32_t> open;
+  // Opened on first region with counters enabled.
+  std::unique_ptr<HardwareCounters> counters;
+};
+
+Profiler& Profiler::Global() {
+  static Profiler profiler;
+  return profiler;
+}
+
+Profiler::Profiler() : epoch_(std::chrono::steady_clock::now()) {}
+
+Profiler::~Profiler() {}
+
+void Profiler::Enable(const ProfileOptions& options) {
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    counter_options_ = options.counter_options;
+  }
+  counters_.store(options.hardware_counters, std::memory_order_relaxed);
+  enabled_.store(true, std::memory_order_release);
+}
+
+void Profiler::Disable() {
+  enabled_.store(false, std::memory_order_release);
+}
+
+void Profiler::Reset() {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& buffer : buffers_) {
+    buffer->Clear();
+  }
+}
+
+std::vector<ThreadProfile> Profiler::Snapshot() const {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<ThreadProfile> profiles;
+  for (const auto& buffer : buffers_) {
+    if (buffer->size == 0) {
+      continue;
+    }
+    ThreadProfile profile;
+    profile.thread = buffer->thread;
+    profile.events.reserve(buffer->size);
+    for (std::size_t i = 0; i < buffer->size; i += 1) {
+      profile.events.push_back((*buffer)[i]);
+    }
+    profiles.push_back(std::move(profile));
+  }
+  return profiles;
+}
+
+std::uint32_t Profiler::Enter(const char* name) {
+  ThreadBuffer& buffer = LocalBuffer();
+  const std::uint32_t index = buffer.Append();
+  ProfileEvent& event = buffer[index];
+  event.name = name;
+  event.parent = buffer.open.empty() ? kNoParentEvent : buffer.open.back();
+  event.depth = static_cast<std::uint32_t>(buffer.open.size());
+  event.end_ns = -1;
+  event.counters = {};
+  buffer.open.push_back(index);
+  if (counters_.load(std::memory_order_relaxed)) {
+    if (buffer.counters == nullptr) {
+      HardwareCounterOptions options;
+      {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        options = counter_options_;
+      }
+      buffer.counters = std::make_unique<HardwareCounters>(options);
+    }
+    // Start values are kept in the event until exit.
+    event.counters = buffer.counters->Read();
+  }
+  // Read the clock last so setup is not attributed to the region.
+  event.start_ns = Now();
+  return index;
+}
+
+void Profiler::Exit(std::uint32_t index) {
+  const std::int64_t now = Now();
+  ThreadBuffer& buffer = LocalBuffer();
+  // Events dropped by Reset while open are ignored.
+  if (buffer.open.empty() || buffer.open.back() != index) {
+    return;
+  }
+  buffer.open.pop_back();
+  ProfileEvent& event = buffer[index];
+  event.end_ns = now;
+  if (buffer.counters != nullptr && buffer.counters->AnyAvailable()) {
+    const HardwareCounterValues values = buffer.counters->Read();
+    for (std::size_t i = 0; i < kNumHardwareCounters; i += 1) {
+      event.counters[i] = values[i] >= event.counters[i]
+                              ? values[i] - event.counters[i]
+                              : 0;
+    }
+  } else {
+    event.counters = {};
+  }
+}
+
+Profiler::ThreadBuffer& Profiler::LocalBuffer() {
+  // Buffers are owned by the profiler, which lives until the end of the
+  // process, so the pointer never dangles.
+  thread_local ThreadBuffer* buffer = nullptr;
+  if (buffer == nullptr) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    buffers_.push_back(std::make_unique<ThreadBuffer>(buffers_.size()));
+    buffer = buffers_.back().get();
+  }
+  return *buffer;
+}
+
+std::int64_t Profiler::Now() const {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - epoch_)
+      .count();
+}
+
+}  // namespace nui
@@ -0,0 +1,183 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_INFO_PROFILING_PROFILER_H_
+#define NUI_INFO_PROFILING_PROFILER_H_
+
+// IWYU pragma: private, include "nui/info/profiling/profiling.h"
+// IWYU pragma: friend "nui/info/profiling/.*\.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+#include "nui/core/basics/basics.h"
+#include "nui/info/profiling/hardware_counters.h"
+
+// Profiling regions are compiled in unless NUI_PROFILING is 0 (see the
+// CMake option NUI_ENABLE_PROFILING). Compiled-in regions have near-zero
+// cost when runtime-disabled (see Profiler). Without them,
+// NUI_PROFILE_REGION and NUI_PROFILE_FUNCTION expand to no-ops.
+#ifndef NUI_PROFILING
+#define NUI_PROFILING 1
+#endif
+
+namespace nui {
+
+struct ProfileOptions {
+  // Record hardware counters of each region (see HardwareCounters). This
+  // costs a system call on entry and exit of every region.
+  bool hardware_counters = false;
+  HardwareCounterOptions counter_options;
+};
+
+// Parent of top-level events.
+constexpr std::uint32_t kNoParentEvent = UINT32_MAX;
+
+// One pass through a region on one thread.
+struct ProfileEvent {
+  // Name of the region (must outlive the profile, e.g., string literals).
+  const char* name = nullptr;
+  // Index of the enclosing event of the same thread or kNoParentEvent.
+  std::uint32_t parent = kNoParentEvent;
+  // Nesting depth (0 for top-level events).
+  std::uint32_t depth = 0;
+  // Entry and exit in nanoseconds since the profiler was created. Events
+  // that are still open have end_ns < start_ns.
+  std::int64_t start_ns = 0;
+  std::int64_t end_ns = -1;
+  // Hardware counter increments between entry and exit.
+  HardwareCounterValues counters = {};
+};
+
+// Events of one thread in order of entry, so parents precede children.
+struct ThreadProfile {
+  std::size_t thread = 0;
+  std::vector<ProfileEvent> events;
+};
+
+// Process-wide recorder of profiling regions.
+//
+// Every thread records into its own buffer, which is registered with the
+// profiler (under a mutex) the first time the thread enters a region.
+// After that, entering and leaving regions takes no locks and touches no
+// shared cache lines; events are appended to chunks that are never
+// reallocated. Buffers outlive their threads, so events of finished worker
+// threads stay available.
+//
+// Recording is off by default. When disabled, a region costs one relaxed
+// atomic load.
+//
+// Reset and Snapshot read the buffers of all threads. They must only be
+// called while no other thread is recording (e.g., after joining workers or
+// outside of OpenMP parallel regions).
+class Profiler {
+ public:
+  // The profiler of this process.
+  static Profiler& Global();
+
+  Profiler(const Profiler&) = delete;
+  Profiler& operator=(const Profiler&) = delete;
+
+  // Start recording regions entered from now on.
+  void Enable(const ProfileOptions& options = {});
+  // Stop recording. Open regions are still closed properly.
+  void Disable();
+  bool IsEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  // Drop all recorded events.
+  void Reset();
+
+  // Copy of the recorded events of all threads that recorded any.
+  std::vector<ThreadProfile> Snapshot() const;
+
+  // Open region name on the calling thread. Returns event to close.
+  std::uint32_t Enter(const char* name);
+  // Close event of the calling thread (must be the innermost open one).
+  void Exit(std::uint32_t event);
+
+ private:
+  struct ThreadBuffer;
+
+  Profiler();
+  ~Profiler();
+
+  // Buffer of the calling thread (registered on first use).
+  ThreadBuffer& LocalBuffer();
+  std::int64_t Now() const;
+
+  std::atomic<bool> enabled_{false};
+  std::atomic<bool> counters_{false};
+  HardwareCounterOptions counter_options_;
+  std::chrono::steady_clock::time_point epoch_;
+
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+};
+
+// Profiling region from construction to destruction.
+//
+// Regions nest: a region entered while another one is open on the same
+// thread becomes its child in the report. Use the macros below rather than
+// this class, so regions can be compiled out.
+class ScopedRegion {
+ public:
+  explicit ScopedRegion(const char* name) {
+    Profiler& profiler = Profiler::Global();
+    if (profiler.IsEnabled()) {
+      event_ = profiler.Enter(name);
+    }
+  }
+  ~ScopedRegion() {
+    if (event_ != kNoEvent) {
+      Profiler::Global().Exit(event_);
+    }
+  }
+
+  ScopedRegion(const ScopedRegion&) = delete;
+  ScopedRegion& operator=(const ScopedRegion&) = delete;
+
+ private:
+  static constexpr std::uint32_t kNoEvent = UINT32_MAX;
+  std::uint32_t event_ = kNoEvent;
+};
+
+}  // namespace nui
+
+#define NUI_PROFILE_CONCAT_IMPL(a, b) a##b
+#define NUI_PROFILE_CONCAT(a, b) NUI_PROFILE_CONCAT_IMPL(a, b)
+
+// Profile the rest of the enclosing scope as region name (string literal).
+//
+// NUI_PROFILE_REGION("BCH transform");
+#if NUI_PROFILING
+#define NUI_PROFILE_REGION(name) \
+  const ::nui::ScopedRegion NUI_PROFILE_CONCAT(nui_region_, __LINE__)(name)
+#else
+// The name is not evaluated, but counts as used.
+#define NUI_PROFILE_REGION(name) static_cast<void>(sizeof(name))
+#endif
+
+// Profile the rest of the enclosing function under its name.
+#define NUI_PROFILE_FUNCTION() NUI_PROFILE_REGION(__func__)
+
+#endif  // NUI_INFO_PROFILING_PROFILER_H_
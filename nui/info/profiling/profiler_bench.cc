@@ -0,0 +1,108 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cmath>
+#include <cstdlib>
+#include <string>
+
+#include "fmt/core.h"
+#include "nui/core/basics/basics.h"
+#include "nui/info/profiling/profiling.h"
+
+// Benchmark of the overhead of profiling regions.
+//
+// Usage: nui_..._profiler_bench [regions] [output prefix]
+//
+// Times empty regions while the profiler is disabled, enabled, and enabled
+// with hardware counters, and prints the report of the last run. The first
+// enabled run also allocates the event chunks, which the second one reuses
+// after the reset. With an output prefix, the text and JSON reports and the
+// Chrome trace are written to prefix.txt, prefix.json, and prefix.trace.json.
+
+namespace {
+
+double Regions(std::size_t n) {
+  double sum = 0.0;
+  NUI_PROFILE_REGION("outer");
+  for (std::size_t i = 0; i < n; i += 1) {
+    NUI_PROFILE_REGION("inner");
+    sum += std::sqrt(static_cast<double>(i));
+  }
+  return sum;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t n = argc > 1 ? std::atol(argv[1]) : 1000000;
+  const std::string prefix = argc > 2 ? argv[2] : "";
+  nui::Profiler& profiler = nui::Profiler::Global();
+  fmt::print(
+      "regions = {}, compiled in = {}, perf counters = {}\n",
+      n,
+      NUI_PROFILING != 0,
+      NUI_PERF_COUNTERS != 0);
+
+  double sum = 0.0;
+  const double baseline = nui::TimeSeconds([&]() {
+    for (std::size_t i = 0; i < n; i += 1) {
+      sum += std::sqrt(static_cast<double>(i));
+    }
+  });
+  const double disabled = nui::TimeSeconds([&]() { sum += Regions(n); });
+  profiler.Enable();
+  const double enabled = nui::TimeSeconds([&]() { sum += Regions(n); });
+  profiler.Reset();
+  nui::ProfileOptions options;
+  options.hardware_counters = true;
+  profiler.Enable(options);
+  const double counted = nui::TimeSeconds([&]() { sum += Regions(n); });
+  profiler.Disable();
+
+  const auto per_region = [n, baseline](double seconds) {
+    return (seconds - baseline) / static_cast<double>(n) * 1e9;
+  };
+  fmt::print("{:<24} {:>10.3f} ms\n", "No regions", baseline * 1e3);
+  fmt::print(
+      "{:<24} {:>10.3f} ms  {:>8.2f} ns / region\n",
+      "Disabled",
+      disabled * 1e3,
+      per_region(disabled));
+  fmt::print(
+      "{:<24} {:>10.3f} ms  {:>8.2f} ns / region\n",
+      "Enabled",
+      enabled * 1e3,
+      per_region(enabled));
+  fmt::print(
+      "{:<24} {:>10.3f} ms  {:>8.2f} ns / region\n",
+      "Enabled with counters",
+      counted * 1e3,
+      per_region(counted));
+
+  const std::vector<nui::ThreadProfile> profiles = profiler.Snapshot();
+  fmt::print("\n{}", nui::ProfileReport(profiles).ToText());
+  if (!prefix.empty() && !nui::WriteProfile(prefix, profiles)) {
+    fmt::print("writing {} failed\n", prefix);
+    return 1;
+  }
+  return sum > 0.0 ? 0 : 1;
+}
@@ -0,0 +1,243 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/info/profiling/profiling.h"
+
+#include <cmath>
+#include <thread>
+
+#include "catch2/catch_test_macros.hpp"
+#include "nui/core/basics/basics.h"
+#include "nui/core/io/io.h"
+
+namespace {
+
+nui::ProfileEvent Event(
+    const char* name,
+    std::uint32_t parent,
+    std::int64_t start,
+    std::int64_t end) {
+  nui::ProfileEvent event;
+  event.name = name;
+  event.parent = parent;
+  event.start_ns = start;
+  event.end_ns = end;
+  return event;
+}
+
+double Work(std::size_t n) {
+  double sum = 0.0;
+  for (std::size_t i = 0; i < n; i += 1) {
+    sum += std::sqrt(static_cast<double>(i));
+  }
+  return sum;
+}
+
+}  // namespace
+
+TEST_CASE("ProfileReport, Test tree aggregation.") {
+  const std::uint32_t none = nui::kNoParentEvent;
+  std::vector<nui::ThreadProfile> profiles(2);
+  profiles[0].thread = 0;
+  profiles[0].events = {
+      Event("a", none, 0, 100),
+      Event("b", 0, 10, 40),
+      Event("b", 0, 50, 80),
+      Event("c", none, 100, 150),
+      // Still open, so skipped.
+      Event("d", none, 150, -1),
+  };
+  profiles[1].thread = 1;
+  profiles[1].events = {
+      Event("a", none, 0, 300),
+      Event("b", 0, 0, 100),
+  };
+  const nui::ProfileReport report(profiles);
+
+  const nui::ProfileNode& root = report.Root();
+  REQUIRE(root.name == "total");
+  REQUIRE(root.children.size() == 3);
+  REQUIRE(root.children[0].name == "a");
+  REQUIRE(std::abs(root.inclusive - 450e-9) < 1e-15);
+
+  const nui::ProfileNode* a = report.Find("a");
+  REQUIRE(a != nullptr);
+  REQUIRE(a->calls == 2);
+  REQUIRE(a->threads == 2);
+  REQUIRE(std::abs(a->inclusive - 400e-9) < 1e-15);
+  REQUIRE(std::abs(a->exclusive - 240e-9) < 1e-15);
+  REQUIRE(std::abs(a->max_thread_inclusive - 300e-9) < 1e-15);
+  REQUIRE(std::abs(a->imbalance - 0.5) < 1e-12);
+
+  const nui::ProfileNode* b = report.Find("a/b");
+  REQUIRE(b != nullptr);
+  REQUIRE(b->calls == 3);
+  REQUIRE(std::abs(b->inclusive - 160e-9) < 1e-15);
+  REQUIRE(b->exclusive == b->inclusive);
+
+  REQUIRE(report.Find("c")->threads == 1);
+  REQUIRE(report.Find("c")->imbalance == 0.0);
+  REQUIRE(report.Find("d")->calls == 0);
+  REQUIRE(report.Find("a/c") == nullptr);
+  REQUIRE(report.Find("") == &root);
+}
+
+TEST_CASE("ProfileReport, Test output formats.") {
+  std::vector<nui::ThreadProfile> profiles(1);
+  profiles[0].events = {
+      nui::ProfileEvent{"flow \"x\"", nui::kNoParentEvent, 0, 1000, 3000},
+      nui::ProfileEvent{"step", 0, 1, 1500, 2500},
+  };
+  profiles[0].events[0].counters[0] = 100;
+  profiles[0].events[1].counters[0] = 42;
+  const nui::ProfileReport report(profiles);
+
+  const std::string text = report.ToText();
+  REQUIRE(text.find("region") != std::string::npos);
+  REQUIRE(text.find("    step") != std::string::npos);
+  REQUIRE(text.find("cycles") != std::string::npos);
+
+  const std::string json = report.ToJson();
+  REQUIRE(json.find("\"name\": \"flow \\\"x\\\"\"") != std::string::npos);
+  REQUIRE(json.find("\"calls\": 1") != std::string::npos);
+  REQUIRE(json.find("\"cycles\": 42") != std::string::npos);
+
+  const std::string trace = nui::ToChromeTrace(profiles);
+  REQUIRE(trace.find("\"traceEvents\"") != std::string::npos);
+  REQUIRE(trace.find("\"ph\": \"X\"") != std::string::npos);
+  REQUIRE(trace.find("\"ts\": 1.500, \"dur\": 1.000") != std::string::npos);
+
+  const nui::TempDirectory dir("nui_profiling_test");
+  const std::string prefix = dir.File("profile");
+  REQUIRE(nui::WriteProfile(prefix, profiles));
+  for (const char* suffix : {".txt", ".json", ".trace.json"}) {
+    REQUIRE(nui::FileExists(prefix + suffix));
+  }
+  REQUIRE_FALSE(nui::WriteProfile("/nonexistent/dir/profile", profiles));
+}
+
+TEST_CASE("Profiler, Test nested regions on threads.") {
+  nui::Profiler& profiler = nui::Profiler::Global();
+  profiler.Reset();
+  {
+    const nui::ScopedRegion region("disabled");
+  }
+  REQUIRE(profiler.Snapshot().empty());
+
+  profiler.Enable();
+  {
+    const nui::ScopedRegion outer("outer");
+    for (std::size_t i = 0; i < 3; i += 1) {
+      const nui::ScopedRegion inner("inner");
+      REQUIRE(Work(1000) > 0.0);
+    }
+  }
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < 2; t += 1) {
+    threads.emplace_back([]() {
+      const nui::ScopedRegion worker("worker");
+      REQUIRE(Work(10000) > 0.0);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  profiler.Disable();
+  {
+    const nui::ScopedRegion region("disabled");
+  }
+
+  const nui::ProfileReport report(profiler.Snapshot());
+  REQUIRE(report.Root().children.size() == 2);
+  const nui::ProfileNode* outer = report.Find("outer");
+  const nui::ProfileNode* inner = report.Find("outer/inner");
+  REQUIRE(outer != nullptr);
+  REQUIRE(inner != nullptr);
+  REQUIRE(outer->calls == 1);
+  REQUIRE(inner->calls == 3);
+  REQUIRE(outer->inclusive >= inner->inclusive);
+  REQUIRE(outer->exclusive <= outer->inclusive);
+  const nui::ProfileNode* worker = report.Find("worker");
+  REQUIRE(worker != nullptr);
+  REQUIRE(worker->calls == 2);
+  REQUIRE(worker->threads == 2);
+  REQUIRE(report.Find("disabled") == nullptr);
+
+  profiler.Reset();
+  REQUIRE(profiler.Snapshot().empty());
+}
+
+TEST_CASE("Profiler, Test region macros.") {
+  nui::Profiler& profiler = nui::Profiler::Global();
+  profiler.Reset();
+  profiler.Enable();
+  {
+    NUI_PROFILE_FUNCTION();
+    NUI_PROFILE_REGION("macro");
+  }
+  profiler.Disable();
+  const nui::ProfileReport report(profiler.Snapshot());
+#if NUI_PROFILING
+  REQUIRE(report.Root().children.size() == 1);
+  REQUIRE(report.Root().children[0].children.size() == 1);
+  REQUIRE(report.Root().children[0].children[0].name == "macro");
+#else
+  REQUIRE(report.Root().children.empty());
+#endif
+  profiler.Reset();
+}
+
+TEST_CASE("HardwareCounters, Test counting.") {
+  REQUIRE(nui::ToString(nui::HardwareCounter::kCacheMisses) ==
+          "cache_misses");
+  nui::HardwareCounterOptions options;
+  const nui::HardwareCounters counters(options);
+  REQUIRE_FALSE(counters.Available(nui::HardwareCounter::kFlops));
+  const nui::HardwareCounterValues before = counters.Read();
+  REQUIRE(Work(100000) > 0.0);
+  const nui::HardwareCounterValues after = counters.Read();
+  for (std::size_t i = 0; i < nui::kNumHardwareCounters; i += 1) {
+    const auto counter = static_cast<nui::HardwareCounter>(i);
+    // Counters are unavailable in many containers and virtual machines.
+    if (!counters.Available(counter)) {
+      REQUIRE(after[i] == 0);
+      continue;
+    }
+    REQUIRE(after[i] >= before[i]);
+  }
+
+  // Profiles with counters work whether or not counters are available.
+  nui::Profiler& profiler = nui::Profiler::Global();
+  profiler.Reset();
+  nui::ProfileOptions profile_options;
+  profile_options.hardware_counters = true;
+  profiler.Enable(profile_options);
+  {
+    const nui::ScopedRegion region("counted");
+    REQUIRE(Work(100000) > 0.0);
+  }
+  profiler.Disable();
+  const nui::ProfileReport report(profiler.Snapshot());
+  REQUIRE(report.Find("counted") != nullptr);
+  REQUIRE(report.Find("counted")->calls == 1);
+  profiler.Reset();
+}
@@ -0,0 +1,60 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_INFO_PROFILING_TIMING_H_
+#define NUI_INFO_PROFILING_TIMING_H_
+
+// IWYU pragma: private, include "nui/info/profiling/profiling.h"
+// IWYU pragma: friend "nui/info/profiling/.*\.h"
+
+#include <chrono>
+
+namespace nui {
+
+// Get wall time in seconds elapsed on the steady clock since start.
+inline double SecondsSince(std::chrono::steady_clock::time_point start) {
+  const auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(stop - start).count();
+}
+
+// Get wall time in seconds of one call of f.
+template <typename F>
+double TimeSeconds(F&& f) {
+  const auto start = std::chrono::steady_clock::now();
+  f();
+  return SecondsSince(start);
+}
+
+// Get mean wall time in seconds of repeats calls of f after a warm-up call.
+template <typename F>
+double TimeSeconds(int repeats, F&& f) {
+  f();
+  const auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < repeats; r += 1) {
+    f();
+  }
+  return SecondsSince(start) / repeats;
+}
+
+}  // namespace nui
+
+#endif  // NUI_INFO_PROFILING_TIMING_H_
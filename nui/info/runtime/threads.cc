@@ -0,0 +1,51 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/info/runtime/threads.h"
+
+#include <omp.h>
+
+#include "nui/core/basics/basics.h"
+
+namespace nui {
+
+namespace {
+
+// Limit of the calling thread, 0 for none.
+thread_local int thread_limit = 0;
+
+}  // namespace
+
+int NumParallelThreads() {
+  return thread_limit > 0 ? thread_limit : omp_get_max_threads();
+}
+
+ScopedThreadLimit::ScopedThreadLimit(std::size_t num_threads)
+    : previous_(thread_limit) {
+  if (num_threads > 0) {
+    thread_limit = static_cast<int>(num_threads);
+  }
+}
+
+ScopedThreadLimit::~ScopedThreadLimit() { thread_limit = previous_; }
+
+}  // namespace nui
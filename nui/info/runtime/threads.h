@@ -0,0 +1,65 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_INFO_RUNTIME_THREADS_H_
+#define NUI_INFO_RUNTIME_THREADS_H_
+
+// IWYU pragma: private, include "nui/info/runtime/runtime.h"
+// IWYU pragma: friend "nui/info/runtime/.*\.h"
+
+#include "nui/core/basics/basics.h"
+
+// Thread counts of OpenMP parallel regions.
+//
+// Parallel regions size their team with num_threads(NumParallelThreads()).
+// Threads that run independent work concurrently (e.g., the flows of an
+// ensemble) limit their own teams with a ScopedThreadLimit instead of
+// omp_set_num_threads, so no thread changes the OpenMP state of another.
+
+namespace nui {
+
+// Get number of threads of parallel regions started by the calling thread.
+//
+// This is the innermost ScopedThreadLimit of the calling thread, or
+// omp_get_max_threads() without one.
+int NumParallelThreads();
+
+// Limit of the threads of parallel regions started by the calling thread,
+// for the lifetime of the object.
+class ScopedThreadLimit {
+ public:
+  // Limit parallel regions to num_threads (0 keeps the current limit).
+  explicit ScopedThreadLimit(std::size_t num_threads);
+
+  ScopedThreadLimit(const ScopedThreadLimit&) = delete;
+  ScopedThreadLimit& operator=(const ScopedThreadLimit&) = delete;
+
+  // Restore the previous limit.
+  ~ScopedThreadLimit();
+
+ private:
+  int previous_ = 0;
+};
+
+}  // namespace nui
+
+#endif  // NUI_INFO_RUNTIME_THREADS_H_
@@ -0,0 +1,67 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/info/runtime/threads.h"
+
+#include <omp.h>
+
+#include <thread>
+
+#include "catch2/catch_test_macros.hpp"
+#include "nui/core/basics/basics.h"
+
+TEST_CASE("ScopedThreadLimit, Test nesting.") {
+  const int max_threads = omp_get_max_threads();
+  REQUIRE(nui::NumParallelThreads() == max_threads);
+  {
+    const nui::ScopedThreadLimit outer(3);
+    REQUIRE(nui::NumParallelThreads() == 3);
+    {
+      const nui::ScopedThreadLimit inner(2);
+      REQUIRE(nui::NumParallelThreads() == 2);
+      const nui::ScopedThreadLimit keep(0);
+      REQUIRE(nui::NumParallelThreads() == 2);
+    }
+    REQUIRE(nui::NumParallelThreads() == 3);
+  }
+  REQUIRE(nui::NumParallelThreads() == max_threads);
+  REQUIRE(omp_get_max_threads() == max_threads);
+}
+
+TEST_CASE("ScopedThreadLimit, Test limits are per thread.") {
+  const nui::ScopedThreadLimit limit(1);
+  int other = 0;
+  int team = 0;
+  std::thread thread([&other, &team]() {
+    const nui::ScopedThreadLimit limit(2);
+    other = nui::NumParallelThreads();
+#pragma omp parallel num_threads(nui::NumParallelThreads())
+    {
+#pragma omp single
+      team = omp_get_num_threads();
+    }
+  });
+  thread.join();
+  REQUIRE(other == 2);
+  REQUIRE(team <= 2);
+  REQUIRE(nui::NumParallelThreads() == 1);
+}
@@ -0,0 +1,156 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/coupling/wigner_symbols.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+
+namespace nui {
+
+namespace {
+
+// Largest factorial representable in double.
+constexpr int kMaxFactorial = 170;
+
+double Factorial(int n) {
+  static const std::array<double, kMaxFactorial + 1> table = []() {
+    std::array<double, kMaxFactorial + 1> t{};
+    t[0] = 1.0;
+    for (int i = 1; i <= kMaxFactorial; i += 1) {
+      t[i] = t[i - 1] * i;
+    }
+    return t;
+  }();
+  return table[n];
+}
+
+// Get triangle coefficient of (j1 j2 j3) for triangular triads.
+double TriangleCoefficient(int two_j1, int two_j2, int two_j3) {
+  return std::sqrt(
+      Factorial((two_j1 + two_j2 - two_j3) / 2) *
+      Factorial((two_j1 - two_j2 + two_j3) / 2) *
+      Factorial((-two_j1 + two_j2 + two_j3) / 2) /
+      Factorial((two_j1 + two_j2 + two_j3) / 2 + 1));
+}
+
+}  // namespace
+
+double SixJ(
+    int two_j1,
+    int two_j2,
+    int two_j3,
+    int two_j4,
+    int two_j5,
+    int two_j6) {
+  if (!IsTriangle(two_j1, two_j2, two_j3) ||
+      !IsTriangle(two_j1, two_j5, two_j6) ||
+      !IsTriangle(two_j4, two_j2, two_j6) ||
+      !IsTriangle(two_j4, two_j5, two_j3)) {
+    return 0.0;
+  }
+  const int a1 = (two_j1 + two_j2 + two_j3) / 2;
+  const int a2 = (two_j1 + two_j5 + two_j6) / 2;
+  const int a3 = (two_j4 + two_j2 + two_j6) / 2;
+  const int a4 = (two_j4 + two_j5 + two_j3) / 2;
+  const int b1 = (two_j1 + two_j2 + two_j4 + two_j5) / 2;
+  const int b2 = (two_j2 + two_j3 + two_j5 + two_j6) / 2;
+  const int b3 = (two_j3 + two_j1 + two_j6 + two_j4) / 2;
+  const int t_min = std::max({a1, a2, a3, a4});
+  const int t_max = std::min({b1, b2, b3});
+  if (t_max + 1 > kMaxFactorial) {
+    return 0.0;
+  }
+
+  double sum = 0.0;
+  for (int t = t_min; t <= t_max; t += 1) {
+    const double term =
+        Factorial(t + 1) /
+        (Factorial(t - a1) * Factorial(t - a2) * Factorial(t - a3) *
+         Factorial(t - a4) * Factorial(b1 - t) * Factorial(b2 - t) *
+         Factorial(b3 - t));
+    sum += t % 2 == 0 ? term : -term;
+  }
+  return sum * TriangleCoefficient(two_j1, two_j2, two_j3) *
+         TriangleCoefficient(two_j1, two_j5, two_j6) *
+         TriangleCoefficient(two_j4, two_j2, two_j6) *
+         TriangleCoefficient(two_j4, two_j5, two_j3);
+}
+
+double CyclicRecoupling(
+    int two_ja,
+    int two_jb,
+    int two_jc,
+    int two_jab,
+    int two_jbc,
+    int two_j) {
+  const double phase =
+      ((two_jb + two_jc) / 2 + two_jbc / 2) % 2 == 0 ? -1.0 : 1.0;
+  return phase * std::sqrt((two_jab + 1.0) * (two_jbc + 1.0)) *
+         SixJ(two_ja, two_jb, two_jab, two_jc, two_j, two_jbc);
+}
+
+double ClebschGordan(
+    int two_j1,
+    int two_m1,
+    int two_j2,
+    int two_m2,
+    int two_j,
+    int two_m) {
+  if (two_m1 + two_m2 != two_m || !IsTriangle(two_j1, two_j2, two_j) ||
+      std::abs(two_m1) > two_j1 || std::abs(two_m2) > two_j2 ||
+      std::abs(two_m) > two_j || (two_j1 + two_m1) % 2 != 0 ||
+      (two_j2 + two_m2) % 2 != 0) {
+    return 0.0;
+  }
+  const int b1 = (two_j1 + two_j2 - two_j) / 2;
+  const int b2 = (two_j1 - two_m1) / 2;
+  const int b3 = (two_j2 + two_m2) / 2;
+  const int c1 = (two_j - two_j2 + two_m1) / 2;
+  const int c2 = (two_j - two_j1 - two_m2) / 2;
+  const int k_min = std::max({0, -c1, -c2});
+  const int k_max = std::min({b1, b2, b3});
+  if ((two_j1 + two_j2 + two_j) / 2 + 1 > kMaxFactorial) {
+    return 0.0;
+  }
+
+  double sum = 0.0;
+  for (int k = k_min; k <= k_max; k += 1) {
+    const double term =
+        1.0 / (Factorial(k) * Factorial(b1 - k) * Factorial(b2 - k) *
+               Factorial(b3 - k) * Factorial(c1 + k) * Factorial(c2 + k));
+    sum += k % 2 == 0 ? term : -term;
+  }
+  return sum * std::sqrt(two_j + 1.0) *
+         TriangleCoefficient(two_j1, two_j2, two_j) *
+         std::sqrt(
+             Factorial((two_j1 + two_m1) / 2) *
+             Factorial((two_j1 - two_m1) / 2) *
+             Factorial((two_j2 + two_m2) / 2) *
+             Factorial((two_j2 - two_m2) / 2) *
+             Factorial((two_j + two_m) / 2) *
+             Factorial((two_j - two_m) / 2));
+}
+
+}  // namespace nui
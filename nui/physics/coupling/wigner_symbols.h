@@ -0,0 +1,82 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_COUPLING_WIGNER_SYMBOLS_H_
+#define NUI_PHYSICS_COUPLING_WIGNER_SYMBOLS_H_
+
+// IWYU pragma: private, include "nui/physics/coupling/coupling.h"
+// IWYU pragma: friend "nui/physics/coupling/.*\.h"
+
+// Wigner symbols for doubled angular momenta (two_j = 2 * j).
+//
+// Symbols are evaluated with the Racah formula in double precision with
+// tabulated factorials, which is accurate for the angular momenta of
+// nuclear model spaces (j <= ~40). Callers in hot loops should tabulate
+// the symbols they need (e.g., in precomputed plans).
+
+namespace nui {
+
+// Check |j1 - j2| <= j3 <= j1 + j2 and j1 + j2 + j3 integer.
+constexpr bool IsTriangle(int two_j1, int two_j2, int two_j3) noexcept {
+  return two_j3 <= two_j1 + two_j2 && two_j1 - two_j2 <= two_j3 &&
+         two_j2 - two_j1 <= two_j3 && (two_j1 + two_j2 + two_j3) % 2 == 0;
+}
+
+// Get 6j symbol {j1 j2 j3; j4 j5 j6}.
+//
+// Returns zero if any triad violates the triangle condition.
+double SixJ(
+    int two_j1,
+    int two_j2,
+    int two_j3,
+    int two_j4,
+    int two_j5,
+    int two_j6);
+
+// Get coefficient of |(bc) J_bc, a; J> in the antisymmetrized three-body
+// state |(ab) J_ab, c; J>,
+//
+//   -(-1)^(j_b + j_c + J_bc) sqrt((2J_ab + 1)(2J_bc + 1))
+//   {j_a j_b J_ab; j_c J J_bc}.
+double CyclicRecoupling(
+    int two_ja,
+    int two_jb,
+    int two_jc,
+    int two_jab,
+    int two_jbc,
+    int two_j);
+
+// Get Clebsch-Gordan coefficient <j1 m1 j2 m2 | j m>.
+//
+// Returns zero if m1 + m2 != m, any |m| exceeds its j, or (j1 j2 j) violates
+// the triangle condition.
+double ClebschGordan(
+    int two_j1,
+    int two_m1,
+    int two_j2,
+    int two_m2,
+    int two_j,
+    int two_m);
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_COUPLING_WIGNER_SYMBOLS_H_
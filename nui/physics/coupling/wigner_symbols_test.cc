@@ -0,0 +1,122 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/coupling/wigner_symbols.h"
+
+#include <cmath>
+
+#include "catch2/catch_approx.hpp"
+#include "catch2/catch_test_macros.hpp"
+
+TEST_CASE("IsTriangle, Test doubled angular momenta.") {
+  REQUIRE(nui::IsTriangle(1, 1, 0));
+  REQUIRE(nui::IsTriangle(1, 1, 2));
+  REQUIRE_FALSE(nui::IsTriangle(1, 1, 4));
+  REQUIRE_FALSE(nui::IsTriangle(1, 1, 1));
+  REQUIRE(nui::IsTriangle(3, 5, 2));
+  REQUIRE_FALSE(nui::IsTriangle(3, 9, 4));
+}
+
+TEST_CASE("SixJ, Test known values.") {
+  // {1/2 1/2 0; 1/2 1/2 0} = -1/2.
+  REQUIRE(nui::SixJ(1, 1, 0, 1, 1, 0) == Catch::Approx(-0.5));
+  // {1/2 1/2 1; 1/2 1/2 0} = 1/2.
+  REQUIRE(nui::SixJ(1, 1, 2, 1, 1, 0) == Catch::Approx(0.5));
+  // {1 1 1; 1 1 1} = 1/6.
+  REQUIRE(nui::SixJ(2, 2, 2, 2, 2, 2) == Catch::Approx(1.0 / 6.0));
+  // {2 2 2; 2 2 2} = -3/70.
+  REQUIRE(nui::SixJ(4, 4, 4, 4, 4, 4) == Catch::Approx(-3.0 / 70.0));
+  // Symmetry under exchange of upper and lower rows in two columns.
+  REQUIRE(
+      nui::SixJ(3, 3, 2, 1, 1, 2) ==
+      Catch::Approx(nui::SixJ(1, 1, 2, 3, 3, 2)));
+  REQUIRE(nui::SixJ(1, 1, 4, 1, 1, 0) == 0.0);
+}
+
+TEST_CASE("SixJ, Test orthogonality.") {
+  // sum_x (2x + 1) (2f + 1) {a b x; c d f} {a b x; c d g} = delta_fg.
+  const int two_a = 7;
+  const int two_b = 5;
+  const int two_c = 3;
+  const int two_d = 9;
+  for (int two_f = 0; two_f <= 16; two_f += 2) {
+    for (int two_g = 0; two_g <= 16; two_g += 2) {
+      if (!nui::IsTriangle(two_a, two_d, two_f) ||
+          !nui::IsTriangle(two_c, two_b, two_f) ||
+          !nui::IsTriangle(two_a, two_d, two_g) ||
+          !nui::IsTriangle(two_c, two_b, two_g)) {
+        continue;
+      }
+      double sum = 0.0;
+      for (int two_x = 0; two_x <= 16; two_x += 2) {
+        sum += (two_x + 1.0) * (two_f + 1.0) *
+               nui::SixJ(two_a, two_b, two_x, two_c, two_d, two_f) *
+               nui::SixJ(two_a, two_b, two_x, two_c, two_d, two_g);
+      }
+      const double expected = two_f == two_g ? 1.0 : 0.0;
+      REQUIRE(sum == Catch::Approx(expected).margin(1e-12));
+    }
+  }
+}
+
+TEST_CASE("ClebschGordan, Test known values.") {
+  // <1/2 1/2 1/2 -1/2 | 0 0> = 1/sqrt(2).
+  REQUIRE(
+      nui::ClebschGordan(1, 1, 1, -1, 0, 0) ==
+      Catch::Approx(1.0 / std::sqrt(2.0)));
+  REQUIRE(
+      nui::ClebschGordan(1, -1, 1, 1, 0, 0) ==
+      Catch::Approx(-1.0 / std::sqrt(2.0)));
+  REQUIRE(nui::ClebschGordan(1, 1, 1, 1, 2, 2) == Catch::Approx(1.0));
+  // <1 1 1/2 -1/2 | 3/2 1/2> = 1/sqrt(3).
+  REQUIRE(
+      nui::ClebschGordan(2, 2, 1, -1, 3, 1) ==
+      Catch::Approx(1.0 / std::sqrt(3.0)));
+  // <1 0 1/2 1/2 | 1/2 1/2> = -1/sqrt(3).
+  REQUIRE(
+      nui::ClebschGordan(2, 0, 1, 1, 1, 1) ==
+      Catch::Approx(-1.0 / std::sqrt(3.0)));
+  REQUIRE(nui::ClebschGordan(1, 1, 1, 1, 0, 0) == 0.0);
+  REQUIRE(nui::ClebschGordan(1, 1, 1, -1, 4, 0) == 0.0);
+}
+
+TEST_CASE("ClebschGordan, Test orthogonality.") {
+  // sum_m1m2 <j1 m1 j2 m2 | j m> <j1 m1 j2 m2 | j' m> = delta_jj'.
+  const int two_j1 = 5;
+  const int two_j2 = 3;
+  for (int two_j = 2; two_j <= 8; two_j += 2) {
+    for (int two_k = 2; two_k <= 8; two_k += 2) {
+      const int two_m = 2;
+      double sum = 0.0;
+      for (int two_m1 = -two_j1; two_m1 <= two_j1; two_m1 += 2) {
+        const int two_m2 = two_m - two_m1;
+        const double x =
+            nui::ClebschGordan(two_j1, two_m1, two_j2, two_m2, two_j, two_m);
+        const double y =
+            nui::ClebschGordan(two_j1, two_m1, two_j2, two_m2, two_k, two_m);
+        sum += x * y;
+      }
+      const double expected = two_j == two_k ? 1.0 : 0.0;
+      REQUIRE(sum == Catch::Approx(expected).margin(1e-12));
+    }
+  }
+}
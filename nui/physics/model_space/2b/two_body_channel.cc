@@ -0,0 +1,68 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/model_space/2b/two_body_channel.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/indexing/indexing.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/quantum_numbers/quantum_numbers.h"
+
+namespace nui {
+
+TwoBodyChannel::TwoBodyChannel(
+    PackedChannel qn,
+    std::vector<OrbitalPair>&& pairs,
+    std::vector<OrbitalPairKey>&& pair_keys,
+    const SPModelSpace& sp)
+    : qn_(qn), pairs_(std::move(pairs)), lookup_(std::move(pair_keys)) {
+  occupations_.reserve(pairs_.size());
+  for (const auto i : StateIndices()) {
+    const OrbitalIndex a = First(i);
+    const OrbitalIndex b = Second(i);
+    std::uint8_t flags = 0;
+    if (sp.IsHole(a) && sp.IsHole(b)) {
+      flags |= kOccupationHH;
+      hh_states_.push_back(i);
+    }
+    if ((sp.IsHole(a) && sp.IsParticle(b)) ||
+        (sp.IsParticle(a) && sp.IsHole(b))) {
+      flags |= kOccupationPH;
+      ph_states_.push_back(i);
+    }
+    if (sp.IsParticle(a) && sp.IsParticle(b)) {
+      flags |= kOccupationPP;
+      pp_states_.push_back(i);
+    }
+    occupations_.push_back(flags);
+  }
+}
+
+std::size_t TwoBodyChannel::MemoryLoad() const {
+  return pairs_.size() * sizeof(OrbitalPair) +
+         occupations_.size() * sizeof(std::uint8_t) +
+         (hh_states_.size() + ph_states_.size() + pp_states_.size()) *
+             sizeof(TwoBodyStateIndex) +
+         lookup_.MemoryLoad();
+}
+
+}  // namespace nui
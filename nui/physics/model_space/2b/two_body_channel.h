@@ -0,0 +1,163 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_MODEL_SPACE_2B_TWO_BODY_CHANNEL_H_
+#define NUI_PHYSICS_MODEL_SPACE_2B_TWO_BODY_CHANNEL_H_
+
+// IWYU pragma: private, include "nui/physics/model_space/2b/model_space_2b.h"
+// IWYU pragma: friend "nui/physics/model_space/2b/.*\.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/indexing/indexing.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/quantum_numbers/quantum_numbers.h"
+
+namespace nui {
+class TwoBodyStateIndex;
+class OrbitalPairKey;
+}  // namespace nui
+
+// Index of a two-body state within a channel.
+NUI_MAKE_INDEX_TYPE(TwoBodyStateIndex);
+
+// Dense key of an orbital pair (a <= b) among all pairs
+// of the same parity and Tz.
+NUI_MAKE_INDEX_TYPE(OrbitalPairKey);
+
+namespace nui {
+
+// Occupation classes of a two-body state |ab> as bit flags.
+//
+// For references with fractional occupations a state may be in several
+// classes at once (an orbital with 0 < n_a < 1 is both hole and particle).
+enum OccupationClass : std::uint8_t {
+  kOccupationHH = 1,
+  kOccupationPH = 2,
+  kOccupationPP = 4,
+};
+
+// Orbital pair (a, b) stored in 32 bits.
+struct OrbitalPair {
+  std::uint16_t a = 0;
+  std::uint16_t b = 0;
+};
+
+// Two-body J-scheme channel (J, parity, Tz).
+//
+// States are antisymmetrized pairs |ab; J> with a <= b in model space order,
+// sorted by a and then b. Pairs with a == b only appear for even J.
+class TwoBodyChannel {
+ public:
+  // Construct empty channel.
+  TwoBodyChannel() {}
+
+  // Construct channel from sorted pairs and their family pair keys.
+  //
+  // The model space sp provides occupations for the occupation classes.
+  TwoBodyChannel(
+      PackedChannel qn,
+      std::vector<OrbitalPair>&& pairs,
+      std::vector<OrbitalPairKey>&& pair_keys,
+      const SPModelSpace& sp);
+
+  // Get channel quantum numbers.
+  PackedChannel QuantumNumbers() const { return qn_; }
+
+  // Get number of states in channel.
+  std::size_t Dimension() const { return pairs_.size(); }
+
+  // Get range of state indices.
+  IndexRange<TwoBodyStateIndex> StateIndices() const {
+    return IndexRange<TwoBodyStateIndex>(pairs_.size());
+  }
+
+  // Get first orbital of state.
+  OrbitalIndex First(TwoBodyStateIndex i) const { return pairs_[i.idx()].a; }
+
+  // Get second orbital of state.
+  OrbitalIndex Second(TwoBodyStateIndex i) const {
+    return pairs_[i.idx()].b;
+  }
+
+  // Get all orbital pairs.
+  const std::vector<OrbitalPair>& Pairs() const { return pairs_; }
+
+  // Get index of state with pair key.
+  //
+  // Returns TwoBodyStateIndex::Invalid() if pair is not in channel.
+  TwoBodyStateIndex Index(OrbitalPairKey key) const {
+    return lookup_.ConvertSafe(key);
+  }
+
+  // Get occupation class flags of state.
+  std::uint8_t Occupation(TwoBodyStateIndex i) const {
+    return occupations_[i.idx()];
+  }
+
+  // Get states with both orbitals holes.
+  const std::vector<TwoBodyStateIndex>& HoleHoleStates() const {
+    return hh_states_;
+  }
+
+  // Get states with one hole and one particle orbital.
+  const std::vector<TwoBodyStateIndex>& ParticleHoleStates() const {
+    return ph_states_;
+  }
+
+  // Get states with both orbitals particles.
+  const std::vector<TwoBodyStateIndex>& ParticleParticleStates() const {
+    return pp_states_;
+  }
+
+  // Get size of channel in dynamic memory.
+  std::size_t MemoryLoad() const;
+
+  // Swap with other channel.
+  void swap(TwoBodyChannel& other) noexcept {
+    using std::swap;
+    swap(qn_, other.qn_);
+    swap(pairs_, other.pairs_);
+    swap(occupations_, other.occupations_);
+    swap(hh_states_, other.hh_states_);
+    swap(ph_states_, other.ph_states_);
+    swap(pp_states_, other.pp_states_);
+    swap(lookup_, other.lookup_);
+  }
+
+ private:
+  PackedChannel qn_;
+  std::vector<OrbitalPair> pairs_;
+  std::vector<std::uint8_t> occupations_;
+  std::vector<TwoBodyStateIndex> hh_states_;
+  std::vector<TwoBodyStateIndex> ph_states_;
+  std::vector<TwoBodyStateIndex> pp_states_;
+  IndexConversion<OrbitalPairKey, TwoBodyStateIndex> lookup_;
+};
+
+// Swap two channels.
+inline void swap(TwoBodyChannel& a, TwoBodyChannel& b) noexcept {
+  a.swap(b);
+}
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_MODEL_SPACE_2B_TWO_BODY_CHANNEL_H_
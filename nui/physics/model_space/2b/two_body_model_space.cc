@@ -0,0 +1,300 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/model_space/2b/two_body_model_space.h"
+
+#include <atomic>
+#include <mutex>
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/indexing/indexing.h"
+#include "nui/info/runtime/runtime.h"
+#include "nui/physics/model_space/2b/two_body_channel.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/quantum_numbers/quantum_numbers.h"
+
+namespace nui {
+
+namespace {
+
+constexpr std::size_t kNumFamilies = 6;
+
+std::size_t FamilyOf(int parity, int two_tz) {
+  return static_cast<std::size_t>(parity + (two_tz + 2));
+}
+
+std::vector<PackedChannel> MakeChannels(
+    const SPModelSpace& sp,
+    const std::vector<std::vector<OrbitalPair>>& family_pairs) {
+  std::vector<PackedChannel> channels;
+  for (const int two_tz : {-2, 0, 2}) {
+    for (const int parity : {0, 1}) {
+      int two_j_max = -1;
+      for (const auto& p : family_pairs[FamilyOf(parity, two_tz)]) {
+        two_j_max = std::max(
+            two_j_max,
+            sp.Orbital(p.a).TwoJ() + sp.Orbital(p.b).TwoJ());
+      }
+      for (int two_j = 0; two_j <= two_j_max; two_j += 2) {
+        channels.push_back(PackedChannel(two_j, parity, two_tz));
+      }
+    }
+  }
+  return channels;
+}
+
+std::vector<ChannelKey> MakeChannelKeys(
+    const std::vector<PackedChannel>& channels) {
+  std::vector<ChannelKey> keys;
+  keys.reserve(channels.size());
+  for (const auto& c : channels) {
+    keys.push_back(c.Key());
+  }
+  return keys;
+}
+
+// Check if orbitals a and b couple to channel qn.
+bool CouplesTo(PackedOrbital a, PackedOrbital b, PackedChannel qn) {
+  return (a.Parity() + b.Parity()) % 2 == qn.Parity() &&
+         a.TwoTz() + b.TwoTz() == qn.TwoTz() &&
+         std::abs(a.TwoJ() - b.TwoJ()) <= qn.TwoJ() &&
+         qn.TwoJ() <= a.TwoJ() + b.TwoJ();
+}
+
+// Interned model space. The single-particle space is reached through the
+// model space, so the registry never keeps either alive.
+struct InternedEntry {
+  TwoBodyTruncation truncation;
+  std::weak_ptr<const TwoBodyModelSpace> ms;
+};
+
+std::mutex interned_mutex;
+std::vector<InternedEntry> interned;
+
+}  // namespace
+
+std::shared_ptr<const TwoBodyModelSpace> TwoBodyModelSpace::Make(
+    std::shared_ptr<const SPModelSpace> sp,
+    TwoBodyTruncation truncation) {
+  const std::lock_guard<std::mutex> lock(interned_mutex);
+
+  interned.erase(
+      std::remove_if(
+          interned.begin(),
+          interned.end(),
+          [](const InternedEntry& x) { return x.ms.expired(); }),
+      interned.end());
+
+  for (const auto& entry : interned) {
+    if (!(entry.truncation == truncation)) {
+      continue;
+    }
+    auto ms = entry.ms.lock();
+    if (!ms) {
+      continue;
+    }
+    const SPModelSpace& entry_sp = ms->SP();
+    if (&entry_sp == sp.get() ||
+        (entry_sp.Truncation() == sp->Truncation() &&
+         entry_sp.ReferenceState() == sp->ReferenceState())) {
+      return ms;
+    }
+  }
+
+  auto ms =
+      std::make_shared<const TwoBodyModelSpace>(std::move(sp), truncation);
+  interned.push_back({truncation, ms});
+  return ms;
+}
+
+std::shared_ptr<const TwoBodyModelSpace> TwoBodyModelSpace::Make(
+    std::shared_ptr<const SPModelSpace> sp) {
+  const int e2max = 2 * sp->Truncation().emax;
+  return Make(std::move(sp), {e2max});
+}
+
+TwoBodyModelSpace::TwoBodyModelSpace(
+    std::shared_ptr<const SPModelSpace> sp,
+    TwoBodyTruncation truncation)
+    : sp_(std::move(sp)),
+      truncation_(truncation),
+      pair_keys_(
+          sp_->NumOrbitals() * sp_->NumOrbitals(),
+          OrbitalPairKey::Invalid()),
+      family_pairs_(kNumFamilies) {
+  const std::size_t norb = sp_->NumOrbitals();
+  for (const auto a : sp_->OrbitalIndices()) {
+    const PackedOrbital oa = sp_->Orbital(a);
+    for (std::size_t b = a.idx(); b < norb; b += 1) {
+      const PackedOrbital ob = sp_->Orbital(b);
+      if (oa.E() + ob.E() > truncation_.e2max) {
+        continue;
+      }
+      auto& family = family_pairs_[FamilyOf(
+          (oa.Parity() + ob.Parity()) % 2,
+          oa.TwoTz() + ob.TwoTz())];
+      pair_keys_[a.idx() * norb + b] = family.size();
+      family.push_back(
+          {static_cast<std::uint16_t>(a.idx()),
+           static_cast<std::uint16_t>(b)});
+    }
+  }
+
+  channel_qns_ = MakeChannels(*sp_, family_pairs_);
+  channel_lookup_ =
+      IndexConversion<ChannelKey, TwoBodyChannelIndex>(
+          MakeChannelKeys(channel_qns_));
+  channel_flags_ = std::make_unique<std::once_flag[]>(channel_qns_.size());
+  channel_built_ =
+      std::make_unique<std::atomic<bool>[]>(channel_qns_.size());
+  channels_.resize(channel_qns_.size());
+}
+
+const TwoBodyChannel& TwoBodyModelSpace::Channel(
+    TwoBodyChannelIndex ch) const {
+  std::call_once(channel_flags_[ch.idx()], [this, ch]() {
+    channels_[ch.idx()] = std::make_unique<TwoBodyChannel>(BuildChannel(ch));
+    channel_built_[ch.idx()].store(true, std::memory_order_release);
+  });
+  return *channels_[ch.idx()];
+}
+
+bool TwoBodyModelSpace::IsChannelBuilt(TwoBodyChannelIndex ch) const {
+  return channel_built_[ch.idx()].load(std::memory_order_acquire);
+}
+
+void TwoBodyModelSpace::BuildAllChannels() const {
+  const std::ptrdiff_t num_channels =
+      static_cast<std::ptrdiff_t>(channel_qns_.size());
+#pragma omp parallel for schedule(dynamic) num_threads(NumParallelThreads())
+  for (std::ptrdiff_t ch = 0; ch < num_channels; ch += 1) {
+    Channel(static_cast<std::size_t>(ch));
+  }
+}
+
+bool TwoBodyModelSpace::CheckChannelPairs(
+    TwoBodyChannelIndex ch,
+    const std::vector<OrbitalPair>& pairs) const {
+  std::vector<OrbitalPairKey> keys;
+  return ChannelPairKeys(ch, pairs, keys);
+}
+
+bool TwoBodyModelSpace::PrimeChannel(
+    TwoBodyChannelIndex ch,
+    std::vector<OrbitalPair>&& pairs) const {
+  std::vector<OrbitalPairKey> keys;
+  if (IsChannelBuilt(ch) || !ChannelPairKeys(ch, pairs, keys)) {
+    return false;
+  }
+
+  bool primed = false;
+  std::call_once(channel_flags_[ch.idx()], [&]() {
+    channels_[ch.idx()] = std::make_unique<TwoBodyChannel>(
+        channel_qns_[ch.idx()],
+        std::move(pairs),
+        std::move(keys),
+        *sp_);
+    channel_built_[ch.idx()].store(true, std::memory_order_release);
+    primed = true;
+  });
+  return primed;
+}
+
+bool TwoBodyModelSpace::ChannelPairKeys(
+    TwoBodyChannelIndex ch,
+    const std::vector<OrbitalPair>& pairs,
+    std::vector<OrbitalPairKey>& keys) const {
+  const std::size_t norb = sp_->NumOrbitals();
+  const PackedChannel qn = channel_qns_[ch.idx()];
+  // Identical orbitals only couple to even J.
+  const bool odd_j = (qn.TwoJ() / 2) % 2 == 1;
+  keys.clear();
+  keys.reserve(pairs.size());
+  for (const auto& p : pairs) {
+    if (p.a > p.b || p.b >= norb || (odd_j && p.a == p.b) ||
+        !CouplesTo(sp_->Orbital(p.a), sp_->Orbital(p.b), qn)) {
+      return false;
+    }
+    const OrbitalPairKey key = pair_keys_[p.a * norb + p.b];
+    if (key == OrbitalPairKey::Invalid() ||
+        (!keys.empty() && !(keys.back() < key))) {
+      return false;
+    }
+    keys.push_back(key);
+  }
+  return true;
+}
+
+TwoBodyChannel TwoBodyModelSpace::BuildChannel(
+    TwoBodyChannelIndex ch) const {
+  const PackedChannel qn = channel_qns_[ch.idx()];
+  const auto& family = family_pairs_[FamilyOf(qn.Parity(), qn.TwoTz())];
+
+  std::vector<PackedOrbital> first(family.size());
+  std::vector<PackedOrbital> second(family.size());
+  for (std::size_t i = 0; i < family.size(); i += 1) {
+    first[i] = sp_->Orbital(family[i].a);
+    second[i] = sp_->Orbital(family[i].b);
+  }
+  std::vector<std::uint8_t> mask(family.size());
+  const std::size_t count = MaskTwoBodyChannel(
+      first.data(),
+      second.data(),
+      family.size(),
+      qn,
+      truncation_.e2max,
+      mask.data());
+
+  // Identical orbitals only couple to even J.
+  const bool odd_j = (qn.TwoJ() / 2) % 2 == 1;
+
+  std::vector<OrbitalPair> pairs;
+  std::vector<OrbitalPairKey> keys;
+  pairs.reserve(count);
+  keys.reserve(count);
+  for (std::size_t i = 0; i < family.size(); i += 1) {
+    if (mask[i] && !(odd_j && family[i].a == family[i].b)) {
+      pairs.push_back(family[i]);
+      keys.push_back(i);
+    }
+  }
+
+  return TwoBodyChannel(qn, std::move(pairs), std::move(keys), *sp_);
+}
+
+std::size_t TwoBodyModelSpace::MemoryLoad() const {
+  std::size_t load = pair_keys_.size() * sizeof(OrbitalPairKey) +
+                     channel_qns_.size() * sizeof(PackedChannel) +
+                     channel_lookup_.MemoryLoad() +
+                     channels_.size() * sizeof(std::unique_ptr<TwoBodyChannel>);
+  for (const auto& family : family_pairs_) {
+    load += family.size() * sizeof(OrbitalPair);
+  }
+  for (const auto ch : ChannelIndices()) {
+    if (IsChannelBuilt(ch)) {
+      load += sizeof(TwoBodyChannel) + channels_[ch.idx()]->MemoryLoad();
+    }
+  }
+  return load;
+}
+
+}  // namespace nui
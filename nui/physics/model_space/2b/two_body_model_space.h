@@ -0,0 +1,204 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_MODEL_SPACE_2B_TWO_BODY_MODEL_SPACE_H_
+#define NUI_PHYSICS_MODEL_SPACE_2B_TWO_BODY_MODEL_SPACE_H_
+
+// IWYU pragma: private, include "nui/physics/model_space/2b/model_space_2b.h"
+// IWYU pragma: friend "nui/physics/model_space/2b/.*\.h"
+
+#include <atomic>
+#include <mutex>
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/indexing/indexing.h"
+#include "nui/physics/model_space/2b/two_body_channel.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/quantum_numbers/quantum_numbers.h"
+
+namespace nui {
+class TwoBodyChannelIndex;
+}  // namespace nui
+
+// Index of a channel in a two-body model space.
+NUI_MAKE_INDEX_TYPE(TwoBodyChannelIndex);
+
+namespace nui {
+
+// Truncation of the two-body basis.
+struct TwoBodyTruncation {
+  // Maximum e_a + e_b.
+  int e2max = 0;
+};
+
+// Compare two truncations.
+inline bool operator==(const TwoBodyTruncation& a, const TwoBodyTruncation& b) {
+  return a.e2max == b.e2max;
+}
+
+// Compare two truncations.
+inline bool operator!=(const TwoBodyTruncation& a, const TwoBodyTruncation& b) {
+  return !(a == b);
+}
+
+// J-scheme two-body model space.
+//
+// Channel quantum numbers are known at construction, but the states of each
+// channel are only enumerated on first access via Channel(). This is
+// thread-safe, concurrent first accesses build a channel exactly once.
+//
+// Pairs (a <= b) of the same parity and Tz share a dense OrbitalPairKey
+// numbering, which channels use as input to their IndexConversion.
+//
+// Model spaces are interned: Make() returns the same instance for equal
+// single-particle model spaces and truncations as long as any user holds it.
+class TwoBodyModelSpace {
+ public:
+  // Get shared model space for sp and truncation.
+  static std::shared_ptr<const TwoBodyModelSpace> Make(
+      std::shared_ptr<const SPModelSpace> sp,
+      TwoBodyTruncation truncation);
+
+  // Get shared model space for sp with e2max = 2 * emax.
+  static std::shared_ptr<const TwoBodyModelSpace> Make(
+      std::shared_ptr<const SPModelSpace> sp);
+
+  // Construct model space. Prefer Make(), which interns instances.
+  TwoBodyModelSpace(
+      std::shared_ptr<const SPModelSpace> sp,
+      TwoBodyTruncation truncation);
+
+  TwoBodyModelSpace(const TwoBodyModelSpace&) = delete;
+  TwoBodyModelSpace& operator=(const TwoBodyModelSpace&) = delete;
+
+  // Get single-particle model space.
+  const SPModelSpace& SP() const { return *sp_; }
+
+  // Get shared single-particle model space.
+  const std::shared_ptr<const SPModelSpace>& SPShared() const { return sp_; }
+
+  // Get truncation.
+  const TwoBodyTruncation& Truncation() const { return truncation_; }
+
+  // Get number of channels.
+  std::size_t NumChannels() const { return channel_qns_.size(); }
+
+  // Get range of channel indices.
+  IndexRange<TwoBodyChannelIndex> ChannelIndices() const {
+    return IndexRange<TwoBodyChannelIndex>(channel_qns_.size());
+  }
+
+  // Get channel quantum numbers (does not build channel).
+  PackedChannel ChannelQuantumNumbers(TwoBodyChannelIndex ch) const {
+    return channel_qns_[ch.idx()];
+  }
+
+  // Get index of channel.
+  //
+  // Returns TwoBodyChannelIndex::Invalid() if channel is not in model space.
+  TwoBodyChannelIndex ChannelIndex(PackedChannel qn) const {
+    return channel_lookup_.ConvertSafe(qn.Key());
+  }
+
+  // Get channel, building it on first access.
+  const TwoBodyChannel& Channel(TwoBodyChannelIndex ch) const;
+
+  // Check if channel has already been built.
+  bool IsChannelBuilt(TwoBodyChannelIndex ch) const;
+
+  // Build all channels (in parallel).
+  void BuildAllChannels() const;
+
+  // Check if pairs are valid prebuilt states of channel (see PrimeChannel).
+  bool CheckChannelPairs(
+      TwoBodyChannelIndex ch,
+      const std::vector<OrbitalPair>& pairs) const;
+
+  // Install prebuilt states of channel (e.g., loaded from a cache).
+  //
+  // pairs must be sorted in pair key order, as produced by Channel().
+  // Returns false (and leaves the channel untouched) if pairs are invalid for
+  // this model space, do not couple to the channel, or the channel has
+  // already been built.
+  bool PrimeChannel(
+      TwoBodyChannelIndex ch,
+      std::vector<OrbitalPair>&& pairs) const;
+
+  // Get key of pair (a <= b).
+  //
+  // Returns OrbitalPairKey::Invalid() if pair violates the truncation.
+  OrbitalPairKey PairKey(OrbitalIndex a, OrbitalIndex b) const {
+    return pair_keys_[a.idx() * sp_->NumOrbitals() + b.idx()];
+  }
+
+  // Get index of state |ab; J> in channel (a <= b).
+  //
+  // Returns TwoBodyStateIndex::Invalid() if state is not in channel.
+  TwoBodyStateIndex StateIndex(
+      TwoBodyChannelIndex ch,
+      OrbitalIndex a,
+      OrbitalIndex b) const {
+    const OrbitalPairKey key = PairKey(a, b);
+    if (key == OrbitalPairKey::Invalid()) {
+      return TwoBodyStateIndex::Invalid();
+    }
+    // Keys are only unique within a (parity, Tz) family, so a pair of
+    // another family may alias a state of the channel.
+    const TwoBodyChannel& channel = Channel(ch);
+    const TwoBodyStateIndex i = channel.Index(key);
+    if (i == TwoBodyStateIndex::Invalid() || channel.First(i) != a ||
+        channel.Second(i) != b) {
+      return TwoBodyStateIndex::Invalid();
+    }
+    return i;
+  }
+
+  // Get size of model space (including built channels) in dynamic memory.
+  std::size_t MemoryLoad() const;
+
+ private:
+  TwoBodyChannel BuildChannel(TwoBodyChannelIndex ch) const;
+  // Check pairs of channel and get their keys.
+  bool ChannelPairKeys(
+      TwoBodyChannelIndex ch,
+      const std::vector<OrbitalPair>& pairs,
+      std::vector<OrbitalPairKey>& keys) const;
+
+  std::shared_ptr<const SPModelSpace> sp_;
+  TwoBodyTruncation truncation_;
+
+  // Pair keys for all (a, b), invalid for a > b.
+  std::vector<OrbitalPairKey> pair_keys_;
+  // Pairs by family (parity + 2 * (Tz + 1)).
+  std::vector<std::vector<OrbitalPair>> family_pairs_;
+
+  std::vector<PackedChannel> channel_qns_;
+  IndexConversion<ChannelKey, TwoBodyChannelIndex> channel_lookup_;
+
+  mutable std::unique_ptr<std::once_flag[]> channel_flags_;
+  mutable std::unique_ptr<std::atomic<bool>[]> channel_built_;
+  mutable std::vector<std::unique_ptr<TwoBodyChannel>> channels_;
+};
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_MODEL_SPACE_2B_TWO_BODY_MODEL_SPACE_H_
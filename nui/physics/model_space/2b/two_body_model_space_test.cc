@@ -0,0 +1,247 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/model_space/2b/two_body_model_space.h"
+
+#include <thread>
+
+#include "catch2/catch_test_macros.hpp"
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/quantum_numbers/quantum_numbers.h"
+
+using nui::OrbitalIndex;
+using nui::PackedChannel;
+using nui::Reference;
+using nui::SPModelSpace;
+using nui::SPTruncation;
+using nui::TwoBodyChannelIndex;
+using nui::TwoBodyModelSpace;
+using nui::TwoBodyStateIndex;
+
+inline std::shared_ptr<const SPModelSpace> MakeSP(int emax) {
+  return SPModelSpace::Make(
+      SPTruncation(emax),
+      Reference::HOEqualFilling(8, 8));
+}
+
+// Count states |ab; J> (a <= b) in channel by brute force.
+inline std::size_t CountStates(
+    const SPModelSpace& sp,
+    PackedChannel qn,
+    int e2max) {
+  std::size_t count = 0UL;
+  for (const auto a : sp.OrbitalIndices()) {
+    for (const auto b : sp.OrbitalIndices()) {
+      const auto oa = sp.Orbital(a);
+      const auto ob = sp.Orbital(b);
+      if (a > b || oa.E() + ob.E() > e2max) {
+        continue;
+      }
+      if ((oa.Parity() + ob.Parity()) % 2 != qn.Parity() ||
+          oa.TwoTz() + ob.TwoTz() != qn.TwoTz() ||
+          std::abs(oa.TwoJ() - ob.TwoJ()) > qn.TwoJ() ||
+          oa.TwoJ() + ob.TwoJ() < qn.TwoJ()) {
+        continue;
+      }
+      if (a == b && (qn.TwoJ() / 2) % 2 == 1) {
+        continue;
+      }
+      count += 1;
+    }
+  }
+  return count;
+}
+
+TEST_CASE("TwoBodyModelSpace, Test channel dimensions.") {
+  for (const int emax : {0, 2, 4}) {
+    for (const int e2max : {emax, 2 * emax}) {
+      const auto sp = MakeSP(emax);
+      const auto ms = TwoBodyModelSpace::Make(sp, {e2max});
+      std::size_t total = 0UL;
+      for (const auto ch : ms->ChannelIndices()) {
+        const auto qn = ms->ChannelQuantumNumbers(ch);
+        REQUIRE(ms->Channel(ch).Dimension() == CountStates(*sp, qn, e2max));
+        REQUIRE(ms->Channel(ch).QuantumNumbers() == qn);
+        REQUIRE(ms->ChannelIndex(qn) == ch);
+        total += ms->Channel(ch).Dimension();
+      }
+      REQUIRE(total > 0);
+    }
+  }
+}
+
+TEST_CASE("TwoBodyModelSpace, Test channels are built lazily.") {
+  const auto ms = TwoBodyModelSpace::Make(MakeSP(3), {5});
+  const std::size_t load_before = ms->MemoryLoad();
+  for (const auto ch : ms->ChannelIndices()) {
+    REQUIRE_FALSE(ms->IsChannelBuilt(ch));
+  }
+  const TwoBodyChannelIndex ch = ms->ChannelIndex(PackedChannel(2, 0, 0));
+  REQUIRE(ch != TwoBodyChannelIndex::Invalid());
+  const auto& channel = ms->Channel(ch);
+  REQUIRE(ms->IsChannelBuilt(ch));
+  REQUIRE(&ms->Channel(ch) == &channel);
+  REQUIRE(ms->MemoryLoad() > load_before);
+
+  ms->BuildAllChannels();
+  for (const auto c : ms->ChannelIndices()) {
+    REQUIRE(ms->IsChannelBuilt(c));
+  }
+}
+
+TEST_CASE("TwoBodyModelSpace, Test concurrent channel access.") {
+  const auto ms = TwoBodyModelSpace::Make(MakeSP(4), {8});
+  std::vector<std::thread> threads;
+  std::vector<std::size_t> dims(4, 0UL);
+  for (std::size_t t = 0; t < dims.size(); t += 1) {
+    threads.emplace_back([&ms, &dims, t]() {
+      for (const auto ch : ms->ChannelIndices()) {
+        dims[t] += ms->Channel(ch).Dimension();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (const auto dim : dims) {
+    REQUIRE(dim == dims[0]);
+  }
+}
+
+TEST_CASE("TwoBodyModelSpace, Test state lookups.") {
+  const auto ms = TwoBodyModelSpace::Make(MakeSP(3));
+  for (const auto ch : ms->ChannelIndices()) {
+    const auto& channel = ms->Channel(ch);
+    for (const auto i : channel.StateIndices()) {
+      const OrbitalIndex a = channel.First(i);
+      const OrbitalIndex b = channel.Second(i);
+      REQUIRE(a <= b);
+      REQUIRE(ms->StateIndex(ch, a, b) == i);
+    }
+    // Pairs of other channels are not found.
+    std::size_t num_found = 0;
+    for (const auto a : ms->SP().OrbitalIndices()) {
+      for (const auto b : ms->SP().OrbitalIndices()) {
+        if (a <= b &&
+            ms->StateIndex(ch, a, b) != TwoBodyStateIndex::Invalid()) {
+          num_found += 1;
+        }
+      }
+    }
+    REQUIRE(num_found == channel.Dimension());
+  }
+  const TwoBodyChannelIndex ch = ms->ChannelIndex(PackedChannel(2, 0, 2));
+  const OrbitalIndex s12 = ms->SP().Index(nui::PackedOrbital(0, 0, 1, 1));
+  REQUIRE(ms->StateIndex(ch, s12, s12) == TwoBodyStateIndex::Invalid());
+}
+
+TEST_CASE("TwoBodyModelSpace, Test occupation classes.") {
+  const auto ms = TwoBodyModelSpace::Make(MakeSP(2));
+  const auto& sp = ms->SP();
+  for (const auto ch : ms->ChannelIndices()) {
+    const auto& channel = ms->Channel(ch);
+    REQUIRE(
+        channel.HoleHoleStates().size() + channel.ParticleHoleStates().size() +
+            channel.ParticleParticleStates().size() ==
+        channel.Dimension());
+    for (const auto i : channel.HoleHoleStates()) {
+      REQUIRE(sp.Occupation(channel.First(i)) == 1.0);
+      REQUIRE(sp.Occupation(channel.Second(i)) == 1.0);
+      REQUIRE(channel.Occupation(i) == nui::kOccupationHH);
+    }
+    for (const auto i : channel.ParticleHoleStates()) {
+      REQUIRE(
+          sp.Occupation(channel.First(i)) + sp.Occupation(channel.Second(i)) ==
+          1.0);
+      REQUIRE(channel.Occupation(i) == nui::kOccupationPH);
+    }
+    for (const auto i : channel.ParticleParticleStates()) {
+      REQUIRE(sp.Occupation(channel.First(i)) == 0.0);
+      REQUIRE(sp.Occupation(channel.Second(i)) == 0.0);
+      REQUIRE(channel.Occupation(i) == nui::kOccupationPP);
+    }
+  }
+}
+
+TEST_CASE("TwoBodyModelSpace, Test interning.") {
+  const auto sp = MakeSP(2);
+  const auto ms_a = TwoBodyModelSpace::Make(sp, {4});
+  const auto ms_b = TwoBodyModelSpace::Make(sp, {4});
+  const auto ms_c = TwoBodyModelSpace::Make(MakeSP(2), {4});
+  const auto ms_d = TwoBodyModelSpace::Make(sp, {3});
+  const auto ms_e = TwoBodyModelSpace::Make(
+      SPModelSpace::Make(SPTruncation(2), Reference()),
+      {4});
+  REQUIRE(ms_a.get() == ms_b.get());
+  REQUIRE(ms_a.get() == ms_c.get());
+  REQUIRE(ms_a.get() != ms_d.get());
+  REQUIRE(ms_a.get() != ms_e.get());
+}
+
+TEST_CASE("TwoBodyModelSpace, Test interning does not hold spaces.") {
+  std::weak_ptr<const SPModelSpace> weak_sp;
+  std::weak_ptr<const TwoBodyModelSpace> weak_ms;
+  {
+    const auto sp = SPModelSpace::Make(SPTruncation(3), Reference());
+    const auto ms = TwoBodyModelSpace::Make(sp, {5});
+    weak_sp = sp;
+    weak_ms = ms;
+  }
+  REQUIRE(weak_ms.expired());
+  REQUIRE(weak_sp.expired());
+}
+
+TEST_CASE("TwoBodyModelSpace, Test priming checks coupling.") {
+  const auto sp = MakeSP(2);
+  const auto built = std::make_shared<const TwoBodyModelSpace>(
+      sp,
+      nui::TwoBodyTruncation{4});
+  const auto primed = std::make_shared<const TwoBodyModelSpace>(
+      sp,
+      nui::TwoBodyTruncation{4});
+  const TwoBodyChannelIndex ch_0 = built->ChannelIndex(PackedChannel(0, 0, 0));
+  const TwoBodyChannelIndex ch_2 = built->ChannelIndex(PackedChannel(2, 0, 0));
+
+  // States of J = 2 have valid keys in the J = 0 family but do not couple.
+  std::vector<nui::OrbitalPair> pairs;
+  const auto& channel_2 = built->Channel(ch_2);
+  for (const auto i : channel_2.StateIndices()) {
+    pairs.push_back(
+        {static_cast<std::uint16_t>(channel_2.First(i).idx()),
+         static_cast<std::uint16_t>(channel_2.Second(i).idx())});
+  }
+  REQUIRE_FALSE(primed->PrimeChannel(ch_0, std::move(pairs)));
+  REQUIRE_FALSE(primed->IsChannelBuilt(ch_0));
+
+  pairs.clear();
+  const auto& channel_0 = built->Channel(ch_0);
+  for (const auto i : channel_0.StateIndices()) {
+    pairs.push_back(
+        {static_cast<std::uint16_t>(channel_0.First(i).idx()),
+         static_cast<std::uint16_t>(channel_0.Second(i).idx())});
+  }
+  REQUIRE(primed->PrimeChannel(ch_0, std::move(pairs)));
+  REQUIRE(primed->Channel(ch_0).Dimension() == channel_0.Dimension());
+}
@@ -0,0 +1,41 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/model_space/3b/three_body_channel.h"
+
+#include "nui/core/basics/basics.h"
+
+namespace nui {
+
+ThreeBodyStateIndex ThreeBodyChannel::Index(ThreeBodyState state) const {
+  const auto it = std::lower_bound(
+      states_.begin(),
+      states_.end(),
+      state,
+      [](ThreeBodyState x, ThreeBodyState y) { return x.Key() < y.Key(); });
+  if (it == states_.end() || *it != state) {
+    return ThreeBodyStateIndex::Invalid();
+  }
+  return static_cast<std::size_t>(it - states_.begin());
+}
+
+}  // namespace nui
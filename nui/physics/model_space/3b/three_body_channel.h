@@ -0,0 +1,140 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_MODEL_SPACE_3B_THREE_BODY_CHANNEL_H_
+#define NUI_PHYSICS_MODEL_SPACE_3B_THREE_BODY_CHANNEL_H_
+
+// IWYU pragma: private, include "nui/physics/model_space/3b/model_space_3b.h"
+// IWYU pragma: friend "nui/physics/model_space/3b/.*\.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/indexing/indexing.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/quantum_numbers/quantum_numbers.h"
+
+namespace nui {
+class ThreeBodyStateIndex;
+}  // namespace nui
+
+// Index of a three-body state within a channel.
+NUI_MAKE_INDEX_TYPE(ThreeBodyStateIndex);
+
+namespace nui {
+
+// Three-body state |(ab) J_ab, c; J> stored in 64 bits.
+//
+// Orbitals are canonically ordered (a <= b <= c) and J_ab is stored doubled.
+struct ThreeBodyState {
+  std::uint16_t a = 0;
+  std::uint16_t b = 0;
+  std::uint16_t c = 0;
+  std::uint16_t two_jab = 0;
+
+  // Get 64-bit sort key, ordering by a, b, c, and J_ab.
+  constexpr std::uint64_t Key() const noexcept {
+    return (static_cast<std::uint64_t>(a) << 48) |
+           (static_cast<std::uint64_t>(b) << 32) |
+           (static_cast<std::uint64_t>(c) << 16) |
+           static_cast<std::uint64_t>(two_jab);
+  }
+};
+
+// Compare two states.
+constexpr bool operator==(ThreeBodyState x, ThreeBodyState y) noexcept {
+  return x.Key() == y.Key();
+}
+
+// Compare two states.
+constexpr bool operator!=(ThreeBodyState x, ThreeBodyState y) noexcept {
+  return x.Key() != y.Key();
+}
+
+// Three-body J-scheme channel (J, parity, Tz).
+//
+// States are antisymmetrized, permutation-canonical triples
+// |(ab) J_ab, c; J> with a <= b <= c, sorted by (a, b, c, J_ab).
+// Pairs with a == b only appear for even J_ab.
+class ThreeBodyChannel {
+ public:
+  // Construct empty channel.
+  ThreeBodyChannel() {}
+
+  // Construct channel with (uninitialized) storage for dim states.
+  ThreeBodyChannel(PackedChannel qn, std::size_t dim)
+      : qn_(qn), states_(dim) {}
+
+  // Construct channel from sorted states.
+  ThreeBodyChannel(PackedChannel qn, std::vector<ThreeBodyState>&& states)
+      : qn_(qn), states_(std::move(states)) {}
+
+  // Get channel quantum numbers.
+  PackedChannel QuantumNumbers() const { return qn_; }
+
+  // Get number of states in channel.
+  std::size_t Dimension() const { return states_.size(); }
+
+  // Get range of state indices.
+  IndexRange<ThreeBodyStateIndex> StateIndices() const {
+    return IndexRange<ThreeBodyStateIndex>(states_.size());
+  }
+
+  // Get state.
+  ThreeBodyState State(ThreeBodyStateIndex i) const {
+    return states_[i.idx()];
+  }
+
+  // Get all states.
+  const std::vector<ThreeBodyState>& States() const { return states_; }
+
+  // Get mutable pointer to states for construction.
+  ThreeBodyState* MutableStates() { return states_.data(); }
+
+  // Get index of canonical state (a <= b <= c) via binary search.
+  //
+  // Returns ThreeBodyStateIndex::Invalid() if state is not in channel.
+  ThreeBodyStateIndex Index(ThreeBodyState state) const;
+
+  // Get size of channel in dynamic memory.
+  std::size_t MemoryLoad() const {
+    return states_.size() * sizeof(ThreeBodyState);
+  }
+
+  // Swap with other channel.
+  void swap(ThreeBodyChannel& other) noexcept {
+    using std::swap;
+    swap(qn_, other.qn_);
+    swap(states_, other.states_);
+  }
+
+ private:
+  PackedChannel qn_;
+  std::vector<ThreeBodyState> states_;
+};
+
+// Swap two channels.
+inline void swap(ThreeBodyChannel& a, ThreeBodyChannel& b) noexcept {
+  a.swap(b);
+}
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_MODEL_SPACE_3B_THREE_BODY_CHANNEL_H_
@@ -0,0 +1,341 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/model_space/3b/three_body_model_space.h"
+
+#include <array>
+#include <limits>
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/indexing/indexing.h"
+#include "nui/info/runtime/runtime.h"
+#include "nui/physics/model_space/3b/three_body_channel.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/quantum_numbers/quantum_numbers.h"
+
+namespace nui {
+
+namespace {
+
+// Dense slot of a three-body channel with odd 2J <= two_j_max.
+//
+// Slots are ordered like channel keys (by J, then Tz, then parity).
+std::size_t ChannelSlot(int two_j, int parity, int two_tz) {
+  return ((static_cast<std::size_t>(two_j) / 2) * 4 +
+          static_cast<std::size_t>((two_tz + 3) / 2)) *
+             2 +
+         static_cast<std::size_t>(parity);
+}
+
+PackedChannel ChannelFromSlot(std::size_t slot) {
+  const int parity = static_cast<int>(slot % 2);
+  const int two_tz = 2 * static_cast<int>((slot / 2) % 4) - 3;
+  const int two_j = 2 * static_cast<int>(slot / 8) + 1;
+  return PackedChannel(two_j, parity, two_tz);
+}
+
+// Check truncations of a triple other than e_a + e_b + e_c <= e3max.
+bool WithinLimits(
+    const SPModelSpace& sp,
+    const ThreeBodyTruncation& truncation,
+    OrbitalIndex a,
+    OrbitalIndex b,
+    OrbitalIndex c) {
+  const int emax = truncation.emax_per_particle;
+  if (sp.Orbital(a).E() > emax || sp.Orbital(b).E() > emax ||
+      sp.Orbital(c).E() > emax) {
+    return false;
+  }
+  const int num_particles =
+      sp.IsParticle(a) + sp.IsParticle(b) + sp.IsParticle(c);
+  const int num_holes = sp.IsHole(a) + sp.IsHole(b) + sp.IsHole(c);
+  return num_particles <= truncation.max_particles &&
+         num_holes <= truncation.max_holes;
+}
+
+bool AllowedTriple(
+    const SPModelSpace& sp,
+    const ThreeBodyTruncation& truncation,
+    OrbitalIndex a,
+    OrbitalIndex b,
+    OrbitalIndex c) {
+  return sp.Orbital(a).E() + sp.Orbital(b).E() + sp.Orbital(c).E() <=
+             truncation.e3max &&
+         WithinLimits(sp, truncation, a, b, c);
+}
+
+// Candidate states of one parity and Tz in (b, c, J_ab) order.
+struct CandidateStates {
+  std::vector<PackedOrbital> second;
+  std::vector<PackedOrbital> third;
+  std::vector<std::int32_t> two_jabs;
+  std::vector<ThreeBodyState> states;
+  int two_j_min = std::numeric_limits<int>::max();
+  int two_j_max = 0;
+};
+
+// Enumerate all canonical states with first orbital a.
+//
+// Triples are filtered by MaskEnergySum, and candidate states are grouped by
+// parity and Tz and split into channels by MaskThreeBodyChannel. Calls
+// f(slot, state) in (b, c, J_ab) order for each channel.
+template <typename F>
+void ForEachStateWithFirst(
+    const ThreeBodyModelSpace& ms,
+    OrbitalIndex a,
+    std::size_t num_slots,
+    F&& f) {
+  const SPModelSpace& sp = ms.SP();
+  const ThreeBodyTruncation& truncation = ms.Truncation();
+  const std::size_t norb = sp.NumOrbitals();
+  const PackedOrbital oa = sp.Orbital(a);
+  std::vector<PackedOrbital> first;
+  std::vector<PackedOrbital> second;
+  std::vector<std::uint8_t> mask;
+  // Groups are indexed like slots modulo 8, by Tz and parity.
+  std::array<CandidateStates, 8> groups;
+  for (std::size_t b = a.idx(); b < norb; b += 1) {
+    const PackedOrbital ob = sp.Orbital(b);
+    if (oa.E() + ob.E() > truncation.e3max) {
+      continue;
+    }
+
+    // Triples (a, b, c) with b <= c within the truncation.
+    const std::size_t num_c = norb - b;
+    first.assign(num_c, oa);
+    second.assign(num_c, ob);
+    mask.resize(num_c);
+    if (MaskEnergySum(
+            first.data(),
+            second.data(),
+            sp.Orbitals().data() + b,
+            num_c,
+            truncation.e3max,
+            mask.data()) == 0) {
+      continue;
+    }
+    for (std::size_t c = b; c < norb; c += 1) {
+      if (!mask[c - b] || !WithinLimits(sp, truncation, a, b, c)) {
+        continue;
+      }
+      const PackedOrbital oc = sp.Orbital(c);
+      const int parity = (oa.L() + ob.L() + oc.L()) % 2;
+      const int two_tz = oa.TwoTz() + ob.TwoTz() + oc.TwoTz();
+      CandidateStates& group = groups[ChannelSlot(1, parity, two_tz)];
+      const int two_jab_min = std::abs(oa.TwoJ() - ob.TwoJ());
+      const int two_jab_max = oa.TwoJ() + ob.TwoJ();
+      for (int two_jab = two_jab_min; two_jab <= two_jab_max;
+           two_jab += 2) {
+        if (a == b && (two_jab / 2) % 2 == 1) {
+          continue;
+        }
+        group.second.push_back(ob);
+        group.third.push_back(oc);
+        group.two_jabs.push_back(two_jab);
+        group.states.push_back(
+            {static_cast<std::uint16_t>(a.idx()),
+             static_cast<std::uint16_t>(b),
+             static_cast<std::uint16_t>(c),
+             static_cast<std::uint16_t>(two_jab)});
+        group.two_j_min =
+            std::min(group.two_j_min, std::abs(two_jab - oc.TwoJ()));
+        group.two_j_max = std::max(group.two_j_max, two_jab + oc.TwoJ());
+      }
+    }
+  }
+
+  for (std::size_t g = 0; g < groups.size(); g += 1) {
+    const CandidateStates& group = groups[g];
+    const std::size_t n = group.states.size();
+    if (n == 0) {
+      continue;
+    }
+    first.assign(n, oa);
+    mask.resize(n);
+    const std::size_t end =
+        std::min(num_slots, ChannelSlot(group.two_j_max, 1, 3) + 1);
+    for (std::size_t slot = ChannelSlot(group.two_j_min, 0, -3) + g;
+         slot < end;
+         slot += groups.size()) {
+      const std::size_t count = MaskThreeBodyChannel(
+          first.data(),
+          group.second.data(),
+          group.third.data(),
+          group.two_jabs.data(),
+          n,
+          ChannelFromSlot(slot),
+          truncation.e3max,
+          mask.data());
+      for (std::size_t i = 0; count > 0 && i < n; i += 1) {
+        if (mask[i]) {
+          f(slot, group.states[i]);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace
+
+std::shared_ptr<const ThreeBodyModelSpace> ThreeBodyModelSpace::Make(
+    std::shared_ptr<const SPModelSpace> sp,
+    ThreeBodyTruncation truncation) {
+  return std::make_shared<const ThreeBodyModelSpace>(
+      std::move(sp),
+      truncation);
+}
+
+ThreeBodyModelSpace::ThreeBodyModelSpace(
+    std::shared_ptr<const SPModelSpace> sp,
+    ThreeBodyTruncation truncation)
+    : sp_(std::move(sp)), truncation_(truncation) {
+  Build();
+  BuildLookup();
+}
+
+ThreeBodyModelSpace::ThreeBodyModelSpace(
+    std::shared_ptr<const SPModelSpace> sp,
+    ThreeBodyTruncation truncation,
+    std::vector<ThreeBodyChannel>&& channels)
+    : sp_(std::move(sp)),
+      truncation_(truncation),
+      channels_(std::move(channels)) {
+  BuildLookup();
+}
+
+bool ThreeBodyModelSpace::IsAllowedTriple(
+    OrbitalIndex a,
+    OrbitalIndex b,
+    OrbitalIndex c) const {
+  return AllowedTriple(*sp_, truncation_, a, b, c);
+}
+
+bool ThreeBodyModelSpace::IsAllowedState(
+    const SPModelSpace& sp,
+    const ThreeBodyTruncation& truncation,
+    PackedChannel qn,
+    ThreeBodyState state) {
+  if (state.a > state.b || state.b > state.c ||
+      state.c >= sp.NumOrbitals() ||
+      (state.a == state.b && (state.two_jab / 2) % 2 == 1) ||
+      !AllowedTriple(sp, truncation, state.a, state.b, state.c)) {
+    return false;
+  }
+  const PackedOrbital oa = sp.Orbital(state.a);
+  const PackedOrbital ob = sp.Orbital(state.b);
+  const PackedOrbital oc = sp.Orbital(state.c);
+  const int two_jab = state.two_jab;
+  return two_jab % 2 == 0 && std::abs(oa.TwoJ() - ob.TwoJ()) <= two_jab &&
+         two_jab <= oa.TwoJ() + ob.TwoJ() &&
+         std::abs(two_jab - oc.TwoJ()) <= qn.TwoJ() &&
+         qn.TwoJ() <= two_jab + oc.TwoJ() &&
+         (oa.L() + ob.L() + oc.L()) % 2 == qn.Parity() &&
+         oa.TwoTz() + ob.TwoTz() + oc.TwoTz() == qn.TwoTz();
+}
+
+void ThreeBodyModelSpace::Build() {
+  const std::size_t norb = sp_->NumOrbitals();
+  int two_j_max_orbital = 0;
+  for (const auto& o : sp_->Orbitals()) {
+    two_j_max_orbital = std::max(two_j_max_orbital, o.TwoJ());
+  }
+  const std::size_t num_slots = ChannelSlot(3 * two_j_max_orbital, 1, 3) + 1;
+  const std::ptrdiff_t num_first = static_cast<std::ptrdiff_t>(norb);
+
+  // Phase 1: count states per (a, slot).
+  std::vector<std::size_t> offsets(norb * num_slots, 0UL);
+#pragma omp parallel for schedule(dynamic) num_threads(NumParallelThreads())
+  for (std::ptrdiff_t a = 0; a < num_first; a += 1) {
+    std::size_t* counts = offsets.data() + a * num_slots;
+    ForEachStateWithFirst(
+        *this,
+        static_cast<std::size_t>(a),
+        num_slots,
+        [counts](std::size_t slot, ThreeBodyState) { counts[slot] += 1; });
+  }
+
+  // Phase 2: exclusive prefix sums over a for each slot, then allocate.
+  std::vector<std::size_t> slot_dims(num_slots, 0UL);
+  for (std::size_t a = 0; a < norb; a += 1) {
+    for (std::size_t slot = 0; slot < num_slots; slot += 1) {
+      const std::size_t count = offsets[a * num_slots + slot];
+      offsets[a * num_slots + slot] = slot_dims[slot];
+      slot_dims[slot] += count;
+    }
+  }
+  std::vector<std::size_t> slot_channels(num_slots, SIZE_MAX);
+  for (std::size_t slot = 0; slot < num_slots; slot += 1) {
+    if (slot_dims[slot] > 0) {
+      slot_channels[slot] = channels_.size();
+      channels_.emplace_back(ChannelFromSlot(slot), slot_dims[slot]);
+    }
+  }
+  scratch_load_ = (offsets.size() + slot_dims.size() + slot_channels.size()) *
+                  sizeof(std::size_t);
+
+  // Phase 3: fill states at their final positions.
+#pragma omp parallel for schedule(dynamic) num_threads(NumParallelThreads())
+  for (std::ptrdiff_t a = 0; a < num_first; a += 1) {
+    std::size_t* positions = offsets.data() + a * num_slots;
+    ForEachStateWithFirst(
+        *this,
+        static_cast<std::size_t>(a),
+        num_slots,
+        [this, positions, &slot_channels](
+            std::size_t slot,
+            ThreeBodyState state) {
+          ThreeBodyState* states =
+              channels_[slot_channels[slot]].MutableStates();
+          states[positions[slot]] = state;
+          positions[slot] += 1;
+        });
+  }
+}
+
+void ThreeBodyModelSpace::BuildLookup() {
+  std::vector<ChannelKey> keys;
+  keys.reserve(channels_.size());
+  for (const auto& channel : channels_) {
+    keys.push_back(channel.QuantumNumbers().Key());
+  }
+  channel_lookup_ =
+      IndexConversion<ChannelKey, ThreeBodyChannelIndex>(std::move(keys));
+}
+
+std::size_t ThreeBodyModelSpace::NumStates() const {
+  std::size_t num = 0UL;
+  for (const auto& channel : channels_) {
+    num += channel.Dimension();
+  }
+  return num;
+}
+
+std::size_t ThreeBodyModelSpace::MemoryLoad() const {
+  std::size_t load = channels_.size() * sizeof(ThreeBodyChannel) +
+                     channel_lookup_.MemoryLoad();
+  for (const auto& channel : channels_) {
+    load += channel.MemoryLoad();
+  }
+  return load;
+}
+
+}  // namespace nui
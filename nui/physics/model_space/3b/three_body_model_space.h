@@ -0,0 +1,173 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_MODEL_SPACE_3B_THREE_BODY_MODEL_SPACE_H_
+#define NUI_PHYSICS_MODEL_SPACE_3B_THREE_BODY_MODEL_SPACE_H_
+
+// IWYU pragma: private, include "nui/physics/model_space/3b/model_space_3b.h"
+// IWYU pragma: friend "nui/physics/model_space/3b/.*\.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/indexing/indexing.h"
+#include "nui/physics/model_space/3b/three_body_channel.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/quantum_numbers/quantum_numbers.h"
+
+namespace nui {
+class ThreeBodyChannelIndex;
+}  // namespace nui
+
+// Index of a channel in a three-body model space.
+NUI_MAKE_INDEX_TYPE(ThreeBodyChannelIndex);
+
+namespace nui {
+
+// Truncation of the three-body basis.
+struct ThreeBodyTruncation {
+  // Construct truncation with only e_a + e_b + e_c <= e3max.
+  explicit ThreeBodyTruncation(int e3max_in) : e3max(e3max_in) {}
+
+  // Maximum e_a + e_b + e_c.
+  int e3max = 0;
+  // Maximum e of each orbital in a triple.
+  int emax_per_particle = 1000;
+  // Maximum number of particle orbitals (occupation < 1) in a triple.
+  int max_particles = 3;
+  // Maximum number of hole orbitals (occupation > 0) in a triple.
+  int max_holes = 3;
+};
+
+// Compare two truncations.
+inline bool operator==(
+    const ThreeBodyTruncation& a,
+    const ThreeBodyTruncation& b) {
+  return a.e3max == b.e3max && a.emax_per_particle == b.emax_per_particle &&
+         a.max_particles == b.max_particles && a.max_holes == b.max_holes;
+}
+
+// Compare two truncations.
+inline bool operator!=(
+    const ThreeBodyTruncation& a,
+    const ThreeBodyTruncation& b) {
+  return !(a == b);
+}
+
+// J-scheme three-body model space.
+//
+// Construction runs in three phases, each parallelized over the first orbital
+// a of the canonical triples (a <= b <= c):
+//
+// 1. Count states per (a, channel) without storing them.
+// 2. Turn counts into per-(a, channel) offsets and allocate every channel
+//    exactly once.
+// 3. Enumerate again and write each state directly to its final position.
+//
+// The full unfiltered candidate list is never materialized, so peak memory is
+// the final state storage plus the (a, channel) count table. The result does
+// not depend on the number of threads.
+class ThreeBodyModelSpace {
+ public:
+  // Construct shared model space.
+  static std::shared_ptr<const ThreeBodyModelSpace> Make(
+      std::shared_ptr<const SPModelSpace> sp,
+      ThreeBodyTruncation truncation);
+
+  // Construct model space. Prefer Make().
+  ThreeBodyModelSpace(
+      std::shared_ptr<const SPModelSpace> sp,
+      ThreeBodyTruncation truncation);
+
+  // Construct model space from prebuilt channels.
+  ThreeBodyModelSpace(
+      std::shared_ptr<const SPModelSpace> sp,
+      ThreeBodyTruncation truncation,
+      std::vector<ThreeBodyChannel>&& channels);
+
+  ThreeBodyModelSpace(const ThreeBodyModelSpace&) = delete;
+  ThreeBodyModelSpace& operator=(const ThreeBodyModelSpace&) = delete;
+
+  // Get single-particle model space.
+  const SPModelSpace& SP() const { return *sp_; }
+
+  // Get shared single-particle model space.
+  const std::shared_ptr<const SPModelSpace>& SPShared() const { return sp_; }
+
+  // Get truncation.
+  const ThreeBodyTruncation& Truncation() const { return truncation_; }
+
+  // Check if triple (a, b, c) passes the truncation.
+  bool IsAllowedTriple(OrbitalIndex a, OrbitalIndex b, OrbitalIndex c) const;
+
+  // Check if state is a canonical state of channel qn in the model space of
+  // sp and truncation (e.g., for states loaded from a cache).
+  //
+  // Checks orbital ranges and order (a <= b <= c), even J_ab for a == b,
+  // both angular momentum couplings, parity, Tz, and the truncation.
+  static bool IsAllowedState(
+      const SPModelSpace& sp,
+      const ThreeBodyTruncation& truncation,
+      PackedChannel qn,
+      ThreeBodyState state);
+
+  // Get number of (nonempty) channels.
+  std::size_t NumChannels() const { return channels_.size(); }
+
+  // Get range of channel indices.
+  IndexRange<ThreeBodyChannelIndex> ChannelIndices() const {
+    return IndexRange<ThreeBodyChannelIndex>(channels_.size());
+  }
+
+  // Get channel.
+  const ThreeBodyChannel& Channel(ThreeBodyChannelIndex ch) const {
+    return channels_[ch.idx()];
+  }
+
+  // Get index of channel.
+  //
+  // Returns ThreeBodyChannelIndex::Invalid() if channel is not in model space.
+  ThreeBodyChannelIndex ChannelIndex(PackedChannel qn) const {
+    return channel_lookup_.ConvertSafe(qn.Key());
+  }
+
+  // Get total number of states in all channels.
+  std::size_t NumStates() const;
+
+  // Get size of model space in dynamic memory.
+  std::size_t MemoryLoad() const;
+
+  // Get size of scratch memory used during construction.
+  std::size_t ConstructionScratchLoad() const { return scratch_load_; }
+
+ private:
+  void Build();
+  void BuildLookup();
+
+  std::shared_ptr<const SPModelSpace> sp_;
+  ThreeBodyTruncation truncation_;
+  std::vector<ThreeBodyChannel> channels_;
+  IndexConversion<ChannelKey, ThreeBodyChannelIndex> channel_lookup_;
+  std::size_t scratch_load_ = 0UL;
+};
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_MODEL_SPACE_3B_THREE_BODY_MODEL_SPACE_H_
@@ -0,0 +1,151 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/model_space/3b/three_body_model_space.h"
+
+#include <map>
+
+#include "catch2/catch_test_macros.hpp"
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/quantum_numbers/quantum_numbers.h"
+
+using nui::PackedChannel;
+using nui::Reference;
+using nui::SPModelSpace;
+using nui::SPTruncation;
+using nui::ThreeBodyChannelIndex;
+using nui::ThreeBodyModelSpace;
+using nui::ThreeBodyState;
+using nui::ThreeBodyStateIndex;
+using nui::ThreeBodyTruncation;
+
+// Count states per channel key by naive nested loops.
+inline std::map<std::uint32_t, std::size_t> CountStates(
+    const ThreeBodyModelSpace& ms) {
+  const auto& sp = ms.SP();
+  std::map<std::uint32_t, std::size_t> counts;
+  for (const auto a : sp.OrbitalIndices()) {
+    for (const auto b : sp.OrbitalIndices()) {
+      for (const auto c : sp.OrbitalIndices()) {
+        if (a > b || b > c || !ms.IsAllowedTriple(a, b, c)) {
+          continue;
+        }
+        const auto oa = sp.Orbital(a);
+        const auto ob = sp.Orbital(b);
+        const auto oc = sp.Orbital(c);
+        for (int two_jab = std::abs(oa.TwoJ() - ob.TwoJ());
+             two_jab <= oa.TwoJ() + ob.TwoJ();
+             two_jab += 2) {
+          if (a == b && (two_jab / 2) % 2 == 1) {
+            continue;
+          }
+          for (int two_j = std::abs(two_jab - oc.TwoJ());
+               two_j <= two_jab + oc.TwoJ();
+               two_j += 2) {
+            const PackedChannel qn(
+                two_j,
+                (oa.L() + ob.L() + oc.L()) % 2,
+                oa.TwoTz() + ob.TwoTz() + oc.TwoTz());
+            counts[qn.Word()] += 1;
+          }
+        }
+      }
+    }
+  }
+  return counts;
+}
+
+inline void RequireMatchesNaiveCount(const ThreeBodyModelSpace& ms) {
+  const auto counts = CountStates(ms);
+  REQUIRE(counts.size() == ms.NumChannels());
+  std::size_t total = 0UL;
+  for (const auto& [word, count] : counts) {
+    const auto qn = PackedChannel::FromKey(word);
+    const ThreeBodyChannelIndex ch = ms.ChannelIndex(qn);
+    REQUIRE(ch != ThreeBodyChannelIndex::Invalid());
+    REQUIRE(ms.Channel(ch).QuantumNumbers() == qn);
+    REQUIRE(ms.Channel(ch).Dimension() == count);
+    total += count;
+  }
+  REQUIRE(ms.NumStates() == total);
+}
+
+TEST_CASE("ThreeBodyModelSpace, Test channel dimensions.") {
+  for (const int emax : {0, 1, 2, 3}) {
+    const auto sp =
+        SPModelSpace::Make(SPTruncation(emax), Reference::HOEqualFilling(2, 2));
+    for (const int e3max : {emax, 2 * emax, 3 * emax}) {
+      const auto ms = ThreeBodyModelSpace::Make(sp, ThreeBodyTruncation(e3max));
+      RequireMatchesNaiveCount(*ms);
+      REQUIRE(ms->MemoryLoad() > 0);
+    }
+  }
+}
+
+TEST_CASE("ThreeBodyModelSpace, Test additional truncations.") {
+  const auto sp =
+      SPModelSpace::Make(SPTruncation(3), Reference::HOEqualFilling(8, 8));
+  ThreeBodyTruncation truncation(7);
+  SECTION("emax per particle") {
+    truncation.emax_per_particle = 2;
+  }
+  SECTION("max particles") {
+    truncation.max_particles = 1;
+  }
+  SECTION("max holes") {
+    truncation.max_holes = 0;
+  }
+  const auto ms = ThreeBodyModelSpace::Make(sp, truncation);
+  const auto ms_full = ThreeBodyModelSpace::Make(sp, ThreeBodyTruncation(7));
+  RequireMatchesNaiveCount(*ms);
+  REQUIRE(ms->NumStates() < ms_full->NumStates());
+}
+
+TEST_CASE("ThreeBodyModelSpace, Test states are canonical and sorted.") {
+  const auto sp = SPModelSpace::Make(SPTruncation(3), Reference());
+  const auto ms = ThreeBodyModelSpace::Make(sp, ThreeBodyTruncation(6));
+  for (const auto ch : ms->ChannelIndices()) {
+    const auto& channel = ms->Channel(ch);
+    for (const auto i : channel.StateIndices()) {
+      const ThreeBodyState s = channel.State(i);
+      REQUIRE(s.a <= s.b);
+      REQUIRE(s.b <= s.c);
+      if (i > 0) {
+        REQUIRE(channel.State(i.idx() - 1).Key() < s.Key());
+      }
+      REQUIRE(channel.Index(s) == i);
+    }
+  }
+  const auto ch = ms->ChannelIndex(PackedChannel(1, 0, 1));
+  REQUIRE(ch != ThreeBodyChannelIndex::Invalid());
+  REQUIRE(
+      ms->Channel(ch).Index({0, 0, 0, 2}) == ThreeBodyStateIndex::Invalid());
+}
+
+TEST_CASE("ThreeBodyModelSpace, Test scratch memory is small.") {
+  const auto sp = SPModelSpace::Make(SPTruncation(4), Reference());
+  const auto ms = ThreeBodyModelSpace::Make(sp, ThreeBodyTruncation(12));
+  REQUIRE(ms->ConstructionScratchLoad() < ms->MemoryLoad() / 4);
+}
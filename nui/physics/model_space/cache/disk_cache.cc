@@ -0,0 +1,422 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/model_space/cache/disk_cache.h"
+
+#include <cstring>
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/io/io.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+
+namespace nui {
+
+namespace {
+
+constexpr char kMagic[8] = "NUIMSC1";
+
+enum class CacheKind : std::uint32_t {
+  kTwoBody = 2,
+  kThreeBody = 3,
+};
+
+// Fixed-size file header. The payload follows at offset sizeof(CacheHeader).
+struct CacheHeader {
+  char magic[8];
+  std::uint32_t format_version;
+  std::uint32_t kind;
+  std::uint64_t key_hash;
+  std::uint64_t payload_size;
+  std::uint64_t payload_checksum;
+  // NuIBasicsVersion(), truncated and zero-padded.
+  char basics_version[24];
+};
+
+static_assert(sizeof(CacheHeader) == 64);
+
+enum class FileStatus {
+  kMissing,
+  kInvalid,
+  kValid,
+};
+
+void CopyBasicsVersion(char (&out)[24]) {
+  std::memset(out, 0, sizeof(out));
+  const std::string version = NuIBasicsVersion();
+  std::memcpy(out, version.data(), std::min(version.size(), sizeof(out) - 1));
+}
+
+// Serialize everything the cached model space depends on.
+std::string SerializeParams(
+    const SPModelSpace& sp,
+    CacheKind kind,
+    const std::vector<int>& truncation) {
+  BinaryWriter writer;
+  writer.Write(ModelSpaceCache::kFormatVersion);
+  writer.WriteString(NuIBasicsVersion());
+  writer.Write(kind);
+  writer.Write(sp.Truncation().emax);
+  writer.Write(sp.Truncation().lmax);
+  std::vector<std::uint32_t> words;
+  for (const auto& o : sp.ReferenceState().OccupiedOrbitals()) {
+    words.push_back(o.Word());
+  }
+  writer.WriteVector(words);
+  writer.WriteVector(sp.ReferenceState().Occupations());
+  writer.WriteVector(truncation);
+  return std::string(writer.Buffer().begin(), writer.Buffer().end());
+}
+
+std::string Params2B(const SPModelSpace& sp, TwoBodyTruncation truncation) {
+  return SerializeParams(sp, CacheKind::kTwoBody, {truncation.e2max});
+}
+
+std::string Params3B(const SPModelSpace& sp, ThreeBodyTruncation truncation) {
+  return SerializeParams(
+      sp,
+      CacheKind::kThreeBody,
+      {truncation.e3max,
+       truncation.emax_per_particle,
+       truncation.max_particles,
+       truncation.max_holes});
+}
+
+std::string CachePath(
+    const std::string& directory,
+    CacheKind kind,
+    const std::string& params) {
+  return fmt::format(
+      "{}/nui_ms_{}b_{:016x}.bin",
+      directory,
+      static_cast<std::uint32_t>(kind),
+      Hash64(params));
+}
+
+// Map file and validate header, checksum, and parameters.
+//
+// On success, reader is positioned after the parameters.
+FileStatus OpenCacheFile(
+    const std::string& path,
+    CacheKind kind,
+    const std::string& params,
+    MappedFile& file,
+    BinaryReader& reader) {
+  if (!FileExists(path)) {
+    return FileStatus::kMissing;
+  }
+  file = MappedFile(path);
+  if (!file.IsValid() || file.Size() < sizeof(CacheHeader)) {
+    return FileStatus::kInvalid;
+  }
+
+  CacheHeader header;
+  std::memcpy(&header, file.Data(), sizeof(CacheHeader));
+  char basics_version[24];
+  CopyBasicsVersion(basics_version);
+  const char* payload = file.Data() + sizeof(CacheHeader);
+  const std::size_t payload_size = file.Size() - sizeof(CacheHeader);
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.format_version != ModelSpaceCache::kFormatVersion ||
+      header.kind != static_cast<std::uint32_t>(kind) ||
+      header.key_hash != Hash64(params) ||
+      std::memcmp(
+          header.basics_version,
+          basics_version,
+          sizeof(basics_version)) != 0 ||
+      header.payload_size != payload_size ||
+      header.payload_checksum != Checksum64(payload, payload_size)) {
+    return FileStatus::kInvalid;
+  }
+
+  reader = BinaryReader(payload, payload_size);
+  std::string stored_params;
+  if (!reader.ReadString(stored_params) || stored_params != params) {
+    return FileStatus::kInvalid;
+  }
+  return FileStatus::kValid;
+}
+
+bool WriteCacheFile(
+    const std::string& path,
+    CacheKind kind,
+    const std::string& params,
+    const BinaryWriter& body) {
+  BinaryWriter payload;
+  payload.WriteString(params);
+  payload.WriteBytes(body.Buffer().data(), body.Size());
+
+  CacheHeader header;
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.format_version = ModelSpaceCache::kFormatVersion;
+  header.kind = static_cast<std::uint32_t>(kind);
+  header.key_hash = Hash64(params);
+  header.payload_size = payload.Size();
+  header.payload_checksum =
+      Checksum64(payload.Buffer().data(), payload.Size());
+  CopyBasicsVersion(header.basics_version);
+
+  return WriteFileAtomically(
+      path,
+      {{&header, sizeof(header)}, {payload.Buffer().data(), payload.Size()}});
+}
+
+// Array of values of T in the mapped file, read in place.
+//
+// The payload has no alignment guarantees, so values are copied out one at
+// a time instead of being accessed through a T pointer.
+template <typename T>
+struct MappedArray {
+  const char* data = nullptr;
+  std::size_t size = 0UL;
+
+  T operator[](std::size_t i) const {
+    T value;
+    std::memcpy(&value, data + i * sizeof(T), sizeof(T));
+    return value;
+  }
+
+  // Copy all values to out.
+  void CopyTo(T* out) const {
+    if (size > 0) {
+      std::memcpy(out, data, size * sizeof(T));
+    }
+  }
+};
+
+// View vector written by BinaryWriter::WriteVector without copying it.
+template <typename T>
+bool ViewVector(BinaryReader& reader, MappedArray<T>& view) {
+  std::uint64_t size = 0;
+  if (!reader.Read(size) || size > reader.Remaining() / sizeof(T)) {
+    return false;
+  }
+  view.data = reader.Current();
+  view.size = size;
+  return reader.Skip(size * sizeof(T));
+}
+
+// Load channels of ms from reader.
+//
+// All channels are read and validated before any is primed, so a file that
+// fails validation leaves ms untouched for the rebuild.
+bool Load2B(const TwoBodyModelSpace& ms, BinaryReader& reader) {
+  std::uint64_t num_channels = 0;
+  if (!reader.Read(num_channels) || num_channels != ms.NumChannels()) {
+    return false;
+  }
+  std::vector<MappedArray<OrbitalPair>> views(num_channels);
+  for (const auto ch : ms.ChannelIndices()) {
+    std::uint32_t word = 0;
+    if (!reader.Read(word) ||
+        word != ms.ChannelQuantumNumbers(ch).Word() ||
+        !ViewVector(reader, views[ch.idx()])) {
+      return false;
+    }
+  }
+  if (!reader.AtEnd()) {
+    return false;
+  }
+  // Pairs are copied once, from the mapping into the storage the channels
+  // adopt. Channels of an interned instance may already be built.
+  std::vector<std::vector<OrbitalPair>> pairs(num_channels);
+  for (const auto ch : ms.ChannelIndices()) {
+    if (ms.IsChannelBuilt(ch)) {
+      continue;
+    }
+    pairs[ch.idx()].resize(views[ch.idx()].size);
+    views[ch.idx()].CopyTo(pairs[ch.idx()].data());
+    if (!ms.CheckChannelPairs(ch, pairs[ch.idx()])) {
+      return false;
+    }
+  }
+  for (const auto ch : ms.ChannelIndices()) {
+    // Only fails if another user built the channel in the meantime.
+    ms.PrimeChannel(ch, std::move(pairs[ch.idx()]));
+  }
+  return true;
+}
+
+BinaryWriter Store2B(const TwoBodyModelSpace& ms) {
+  BinaryWriter writer;
+  writer.Write<std::uint64_t>(ms.NumChannels());
+  for (const auto ch : ms.ChannelIndices()) {
+    writer.Write(ms.ChannelQuantumNumbers(ch).Word());
+    writer.WriteVector(ms.Channel(ch).Pairs());
+  }
+  return writer;
+}
+
+// Load channels of the model space of sp and truncation from reader.
+//
+// States are validated in the mapping and only copied once every channel
+// passed.
+bool Load3B(
+    const SPModelSpace& sp,
+    const ThreeBodyTruncation& truncation,
+    BinaryReader& reader,
+    std::vector<ThreeBodyChannel>& channels) {
+  std::uint64_t num_channels = 0;
+  if (!reader.Read(num_channels) ||
+      num_channels > reader.Remaining() / (2 * sizeof(std::uint64_t))) {
+    return false;
+  }
+  std::vector<PackedChannel> qns(num_channels);
+  std::vector<MappedArray<ThreeBodyState>> views(num_channels);
+  for (std::size_t ch = 0; ch < num_channels; ch += 1) {
+    std::uint32_t word = 0;
+    std::uint32_t padding = 0;
+    if (!reader.Read(word) || !reader.Read(padding) ||
+        !ViewVector(reader, views[ch])) {
+      return false;
+    }
+    // Channels are sorted by key, states by (a, b, c, J_ab).
+    qns[ch] = PackedChannel::FromKey(word);
+    if (ch > 0 && !(qns[ch - 1].Key() < qns[ch].Key())) {
+      return false;
+    }
+    const MappedArray<ThreeBodyState>& states = views[ch];
+    for (std::size_t i = 0; i < states.size; i += 1) {
+      const ThreeBodyState state = states[i];
+      if ((i > 0 && !(states[i - 1].Key() < state.Key())) ||
+          !ThreeBodyModelSpace::IsAllowedState(
+              sp,
+              truncation,
+              qns[ch],
+              state)) {
+        return false;
+      }
+    }
+  }
+  if (!reader.AtEnd()) {
+    return false;
+  }
+  channels.resize(num_channels);
+  for (std::size_t ch = 0; ch < num_channels; ch += 1) {
+    channels[ch] = ThreeBodyChannel(qns[ch], views[ch].size);
+    views[ch].CopyTo(channels[ch].MutableStates());
+  }
+  return true;
+}
+
+BinaryWriter Store3B(const ThreeBodyModelSpace& ms) {
+  BinaryWriter writer;
+  writer.Write<std::uint64_t>(ms.NumChannels());
+  for (const auto ch : ms.ChannelIndices()) {
+    const auto& channel = ms.Channel(ch);
+    writer.Write(channel.QuantumNumbers().Word());
+    writer.Write<std::uint32_t>(0);
+    writer.Write<std::uint64_t>(channel.Dimension());
+    writer.WriteBytes(
+        channel.States().data(),
+        channel.Dimension() * sizeof(ThreeBodyState));
+  }
+  return writer;
+}
+
+}  // namespace
+
+ModelSpaceCache::ModelSpaceCache(std::string directory)
+    : directory_(std::move(directory)) {
+  EnsureDirectory(directory_);
+}
+
+std::shared_ptr<const TwoBodyModelSpace> ModelSpaceCache::Get2B(
+    std::shared_ptr<const SPModelSpace> sp,
+    TwoBodyTruncation truncation) {
+  const std::string params = Params2B(*sp, truncation);
+  const std::string path =
+      CachePath(directory_, CacheKind::kTwoBody, params);
+  auto ms = TwoBodyModelSpace::Make(std::move(sp), truncation);
+
+  MappedFile file;
+  BinaryReader reader;
+  const FileStatus status =
+      OpenCacheFile(path, CacheKind::kTwoBody, params, file, reader);
+  if (status == FileStatus::kValid && Load2B(*ms, reader)) {
+    stats_.hits += 1;
+    return ms;
+  }
+  if (status == FileStatus::kMissing) {
+    stats_.misses += 1;
+  } else {
+    stats_.rebuilds += 1;
+  }
+
+  ms->BuildAllChannels();
+  if (!WriteCacheFile(path, CacheKind::kTwoBody, params, Store2B(*ms))) {
+    stats_.write_failures += 1;
+  }
+  return ms;
+}
+
+std::shared_ptr<const ThreeBodyModelSpace> ModelSpaceCache::Get3B(
+    std::shared_ptr<const SPModelSpace> sp,
+    ThreeBodyTruncation truncation) {
+  const std::string params = Params3B(*sp, truncation);
+  const std::string path =
+      CachePath(directory_, CacheKind::kThreeBody, params);
+
+  MappedFile file;
+  BinaryReader reader;
+  const FileStatus status =
+      OpenCacheFile(path, CacheKind::kThreeBody, params, file, reader);
+  if (status == FileStatus::kValid) {
+    std::vector<ThreeBodyChannel> channels;
+    if (Load3B(*sp, truncation, reader, channels)) {
+      stats_.hits += 1;
+      return std::make_shared<const ThreeBodyModelSpace>(
+          std::move(sp),
+          truncation,
+          std::move(channels));
+    }
+  }
+  if (status == FileStatus::kMissing) {
+    stats_.misses += 1;
+  } else {
+    stats_.rebuilds += 1;
+  }
+
+  auto ms = ThreeBodyModelSpace::Make(std::move(sp), truncation);
+  if (!WriteCacheFile(path, CacheKind::kThreeBody, params, Store3B(*ms))) {
+    stats_.write_failures += 1;
+  }
+  return ms;
+}
+
+std::string ModelSpaceCache::Path2B(
+    const SPModelSpace& sp,
+    TwoBodyTruncation truncation) const {
+  return CachePath(directory_, CacheKind::kTwoBody, Params2B(sp, truncation));
+}
+
+std::string ModelSpaceCache::Path3B(
+    const SPModelSpace& sp,
+    ThreeBodyTruncation truncation) const {
+  return CachePath(
+      directory_,
+      CacheKind::kThreeBody,
+      Params3B(sp, truncation));
+}
+
+}  // namespace nui
@@ -0,0 +1,109 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_MODEL_SPACE_CACHE_DISK_CACHE_H_
+#define NUI_PHYSICS_MODEL_SPACE_CACHE_DISK_CACHE_H_
+
+// IWYU pragma: private, include "nui/physics/model_space/cache/model_space_cache.h"
+// IWYU pragma: friend "nui/physics/model_space/cache/.*\.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+
+namespace nui {
+
+// Counters of cache lookups.
+struct ModelSpaceCacheStats {
+  // Model spaces loaded from a valid cache file.
+  std::size_t hits = 0UL;
+  // Model spaces built because no cache file existed.
+  std::size_t misses = 0UL;
+  // Model spaces rebuilt because the cache file was stale or corrupt.
+  std::size_t rebuilds = 0UL;
+  // Cache files that could not be written.
+  std::size_t write_failures = 0UL;
+};
+
+// On-disk cache of two- and three-body model spaces.
+//
+// Each model space is stored in its own file in the cache directory, named by
+// a 64-bit hash of the truncation parameters, the reference state, the cache
+// format version, and NuIBasicsVersion(). A file starts with a fixed 64-byte
+// header (magic, versions, key hash, payload size, payload checksum), followed
+// by the serialized parameters and the channel states.
+//
+// Files are read via mmap. States are validated in the mapping (orbital
+// ranges, order, and coupling to their channel) and copied once into the
+// model space. A file whose header, parameters, checksum, or states do not
+// match is treated as stale or corrupt: the model space is rebuilt and the
+// file is replaced. Files are written atomically (write + rename), so
+// concurrent jobs sharing a cache directory never observe partial files.
+//
+// Single-particle model spaces are cheap to build and are not stored, but
+// their truncation and reference are part of every key.
+//
+// A cache instance is not thread-safe; use one per thread or guard it.
+class ModelSpaceCache {
+ public:
+  // Version of the cache file format.
+  static constexpr std::uint32_t kFormatVersion = 1;
+
+  // Construct cache in directory (created if missing).
+  explicit ModelSpaceCache(std::string directory);
+
+  // Get directory of cache files.
+  const std::string& Directory() const { return directory_; }
+
+  // Get two-body model space, loading it from or storing it to the cache.
+  //
+  // The returned model space is interned (see TwoBodyModelSpace::Make())
+  // and has all channels built.
+  std::shared_ptr<const TwoBodyModelSpace> Get2B(
+      std::shared_ptr<const SPModelSpace> sp,
+      TwoBodyTruncation truncation);
+
+  // Get three-body model space, loading it from or storing it to the cache.
+  std::shared_ptr<const ThreeBodyModelSpace> Get3B(
+      std::shared_ptr<const SPModelSpace> sp,
+      ThreeBodyTruncation truncation);
+
+  // Get path of cache file for two-body model space.
+  std::string Path2B(const SPModelSpace& sp, TwoBodyTruncation truncation)
+      const;
+
+  // Get path of cache file for three-body model space.
+  std::string Path3B(const SPModelSpace& sp, ThreeBodyTruncation truncation)
+      const;
+
+  // Get lookup statistics.
+  const ModelSpaceCacheStats& Statistics() const { return stats_; }
+
+ private:
+  std::string directory_;
+  ModelSpaceCacheStats stats_;
+};
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_MODEL_SPACE_CACHE_DISK_CACHE_H_
@@ -0,0 +1,227 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/model_space/cache/disk_cache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "catch2/catch_test_macros.hpp"
+#include "nui/core/basics/basics.h"
+#include "nui/core/io/io.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+
+namespace {
+
+std::shared_ptr<const nui::SPModelSpace> MakeSP(int emax) {
+  return nui::SPModelSpace::Make(
+      nui::SPTruncation(emax),
+      nui::Reference::HOEqualFilling(8, 8));
+}
+
+bool Equal3B(
+    const nui::ThreeBodyModelSpace& a,
+    const nui::ThreeBodyModelSpace& b) {
+  if (a.NumChannels() != b.NumChannels()) {
+    return false;
+  }
+  for (const auto ch : a.ChannelIndices()) {
+    if (a.Channel(ch).QuantumNumbers() != b.Channel(ch).QuantumNumbers() ||
+        a.Channel(ch).States() != b.Channel(ch).States() ||
+        b.ChannelIndex(b.Channel(ch).QuantumNumbers()) != ch) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void FlipByte(const std::string& path, std::streamoff pos) {
+  std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+  f.seekg(pos);
+  char c = 0;
+  f.read(&c, 1);
+  c = static_cast<char>(c ^ 0x1);
+  f.seekp(pos);
+  f.write(&c, 1);
+}
+
+// Overwrite the 16-bit word at pos bytes before the end of the file and fix
+// the payload checksum in the header, so only the content is invalid.
+void PatchWord(const std::string& path, std::size_t pos, std::uint16_t word) {
+  std::vector<char> data;
+  {
+    std::ifstream f(path, std::ios::binary);
+    data.assign(std::istreambuf_iterator<char>(f), {});
+  }
+  std::memcpy(data.data() + data.size() - pos, &word, sizeof(word));
+  // Header: magic, version, kind, key hash, payload size, payload checksum.
+  constexpr std::size_t kHeaderSize = 64;
+  constexpr std::size_t kChecksumOffset = 32;
+  const std::uint64_t checksum =
+      nui::Checksum64(data.data() + kHeaderSize, data.size() - kHeaderSize);
+  std::memcpy(data.data() + kChecksumOffset, &checksum, sizeof(checksum));
+  std::ofstream f(path, std::ios::binary | std::ios::trunc);
+  f.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+}  // namespace
+
+TEST_CASE("ModelSpaceCache, Test 3b round trip.") {
+  const nui::TempDirectory dir("nui_disk_cache_test");
+  nui::ModelSpaceCache cache(dir.Path());
+  const auto sp = MakeSP(3);
+  const nui::ThreeBodyTruncation truncation(5);
+  const nui::ThreeBodyModelSpace ref(sp, truncation);
+
+  const auto built = cache.Get3B(sp, truncation);
+  REQUIRE(cache.Statistics().misses == 1);
+  REQUIRE(Equal3B(ref, *built));
+
+  const auto loaded = cache.Get3B(sp, truncation);
+  REQUIRE(cache.Statistics().hits == 1);
+  REQUIRE(loaded.get() != built.get());
+  REQUIRE(Equal3B(ref, *loaded));
+  REQUIRE(cache.Statistics().write_failures == 0);
+
+  // Different parameters use different files.
+  REQUIRE(
+      cache.Path3B(*sp, truncation) !=
+      cache.Path3B(*sp, nui::ThreeBodyTruncation(6)));
+  REQUIRE(
+      cache.Path3B(*sp, truncation) !=
+      cache.Path3B(*MakeSP(4), truncation));
+}
+
+TEST_CASE("ModelSpaceCache, Test 2b round trip.") {
+  const nui::TempDirectory dir("nui_disk_cache_test");
+  const auto sp = MakeSP(3);
+  const nui::TwoBodyTruncation truncation{5};
+  std::vector<std::vector<nui::OrbitalPair>> ref_pairs;
+  {
+    nui::ModelSpaceCache cache(dir.Path());
+    const auto ms = cache.Get2B(sp, truncation);
+    REQUIRE(cache.Statistics().misses == 1);
+    for (const auto ch : ms->ChannelIndices()) {
+      REQUIRE(ms->IsChannelBuilt(ch));
+      ref_pairs.push_back(ms->Channel(ch).Pairs());
+    }
+  }
+
+  // The interned instance above has expired, so this loads a fresh one.
+  nui::ModelSpaceCache cache(dir.Path());
+  const auto ms = cache.Get2B(sp, truncation);
+  REQUIRE(cache.Statistics().hits == 1);
+  REQUIRE(ms->NumChannels() == ref_pairs.size());
+  for (const auto ch : ms->ChannelIndices()) {
+    REQUIRE(ms->IsChannelBuilt(ch));
+    const auto& channel = ms->Channel(ch);
+    REQUIRE(channel.Pairs().size() == ref_pairs[ch.idx()].size());
+    for (const auto i : channel.StateIndices()) {
+      const auto& p = channel.Pairs()[i.idx()];
+      REQUIRE(p.a == ref_pairs[ch.idx()][i.idx()].a);
+      REQUIRE(p.b == ref_pairs[ch.idx()][i.idx()].b);
+      REQUIRE(ms->StateIndex(ch, p.a, p.b) == i);
+    }
+  }
+}
+
+TEST_CASE("ModelSpaceCache, Test corrupt file is rebuilt.") {
+  const nui::TempDirectory dir("nui_disk_cache_test");
+  nui::ModelSpaceCache cache(dir.Path());
+  const auto sp = MakeSP(2);
+  const nui::ThreeBodyTruncation truncation(4);
+  const auto ref = cache.Get3B(sp, truncation);
+  const std::string path = cache.Path3B(*sp, truncation);
+
+  // Payload bit flip.
+  FlipByte(path, 200);
+  const auto rebuilt = cache.Get3B(sp, truncation);
+  REQUIRE(cache.Statistics().rebuilds == 1);
+  REQUIRE(Equal3B(*ref, *rebuilt));
+
+  // File was rewritten.
+  REQUIRE(Equal3B(*ref, *cache.Get3B(sp, truncation)));
+  REQUIRE(cache.Statistics().hits == 1);
+
+  // Header (format version) mismatch.
+  FlipByte(path, 8);
+  REQUIRE(Equal3B(*ref, *cache.Get3B(sp, truncation)));
+  REQUIRE(cache.Statistics().rebuilds == 2);
+
+  // Truncated file.
+  { std::ofstream f(path, std::ios::binary | std::ios::trunc); }
+  REQUIRE(Equal3B(*ref, *cache.Get3B(sp, truncation)));
+  REQUIRE(cache.Statistics().rebuilds == 3);
+  REQUIRE(Equal3B(*ref, *cache.Get3B(sp, truncation)));
+  REQUIRE(cache.Statistics().hits == 2);
+}
+
+TEST_CASE("ModelSpaceCache, Test invalid states are rebuilt.") {
+  const nui::TempDirectory dir("nui_disk_cache_test");
+  nui::ModelSpaceCache cache(dir.Path());
+  const auto sp = MakeSP(2);
+  const nui::ThreeBodyTruncation truncation(4);
+  const auto ref = cache.Get3B(sp, truncation);
+  const std::string path_3b = cache.Path3B(*sp, truncation);
+  const nui::ThreeBodyState last = ref->Channel(ref->NumChannels() - 1)
+                                       .States()
+                                       .back();
+
+  // The last state is |(ab) J_ab, c>, stored as four 16-bit words.
+  // Orbital c out of range.
+  PatchWord(path_3b, 4, 0xffff);
+  REQUIRE(Equal3B(*ref, *cache.Get3B(sp, truncation)));
+  REQUIRE(cache.Statistics().rebuilds == 1);
+  // J_ab does not couple j_a and j_b.
+  PatchWord(path_3b, 2, static_cast<std::uint16_t>(last.two_jab + 100));
+  REQUIRE(Equal3B(*ref, *cache.Get3B(sp, truncation)));
+  REQUIRE(cache.Statistics().rebuilds == 2);
+  // States out of order (b > c).
+  PatchWord(path_3b, 6, static_cast<std::uint16_t>(last.c + 1));
+  REQUIRE(Equal3B(*ref, *cache.Get3B(sp, truncation)));
+  REQUIRE(cache.Statistics().rebuilds == 3);
+  REQUIRE(Equal3B(*ref, *cache.Get3B(sp, truncation)));
+  REQUIRE(cache.Statistics().hits == 1);
+
+  // The last pair of the last 2-body channel is (a, b) as 16-bit words.
+  const nui::TwoBodyTruncation truncation_2b{4};
+  std::size_t num_states = 0;
+  {
+    nui::ModelSpaceCache cache_2b(dir.Path());
+    const auto ms = cache_2b.Get2B(sp, truncation_2b);
+    for (const auto ch : ms->ChannelIndices()) {
+      num_states += ms->Channel(ch).Dimension();
+    }
+  }
+  PatchWord(cache.Path2B(*sp, truncation_2b), 4, 0xffff);
+  const auto ms = cache.Get2B(sp, truncation_2b);
+  REQUIRE(cache.Statistics().rebuilds == 4);
+  std::size_t num_rebuilt = 0;
+  for (const auto ch : ms->ChannelIndices()) {
+    num_rebuilt += ms->Channel(ch).Dimension();
+  }
+  REQUIRE(num_rebuilt == num_states);
+}
@@ -0,0 +1,119 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/model_space/sp/reference.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/quantum_numbers/quantum_numbers.h"
+
+namespace nui {
+
+Reference::Reference(
+    const std::vector<std::pair<PackedOrbital, double>>& occupations) {
+  std::vector<std::pair<PackedOrbital, double>> sorted;
+  for (const auto& [orbital, occ] : occupations) {
+    const auto it = std::find_if(
+        sorted.begin(),
+        sorted.end(),
+        [orbital = orbital](const auto& x) { return x.first == orbital; });
+    const double clamped = std::min(1.0, std::max(0.0, occ));
+    if (it != sorted.end()) {
+      it->second = clamped;
+    } else {
+      sorted.push_back({orbital, clamped});
+    }
+  }
+  std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+    return a.first < b.first;
+  });
+
+  for (const auto& [orbital, occ] : sorted) {
+    if (occ > 0.0) {
+      orbitals_.push_back(orbital);
+      occupations_.push_back(occ);
+    }
+  }
+}
+
+Reference Reference::HOEqualFilling(int num_protons, int num_neutrons) {
+  std::vector<std::pair<PackedOrbital, double>> occupations;
+  for (const int two_tz : {-1, 1}) {
+    int remaining = two_tz < 0 ? num_protons : num_neutrons;
+    for (int e = 0; remaining > 0; e += 1) {
+      const int capacity = (e + 1) * (e + 2);
+      const double occ = remaining >= capacity
+                             ? 1.0
+                             : static_cast<double>(remaining) / capacity;
+      for (int l = e % 2; l <= e; l += 2) {
+        for (int two_j = std::abs(2 * l - 1); two_j <= 2 * l + 1; two_j += 2) {
+          occupations.push_back(
+              {PackedOrbital((e - l) / 2, l, two_j, two_tz), occ});
+        }
+      }
+      remaining -= std::min(remaining, capacity);
+    }
+  }
+  return Reference(occupations);
+}
+
+double Reference::Occupation(PackedOrbital orbital) const {
+  const auto it = std::lower_bound(orbitals_.begin(), orbitals_.end(), orbital);
+  if (it == orbitals_.end() || *it != orbital) {
+    return 0.0;
+  }
+  return occupations_[static_cast<std::size_t>(it - orbitals_.begin())];
+}
+
+double Reference::NumProtons() const {
+  double num = 0.0;
+  for (std::size_t i = 0; i < orbitals_.size(); i += 1) {
+    if (orbitals_[i].TwoTz() < 0) {
+      num += (orbitals_[i].TwoJ() + 1) * occupations_[i];
+    }
+  }
+  return num;
+}
+
+double Reference::NumNeutrons() const {
+  double num = 0.0;
+  for (std::size_t i = 0; i < orbitals_.size(); i += 1) {
+    if (orbitals_[i].TwoTz() > 0) {
+      num += (orbitals_[i].TwoJ() + 1) * occupations_[i];
+    }
+  }
+  return num;
+}
+
+int Reference::EMaxOccupied() const {
+  int emax = -1;
+  for (const auto& o : orbitals_) {
+    emax = std::max(emax, o.E());
+  }
+  return emax;
+}
+
+bool operator==(const Reference& a, const Reference& b) {
+  return nui::AreVectorsEqual(a.OccupiedOrbitals(), b.OccupiedOrbitals()) &&
+         nui::AreVectorsEqual(a.Occupations(), b.Occupations());
+}
+
+}  // namespace nui
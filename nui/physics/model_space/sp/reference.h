@@ -0,0 +1,103 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_MODEL_SPACE_SP_REFERENCE_H_
+#define NUI_PHYSICS_MODEL_SPACE_SP_REFERENCE_H_
+
+// IWYU pragma: private, include "nui/physics/model_space/sp/model_space_sp.h"
+// IWYU pragma: friend "nui/physics/model_space/sp/.*\.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/quantum_numbers/quantum_numbers.h"
+
+namespace nui {
+
+// Occupations of J-scheme orbitals in a reference state.
+//
+// Occupations are in [0, 1] and apply equally to all m-substates of an
+// orbital, so fractional values describe open-shell (ensemble) references.
+// Orbitals not listed are empty.
+class Reference {
+ public:
+  // Construct empty reference (vacuum).
+  Reference() {}
+
+  // Construct reference from orbitals and their occupations.
+  //
+  // Occupations are clamped to [0, 1] and orbitals with zero occupation are
+  // dropped. Repeated orbitals keep the last occupation.
+  explicit Reference(
+      const std::vector<std::pair<PackedOrbital, double>>& occupations);
+
+  // Construct reference by filling harmonic oscillator major shells.
+  //
+  // Protons and neutrons fill shells e = 0, 1, ... separately. If a shell
+  // is only partially filled, all its orbitals get the same fractional
+  // occupation (equal filling approximation).
+  static Reference HOEqualFilling(int num_protons, int num_neutrons);
+
+  // Get occupation of orbital.
+  double Occupation(PackedOrbital orbital) const;
+
+  // Get occupied orbitals (sorted by packed word).
+  const std::vector<PackedOrbital>& OccupiedOrbitals() const {
+    return orbitals_;
+  }
+
+  // Get occupations corresponding to OccupiedOrbitals().
+  const std::vector<double>& Occupations() const { return occupations_; }
+
+  // Get number of protons, sum of (2j + 1) n_a over proton orbitals.
+  double NumProtons() const;
+
+  // Get number of neutrons, sum of (2j + 1) n_a over neutron orbitals.
+  double NumNeutrons() const;
+
+  // Get largest e = 2n + l of any occupied orbital (-1 for vacuum).
+  int EMaxOccupied() const;
+
+  // Swap with other reference.
+  void swap(Reference& other) noexcept {
+    using std::swap;
+    swap(orbitals_, other.orbitals_);
+    swap(occupations_, other.occupations_);
+  }
+
+ private:
+  std::vector<PackedOrbital> orbitals_;
+  std::vector<double> occupations_;
+};
+
+// Swap two references.
+inline void swap(Reference& a, Reference& b) noexcept { a.swap(b); }
+
+// Compare two references.
+bool operator==(const Reference& a, const Reference& b);
+
+// Compare two references.
+inline bool operator!=(const Reference& a, const Reference& b) {
+  return !(a == b);
+}
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_MODEL_SPACE_SP_REFERENCE_H_
@@ -0,0 +1,83 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/model_space/sp/reference.h"
+
+#include "catch2/catch_test_macros.hpp"
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/quantum_numbers/quantum_numbers.h"
+
+using nui::PackedOrbital;
+using nui::Reference;
+
+TEST_CASE("Reference, Test default ctor is vacuum.") {
+  const Reference ref;
+  REQUIRE(ref.OccupiedOrbitals().size() == 0);
+  REQUIRE(ref.NumProtons() == 0.0);
+  REQUIRE(ref.NumNeutrons() == 0.0);
+  REQUIRE(ref.EMaxOccupied() == -1);
+  REQUIRE(ref.Occupation(PackedOrbital(0, 0, 1, 1)) == 0.0);
+}
+
+TEST_CASE("Reference, Test explicit occupations.") {
+  const Reference ref({
+      {PackedOrbital(0, 1, 3, 1), 0.5},
+      {PackedOrbital(0, 0, 1, 1), 1.0},
+      {PackedOrbital(0, 0, 1, -1), 2.0},
+      {PackedOrbital(0, 1, 1, -1), 0.0},
+  });
+  REQUIRE(ref.OccupiedOrbitals().size() == 3);
+  REQUIRE(ref.Occupation(PackedOrbital(0, 0, 1, 1)) == 1.0);
+  REQUIRE(ref.Occupation(PackedOrbital(0, 0, 1, -1)) == 1.0);
+  REQUIRE(ref.Occupation(PackedOrbital(0, 1, 3, 1)) == 0.5);
+  REQUIRE(ref.Occupation(PackedOrbital(0, 1, 1, -1)) == 0.0);
+  REQUIRE(ref.NumProtons() == 2.0);
+  REQUIRE(ref.NumNeutrons() == 4.0);
+  REQUIRE(ref.EMaxOccupied() == 1);
+}
+
+TEST_CASE("Reference, Test HO filling of closed shells.") {
+  const auto ref = Reference::HOEqualFilling(8, 8);
+  REQUIRE(ref.NumProtons() == 8.0);
+  REQUIRE(ref.NumNeutrons() == 8.0);
+  REQUIRE(ref.EMaxOccupied() == 1);
+  for (const auto& occ : ref.Occupations()) {
+    REQUIRE(occ == 1.0);
+  }
+}
+
+TEST_CASE("Reference, Test HO filling of open shells.") {
+  const auto ref = Reference::HOEqualFilling(6, 14);
+  REQUIRE(ref.NumProtons() == 6.0);
+  REQUIRE(ref.NumNeutrons() == 14.0);
+  REQUIRE(ref.Occupation(PackedOrbital(0, 1, 3, -1)) == 4.0 / 6.0);
+  REQUIRE(ref.Occupation(PackedOrbital(0, 2, 5, 1)) == 6.0 / 12.0);
+  REQUIRE(ref.Occupation(PackedOrbital(1, 0, 1, 1)) == 6.0 / 12.0);
+}
+
+TEST_CASE("Reference, Test comparison.") {
+  REQUIRE(Reference::HOEqualFilling(8, 8) == Reference::HOEqualFilling(8, 8));
+  REQUIRE(Reference::HOEqualFilling(8, 8) != Reference::HOEqualFilling(8, 6));
+  REQUIRE(Reference() != Reference::HOEqualFilling(2, 2));
+}
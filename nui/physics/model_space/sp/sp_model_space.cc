@@ -0,0 +1,117 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/model_space/sp/sp_model_space.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/indexing/indexing.h"
+#include "nui/physics/model_space/sp/reference.h"
+#include "nui/physics/quantum_numbers/quantum_numbers.h"
+
+namespace nui {
+
+namespace {
+
+std::vector<PackedOrbital> MakeOrderedOrbitals(SPTruncation truncation) {
+  std::vector<PackedOrbital> orbitals;
+  const int lmax = std::min(truncation.emax, truncation.lmax);
+  for (int l = 0; l <= lmax; l += 1) {
+    for (int two_j = std::abs(2 * l - 1); two_j <= 2 * l + 1; two_j += 2) {
+      if (two_j == 0) {
+        continue;
+      }
+      for (const int two_tz : {-1, 1}) {
+        for (int n = 0; 2 * n + l <= truncation.emax; n += 1) {
+          orbitals.push_back(PackedOrbital(n, l, two_j, two_tz));
+        }
+      }
+    }
+  }
+  return orbitals;
+}
+
+std::vector<OrbitalKey> MakeKeys(const std::vector<PackedOrbital>& orbitals) {
+  std::vector<OrbitalKey> keys;
+  keys.reserve(orbitals.size());
+  for (const auto& o : orbitals) {
+    keys.push_back(o.Key());
+  }
+  return keys;
+}
+
+}  // namespace
+
+std::shared_ptr<const SPModelSpace> SPModelSpace::Make(
+    SPTruncation truncation,
+    Reference reference) {
+  return std::make_shared<const SPModelSpace>(
+      truncation,
+      std::move(reference));
+}
+
+SPModelSpace::SPModelSpace(SPTruncation truncation, Reference reference)
+    : truncation_(truncation),
+      reference_(std::move(reference)),
+      orbitals_(MakeOrderedOrbitals(truncation)),
+      lookup_(MakeKeys(orbitals_)) {
+  occupations_.reserve(orbitals_.size());
+  orbital_pws_.reserve(orbitals_.size());
+  pw_offsets_.push_back(0);
+  for (std::size_t i = 0; i < orbitals_.size(); i += 1) {
+    occupations_.push_back(reference_.Occupation(orbitals_[i]));
+    if (i > 0 && orbitals_[i].N() == 0) {
+      pw_offsets_.push_back(i);
+    }
+    orbital_pws_.push_back(pw_offsets_.size() - 1);
+  }
+  // An empty space has no partial waves, so pw_offsets_ stays {0}.
+  if (!orbitals_.empty()) {
+    pw_offsets_.push_back(orbitals_.size());
+  }
+}
+
+std::size_t SPModelSpace::MemoryLoad() const {
+  return reference_.OccupiedOrbitals().size() *
+             (sizeof(PackedOrbital) + sizeof(double)) +
+         orbitals_.size() * (sizeof(PackedOrbital) + sizeof(double) +
+                             sizeof(PartialWaveIndex)) +
+         pw_offsets_.size() * sizeof(std::size_t) + lookup_.MemoryLoad();
+}
+
+bool SPModelSpace::CheckInvariants() const {
+  if (!lookup_.CheckInvariants()) {
+    return false;
+  }
+  for (const auto i : OrbitalIndices()) {
+    if (Index(Orbital(i)) != i) {
+      return false;
+    }
+    const PackedOrbital pw = PartialWave(PartialWaveOf(i));
+    if (pw.L() != Orbital(i).L() || pw.TwoJ() != Orbital(i).TwoJ() ||
+        pw.TwoTz() != Orbital(i).TwoTz()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace nui
@@ -0,0 +1,190 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_MODEL_SPACE_SP_SP_MODEL_SPACE_H_
+#define NUI_PHYSICS_MODEL_SPACE_SP_SP_MODEL_SPACE_H_
+
+// IWYU pragma: private, include "nui/physics/model_space/sp/model_space_sp.h"
+// IWYU pragma: friend "nui/physics/model_space/sp/.*\.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/indexing/indexing.h"
+#include "nui/physics/model_space/sp/reference.h"
+#include "nui/physics/quantum_numbers/quantum_numbers.h"
+
+namespace nui {
+class OrbitalIndex;
+class PartialWaveIndex;
+}  // namespace nui
+
+// Index of an orbital in a single-particle model space.
+NUI_MAKE_INDEX_TYPE(OrbitalIndex);
+
+// Index of a partial wave (l, j, tz) block in a single-particle model space.
+NUI_MAKE_INDEX_TYPE(PartialWaveIndex);
+
+namespace nui {
+
+// Truncation of the single-particle harmonic oscillator basis.
+struct SPTruncation {
+  // Construct truncation with lmax = emax.
+  explicit SPTruncation(int emax_in) : emax(emax_in), lmax(emax_in) {}
+
+  // Construct truncation with separate lmax.
+  SPTruncation(int emax_in, int lmax_in) : emax(emax_in), lmax(lmax_in) {}
+
+  // Maximum e = 2n + l.
+  int emax = 0;
+  // Maximum l.
+  int lmax = 0;
+};
+
+// Compare two truncations.
+inline bool operator==(const SPTruncation& a, const SPTruncation& b) {
+  return a.emax == b.emax && a.lmax == b.lmax;
+}
+
+// Compare two truncations.
+inline bool operator!=(const SPTruncation& a, const SPTruncation& b) {
+  return !(a == b);
+}
+
+// J-scheme single-particle harmonic oscillator model space.
+//
+// Orbitals are ordered by partial wave (l, then j, then tz) and by n within
+// each partial wave. Every (l, j, tz) block is thus a contiguous range of
+// OrbitalIndex values, which makes 1-body operator blocks dense.
+//
+// Lookups from quantum numbers to OrbitalIndex go through an IndexConversion
+// on OrbitalKey and are O(1).
+//
+// Model spaces are immutable after construction. They are meant to be created
+// once via Make() and shared (by reference counting) between all operators and
+// threads that need them, so copying is disabled.
+class SPModelSpace {
+ public:
+  // Construct shared model space.
+  static std::shared_ptr<const SPModelSpace> Make(
+      SPTruncation truncation,
+      Reference reference);
+
+  // Construct model space. Prefer Make().
+  SPModelSpace(SPTruncation truncation, Reference reference);
+
+  SPModelSpace(const SPModelSpace&) = delete;
+  SPModelSpace& operator=(const SPModelSpace&) = delete;
+  SPModelSpace(SPModelSpace&&) = default;
+  SPModelSpace& operator=(SPModelSpace&&) = default;
+
+  // Get truncation.
+  const SPTruncation& Truncation() const { return truncation_; }
+
+  // Get reference state.
+  const Reference& ReferenceState() const { return reference_; }
+
+  // Get number of orbitals.
+  std::size_t NumOrbitals() const { return orbitals_.size(); }
+
+  // Get range of all orbital indices.
+  IndexRange<OrbitalIndex> OrbitalIndices() const {
+    return IndexRange<OrbitalIndex>(orbitals_.size());
+  }
+
+  // Get orbital quantum numbers.
+  PackedOrbital Orbital(OrbitalIndex i) const { return orbitals_[i.idx()]; }
+
+  // Get all orbitals in model space order.
+  const std::vector<PackedOrbital>& Orbitals() const { return orbitals_; }
+
+  // Get index of orbital.
+  //
+  // Returns OrbitalIndex::Invalid() if orbital is not in model space.
+  OrbitalIndex Index(PackedOrbital orbital) const {
+    return lookup_.ConvertSafe(orbital.Key());
+  }
+
+  // Get occupation of orbital in reference state.
+  double Occupation(OrbitalIndex i) const { return occupations_[i.idx()]; }
+
+  // Get occupations of all orbitals in model space order.
+  const std::vector<double>& Occupations() const { return occupations_; }
+
+  // Check if orbital is (partially) occupied in reference state.
+  bool IsHole(OrbitalIndex i) const { return occupations_[i.idx()] > 0.0; }
+
+  // Check if orbital is (partially) unoccupied in reference state.
+  bool IsParticle(OrbitalIndex i) const { return occupations_[i.idx()] < 1.0; }
+
+  // Get number of partial waves.
+  std::size_t NumPartialWaves() const { return pw_offsets_.size() - 1; }
+
+  // Get range of all partial wave indices.
+  IndexRange<PartialWaveIndex> PartialWaveIndices() const {
+    return IndexRange<PartialWaveIndex>(NumPartialWaves());
+  }
+
+  // Get partial wave quantum numbers (l, j, tz) as orbital with n = 0.
+  PackedOrbital PartialWave(PartialWaveIndex pw) const {
+    return Orbital(pw_offsets_[pw.idx()]);
+  }
+
+  // Get partial wave that orbital belongs to.
+  PartialWaveIndex PartialWaveOf(OrbitalIndex i) const {
+    return orbital_pws_[i.idx()];
+  }
+
+  // Get first orbital of partial wave.
+  OrbitalIndex PartialWaveBegin(PartialWaveIndex pw) const {
+    return pw_offsets_[pw.idx()];
+  }
+
+  // Get number of orbitals in partial wave.
+  std::size_t PartialWaveSize(PartialWaveIndex pw) const {
+    return pw_offsets_[pw.idx() + 1] - pw_offsets_[pw.idx()];
+  }
+
+  // Get contiguous range of orbitals in partial wave.
+  IndexRange<OrbitalIndex> PartialWaveOrbitals(PartialWaveIndex pw) const {
+    return IndexRange<OrbitalIndex>(
+        pw_offsets_[pw.idx()],
+        pw_offsets_[pw.idx() + 1]);
+  }
+
+  // Get size of model space in dynamic memory.
+  std::size_t MemoryLoad() const;
+
+  // Check that invariants among data members are fulfilled.
+  bool CheckInvariants() const;
+
+ private:
+  SPTruncation truncation_;
+  Reference reference_;
+  std::vector<PackedOrbital> orbitals_;
+  std::vector<double> occupations_;
+  std::vector<PartialWaveIndex> orbital_pws_;
+  std::vector<std::size_t> pw_offsets_;
+  IndexConversion<OrbitalKey, OrbitalIndex> lookup_;
+};
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_MODEL_SPACE_SP_SP_MODEL_SPACE_H_
@@ -0,0 +1,120 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/model_space/sp/sp_model_space.h"
+
+#include "catch2/catch_test_macros.hpp"
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/indexing/indexing.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/quantum_numbers/quantum_numbers.h"
+
+using nui::OrbitalIndex;
+using nui::PackedOrbital;
+using nui::PartialWaveIndex;
+using nui::Reference;
+using nui::SPModelSpace;
+using nui::SPTruncation;
+
+TEST_CASE("SPModelSpace, Test number of orbitals.") {
+  for (const int emax : {0, 1, 4, 14}) {
+    const auto ms = SPModelSpace::Make(SPTruncation(emax), Reference());
+    REQUIRE(ms->NumOrbitals() ==
+            static_cast<std::size_t>((emax + 1) * (emax + 2)));
+    REQUIRE(ms->NumPartialWaves() ==
+            static_cast<std::size_t>(2 * (2 * emax + 1)));
+    REQUIRE(ms->CheckInvariants());
+    REQUIRE(ms->MemoryLoad() > 0);
+  }
+}
+
+TEST_CASE("SPModelSpace, Test empty space.") {
+  const auto ms = SPModelSpace::Make(SPTruncation(-1), Reference());
+  REQUIRE(ms->NumOrbitals() == 0);
+  REQUIRE(ms->NumPartialWaves() == 0);
+  REQUIRE(ms->PartialWaveIndices().begin() == ms->PartialWaveIndices().end());
+  REQUIRE(ms->CheckInvariants());
+}
+
+TEST_CASE("SPModelSpace, Test lmax truncation.") {
+  const auto ms = SPModelSpace::Make(SPTruncation(6, 2), Reference());
+  for (const auto i : ms->OrbitalIndices()) {
+    REQUIRE(ms->Orbital(i).L() <= 2);
+    REQUIRE(ms->Orbital(i).E() <= 6);
+  }
+  REQUIRE(ms->NumPartialWaves() == 10);
+  REQUIRE(ms->CheckInvariants());
+}
+
+TEST_CASE("SPModelSpace, Test partial waves are contiguous.") {
+  const auto ms = SPModelSpace::Make(SPTruncation(8), Reference());
+  std::size_t expected_begin = 0UL;
+  for (const auto pw : ms->PartialWaveIndices()) {
+    const PackedOrbital pw_qn = ms->PartialWave(pw);
+    REQUIRE(ms->PartialWaveBegin(pw) == expected_begin);
+    int expected_n = 0;
+    for (const auto i : ms->PartialWaveOrbitals(pw)) {
+      REQUIRE(ms->PartialWaveOf(i) == pw);
+      REQUIRE(ms->Orbital(i).N() == expected_n);
+      REQUIRE(ms->Orbital(i).L() == pw_qn.L());
+      REQUIRE(ms->Orbital(i).TwoJ() == pw_qn.TwoJ());
+      REQUIRE(ms->Orbital(i).TwoTz() == pw_qn.TwoTz());
+      expected_n += 1;
+    }
+    expected_begin += ms->PartialWaveSize(pw);
+  }
+  REQUIRE(expected_begin == ms->NumOrbitals());
+}
+
+TEST_CASE("SPModelSpace, Test lookups.") {
+  const auto ms = SPModelSpace::Make(SPTruncation(6), Reference());
+  for (const auto i : ms->OrbitalIndices()) {
+    REQUIRE(ms->Index(ms->Orbital(i)) == i);
+  }
+  REQUIRE(ms->Index(PackedOrbital(4, 0, 1, 1)) == OrbitalIndex::Invalid());
+  REQUIRE(ms->Index(PackedOrbital(0, 7, 15, 1)) == OrbitalIndex::Invalid());
+  REQUIRE(ms->Index(PackedOrbital(30, 7, 15, 1)) == OrbitalIndex::Invalid());
+}
+
+TEST_CASE("SPModelSpace, Test occupations.") {
+  const auto ms =
+      SPModelSpace::Make(SPTruncation(4), Reference::HOEqualFilling(8, 10));
+  double num_protons = 0.0;
+  double num_neutrons = 0.0;
+  for (const auto i : ms->OrbitalIndices()) {
+    const PackedOrbital o = ms->Orbital(i);
+    const double n = (o.TwoJ() + 1) * ms->Occupation(i);
+    (o.TwoTz() < 0 ? num_protons : num_neutrons) += n;
+    REQUIRE(ms->IsHole(i) == (o.E() <= 1 || (o.E() == 2 && o.TwoTz() > 0)));
+    REQUIRE(ms->IsParticle(i) == (o.E() >= 2));
+  }
+  REQUIRE(num_protons == 8.0);
+  REQUIRE(num_neutrons == 10.0);
+}
+
+TEST_CASE("SPModelSpace, Test instances are shared.") {
+  const auto ms = SPModelSpace::Make(SPTruncation(2), Reference());
+  const auto other = ms;
+  REQUIRE(other.get() == ms.get());
+  REQUIRE(ms.use_count() == 2);
+}
@@ -0,0 +1,227 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/actions/1b/normal_ordering.h"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/memory/memory.h"
+#include "nui/info/runtime/runtime.h"
+#include "nui/physics/coupling/coupling.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/storage/1b/op_1b.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+#include "nui/physics/operators/storage/full/op_full.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+
+namespace nui {
+
+namespace {
+
+// State |x c; J> of a channel with occupied spectator c.
+//
+// factor brings the stored state to order (x, c) and to unnormalized
+// normalization (sqrt(2) for x == c).
+struct SpectatorState {
+  std::size_t c = 0;
+  std::size_t x = 0;
+  std::size_t state = 0;
+  double factor = 1.0;
+};
+
+// Accumulate contractions of channel into f (1-body layout with offsets)
+// and return its 0-body contraction.
+double ContractChannel(
+    const TwoBodyOperator& op,
+    TwoBodyChannelIndex ch,
+    const std::vector<double>& occupations,
+    const std::vector<std::size_t>& offsets,
+    std::vector<SpectatorState>& states,
+    double* f) {
+  const TwoBodyModelSpace& ms = op.ModelSpace();
+  const SPModelSpace& sp = ms.SP();
+  const TwoBodyChannel& channel = ms.Channel(ch);
+  const int two_j = ms.ChannelQuantumNumbers(ch).TwoJ();
+  const double degeneracy = two_j + 1.0;
+  const bool symmetric = IsSymmetric(op.Symmetry());
+
+  double zero_body = 0.0;
+  states.clear();
+  for (const auto i : channel.StateIndices()) {
+    const std::size_t p = channel.First(i).idx();
+    const std::size_t q = channel.Second(i).idx();
+    const double np = occupations[p];
+    const double nq = occupations[q];
+    if (np == 0.0 && nq == 0.0) {
+      continue;
+    }
+    zero_body += degeneracy * np * nq * op.Get(ch, i, i);
+    if (p == q) {
+      states.push_back({p, p, i.idx(), std::sqrt(2.0)});
+      continue;
+    }
+    if (nq != 0.0) {
+      states.push_back({q, p, i.idx(), 1.0});
+    }
+    if (np != 0.0) {
+      const double phase = SwapPhase(
+          sp.Orbital(OrbitalIndex(p)).TwoJ(),
+          sp.Orbital(OrbitalIndex(q)).TwoJ(),
+          two_j);
+      states.push_back({p, q, i.idx(), phase});
+    }
+  }
+  std::sort(states.begin(), states.end(), [](const auto& a, const auto& b) {
+    return a.c < b.c || (a.c == b.c && a.x < b.x);
+  });
+
+  // Runs of equal spectator c and partial wave of x (orbitals of a partial
+  // wave are contiguous).
+  std::size_t begin = 0;
+  while (begin < states.size()) {
+    const std::size_t c = states[begin].c;
+    const auto pw = sp.PartialWaveOf(OrbitalIndex(states[begin].x));
+    std::size_t end = begin + 1;
+    while (end < states.size() && states[end].c == c &&
+           sp.PartialWaveOf(OrbitalIndex(states[end].x)) == pw) {
+      end += 1;
+    }
+    const std::size_t first = sp.PartialWaveBegin(pw).idx();
+    const std::size_t n = sp.PartialWaveSize(pw);
+    const double weight = occupations[c] * degeneracy /
+                          (sp.Orbital(OrbitalIndex(first)).TwoJ() + 1.0);
+    double* block = f + offsets[pw.idx()];
+    for (std::size_t s = begin; s < end; s += 1) {
+      const SpectatorState& bra = states[s];
+      const TwoBodyStateIndex i(bra.state);
+      for (std::size_t t = symmetric ? s : begin; t < end; t += 1) {
+        const SpectatorState& ket = states[t];
+        const double v = weight * bra.factor * ket.factor *
+                         op.Get(ch, i, TwoBodyStateIndex(ket.state));
+        const std::size_t a = bra.x - first;
+        const std::size_t b = ket.x - first;
+        block[symmetric ? PackedIndex(a, b) : a * n + b] += v;
+      }
+    }
+    begin = end;
+  }
+  return zero_body;
+}
+
+}  // namespace
+
+double ContractOneBody(
+    const OneBodyOperator& op,
+    const std::vector<double>& occupations) {
+  const SPModelSpace& sp = op.SP();
+  double zero_body = 0.0;
+  for (const auto a : sp.OrbitalIndices()) {
+    if (occupations[a.idx()] != 0.0) {
+      zero_body += (sp.Orbital(a).TwoJ() + 1.0) * occupations[a.idx()] *
+                   op.Get(a, a);
+    }
+  }
+  return zero_body;
+}
+
+bool ContractTwoBody(
+    const TwoBodyOperator& op,
+    const std::vector<double>& occupations,
+    OneBodyOperator& one_body,
+    double& zero_body) {
+  const TwoBodyModelSpace& ms = op.ModelSpace();
+  if (&one_body.SP() != &ms.SP() || one_body.Symmetry() != op.Symmetry() ||
+      occupations.size() != ms.SP().NumOrbitals()) {
+    return false;
+  }
+  ms.BuildAllChannels();
+
+  std::vector<std::size_t> offsets(one_body.NumBlocks() + 1, 0UL);
+  for (const auto pw : ms.SP().PartialWaveIndices()) {
+    offsets[pw.idx() + 1] = offsets[pw.idx()] + one_body.BlockSize(pw);
+  }
+  const std::size_t size = offsets.back();
+  const std::size_t num_channels = op.NumChannels();
+  const int num_threads = omp_get_max_threads();
+  std::vector<AlignedVector<double>> partial(
+      static_cast<std::size_t>(num_threads));
+  double sum = 0.0;
+
+#pragma omp parallel reduction(+ : sum) num_threads(NumParallelThreads())
+  {
+    AlignedVector<double>& f =
+        partial[static_cast<std::size_t>(omp_get_thread_num())];
+    f.assign(size, 0.0);
+    std::vector<SpectatorState> states;
+#pragma omp for schedule(dynamic)
+    for (std::size_t c = 0; c < num_channels; c += 1) {
+      sum += ContractChannel(
+          op,
+          TwoBodyChannelIndex(c),
+          occupations,
+          offsets,
+          states,
+          f.data());
+    }
+  }
+
+  one_body.PrepareWrites();
+  const std::size_t num_blocks = one_body.NumBlocks();
+#pragma omp parallel for schedule(dynamic) num_threads(NumParallelThreads())
+  for (std::size_t b = 0; b < num_blocks; b += 1) {
+    double* block = one_body.MutableBlock(PartialWaveIndex(b));
+    for (const auto& f : partial) {
+      if (f.empty()) {
+        continue;
+      }
+      const double* x = f.data() + offsets[b];
+      for (std::size_t i = 0; i < offsets[b + 1] - offsets[b]; i += 1) {
+        block[i] += x[i];
+      }
+    }
+  }
+  zero_body += sum;
+  return true;
+}
+
+bool NormalOrder(Operator& op, const std::vector<double>& occupations) {
+  if (occupations.size() != op.SP().NumOrbitals()) {
+    return false;
+  }
+  double zero_body =
+      op.ZeroBody() + ContractOneBody(op.OneBody(), occupations);
+  ContractTwoBody(op.TwoBody(), occupations, op.OneBody(), zero_body);
+  op.SetZeroBody(zero_body);
+  return true;
+}
+
+bool NormalOrder(Operator& op) {
+  return NormalOrder(op, op.SP().Occupations());
+}
+
+}  // namespace nui
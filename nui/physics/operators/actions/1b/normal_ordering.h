@@ -0,0 +1,79 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_OPERATORS_ACTIONS_1B_NORMAL_ORDERING_H_
+#define NUI_PHYSICS_OPERATORS_ACTIONS_1B_NORMAL_ORDERING_H_
+
+// IWYU pragma: private, include "nui/physics/operators/actions/1b/op_actions_1b.h"
+// IWYU pragma: friend "nui/physics/operators/actions/1b/.*\.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/operators/storage/1b/op_1b.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+#include "nui/physics/operators/storage/full/op_full.h"
+
+// Normal ordering of 1- and 2-body operators with respect to a reference
+// with occupations n_a (which may be fractional, e.g., for open shells):
+//
+//   E_0  = sum_a (2j_a + 1) n_a t_aa
+//          + 1/2 sum_ab n_a n_b sum_J (2J + 1) V^J_abab,
+//   f_ab = t_ab + sum_c n_c sum_J (2J + 1) / (2j_a + 1) V^J_acbc,
+//
+// with unnormalized J-coupled matrix elements. The 2-body part is unchanged.
+//
+// The 2-body contractions traverse the 2-body channels in order, in
+// parallel. Each channel only visits states with an occupied orbital, groups
+// them by that orbital, and accumulates f_ab into per-thread buffers, so
+// no coupling lookup is done per matrix element.
+
+namespace nui {
+
+// Get 0-body contraction sum_a (2j_a + 1) n_a t_aa.
+double ContractOneBody(
+    const OneBodyOperator& op,
+    const std::vector<double>& occupations);
+
+// Add 1-body contraction of op to one_body and 0-body contraction to
+// zero_body.
+//
+// Returns false (and does nothing) if one_body does not have the
+// single-particle model space and hermiticity of op, or occupations does not
+// have one entry per orbital.
+bool ContractTwoBody(
+    const TwoBodyOperator& op,
+    const std::vector<double>& occupations,
+    OneBodyOperator& one_body,
+    double& zero_body);
+
+// Normal order operator in place with respect to occupations.
+//
+// Returns false (and does nothing) if occupations does not have one entry
+// per orbital. A 3-body part is not normal ordered (and left untouched).
+bool NormalOrder(Operator& op, const std::vector<double>& occupations);
+
+// Normal order operator in place with respect to the reference state of its
+// single-particle model space.
+bool NormalOrder(Operator& op);
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_OPERATORS_ACTIONS_1B_NORMAL_ORDERING_H_
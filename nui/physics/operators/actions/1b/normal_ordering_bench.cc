@@ -0,0 +1,149 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "fmt/core.h"
+#include "nui/core/basics/basics.h"
+#include "nui/info/profiling/profiling.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/actions/1b/op_actions_1b.h"
+#include "nui/physics/operators/storage/full/op_full.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+#include "nui/physics/operators/storage/testing/op_testing.h"
+
+// Benchmark of normal ordering of a 2-body Hamiltonian.
+//
+// Usage: nui_..._normal_ordering_bench [emax] [e2max] [naive]
+//
+// e2max < 0 uses 2 * emax. If naive is nonzero, the contraction is compared
+// with a loop over all (a, b, c, J) with coupled lookups per matrix element.
+
+namespace {
+
+// Contract 2-body part with orbital lookups for each (a, b, c, J).
+double NaiveContraction(
+    const nui::TwoBodyOperator& v,
+    const std::vector<double>& n,
+    nui::OneBodyOperator& f) {
+  const nui::TwoBodyModelSpace& ms = v.ModelSpace();
+  const nui::SPModelSpace& sp = ms.SP();
+  double zero_body = 0.0;
+  f.PrepareWrites();
+  for (const auto a : sp.OrbitalIndices()) {
+    const auto oa = sp.Orbital(a);
+    for (const auto b : sp.PartialWaveOrbitals(sp.PartialWaveOf(a))) {
+      if (b < a) {
+        continue;
+      }
+      double sum = 0.0;
+      for (const auto c : sp.OrbitalIndices()) {
+        if (n[c.idx()] == 0.0) {
+          continue;
+        }
+        const auto oc = sp.Orbital(c);
+        const double norm =
+            (a == c ? std::sqrt(2.0) : 1.0) * (b == c ? std::sqrt(2.0) : 1.0);
+        for (int two_j = std::abs(oa.TwoJ() - oc.TwoJ());
+             two_j <= oa.TwoJ() + oc.TwoJ();
+             two_j += 2) {
+          const auto ch = ms.ChannelIndex(nui::PackedChannel(
+              two_j,
+              (oa.L() + oc.L()) % 2,
+              oa.TwoTz() + oc.TwoTz()));
+          if (ch == nui::TwoBodyChannelIndex::Invalid()) {
+            continue;
+          }
+          sum += n[c.idx()] * (two_j + 1.0) * norm * v.Get(ch, a, c, b, c);
+        }
+      }
+      f.Set(a, b, f.Get(a, b) + sum / (oa.TwoJ() + 1.0));
+      if (a == b) {
+        zero_body += 0.5 * n[a.idx()] * sum;
+      }
+    }
+  }
+  return zero_body;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int emax = argc > 1 ? std::atoi(argv[1]) : 12;
+  const int e2max = argc > 2 ? std::atoi(argv[2]) : -1;
+  const bool naive = argc > 3 ? std::atoi(argv[3]) != 0 : true;
+
+  const auto sp = nui::SPModelSpace::Make(
+      nui::SPTruncation(emax),
+      nui::Reference::HOEqualFilling(8, 8));
+  const auto ms = e2max < 0 ? nui::TwoBodyModelSpace::Make(sp)
+                            : nui::TwoBodyModelSpace::Make(
+                                  sp,
+                                  nui::TwoBodyTruncation{e2max});
+  nui::TwoBodyOperator v(ms, nui::Hermiticity::kHermitian);
+  nui::testing::FillStored(1.0, v);
+  fmt::print(
+      "emax = {}, e2max = {}, orbitals = {}, 2-body = {:.1f} MB\n",
+      emax,
+      ms->Truncation().e2max,
+      sp->NumOrbitals(),
+      v.Blocks().TotalSize() * sizeof(double) * 1e-6);
+
+  const std::vector<double>& n = sp->Occupations();
+  nui::OneBodyOperator f(sp, nui::Hermiticity::kHermitian);
+  double zero_body = 0.0;
+  const double fast =
+      nui::TimeSeconds([&]() { nui::ContractTwoBody(v, n, f, zero_body); });
+  fmt::print(
+      "{:<24} {:>10.3f} ms  E0 = {:.10e}\n",
+      "ContractTwoBody",
+      fast * 1e3,
+      zero_body);
+
+  if (naive) {
+    nui::OneBodyOperator g(sp, nui::Hermiticity::kHermitian);
+    double naive_zero_body = 0.0;
+    const double slow = nui::TimeSeconds([&]() {
+      naive_zero_body = NaiveContraction(v, n, g);
+    });
+    double diff = 0.0;
+    for (const auto a : sp->OrbitalIndices()) {
+      for (const auto b : sp->PartialWaveOrbitals(sp->PartialWaveOf(a))) {
+        diff = std::max(diff, std::abs(f.Get(a, b) - g.Get(a, b)));
+      }
+    }
+    fmt::print(
+        "{:<24} {:>10.3f} ms  E0 = {:.10e}\n",
+        "Naive lookups",
+        slow * 1e3,
+        naive_zero_body);
+    fmt::print(
+        "speedup = {:.1f}, max |f - f_naive| = {:.2e}\n",
+        slow / fast,
+        diff);
+  }
+  return 0;
+}
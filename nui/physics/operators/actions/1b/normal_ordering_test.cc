@@ -0,0 +1,155 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/actions/1b/normal_ordering.h"
+
+#include <cmath>
+#include <vector>
+
+#include "catch2/catch_approx.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "nui/core/basics/basics.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/actions/testing/op_actions_testing.h"
+#include "nui/physics/operators/storage/1b/op_1b.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+#include "nui/physics/operators/storage/full/op_full.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+#include "nui/physics/operators/storage/testing/op_testing.h"
+
+namespace {
+
+using nui::Hermiticity;
+using nui::OrbitalIndex;
+using nui::testing::Fill;
+using nui::testing::MakeTwoBodyModelSpace;
+
+// Get unnormalized <ab; J| V |cd; J>.
+double Unnormalized(
+    const nui::TwoBodyOperator& v,
+    nui::TwoBodyChannelIndex ch,
+    OrbitalIndex a,
+    OrbitalIndex b,
+    OrbitalIndex c,
+    OrbitalIndex d) {
+  const double norm =
+      (a == b ? std::sqrt(2.0) : 1.0) * (c == d ? std::sqrt(2.0) : 1.0);
+  return norm * v.Get(ch, a, b, c, d);
+}
+
+// Normal order by summing over all orbitals and channels.
+void NaiveNormalOrder(nui::Operator& op, const std::vector<double>& n) {
+  const nui::SPModelSpace& sp = op.SP();
+  const nui::TwoBodyOperator& v = op.TwoBody();
+  const nui::TwoBodyModelSpace& ms = v.ModelSpace();
+  const bool symmetric = nui::IsSymmetric(op.Symmetry());
+  double zero_body = op.ZeroBody();
+  for (const auto a : sp.OrbitalIndices()) {
+    zero_body +=
+        (sp.Orbital(a).TwoJ() + 1.0) * n[a.idx()] * op.OneBody().Get(a, a);
+  }
+  nui::OneBodyOperator f = op.OneBody();
+  f.PrepareWrites();
+  for (const auto ch : ms.ChannelIndices()) {
+    const double degeneracy = ms.ChannelQuantumNumbers(ch).TwoJ() + 1.0;
+    for (const auto a : sp.OrbitalIndices()) {
+      for (const auto c : sp.OrbitalIndices()) {
+        if (n[c.idx()] == 0.0) {
+          continue;
+        }
+        zero_body += 0.5 * degeneracy * n[a.idx()] * n[c.idx()] *
+                     Unnormalized(v, ch, a, c, a, c);
+        for (const auto b : sp.OrbitalIndices()) {
+          if (sp.PartialWaveOf(a) != sp.PartialWaveOf(b) ||
+              (symmetric && b < a)) {
+            continue;
+          }
+          const double x = n[c.idx()] * degeneracy /
+                           (sp.Orbital(a).TwoJ() + 1.0) *
+                           Unnormalized(v, ch, a, c, b, c);
+          if (x != 0.0) {
+            f.Set(a, b, f.Get(a, b) + x);
+          }
+        }
+      }
+    }
+  }
+  op.SetZeroBody(zero_body);
+  op.OneBody() = f;
+}
+
+void CheckNormalOrder(Hermiticity h, bool packed) {
+  const auto ms = MakeTwoBodyModelSpace(3);
+  nui::Operator op(ms, h, packed);
+  Fill(17.0, op);
+  const std::vector<double> n = nui::testing::MakeOccupations(op.SP(), 2);
+  nui::Operator ref = op.Clone();
+  NaiveNormalOrder(ref, n);
+
+  REQUIRE(nui::NormalOrder(op, n));
+  REQUIRE(op.ZeroBody() == Catch::Approx(ref.ZeroBody()));
+  for (const auto a : op.SP().OrbitalIndices()) {
+    for (const auto b : op.SP().OrbitalIndices()) {
+      REQUIRE(
+          op.OneBody().Get(a, b) ==
+          Catch::Approx(ref.OneBody().Get(a, b)).margin(1e-12));
+    }
+  }
+}
+
+}  // namespace
+
+TEST_CASE("ContractTwoBody, Test argument checks.") {
+  const auto ms = MakeTwoBodyModelSpace(3);
+  const nui::TwoBodyOperator v(ms, Hermiticity::kHermitian);
+  nui::OneBodyOperator f(ms->SPShared(), Hermiticity::kAntihermitian);
+  double zero_body = 0.0;
+  REQUIRE_FALSE(
+      nui::ContractTwoBody(v, ms->SP().Occupations(), f, zero_body));
+
+  nui::OneBodyOperator g(ms->SPShared(), Hermiticity::kHermitian);
+  REQUIRE_FALSE(nui::ContractTwoBody(v, {1.0}, g, zero_body));
+  REQUIRE(nui::ContractTwoBody(v, ms->SP().Occupations(), g, zero_body));
+  REQUIRE(zero_body == 0.0);
+}
+
+TEST_CASE("NormalOrder, Test against naive sums.") {
+  CheckNormalOrder(Hermiticity::kHermitian, true);
+  CheckNormalOrder(Hermiticity::kHermitian, false);
+  CheckNormalOrder(Hermiticity::kAntihermitian, true);
+  CheckNormalOrder(Hermiticity::kNone, true);
+}
+
+TEST_CASE("NormalOrder, Test reference occupations.") {
+  const auto ms = MakeTwoBodyModelSpace(3);
+  nui::Operator op(ms, Hermiticity::kHermitian);
+  Fill(3.0, op);
+  nui::Operator ref = op.Clone();
+  NaiveNormalOrder(ref, op.SP().Occupations());
+
+  REQUIRE(nui::NormalOrder(op));
+  REQUIRE(op.ZeroBody() == Catch::Approx(ref.ZeroBody()));
+
+  std::vector<double> n(op.SP().NumOrbitals() + 1, 0.0);
+  REQUIRE_FALSE(nui::NormalOrder(op, n));
+}
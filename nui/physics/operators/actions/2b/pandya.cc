@@ -0,0 +1,568 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/actions/2b/pandya.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <vector>
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/memory/memory.h"
+#include "nui/info/runtime/runtime.h"
+#include "nui/physics/coupling/coupling.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+
+namespace nui {
+
+namespace {
+
+constexpr std::uint32_t kNoPair = std::numeric_limits<std::uint32_t>::max();
+
+// Get norm factor of unnormalized |ab; J> relative to stored state.
+double PairNorm(std::size_t a, std::size_t b) {
+  return a == b ? std::sqrt(2.0) : 1.0;
+}
+
+// Orbital quantum numbers used in recoupling.
+struct OrbitalInfo {
+  int two_j = 0;
+  int l = 0;
+  int two_tz = 0;
+};
+
+std::vector<OrbitalInfo> MakeOrbitalInfos(const SPModelSpace& sp) {
+  std::vector<OrbitalInfo> infos;
+  infos.reserve(sp.NumOrbitals());
+  for (const auto a : sp.OrbitalIndices()) {
+    const PackedOrbital o = sp.Orbital(a);
+    infos.push_back({o.TwoJ(), o.L(), o.TwoTz()});
+  }
+  return infos;
+}
+
+std::vector<CrossCoupledChannel> MakeChannels(
+    const TwoBodyModelSpace& ms,
+    bool particle_hole_kets) {
+  const SPModelSpace& sp = ms.SP();
+  const int e2max = ms.Truncation().e2max;
+  std::map<std::uint32_t, CrossCoupledChannel> channels;
+  for (const auto a : sp.OrbitalIndices()) {
+    const PackedOrbital oa = sp.Orbital(a);
+    for (const auto b : sp.OrbitalIndices()) {
+      const PackedOrbital ob = sp.Orbital(b);
+      if (oa.E() + ob.E() > e2max) {
+        continue;
+      }
+      const OrbitalPair pair{
+          static_cast<std::uint16_t>(a.idx()),
+          static_cast<std::uint16_t>(b.idx())};
+      const bool ket = !particle_hole_kets ||
+                       sp.Occupation(a) != sp.Occupation(b);
+      for (int two_j = std::abs(oa.TwoJ() - ob.TwoJ());
+           two_j <= oa.TwoJ() + ob.TwoJ();
+           two_j += 2) {
+        const PackedChannel qn(
+            two_j,
+            (oa.L() + ob.L()) % 2,
+            oa.TwoTz() - ob.TwoTz());
+        CrossCoupledChannel& channel = channels[qn.Word()];
+        channel.qn = qn;
+        channel.bras.push_back(pair);
+        if (ket) {
+          channel.kets.push_back(pair);
+        }
+      }
+    }
+  }
+  std::vector<CrossCoupledChannel> out;
+  out.reserve(channels.size());
+  for (auto& [key, channel] : channels) {
+    out.push_back(std::move(channel));
+  }
+  return out;
+}
+
+// Get offset and sign of stored element (i, j) of n x n block.
+//
+// Returns false if the element is not stored (antihermitian diagonal).
+bool StoredOffset(
+    std::size_t i,
+    std::size_t j,
+    std::size_t n,
+    Hermiticity h,
+    BlockLayout layout,
+    std::uint32_t& offset,
+    double& sign) {
+  sign = 1.0;
+  if (layout == BlockLayout::kFull) {
+    offset = static_cast<std::uint32_t>(i * n + j);
+    return true;
+  }
+  if (i == j && h == Hermiticity::kAntihermitian) {
+    return false;
+  }
+  if (i <= j) {
+    offset = static_cast<std::uint32_t>(PackedIndex(i, j));
+  } else {
+    offset = static_cast<std::uint32_t>(PackedIndex(j, i));
+    sign = HermiticitySign(h);
+  }
+  return true;
+}
+
+// Get state index of |ab; J> in channel ch and phase relative to stored
+// state.
+TwoBodyStateIndex OrderedState(
+    const TwoBodyModelSpace& ms,
+    const std::vector<OrbitalInfo>& infos,
+    TwoBodyChannelIndex ch,
+    std::size_t a,
+    std::size_t b,
+    int two_j,
+    double& phase) {
+  phase = 1.0;
+  if (a > b) {
+    phase = SwapPhase(infos[a].two_j, infos[b].two_j, two_j);
+    std::swap(a, b);
+  }
+  return ms.StateIndex(ch, OrbitalIndex(a), OrbitalIndex(b));
+}
+
+// Build plan of transform into cross-coupled channel.
+GatherPlan MakeForwardPlan(
+    const TwoBodyModelSpace& ms,
+    const std::vector<OrbitalInfo>& infos,
+    const CrossCoupledChannel& channel,
+    Hermiticity h,
+    BlockLayout layout) {
+  const int two_j = channel.qn.TwoJ();
+  GatherPlan plan;
+  plan.begin.reserve(channel.bras.size() * channel.kets.size() + 1);
+  plan.begin.push_back(0);
+  for (const auto& bra : channel.bras) {
+    for (const auto& ket : channel.kets) {
+      const std::size_t a = bra.a;
+      const std::size_t b = bra.b;
+      const std::size_t c = ket.a;
+      const std::size_t d = ket.b;
+      const OrbitalInfo& ia = infos[a];
+      const OrbitalInfo& ib = infos[b];
+      const OrbitalInfo& ic = infos[c];
+      const OrbitalInfo& id = infos[d];
+      const int jp_min = std::max(
+          std::abs(ia.two_j - id.two_j),
+          std::abs(ic.two_j - ib.two_j));
+      const int jp_max = std::min(ia.two_j + id.two_j, ic.two_j + ib.two_j);
+      for (int two_jp = jp_min; two_jp <= jp_max; two_jp += 2) {
+        const TwoBodyChannelIndex ch = ms.ChannelIndex(PackedChannel(
+            two_jp,
+            (ia.l + id.l) % 2,
+            ia.two_tz + id.two_tz));
+        if (ch == TwoBodyChannelIndex::Invalid()) {
+          continue;
+        }
+        double phase_ad = 1.0;
+        double phase_cb = 1.0;
+        const TwoBodyStateIndex i =
+            OrderedState(ms, infos, ch, a, d, two_jp, phase_ad);
+        const TwoBodyStateIndex j =
+            OrderedState(ms, infos, ch, c, b, two_jp, phase_cb);
+        if (i == TwoBodyStateIndex::Invalid() ||
+            j == TwoBodyStateIndex::Invalid()) {
+          continue;
+        }
+        const double sixj = SixJ(
+            ia.two_j,
+            ib.two_j,
+            two_j,
+            ic.two_j,
+            id.two_j,
+            two_jp);
+        std::uint32_t offset = 0;
+        double sign = 1.0;
+        if (sixj == 0.0 ||
+            !StoredOffset(
+                i.idx(),
+                j.idx(),
+                ms.Channel(ch).Dimension(),
+                h,
+                layout,
+                offset,
+                sign)) {
+          continue;
+        }
+        plan.source.push_back(static_cast<std::uint32_t>(ch.idx()));
+        plan.offset.push_back(offset);
+        plan.weight.push_back(
+            -(two_jp + 1.0) * sixj * phase_ad * phase_cb * sign *
+            PairNorm(a, d) * PairNorm(c, b));
+      }
+      plan.begin.push_back(plan.source.size());
+    }
+  }
+  return plan;
+}
+
+// Context of inverse plans: bra lookups of cross-coupled channels.
+struct InverseContext {
+  const TwoBodyModelSpace& ms;
+  const PandyaPlan& pandya;
+  const std::vector<OrbitalInfo>& infos;
+  // Bra index of pair (a, b) in channel c at c * n * n + a * n + b.
+  const std::vector<std::uint32_t>& bra_lookup;
+};
+
+// Add terms of -sum_J' (2J' + 1) {j_a j_b J; j_c j_d J'} Z^J'_{ad^-1 cb^-1}
+// scaled by factor to plan.
+void AddInverseTerms(
+    const InverseContext& ctx,
+    std::size_t a,
+    std::size_t b,
+    std::size_t c,
+    std::size_t d,
+    int two_j,
+    double factor,
+    GatherPlan& plan) {
+  const std::size_t norb = ctx.infos.size();
+  const OrbitalInfo& ia = ctx.infos[a];
+  const OrbitalInfo& ib = ctx.infos[b];
+  const OrbitalInfo& ic = ctx.infos[c];
+  const OrbitalInfo& id = ctx.infos[d];
+  const int jp_min = std::max(
+      std::abs(ia.two_j - id.two_j),
+      std::abs(ic.two_j - ib.two_j));
+  const int jp_max = std::min(ia.two_j + id.two_j, ic.two_j + ib.two_j);
+  for (int two_jp = jp_min; two_jp <= jp_max; two_jp += 2) {
+    const std::size_t cc = ctx.pandya.ChannelIndex(PackedChannel(
+        two_jp,
+        (ia.l + id.l) % 2,
+        ia.two_tz - id.two_tz));
+    if (cc == ctx.pandya.NumChannels()) {
+      continue;
+    }
+    const std::uint32_t bra =
+        ctx.bra_lookup[(cc * norb + a) * norb + d];
+    const std::uint32_t ket =
+        ctx.bra_lookup[(cc * norb + c) * norb + b];
+    if (bra == kNoPair || ket == kNoPair) {
+      continue;
+    }
+    const double sixj = SixJ(
+        ia.two_j,
+        ib.two_j,
+        two_j,
+        ic.two_j,
+        id.two_j,
+        two_jp);
+    if (sixj == 0.0) {
+      continue;
+    }
+    const std::size_t n = ctx.pandya.Channel(cc).bras.size();
+    plan.source.push_back(static_cast<std::uint32_t>(cc));
+    plan.offset.push_back(static_cast<std::uint32_t>(bra * n + ket));
+    plan.weight.push_back(-(two_jp + 1.0) * sixj * factor);
+  }
+}
+
+// Build plan of inverse transform into stored block of channel ch.
+GatherPlan MakeInversePlan(
+    const InverseContext& ctx,
+    TwoBodyChannelIndex ch,
+    Hermiticity h,
+    BlockLayout layout,
+    bool antisymmetrize) {
+  const TwoBodyChannel& channel = ctx.ms.Channel(ch);
+  const int two_j = channel.QuantumNumbers().TwoJ();
+  const std::size_t n = channel.Dimension();
+  const std::size_t size = StoredBlockSize(n, layout);
+
+  // Rows in stored order.
+  std::vector<std::pair<std::size_t, std::size_t>> rows(size, {n, n});
+  for (std::size_t i = 0; i < n; i += 1) {
+    for (std::size_t j = 0; j < n; j += 1) {
+      std::uint32_t offset = 0;
+      double sign = 1.0;
+      if ((layout == BlockLayout::kFull || i <= j) &&
+          StoredOffset(i, j, n, h, layout, offset, sign)) {
+        rows[offset] = {i, j};
+      }
+    }
+  }
+
+  GatherPlan plan;
+  plan.begin.reserve(size + 1);
+  plan.begin.push_back(0);
+  for (const auto& [i, j] : rows) {
+    if (i < n) {
+      const TwoBodyStateIndex si(i);
+      const TwoBodyStateIndex sj(j);
+      const std::size_t a = channel.First(si).idx();
+      const std::size_t b = channel.Second(si).idx();
+      const std::size_t c = channel.First(sj).idx();
+      const std::size_t d = channel.Second(sj).idx();
+      const double norm = 1.0 / (PairNorm(a, b) * PairNorm(c, d));
+      AddInverseTerms(ctx, a, b, c, d, two_j, norm, plan);
+      if (antisymmetrize) {
+        const double phase =
+            SwapPhase(ctx.infos[a].two_j, ctx.infos[b].two_j, two_j);
+        AddInverseTerms(ctx, b, a, c, d, two_j, phase * norm, plan);
+      }
+    }
+    plan.begin.push_back(plan.source.size());
+  }
+  return plan;
+}
+
+}  // namespace
+
+std::size_t GatherPlan::MemoryLoad() const {
+  return begin.size() * sizeof(std::size_t) +
+         (source.size() + offset.size()) * sizeof(std::uint32_t) +
+         weight.size() * sizeof(double);
+}
+
+PandyaPlan::PandyaPlan(
+    std::shared_ptr<const TwoBodyModelSpace> ms,
+    Hermiticity hermiticity,
+    BlockLayout layout,
+    PandyaOptions options)
+    : ms_(std::move(ms)),
+      hermiticity_(hermiticity),
+      layout_(IsSymmetric(hermiticity) ? layout : BlockLayout::kFull),
+      options_(options),
+      channels_(MakeChannels(*ms_, options.particle_hole_kets)),
+      forward_(channels_.size()),
+      inverse_(ms_->NumChannels()) {
+  ms_->BuildAllChannels();
+  const std::vector<OrbitalInfo> infos = MakeOrbitalInfos(ms_->SP());
+  const std::size_t norb = infos.size();
+  const std::size_t num_channels = channels_.size();
+
+  std::vector<std::uint32_t> bra_lookup(num_channels * norb * norb, kNoPair);
+  for (std::size_t c = 0; c < num_channels; c += 1) {
+    const auto& bras = channels_[c].bras;
+    for (std::size_t i = 0; i < bras.size(); i += 1) {
+      bra_lookup[(c * norb + bras[i].a) * norb + bras[i].b] =
+          static_cast<std::uint32_t>(i);
+    }
+  }
+
+#pragma omp parallel for schedule(dynamic) num_threads(NumParallelThreads())
+  for (std::size_t c = 0; c < num_channels; c += 1) {
+    forward_[c] =
+        MakeForwardPlan(*ms_, infos, channels_[c], hermiticity_, layout_);
+  }
+
+  const InverseContext ctx{*ms_, *this, infos, bra_lookup};
+  const std::size_t num_pp_channels = ms_->NumChannels();
+#pragma omp parallel for schedule(dynamic) num_threads(NumParallelThreads())
+  for (std::size_t c = 0; c < num_pp_channels; c += 1) {
+    inverse_[c] = MakeInversePlan(
+        ctx,
+        TwoBodyChannelIndex(c),
+        hermiticity_,
+        layout_,
+        options_.antisymmetrize_inverse);
+  }
+}
+
+std::size_t PandyaPlan::ChannelIndex(PackedChannel qn) const {
+  const auto it = std::lower_bound(
+      channels_.begin(),
+      channels_.end(),
+      qn,
+      [](const CrossCoupledChannel& channel, PackedChannel x) {
+        return channel.qn < x;
+      });
+  if (it == channels_.end() || it->qn != qn) {
+    return channels_.size();
+  }
+  return static_cast<std::size_t>(it - channels_.begin());
+}
+
+bool PandyaPlan::Matches(const TwoBodyOperator& op) const {
+  return &op.ModelSpace() == ms_.get() && op.Symmetry() == hermiticity_ &&
+         op.Layout() == layout_;
+}
+
+std::size_t PandyaPlan::TransformedSize() const {
+  std::size_t size = 0;
+  for (const auto& channel : channels_) {
+    size += channel.bras.size() * channel.kets.size();
+  }
+  return size;
+}
+
+std::size_t PandyaPlan::MemoryLoad() const {
+  std::size_t load = 0;
+  for (const auto& channel : channels_) {
+    load += (channel.bras.size() + channel.kets.size()) * sizeof(OrbitalPair);
+  }
+  for (const auto& plan : forward_) {
+    load += plan.MemoryLoad();
+  }
+  for (const auto& plan : inverse_) {
+    load += plan.MemoryLoad();
+  }
+  return load;
+}
+
+bool PandyaTransform(
+    const PandyaPlan& plan,
+    const TwoBodyOperator& op,
+    std::vector<AlignedVector<double>>& out) {
+  if (!plan.Matches(op)) {
+    return false;
+  }
+  std::vector<const double*> blocks;
+  blocks.reserve(op.NumChannels());
+  for (const auto ch : op.ModelSpace().ChannelIndices()) {
+    blocks.push_back(op.Block(ch));
+  }
+
+  const std::size_t num_channels = plan.NumChannels();
+  out.resize(num_channels);
+#pragma omp parallel for schedule(dynamic) num_threads(NumParallelThreads())
+  for (std::size_t c = 0; c < num_channels; c += 1) {
+    const GatherPlan& gather = plan.Forward(c);
+    const std::size_t* begin = gather.begin.data();
+    const std::uint32_t* source = gather.source.data();
+    const std::uint32_t* offset = gather.offset.data();
+    const double* weight = gather.weight.data();
+    const std::size_t size = gather.NumOutputs();
+    AlignedVector<double>& x = out[c];
+    x.resize(size);
+    for (std::size_t e = 0; e < size; e += 1) {
+      double sum = 0.0;
+#pragma omp simd reduction(+ : sum)
+      for (std::size_t k = begin[e]; k < begin[e + 1]; k += 1) {
+        sum += weight[k] * blocks[source[k]][offset[k]];
+      }
+      x[e] = sum;
+    }
+  }
+  return true;
+}
+
+bool InversePandyaTransform(
+    const PandyaPlan& plan,
+    const std::vector<AlignedVector<double>>& in,
+    double scale,
+    TwoBodyOperator& op) {
+  if (!plan.Matches(op) || in.size() != plan.NumChannels()) {
+    return false;
+  }
+  std::vector<const double*> sources;
+  sources.reserve(in.size());
+  for (std::size_t c = 0; c < in.size(); c += 1) {
+    const std::size_t n = plan.Channel(c).bras.size();
+    if (in[c].size() != n * n) {
+      return false;
+    }
+    sources.push_back(in[c].data());
+  }
+
+  op.PrepareWrites();
+  const std::size_t num_channels = op.NumChannels();
+#pragma omp parallel for schedule(dynamic) num_threads(NumParallelThreads())
+  for (std::size_t c = 0; c < num_channels; c += 1) {
+    const TwoBodyChannelIndex ch(c);
+    const GatherPlan& gather = plan.Inverse(ch);
+    const std::size_t* begin = gather.begin.data();
+    const std::uint32_t* source = gather.source.data();
+    const std::uint32_t* offset = gather.offset.data();
+    const double* weight = gather.weight.data();
+    double* block = op.MutableBlock(ch);
+    const std::size_t size = gather.NumOutputs();
+    for (std::size_t e = 0; e < size; e += 1) {
+      double sum = 0.0;
+#pragma omp simd reduction(+ : sum)
+      for (std::size_t k = begin[e]; k < begin[e + 1]; k += 1) {
+        sum += weight[k] * sources[source[k]][offset[k]];
+      }
+      block[e] += scale * sum;
+    }
+  }
+  return true;
+}
+
+bool PandyaTransformDirect(
+    const PandyaPlan& plan,
+    const TwoBodyOperator& op,
+    std::vector<AlignedVector<double>>& out) {
+  if (!plan.Matches(op)) {
+    return false;
+  }
+  const TwoBodyModelSpace& ms = op.ModelSpace();
+  const SPModelSpace& sp = ms.SP();
+  const std::size_t num_channels = plan.NumChannels();
+  out.resize(num_channels);
+#pragma omp parallel for schedule(dynamic) num_threads(NumParallelThreads())
+  for (std::size_t cc = 0; cc < num_channels; cc += 1) {
+    const CrossCoupledChannel& channel = plan.Channel(cc);
+    const int two_j = channel.qn.TwoJ();
+    AlignedVector<double>& x = out[cc];
+    x.assign(channel.bras.size() * channel.kets.size(), 0.0);
+    std::size_t e = 0;
+    for (const auto& bra : channel.bras) {
+      for (const auto& ket : channel.kets) {
+        const OrbitalIndex a(bra.a);
+        const OrbitalIndex b(bra.b);
+        const OrbitalIndex c(ket.a);
+        const OrbitalIndex d(ket.b);
+        const PackedOrbital oa = sp.Orbital(a);
+        const PackedOrbital od = sp.Orbital(d);
+        double sum = 0.0;
+        for (int two_jp = 0; two_jp <= oa.TwoJ() + od.TwoJ(); two_jp += 2) {
+          const TwoBodyChannelIndex ch = ms.ChannelIndex(PackedChannel(
+              two_jp,
+              (oa.L() + od.L()) % 2,
+              oa.TwoTz() + od.TwoTz()));
+          if (ch == TwoBodyChannelIndex::Invalid()) {
+            continue;
+          }
+          const double sixj = SixJ(
+              oa.TwoJ(),
+              sp.Orbital(b).TwoJ(),
+              two_j,
+              sp.Orbital(c).TwoJ(),
+              od.TwoJ(),
+              two_jp);
+          sum -= (two_jp + 1.0) * sixj * PairNorm(a.idx(), d.idx()) *
+                 PairNorm(c.idx(), b.idx()) * op.Get(ch, a, d, c, b);
+        }
+        x[e] = sum;
+        e += 1;
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace nui
@@ -0,0 +1,185 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_OPERATORS_ACTIONS_2B_PANDYA_H_
+#define NUI_PHYSICS_OPERATORS_ACTIONS_2B_PANDYA_H_
+
+// IWYU pragma: private, include "nui/physics/operators/actions/2b/op_actions_2b.h"
+// IWYU pragma: friend "nui/physics/operators/actions/2b/.*\.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/memory/memory.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+
+// Pandya (particle-hole) transformation of 2-body operators.
+//
+// The transform recouples an operator to cross-coupled states |a b^-1; J>,
+//
+//   X^J_{ab^-1 cd^-1} = -sum_J' (2J' + 1) {j_a j_b J; j_c j_d J'} X^J'_{adcb},
+//
+// with unnormalized J-coupled matrix elements, and is its own inverse.
+// Cross-coupled channels (J, parity, Tz = tz_a - tz_b) hold all ordered pairs
+// (a, b) with e_a + e_b <= e2max, and the transformed operator is one dense
+// row-major matrix per channel.
+//
+// A PandyaPlan is built once per model space and layout. It stores for each
+// output element the source offsets and weights (6j symbols, phases, and
+// normalizations) in compressed rows, so transforms are streaming
+// gather-multiply-accumulate loops without coupling logic, parallel over
+// channels. Plans take about as many terms per element as there are
+// intermediate J', so they are several times larger than the operator.
+
+namespace nui {
+
+// Cross-coupled channel of ordered pairs |a b^-1; J>.
+struct CrossCoupledChannel {
+  // J, parity, and Tz = tz_a - tz_b (doubled).
+  PackedChannel qn;
+  // All pairs in the channel, sorted by a and then b.
+  std::vector<OrbitalPair> bras;
+  // Kets kept in transformed matrices (all bras or a subset).
+  std::vector<OrbitalPair> kets;
+};
+
+// Gather plan: out[e] = sum_k weight[k] * blocks[source[k]][offset[k]] for k
+// in [begin[e], begin[e + 1]).
+struct GatherPlan {
+  std::vector<std::size_t> begin;
+  std::vector<std::uint32_t> source;
+  std::vector<std::uint32_t> offset;
+  AlignedVector<double> weight;
+
+  // Get number of output elements.
+  std::size_t NumOutputs() const {
+    return begin.empty() ? 0 : begin.size() - 1;
+  }
+
+  // Get size in dynamic memory.
+  std::size_t MemoryLoad() const;
+};
+
+// Options of Pandya plans.
+struct PandyaOptions {
+  // Only keep kets |c d^-1> with n_c != n_d in transformed matrices.
+  //
+  // This is all that is needed for particle-hole contractions weighted with
+  // n_c - n_d.
+  bool particle_hole_kets = false;
+  // Antisymmetrize inverse transform, Z_abcd -> Z_abcd - P_ab Z_abcd.
+  bool antisymmetrize_inverse = false;
+};
+
+// Precomputed Pandya transform of operators with given model space,
+// hermiticity, and layout.
+class PandyaPlan {
+ public:
+  // Build plans.
+  PandyaPlan(
+      std::shared_ptr<const TwoBodyModelSpace> ms,
+      Hermiticity hermiticity,
+      BlockLayout layout,
+      PandyaOptions options = {});
+
+  // Get two-body model space.
+  const TwoBodyModelSpace& ModelSpace() const { return *ms_; }
+
+  // Get hermiticity of transformed operators.
+  Hermiticity Symmetry() const { return hermiticity_; }
+
+  // Get layout of transformed operators.
+  BlockLayout Layout() const { return layout_; }
+
+  // Get options.
+  const PandyaOptions& Options() const { return options_; }
+
+  // Get number of cross-coupled channels.
+  std::size_t NumChannels() const { return channels_.size(); }
+
+  // Get cross-coupled channel.
+  const CrossCoupledChannel& Channel(std::size_t c) const {
+    return channels_[c];
+  }
+
+  // Get index of cross-coupled channel (NumChannels() if not present).
+  std::size_t ChannelIndex(PackedChannel qn) const;
+
+  // Get plan of transform into cross-coupled channel c.
+  const GatherPlan& Forward(std::size_t c) const { return forward_[c]; }
+
+  // Get plan of inverse transform into stored block of channel ch.
+  const GatherPlan& Inverse(TwoBodyChannelIndex ch) const {
+    return inverse_[ch.idx()];
+  }
+
+  // Check that op has model space, hermiticity, and layout of plan.
+  bool Matches(const TwoBodyOperator& op) const;
+
+  // Get number of elements of transformed matrices.
+  std::size_t TransformedSize() const;
+
+  // Get size in dynamic memory.
+  std::size_t MemoryLoad() const;
+
+ private:
+  std::shared_ptr<const TwoBodyModelSpace> ms_;
+  Hermiticity hermiticity_;
+  BlockLayout layout_;
+  PandyaOptions options_;
+  std::vector<CrossCoupledChannel> channels_;
+  std::vector<GatherPlan> forward_;
+  std::vector<GatherPlan> inverse_;
+};
+
+// Pandya transform op into bras x kets matrices of cross-coupled channels.
+//
+// Returns false (and does nothing) if op does not match plan.
+bool PandyaTransform(
+    const PandyaPlan& plan,
+    const TwoBodyOperator& op,
+    std::vector<AlignedVector<double>>& out);
+
+// Add scaled inverse Pandya transform of bras x bras matrices of
+// cross-coupled channels, op += scale * inverse(in).
+//
+// Only stored elements of op are computed. Returns false (and does nothing)
+// if op does not match plan or in has the wrong shape.
+bool InversePandyaTransform(
+    const PandyaPlan& plan,
+    const std::vector<AlignedVector<double>>& in,
+    double scale,
+    TwoBodyOperator& op);
+
+// Pandya transform op element by element with 6j symbols and coupled
+// lookups.
+//
+// This is the direct reference for PandyaTransform. Returns false (and does
+// nothing) if op does not match plan.
+bool PandyaTransformDirect(
+    const PandyaPlan& plan,
+    const TwoBodyOperator& op,
+    std::vector<AlignedVector<double>>& out);
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_OPERATORS_ACTIONS_2B_PANDYA_H_
@@ -0,0 +1,107 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "fmt/core.h"
+#include "nui/core/basics/basics.h"
+#include "nui/core/memory/memory.h"
+#include "nui/info/profiling/profiling.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/actions/2b/op_actions_2b.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+#include "nui/physics/operators/storage/testing/op_testing.h"
+
+// Benchmark of Pandya transforms with gather plans against the direct
+// transform with 6j symbols and coupled lookups per element.
+//
+// Usage: nui_..._pandya_bench [emax] [e2max] [repeats]
+//
+// e2max < 0 uses 2 * emax. Kets are restricted to particle-hole pairs, as
+// in commutators.
+
+namespace {
+
+void Report(const char* name, double seconds) {
+  fmt::print("{:<28} {:>10.3f} ms\n", name, seconds * 1e3);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int emax = argc > 1 ? std::atoi(argv[1]) : 4;
+  const int e2max = argc > 2 ? std::atoi(argv[2]) : -1;
+  const int repeats = argc > 3 ? std::atoi(argv[3]) : 3;
+
+  const auto sp = nui::SPModelSpace::Make(
+      nui::SPTruncation(emax),
+      nui::Reference::HOEqualFilling(8, 8));
+  const auto ms = e2max < 0 ? nui::TwoBodyModelSpace::Make(sp)
+                            : nui::TwoBodyModelSpace::Make(
+                                  sp,
+                                  nui::TwoBodyTruncation{e2max});
+  nui::TwoBodyOperator v(ms, nui::Hermiticity::kHermitian);
+  nui::testing::FillStored(1.0, v);
+
+  nui::PandyaOptions options;
+  options.particle_hole_kets = true;
+  const auto start = std::chrono::steady_clock::now();
+  const nui::PandyaPlan plan(ms, v.Symmetry(), v.Layout(), options);
+  fmt::print(
+      "emax = {}, e2max = {}, 2-body = {:.1f} MB, transformed = {:.1f} MB, "
+      "plan = {:.1f} MB\n",
+      emax,
+      ms->Truncation().e2max,
+      v.Blocks().TotalSize() * sizeof(double) * 1e-6,
+      plan.TransformedSize() * sizeof(double) * 1e-6,
+      plan.MemoryLoad() * 1e-6);
+  Report("Build plan", nui::SecondsSince(start));
+
+  std::vector<nui::AlignedVector<double>> fast;
+  std::vector<nui::AlignedVector<double>> direct;
+  const double t_fast = nui::TimeSeconds(
+      repeats,
+      [&]() { nui::PandyaTransform(plan, v, fast); });
+  const double t_direct = nui::TimeSeconds(
+      repeats,
+      [&]() { nui::PandyaTransformDirect(plan, v, direct); });
+  Report("PandyaTransform", t_fast);
+  Report("PandyaTransformDirect", t_direct);
+
+  double diff = 0.0;
+  for (std::size_t c = 0; c < fast.size(); c += 1) {
+    for (std::size_t e = 0; e < fast[c].size(); e += 1) {
+      diff = std::max(diff, std::abs(fast[c][e] - direct[c][e]));
+    }
+  }
+  fmt::print(
+      "speedup = {:.1f}, max difference = {:.2e}\n",
+      t_direct / t_fast,
+      diff);
+  return 0;
+}
@@ -0,0 +1,170 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/actions/2b/pandya.h"
+
+#include <vector>
+
+#include "catch2/catch_approx.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "nui/core/basics/basics.h"
+#include "nui/core/memory/memory.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+#include "nui/physics/operators/storage/testing/op_testing.h"
+
+namespace {
+
+using nui::BlockLayout;
+using nui::Hermiticity;
+using nui::testing::Fill;
+using nui::testing::MakeTwoBodyModelSpace;
+
+void RequireEqual(
+    const std::vector<nui::AlignedVector<double>>& x,
+    const std::vector<nui::AlignedVector<double>>& y) {
+  REQUIRE(x.size() == y.size());
+  for (std::size_t c = 0; c < x.size(); c += 1) {
+    REQUIRE(x[c].size() == y[c].size());
+    for (std::size_t e = 0; e < x[c].size(); e += 1) {
+      REQUIRE(x[c][e] == Catch::Approx(y[c][e]).margin(1e-12));
+    }
+  }
+}
+
+void RequireEqual(
+    const nui::TwoBodyOperator& x,
+    double scale,
+    const nui::TwoBodyOperator& y) {
+  for (const auto ch : x.ModelSpace().ChannelIndices()) {
+    for (std::size_t e = 0; e < x.ChannelSize(ch); e += 1) {
+      REQUIRE(
+          x.Block(ch)[e] ==
+          Catch::Approx(scale * y.Block(ch)[e]).margin(1e-12));
+    }
+  }
+}
+
+}  // namespace
+
+TEST_CASE("PandyaPlan, Test channels.") {
+  const auto ms = MakeTwoBodyModelSpace(2);
+  const nui::PandyaPlan plan(ms, Hermiticity::kHermitian, BlockLayout::kFull);
+  nui::PandyaOptions options;
+  options.particle_hole_kets = true;
+  const nui::PandyaPlan ph_plan(
+      ms,
+      Hermiticity::kHermitian,
+      BlockLayout::kFull,
+      options);
+  REQUIRE(plan.NumChannels() == ph_plan.NumChannels());
+  REQUIRE(plan.MemoryLoad() > 0);
+  REQUIRE(ph_plan.TransformedSize() < plan.TransformedSize());
+
+  std::size_t num_bras = 0;
+  for (std::size_t c = 0; c < plan.NumChannels(); c += 1) {
+    const auto& channel = plan.Channel(c);
+    REQUIRE(plan.ChannelIndex(channel.qn) == c);
+    REQUIRE(channel.bras.size() == channel.kets.size());
+    num_bras += channel.bras.size();
+    for (const auto& ket : ph_plan.Channel(c).kets) {
+      REQUIRE(
+          ms->SP().Occupation(nui::OrbitalIndex(ket.a)) !=
+          ms->SP().Occupation(nui::OrbitalIndex(ket.b)));
+    }
+  }
+  // Each ordered pair (a, b) appears once per J.
+  std::size_t expected = 0;
+  for (const auto a : ms->SP().OrbitalIndices()) {
+    for (const auto b : ms->SP().OrbitalIndices()) {
+      const int two_ja = ms->SP().Orbital(a).TwoJ();
+      const int two_jb = ms->SP().Orbital(b).TwoJ();
+      expected += static_cast<std::size_t>(
+          (two_ja + two_jb - std::abs(two_ja - two_jb)) / 2 + 1);
+    }
+  }
+  REQUIRE(num_bras == expected);
+  REQUIRE(
+      plan.ChannelIndex(nui::PackedChannel(40, 0, 0)) == plan.NumChannels());
+}
+
+TEST_CASE("PandyaTransform, Test against direct transform.") {
+  const auto ms = MakeTwoBodyModelSpace(2);
+  const std::vector<std::pair<Hermiticity, bool>> cases = {
+      {Hermiticity::kHermitian, true},
+      {Hermiticity::kHermitian, false},
+      {Hermiticity::kAntihermitian, true},
+      {Hermiticity::kNone, false},
+  };
+  for (const auto& [h, packed] : cases) {
+    nui::TwoBodyOperator op(ms, h, packed);
+    Fill(5.0, op);
+    for (const bool ph_kets : {false, true}) {
+      nui::PandyaOptions options;
+      options.particle_hole_kets = ph_kets;
+      const nui::PandyaPlan plan(ms, h, op.Layout(), options);
+      std::vector<nui::AlignedVector<double>> fast;
+      std::vector<nui::AlignedVector<double>> direct;
+      REQUIRE(nui::PandyaTransform(plan, op, fast));
+      REQUIRE(nui::PandyaTransformDirect(plan, op, direct));
+      RequireEqual(fast, direct);
+    }
+  }
+
+  nui::TwoBodyOperator op(ms, Hermiticity::kHermitian);
+  const nui::PandyaPlan plan(
+      ms,
+      Hermiticity::kAntihermitian,
+      BlockLayout::kPackedUpper);
+  std::vector<nui::AlignedVector<double>> out;
+  REQUIRE_FALSE(nui::PandyaTransform(plan, op, out));
+  REQUIRE_FALSE(nui::PandyaTransformDirect(plan, op, out));
+  REQUIRE(out.empty());
+}
+
+TEST_CASE("InversePandyaTransform, Test round trip.") {
+  const auto ms = MakeTwoBodyModelSpace(2);
+  for (const auto h : {Hermiticity::kHermitian, Hermiticity::kAntihermitian}) {
+    nui::TwoBodyOperator op(ms, h);
+    Fill(11.0, op);
+    const nui::PandyaPlan plan(ms, h, op.Layout());
+    std::vector<nui::AlignedVector<double>> x;
+    REQUIRE(nui::PandyaTransform(plan, op, x));
+
+    nui::TwoBodyOperator back(ms, h);
+    REQUIRE(nui::InversePandyaTransform(plan, x, 1.0, back));
+    RequireEqual(back, 1.0, op);
+
+    // (1 - P_ab) doubles antisymmetric operators.
+    nui::PandyaOptions options;
+    options.antisymmetrize_inverse = true;
+    const nui::PandyaPlan anti_plan(ms, h, op.Layout(), options);
+    nui::TwoBodyOperator twice(ms, h);
+    REQUIRE(nui::InversePandyaTransform(anti_plan, x, 0.5, twice));
+    RequireEqual(twice, 2.0 * 0.5, op);
+
+    x.pop_back();
+    REQUIRE_FALSE(nui::InversePandyaTransform(plan, x, 1.0, back));
+  }
+}
@@ -0,0 +1,434 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/actions/3b/basis_transform.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/memory/memory.h"
+#include "nui/info/runtime/runtime.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/actions/3b/recoupling.h"
+#include "nui/physics/operators/storage/1b/op_1b.h"
+#include "nui/physics/operators/storage/3b/op_3b.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+#include "nui/tensor/contraction/tensor_contraction.h"
+
+namespace nui {
+
+namespace {
+
+// Canonical states [begin, end) (in channel order by group) whose orbitals
+// have partial waves pw, with product basis J_ab in
+// [two_jab_min, two_jab_min + 2 * num_jab).
+struct Group {
+  PartialWaveIndex pw[3];
+  std::size_t begin = 0;
+  std::size_t end = 0;
+  int two_jab_min = 0;
+  std::size_t num_jab = 0;
+
+  std::size_t Dimension() const { return end - begin; }
+};
+
+// Element of the product basis expansion (row) of a canonical state (col).
+struct ExpansionEntry {
+  std::size_t col = 0;
+  std::size_t row = 0;
+  double coefficient = 0.0;
+};
+
+// Scratch of one thread.
+struct Workspace {
+  // Channel states ordered by group, and position of each state there.
+  std::vector<std::size_t> members;
+  std::vector<std::size_t> position;
+  std::vector<Group> groups;
+  // Transformation matrices of all groups.
+  std::vector<std::size_t> f_offsets;
+  AlignedVector<double> f;
+  std::vector<ThreeBodyTerm> terms;
+  std::vector<ExpansionEntry> entries;
+  AlignedVector<double> x;
+  AlignedVector<double> y;
+  // Row panels.
+  AlignedVector<double> p;
+  AlignedVector<double> q;
+};
+
+// Sort states of channel into groups.
+void BuildGroups(
+    const ThreeBodyChannel& channel,
+    const SPModelSpace& sp,
+    Workspace& ws) {
+  const std::size_t n = channel.Dimension();
+  const auto key = [&channel, &sp](std::size_t i) {
+    const ThreeBodyState st = channel.States()[i];
+    const std::uint64_t pa = sp.PartialWaveOf(OrbitalIndex(st.a)).idx();
+    const std::uint64_t pb = sp.PartialWaveOf(OrbitalIndex(st.b)).idx();
+    const std::uint64_t pc = sp.PartialWaveOf(OrbitalIndex(st.c)).idx();
+    return (pa << 42) | (pb << 21) | pc;
+  };
+  ws.members.resize(n);
+  for (std::size_t i = 0; i < n; i += 1) {
+    ws.members[i] = i;
+  }
+  std::stable_sort(
+      ws.members.begin(),
+      ws.members.end(),
+      [&key](std::size_t i, std::size_t j) { return key(i) < key(j); });
+  ws.position.resize(n);
+  ws.groups.clear();
+  const int two_j = channel.QuantumNumbers().TwoJ();
+  for (std::size_t m = 0; m < n; m += 1) {
+    ws.position[ws.members[m]] = m;
+    if (m > 0 && key(ws.members[m]) == key(ws.members[m - 1])) {
+      ws.groups.back().end = m + 1;
+      continue;
+    }
+    const ThreeBodyState st = channel.States()[ws.members[m]];
+    Group group;
+    group.pw[0] = sp.PartialWaveOf(OrbitalIndex(st.a));
+    group.pw[1] = sp.PartialWaveOf(OrbitalIndex(st.b));
+    group.pw[2] = sp.PartialWaveOf(OrbitalIndex(st.c));
+    group.begin = m;
+    group.end = m + 1;
+    const int ja = sp.PartialWave(group.pw[0]).TwoJ();
+    const int jb = sp.PartialWave(group.pw[1]).TwoJ();
+    const int jc = sp.PartialWave(group.pw[2]).TwoJ();
+    // Triangle conditions leave a contiguous range of J_ab.
+    const int lo = std::max(std::abs(ja - jb), std::abs(two_j - jc));
+    const int hi = std::min(ja + jb, two_j + jc);
+    group.two_jab_min = lo;
+    group.num_jab = static_cast<std::size_t>((hi - lo) / 2 + 1);
+    ws.groups.push_back(group);
+  }
+}
+
+// Get row of |(ab) J_ab, c> in the product basis of group.
+std::size_t ProductRow(
+    const Group& group,
+    const SPModelSpace& sp,
+    std::size_t a,
+    std::size_t b,
+    std::size_t c,
+    int two_jab) {
+  const std::size_t n1 = sp.PartialWaveSize(group.pw[0]);
+  const std::size_t n2 = sp.PartialWaveSize(group.pw[1]);
+  const std::size_t n3 = sp.PartialWaveSize(group.pw[2]);
+  const std::size_t j =
+      static_cast<std::size_t>(two_jab - group.two_jab_min) / 2;
+  return ((j * n1 + a - sp.PartialWaveBegin(group.pw[0]).idx()) * n2 + b -
+          sp.PartialWaveBegin(group.pw[1]).idx()) *
+             n3 +
+         c - sp.PartialWaveBegin(group.pw[2]).idx();
+}
+
+// Compute transformation matrix (dim x dim, row-major) of group into f.
+void ComputeGroupTransform(
+    const ThreeBodyChannel& channel,
+    const OneBodyOperator& basis,
+    const Group& group,
+    std::size_t block_columns,
+    Workspace& ws,
+    double* f) {
+  const SPModelSpace& sp = basis.SP();
+  const std::size_t n1 = sp.PartialWaveSize(group.pw[0]);
+  const std::size_t n2 = sp.PartialWaveSize(group.pw[1]);
+  const std::size_t n3 = sp.PartialWaveSize(group.pw[2]);
+  const std::size_t f1 = sp.PartialWaveBegin(group.pw[0]).idx();
+  const std::size_t f2 = sp.PartialWaveBegin(group.pw[1]).idx();
+  const std::size_t f3 = sp.PartialWaveBegin(group.pw[2]).idx();
+  const double* c1 = basis.Block(group.pw[0]);
+  const double* c2 = basis.Block(group.pw[1]);
+  const double* c3 = basis.Block(group.pw[2]);
+  const std::size_t dim = group.Dimension();
+  const std::size_t num_rows = group.num_jab * n1 * n2 * n3;
+
+  // Expansion of product states in canonical states, by canonical state.
+  ws.entries.clear();
+  std::size_t row = 0;
+  for (std::size_t j = 0; j < group.num_jab; j += 1) {
+    const int two_jab = group.two_jab_min + 2 * static_cast<int>(j);
+    for (std::size_t a = f1; a < f1 + n1; a += 1) {
+      for (std::size_t b = f2; b < f2 + n2; b += 1) {
+        for (std::size_t c = f3; c < f3 + n3; c += 1) {
+          ws.terms.clear();
+          ExpandThreeBodyState(
+              channel,
+              sp,
+              OrbitalIndex(a),
+              OrbitalIndex(b),
+              two_jab,
+              OrbitalIndex(c),
+              ws.terms);
+          for (const ThreeBodyTerm& t : ws.terms) {
+            ExpansionEntry entry;
+            entry.col = ws.position[t.state] - group.begin;
+            entry.row = row;
+            entry.coefficient = t.coefficient;
+            ws.entries.push_back(entry);
+          }
+          row += 1;
+        }
+      }
+    }
+  }
+  std::sort(
+      ws.entries.begin(),
+      ws.entries.end(),
+      [](const auto& x, const auto& y) { return x.col < y.col; });
+
+  std::size_t e = 0;
+  for (std::size_t m0 = 0; m0 < dim; m0 += block_columns) {
+    const std::size_t nb = std::min(block_columns, dim - m0);
+    ws.x.assign(num_rows * nb, 0.0);
+    ws.y.resize(num_rows * nb);
+    for (; e < ws.entries.size() && ws.entries[e].col < m0 + nb; e += 1) {
+      const ExpansionEntry& entry = ws.entries[e];
+      ws.x[entry.row * nb + entry.col - m0] += entry.coefficient;
+    }
+    // One-index transformations x -> y -> x -> y with C^T.
+    const std::size_t stride_a = n2 * n3 * nb;
+    for (std::size_t j = 0; j < group.num_jab; j += 1) {
+      const std::size_t offset = j * n1 * stride_a;
+      Gemm(
+          GemmOp::kTranspose,
+          GemmOp::kNormal,
+          n1,
+          stride_a,
+          n1,
+          1.0,
+          c1,
+          n1,
+          ws.x.data() + offset,
+          stride_a,
+          0.0,
+          ws.y.data() + offset,
+          stride_a);
+    }
+    const std::size_t stride_b = n3 * nb;
+    for (std::size_t r = 0; r < group.num_jab * n1; r += 1) {
+      const std::size_t offset = r * n2 * stride_b;
+      Gemm(
+          GemmOp::kTranspose,
+          GemmOp::kNormal,
+          n2,
+          stride_b,
+          n2,
+          1.0,
+          c2,
+          n2,
+          ws.y.data() + offset,
+          stride_b,
+          0.0,
+          ws.x.data() + offset,
+          stride_b);
+    }
+    for (std::size_t r = 0; r < group.num_jab * n1 * n2; r += 1) {
+      const std::size_t offset = r * n3 * nb;
+      Gemm(
+          GemmOp::kTranspose,
+          GemmOp::kNormal,
+          n3,
+          nb,
+          n3,
+          1.0,
+          c3,
+          n3,
+          ws.x.data() + offset,
+          nb,
+          0.0,
+          ws.y.data() + offset,
+          nb);
+    }
+    // Rows of canonical states.
+    for (std::size_t i = 0; i < dim; i += 1) {
+      const ThreeBodyState st =
+          channel.States()[ws.members[group.begin + i]];
+      const std::size_t r =
+          ProductRow(group, sp, st.a, st.b, st.c, st.two_jab);
+      const double* src = ws.y.data() + r * nb;
+      std::copy(src, src + nb, f + i * dim + m0);
+    }
+  }
+}
+
+void TransformChannel(
+    const ThreeBodyOperator& in,
+    const OneBodyOperator& basis,
+    ThreeBodyChannelIndex ch,
+    const ThreeBodyTransformOptions& options,
+    ThreeBodyOperator& out,
+    Workspace& ws) {
+  const ThreeBodyChannel& channel = in.ModelSpace().Channel(ch);
+  const std::size_t n = channel.Dimension();
+  BuildGroups(channel, basis.SP(), ws);
+  ws.f_offsets.assign(1, 0UL);
+  for (const Group& group : ws.groups) {
+    ws.f_offsets.push_back(
+        ws.f_offsets.back() + group.Dimension() * group.Dimension());
+  }
+  ws.f.resize(ws.f_offsets.back());
+  for (std::size_t g = 0; g < ws.groups.size(); g += 1) {
+    ComputeGroupTransform(
+        channel,
+        basis,
+        ws.groups[g],
+        std::max<std::size_t>(options.block_columns, 1),
+        ws,
+        ws.f.data() + ws.f_offsets[g]);
+  }
+
+  const Hermiticity h = in.Symmetry();
+  const bool symmetric = IsSymmetric(h);
+  const double sign = HermiticitySign(h);
+  const Hermiticity stored_h = in.IsPacked() ? h : Hermiticity::kNone;
+  const bool packed = out.IsPacked();
+  const ThreeBodyChannelView view = in.Read(ch);
+  const double* w = view.Data();
+  const ThreeBodyChannelRef ref = out.Write(ch);
+  double* result = ref.MutableData();
+  std::fill(result, result + out.ChannelSize(ch), 0.0);
+
+  for (std::size_t g = 0; g < ws.groups.size(); g += 1) {
+    const Group& group = ws.groups[g];
+    const std::size_t dim = group.Dimension();
+    // Symmetric operators only need the panels right of the diagonal.
+    const std::size_t col_begin = symmetric ? group.begin : 0;
+    const std::size_t width = n - col_begin;
+    ws.p.resize(dim * width);
+    ws.q.resize(dim * width);
+    for (std::size_t i = 0; i < dim; i += 1) {
+      const std::size_t ci = ws.members[group.begin + i];
+      double* row = ws.p.data() + i * width;
+      for (std::size_t j = 0; j < width; j += 1) {
+        const std::size_t cj = ws.members[col_begin + j];
+        row[j] = BlockElement(w, n, stored_h, ci, cj);
+      }
+    }
+    // q = p F^T (block diagonal), p = F_g q.
+    for (std::size_t k = symmetric ? g : 0; k < ws.groups.size(); k += 1) {
+      const Group& other = ws.groups[k];
+      const std::size_t offset = other.begin - col_begin;
+      Gemm(
+          GemmOp::kNormal,
+          GemmOp::kTranspose,
+          dim,
+          other.Dimension(),
+          other.Dimension(),
+          1.0,
+          ws.p.data() + offset,
+          width,
+          ws.f.data() + ws.f_offsets[k],
+          other.Dimension(),
+          0.0,
+          ws.q.data() + offset,
+          width);
+    }
+    Gemm(
+        GemmOp::kNormal,
+        GemmOp::kNormal,
+        dim,
+        width,
+        dim,
+        1.0,
+        ws.f.data() + ws.f_offsets[g],
+        dim,
+        ws.q.data(),
+        width,
+        0.0,
+        ws.p.data(),
+        width);
+
+    for (std::size_t i = 0; i < dim; i += 1) {
+      const std::size_t ci = ws.members[group.begin + i];
+      const double* row = ws.p.data() + i * width;
+      for (std::size_t j = 0; j < width; j += 1) {
+        const std::size_t cj = ws.members[col_begin + j];
+        if (!symmetric) {
+          result[ci * n + cj] = row[j];
+        } else if (packed) {
+          if (ci <= cj) {
+            result[PackedIndex(ci, cj)] = row[j];
+          } else {
+            result[PackedIndex(cj, ci)] = sign * row[j];
+          }
+        } else {
+          result[ci * n + cj] = row[j];
+          result[cj * n + ci] = sign * row[j];
+        }
+      }
+    }
+  }
+}
+
+}  // namespace
+
+bool TransformBasis(
+    const ThreeBodyOperator& in,
+    const OneBodyOperator& basis,
+    ThreeBodyOperator& out,
+    const ThreeBodyTransformOptions& options) {
+  const ThreeBodyModelSpace& ms = in.ModelSpace();
+  if (&basis.SP() != &ms.SP() || basis.Symmetry() != Hermiticity::kNone ||
+      !out.IsCompatible(in) || &out == &in) {
+    return false;
+  }
+
+  // Largest channels first for load balance.
+  std::vector<std::size_t> order;
+  for (const auto ch : ms.ChannelIndices()) {
+    if (in.IsMaterialized(ch)) {
+      order.push_back(ch.idx());
+    }
+  }
+  std::stable_sort(
+      order.begin(),
+      order.end(),
+      [&in](std::size_t x, std::size_t y) {
+        return in.ChannelSize(ThreeBodyChannelIndex(x)) >
+               in.ChannelSize(ThreeBodyChannelIndex(y));
+      });
+
+  const std::size_t num_channels = order.size();
+#pragma omp parallel num_threads(NumParallelThreads())
+  {
+    Workspace ws;
+#pragma omp for schedule(dynamic)
+    for (std::size_t c = 0; c < num_channels; c += 1) {
+      TransformChannel(
+          in,
+          basis,
+          ThreeBodyChannelIndex(order[c]),
+          options,
+          out,
+          ws);
+    }
+  }
+  return true;
+}
+
+}  // namespace nui
@@ -0,0 +1,83 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_OPERATORS_ACTIONS_3B_BASIS_TRANSFORM_H_
+#define NUI_PHYSICS_OPERATORS_ACTIONS_3B_BASIS_TRANSFORM_H_
+
+// IWYU pragma: private, include "nui/physics/operators/actions/3b/op_actions_3b.h"
+// IWYU pragma: friend "nui/physics/operators/actions/3b/.*\.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/operators/storage/1b/op_1b.h"
+#include "nui/physics/operators/storage/3b/op_3b.h"
+
+// Transformation of 3-body operators to a new single-particle basis
+// (e.g., from the harmonic oscillator to the Hartree-Fock basis),
+//
+//   |p> = sum_alpha C_alpha,p |alpha>,
+//
+// with C orthogonal within each partial wave.
+//
+// The transformation only mixes canonical states of a channel whose orbitals
+// have the same partial waves (P1, P2, P3). For each such group, the
+// canonical states are expanded in the product basis |(ab) J_ab, c> with
+// a in P1, b in P2, c in P3 (see ExpandThreeBodyState()), and the product
+// basis is transformed by three one-index transformations, each a batch of
+// GEMMs with C^T. Restricting the result to canonical states gives the
+// transformation matrix F of the group, and
+//
+//   W' = F W F^T
+//
+// is evaluated with F block diagonal: one row panel of W per group is
+// multiplied with F^T of all groups (only the upper panels for symmetric
+// operators) and then with F of its group. Truncated states are dropped
+// before and after the transformation, as in a direct summation over the
+// model space.
+//
+// Channels are processed in parallel, largest first. Scratch memory per
+// thread is F of all groups and two row panels of the current channel, and
+// the product basis expansion of block_columns states at a time.
+
+namespace nui {
+
+// Options of 3-body basis transformations.
+struct ThreeBodyTransformOptions {
+  // Number of canonical states transformed in the product basis at once.
+  std::size_t block_columns = 64;
+};
+
+// Transform in to the basis with basis.Get(alpha, p) = C_alpha,p and write
+// the result into out.
+//
+// Only channels materialized in in are written (and overwritten) in out.
+// Returns false (and does nothing) if basis does not have the
+// single-particle model space of in or is not stored in full (Hermiticity
+// kNone), or if out is not compatible with in or is in.
+bool TransformBasis(
+    const ThreeBodyOperator& in,
+    const OneBodyOperator& basis,
+    ThreeBodyOperator& out,
+    const ThreeBodyTransformOptions& options = {});
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_OPERATORS_ACTIONS_3B_BASIS_TRANSFORM_H_
@@ -0,0 +1,134 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cmath>
+#include <cstdlib>
+
+#include "fmt/core.h"
+#include "nui/core/basics/basics.h"
+#include "nui/info/profiling/profiling.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/actions/3b/op_actions_3b.h"
+#include "nui/physics/operators/storage/1b/op_1b.h"
+#include "nui/physics/operators/storage/3b/op_3b.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+
+// Benchmark of the basis transformation of a 3-body operator.
+//
+// Usage: nui_..._basis_transform_bench [emax] [e3max] [block_columns]
+//
+// The operator is transformed with a rotation in each partial wave and back,
+// and the largest deviation from the original elements is reported. The
+// round trip is only exact for e3max = 3 * emax, since rotations mix orbitals
+// across the e3max truncation otherwise.
+
+namespace {
+
+// Rotate neighboring orbitals of each partial wave by angle.
+nui::OneBodyOperator MakeBasis(
+    std::shared_ptr<const nui::SPModelSpace> sp,
+    double angle) {
+  nui::OneBodyOperator basis(sp, nui::Hermiticity::kNone);
+  for (const auto pw : sp->PartialWaveIndices()) {
+    const std::size_t first = sp->PartialWaveBegin(pw).idx();
+    const std::size_t n = sp->PartialWaveSize(pw);
+    for (std::size_t a = 0; a < n; a += 1) {
+      const nui::OrbitalIndex x(first + a);
+      basis.Set(x, x, 1.0);
+    }
+    for (std::size_t a = 0; a + 1 < n; a += 2) {
+      const nui::OrbitalIndex x(first + a);
+      const nui::OrbitalIndex y(first + a + 1);
+      basis.Set(x, x, std::cos(angle));
+      basis.Set(x, y, -std::sin(angle));
+      basis.Set(y, x, std::sin(angle));
+      basis.Set(y, y, std::cos(angle));
+    }
+  }
+  return basis;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int emax = argc > 1 ? std::atoi(argv[1]) : 4;
+  const int e3max = argc > 2 ? std::atoi(argv[2]) : 8;
+  nui::ThreeBodyTransformOptions options;
+  if (argc > 3) {
+    options.block_columns = static_cast<std::size_t>(std::atoi(argv[3]));
+  }
+
+  const auto sp = nui::SPModelSpace::Make(
+      nui::SPTruncation(emax),
+      nui::Reference::HOEqualFilling(8, 8));
+  const auto ms =
+      nui::ThreeBodyModelSpace::Make(sp, nui::ThreeBodyTruncation(e3max));
+  nui::ThreeBodyOperator w(ms, nui::Hermiticity::kHermitian);
+  // Elements of overcomplete states |(ab) J_ab, b> are left zero.
+  w.StreamChannelsMutable([&ms](nui::ThreeBodyChannelIndex ch, double* block) {
+    const auto& states = ms->Channel(ch).States();
+    for (std::size_t j = 0; j < states.size(); j += 1) {
+      for (std::size_t i = 0; i <= j; i += 1) {
+        const bool overcomplete =
+            states[i].b == states[i].c || states[j].b == states[j].c;
+        const double x = 1.0 / (1.0 + static_cast<double>((i + j) % 97));
+        block[nui::PackedIndex(i, j)] = overcomplete ? 0.0 : x;
+      }
+    }
+  });
+  fmt::print(
+      "emax = {}, e3max = {}, 3-body channels = {}, 3-body = {:.1f} MB\n",
+      emax,
+      e3max,
+      ms->NumChannels(),
+      w.TotalSize() * sizeof(double) * 1e-6);
+
+  const double angle = 0.3;
+  nui::ThreeBodyOperator there(ms, nui::Hermiticity::kHermitian);
+  nui::ThreeBodyOperator back(ms, nui::Hermiticity::kHermitian);
+  const double forward = nui::TimeSeconds([&]() {
+    nui::TransformBasis(w, MakeBasis(sp, angle), there, options);
+  });
+  const double inverse = nui::TimeSeconds([&]() {
+    nui::TransformBasis(there, MakeBasis(sp, -angle), back, options);
+  });
+  double diff = 0.0;
+  for (const auto ch : ms->ChannelIndices()) {
+    const nui::ThreeBodyChannelView x = w.Read(ch);
+    const nui::ThreeBodyChannelView y = back.Read(ch);
+    for (std::size_t i = 0; i < w.ChannelSize(ch); i += 1) {
+      diff = std::max(diff, std::abs(x.Data()[i] - y.Data()[i]));
+    }
+  }
+  fmt::print(
+      "{:<24} {:>10.3f} ms  {:>8.1f} MB/s\n",
+      "TransformBasis",
+      forward * 1e3,
+      w.TotalSize() * sizeof(double) * 1e-6 / forward);
+  fmt::print(
+      "{:<24} {:>10.3f} ms  max |W - W_back| = {:.2e}\n",
+      "TransformBasis (back)",
+      inverse * 1e3,
+      diff);
+  return 0;
+}
@@ -0,0 +1,244 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/actions/3b/basis_transform.h"
+
+#include <cmath>
+#include <vector>
+
+#include "catch2/catch_approx.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "nui/core/basics/basics.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/actions/3b/recoupling.h"
+#include "nui/physics/operators/storage/1b/op_1b.h"
+#include "nui/physics/operators/storage/3b/op_3b.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+#include "nui/physics/operators/storage/testing/op_testing.h"
+
+namespace {
+
+using nui::Hermiticity;
+using nui::OrbitalIndex;
+using nui::ThreeBodyChannelIndex;
+using nui::ThreeBodyStateIndex;
+using nui::testing::Fill;
+using nui::testing::MakeSP;
+
+// Make orthogonal basis (Gram-Schmidt of smooth columns) in each partial
+// wave, or its transpose.
+nui::OneBodyOperator MakeBasis(
+    std::shared_ptr<const nui::SPModelSpace> sp,
+    bool transpose) {
+  nui::OneBodyOperator basis(sp, Hermiticity::kNone);
+  for (const auto pw : sp->PartialWaveIndices()) {
+    const std::size_t n = sp->PartialWaveSize(pw);
+    std::vector<double> q(n * n, 0.0);
+    for (std::size_t p = 0; p < n; p += 1) {
+      for (std::size_t a = 0; a < n; a += 1) {
+        q[a * n + p] = (a == p ? 2.0 : 0.0) + std::cos(1.0 + a + 2.3 * p);
+      }
+      for (std::size_t r = 0; r < p; r += 1) {
+        double overlap = 0.0;
+        for (std::size_t a = 0; a < n; a += 1) {
+          overlap += q[a * n + r] * q[a * n + p];
+        }
+        for (std::size_t a = 0; a < n; a += 1) {
+          q[a * n + p] -= overlap * q[a * n + r];
+        }
+      }
+      double norm = 0.0;
+      for (std::size_t a = 0; a < n; a += 1) {
+        norm += q[a * n + p] * q[a * n + p];
+      }
+      for (std::size_t a = 0; a < n; a += 1) {
+        q[a * n + p] /= std::sqrt(norm);
+      }
+    }
+    const std::size_t first = sp->PartialWaveBegin(pw).idx();
+    for (std::size_t a = 0; a < n; a += 1) {
+      for (std::size_t p = 0; p < n; p += 1) {
+        basis.Set(
+            OrbitalIndex(first + a),
+            OrbitalIndex(first + p),
+            transpose ? q[p * n + a] : q[a * n + p]);
+      }
+    }
+  }
+  return basis;
+}
+
+// Get transformed elements of channel ch by expanding each canonical state
+// in the old basis, W' = V W V^T with V_ik = sum_a'b'c' C C C <k|(a'b')c'>.
+std::vector<double> Direct(
+    const nui::ThreeBodyOperator& w,
+    const nui::OneBodyOperator& basis,
+    ThreeBodyChannelIndex ch) {
+  const nui::SPModelSpace& sp = basis.SP();
+  const auto& channel = w.ModelSpace().Channel(ch);
+  const std::size_t n = channel.Dimension();
+  std::vector<double> v(n * n, 0.0);
+  std::vector<nui::ThreeBodyTerm> terms;
+  for (const auto i : channel.StateIndices()) {
+    const auto st = channel.State(i);
+    const auto pw_a = sp.PartialWaveOf(OrbitalIndex(st.a));
+    const auto pw_b = sp.PartialWaveOf(OrbitalIndex(st.b));
+    const auto pw_c = sp.PartialWaveOf(OrbitalIndex(st.c));
+    for (const auto a : sp.PartialWaveOrbitals(pw_a)) {
+      for (const auto b : sp.PartialWaveOrbitals(pw_b)) {
+        for (const auto c : sp.PartialWaveOrbitals(pw_c)) {
+          const double coefficient =
+              basis.Get(a, OrbitalIndex(st.a)) *
+              basis.Get(b, OrbitalIndex(st.b)) *
+              basis.Get(c, OrbitalIndex(st.c));
+          terms.clear();
+          nui::ExpandThreeBodyState(channel, sp, a, b, st.two_jab, c, terms);
+          for (const auto& t : terms) {
+            v[i.idx() * n + t.state] += coefficient * t.coefficient;
+          }
+        }
+      }
+    }
+  }
+  std::vector<double> vw(n * n, 0.0);
+  for (std::size_t i = 0; i < n; i += 1) {
+    for (std::size_t k = 0; k < n; k += 1) {
+      if (v[i * n + k] == 0.0) {
+        continue;
+      }
+      for (std::size_t l = 0; l < n; l += 1) {
+        const double x =
+            w.Get(ch, ThreeBodyStateIndex(k), ThreeBodyStateIndex(l));
+        vw[i * n + l] += v[i * n + k] * x;
+      }
+    }
+  }
+  std::vector<double> out(n * n, 0.0);
+  for (std::size_t i = 0; i < n; i += 1) {
+    for (std::size_t j = 0; j < n; j += 1) {
+      double sum = 0.0;
+      for (std::size_t l = 0; l < n; l += 1) {
+        sum += vw[i * n + l] * v[j * n + l];
+      }
+      out[i * n + j] = sum;
+    }
+  }
+  return out;
+}
+
+void RequireEqual(
+    const nui::ThreeBodyOperator& x,
+    const nui::ThreeBodyOperator& y) {
+  for (const auto ch : x.ModelSpace().ChannelIndices()) {
+    for (const auto i : x.ModelSpace().Channel(ch).StateIndices()) {
+      for (const auto j : x.ModelSpace().Channel(ch).StateIndices()) {
+        REQUIRE(
+            x.Get(ch, i, j) ==
+            Catch::Approx(y.Get(ch, i, j)).margin(1e-10));
+      }
+    }
+  }
+}
+
+}  // namespace
+
+TEST_CASE("TransformBasis, Test against direct expansion.") {
+  const auto sp = MakeSP(2);
+  const auto ms =
+      nui::ThreeBodyModelSpace::Make(sp, nui::ThreeBodyTruncation(4));
+  const nui::OneBodyOperator basis = MakeBasis(sp, false);
+  for (const auto h :
+       {Hermiticity::kHermitian,
+        Hermiticity::kAntihermitian,
+        Hermiticity::kNone}) {
+    for (const bool packed : {true, false}) {
+      nui::ThreeBodyStorageOptions options;
+      options.packed = packed;
+      nui::ThreeBodyOperator w(ms, h, options);
+      Fill(1.0, w);
+      nui::ThreeBodyOperator out(ms, h, options);
+      nui::ThreeBodyTransformOptions transform_options;
+      transform_options.block_columns = 5;
+      REQUIRE(nui::TransformBasis(w, basis, out, transform_options));
+
+      double norm = 0.0;
+      for (const auto ch : ms->ChannelIndices()) {
+        const std::vector<double> expected = Direct(w, basis, ch);
+        const std::size_t n = ms->Channel(ch).Dimension();
+        for (std::size_t i = 0; i < n; i += 1) {
+          for (std::size_t j = 0; j < n; j += 1) {
+            REQUIRE(
+                out.Get(ch, ThreeBodyStateIndex(i), ThreeBodyStateIndex(j)) ==
+                Catch::Approx(expected[i * n + j]).margin(1e-10));
+            norm += expected[i * n + j] * expected[i * n + j];
+          }
+        }
+      }
+      REQUIRE(norm > 1.0);
+    }
+  }
+}
+
+TEST_CASE("TransformBasis, Test identity and round trip.") {
+  const auto sp = MakeSP(2);
+  // No truncation beyond emax, so the transform is unitary.
+  const auto ms =
+      nui::ThreeBodyModelSpace::Make(sp, nui::ThreeBodyTruncation(6));
+  nui::ThreeBodyOperator w(ms, Hermiticity::kHermitian);
+  Fill(1.0, w);
+
+  nui::OneBodyOperator identity(sp, Hermiticity::kNone);
+  for (const auto a : sp->OrbitalIndices()) {
+    identity.Set(a, a, 1.0);
+  }
+  nui::ThreeBodyOperator same(ms, Hermiticity::kHermitian);
+  REQUIRE(nui::TransformBasis(w, identity, same));
+  RequireEqual(same, w);
+
+  nui::ThreeBodyOperator there(ms, Hermiticity::kHermitian);
+  nui::ThreeBodyOperator back(ms, Hermiticity::kHermitian);
+  REQUIRE(nui::TransformBasis(w, MakeBasis(sp, false), there));
+  REQUIRE(nui::TransformBasis(there, MakeBasis(sp, true), back));
+  RequireEqual(back, w);
+}
+
+TEST_CASE("TransformBasis, Test argument checks.") {
+  const auto sp = MakeSP(2);
+  const auto ms =
+      nui::ThreeBodyModelSpace::Make(sp, nui::ThreeBodyTruncation(3));
+  nui::ThreeBodyOperator w(ms, Hermiticity::kHermitian);
+  nui::ThreeBodyOperator out(ms, Hermiticity::kHermitian);
+  nui::ThreeBodyOperator anti(ms, Hermiticity::kAntihermitian);
+  const nui::OneBodyOperator basis = MakeBasis(sp, false);
+  const nui::OneBodyOperator symmetric(sp, Hermiticity::kHermitian);
+  REQUIRE_FALSE(nui::TransformBasis(w, symmetric, out));
+  REQUIRE_FALSE(nui::TransformBasis(w, basis, anti));
+  REQUIRE_FALSE(nui::TransformBasis(w, basis, w));
+  REQUIRE_FALSE(nui::TransformBasis(
+      w,
+      MakeBasis(
+          nui::SPModelSpace::Make(nui::SPTruncation(3), nui::Reference()),
+          false),
+      out));
+  REQUIRE(nui::TransformBasis(w, basis, out));
+}
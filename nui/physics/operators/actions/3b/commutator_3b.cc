@@ -0,0 +1,769 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/actions/3b/commutator_3b.h"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/memory/memory.h"
+#include "nui/info/runtime/runtime.h"
+#include "nui/physics/coupling/coupling.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/actions/3b/recoupling.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+#include "nui/physics/operators/storage/3b/op_3b.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+#include "nui/tensor/contraction/tensor_contraction.h"
+
+namespace nui {
+
+namespace {
+
+double Phase(int two_x) { return (two_x / 2) % 2 == 0 ? 1.0 : -1.0; }
+
+// Product state |(xy) J, s; J3> (x <= y), i.e., state k of 2-body channel
+// ch2 with spectator s.
+struct ProductState {
+  std::uint32_t ch2 = 0;
+  std::uint32_t s = 0;
+  std::uint32_t k = 0;
+};
+
+// Coefficient of canonical state in product state (or vice versa).
+struct Triplet {
+  std::uint64_t key = 0;
+  ThreeBodyTerm term;
+};
+
+// Product states of a 3-body channel with sparse coefficients on canonical
+// states, grouped by (ch2, s).
+struct ProductBasis {
+  std::vector<ProductState> states;
+  // Terms [begin[p], begin[p + 1]) of product state p.
+  std::vector<std::size_t> begin;
+  std::vector<ThreeBodyTerm> terms;
+  // Groups [groups[g], groups[g + 1]) of product states.
+  std::vector<std::size_t> groups;
+  std::vector<Triplet> triplets;
+};
+
+// Scratch of one thread.
+struct Workspace {
+  ProductBasis basis;
+  std::vector<ThreeBodyTerm> terms;
+  std::vector<std::uint32_t> orbitals;
+  std::vector<double> weights;
+  std::vector<double> recouplings;
+  std::vector<std::size_t> columns;
+  AlignedVector<double> x;
+  AlignedVector<double> y;
+  AlignedVector<double> left;
+  AlignedVector<double> right;
+  // Unnormalized 2-body blocks (empty until first touched).
+  std::vector<AlignedVector<double>> blocks;
+  std::vector<AlignedVector<double>> transposed_blocks;
+};
+
+// Get energy of canonical state.
+int Energy(const SPModelSpace& sp, ThreeBodyState st) {
+  return sp.Orbital(OrbitalIndex(st.a)).E() +
+         sp.Orbital(OrbitalIndex(st.b)).E() +
+         sp.Orbital(OrbitalIndex(st.c)).E();
+}
+
+// Get index of 2-body channel of |xy; J>.
+TwoBodyChannelIndex PairChannel(
+    const TwoBodyModelSpace& ms2,
+    OrbitalIndex x,
+    OrbitalIndex y,
+    int two_j) {
+  const auto ox = ms2.SP().Orbital(x);
+  const auto oy = ms2.SP().Orbital(y);
+  return ms2.ChannelIndex(
+      PackedChannel(two_j, (ox.L() + oy.L()) % 2, ox.TwoTz() + oy.TwoTz()));
+}
+
+// Add coefficient of canonical state to product state |(xy) J, s> (x <= y).
+void AddTriplet(
+    const TwoBodyModelSpace& ms2,
+    OrbitalIndex x,
+    OrbitalIndex y,
+    int two_j,
+    OrbitalIndex s,
+    ThreeBodyTerm term,
+    std::vector<Triplet>& triplets) {
+  if (term.coefficient == 0.0 || (x == y && (two_j / 2) % 2 == 1)) {
+    return;
+  }
+  const TwoBodyChannelIndex ch2 = PairChannel(ms2, x, y, two_j);
+  if (ch2 == TwoBodyChannelIndex::Invalid()) {
+    return;
+  }
+  const TwoBodyStateIndex k = ms2.StateIndex(ch2, x, y);
+  if (k == TwoBodyStateIndex::Invalid()) {
+    return;
+  }
+  Triplet triplet;
+  triplet.key = (static_cast<std::uint64_t>(ch2.idx()) << 40) |
+                (static_cast<std::uint64_t>(s.idx()) << 24) |
+                static_cast<std::uint64_t>(k.idx());
+  triplet.term = term;
+  triplets.push_back(triplet);
+}
+
+// Sort triplets into product states and groups.
+void FinishBasis(ProductBasis& basis) {
+  std::stable_sort(
+      basis.triplets.begin(),
+      basis.triplets.end(),
+      [](const auto& x, const auto& y) { return x.key < y.key; });
+  basis.states.clear();
+  basis.begin.clear();
+  basis.terms.clear();
+  basis.groups.clear();
+  for (std::size_t t = 0; t < basis.triplets.size(); t += 1) {
+    const std::uint64_t key = basis.triplets[t].key;
+    if (t == 0 || key != basis.triplets[t - 1].key) {
+      ProductState state;
+      state.ch2 = static_cast<std::uint32_t>(key >> 40);
+      state.s = static_cast<std::uint32_t>((key >> 24) & 0xFFFFUL);
+      state.k = static_cast<std::uint32_t>(key & 0xFFFFFFUL);
+      if (t == 0 || (key >> 24) != (basis.triplets[t - 1].key >> 24)) {
+        basis.groups.push_back(basis.states.size());
+      }
+      basis.begin.push_back(basis.terms.size());
+      basis.states.push_back(state);
+    }
+    basis.terms.push_back(basis.triplets[t].term);
+  }
+  basis.begin.push_back(basis.terms.size());
+  basis.groups.push_back(basis.states.size());
+}
+
+// Build product states of the cyclic images of canonical states,
+//
+//   W_(ab)J c = X_(ab)J c + sum_J' R X_(bc)J' a + sum_J'' R X_(ca)J'' b,
+//
+// with coefficients of canonical states in product states.
+void BuildCyclicBasis(
+    const ThreeBodyChannel& channel,
+    const TwoBodyModelSpace& ms2,
+    int e3max,
+    ProductBasis& basis) {
+  const SPModelSpace& sp = ms2.SP();
+  const int two_j3 = channel.QuantumNumbers().TwoJ();
+  basis.triplets.clear();
+  const auto& states = channel.States();
+  for (std::size_t i = 0; i < states.size(); i += 1) {
+    const ThreeBodyState st = states[i];
+    if (e3max >= 0 && Energy(sp, st) > e3max) {
+      continue;
+    }
+    const OrbitalIndex a(st.a);
+    const OrbitalIndex b(st.b);
+    const OrbitalIndex c(st.c);
+    const int ja = sp.Orbital(a).TwoJ();
+    const int jb = sp.Orbital(b).TwoJ();
+    const int jc = sp.Orbital(c).TwoJ();
+    ThreeBodyTerm term;
+    term.state = static_cast<std::uint32_t>(i);
+    term.coefficient = 1.0;
+    AddTriplet(ms2, a, b, st.two_jab, c, term, basis.triplets);
+    for (int two_j = std::abs(jb - jc); two_j <= jb + jc; two_j += 2) {
+      term.coefficient =
+          CyclicRecoupling(ja, jb, jc, st.two_jab, two_j, two_j3);
+      AddTriplet(ms2, b, c, two_j, a, term, basis.triplets);
+    }
+    for (int two_j = std::abs(ja - jc); two_j <= ja + jc; two_j += 2) {
+      term.coefficient =
+          CyclicRecoupling(jc, ja, jb, two_j, st.two_jab, two_j3) *
+          SwapPhase(jc, ja, two_j);
+      AddTriplet(ms2, a, c, two_j, b, term, basis.triplets);
+    }
+  }
+  FinishBasis(basis);
+}
+
+// Build product states |(xy) J, s> with their expansion in canonical states.
+void BuildExpansionBasis(
+    const ThreeBodyChannel& channel,
+    const TwoBodyModelSpace& ms2,
+    int e3max,
+    ProductBasis& basis,
+    std::vector<ThreeBodyTerm>& terms) {
+  const SPModelSpace& sp = ms2.SP();
+  const int two_j3 = channel.QuantumNumbers().TwoJ();
+  basis.triplets.clear();
+  const auto add = [&](OrbitalIndex x, OrbitalIndex y, OrbitalIndex s) {
+    const int jx = sp.Orbital(x).TwoJ();
+    const int jy = sp.Orbital(y).TwoJ();
+    const int js = sp.Orbital(s).TwoJ();
+    for (int two_j = std::abs(jx - jy); two_j <= jx + jy; two_j += 2) {
+      if (!IsTriangle(two_j, js, two_j3)) {
+        continue;
+      }
+      terms.clear();
+      ExpandThreeBodyState(channel, sp, x, y, two_j, s, terms);
+      for (const ThreeBodyTerm& t : terms) {
+        AddTriplet(ms2, x, y, two_j, s, t, basis.triplets);
+      }
+    }
+  };
+  const auto& states = channel.States();
+  for (std::size_t r = 0; r < states.size(); r += 1) {
+    const ThreeBodyState st = states[r];
+    if ((r > 0 && states[r - 1].a == st.a && states[r - 1].b == st.b &&
+         states[r - 1].c == st.c) ||
+        (e3max >= 0 && Energy(sp, st) > e3max)) {
+      continue;
+    }
+    const OrbitalIndex a(st.a);
+    const OrbitalIndex b(st.b);
+    const OrbitalIndex c(st.c);
+    add(b, c, a);
+    if (b != a) {
+      add(a, c, b);
+    }
+    if (c != b) {
+      add(a, b, c);
+    }
+  }
+  FinishBasis(basis);
+}
+
+// Get unnormalized <ab; J| O |cd; J> for any orbital order.
+double Unnormalized(
+    const TwoBodyOperator& op,
+    TwoBodyChannelIndex ch,
+    OrbitalIndex a,
+    OrbitalIndex b,
+    OrbitalIndex c,
+    OrbitalIndex d) {
+  const double norm =
+      (a == b ? std::sqrt(2.0) : 1.0) * (c == d ? std::sqrt(2.0) : 1.0);
+  return norm * op.Get(ch, a, b, c, d);
+}
+
+// Add [2,2]->3 contributions to channel ch of out.
+void Commutator223Channel(
+    const TwoBodyOperator& a,
+    const TwoBodyOperator& b,
+    double scale,
+    ThreeBodyChannelIndex ch,
+    int e3max,
+    ThreeBodyOperator& out,
+    Workspace& ws) {
+  const TwoBodyModelSpace& ms2 = a.ModelSpace();
+  const SPModelSpace& sp = ms2.SP();
+  const ThreeBodyChannel& channel = out.ModelSpace().Channel(ch);
+  const std::size_t n = channel.Dimension();
+  const int two_j3 = channel.QuantumNumbers().TwoJ();
+  ProductBasis& basis = ws.basis;
+  BuildCyclicBasis(channel, ms2, e3max, basis);
+  const std::size_t num_products = basis.states.size();
+  if (num_products == 0) {
+    return;
+  }
+  const ThreeBodyChannelRef ref = out.Write(ch);
+  double* result = ref.MutableData();
+  const bool packed = out.IsPacked();
+
+  for (std::size_t g = 0; g + 1 < basis.groups.size(); g += 1) {
+    const std::size_t r0 = basis.groups[g];
+    const std::size_t nr = basis.groups[g + 1] - r0;
+    const TwoBodyChannelIndex ch1(basis.states[r0].ch2);
+    const OrbitalIndex k(basis.states[r0].s);
+    const auto& channel1 = ms2.Channel(ch1);
+    const int two_j1 = ms2.ChannelQuantumNumbers(ch1).TwoJ();
+    const int jk = sp.Orbital(k).TwoJ();
+
+    // X_(ij)J1 k,(mn)J2 l for all product states (mn)J2 l.
+    ws.x.assign(nr * num_products, 0.0);
+    for (std::size_t h = 0; h + 1 < basis.groups.size(); h += 1) {
+      const std::size_t q0 = basis.groups[h];
+      const std::size_t nc = basis.groups[h + 1] - q0;
+      const TwoBodyChannelIndex ch2(basis.states[q0].ch2);
+      const OrbitalIndex l(basis.states[q0].s);
+      const auto& channel2 = ms2.Channel(ch2);
+      const int two_j2 = ms2.ChannelQuantumNumbers(ch2).TwoJ();
+      const int jl = sp.Orbital(l).TwoJ();
+
+      // Intermediate orbitals with |la; J1> and |ak; J2> in the model space
+      // and recoupling weight
+      //   <((la)J1, k) J3| (l, (ak)J2) J3> (-1)^(J2 + j_l - J3).
+      ws.orbitals.clear();
+      ws.weights.clear();
+      for (const auto x : sp.OrbitalIndices()) {
+        const int jx = sp.Orbital(x).TwoJ();
+        if (!IsTriangle(jl, jx, two_j1) || !IsTriangle(jx, jk, two_j2)) {
+          continue;
+        }
+        if (PairChannel(ms2, l, x, two_j1) != ch1 ||
+            PairChannel(ms2, x, k, two_j2) != ch2 ||
+            ms2.StateIndex(ch1, std::min(l, x), std::max(l, x)) ==
+                TwoBodyStateIndex::Invalid() ||
+            ms2.StateIndex(ch2, std::min(x, k), std::max(x, k)) ==
+                TwoBodyStateIndex::Invalid()) {
+          continue;
+        }
+        const double weight =
+            Phase(jl + jx + jk + two_j3) * Phase(two_j2 + jl - two_j3) *
+            std::sqrt((two_j1 + 1.0) * (two_j2 + 1.0)) *
+            SixJ(jl, jx, two_j1, jk, two_j3, two_j2);
+        if (weight == 0.0) {
+          continue;
+        }
+        ws.orbitals.push_back(static_cast<std::uint32_t>(x.idx()));
+        ws.weights.push_back(weight);
+      }
+      const std::size_t na = ws.orbitals.size();
+      if (na == 0) {
+        continue;
+      }
+
+      // X = [w A_ij,la | -w B_ij,la] [B_ak,mn; A_ak,mn].
+      ws.left.resize(nr * 2 * na);
+      for (std::size_t r = 0; r < nr; r += 1) {
+        const TwoBodyStateIndex ij(basis.states[r0 + r].k);
+        const OrbitalIndex i = channel1.First(ij);
+        const OrbitalIndex j = channel1.Second(ij);
+        double* row = ws.left.data() + r * 2 * na;
+        for (std::size_t t = 0; t < na; t += 1) {
+          const OrbitalIndex x(ws.orbitals[t]);
+          row[t] = ws.weights[t] * Unnormalized(a, ch1, i, j, l, x);
+          row[na + t] = -ws.weights[t] * Unnormalized(b, ch1, i, j, l, x);
+        }
+      }
+      ws.right.resize(2 * na * nc);
+      for (std::size_t t = 0; t < na; t += 1) {
+        const OrbitalIndex x(ws.orbitals[t]);
+        double* row_b = ws.right.data() + t * nc;
+        double* row_a = ws.right.data() + (na + t) * nc;
+        for (std::size_t q = 0; q < nc; q += 1) {
+          const TwoBodyStateIndex mn(basis.states[q0 + q].k);
+          const OrbitalIndex m = channel2.First(mn);
+          const OrbitalIndex o = channel2.Second(mn);
+          row_b[q] = Unnormalized(b, ch2, x, k, m, o);
+          row_a[q] = Unnormalized(a, ch2, x, k, m, o);
+        }
+      }
+      Gemm(
+          GemmOp::kNormal,
+          GemmOp::kNormal,
+          nr,
+          nc,
+          2 * na,
+          1.0,
+          ws.left.data(),
+          2 * na,
+          ws.right.data(),
+          nc,
+          0.0,
+          ws.x.data() + q0,
+          num_products);
+    }
+
+    // Y = X R^T on canonical kets, then W += scale R Y on canonical bras.
+    ws.y.assign(nr * n, 0.0);
+    for (std::size_t q = 0; q < num_products; q += 1) {
+      for (std::size_t t = basis.begin[q]; t < basis.begin[q + 1]; t += 1) {
+        const ThreeBodyTerm term = basis.terms[t];
+        for (std::size_t r = 0; r < nr; r += 1) {
+          ws.y[r * n + term.state] +=
+              term.coefficient * ws.x[r * num_products + q];
+        }
+      }
+    }
+    for (std::size_t r = 0; r < nr; r += 1) {
+      const std::size_t p = r0 + r;
+      const double* y = ws.y.data() + r * n;
+      for (std::size_t t = basis.begin[p]; t < basis.begin[p + 1]; t += 1) {
+        const ThreeBodyTerm term = basis.terms[t];
+        const double factor = scale * term.coefficient;
+        const std::size_t i = term.state;
+        if (packed) {
+          for (std::size_t j = i; j < n; j += 1) {
+            result[PackedIndex(i, j)] += factor * y[j];
+          }
+        } else {
+          for (std::size_t j = 0; j < n; j += 1) {
+            result[i * n + j] += factor * y[j];
+          }
+        }
+      }
+    }
+  }
+}
+
+// Accumulate U_ijkl = (1 - P_kl) 1/2 sum_abc f_abc W_ijcabl B_abck of 3-body
+// channel ch into unnormalized 2-body blocks (W and B transposed if
+// transpose).
+void Commutator322Channel(
+    const ThreeBodyOperator& w,
+    const TwoBodyOperator& b,
+    const std::vector<double>& occupations,
+    ThreeBodyChannelIndex ch,
+    const ThreeBodyCommutatorOptions& options,
+    bool transpose,
+    Workspace& ws,
+    std::vector<AlignedVector<double>>& blocks) {
+  const TwoBodyModelSpace& ms2 = b.ModelSpace();
+  const SPModelSpace& sp = ms2.SP();
+  const ThreeBodyChannel& channel = w.ModelSpace().Channel(ch);
+  const std::size_t n = channel.Dimension();
+  const int two_j3 = channel.QuantumNumbers().TwoJ();
+  ProductBasis& basis = ws.basis;
+  BuildExpansionBasis(channel, ms2, options.e3max, basis, ws.terms);
+  if (basis.states.empty()) {
+    return;
+  }
+  const ThreeBodyChannelView view = w.Read(ch);
+  const double* block = view.Data();
+  const Hermiticity stored_h =
+      w.IsPacked() ? w.Symmetry() : Hermiticity::kNone;
+
+  for (std::size_t g = 0; g + 1 < basis.groups.size(); g += 1) {
+    const std::size_t r0 = basis.groups[g];
+    const std::size_t nr = basis.groups[g + 1] - r0;
+    const TwoBodyChannelIndex ch1(basis.states[r0].ch2);
+    const OrbitalIndex c(basis.states[r0].s);
+    const int two_j = ms2.ChannelQuantumNumbers(ch1).TwoJ();
+    const int jc = sp.Orbital(c).TwoJ();
+    const std::size_t n1 = ms2.Channel(ch1).Dimension();
+    const double degeneracy = (two_j3 + 1.0) / (two_j + 1.0);
+
+    // Rows W_(ij)J c,K of the product states of the group.
+    ws.x.assign(nr * n, 0.0);
+    for (std::size_t r = 0; r < nr; r += 1) {
+      const std::size_t p = r0 + r;
+      double* row = ws.x.data() + r * n;
+      for (std::size_t t = basis.begin[p]; t < basis.begin[p + 1]; t += 1) {
+        const ThreeBodyTerm term = basis.terms[t];
+        for (std::size_t j = 0; j < n; j += 1) {
+          const double x =
+              transpose ? BlockElement(block, n, stored_h, j, term.state)
+                        : BlockElement(block, n, stored_h, term.state, j);
+          row[j] += term.coefficient * x;
+        }
+      }
+    }
+
+    for (std::size_t h = 0; h + 1 < basis.groups.size(); h += 1) {
+      const std::size_t q0 = basis.groups[h];
+      const std::size_t q1 = basis.groups[h + 1];
+      const TwoBodyChannelIndex ch2(basis.states[q0].ch2);
+      const OrbitalIndex l(basis.states[q0].s);
+      const auto& channel2 = ms2.Channel(ch2);
+      const int two_j2 = ms2.ChannelQuantumNumbers(ch2).TwoJ();
+      const int jl = sp.Orbital(l).TwoJ();
+
+      // Kets (ab) J2 l with occupation weight f_abc (1/2 for a == b).
+      ws.columns.clear();
+      ws.weights.clear();
+      const double n_c = occupations[c.idx()];
+      for (std::size_t q = q0; q < q1; q += 1) {
+        const TwoBodyStateIndex ab(basis.states[q].k);
+        const double n_a = occupations[channel2.First(ab).idx()];
+        const double n_b = occupations[channel2.Second(ab).idx()];
+        const double f =
+            n_a * n_b * (1.0 - n_c) + (1.0 - n_a) * (1.0 - n_b) * n_c;
+        if (std::abs(f) <= options.occupation_cutoff) {
+          continue;
+        }
+        ws.columns.push_back(q);
+        ws.weights.push_back(
+            channel2.First(ab) == channel2.Second(ab) ? 0.5 * f : f);
+      }
+      const std::size_t nq = ws.columns.size();
+      if (nq == 0) {
+        continue;
+      }
+
+      // Orbitals k with |ck; J2> and |kl; J> in the model space, and the
+      // recoupling of ((ck)J2, l) to ((kl)J, c).
+      ws.orbitals.clear();
+      ws.recouplings.clear();
+      for (const auto k : sp.OrbitalIndices()) {
+        const int jk = sp.Orbital(k).TwoJ();
+        if (!IsTriangle(jc, jk, two_j2) || !IsTriangle(jk, jl, two_j) ||
+            PairChannel(ms2, c, k, two_j2) != ch2 ||
+            PairChannel(ms2, k, l, two_j) != ch1 ||
+            ms2.StateIndex(ch2, std::min(c, k), std::max(c, k)) ==
+                TwoBodyStateIndex::Invalid() ||
+            ms2.StateIndex(ch1, std::min(k, l), std::max(k, l)) ==
+                TwoBodyStateIndex::Invalid()) {
+          continue;
+        }
+        const double recoupling =
+            CyclicRecoupling(jc, jk, jl, two_j2, two_j, two_j3);
+        if (recoupling == 0.0) {
+          continue;
+        }
+        ws.orbitals.push_back(static_cast<std::uint32_t>(k.idx()));
+        ws.recouplings.push_back(recoupling);
+      }
+      const std::size_t nk = ws.orbitals.size();
+      if (nk == 0) {
+        continue;
+      }
+
+      // W_(ij)J c,(ab)J2 l for the kets.
+      ws.left.assign(nr * nq, 0.0);
+      for (std::size_t u = 0; u < nq; u += 1) {
+        const std::size_t q = ws.columns[u];
+        for (std::size_t t = basis.begin[q]; t < basis.begin[q + 1]; t += 1) {
+          const ThreeBodyTerm term = basis.terms[t];
+          for (std::size_t r = 0; r < nr; r += 1) {
+            ws.left[r * nq + u] += term.coefficient * ws.x[r * n + term.state];
+          }
+        }
+      }
+      // f B_ab,ck.
+      ws.right.resize(nq * nk);
+      for (std::size_t u = 0; u < nq; u += 1) {
+        const TwoBodyStateIndex ab(basis.states[ws.columns[u]].k);
+        const OrbitalIndex x = channel2.First(ab);
+        const OrbitalIndex y = channel2.Second(ab);
+        for (std::size_t v = 0; v < nk; v += 1) {
+          const OrbitalIndex k(ws.orbitals[v]);
+          ws.right[u * nk + v] =
+              ws.weights[u] * (transpose ? Unnormalized(b, ch2, c, k, x, y)
+                                         : Unnormalized(b, ch2, x, y, c, k));
+        }
+      }
+      ws.y.resize(nr * nk);
+      Gemm(
+          GemmOp::kNormal,
+          GemmOp::kNormal,
+          nr,
+          nk,
+          nq,
+          1.0,
+          ws.left.data(),
+          nq,
+          ws.right.data(),
+          nk,
+          0.0,
+          ws.y.data(),
+          nk);
+
+      // Trace out c and antisymmetrize in (kl).
+      AlignedVector<double>& u_block = blocks[ch1.idx()];
+      if (u_block.empty()) {
+        u_block.assign(n1 * n1, 0.0);
+      }
+      for (std::size_t v = 0; v < nk; v += 1) {
+        const OrbitalIndex k(ws.orbitals[v]);
+        const int jk = sp.Orbital(k).TwoJ();
+        const TwoBodyStateIndex kl =
+            ms2.StateIndex(ch1, std::min(k, l), std::max(k, l));
+        double factor = degeneracy * ws.recouplings[v];
+        if (k > l) {
+          factor *= SwapPhase(jk, jl, two_j);
+        } else if (k == l) {
+          factor *= 1.0 + SwapPhase(jk, jl, two_j);
+        }
+        for (std::size_t r = 0; r < nr; r += 1) {
+          const std::size_t ij = basis.states[r0 + r].k;
+          u_block[ij * n1 + kl.idx()] += factor * ws.y[r * nk + v];
+        }
+      }
+    }
+  }
+}
+
+// Get channels of ms with nonzero sizes, largest first.
+std::vector<std::size_t> ChannelOrder(
+    const ThreeBodyModelSpace& ms,
+    const std::vector<std::size_t>& sizes) {
+  std::vector<std::size_t> order;
+  for (const auto ch : ms.ChannelIndices()) {
+    if (sizes[ch.idx()] > 0) {
+      order.push_back(ch.idx());
+    }
+  }
+  std::stable_sort(
+      order.begin(),
+      order.end(),
+      [&sizes](std::size_t x, std::size_t y) { return sizes[x] > sizes[y]; });
+  return order;
+}
+
+}  // namespace
+
+bool AddCommutator223(
+    const TwoBodyOperator& a,
+    const TwoBodyOperator& b,
+    double scale,
+    ThreeBodyOperator& out,
+    const ThreeBodyCommutatorOptions& options) {
+  const ThreeBodyModelSpace& ms3 = out.ModelSpace();
+  if (&a.ModelSpace() != &b.ModelSpace() ||
+      &a.ModelSpace().SP() != &ms3.SP()) {
+    return false;
+  }
+  a.ModelSpace().BuildAllChannels();
+  std::vector<std::size_t> sizes(ms3.NumChannels(), 0UL);
+  for (const auto ch : ms3.ChannelIndices()) {
+    sizes[ch.idx()] = out.ChannelSize(ch);
+  }
+  const std::vector<std::size_t> order = ChannelOrder(ms3, sizes);
+  const std::size_t num_channels = order.size();
+#pragma omp parallel num_threads(NumParallelThreads())
+  {
+    Workspace ws;
+#pragma omp for schedule(dynamic)
+    for (std::size_t c = 0; c < num_channels; c += 1) {
+      Commutator223Channel(
+          a,
+          b,
+          scale,
+          ThreeBodyChannelIndex(order[c]),
+          options.e3max,
+          out,
+          ws);
+    }
+  }
+  return true;
+}
+
+bool AddCommutator322(
+    const ThreeBodyOperator& w,
+    const TwoBodyOperator& b,
+    const std::vector<double>& occupations,
+    double scale,
+    TwoBodyOperator& out,
+    const ThreeBodyCommutatorOptions& options) {
+  const ThreeBodyModelSpace& ms3 = w.ModelSpace();
+  const TwoBodyModelSpace& ms2 = b.ModelSpace();
+  if (&out.ModelSpace() != &ms2 || &ms2.SP() != &ms3.SP() ||
+      occupations.size() != ms2.SP().NumOrbitals()) {
+    return false;
+  }
+  ms2.BuildAllChannels();
+  std::vector<std::size_t> sizes(ms3.NumChannels(), 0UL);
+  for (const auto ch : ms3.ChannelIndices()) {
+    if (w.IsMaterialized(ch)) {
+      sizes[ch.idx()] = w.ChannelSize(ch);
+    }
+  }
+  const std::vector<std::size_t> order = ChannelOrder(ms3, sizes);
+  const std::size_t num_channels = order.size();
+
+  // C = U(W, B) - U(W^T, B^T)^T, where U(W^T, B^T) = s_W s_B U(W, B) for
+  // (anti)hermitian W and B.
+  const bool symmetric =
+      IsSymmetric(w.Symmetry()) && IsSymmetric(b.Symmetry());
+  const double sign =
+      symmetric ? HermiticitySign(w.Symmetry()) * HermiticitySign(b.Symmetry())
+                : 1.0;
+  std::vector<Workspace> workspaces(
+      static_cast<std::size_t>(omp_get_max_threads()));
+#pragma omp parallel num_threads(NumParallelThreads())
+  {
+    Workspace& ws = workspaces[static_cast<std::size_t>(omp_get_thread_num())];
+    ws.blocks.resize(ms2.NumChannels());
+    ws.transposed_blocks.resize(ms2.NumChannels());
+#pragma omp for schedule(dynamic)
+    for (std::size_t c = 0; c < num_channels; c += 1) {
+      const ThreeBodyChannelIndex ch(order[c]);
+      Commutator322Channel(
+          w,
+          b,
+          occupations,
+          ch,
+          options,
+          false,
+          ws,
+          ws.blocks);
+      if (!symmetric) {
+        Commutator322Channel(
+            w,
+            b,
+            occupations,
+            ch,
+            options,
+            true,
+            ws,
+            ws.transposed_blocks);
+      }
+    }
+  }
+
+  out.PrepareWrites();
+  const bool packed = out.IsPacked();
+  const std::size_t num_channels2 = ms2.NumChannels();
+#pragma omp parallel for schedule(dynamic) num_threads(NumParallelThreads())
+  for (std::size_t c = 0; c < num_channels2; c += 1) {
+    const TwoBodyChannelIndex ch(c);
+    const auto& channel = ms2.Channel(ch);
+    const std::size_t n = channel.Dimension();
+    AlignedVector<double> u(n * n, 0.0);
+    AlignedVector<double> v(n * n, 0.0);
+    bool touched = false;
+    for (const auto& ws : workspaces) {
+      if (!ws.blocks[c].empty()) {
+        touched = true;
+        for (std::size_t i = 0; i < n * n; i += 1) {
+          u[i] += ws.blocks[c][i];
+        }
+      }
+      if (!ws.transposed_blocks[c].empty()) {
+        touched = true;
+        for (std::size_t i = 0; i < n * n; i += 1) {
+          v[i] += ws.transposed_blocks[c][i];
+        }
+      }
+    }
+    if (!touched) {
+      continue;
+    }
+    const AlignedVector<double>& transposed = symmetric ? u : v;
+    double* block = out.MutableBlock(ch);
+    for (const auto i : channel.StateIndices()) {
+      const double norm_i =
+          channel.First(i) == channel.Second(i) ? std::sqrt(0.5) : 1.0;
+      for (const auto j : channel.StateIndices()) {
+        if (packed && j < i) {
+          continue;
+        }
+        const double norm_j =
+            channel.First(j) == channel.Second(j) ? std::sqrt(0.5) : 1.0;
+        const double x = u[i.idx() * n + j.idx()] -
+                         sign * transposed[j.idx() * n + i.idx()];
+        const std::size_t pos =
+            packed ? PackedIndex(i.idx(), j.idx()) : i.idx() * n + j.idx();
+        block[pos] += scale * norm_i * norm_j * x;
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace nui
@@ -0,0 +1,104 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_OPERATORS_ACTIONS_3B_COMMUTATOR_3B_H_
+#define NUI_PHYSICS_OPERATORS_ACTIONS_3B_COMMUTATOR_3B_H_
+
+// IWYU pragma: private, include "nui/physics/operators/actions/3b/op_actions_3b.h"
+// IWYU pragma: friend "nui/physics/operators/actions/3b/.*\.h"
+
+#include <vector>
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+#include "nui/physics/operators/storage/3b/op_3b.h"
+
+// Commutator pieces of the IMSRG(3) with 3-body operators,
+//
+//   [2,2]->3: C_ijklmn = P(ij/k) P(l/mn) sum_a (A_ijla B_akmn - B_ijla A_akmn),
+//   [3,2]->2: C_ijkl = 1/2 sum_abc (n_a n_b nbar_c + nbar_a nbar_b n_c)
+//                      [(1 - P_kl) W_ijcabl B_abck
+//                       + (1 - P_ij) W_iabckl B_cjab],
+//
+// with antisymmetrized m-scheme elements, P(ij/k) = 1 - P_ik - P_jk, and
+// nbar = 1 - n.
+//
+// Both pieces work on product states |(xy) J, s; J3> of a 3-body channel,
+// i.e., a 2-body state |xy; J> and a spectator orbital s. The channel's
+// canonical states map to product states with one recoupling (6j symbol),
+// product states are grouped by (2-body channel, spectator), and the
+// contractions over the summed orbitals become one GEMM per pair of groups:
+//
+// - [2,2]->3 contracts a over 2-body blocks gathered for the groups,
+//   X_(ij)k,(mn)l = sum_a A_ij,la B_ak,mn with a 6j recoupling weight, and
+//   maps X back to canonical states with the cyclic recouplings of P(ij/k).
+// - [3,2]->2 expands W to product states one row panel (group) at a time
+//   and contracts (ab) with B, weighted by occupations, before tracing out
+//   the spectator c.
+//
+// 3-body channels are processed in parallel, largest first, with scratch of
+// one row panel of product states per thread. The energy truncation e3max
+// and the occupation cutoff bound the work: 3-body states above e3max are
+// neither computed nor read, and contractions over (a, b, c) with negligible
+// occupation weight are skipped.
+
+namespace nui {
+
+// Truncations of 3-body commutator kernels.
+struct ThreeBodyCommutatorOptions {
+  // Only 3-body states with e_a + e_b + e_c <= e3max are computed ([2,2]->3)
+  // or read ([3,2]->2). Negative values keep all states of the model space.
+  int e3max = -1;
+  // Skip terms with occupation weight n_a n_b nbar_c + nbar_a nbar_b n_c at
+  // most occupation_cutoff ([3,2]->2).
+  double occupation_cutoff = 0.0;
+};
+
+// Add scale * [A, B] of 2-body operators a and b to 3-body operator out.
+//
+// For packed out, only the upper triangle is computed. Returns false (and
+// does nothing) if a and b have different model spaces or out has another
+// single-particle model space.
+bool AddCommutator223(
+    const TwoBodyOperator& a,
+    const TwoBodyOperator& b,
+    double scale,
+    ThreeBodyOperator& out,
+    const ThreeBodyCommutatorOptions& options = {});
+
+// Add scale * [W, B] of 3-body operator w and 2-body operator b to 2-body
+// operator out with the given occupations.
+//
+// Only materialized channels of w contribute. Returns false (and does
+// nothing) if b and out have different model spaces, w has another
+// single-particle model space, or occupations has the wrong size.
+bool AddCommutator322(
+    const ThreeBodyOperator& w,
+    const TwoBodyOperator& b,
+    const std::vector<double>& occupations,
+    double scale,
+    TwoBodyOperator& out,
+    const ThreeBodyCommutatorOptions& options = {});
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_OPERATORS_ACTIONS_3B_COMMUTATOR_3B_H_
@@ -0,0 +1,109 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "fmt/core.h"
+#include "nui/core/basics/basics.h"
+#include "nui/info/profiling/profiling.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/actions/3b/op_actions_3b.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+#include "nui/physics/operators/storage/3b/op_3b.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+#include "nui/physics/operators/storage/testing/op_testing.h"
+
+// Benchmark of the IMSRG(3) commutator kernels [2,2]->3 and [3,2]->2.
+//
+// Usage: nui_..._commutator_3b_bench [emax] [e3max] [kernel e3max]
+//
+// The kernel e3max (negative for the full model space) is passed as the
+// truncation option, so runs with decreasing values show the scaling of the
+// kernels with the 3-body energy truncation.
+
+namespace {
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int emax = argc > 1 ? std::atoi(argv[1]) : 2;
+  const int e3max = argc > 2 ? std::atoi(argv[2]) : 6;
+  nui::ThreeBodyCommutatorOptions options;
+  if (argc > 3) {
+    options.e3max = std::atoi(argv[3]);
+  }
+
+  const auto sp = nui::SPModelSpace::Make(
+      nui::SPTruncation(emax),
+      nui::Reference::HOEqualFilling(8, 8));
+  const auto ms2 = nui::TwoBodyModelSpace::Make(sp);
+  const auto ms3 =
+      nui::ThreeBodyModelSpace::Make(sp, nui::ThreeBodyTruncation(e3max));
+  nui::TwoBodyOperator eta(ms2, nui::Hermiticity::kAntihermitian);
+  nui::TwoBodyOperator h(ms2, nui::Hermiticity::kHermitian);
+  nui::testing::FillStored(1.0, eta);
+  nui::testing::FillStored(0.5, h);
+  nui::ThreeBodyOperator w(ms3, nui::Hermiticity::kHermitian);
+  const double t223 = nui::TimeSeconds(
+      [&]() { nui::AddCommutator223(eta, h, 1.0, w, options); });
+  fmt::print(
+      "emax = {}, e3max = {}, kernel e3max = {}, 3-body = {:.1f} MB\n",
+      emax,
+      e3max,
+      options.e3max,
+      w.TotalSize() * sizeof(double) * 1e-6);
+
+  double norm = 0.0;
+  for (const auto ch : ms3->ChannelIndices()) {
+    const nui::ThreeBodyChannelView x = w.Read(ch);
+    for (std::size_t i = 0; i < w.ChannelSize(ch); i += 1) {
+      norm += x.Data()[i] * x.Data()[i];
+    }
+  }
+  fmt::print(
+      "{:<24} {:>10.3f} ms  |W| = {:.6e}\n",
+      "AddCommutator223",
+      t223 * 1e3,
+      std::sqrt(norm));
+
+  nui::TwoBodyOperator c(ms2, nui::Hermiticity::kHermitian);
+  const double t322 = nui::TimeSeconds([&]() {
+    nui::AddCommutator322(w, eta, sp->Occupations(), 1.0, c, options);
+  });
+  norm = 0.0;
+  for (const auto ch : ms2->ChannelIndices()) {
+    const double* block = c.Block(ch);
+    for (std::size_t i = 0; i < c.ChannelSize(ch); i += 1) {
+      norm += block[i] * block[i];
+    }
+  }
+  fmt::print(
+      "{:<24} {:>10.3f} ms  |C| = {:.6e}\n",
+      "AddCommutator322",
+      t322 * 1e3,
+      std::sqrt(norm));
+  return 0;
+}
@@ -0,0 +1,432 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/actions/3b/commutator_3b.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "catch2/catch_approx.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "nui/core/basics/basics.h"
+#include "nui/physics/coupling/coupling.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/actions/3b/recoupling.h"
+#include "nui/physics/operators/actions/testing/op_actions_testing.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+#include "nui/physics/operators/storage/3b/op_3b.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+#include "nui/physics/operators/storage/testing/op_testing.h"
+
+// The J-scheme kernels are checked against the m-scheme formulas in a small
+// model space (emax = 1, 16 m-states).
+
+namespace {
+
+using nui::Hermiticity;
+using nui::OrbitalIndex;
+using nui::ThreeBodyChannelIndex;
+using nui::ThreeBodyStateIndex;
+using nui::testing::Fill;
+using nui::testing::MakeMStates;
+using nui::testing::MakeSP;
+using nui::testing::MScheme;
+using nui::testing::MState;
+
+// Coefficient of canonical J-scheme state in m-scheme state.
+struct MTerm {
+  ThreeBodyChannelIndex ch;
+  std::uint32_t state;
+  double coefficient;
+};
+
+// Sorted m-scheme triples p < q < r with their J-scheme expansion.
+struct MTriples {
+  std::vector<std::array<std::size_t, 3>> triples;
+  std::vector<int> two_m;
+  std::vector<std::vector<MTerm>> terms;
+  // Index of sorted triple by (p, q, r).
+  std::vector<std::size_t> index;
+};
+
+MTriples MakeTriples(
+    const nui::ThreeBodyModelSpace& ms3,
+    const std::vector<MState>& ms) {
+  const nui::SPModelSpace& sp = ms3.SP();
+  const std::size_t n = ms.size();
+  MTriples t;
+  t.index.assign(n * n * n, 0);
+  std::vector<nui::ThreeBodyTerm> expansion;
+  for (std::size_t p = 0; p < n; p += 1) {
+    for (std::size_t q = p + 1; q < n; q += 1) {
+      for (std::size_t r = q + 1; r < n; r += 1) {
+        t.index[(p * n + q) * n + r] = t.triples.size();
+        t.triples.push_back({p, q, r});
+        const int two_m = ms[p].two_m + ms[q].two_m + ms[r].two_m;
+        t.two_m.push_back(two_m);
+        std::vector<MTerm> terms;
+        const auto oa = sp.Orbital(ms[p].orbital);
+        const auto ob = sp.Orbital(ms[q].orbital);
+        const auto oc = sp.Orbital(ms[r].orbital);
+        for (int two_jab = 0; two_jab <= oa.TwoJ() + ob.TwoJ();
+             two_jab += 2) {
+          const double cg_ab = nui::ClebschGordan(
+              oa.TwoJ(),
+              ms[p].two_m,
+              ob.TwoJ(),
+              ms[q].two_m,
+              two_jab,
+              ms[p].two_m + ms[q].two_m);
+          if (cg_ab == 0.0) {
+            continue;
+          }
+          for (int two_j = 1; two_j <= two_jab + oc.TwoJ(); two_j += 2) {
+            const double cg = cg_ab * nui::ClebschGordan(
+                                          two_jab,
+                                          ms[p].two_m + ms[q].two_m,
+                                          oc.TwoJ(),
+                                          ms[r].two_m,
+                                          two_j,
+                                          two_m);
+            if (cg == 0.0) {
+              continue;
+            }
+            const auto ch = ms3.ChannelIndex(nui::PackedChannel(
+                two_j,
+                (oa.L() + ob.L() + oc.L()) % 2,
+                oa.TwoTz() + ob.TwoTz() + oc.TwoTz()));
+            if (ch == ThreeBodyChannelIndex::Invalid()) {
+              continue;
+            }
+            expansion.clear();
+            nui::ExpandThreeBodyState(
+                ms3.Channel(ch),
+                sp,
+                ms[p].orbital,
+                ms[q].orbital,
+                two_jab,
+                ms[r].orbital,
+                expansion);
+            for (const auto& e : expansion) {
+              terms.push_back({ch, e.state, cg * e.coefficient});
+            }
+          }
+        }
+        t.terms.push_back(terms);
+      }
+    }
+  }
+  return t;
+}
+
+// Antisymmetrized m-scheme 3-body elements between sorted triples.
+std::vector<double> MScheme(
+    const nui::ThreeBodyOperator& op,
+    const MTriples& t) {
+  const std::size_t n = t.triples.size();
+  std::vector<double> out(n * n, 0.0);
+  for (std::size_t p = 0; p < n; p += 1) {
+    for (std::size_t q = 0; q < n; q += 1) {
+      if (t.two_m[p] != t.two_m[q]) {
+        continue;
+      }
+      double sum = 0.0;
+      for (const MTerm& x : t.terms[p]) {
+        for (const MTerm& y : t.terms[q]) {
+          if (x.ch == y.ch) {
+            sum += x.coefficient * y.coefficient *
+                   op.Get(
+                       x.ch,
+                       ThreeBodyStateIndex(x.state),
+                       ThreeBodyStateIndex(y.state));
+          }
+        }
+      }
+      out[p * n + q] = sum;
+    }
+  }
+  return out;
+}
+
+// Get element of antisymmetric tensor stored by sorted triples.
+double Element3(
+    const std::vector<double>& w,
+    const MTriples& t,
+    std::size_t num_states,
+    std::array<std::size_t, 3> bra,
+    std::array<std::size_t, 3> ket) {
+  double sign = 1.0;
+  const auto sort = [&sign](std::array<std::size_t, 3>& x) {
+    for (int pass = 0; pass < 2; pass += 1) {
+      for (int i = 0; i < 2; i += 1) {
+        if (x[i] > x[i + 1]) {
+          std::swap(x[i], x[i + 1]);
+          sign = -sign;
+        }
+      }
+    }
+    return x[0] != x[1] && x[1] != x[2];
+  };
+  if (!sort(bra) || !sort(ket)) {
+    return 0.0;
+  }
+  const std::size_t n = num_states;
+  const std::size_t p = t.index[(bra[0] * n + bra[1]) * n + bra[2]];
+  const std::size_t q = t.index[(ket[0] * n + ket[1]) * n + ket[2]];
+  return sign * w[p * t.triples.size() + q];
+}
+
+void Check223(Hermiticity ha, Hermiticity hb, Hermiticity hc) {
+  const auto sp = MakeSP(1, nui::Reference::HOEqualFilling(2, 2));
+  const auto ms2 = nui::TwoBodyModelSpace::Make(sp);
+  const auto ms3 =
+      nui::ThreeBodyModelSpace::Make(sp, nui::ThreeBodyTruncation(3));
+  nui::TwoBodyOperator a(ms2, ha);
+  nui::TwoBodyOperator b(ms2, hb);
+  Fill(1.0, a);
+  Fill(2.0, b);
+  nui::ThreeBodyOperator c(ms3, hc);
+  REQUIRE(nui::AddCommutator223(a, b, 0.5, c));
+
+  const std::vector<MState> states = MakeMStates(*sp);
+  const std::size_t n = states.size();
+  const std::vector<double> am = MScheme(a, states);
+  const std::vector<double> bm = MScheme(b, states);
+  const MTriples t = MakeTriples(*ms3, states);
+  const std::vector<double> cm = MScheme(c, t);
+  const auto at = [n](const std::vector<double>& x,
+                      std::size_t p,
+                      std::size_t q,
+                      std::size_t r,
+                      std::size_t s) {
+    return x[((p * n + q) * n + r) * n + s];
+  };
+  // Z_ijk,lmn = sum_a (A_ijla B_akmn - B_ijla A_akmn).
+  const auto z = [&](std::array<std::size_t, 3> x,
+                     std::array<std::size_t, 3> y) {
+    double sum = 0.0;
+    for (std::size_t s = 0; s < n; s += 1) {
+      sum += at(am, x[0], x[1], y[0], s) * at(bm, s, x[2], y[1], y[2]) -
+             at(bm, x[0], x[1], y[0], s) * at(am, s, x[2], y[1], y[2]);
+    }
+    return sum;
+  };
+  double norm = 0.0;
+  for (std::size_t p = 0; p < t.triples.size(); p += 1) {
+    for (std::size_t q = 0; q < t.triples.size(); q += 1) {
+      const auto [i, j, k] = t.triples[p];
+      const auto [l, m, o] = t.triples[q];
+      const std::array<std::array<std::size_t, 3>, 3> bras = {
+          {{i, j, k}, {k, j, i}, {i, k, j}}};
+      const std::array<std::array<std::size_t, 3>, 3> kets = {
+          {{l, m, o}, {m, l, o}, {o, m, l}}};
+      double expected = 0.0;
+      for (std::size_t x = 0; x < 3; x += 1) {
+        for (std::size_t y = 0; y < 3; y += 1) {
+          const double sign = (x == 0 ? 1.0 : -1.0) * (y == 0 ? 1.0 : -1.0);
+          expected += sign * z(bras[x], kets[y]);
+        }
+      }
+      REQUIRE(
+          cm[p * t.triples.size() + q] ==
+          Catch::Approx(0.5 * expected).margin(1e-10));
+      norm += expected * expected;
+    }
+  }
+  REQUIRE(norm > 1.0);
+}
+
+void Check322(Hermiticity hw, Hermiticity hb, Hermiticity hc) {
+  const auto sp = MakeSP(1, nui::Reference::HOEqualFilling(2, 2));
+  const auto ms2 = nui::TwoBodyModelSpace::Make(sp);
+  const auto ms3 =
+      nui::ThreeBodyModelSpace::Make(sp, nui::ThreeBodyTruncation(3));
+  const std::vector<double> occupations = nui::testing::MakeOccupations(*sp, 1);
+  nui::ThreeBodyOperator w(ms3, hw);
+  nui::TwoBodyOperator b(ms2, hb);
+  Fill(3.0, w);
+  Fill(4.0, b);
+  nui::TwoBodyOperator c(ms2, hc);
+  REQUIRE(nui::AddCommutator322(w, b, occupations, 2.0, c));
+
+  const std::vector<MState> states = MakeMStates(*sp);
+  const std::size_t n = states.size();
+  const std::vector<double> bm = MScheme(b, states);
+  const MTriples t = MakeTriples(*ms3, states);
+  const std::vector<double> wm = MScheme(w, t);
+  const std::vector<double> cm = MScheme(c, states);
+  const auto bt = [&](std::size_t p,
+                      std::size_t q,
+                      std::size_t r,
+                      std::size_t s) {
+    return bm[((p * n + q) * n + r) * n + s];
+  };
+  const auto wt = [&](std::size_t p,
+                      std::size_t q,
+                      std::size_t r,
+                      std::size_t s,
+                      std::size_t u,
+                      std::size_t v) {
+    return Element3(wm, t, n, {p, q, r}, {s, u, v});
+  };
+  std::vector<double> nbar(n);
+  std::vector<double> occ(n);
+  for (std::size_t p = 0; p < n; p += 1) {
+    occ[p] = occupations[states[p].orbital.idx()];
+    nbar[p] = 1.0 - occ[p];
+  }
+  // T1_ijkl = 1/2 sum f W_ijcabl B_abck, T2_ijkl = 1/2 sum f W_iabckl B_cjab.
+  const auto t1 = [&](std::size_t i,
+                      std::size_t j,
+                      std::size_t k,
+                      std::size_t l) {
+    double sum = 0.0;
+    for (std::size_t x = 0; x < n; x += 1) {
+      for (std::size_t y = 0; y < n; y += 1) {
+        for (std::size_t s = 0; s < n; s += 1) {
+          const double f =
+              occ[x] * occ[y] * nbar[s] + nbar[x] * nbar[y] * occ[s];
+          if (f != 0.0) {
+            sum += 0.5 * f * wt(i, j, s, x, y, l) * bt(x, y, s, k);
+          }
+        }
+      }
+    }
+    return sum;
+  };
+  const auto t2 = [&](std::size_t i,
+                      std::size_t j,
+                      std::size_t k,
+                      std::size_t l) {
+    double sum = 0.0;
+    for (std::size_t x = 0; x < n; x += 1) {
+      for (std::size_t y = 0; y < n; y += 1) {
+        for (std::size_t s = 0; s < n; s += 1) {
+          const double f =
+              occ[x] * occ[y] * nbar[s] + nbar[x] * nbar[y] * occ[s];
+          if (f != 0.0) {
+            sum += 0.5 * f * wt(i, x, y, s, k, l) * bt(s, j, x, y);
+          }
+        }
+      }
+    }
+    return sum;
+  };
+  double norm = 0.0;
+  for (std::size_t i = 0; i < n; i += 1) {
+    for (std::size_t j = i + 1; j < n; j += 1) {
+      for (std::size_t k = 0; k < n; k += 1) {
+        for (std::size_t l = k + 1; l < n; l += 1) {
+          if (states[i].two_m + states[j].two_m !=
+              states[k].two_m + states[l].two_m) {
+            continue;
+          }
+          const double expected = t1(i, j, k, l) - t1(i, j, l, k) +
+                                  t2(i, j, k, l) - t2(j, i, k, l);
+          REQUIRE(
+              cm[((i * n + j) * n + k) * n + l] ==
+              Catch::Approx(2.0 * expected).margin(1e-10));
+          norm += expected * expected;
+        }
+      }
+    }
+  }
+  REQUIRE(norm > 1e-2);
+}
+
+}  // namespace
+
+TEST_CASE("AddCommutator223, Test against m-scheme.") {
+  Check223(
+      Hermiticity::kAntihermitian,
+      Hermiticity::kHermitian,
+      Hermiticity::kHermitian);
+  Check223(Hermiticity::kNone, Hermiticity::kNone, Hermiticity::kNone);
+}
+
+TEST_CASE("AddCommutator322, Test against m-scheme.") {
+  Check322(
+      Hermiticity::kHermitian,
+      Hermiticity::kAntihermitian,
+      Hermiticity::kHermitian);
+  Check322(Hermiticity::kNone, Hermiticity::kNone, Hermiticity::kNone);
+}
+
+TEST_CASE("AddCommutator223, Test energy truncation.") {
+  const auto sp = MakeSP(1, nui::Reference::HOEqualFilling(2, 2));
+  const auto ms2 = nui::TwoBodyModelSpace::Make(sp);
+  const auto ms3 =
+      nui::ThreeBodyModelSpace::Make(sp, nui::ThreeBodyTruncation(3));
+  nui::TwoBodyOperator a(ms2, Hermiticity::kAntihermitian);
+  nui::TwoBodyOperator b(ms2, Hermiticity::kHermitian);
+  Fill(5.0, a);
+  Fill(6.0, b);
+  nui::ThreeBodyOperator full(ms3, Hermiticity::kHermitian);
+  nui::ThreeBodyOperator truncated(ms3, Hermiticity::kHermitian);
+  REQUIRE(nui::AddCommutator223(a, b, 1.0, full));
+  nui::ThreeBodyCommutatorOptions options;
+  options.e3max = 2;
+  REQUIRE(nui::AddCommutator223(a, b, 1.0, truncated, options));
+
+  std::size_t num_kept = 0;
+  for (const auto ch : ms3->ChannelIndices()) {
+    const auto& channel = ms3->Channel(ch);
+    for (const auto i : channel.StateIndices()) {
+      for (const auto j : channel.StateIndices()) {
+        const auto energy = [&sp](nui::ThreeBodyState st) {
+          return sp->Orbital(OrbitalIndex(st.a)).E() +
+                 sp->Orbital(OrbitalIndex(st.b)).E() +
+                 sp->Orbital(OrbitalIndex(st.c)).E();
+        };
+        if (energy(channel.State(i)) <= 2 && energy(channel.State(j)) <= 2) {
+          REQUIRE(
+              truncated.Get(ch, i, j) ==
+              Catch::Approx(full.Get(ch, i, j)).margin(1e-12));
+          num_kept += 1;
+        } else {
+          REQUIRE(truncated.Get(ch, i, j) == 0.0);
+        }
+      }
+    }
+  }
+  REQUIRE(num_kept > 0);
+}
+
+TEST_CASE("AddCommutator322, Test argument checks.") {
+  const auto sp = MakeSP(1, nui::Reference::HOEqualFilling(2, 2));
+  const auto ms2 = nui::TwoBodyModelSpace::Make(sp);
+  const auto ms3 =
+      nui::ThreeBodyModelSpace::Make(sp, nui::ThreeBodyTruncation(3));
+  nui::ThreeBodyOperator w(ms3, Hermiticity::kHermitian);
+  nui::TwoBodyOperator b(ms2, Hermiticity::kAntihermitian);
+  nui::TwoBodyOperator c(ms2, Hermiticity::kHermitian);
+  nui::TwoBodyOperator other(
+      nui::TwoBodyModelSpace::Make(sp, nui::TwoBodyTruncation{1}),
+      Hermiticity::kHermitian);
+  REQUIRE_FALSE(nui::AddCommutator322(w, b, {1.0}, 1.0, c));
+  REQUIRE_FALSE(nui::AddCommutator322(w, b, sp->Occupations(), 1.0, other));
+  REQUIRE_FALSE(nui::AddCommutator223(b, other, 1.0, w));
+  REQUIRE(nui::AddCommutator322(w, b, sp->Occupations(), 1.0, c));
+}
@@ -0,0 +1,417 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/actions/3b/no2b.h"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/memory/memory.h"
+#include "nui/info/profiling/profiling.h"
+#include "nui/info/runtime/runtime.h"
+#include "nui/physics/coupling/coupling.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/actions/1b/op_actions_1b.h"
+#include "nui/physics/operators/actions/3b/recoupling.h"
+#include "nui/physics/operators/storage/1b/op_1b.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+#include "nui/physics/operators/storage/3b/op_3b.h"
+#include "nui/physics/operators/storage/full/op_full.h"
+#include "nui/physics/operators/storage/io/op_io.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+
+namespace nui {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// State |(xy) J, s; J3> of a 3-body channel, i.e., state k of 2-body
+// channel ch2 with spectator s, expanded in terms [begin, end).
+//
+// norm converts to normalized 2-body elements (1 / sqrt(2) for x == y).
+struct SpectatorState {
+  std::uint32_t s = 0;
+  std::uint32_t ch2 = 0;
+  std::uint32_t k = 0;
+  std::uint32_t begin = 0;
+  std::uint32_t end = 0;
+  double norm = 1.0;
+};
+
+// Scratch and partial sums of one thread.
+struct Workspace {
+  std::vector<SpectatorState> states;
+  std::vector<ThreeBodyTerm> terms;
+  // Partial 2-body blocks (empty until first touched).
+  std::vector<AlignedVector<double>> blocks;
+};
+
+// Append states |(xy) J, s; J3> (x <= y) of 3-body channel to ws.
+void AddSpectatorStates(
+    const ThreeBodyChannel& channel,
+    const TwoBodyModelSpace& ms2,
+    OrbitalIndex x,
+    OrbitalIndex y,
+    OrbitalIndex s,
+    Workspace& ws) {
+  const SPModelSpace& sp = ms2.SP();
+  const int two_j3 = channel.QuantumNumbers().TwoJ();
+  const auto ox = sp.Orbital(x);
+  const auto oy = sp.Orbital(y);
+  const int jx = ox.TwoJ();
+  const int jy = oy.TwoJ();
+  const int js = sp.Orbital(s).TwoJ();
+  const int parity = (ox.L() + oy.L()) % 2;
+  const int two_tz = ox.TwoTz() + oy.TwoTz();
+  for (int two_j = std::abs(jx - jy); two_j <= jx + jy; two_j += 2) {
+    if (!IsTriangle(two_j, js, two_j3) ||
+        (x == y && (two_j / 2) % 2 == 1)) {
+      continue;
+    }
+    const TwoBodyChannelIndex ch2 =
+        ms2.ChannelIndex(PackedChannel(two_j, parity, two_tz));
+    if (ch2 == TwoBodyChannelIndex::Invalid()) {
+      continue;
+    }
+    const TwoBodyStateIndex k = ms2.StateIndex(ch2, x, y);
+    if (k == TwoBodyStateIndex::Invalid()) {
+      continue;
+    }
+    const auto begin = static_cast<std::uint32_t>(ws.terms.size());
+    ExpandThreeBodyState(channel, sp, x, y, two_j, s, ws.terms);
+    const auto end = static_cast<std::uint32_t>(ws.terms.size());
+    if (end > begin) {
+      SpectatorState state;
+      state.s = static_cast<std::uint32_t>(s.idx());
+      state.ch2 = static_cast<std::uint32_t>(ch2.idx());
+      state.k = static_cast<std::uint32_t>(k.idx());
+      state.begin = begin;
+      state.end = end;
+      state.norm = x == y ? 1.0 / std::sqrt(2.0) : 1.0;
+      ws.states.push_back(state);
+    }
+  }
+}
+
+// Accumulate NO2B contributions of 3-body channel into ws.blocks.
+void ContractChannel(
+    const ThreeBodyChannel& channel,
+    const double* block,
+    Hermiticity stored_hermiticity,
+    const std::vector<double>& occupations,
+    const TwoBodyOperator& two_body,
+    Workspace& ws) {
+  const TwoBodyModelSpace& ms2 = two_body.ModelSpace();
+  ws.states.clear();
+  ws.terms.clear();
+  // Runs of states with the same orbitals (a <= b <= c).
+  const auto& states = channel.States();
+  for (std::size_t r = 0; r < states.size(); r += 1) {
+    const ThreeBodyState st = states[r];
+    if (r > 0 && states[r - 1].a == st.a && states[r - 1].b == st.b &&
+        states[r - 1].c == st.c) {
+      continue;
+    }
+    const OrbitalIndex a(st.a);
+    const OrbitalIndex b(st.b);
+    const OrbitalIndex c(st.c);
+    if (occupations[a.idx()] != 0.0) {
+      AddSpectatorStates(channel, ms2, b, c, a, ws);
+    }
+    if (b != a && occupations[b.idx()] != 0.0) {
+      AddSpectatorStates(channel, ms2, a, c, b, ws);
+    }
+    if (c != b && occupations[c.idx()] != 0.0) {
+      AddSpectatorStates(channel, ms2, a, b, c, ws);
+    }
+  }
+  std::sort(
+      ws.states.begin(),
+      ws.states.end(),
+      [](const auto& x, const auto& y) {
+        return x.s < y.s || (x.s == y.s && x.ch2 < y.ch2);
+      });
+
+  const std::size_t n = channel.Dimension();
+  const int two_j3 = channel.QuantumNumbers().TwoJ();
+  const bool packed = two_body.IsPacked();
+  const bool antihermitian =
+      two_body.Symmetry() == Hermiticity::kAntihermitian;
+  std::size_t begin = 0;
+  while (begin < ws.states.size()) {
+    const std::uint32_t s = ws.states[begin].s;
+    const std::uint32_t ch2 = ws.states[begin].ch2;
+    std::size_t end = begin + 1;
+    while (end < ws.states.size() && ws.states[end].s == s &&
+           ws.states[end].ch2 == ch2) {
+      end += 1;
+    }
+    const TwoBodyChannelIndex ch(ch2);
+    const double weight = occupations[s] * (two_j3 + 1.0) /
+                          (ms2.ChannelQuantumNumbers(ch).TwoJ() + 1.0);
+    const std::size_t n2 = two_body.ChannelDimension(ch);
+    AlignedVector<double>& gamma = ws.blocks[ch2];
+    if (gamma.empty()) {
+      gamma.assign(two_body.ChannelSize(ch), 0.0);
+    }
+    for (std::size_t p = begin; p < end; p += 1) {
+      const SpectatorState& bra = ws.states[p];
+      for (std::size_t q = begin; q < end; q += 1) {
+        const SpectatorState& ket = ws.states[q];
+        if (packed && (bra.k > ket.k || (antihermitian && bra.k == ket.k))) {
+          continue;
+        }
+        double sum = 0.0;
+        for (std::uint32_t t = bra.begin; t < bra.end; t += 1) {
+          const ThreeBodyTerm x = ws.terms[t];
+          double row = 0.0;
+          for (std::uint32_t u = ket.begin; u < ket.end; u += 1) {
+            const ThreeBodyTerm y = ws.terms[u];
+            row += y.coefficient *
+                   BlockElement(block, n, stored_hermiticity, x.state, y.state);
+          }
+          sum += x.coefficient * row;
+        }
+        const std::size_t pos =
+            packed ? PackedIndex(bra.k, ket.k) : bra.k * n2 + ket.k;
+        gamma[pos] += weight * bra.norm * ket.norm * sum;
+      }
+    }
+    begin = end;
+  }
+}
+
+// Reduce stored channels (sizes[c] > 0) of a 3-body operator into two_body.
+//
+// fetch(ch, f) calls f(const double* block) with the stored block of channel
+// ch available and returns false if the block cannot be read.
+template <typename Fetch>
+bool Reduce(
+    const ThreeBodyModelSpace& ms3,
+    BlockLayout layout,
+    const std::vector<std::size_t>& sizes,
+    const std::vector<double>& occupations,
+    TwoBodyOperator& two_body,
+    const NO2BOptions& options,
+    Fetch&& fetch) {
+  const Clock::time_point start = Clock::now();
+  const TwoBodyModelSpace& ms2 = two_body.ModelSpace();
+  ms2.BuildAllChannels();
+  const Hermiticity stored_hermiticity =
+      layout == BlockLayout::kPackedUpper ? two_body.Symmetry()
+                                          : Hermiticity::kNone;
+
+  // Largest channels first for load balance.
+  std::vector<std::size_t> order;
+  NO2BProgress progress;
+  for (const auto ch : ms3.ChannelIndices()) {
+    if (sizes[ch.idx()] > 0) {
+      order.push_back(ch.idx());
+      progress.num_elements += sizes[ch.idx()];
+    }
+  }
+  std::stable_sort(
+      order.begin(),
+      order.end(),
+      [&sizes](std::size_t x, std::size_t y) { return sizes[x] > sizes[y]; });
+  progress.num_channels = order.size();
+
+  const std::size_t num_channels = order.size();
+  const int num_threads = omp_get_max_threads();
+  std::vector<Workspace> workspaces(static_cast<std::size_t>(num_threads));
+  std::atomic<std::size_t> channels_done(0);
+  std::atomic<std::size_t> elements_done(0);
+  std::atomic<bool> valid(true);
+  double last_report = 0.0;
+
+#pragma omp parallel num_threads(NumParallelThreads())
+  {
+    Workspace& ws = workspaces[static_cast<std::size_t>(omp_get_thread_num())];
+    ws.blocks.resize(ms2.NumChannels());
+#pragma omp for schedule(dynamic)
+    for (std::size_t c = 0; c < num_channels; c += 1) {
+      if (!valid.load(std::memory_order_relaxed)) {
+        continue;
+      }
+      const ThreeBodyChannelIndex ch(order[c]);
+      const bool fetched = fetch(ch, [&](const double* block) {
+        ContractChannel(
+            ms3.Channel(ch),
+            block,
+            stored_hermiticity,
+            occupations,
+            two_body,
+            ws);
+      });
+      if (!fetched) {
+        valid.store(false, std::memory_order_relaxed);
+        continue;
+      }
+      channels_done.fetch_add(1, std::memory_order_relaxed);
+      elements_done.fetch_add(sizes[ch.idx()], std::memory_order_relaxed);
+      if (options.progress && omp_get_thread_num() == 0) {
+        const double seconds = SecondsSince(start);
+        if (seconds - last_report >= options.progress_interval) {
+          last_report = seconds;
+          NO2BProgress current = progress;
+          current.channels_done = channels_done.load();
+          current.elements_done = elements_done.load();
+          current.seconds = seconds;
+          options.progress(current);
+        }
+      }
+    }
+  }
+  if (!valid) {
+    return false;
+  }
+
+  two_body.PrepareWrites();
+  const std::size_t num_channels2 = ms2.NumChannels();
+#pragma omp parallel for schedule(dynamic) num_threads(NumParallelThreads())
+  for (std::size_t c = 0; c < num_channels2; c += 1) {
+    double* block = two_body.MutableBlock(TwoBodyChannelIndex(c));
+    for (const auto& ws : workspaces) {
+      if (ws.blocks.empty() || ws.blocks[c].empty()) {
+        continue;
+      }
+      const double* x = ws.blocks[c].data();
+      for (std::size_t i = 0; i < ws.blocks[c].size(); i += 1) {
+        block[i] += x[i];
+      }
+    }
+  }
+
+  if (options.progress) {
+    progress.channels_done = num_channels;
+    progress.elements_done = progress.num_elements;
+    progress.seconds = SecondsSince(start);
+    options.progress(progress);
+  }
+  return true;
+}
+
+}  // namespace
+
+bool AddNO2B(
+    const ThreeBodyOperator& three_body,
+    const std::vector<double>& occupations,
+    TwoBodyOperator& two_body,
+    const NO2BOptions& options) {
+  const ThreeBodyModelSpace& ms3 = three_body.ModelSpace();
+  if (&two_body.ModelSpace().SP() != &ms3.SP() ||
+      two_body.Symmetry() != three_body.Symmetry() ||
+      occupations.size() != ms3.SP().NumOrbitals()) {
+    return false;
+  }
+  std::vector<std::size_t> sizes(ms3.NumChannels(), 0UL);
+  for (const auto ch : ms3.ChannelIndices()) {
+    if (three_body.IsMaterialized(ch)) {
+      sizes[ch.idx()] = three_body.ChannelSize(ch);
+    }
+  }
+  return Reduce(
+      ms3,
+      three_body.Layout(),
+      sizes,
+      occupations,
+      two_body,
+      options,
+      [&three_body](ThreeBodyChannelIndex ch, const auto& f) {
+        const ThreeBodyChannelView view = three_body.Read(ch);
+        f(view.Data());
+        return true;
+      });
+}
+
+bool AddNO2B(
+    const std::string& path,
+    const ThreeBodyModelSpace& ms,
+    const std::vector<double>& occupations,
+    TwoBodyOperator& two_body,
+    const NO2BOptions& options) {
+  NativeThreeBodyFile file;
+  if (&two_body.ModelSpace().SP() != &ms.SP() ||
+      occupations.size() != ms.SP().NumOrbitals() || !file.Open(path, ms) ||
+      file.Symmetry() != two_body.Symmetry()) {
+    return false;
+  }
+  std::vector<std::size_t> sizes(ms.NumChannels(), 0UL);
+  for (const auto ch : ms.ChannelIndices()) {
+    sizes[ch.idx()] = file.ChannelSize(ch);
+  }
+  return Reduce(
+      ms,
+      file.Layout(),
+      sizes,
+      occupations,
+      two_body,
+      options,
+      [&file, &options](ThreeBodyChannelIndex ch, const auto& f) {
+        if (options.verify && !file.VerifyChannel(ch)) {
+          file.Release(ch);
+          return false;
+        }
+        f(file.Channel(ch));
+        file.Release(ch);
+        return true;
+      });
+}
+
+bool NormalOrderThreeBody(
+    Operator& op,
+    const std::vector<double>& occupations,
+    const NO2BOptions& options) {
+  if (!op.HasThreeBody() ||
+      occupations.size() != op.SP().NumOrbitals()) {
+    return false;
+  }
+  TwoBodyOperator gamma(
+      op.TwoBody().ModelSpaceShared(),
+      op.Symmetry(),
+      op.TwoBody().IsPacked());
+  if (!AddNO2B(op.ThreeBody(), occupations, gamma, options)) {
+    return false;
+  }
+  OneBodyOperator f(op.OneBody().SPShared(), op.Symmetry());
+  double zero_body = 0.0;
+  ContractTwoBody(gamma, occupations, f, zero_body);
+  Axpy(0.5, f, op.OneBody());
+  Axpy(1.0, gamma, op.TwoBody());
+  op.SetZeroBody(op.ZeroBody() + zero_body / 3.0);
+  return true;
+}
+
+bool NormalOrderThreeBody(Operator& op, const NO2BOptions& options) {
+  return NormalOrderThreeBody(op, op.SP().Occupations(), options);
+}
+
+}  // namespace nui
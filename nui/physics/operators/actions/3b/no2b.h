@@ -0,0 +1,126 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_OPERATORS_ACTIONS_3B_NO2B_H_
+#define NUI_PHYSICS_OPERATORS_ACTIONS_3B_NO2B_H_
+
+// IWYU pragma: private, include "nui/physics/operators/actions/3b/op_actions_3b.h"
+// IWYU pragma: friend "nui/physics/operators/actions/3b/.*\.h"
+
+#include <functional>
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+#include "nui/physics/operators/storage/3b/op_3b.h"
+#include "nui/physics/operators/storage/full/op_full.h"
+#include "nui/physics/operators/storage/io/op_io.h"
+
+// Normal-ordered two-body (NO2B) part of 3-body operators,
+//
+//   Gamma^J_{ab,de} = sum_c n_c sum_J3 (2J3 + 1) / (2J + 1)
+//                     W^J3_{(ab)J c,(de)J c},
+//
+// with unnormalized J-coupled matrix elements. The states |(ab)J c; J3> are
+// expanded in the canonical states of the 3-body channel with a single
+// recoupling (6j symbol), and states outside the 3-body truncation do not
+// contribute.
+//
+// 3-body channels are streamed, largest first, in parallel. Each thread holds
+// one channel at a time (pinned in storage, or paged in from a file and
+// released after use) and accumulates into its own lazily allocated 2-body
+// blocks, which are summed over threads at the end. Peak memory is thus one
+// 3-body channel and at most one 2-body operator per thread.
+
+namespace nui {
+
+// Progress of a NO2B reduction.
+struct NO2BProgress {
+  // 3-body channels processed.
+  std::size_t channels_done = 0UL;
+  std::size_t num_channels = 0UL;
+  // Stored 3-body matrix elements read.
+  std::size_t elements_done = 0UL;
+  std::size_t num_elements = 0UL;
+  // Wall time since start.
+  double seconds = 0.0;
+
+  // Get throughput in bytes of 3-body matrix elements per second.
+  double BytesPerSecond() const {
+    return seconds > 0.0 ? elements_done * sizeof(double) / seconds : 0.0;
+  }
+};
+
+// Options of NO2B reductions.
+struct NO2BOptions {
+  // Called from one thread about every progress_interval seconds and once
+  // when all channels are done.
+  std::function<void(const NO2BProgress&)> progress;
+  double progress_interval = 1.0;
+  // Check the checksum of each channel read from a file before using it.
+  bool verify = true;
+};
+
+// Add NO2B part of three_body to two_body.
+//
+// Channels that were never materialized are skipped. Returns false (and does
+// nothing) if two_body does not have the single-particle model space and
+// hermiticity of three_body, or occupations does not have one entry per
+// orbital.
+bool AddNO2B(
+    const ThreeBodyOperator& three_body,
+    const std::vector<double>& occupations,
+    TwoBodyOperator& two_body,
+    const NO2BOptions& options = {});
+
+// Add NO2B part of the 3-body operator in a native file to two_body.
+//
+// Channels are read in place from the mapped file, so it may be larger than
+// memory. Returns false if the file cannot be read, does not match ms or the
+// hermiticity of two_body, or a channel fails verification (two_body may be
+// partially updated then), and as above.
+bool AddNO2B(
+    const std::string& path,
+    const ThreeBodyModelSpace& ms,
+    const std::vector<double>& occupations,
+    TwoBodyOperator& two_body,
+    const NO2BOptions& options = {});
+
+// Normal order the 3-body part of op in place with respect to occupations.
+//
+// Adds the NO2B part to the 2-body part and its contractions (with factors
+// 1/2 and 1/3) to the 1- and 0-body parts. The 3-body part is left untouched,
+// and 1- and 2-body parts are normal ordered separately (see NormalOrder()).
+// Returns false (and does nothing) if op has no 3-body part or occupations
+// does not have one entry per orbital.
+bool NormalOrderThreeBody(
+    Operator& op,
+    const std::vector<double>& occupations,
+    const NO2BOptions& options = {});
+
+// Normal order the 3-body part of op in place with respect to the reference
+// state of its single-particle model space.
+bool NormalOrderThreeBody(Operator& op, const NO2BOptions& options = {});
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_OPERATORS_ACTIONS_3B_NO2B_H_
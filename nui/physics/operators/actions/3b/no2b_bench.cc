@@ -0,0 +1,111 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdlib>
+#include <vector>
+
+#include "fmt/core.h"
+#include "nui/core/basics/basics.h"
+#include "nui/core/io/io.h"
+#include "nui/info/profiling/profiling.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/actions/3b/op_actions_3b.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+#include "nui/physics/operators/storage/3b/op_3b.h"
+#include "nui/physics/operators/storage/io/op_io.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+
+// Benchmark of the NO2B reduction of a 3-body operator.
+//
+// Usage: nui_..._no2b_bench [emax] [e3max] [file]
+//
+// The reduction is run on the operator in memory and, if file is nonzero,
+// streamed from a native file written to /tmp.
+
+namespace {
+
+void PrintProgress(const nui::NO2BProgress& progress) {
+  fmt::print(
+      "  {:>6}/{} channels, {:>8.1f}/{:.1f} MB, {:>8.1f} MB/s\n",
+      progress.channels_done,
+      progress.num_channels,
+      progress.elements_done * sizeof(double) * 1e-6,
+      progress.num_elements * sizeof(double) * 1e-6,
+      progress.BytesPerSecond() * 1e-6);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int emax = argc > 1 ? std::atoi(argv[1]) : 4;
+  const int e3max = argc > 2 ? std::atoi(argv[2]) : 8;
+  const bool file = argc > 3 ? std::atoi(argv[3]) != 0 : true;
+
+  const auto sp = nui::SPModelSpace::Make(
+      nui::SPTruncation(emax),
+      nui::Reference::HOEqualFilling(8, 8));
+  const auto ms2 = nui::TwoBodyModelSpace::Make(sp);
+  const auto ms3 =
+      nui::ThreeBodyModelSpace::Make(sp, nui::ThreeBodyTruncation(e3max));
+  nui::ThreeBodyOperator w(ms3, nui::Hermiticity::kHermitian);
+  w.StreamChannelsMutable([&w](nui::ThreeBodyChannelIndex ch, double* block) {
+    for (std::size_t i = 0; i < w.ChannelSize(ch); i += 1) {
+      block[i] = 1.0 / (1.0 + static_cast<double>(i % 97));
+    }
+  });
+  fmt::print(
+      "emax = {}, e3max = {}, 3-body channels = {}, 3-body = {:.1f} MB\n",
+      emax,
+      e3max,
+      ms3->NumChannels(),
+      w.TotalSize() * sizeof(double) * 1e-6);
+
+  nui::NO2BOptions options;
+  options.progress = PrintProgress;
+  nui::TwoBodyOperator gamma(ms2, nui::Hermiticity::kHermitian);
+  const double memory = nui::TimeSeconds([&]() {
+    nui::AddNO2B(w, sp->Occupations(), gamma, options);
+  });
+  fmt::print(
+      "{:<24} {:>10.3f} ms  |Gamma| = {:.10e}\n",
+      "AddNO2B (memory)",
+      memory * 1e3,
+      nui::Norm(gamma));
+
+  if (file) {
+    const nui::TempDirectory dir("nui_no2b_bench");
+    const std::string path = dir.File("w.bin");
+    nui::WriteNativeOperator(path, w);
+    nui::TwoBodyOperator streamed(ms2, nui::Hermiticity::kHermitian);
+    const double seconds = nui::TimeSeconds([&]() {
+      nui::AddNO2B(path, *ms3, sp->Occupations(), streamed, options);
+    });
+    fmt::print(
+        "{:<24} {:>10.3f} ms  |Gamma| = {:.10e}\n",
+        "AddNO2B (file)",
+        seconds * 1e3,
+        nui::Norm(streamed));
+  }
+  return 0;
+}
@@ -0,0 +1,275 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/actions/3b/no2b.h"
+
+#include <cmath>
+#include <vector>
+
+#include "catch2/catch_approx.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "nui/core/basics/basics.h"
+#include "nui/core/io/io.h"
+#include "nui/physics/coupling/coupling.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/actions/testing/op_actions_testing.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+#include "nui/physics/operators/storage/3b/op_3b.h"
+#include "nui/physics/operators/storage/full/op_full.h"
+#include "nui/physics/operators/storage/io/op_io.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+#include "nui/physics/operators/storage/testing/op_testing.h"
+
+namespace {
+
+using nui::Hermiticity;
+using nui::OrbitalIndex;
+using nui::ThreeBodyChannelIndex;
+using nui::ThreeBodyStateIndex;
+using nui::testing::Fill;
+using nui::testing::MakeSP;
+
+// Coefficient of |(bc) J_bc, a; J> in |(ab) J_ab, c; J>.
+double Recoupling(int ja, int jb, int jc, int jab, int jbc, int j) {
+  const double phase = ((jb + jc) / 2 + jbc / 2) % 2 == 0 ? -1.0 : 1.0;
+  return phase * std::sqrt((jab + 1.0) * (jbc + 1.0)) *
+         nui::SixJ(ja, jb, jab, jc, j, jbc);
+}
+
+struct Term {
+  ThreeBodyStateIndex i;
+  double coefficient;
+};
+
+// Expand |(xy) J, s; J3> in canonical states with two cyclic recouplings,
+//
+//   |(xy) J, s> = sum_J' R |(ys) J', x> = sum_J' R sum_J'' R |(sx) J'', y>.
+std::vector<Term> Expand(
+    const nui::ThreeBodyChannel& channel,
+    const nui::SPModelSpace& sp,
+    OrbitalIndex x,
+    OrbitalIndex y,
+    int two_j,
+    OrbitalIndex s) {
+  const int jx = sp.Orbital(x).TwoJ();
+  const int jy = sp.Orbital(y).TwoJ();
+  const int js = sp.Orbital(s).TwoJ();
+  const int j3 = channel.QuantumNumbers().TwoJ();
+  const auto find = [&channel](OrbitalIndex a, OrbitalIndex b, OrbitalIndex c,
+                               int two_jab) {
+    return channel.Index(
+        {static_cast<std::uint16_t>(a.idx()),
+         static_cast<std::uint16_t>(b.idx()),
+         static_cast<std::uint16_t>(c.idx()),
+         static_cast<std::uint16_t>(two_jab)});
+  };
+  std::vector<Term> terms;
+  if (s >= y) {
+    const ThreeBodyStateIndex i = find(x, y, s, two_j);
+    if (i != ThreeBodyStateIndex::Invalid()) {
+      terms.push_back({i, 1.0});
+    }
+    return terms;
+  }
+  for (int j2 = std::abs(js - jx); j2 <= js + jx; j2 += 2) {
+    const ThreeBodyStateIndex i =
+        s < x ? find(s, x, y, j2) : find(x, s, y, j2);
+    if (i == ThreeBodyStateIndex::Invalid()) {
+      continue;
+    }
+    double coefficient = 0.0;
+    for (int j1 = std::abs(jy - js); j1 <= jy + js; j1 += 2) {
+      coefficient += Recoupling(jx, jy, js, two_j, j1, j3) *
+                     Recoupling(jy, js, jx, j1, j2, j3);
+    }
+    if (x < s) {
+      coefficient *= nui::SwapPhase(js, jx, j2);
+    }
+    terms.push_back({i, coefficient});
+  }
+  return terms;
+}
+
+// Get stored NO2B element <k| Gamma |l> of channel ch element by element.
+double Naive(
+    const nui::ThreeBodyOperator& w,
+    const std::vector<double>& occupations,
+    const nui::TwoBodyModelSpace& ms2,
+    nui::TwoBodyChannelIndex ch,
+    nui::TwoBodyStateIndex k,
+    nui::TwoBodyStateIndex l) {
+  const nui::SPModelSpace& sp = ms2.SP();
+  const nui::ThreeBodyModelSpace& ms3 = w.ModelSpace();
+  const auto& channel = ms2.Channel(ch);
+  const auto qn = channel.QuantumNumbers();
+  const OrbitalIndex a = channel.First(k);
+  const OrbitalIndex b = channel.Second(k);
+  const OrbitalIndex d = channel.First(l);
+  const OrbitalIndex e = channel.Second(l);
+  double sum = 0.0;
+  for (const auto s : sp.OrbitalIndices()) {
+    if (occupations[s.idx()] == 0.0) {
+      continue;
+    }
+    const auto os = sp.Orbital(s);
+    for (int j3 = std::abs(qn.TwoJ() - os.TwoJ()); j3 <= qn.TwoJ() + os.TwoJ();
+         j3 += 2) {
+      const ThreeBodyChannelIndex ch3 = ms3.ChannelIndex(nui::PackedChannel(
+          j3,
+          (qn.Parity() + os.L()) % 2,
+          qn.TwoTz() + os.TwoTz()));
+      if (ch3 == ThreeBodyChannelIndex::Invalid()) {
+        continue;
+      }
+      const auto& channel3 = ms3.Channel(ch3);
+      for (const Term& t : Expand(channel3, sp, a, b, qn.TwoJ(), s)) {
+        for (const Term& u : Expand(channel3, sp, d, e, qn.TwoJ(), s)) {
+          sum += occupations[s.idx()] * (j3 + 1.0) / (qn.TwoJ() + 1.0) *
+                 t.coefficient * u.coefficient * w.Get(ch3, t.i, u.i);
+        }
+      }
+    }
+  }
+  const double norm =
+      (a == b ? std::sqrt(2.0) : 1.0) * (d == e ? std::sqrt(2.0) : 1.0);
+  return sum / norm;
+}
+
+}  // namespace
+
+TEST_CASE("NO2B, Test against element-wise reduction.") {
+  const auto sp = MakeSP(2);
+  const auto ms2 = nui::TwoBodyModelSpace::Make(sp);
+  const auto ms3 =
+      nui::ThreeBodyModelSpace::Make(sp, nui::ThreeBodyTruncation(4));
+  const std::vector<double> occupations = nui::testing::MakeOccupations(*sp, 2);
+  for (const auto h :
+       {Hermiticity::kHermitian,
+        Hermiticity::kAntihermitian,
+        Hermiticity::kNone}) {
+    for (const bool packed : {true, false}) {
+      nui::ThreeBodyStorageOptions options;
+      options.packed = packed;
+      nui::ThreeBodyOperator w(ms3, h, options);
+      Fill(1.0, w);
+      nui::TwoBodyOperator gamma(ms2, h, packed);
+      REQUIRE(nui::AddNO2B(w, occupations, gamma));
+
+      double norm = 0.0;
+      for (const auto ch : ms2->ChannelIndices()) {
+        for (const auto k : ms2->Channel(ch).StateIndices()) {
+          for (const auto l : ms2->Channel(ch).StateIndices()) {
+            const double expected = Naive(w, occupations, *ms2, ch, k, l);
+            REQUIRE(
+                gamma.Get(ch, k, l) ==
+                Catch::Approx(expected).margin(1e-10));
+            norm += expected * expected;
+          }
+        }
+      }
+      REQUIRE(norm > 1.0);
+    }
+  }
+}
+
+TEST_CASE("NO2B, Test 0-body contraction.") {
+  const auto sp = MakeSP(2);
+  const auto ms3 =
+      nui::ThreeBodyModelSpace::Make(sp, nui::ThreeBodyTruncation(5));
+  const std::vector<double> occupations = nui::testing::MakeOccupations(*sp, 2);
+  nui::Operator op(nui::TwoBodyModelSpace::Make(sp), Hermiticity::kHermitian);
+  REQUIRE_FALSE(nui::NormalOrderThreeBody(op, occupations));
+  REQUIRE(op.AddThreeBody(ms3));
+  Fill(1.0, op.ThreeBody());
+
+  // E_0 = 1/6 sum_abc n_a n_b n_c sum_J3 (2J3 + 1) sum_Jab W_(ab)c,(ab)c,
+  // where all orders of a, b, c give the same trace.
+  double expected = 0.0;
+  for (const auto ch : ms3->ChannelIndices()) {
+    const auto& channel = ms3->Channel(ch);
+    const double degeneracy = channel.QuantumNumbers().TwoJ() + 1.0;
+    for (const auto i : channel.StateIndices()) {
+      const auto st = channel.State(i);
+      const double multiplicity =
+          st.a == st.c ? 1.0 / 6.0
+                       : (st.a == st.b || st.b == st.c ? 0.5 : 1.0);
+      expected += multiplicity * degeneracy * occupations[st.a] *
+                  occupations[st.b] * occupations[st.c] *
+                  op.ThreeBody().Get(ch, i, i);
+    }
+  }
+  REQUIRE(std::abs(expected) > 1.0);
+  REQUIRE(nui::NormalOrderThreeBody(op, occupations));
+  REQUIRE(op.ZeroBody() == Catch::Approx(expected));
+  REQUIRE(nui::Norm(op.OneBody()) > 0.0);
+  REQUIRE(op.HasThreeBody());
+}
+
+TEST_CASE("NO2B, Test streaming from file.") {
+  const nui::TempDirectory dir("nui_no2b_test");
+  const auto sp = MakeSP(2);
+  const auto ms2 = nui::TwoBodyModelSpace::Make(sp);
+  const auto ms3 =
+      nui::ThreeBodyModelSpace::Make(sp, nui::ThreeBodyTruncation(4));
+  const std::vector<double> occupations = nui::testing::MakeOccupations(*sp, 2);
+  nui::ThreeBodyOperator w(ms3, Hermiticity::kHermitian);
+  Fill(1.0, w);
+  const std::string path = dir.File("w.bin");
+  REQUIRE(nui::WriteNativeOperator(path, w));
+
+  nui::TwoBodyOperator expected(ms2, Hermiticity::kHermitian);
+  REQUIRE(nui::AddNO2B(w, occupations, expected));
+
+  nui::NO2BOptions options;
+  options.progress_interval = 0.0;
+  std::size_t num_reports = 0;
+  nui::NO2BProgress last;
+  options.progress = [&](const nui::NO2BProgress& progress) {
+    REQUIRE(progress.channels_done <= progress.num_channels);
+    num_reports += 1;
+    last = progress;
+  };
+  nui::TwoBodyOperator gamma(ms2, Hermiticity::kHermitian);
+  REQUIRE(nui::AddNO2B(path, *ms3, occupations, gamma, options));
+  REQUIRE(num_reports > 0);
+  std::size_t num_stored = 0;
+  for (const auto ch : ms3->ChannelIndices()) {
+    num_stored += w.IsMaterialized(ch) ? 1 : 0;
+  }
+  REQUIRE(last.channels_done == num_stored);
+  REQUIRE(last.elements_done == last.num_elements);
+  for (const auto ch : ms2->ChannelIndices()) {
+    for (std::size_t i = 0; i < gamma.ChannelSize(ch); i += 1) {
+      REQUIRE(gamma.Block(ch)[i] == Catch::Approx(expected.Block(ch)[i]));
+    }
+  }
+
+  nui::TwoBodyOperator antihermitian(ms2, Hermiticity::kAntihermitian);
+  REQUIRE_FALSE(nui::AddNO2B(path, *ms3, occupations, antihermitian));
+  REQUIRE_FALSE(nui::AddNO2B(
+      path,
+      *nui::ThreeBodyModelSpace::Make(sp, nui::ThreeBodyTruncation(3)),
+      occupations,
+      gamma));
+}
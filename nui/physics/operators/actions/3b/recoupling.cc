@@ -0,0 +1,101 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/actions/3b/recoupling.h"
+
+#include <cmath>
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/coupling/coupling.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+
+namespace nui {
+
+namespace {
+
+ThreeBodyStateIndex Find(
+    const ThreeBodyChannel& channel,
+    OrbitalIndex a,
+    OrbitalIndex b,
+    OrbitalIndex c,
+    int two_jab) {
+  ThreeBodyState state;
+  state.a = static_cast<std::uint16_t>(a.idx());
+  state.b = static_cast<std::uint16_t>(b.idx());
+  state.c = static_cast<std::uint16_t>(c.idx());
+  state.two_jab = static_cast<std::uint16_t>(two_jab);
+  return channel.Index(state);
+}
+
+}  // namespace
+
+void ExpandThreeBodyState(
+    const ThreeBodyChannel& channel,
+    const SPModelSpace& sp,
+    OrbitalIndex a,
+    OrbitalIndex b,
+    int two_jab,
+    OrbitalIndex c,
+    std::vector<ThreeBodyTerm>& terms) {
+  int two_ja = sp.Orbital(a).TwoJ();
+  int two_jb = sp.Orbital(b).TwoJ();
+  double phase = 1.0;
+  if (a > b) {
+    phase = SwapPhase(two_ja, two_jb, two_jab);
+    std::swap(a, b);
+    std::swap(two_ja, two_jb);
+  }
+  if (c >= b) {
+    const ThreeBodyStateIndex i = Find(channel, a, b, c, two_jab);
+    if (i != ThreeBodyStateIndex::Invalid()) {
+      terms.push_back({static_cast<std::uint32_t>(i.idx()), phase});
+    }
+    return;
+  }
+  // |(ab) J_ab, c> = P |(ba) J_ab, c> = P sum_J' R |(ac) J', b>, and b is
+  // now the largest orbital.
+  const int two_jc = sp.Orbital(c).TwoJ();
+  const int two_j = channel.QuantumNumbers().TwoJ();
+  phase *= SwapPhase(two_ja, two_jb, two_jab);
+  const OrbitalIndex lo = std::min(a, c);
+  const OrbitalIndex hi = std::max(a, c);
+  for (int two_jp = std::abs(two_ja - two_jc); two_jp <= two_ja + two_jc;
+       two_jp += 2) {
+    if (!IsTriangle(two_jp, two_jb, two_j)) {
+      continue;
+    }
+    const ThreeBodyStateIndex i = Find(channel, lo, hi, b, two_jp);
+    if (i == ThreeBodyStateIndex::Invalid()) {
+      continue;
+    }
+    double coefficient =
+        phase *
+        CyclicRecoupling(two_jb, two_ja, two_jc, two_jab, two_jp, two_j);
+    if (c < a) {
+      coefficient *= SwapPhase(two_ja, two_jc, two_jp);
+    }
+    terms.push_back({static_cast<std::uint32_t>(i.idx()), coefficient});
+  }
+}
+
+}  // namespace nui
@@ -0,0 +1,62 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_OPERATORS_ACTIONS_3B_RECOUPLING_H_
+#define NUI_PHYSICS_OPERATORS_ACTIONS_3B_RECOUPLING_H_
+
+// IWYU pragma: private, include "nui/physics/operators/actions/3b/op_actions_3b.h"
+// IWYU pragma: friend "nui/physics/operators/actions/3b/.*\.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+
+// Expansion of antisymmetrized 3-body states |(ab) J_ab, c; J> with
+// orbitals in any order in the canonical states (a <= b <= c) of a channel.
+//
+// A pair swap gives the phase SwapPhase(), and a cyclic permutation
+// recouples with one 6j symbol (see CyclicRecoupling()), so every state
+// needs at most one recoupling. Canonical states that are not in the channel
+// (truncated, or vanishing like |(aa) J_odd, c>) do not contribute.
+
+namespace nui {
+
+// Canonical state of a 3-body channel with expansion coefficient.
+struct ThreeBodyTerm {
+  std::uint32_t state = 0;
+  double coefficient = 0.0;
+};
+
+// Append expansion of |(ab) J_ab, c; J> in canonical states of channel to
+// terms.
+void ExpandThreeBodyState(
+    const ThreeBodyChannel& channel,
+    const SPModelSpace& sp,
+    OrbitalIndex a,
+    OrbitalIndex b,
+    int two_jab,
+    OrbitalIndex c,
+    std::vector<ThreeBodyTerm>& terms);
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_OPERATORS_ACTIONS_3B_RECOUPLING_H_
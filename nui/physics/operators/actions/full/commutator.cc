@@ -0,0 +1,1292 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/actions/full/commutator.h"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/memory/memory.h"
+#include "nui/info/profiling/profiling.h"
+#include "nui/info/runtime/runtime.h"
+#include "nui/physics/coupling/coupling.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/actions/2b/op_actions_2b.h"
+#include "nui/physics/operators/storage/1b/op_1b.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+#include "nui/physics/operators/storage/full/op_full.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+#include "nui/tensor/contraction/tensor_contraction.h"
+
+namespace nui {
+
+namespace {
+
+// Orbital x of stored state |xc; J> or |cx; J> with spectator c.
+//
+// factor brings the stored state to order (x, c) and to unnormalized
+// normalization (sqrt(2) for x == c).
+struct SpectatorState {
+  std::size_t c = 0;
+  std::size_t x = 0;
+  std::size_t state = 0;
+  double factor = 1.0;
+  std::size_t pw_c = 0;
+  std::size_t pw_x = 0;
+};
+
+// Get spectator states of all states of channel, sorted by the partial
+// waves of c and x, then by c and x.
+//
+// States with x == c appear once, all others twice (with either orbital as
+// spectator).
+void MakeSpectatorStates(
+    const SPModelSpace& sp,
+    const TwoBodyChannel& channel,
+    int two_j,
+    std::vector<SpectatorState>& states) {
+  states.clear();
+  for (const auto i : channel.StateIndices()) {
+    const OrbitalIndex p = channel.First(i);
+    const OrbitalIndex q = channel.Second(i);
+    const std::size_t pw_p = sp.PartialWaveOf(p).idx();
+    const std::size_t pw_q = sp.PartialWaveOf(q).idx();
+    if (p == q) {
+      states.push_back(
+          {p.idx(), p.idx(), i.idx(), std::sqrt(2.0), pw_p, pw_p});
+      continue;
+    }
+    const double phase =
+        SwapPhase(sp.Orbital(p).TwoJ(), sp.Orbital(q).TwoJ(), two_j);
+    states.push_back({q.idx(), p.idx(), i.idx(), 1.0, pw_q, pw_p});
+    states.push_back({p.idx(), q.idx(), i.idx(), phase, pw_p, pw_q});
+  }
+  std::sort(states.begin(), states.end(), [](const auto& a, const auto& b) {
+    if (a.pw_c != b.pw_c) {
+      return a.pw_c < b.pw_c;
+    }
+    if (a.pw_x != b.pw_x) {
+      return a.pw_x < b.pw_x;
+    }
+    return a.c < b.c || (a.c == b.c && a.x < b.x);
+  });
+}
+
+// Get end of run of spectator states starting at begin with equal partial
+// waves of c and x (and equal c if same_spectator).
+std::size_t RunEnd(
+    const std::vector<SpectatorState>& states,
+    std::size_t begin,
+    bool same_spectator) {
+  const SpectatorState& first = states[begin];
+  std::size_t end = begin + 1;
+  while (end < states.size() && states[end].pw_c == first.pw_c &&
+         states[end].pw_x == first.pw_x &&
+         (!same_spectator || states[end].c == first.c)) {
+    end += 1;
+  }
+  return end;
+}
+
+// Get Frobenius norm of size elements.
+double FrobeniusNorm(const double* x, std::size_t size) {
+  double sum = 0.0;
+#pragma omp simd reduction(+ : sum)
+  for (std::size_t i = 0; i < size; i += 1) {
+    sum += x[i] * x[i];
+  }
+  return std::sqrt(sum);
+}
+
+// Transpose row-major n x n matrix.
+void Transpose(const double* x, std::size_t n, double* xt) {
+  for (std::size_t i = 0; i < n; i += 1) {
+    for (std::size_t j = 0; j < n; j += 1) {
+      xt[j * n + i] = x[i * n + j];
+    }
+  }
+}
+
+// Replace p by p - sign * p^T.
+void SubtractTranspose(double sign, std::size_t n, double* p) {
+  for (std::size_t i = 0; i < n; i += 1) {
+    p[i * n + i] *= 1.0 - sign;
+    for (std::size_t j = i + 1; j < n; j += 1) {
+      const double x = p[i * n + j];
+      const double y = p[j * n + i];
+      p[i * n + j] = x - sign * y;
+      p[j * n + i] = y - sign * x;
+    }
+  }
+}
+
+// Add scale * z (full n x n) to stored block with hermiticity h.
+void AddToBlock(
+    const double* z,
+    std::size_t n,
+    double scale,
+    Hermiticity h,
+    bool packed,
+    double* block) {
+  if (!packed) {
+    for (std::size_t i = 0; i < n * n; i += 1) {
+      block[i] += scale * z[i];
+    }
+    return;
+  }
+  const bool anti = h == Hermiticity::kAntihermitian;
+  for (std::size_t j = 0; j < n; j += 1) {
+    double* col = block + PackedIndex(0, j);
+    for (std::size_t i = 0; i <= j; i += 1) {
+      if (!(anti && i == j)) {
+        col[i] += scale * z[i * n + j];
+      }
+    }
+  }
+}
+
+// Get transpose of 2-body operator without symmetry.
+TwoBodyOperator Transposed(const TwoBodyOperator& op) {
+  TwoBodyOperator t(op.ModelSpaceShared(), Hermiticity::kNone, false);
+  for (const auto ch : op.ModelSpace().ChannelIndices()) {
+    Transpose(op.Block(ch), op.ChannelDimension(ch), t.MutableBlock(ch));
+  }
+  return t;
+}
+
+// Get index of Pandya plan by hermiticity and layout.
+std::size_t PlanIndex(Hermiticity h, BlockLayout layout) {
+  return 2 * static_cast<std::size_t>(h) + static_cast<std::size_t>(layout);
+}
+
+}  // namespace
+
+// Plans of engines, built on first use by any engine sharing them.
+struct CommutatorEngine::PlanCache {
+  std::mutex mutex;
+  std::array<std::unique_ptr<PandyaPlan>, 6> plans;
+};
+
+// Scratch of one thread.
+struct CommutatorEngine::Workspace {
+  AlignedVector<double> x;
+  AlignedVector<double> y;
+  AlignedVector<double> xt;
+  AlignedVector<double> yt;
+  AlignedVector<double> left;
+  AlignedVector<double> right;
+  AlignedVector<double> p1;
+  AlignedVector<double> p2;
+  AlignedVector<double> q;
+  AlignedVector<double> z;
+  std::vector<SpectatorState> states;
+  std::vector<std::size_t> columns;
+  std::vector<double> weights;
+  // Items of the batch evaluated in the current channel, their symmetry
+  // signs, and the positions of items without symmetry among them.
+  std::vector<std::size_t> items;
+  std::vector<double> signs;
+  std::vector<std::size_t> rows;
+  // Full partial-wave blocks of 1-body results and 0-body results by item.
+  AlignedVector<double> one_body;
+  std::vector<double> zero_body;
+  double flops = 0.0;
+  // Screening of the current term.
+  double skipped_flops = 0.0;
+  double error2 = 0.0;
+  std::size_t num_blocks = 0;
+  std::size_t skipped_blocks = 0;
+  std::size_t factored_blocks = 0;
+
+  // Record skipped block with degeneracy, bound of its contribution, and
+  // cost.
+  void Skip(double degeneracy, double bound, double cost) {
+    skipped_blocks += 1;
+    skipped_flops += cost;
+    error2 += degeneracy * bound * bound;
+  }
+
+  std::size_t MemoryLoad() const {
+    return (x.capacity() + y.capacity() + xt.capacity() + yt.capacity() +
+            left.capacity() + right.capacity() + p1.capacity() +
+            p2.capacity() + q.capacity() + z.capacity() + weights.capacity() +
+            signs.capacity() + one_body.capacity() + zero_body.capacity()) *
+               sizeof(double) +
+           states.capacity() * sizeof(SpectatorState) +
+           (columns.capacity() + items.capacity() + rows.capacity()) *
+               sizeof(std::size_t);
+  }
+
+  // Set p_r = x[:, columns] w y_r[columns, :] - y_r[:, columns] w x[columns, :]
+  // for the n x n matrices y_r stacked in y, one per entry of signs (with
+  // y_r w x = signs[r] (x w y_r)^T if signs[r] != 0).
+  //
+  // The products y_r w x of all r are one GEMM with stacked rows, as are
+  // the products (x w y_r)^T of all r without symmetry.
+  void Product(std::size_t n, AlignedVector<double>& p) {
+    const std::size_t m = columns.size();
+    const std::size_t num = signs.size();
+    p.resize(num * n * n);
+    if (m == 0) {
+      std::fill(p.begin(), p.end(), 0.0);
+      return;
+    }
+    // Q_r = y_r[:, columns] w x[columns, :].
+    left.resize(num * n * m);
+    right.resize(m * n);
+    for (std::size_t r = 0; r < num; r += 1) {
+      const double* yr = y.data() + r * n * n;
+      double* lr = left.data() + r * n * m;
+      for (std::size_t i = 0; i < n; i += 1) {
+        for (std::size_t k = 0; k < m; k += 1) {
+          lr[i * m + k] = yr[i * n + columns[k]] * weights[k];
+        }
+      }
+    }
+    for (std::size_t k = 0; k < m; k += 1) {
+      std::copy_n(x.data() + columns[k] * n, n, right.data() + k * n);
+    }
+    Gemm(
+        GemmOp::kNormal,
+        GemmOp::kNormal,
+        num * n,
+        n,
+        m,
+        1.0,
+        left.data(),
+        m,
+        right.data(),
+        n,
+        0.0,
+        p.data(),
+        n);
+    flops += GemmFlops(num * n, n, m);
+
+    // R_r = (x w y_r)^T = y_r^T[:, columns] w x^T[columns, :].
+    rows.clear();
+    for (std::size_t r = 0; r < num; r += 1) {
+      if (signs[r] == 0.0) {
+        rows.push_back(r);
+      }
+    }
+    if (!rows.empty()) {
+      left.resize(rows.size() * n * m);
+      for (std::size_t t = 0; t < rows.size(); t += 1) {
+        const double* yr = y.data() + rows[t] * n * n;
+        double* lr = left.data() + t * n * m;
+        for (std::size_t i = 0; i < n; i += 1) {
+          for (std::size_t k = 0; k < m; k += 1) {
+            lr[i * m + k] = yr[columns[k] * n + i] * weights[k];
+          }
+        }
+      }
+      for (std::size_t k = 0; k < m; k += 1) {
+        for (std::size_t j = 0; j < n; j += 1) {
+          right[k * n + j] = x[j * n + columns[k]];
+        }
+      }
+      q.resize(rows.size() * n * n);
+      Gemm(
+          GemmOp::kNormal,
+          GemmOp::kNormal,
+          rows.size() * n,
+          n,
+          m,
+          1.0,
+          left.data(),
+          m,
+          right.data(),
+          n,
+          0.0,
+          q.data(),
+          n);
+      flops += GemmFlops(rows.size() * n, n, m);
+    }
+
+    std::size_t t = 0;
+    for (std::size_t r = 0; r < num; r += 1) {
+      double* pr = p.data() + r * n * n;
+      if (signs[r] != 0.0) {
+        // p_r = s Q_r^T - Q_r.
+        SubtractTranspose(signs[r], n, pr);
+        for (std::size_t i = 0; i < n * n; i += 1) {
+          pr[i] = -pr[i];
+        }
+        continue;
+      }
+      const double* qr = q.data() + t * n * n;
+      for (std::size_t i = 0; i < n; i += 1) {
+        for (std::size_t j = 0; j < n; j += 1) {
+          pr[i * n + j] = qr[j * n + i] - pr[i * n + j];
+        }
+      }
+      t += 1;
+    }
+  }
+
+  // Set p_r as in Product with x = l r for n x rank factors l and r.
+  //
+  // x w y_r = l (r[:, columns] w y_r[columns, :]) and y_r w x =
+  // (y_r[:, columns] w l[columns, :]) r cost O(n^2 rank) instead of
+  // O(n^2 m) flops.
+  void FactoredProduct(
+      std::size_t n,
+      std::size_t rank,
+      const double* l,
+      const double* r,
+      AlignedVector<double>& p) {
+    const std::size_t m = columns.size();
+    const std::size_t num = signs.size();
+    p.resize(num * n * n);
+    if (m == 0 || rank == 0) {
+      std::fill(p.begin(), p.end(), 0.0);
+      return;
+    }
+    // right = r[:, columns] w, q = w l[columns, :].
+    right.resize(rank * m);
+    q.resize(m * rank);
+    for (std::size_t k = 0; k < rank; k += 1) {
+      for (std::size_t j = 0; j < m; j += 1) {
+        right[k * m + j] = r[k * n + columns[j]] * weights[j];
+      }
+    }
+    for (std::size_t j = 0; j < m; j += 1) {
+      for (std::size_t k = 0; k < rank; k += 1) {
+        q[j * rank + k] = l[columns[j] * rank + k] * weights[j];
+      }
+    }
+    left.resize(m * n);
+    z.resize(rank * n);
+    for (std::size_t t = 0; t < num; t += 1) {
+      const double* yr = y.data() + t * n * n;
+      double* pr = p.data() + t * n * n;
+      // p_r = l (right y_r[columns, :]).
+      for (std::size_t j = 0; j < m; j += 1) {
+        std::copy_n(yr + columns[j] * n, n, left.data() + j * n);
+      }
+      Gemm(
+          GemmOp::kNormal,
+          GemmOp::kNormal,
+          rank,
+          n,
+          m,
+          1.0,
+          right.data(),
+          m,
+          left.data(),
+          n,
+          0.0,
+          z.data(),
+          n);
+      Gemm(
+          GemmOp::kNormal,
+          GemmOp::kNormal,
+          n,
+          n,
+          rank,
+          1.0,
+          l,
+          rank,
+          z.data(),
+          n,
+          0.0,
+          pr,
+          n);
+      flops += GemmFlops(rank, n, m) + GemmFlops(n, n, rank);
+      if (signs[t] != 0.0) {
+        SubtractTranspose(signs[t], n, pr);
+        continue;
+      }
+      // p_r -= (y_r[:, columns] q) r.
+      for (std::size_t i = 0; i < n; i += 1) {
+        for (std::size_t j = 0; j < m; j += 1) {
+          left[i * m + j] = yr[i * n + columns[j]];
+        }
+      }
+      Gemm(
+          GemmOp::kNormal,
+          GemmOp::kNormal,
+          n,
+          rank,
+          m,
+          1.0,
+          left.data(),
+          m,
+          q.data(),
+          rank,
+          0.0,
+          z.data(),
+          rank);
+      Gemm(
+          GemmOp::kNormal,
+          GemmOp::kNormal,
+          n,
+          n,
+          rank,
+          -1.0,
+          z.data(),
+          rank,
+          r,
+          n,
+          1.0,
+          pr,
+          n);
+      flops += GemmFlops(n, rank, m) + GemmFlops(n, n, rank);
+    }
+  }
+};
+
+std::string_view ToString(CommutatorTerm term) {
+  switch (term) {
+    case CommutatorTerm::kOneOne:
+      return "[1,1]";
+    case CommutatorTerm::kOneTwo:
+      return "[1,2]";
+    case CommutatorTerm::kLadder:
+      return "[2,2] pp/hh";
+    case CommutatorTerm::kParticleHole:
+      return "[2,2] ph";
+  }
+  return "unknown";
+}
+
+CommutatorEngine::CommutatorEngine(
+    std::shared_ptr<const TwoBodyModelSpace> ms,
+    std::vector<double> occupations,
+    CommutatorOptions options)
+    : ms_(std::move(ms)),
+      occupations_(std::move(occupations)),
+      options_(options),
+      plans_(std::make_shared<PlanCache>()) {
+  ms_->BuildAllChannels();
+  const SPModelSpace& sp = ms_->SP();
+  offsets_.assign(sp.NumPartialWaves() + 1, 0UL);
+  for (const auto pw : sp.PartialWaveIndices()) {
+    const std::size_t n = sp.PartialWaveSize(pw);
+    offsets_[pw.idx() + 1] = offsets_[pw.idx()] + n * n;
+  }
+  for (const auto ch : ms_->ChannelIndices()) {
+    order_.push_back(ch);
+  }
+  std::stable_sort(
+      order_.begin(),
+      order_.end(),
+      [this](TwoBodyChannelIndex a, TwoBodyChannelIndex b) {
+        return ms_->Channel(a).Dimension() > ms_->Channel(b).Dimension();
+      });
+}
+
+CommutatorEngine::CommutatorEngine(
+    std::shared_ptr<const TwoBodyModelSpace> ms)
+    : CommutatorEngine(ms, ms->SP().Occupations()) {}
+
+CommutatorEngine::~CommutatorEngine() = default;
+CommutatorEngine::CommutatorEngine(CommutatorEngine&&) noexcept = default;
+CommutatorEngine& CommutatorEngine::operator=(CommutatorEngine&&) noexcept =
+    default;
+
+CommutatorEngine CommutatorEngine::Share() const {
+  CommutatorEngine engine(ms_, occupations_, options_);
+  engine.plans_ = plans_;
+  return engine;
+}
+
+const PandyaPlan& CommutatorEngine::Plan(Hermiticity h, BlockLayout layout) {
+  const std::lock_guard<std::mutex> lock(plans_->mutex);
+  std::unique_ptr<PandyaPlan>& plan = plans_->plans[PlanIndex(h, layout)];
+  if (plan == nullptr) {
+    PandyaOptions options;
+    // Particle-hole kets are selected with the reference occupations.
+    options.particle_hole_kets = occupations_ == ms_->SP().Occupations();
+    options.antisymmetrize_inverse = true;
+    plan = std::make_unique<PandyaPlan>(ms_, h, layout, options);
+  }
+  return *plan;
+}
+
+bool CommutatorEngine::AddCommutator(
+    const Operator& a,
+    const Operator& b,
+    double scale,
+    Operator& out) {
+  return AddCommutators(a, {&b}, scale, {&out});
+}
+
+bool CommutatorEngine::AddCommutator(
+    const Operator& a,
+    const LowRankTwoBodyOperator& a_factors,
+    const Operator& b,
+    double scale,
+    Operator& out) {
+  return AddCommutators(a, a_factors, {&b}, scale, {&out});
+}
+
+bool CommutatorEngine::AddCommutators(
+    const Operator& a,
+    const LowRankTwoBodyOperator& a_factors,
+    const std::vector<const Operator*>& bs,
+    double scale,
+    const std::vector<Operator*>& outs) {
+  if (a_factors.ModelSpaceShared() != ms_ ||
+      a_factors.Symmetry() != a.Symmetry()) {
+    return false;
+  }
+  factors_ = &a_factors;
+  const bool ok = AddCommutators(a, bs, scale, outs);
+  factors_ = nullptr;
+  return ok;
+}
+
+bool CommutatorEngine::Accepts(
+    const Operator& a,
+    const Operator& b,
+    const Operator& out) const {
+  if (&a.TwoBody().ModelSpace() != ms_.get() ||
+      &b.TwoBody().ModelSpace() != ms_.get() ||
+      &out.TwoBody().ModelSpace() != ms_.get() ||
+      occupations_.size() != ms_->SP().NumOrbitals()) {
+    return false;
+  }
+  return !IsSymmetric(out.Symmetry()) ||
+         CommutatorHermiticity(a.Symmetry(), b.Symmetry()) == out.Symmetry();
+}
+
+bool CommutatorEngine::AddCommutators(
+    const Operator& a,
+    const std::vector<const Operator*>& bs,
+    double scale,
+    const std::vector<Operator*>& outs) {
+  if (bs.size() != outs.size()) {
+    return false;
+  }
+  for (std::size_t k = 0; k < bs.size(); k += 1) {
+    if (!Accepts(a, *bs[k], *outs[k])) {
+      return false;
+    }
+  }
+  const std::size_t num_items = bs.size();
+  if (num_items == 0) {
+    return true;
+  }
+  NUI_PROFILE_REGION("commutator");
+
+  const std::size_t size = offsets_.back();
+  const std::size_t num_threads =
+      static_cast<std::size_t>(NumParallelThreads());
+  if (workspaces_.size() < num_threads) {
+    workspaces_.resize(num_threads);
+  }
+  for (auto& ws : workspaces_) {
+    if (ws == nullptr) {
+      ws = std::make_unique<Workspace>();
+    }
+    ws->one_body.assign(num_items * size, 0.0);
+    ws->zero_body.assign(num_items, 0.0);
+  }
+  const SPModelSpace& sp = ms_->SP();
+  one_body_a_.resize(size);
+  one_body_b_.resize(num_items * size);
+  one_body_norm_a_ = 0.0;
+  one_body_norms_b_.assign(num_items, 0.0);
+  for (const auto pw : sp.PartialWaveIndices()) {
+    const std::size_t n = sp.PartialWaveSize(pw);
+    double* block_a = one_body_a_.data() + offsets_[pw.idx()];
+    UnpackBlock(a.OneBody().Block(pw), n, a.Symmetry(), block_a);
+    one_body_norm_a_ =
+        std::max(one_body_norm_a_, FrobeniusNorm(block_a, n * n));
+    for (std::size_t k = 0; k < num_items; k += 1) {
+      double* block_b = one_body_b_.data() + k * size + offsets_[pw.idx()];
+      UnpackBlock(bs[k]->OneBody().Block(pw), n, bs[k]->Symmetry(), block_b);
+      one_body_norms_b_[k] =
+          std::max(one_body_norms_b_[k], FrobeniusNorm(block_b, n * n));
+    }
+  }
+
+  const auto run = [&](CommutatorTerm term, auto&& add) {
+    NUI_PROFILE_REGION(ToString(term).data());
+    for (auto& ws : workspaces_) {
+      ws->flops = 0.0;
+      ws->skipped_flops = 0.0;
+      ws->error2 = 0.0;
+      ws->num_blocks = 0;
+      ws->skipped_blocks = 0;
+      ws->factored_blocks = 0;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    add();
+    const std::size_t t = static_cast<std::size_t>(term);
+    stats_.seconds[t] += SecondsSince(start);
+    double error2 = 0.0;
+    for (const auto& ws : workspaces_) {
+      stats_.flops[t] += ws->flops;
+      stats_.skipped_flops[t] += ws->skipped_flops;
+      stats_.num_blocks[t] += ws->num_blocks;
+      stats_.skipped_blocks[t] += ws->skipped_blocks;
+      stats_.factored_blocks[t] += ws->factored_blocks;
+      error2 += ws->error2;
+    }
+    stats_.error_bound[t] += std::sqrt(error2);
+  };
+  const TwoBodyOperator& x = a.TwoBody();
+  std::vector<const TwoBodyOperator*> ys(num_items);
+  std::vector<TwoBodyOperator*> zs(num_items);
+  for (std::size_t k = 0; k < num_items; k += 1) {
+    ys[k] = &bs[k]->TwoBody();
+    zs[k] = &outs[k]->TwoBody();
+    zs[k]->PrepareWrites();
+  }
+  run(CommutatorTerm::kOneOne, [&]() { AddOneOne(num_items); });
+  run(CommutatorTerm::kOneTwo, [&]() { AddOneTwo(x, ys, scale, zs); });
+  run(CommutatorTerm::kLadder, [&]() { AddLadder(x, ys, scale, zs); });
+  run(CommutatorTerm::kParticleHole,
+      [&]() { AddParticleHole(x, ys, scale, zs); });
+
+  for (std::size_t k = 0; k < num_items; k += 1) {
+    double zero_body = 0.0;
+    for (const auto& ws : workspaces_) {
+      zero_body += ws->zero_body[k];
+    }
+    outs[k]->SetZeroBody(outs[k]->ZeroBody() + scale * zero_body);
+    ReduceOneBody(k, scale, outs[k]->OneBody());
+  }
+  stats_.num_commutators += num_items;
+  return true;
+}
+
+void CommutatorEngine::AddOneOne(std::size_t num_items) {
+  const SPModelSpace& sp = ms_->SP();
+  const std::size_t size = offsets_.back();
+  Workspace& ws = *workspaces_[0];
+  for (std::size_t item = 0; item < num_items; item += 1) {
+    for (const auto pw : sp.PartialWaveIndices()) {
+      const std::size_t n = sp.PartialWaveSize(pw);
+      const std::size_t first = sp.PartialWaveBegin(pw).idx();
+      const double* x = one_body_a_.data() + offsets_[pw.idx()];
+      const double* y = one_body_b_.data() + item * size + offsets_[pw.idx()];
+      double* z = ws.one_body.data() + item * size + offsets_[pw.idx()];
+      const double degeneracy = sp.Orbital(OrbitalIndex(first)).TwoJ() + 1.0;
+      for (std::size_t i = 0; i < n; i += 1) {
+        for (std::size_t j = 0; j < n; j += 1) {
+          double sum = 0.0;
+          for (std::size_t k = 0; k < n; k += 1) {
+            sum += x[i * n + k] * y[k * n + j] - y[i * n + k] * x[k * n + j];
+          }
+          z[i * n + j] += sum;
+          ws.zero_body[item] +=
+              degeneracy *
+              (occupations_[first + i] - occupations_[first + j]) *
+              x[i * n + j] * y[j * n + i];
+        }
+      }
+      ws.flops += 4.0 * static_cast<double>(n * n * n);
+    }
+  }
+}
+
+void CommutatorEngine::AddOneTwo(
+    const TwoBodyOperator& x,
+    const std::vector<const TwoBodyOperator*>& ys,
+    double scale,
+    const std::vector<TwoBodyOperator*>& zs) {
+  const SPModelSpace& sp = ms_->SP();
+  const double* a1 = one_body_a_.data();
+  const std::vector<std::size_t>& offsets = offsets_;
+  const std::size_t size = offsets_.back();
+  // Element (p, q) of full 1-body blocks (p, q in the same partial wave).
+  const auto element = [&sp, &offsets](
+                           const double* blocks,
+                           std::size_t pw,
+                           std::size_t p,
+                           std::size_t q) {
+    const PartialWaveIndex w(pw);
+    const std::size_t first = sp.PartialWaveBegin(w).idx();
+    return blocks[offsets[pw] + (p - first) * sp.PartialWaveSize(w) +
+                  (q - first)];
+  };
+  const std::size_t num_channels = order_.size();
+  const double threshold = options_.screening_threshold;
+
+#pragma omp parallel num_threads(NumParallelThreads())
+  {
+    const auto thread = static_cast<std::size_t>(omp_get_thread_num());
+    Workspace& ws = *workspaces_[thread];
+#pragma omp for schedule(dynamic)
+    for (std::size_t c = 0; c < num_channels; c += 1) {
+      const TwoBodyChannelIndex ch = order_[c];
+      const TwoBodyChannel& channel = ms_->Channel(ch);
+      const std::size_t n = channel.Dimension();
+      if (n == 0) {
+        continue;
+      }
+      const int two_j = channel.QuantumNumbers().TwoJ();
+      const double degeneracy = two_j + 1.0;
+      MakeSpectatorStates(sp, channel, two_j, ws.states);
+      const std::vector<SpectatorState>& states = ws.states;
+      double cost = 0.0;
+      for (std::size_t begin = 0; begin < states.size();) {
+        const std::size_t end = RunEnd(states, begin, true);
+        cost += 8.0 * static_cast<double>(n * (end - begin) * (end - begin));
+        begin = end;
+      }
+      const double norm_x = ChannelNorm(x, ch);
+      bool unpacked = false;
+
+      for (std::size_t item = 0; item < ys.size(); item += 1) {
+        const TwoBodyOperator& y = *ys[item];
+        const double* b1 = one_body_b_.data() + item * size;
+        ws.num_blocks += 1;
+        const double bound =
+            4.0 * std::abs(scale) *
+            (one_body_norm_a_ * ChannelNorm(y, ch) +
+             one_body_norms_b_[item] * norm_x);
+        if (bound < threshold) {
+          ws.Skip(degeneracy, bound, cost);
+          continue;
+        }
+        if (!unpacked) {
+          ws.x.resize(n * n);
+          ws.xt.resize(n * n);
+          x.UnpackChannel(ch, ws.x.data());
+          Transpose(ws.x.data(), n, ws.xt.data());
+          unpacked = true;
+        }
+        ws.y.resize(n * n);
+        ws.yt.resize(n * n);
+        y.UnpackChannel(ch, ws.y.data());
+        Transpose(ws.y.data(), n, ws.yt.data());
+        ws.z.assign(n * n, 0.0);
+        ws.p1.assign(n * n, 0.0);
+
+        // 1-body operators act on orbital x of states |xc; J> with
+        // spectator c: Z += A1 Y - B1 X and V += A1^T Y^T - B1^T X^T,
+        // Z -= V^T.
+        std::size_t begin = 0;
+        while (begin < states.size()) {
+          const std::size_t end = RunEnd(states, begin, true);
+          const std::size_t pw = states[begin].pw_x;
+          for (std::size_t s = begin; s < end; s += 1) {
+            const SpectatorState& bra = states[s];
+            // Both terms act on |cc; J> if x == c.
+            const double weight = (bra.x == bra.c ? 2.0 : 1.0) / bra.factor;
+            double* zs_row = ws.z.data() + bra.state * n;
+            double* vs_row = ws.p1.data() + bra.state * n;
+            for (std::size_t u = begin; u < end; u += 1) {
+              const SpectatorState& ket = states[u];
+              const double f = weight * ket.factor;
+              const double la = f * element(a1, pw, bra.x, ket.x);
+              const double lb = f * element(b1, pw, bra.x, ket.x);
+              const double lat = f * element(a1, pw, ket.x, bra.x);
+              const double lbt = f * element(b1, pw, ket.x, bra.x);
+              const double* xu = ws.x.data() + ket.state * n;
+              const double* yu = ws.y.data() + ket.state * n;
+              const double* xtu = ws.xt.data() + ket.state * n;
+              const double* ytu = ws.yt.data() + ket.state * n;
+#pragma omp simd
+              for (std::size_t k = 0; k < n; k += 1) {
+                zs_row[k] += la * yu[k] - lb * xu[k];
+                vs_row[k] += lat * ytu[k] - lbt * xtu[k];
+              }
+            }
+          }
+          begin = end;
+        }
+        ws.flops += cost;
+        for (std::size_t i = 0; i < n; i += 1) {
+          for (std::size_t j = 0; j < n; j += 1) {
+            ws.z[i * n + j] -= ws.p1[j * n + i];
+          }
+        }
+        TwoBodyOperator& z = *zs[item];
+        AddToBlock(
+            ws.z.data(),
+            n,
+            scale,
+            z.Symmetry(),
+            z.IsPacked(),
+            z.MutableBlock(ch));
+
+        // Z_ij += (2J + 1) / (2j_i + 1) sum_ab (n_a - n_b)
+        //         (A_ab Y_bi,aj - B_ab X_bi,aj) over states |bi; J>, |aj; J>.
+        begin = 0;
+        while (begin < states.size()) {
+          const std::size_t end = RunEnd(states, begin, false);
+          const std::size_t pw_c = states[begin].pw_c;
+          const PartialWaveIndex pw(states[begin].pw_x);
+          const std::size_t first = sp.PartialWaveBegin(pw).idx();
+          const std::size_t npw = sp.PartialWaveSize(pw);
+          const double weight =
+              degeneracy / (sp.Orbital(OrbitalIndex(first)).TwoJ() + 1.0);
+          double* f =
+              ws.one_body.data() + item * size + offsets_[pw.idx()];
+          for (std::size_t s = begin; s < end; s += 1) {
+            const SpectatorState& bra = states[s];
+            for (std::size_t t = begin; t < end; t += 1) {
+              const SpectatorState& ket = states[t];
+              const double dn = occupations_[ket.c] - occupations_[bra.c];
+              if (dn == 0.0) {
+                continue;
+              }
+              const std::size_t e = bra.state * n + ket.state;
+              f[(bra.x - first) * npw + (ket.x - first)] +=
+                  weight * dn * bra.factor * ket.factor *
+                  (element(a1, pw_c, ket.c, bra.c) * ws.y[e] -
+                   element(b1, pw_c, ket.c, bra.c) * ws.x[e]);
+            }
+          }
+          begin = end;
+        }
+      }
+    }
+  }
+}
+
+void CommutatorEngine::AddLadder(
+    const TwoBodyOperator& x,
+    const std::vector<const TwoBodyOperator*>& ys,
+    double scale,
+    const std::vector<TwoBodyOperator*>& zs) {
+  const SPModelSpace& sp = ms_->SP();
+  const double sx = HermiticitySign(x.Symmetry());
+  const std::size_t size = offsets_.back();
+  const std::size_t num_channels = order_.size();
+  const double threshold = options_.screening_threshold;
+
+#pragma omp parallel num_threads(NumParallelThreads())
+  {
+    const auto thread = static_cast<std::size_t>(omp_get_thread_num());
+    Workspace& ws = *workspaces_[thread];
+#pragma omp for schedule(dynamic)
+    for (std::size_t c = 0; c < num_channels; c += 1) {
+      const TwoBodyChannelIndex ch = order_[c];
+      const TwoBodyChannel& channel = ms_->Channel(ch);
+      const std::size_t n = channel.Dimension();
+      if (n == 0) {
+        continue;
+      }
+      const int two_j = channel.QuantumNumbers().TwoJ();
+      const double degeneracy = two_j + 1.0;
+
+      // P1 = X D1 Y - Y D1 X over hh weights n_a n_b, P2 over pp weights
+      // nbar_a nbar_b.
+      const auto gather = [&](bool particles) {
+        ws.columns.clear();
+        ws.weights.clear();
+        for (const auto i : channel.StateIndices()) {
+          const double na = occupations_[channel.First(i).idx()];
+          const double nb = occupations_[channel.Second(i).idx()];
+          const double w = particles ? (1.0 - na) * (1.0 - nb) : na * nb;
+          if (w != 0.0) {
+            ws.columns.push_back(i.idx());
+            ws.weights.push_back(w);
+          }
+        }
+      };
+
+      // Items with a product above the screening threshold.
+      const double norm_x = ChannelNorm(x, ch);
+      // Flops of one product of each weight class (computed on first use).
+      double cost = -1.0;
+      ws.items.clear();
+      ws.signs.clear();
+      for (std::size_t item = 0; item < ys.size(); item += 1) {
+        const double sign = sx * HermiticitySign(ys[item]->Symmetry());
+        ws.num_blocks += 1;
+        const double bound =
+            2.0 * std::abs(scale) * norm_x * ChannelNorm(*ys[item], ch);
+        if (bound < threshold) {
+          if (cost < 0.0) {
+            gather(false);
+            cost = GemmFlops(n, n, ws.columns.size());
+            gather(true);
+            cost += GemmFlops(n, n, ws.columns.size());
+          }
+          ws.Skip(degeneracy, bound, (sign != 0.0 ? 1.0 : 2.0) * cost);
+          continue;
+        }
+        ws.items.push_back(item);
+        ws.signs.push_back(sign);
+      }
+      const std::size_t num = ws.items.size();
+      if (num == 0) {
+        continue;
+      }
+      ws.x.resize(n * n);
+      ws.y.resize(num * n * n);
+      x.UnpackChannel(ch, ws.x.data());
+      for (std::size_t r = 0; r < num; r += 1) {
+        ys[ws.items[r]]->UnpackChannel(ch, ws.y.data() + r * n * n);
+      }
+      // Products with factors of x cost 2 n rank (m + n) instead of
+      // 2 n^2 m flops.
+      const bool factored = factors_ != nullptr && factors_->IsFactored(ch);
+      const std::size_t rank = factored ? factors_->Rank(ch) : n;
+      const auto product = [&](AlignedVector<double>& p) {
+        const std::size_t m = ws.columns.size();
+        if (factored && rank * (m + n) < n * m) {
+          ws.FactoredProduct(
+              n,
+              rank,
+              factors_->Left(ch),
+              factors_->Right(ch),
+              p);
+          ws.factored_blocks += 1;
+        } else {
+          ws.Product(n, p);
+        }
+      };
+      gather(false);
+      product(ws.p1);
+      gather(true);
+      product(ws.p2);
+      MakeSpectatorStates(sp, channel, two_j, ws.states);
+      const std::vector<SpectatorState>& states = ws.states;
+      gather(false);
+
+      for (std::size_t r = 0; r < num; r += 1) {
+        const std::size_t item = ws.items[r];
+        const double* p1 = ws.p1.data() + r * n * n;
+        const double* p2 = ws.p2.data() + r * n * n;
+        ws.z.resize(n * n);
+        for (std::size_t i = 0; i < n * n; i += 1) {
+          ws.z[i] = p2[i] - p1[i];
+        }
+        TwoBodyOperator& z = *zs[item];
+        AddToBlock(
+            ws.z.data(),
+            n,
+            scale,
+            z.Symmetry(),
+            z.IsPacked(),
+            z.MutableBlock(ch));
+
+        // C_0 += (2J + 1) sum_i n_i (P2)_ii over hh weights.
+        for (std::size_t k = 0; k < ws.columns.size(); k += 1) {
+          const std::size_t i = ws.columns[k];
+          ws.zero_body[item] += degeneracy * ws.weights[k] * p2[i * n + i];
+        }
+
+        // C_ij += (2J + 1) / (2j_i + 1) sum_c (nbar_c P1 + n_c P2)_ci,cj.
+        std::size_t begin = 0;
+        while (begin < states.size()) {
+          const std::size_t end = RunEnd(states, begin, true);
+          const PartialWaveIndex pw(states[begin].pw_x);
+          const std::size_t first = sp.PartialWaveBegin(pw).idx();
+          const std::size_t npw = sp.PartialWaveSize(pw);
+          const double nc = occupations_[states[begin].c];
+          const double weight =
+              degeneracy / (sp.Orbital(OrbitalIndex(first)).TwoJ() + 1.0);
+          double* f =
+              ws.one_body.data() + item * size + offsets_[pw.idx()];
+          for (std::size_t s = begin; s < end; s += 1) {
+            const SpectatorState& bra = states[s];
+            for (std::size_t t = begin; t < end; t += 1) {
+              const SpectatorState& ket = states[t];
+              const std::size_t e = bra.state * n + ket.state;
+              f[(bra.x - first) * npw + (ket.x - first)] +=
+                  weight * bra.factor * ket.factor *
+                  ((1.0 - nc) * p1[e] + nc * p2[e]);
+            }
+          }
+          begin = end;
+        }
+      }
+    }
+  }
+}
+
+void CommutatorEngine::AddParticleHole(
+    const TwoBodyOperator& x,
+    const std::vector<const TwoBodyOperator*>& ys,
+    double scale,
+    const std::vector<TwoBodyOperator*>& zs) {
+  const std::size_t num_items = ys.size();
+  const PandyaPlan& plan_x = Plan(x.Symmetry(), x.Layout());
+  PandyaTransform(plan_x, x, cross_a_);
+
+  // Cross-coupled matrices of transposes: s X-bar for (anti)hermitian X,
+  // transforms of explicit transposes otherwise.
+  const double sx = HermiticitySign(x.Symmetry());
+  if (sx == 0.0) {
+    PandyaTransform(plan_x, Transposed(x), cross_at_);
+  }
+  const std::vector<AlignedVector<double>>& xt = sx == 0.0 ? cross_at_
+                                                           : cross_a_;
+  const double fx = sx == 0.0 ? 1.0 : sx;
+  cross_b_.resize(num_items);
+  cross_bt_.resize(num_items);
+  cross_c_.resize(num_items);
+  std::vector<double> sy(num_items);
+  for (std::size_t k = 0; k < num_items; k += 1) {
+    const TwoBodyOperator& y = *ys[k];
+    const PandyaPlan& plan_y = Plan(y.Symmetry(), y.Layout());
+    PandyaTransform(plan_y, y, cross_b_[k]);
+    sy[k] = HermiticitySign(y.Symmetry());
+    if (sy[k] == 0.0) {
+      PandyaTransform(plan_y, Transposed(y), cross_bt_[k]);
+    }
+    cross_c_[k].resize(plan_x.NumChannels());
+  }
+  // Get cross-coupled matrix of transpose of item k and its factor.
+  const auto yt = [&](std::size_t k, std::size_t c) -> const double* {
+    return sy[k] == 0.0 ? cross_bt_[k][c].data() : cross_b_[k][c].data();
+  };
+  const auto fy = [&sy](std::size_t k) {
+    return sy[k] == 0.0 ? 1.0 : sy[k];
+  };
+
+  const std::size_t num_channels = plan_x.NumChannels();
+  std::vector<std::size_t> order(num_channels);
+  for (std::size_t c = 0; c < num_channels; c += 1) {
+    order[c] = c;
+  }
+  std::stable_sort(
+      order.begin(),
+      order.end(),
+      [&plan_x](std::size_t a, std::size_t b) {
+        return plan_x.Channel(a).bras.size() > plan_x.Channel(b).bras.size();
+      });
+  const double threshold = options_.screening_threshold;
+
+#pragma omp parallel num_threads(NumParallelThreads())
+  {
+    const auto thread = static_cast<std::size_t>(omp_get_thread_num());
+    Workspace& ws = *workspaces_[thread];
+#pragma omp for schedule(dynamic)
+    for (std::size_t k = 0; k < num_channels; k += 1) {
+      const std::size_t c = order[k];
+      const CrossCoupledChannel& channel = plan_x.Channel(c);
+      const std::size_t nb = channel.bras.size();
+      const std::size_t nk = channel.kets.size();
+      for (std::size_t item = 0; item < num_items; item += 1) {
+        cross_c_[item][c].assign(nb * nb, 0.0);
+      }
+
+      // Kets |ab^-1> with weight n_a - n_b != 0.
+      ws.columns.clear();
+      ws.weights.clear();
+      for (std::size_t j = 0; j < nk; j += 1) {
+        const double w = occupations_[channel.kets[j].a] -
+                         occupations_[channel.kets[j].b];
+        if (w != 0.0) {
+          ws.columns.push_back(j);
+          ws.weights.push_back(w);
+        }
+      }
+      const std::size_t m = ws.columns.size();
+      if (nb == 0 || m == 0) {
+        continue;
+      }
+
+      // Items with a product above the screening threshold.
+      const double norm_x = FrobeniusNorm(cross_a_[c].data(), nb * nk);
+      const double norm_xt = FrobeniusNorm(xt[c].data(), nb * nk);
+      ws.items.clear();
+      ws.rows.clear();
+      for (std::size_t item = 0; item < num_items; item += 1) {
+        const bool symmetric = sx != 0.0 && sy[item] != 0.0;
+        ws.num_blocks += 1;
+        const double bound =
+            std::abs(scale) *
+            (norm_x * FrobeniusNorm(yt(item, c), nb * nk) +
+             FrobeniusNorm(cross_b_[item][c].data(), nb * nk) * norm_xt);
+        if (bound < threshold) {
+          ws.Skip(
+              channel.qn.TwoJ() + 1.0,
+              bound,
+              (symmetric ? 1.0 : 2.0) * GemmFlops(nb, nb, m));
+          continue;
+        }
+        ws.items.push_back(item);
+        if (!symmetric) {
+          ws.rows.push_back(item);
+        }
+      }
+      if (ws.items.empty()) {
+        continue;
+      }
+
+      // Stacked U_r[:, kets] D V[:, kets]^T for rows u_r of items.
+      const auto product = [&](const std::vector<std::size_t>& items,
+                               const auto& u,
+                               const double* v,
+                               AlignedVector<double>& out) {
+        const std::size_t num = items.size();
+        ws.left.resize(num * nb * m);
+        ws.right.resize(nb * m);
+        for (std::size_t r = 0; r < num; r += 1) {
+          const double* ur = u(items[r]);
+          double* lr = ws.left.data() + r * nb * m;
+          for (std::size_t i = 0; i < nb; i += 1) {
+            for (std::size_t j = 0; j < m; j += 1) {
+              lr[i * m + j] = ur[i * nk + ws.columns[j]] * ws.weights[j];
+            }
+          }
+        }
+        for (std::size_t i = 0; i < nb; i += 1) {
+          for (std::size_t j = 0; j < m; j += 1) {
+            ws.right[i * m + j] = v[i * nk + ws.columns[j]];
+          }
+        }
+        out.resize(num * nb * nb);
+        Gemm(
+            GemmOp::kNormal,
+            GemmOp::kTranspose,
+            num * nb,
+            nb,
+            m,
+            1.0,
+            ws.left.data(),
+            m,
+            ws.right.data(),
+            m,
+            0.0,
+            out.data(),
+            nb);
+        ws.flops += GemmFlops(num * nb, nb, m);
+      };
+      // T_r = Yt_r D A^T, so that fy A D Yt_r^T = fy T_r^T.
+      product(
+          ws.items,
+          [&](std::size_t item) { return yt(item, c); },
+          cross_a_[c].data(),
+          ws.p1);
+      // U_r = B_r D Xt^T for items without symmetry.
+      if (!ws.rows.empty()) {
+        product(
+            ws.rows,
+            [&](std::size_t item) { return cross_b_[item][c].data(); },
+            xt[c].data(),
+            ws.p2);
+      }
+
+      std::size_t t = 0;
+      for (std::size_t r = 0; r < ws.items.size(); r += 1) {
+        const std::size_t item = ws.items[r];
+        const double* tr = ws.p1.data() + r * nb * nb;
+        double* zbar = cross_c_[item][c].data();
+        const double f = fy(item);
+        if (sx != 0.0 && sy[item] != 0.0) {
+          // Zbar = G - s G^T with G = f T^T.
+          const double s = sx * sy[item];
+          for (std::size_t i = 0; i < nb; i += 1) {
+            for (std::size_t j = 0; j < nb; j += 1) {
+              zbar[i * nb + j] = f * (tr[j * nb + i] - s * tr[i * nb + j]);
+            }
+          }
+          continue;
+        }
+        // Zbar = f T^T - fx U.
+        const double* ur = ws.p2.data() + t * nb * nb;
+        for (std::size_t i = 0; i < nb; i += 1) {
+          for (std::size_t j = 0; j < nb; j += 1) {
+            zbar[i * nb + j] = f * tr[j * nb + i] - fx * ur[i * nb + j];
+          }
+        }
+        t += 1;
+      }
+    }
+  }
+  for (std::size_t k = 0; k < num_items; k += 1) {
+    TwoBodyOperator& z = *zs[k];
+    InversePandyaTransform(
+        Plan(z.Symmetry(), z.Layout()),
+        cross_c_[k],
+        -scale,
+        z);
+  }
+}
+
+void CommutatorEngine::ReduceOneBody(
+    std::size_t item,
+    double scale,
+    OneBodyOperator& out) {
+  const SPModelSpace& sp = ms_->SP();
+  const bool packed = IsSymmetric(out.Symmetry());
+  const std::size_t size = offsets_.back();
+  out.PrepareWrites();
+  AlignedVector<double> sum;
+  for (const auto pw : sp.PartialWaveIndices()) {
+    const std::size_t n = sp.PartialWaveSize(pw);
+    sum.assign(n * n, 0.0);
+    for (const auto& ws : workspaces_) {
+      const double* f = ws->one_body.data() + item * size + offsets_[pw.idx()];
+      for (std::size_t i = 0; i < n * n; i += 1) {
+        sum[i] += f[i];
+      }
+    }
+    AddToBlock(
+        sum.data(),
+        n,
+        scale,
+        out.Symmetry(),
+        packed,
+        out.MutableBlock(pw));
+  }
+}
+
+std::size_t CommutatorEngine::MemoryLoad() const {
+  std::size_t load = (occupations_.capacity() + one_body_a_.capacity() +
+                      one_body_b_.capacity() + one_body_norms_b_.capacity()) *
+                         sizeof(double) +
+                     offsets_.capacity() * sizeof(std::size_t) +
+                     order_.capacity() * sizeof(TwoBodyChannelIndex) +
+                     PlanMemoryLoad();
+  for (const auto& ws : workspaces_) {
+    load += ws->MemoryLoad();
+  }
+  for (const auto* cross : {&cross_a_, &cross_at_}) {
+    for (const auto& x : *cross) {
+      load += x.capacity() * sizeof(double);
+    }
+  }
+  for (const auto* cross : {&cross_b_, &cross_bt_, &cross_c_}) {
+    for (const auto& item : *cross) {
+      for (const auto& x : item) {
+        load += x.capacity() * sizeof(double);
+      }
+    }
+  }
+  return load;
+}
+
+std::size_t CommutatorEngine::PlanMemoryLoad() const {
+  const std::lock_guard<std::mutex> lock(plans_->mutex);
+  std::size_t load = 0;
+  for (const auto& plan : plans_->plans) {
+    if (plan != nullptr) {
+      load += plan->MemoryLoad();
+    }
+  }
+  return load;
+}
+
+}  // namespace nui
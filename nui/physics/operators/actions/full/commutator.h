@@ -0,0 +1,312 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_OPERATORS_ACTIONS_FULL_COMMUTATOR_H_
+#define NUI_PHYSICS_OPERATORS_ACTIONS_FULL_COMMUTATOR_H_
+
+// IWYU pragma: private, include "nui/physics/operators/actions/full/op_actions_full.h"
+// IWYU pragma: friend "nui/physics/operators/actions/full/.*\.h"
+
+#include <array>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/memory/memory.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/operators/actions/2b/op_actions_2b.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+#include "nui/physics/operators/storage/full/op_full.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+
+// Commutators C = [A, B] of normal-ordered operators truncated at the
+// 2-body level (IMSRG(2)). With antisymmetrized m-scheme elements, nbar =
+// 1 - n, and P_ij exchanging indices:
+//
+//   C_0    = sum_ab (n_a - n_b) A_ab B_ba
+//            + 1/4 sum_abcd n_a n_b nbar_c nbar_d (A_abcd B_cdab - B A),
+//   C_ij   = sum_a (A_ia B_aj - B_ia A_aj)
+//            + sum_ab (n_a - n_b) (A_ab B_biaj - B_ab A_biaj)
+//            + 1/2 sum_abc (n_a n_b nbar_c + nbar_a nbar_b n_c)
+//                          (A_ciab B_abcj - B_ciab A_abcj),
+//   C_ijkl = (1 - P_ij) sum_a (A_ia B_ajkl - B_ia A_ajkl)
+//            - (1 - P_kl) sum_a (A_ak B_ijal - B_ak A_ijal)
+//            + 1/2 sum_ab (1 - n_a - n_b) (A_ijab B_abkl - B_ijab A_abkl)
+//            + (1 - P_ij) (1 - P_kl) sum_ab (n_a - n_b) A_aibk B_bjal.
+//
+// The J-scheme terms are evaluated channel by channel:
+//
+// - [1,2]: the 1-body operators act on 2-body states as sparse matrices
+//   within a channel (one row update per orbital of a partial wave), and the
+//   1-body result contracts pairs of states with a common spectator.
+// - pp/hh ladder: C = A D B - B D A with diagonal D over pp (nbar nbar) and
+//   hh (n n) states, one GEMM per channel and weight class on the gathered
+//   columns. The same products give the [2,2] -> 0, 1 terms.
+// - particle-hole: both operators are Pandya transformed (see pandya.h) to
+//   cross-coupled matrices with particle-hole kets, multiplied with weights
+//   n_a - n_b in one GEMM per cross-coupled channel, and transformed back
+//   with antisymmetrization.
+//
+// Channels are processed in parallel, largest first, with scratch matrices
+// per thread that the engine keeps between calls. If both operators are
+// (anti)hermitian, B D A = s_A s_B (A D B)^T, so each product is one GEMM.
+//
+// Block products are screened by norms: a channel is skipped if the bound
+// of its contribution, from Frobenius norms of the blocks (|D| <= 1), is
+// below the screening threshold. Late in a flow most blocks of the generator
+// are negligible, so most GEMMs are skipped. The bounds are
+//
+//   [1,2]:  4 |scale| (|A1| |Y| + |B1| |X|)  with |A1| the largest 1-body
+//                                            partial-wave block norm,
+//   pp/hh:  2 |scale| |X| |Y|               per 2-body channel,
+//   ph:     2 |scale| |Xbar| |Ybar|         per cross-coupled channel
+//                                            (with norms of transforms of
+//                                            transposes if not symmetric).
+//
+// Only the 2-body part of a skipped contribution is bounded; its 0- and
+// 1-body parts are of the same order.
+//
+// The 2-body part of A may also be given as low-rank factors X ~ L R (see
+// LowRankTwoBodyOperator). The pp/hh products of factored channels are then
+// evaluated as L (R D Y) and (Y D L) R in O(n^2 r) instead of O(n^2 m)
+// flops if that is cheaper (for pp weights when r < n / 2, roughly). The
+// other terms use the dense blocks of A, whose cost is dominated by the
+// transforms and the 1-body contractions.
+//
+// Commutators [A, B_k] of one operator with a batch of operators, e.g.,
+// observables transformed with one Magnus operator, share the unpacked and
+// transformed blocks of A, and the products of all B_k in a channel are
+// stacked into the rows of one GEMM. The rows of A-side products are then
+// reused across the batch, which pays off for small channels, where single
+// GEMMs do not reach peak rate.
+
+namespace nui {
+
+// Terms of IMSRG(2) commutators, timed separately.
+enum class CommutatorTerm : std::uint8_t {
+  // [1,1] -> 0, 1.
+  kOneOne = 0,
+  // [1,2] -> 1, 2.
+  kOneTwo = 1,
+  // [2,2] -> 0, 1 and the pp/hh ladder [2,2] -> 2.
+  kLadder = 2,
+  // Particle-hole [2,2] -> 2.
+  kParticleHole = 3,
+};
+
+// Number of commutator terms.
+inline constexpr std::size_t kNumCommutatorTerms = 4;
+
+// Get string representation of commutator term.
+std::string_view ToString(CommutatorTerm term);
+
+// Options of commutator engines.
+struct CommutatorOptions {
+  // Skip block products with a bound of their contribution below this
+  // threshold (0 disables screening).
+  double screening_threshold = 1e-12;
+};
+
+// Accumulated cost of commutators by term.
+struct CommutatorStatistics {
+  // Wall time in seconds.
+  std::array<double, kNumCommutatorTerms> seconds = {};
+  // Floating point operations of matrix products and row updates.
+  std::array<double, kNumCommutatorTerms> flops = {};
+  // Floating point operations of skipped products.
+  std::array<double, kNumCommutatorTerms> skipped_flops = {};
+  // Number of channel blocks, evaluated or skipped.
+  std::array<std::size_t, kNumCommutatorTerms> num_blocks = {};
+  // Number of skipped channel blocks.
+  std::array<std::size_t, kNumCommutatorTerms> skipped_blocks = {};
+  // Number of block products evaluated with low-rank factors.
+  std::array<std::size_t, kNumCommutatorTerms> factored_blocks = {};
+  // Bound of the norm of skipped 2-body contributions, sqrt(sum_J (2J + 1)
+  // bound_J^2) per commutator and summed over commutators (for the
+  // particle-hole term in the norm of cross-coupled matrices).
+  std::array<double, kNumCommutatorTerms> error_bound = {};
+  // Number of evaluated commutators.
+  std::size_t num_commutators = 0;
+};
+
+// Engine evaluating IMSRG(2) commutators of operators in one 2-body model
+// space.
+//
+// The engine owns Pandya plans (built on first use for each hermiticity and
+// layout) and scratch buffers, so repeated commutators, e.g., in a flow, do
+// not allocate. Calls on one engine must not overlap. Engines from Share()
+// have their own scratch but share plans, so they can evaluate commutators
+// concurrently, e.g., for an ensemble of Hamiltonians.
+class CommutatorEngine {
+ public:
+  // Build engine for operators in ms with normal ordering occupations.
+  CommutatorEngine(
+      std::shared_ptr<const TwoBodyModelSpace> ms,
+      std::vector<double> occupations,
+      CommutatorOptions options = {});
+
+  // Build engine with the occupations of the reference state of ms.
+  explicit CommutatorEngine(std::shared_ptr<const TwoBodyModelSpace> ms);
+
+  ~CommutatorEngine();
+  CommutatorEngine(CommutatorEngine&&) noexcept;
+  CommutatorEngine& operator=(CommutatorEngine&&) noexcept;
+
+  // Get engine with the model space, occupations, and options of this
+  // engine that shares its Pandya plans (built so far and later by either
+  // engine) but not its scratch or statistics.
+  CommutatorEngine Share() const;
+
+  // Get two-body model space.
+  const TwoBodyModelSpace& ModelSpace() const { return *ms_; }
+
+  // Get occupations.
+  const std::vector<double>& Occupations() const { return occupations_; }
+
+  // Get options.
+  const CommutatorOptions& Options() const { return options_; }
+
+  // Set options (for subsequent commutators).
+  void SetOptions(const CommutatorOptions& options) { options_ = options; }
+
+  // Check if AddCommutator(a, b, scale, out) accepts the operators.
+  //
+  // The check only depends on the model spaces and hermiticities, so it
+  // holds for all operators with the same ones.
+  bool Accepts(const Operator& a, const Operator& b, const Operator& out) const;
+
+  // Add scale * [a, b] to out (0-, 1-, and 2-body parts).
+  //
+  // 3-body parts are ignored, and out must not alias a or b. Returns false
+  // (and does nothing) if an operator has another 2-body model space, the
+  // occupations do not have one entry per orbital, or out is (anti)hermitian
+  // and [a, b] does not have its hermiticity.
+  bool AddCommutator(
+      const Operator& a,
+      const Operator& b,
+      double scale,
+      Operator& out);
+
+  // Add scale * [a, bs[k]] to outs[k] for all k.
+  //
+  // Equivalent to AddCommutator for each k, with the same conditions for
+  // all pairs. Hermiticities and layouts of the bs may differ. Returns false
+  // (and does nothing) if bs and outs differ in size or a pair is invalid.
+  bool AddCommutators(
+      const Operator& a,
+      const std::vector<const Operator*>& bs,
+      double scale,
+      const std::vector<Operator*>& outs);
+
+  // Add scale * [a, b] to out, or scale * [a, bs[k]] to outs[k], with
+  // a_factors approximating the 2-body part of a in the pp/hh ladder term.
+  //
+  // The results differ from the dense ones by the compression error of
+  // a_factors. Returns false (and does nothing) if a_factors has another
+  // model space or hermiticity than a, or as AddCommutator(s).
+  bool AddCommutator(
+      const Operator& a,
+      const LowRankTwoBodyOperator& a_factors,
+      const Operator& b,
+      double scale,
+      Operator& out);
+  bool AddCommutators(
+      const Operator& a,
+      const LowRankTwoBodyOperator& a_factors,
+      const std::vector<const Operator*>& bs,
+      double scale,
+      const std::vector<Operator*>& outs);
+
+  // Get accumulated statistics.
+  const CommutatorStatistics& Statistics() const { return stats_; }
+
+  // Reset accumulated statistics.
+  void ResetStatistics() { stats_ = {}; }
+
+  // Get size of plans (including shared plans) and scratch in dynamic
+  // memory.
+  std::size_t MemoryLoad() const;
+
+  // Get size of plans in dynamic memory.
+  std::size_t PlanMemoryLoad() const;
+
+ private:
+  struct PlanCache;
+  struct Workspace;
+
+  // Get Pandya plan of operators with hermiticity and layout.
+  const PandyaPlan& Plan(Hermiticity h, BlockLayout layout);
+
+  // Add terms of all items to per-thread results (1-body parts from
+  // unpacked blocks) and scaled 2-body results to zs.
+  void AddOneOne(std::size_t num_items);
+  void AddOneTwo(
+      const TwoBodyOperator& x,
+      const std::vector<const TwoBodyOperator*>& ys,
+      double scale,
+      const std::vector<TwoBodyOperator*>& zs);
+  void AddLadder(
+      const TwoBodyOperator& x,
+      const std::vector<const TwoBodyOperator*>& ys,
+      double scale,
+      const std::vector<TwoBodyOperator*>& zs);
+  void AddParticleHole(
+      const TwoBodyOperator& x,
+      const std::vector<const TwoBodyOperator*>& ys,
+      double scale,
+      const std::vector<TwoBodyOperator*>& zs);
+
+  // Add per-thread 1-body results of item to out.
+  void ReduceOneBody(std::size_t item, double scale, OneBodyOperator& out);
+
+  std::shared_ptr<const TwoBodyModelSpace> ms_;
+  std::vector<double> occupations_;
+  CommutatorOptions options_;
+  // Offsets of full partial-wave blocks in 1-body scratch.
+  std::vector<std::size_t> offsets_;
+  // 2-body channels, largest first.
+  std::vector<TwoBodyChannelIndex> order_;
+  // Plans by 2 * hermiticity + layout, shared by engines from Share().
+  std::shared_ptr<PlanCache> plans_;
+  std::vector<std::unique_ptr<Workspace>> workspaces_;
+  // Full 1-body blocks of a and of the bs (one set of blocks per item).
+  AlignedVector<double> one_body_a_;
+  AlignedVector<double> one_body_b_;
+  // Largest Frobenius norms of 1-body partial-wave blocks of a and the bs.
+  double one_body_norm_a_ = 0.0;
+  std::vector<double> one_body_norms_b_;
+  // Factors of the 2-body part of a during a call (null if none).
+  const LowRankTwoBodyOperator* factors_ = nullptr;
+  // Cross-coupled matrices of the particle-hole term (by item for the bs
+  // and results).
+  std::vector<AlignedVector<double>> cross_a_;
+  std::vector<AlignedVector<double>> cross_at_;
+  std::vector<std::vector<AlignedVector<double>>> cross_b_;
+  std::vector<std::vector<AlignedVector<double>>> cross_bt_;
+  std::vector<std::vector<AlignedVector<double>>> cross_c_;
+  CommutatorStatistics stats_;
+};
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_OPERATORS_ACTIONS_FULL_COMMUTATOR_H_
@@ -0,0 +1,220 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "fmt/core.h"
+#include "nui/core/basics/basics.h"
+#include "nui/info/profiling/profiling.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/actions/full/op_actions_full.h"
+#include "nui/physics/operators/storage/full/op_full.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+#include "nui/physics/operators/storage/testing/op_testing.h"
+
+// Benchmark of IMSRG(2) commutators [eta, H] of an antihermitian generator
+// and a hermitian Hamiltonian.
+//
+// Usage: nui_..._commutator_bench [emax] [e2max] [repeats] [threshold]
+//                                  [decay] [rank]
+//
+// e2max < 0 uses 2 * emax. The first commutator builds the Pandya plans and
+// is timed separately. The table shows the average time and rate of each
+// term over the repeated commutators, and the fraction of skipped blocks
+// and flops with the screening threshold. Channel c of the generator is
+// scaled by decay^c, which mimics the decaying generator late in a flow.
+//
+// With rank > 0, the 2-body blocks of the generator have rank 2 * rank
+// (antihermitian sums of outer products). The generator is then compressed
+// (see LowRankTwoBodyOperator), the achieved ranks and memory of the
+// largest channels are shown, and the commutators use the factors.
+
+namespace {
+
+// Scale channel c of the 2-body part of op by decay^c.
+void Decay(double decay, nui::Operator& op) {
+  nui::TwoBodyOperator& v = op.TwoBody();
+  double factor = 1.0;
+  for (const auto ch : v.ModelSpace().ChannelIndices()) {
+    double* block = v.MutableBlock(ch);
+    for (std::size_t i = 0; i < v.ChannelSize(ch); i += 1) {
+      block[i] *= factor;
+    }
+    factor *= decay;
+  }
+}
+
+// Set 2-body blocks of antihermitian op to sum_k f_k g_k^T - g_k f_k^T.
+void FillLowRank(std::size_t rank, nui::Operator& op) {
+  nui::TwoBodyOperator& v = op.TwoBody();
+  std::vector<double> full;
+  for (const auto ch : v.ModelSpace().ChannelIndices()) {
+    const std::size_t n = v.ChannelDimension(ch);
+    full.assign(n * n, 0.0);
+    for (std::size_t k = 0; k < rank; k += 1) {
+      for (std::size_t i = 0; i < n; i += 1) {
+        for (std::size_t j = 0; j < n; j += 1) {
+          const double fi = std::cos(0.3 * (k + 1) * i);
+          const double fj = std::cos(0.3 * (k + 1) * j);
+          const double gi = std::sin(0.7 * i + k);
+          const double gj = std::sin(0.7 * j + k);
+          full[i * n + j] += (fi * gj - gi * fj) / (1.0 + k);
+        }
+      }
+    }
+    v.PackChannel(ch, full.data());
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int emax = argc > 1 ? std::atoi(argv[1]) : 6;
+  const int e2max = argc > 2 ? std::atoi(argv[2]) : -1;
+  const int repeats = argc > 3 ? std::atoi(argv[3]) : 3;
+  nui::CommutatorOptions options;
+  if (argc > 4) {
+    options.screening_threshold = std::atof(argv[4]);
+  }
+  const double decay = argc > 5 ? std::atof(argv[5]) : 1.0;
+  const int rank = argc > 6 ? std::atoi(argv[6]) : 0;
+
+  const auto sp = nui::SPModelSpace::Make(
+      nui::SPTruncation(emax),
+      nui::Reference::HOEqualFilling(8, 8));
+  const auto ms = e2max < 0 ? nui::TwoBodyModelSpace::Make(sp)
+                            : nui::TwoBodyModelSpace::Make(
+                                  sp,
+                                  nui::TwoBodyTruncation{e2max});
+  nui::Operator eta(ms, nui::Hermiticity::kAntihermitian);
+  nui::Operator h(ms, nui::Hermiticity::kHermitian);
+  nui::testing::Fill(1.0, eta);
+  nui::testing::Fill(0.5, h);
+  Decay(decay, eta);
+  if (rank > 0) {
+    FillLowRank(static_cast<std::size_t>(rank), eta);
+  }
+  fmt::print(
+      "emax = {}, e2max = {}, threshold = {:.1e}, decay = {}, orbitals = {}, "
+      "2-body = {:.1f} MB\n",
+      emax,
+      ms->Truncation().e2max,
+      options.screening_threshold,
+      decay,
+      sp->NumOrbitals(),
+      h.TwoBody().Blocks().TotalSize() * sizeof(double) * 1e-6);
+
+  nui::LowRankOptions low_rank;
+  low_rank.tolerance = 1e-10;
+  std::unique_ptr<nui::LowRankTwoBodyOperator> factors;
+  if (rank > 0) {
+    const double seconds = nui::TimeSeconds([&]() {
+      factors = std::make_unique<nui::LowRankTwoBodyOperator>(
+          eta.TwoBody(),
+          low_rank);
+    });
+    const nui::LowRankStatistics stats = factors->Statistics();
+    fmt::print(
+        "Compression {:.3f} ms: {} of {} channels factored, max rank {}, "
+        "rank / n = {:.3f}, {:.1f} of {:.1f} MB, error {:.2e}\n",
+        seconds * 1e3,
+        stats.factored_channels,
+        stats.num_channels,
+        stats.max_rank,
+        stats.rank_fraction,
+        stats.compressed_bytes * 1e-6,
+        stats.source_bytes * 1e-6,
+        stats.error);
+    std::vector<nui::TwoBodyChannelIndex> channels;
+    for (const auto ch : ms->ChannelIndices()) {
+      channels.push_back(ch);
+    }
+    std::stable_sort(
+        channels.begin(),
+        channels.end(),
+        [&ms](nui::TwoBodyChannelIndex a, nui::TwoBodyChannelIndex b) {
+          return ms->Channel(a).Dimension() > ms->Channel(b).Dimension();
+        });
+    for (std::size_t i = 0; i < std::min<std::size_t>(5, channels.size());
+         i += 1) {
+      const nui::TwoBodyChannelIndex ch = channels[i];
+      fmt::print(
+          "  channel {:>4}: n = {:>5}, rank = {:>4}, error {:.2e}\n",
+          ch.idx(),
+          factors->ChannelDimension(ch),
+          factors->Rank(ch),
+          factors->Error(ch));
+    }
+  }
+
+  nui::CommutatorEngine engine(ms, sp->Occupations(), options);
+  nui::Operator c(ms, nui::Hermiticity::kHermitian);
+  const auto commutator = [&]() {
+    if (factors != nullptr) {
+      engine.AddCommutator(eta, *factors, h, 1.0, c);
+    } else {
+      engine.AddCommutator(eta, h, 1.0, c);
+    }
+  };
+  const double first = nui::TimeSeconds(commutator);
+  fmt::print(
+      "{:<24} {:>10.3f} ms  engine = {:.1f} MB\n",
+      "First commutator",
+      first * 1e3,
+      engine.MemoryLoad() * 1e-6);
+
+  engine.ResetStatistics();
+  const double total = nui::TimeSeconds([&]() {
+    for (int i = 0; i < repeats; i += 1) {
+      commutator();
+    }
+  });
+  const nui::CommutatorStatistics& stats = engine.Statistics();
+  const double n = static_cast<double>(stats.num_commutators);
+  for (std::size_t t = 0; t < nui::kNumCommutatorTerms; t += 1) {
+    const double all_flops = stats.flops[t] + stats.skipped_flops[t];
+    fmt::print(
+        "{:<24} {:>10.3f} ms  {:>8.2f} GFLOP/s  skipped {:>5.1f}% blocks "
+        "{:>5.1f}% flops  bound {:.2e}  factored {}\n",
+        nui::ToString(static_cast<nui::CommutatorTerm>(t)),
+        stats.seconds[t] / n * 1e3,
+        stats.seconds[t] > 0.0 ? stats.flops[t] / stats.seconds[t] * 1e-9
+                               : 0.0,
+        stats.num_blocks[t] > 0 ? 100.0 * stats.skipped_blocks[t] /
+                                      static_cast<double>(stats.num_blocks[t])
+                                : 0.0,
+        all_flops > 0.0 ? 100.0 * stats.skipped_flops[t] / all_flops : 0.0,
+        stats.error_bound[t] / n,
+        stats.factored_blocks[t] / stats.num_commutators);
+  }
+  fmt::print(
+      "{:<24} {:>10.3f} ms  C0 = {:.10e}\n",
+      "Commutator",
+      total / n * 1e3,
+      c.ZeroBody());
+  return 0;
+}
@@ -0,0 +1,540 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/actions/full/commutator.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "catch2/catch_approx.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "nui/core/basics/basics.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/actions/testing/op_actions_testing.h"
+#include "nui/physics/operators/storage/1b/op_1b.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+#include "nui/physics/operators/storage/full/op_full.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+#include "nui/physics/operators/storage/testing/op_testing.h"
+
+// The J-scheme commutator is checked against the m-scheme formulas in a
+// small model space (emax = 2, 40 m-states). 2-body elements of the
+// reference are only evaluated on a sample of m-scheme elements.
+
+namespace {
+
+using nui::Hermiticity;
+using nui::OrbitalIndex;
+using nui::testing::Fill;
+using nui::testing::MakeMStates;
+using nui::testing::MakeTwoBodyModelSpace;
+using nui::testing::MState;
+
+// m-scheme operator with dense 1- and antisymmetrized 2-body parts.
+struct MOperator {
+  double zero_body = 0.0;
+  std::vector<double> one_body;
+  std::vector<double> two_body;
+};
+
+MOperator MScheme(const nui::Operator& op, const std::vector<MState>& ms) {
+  const std::size_t n = ms.size();
+  MOperator out;
+  out.zero_body = op.ZeroBody();
+  out.one_body.assign(n * n, 0.0);
+  for (std::size_t p = 0; p < n; p += 1) {
+    for (std::size_t q = 0; q < n; q += 1) {
+      if (ms[p].two_m == ms[q].two_m) {
+        out.one_body[p * n + q] =
+            op.OneBody().Get(ms[p].orbital, ms[q].orbital);
+      }
+    }
+  }
+  out.two_body = nui::testing::MScheme(op.TwoBody(), ms);
+  return out;
+}
+
+// [A, B] by the m-scheme formulas (0- and 1-body parts dense, 2-body
+// elements on demand).
+class MCommutator {
+ public:
+  MCommutator(
+      const MOperator& a,
+      const MOperator& b,
+      const std::vector<double>& occ)
+      : a_(a), b_(b), occ_(occ), n_(occ.size()) {}
+
+  double ZeroBody() const {
+    const std::size_t n = n_;
+    double sum = 0.0;
+    for (std::size_t p = 0; p < n; p += 1) {
+      for (std::size_t q = 0; q < n; q += 1) {
+        sum += (occ_[p] - occ_[q]) * One(a_, p, q) * One(b_, q, p);
+        for (std::size_t r = 0; r < n; r += 1) {
+          for (std::size_t s = 0; s < n; s += 1) {
+            sum += 0.25 * occ_[p] * occ_[q] * Nbar(r) * Nbar(s) *
+                   (Two(a_, p, q, r, s) * Two(b_, r, s, p, q) -
+                    Two(b_, p, q, r, s) * Two(a_, r, s, p, q));
+          }
+        }
+      }
+    }
+    return sum;
+  }
+
+  double OneBody(std::size_t i, std::size_t j) const {
+    const std::size_t n = n_;
+    double sum = 0.0;
+    for (std::size_t x = 0; x < n; x += 1) {
+      sum += One(a_, i, x) * One(b_, x, j) - One(b_, i, x) * One(a_, x, j);
+      for (std::size_t y = 0; y < n; y += 1) {
+        sum += (occ_[x] - occ_[y]) * (One(a_, x, y) * Two(b_, y, i, x, j) -
+                                      One(b_, x, y) * Two(a_, y, i, x, j));
+        for (std::size_t z = 0; z < n; z += 1) {
+          const double f =
+              occ_[x] * occ_[y] * Nbar(z) + Nbar(x) * Nbar(y) * occ_[z];
+          if (f != 0.0) {
+            sum += 0.5 * f *
+                   (Two(a_, z, i, x, y) * Two(b_, x, y, z, j) -
+                    Two(b_, z, i, x, y) * Two(a_, x, y, z, j));
+          }
+        }
+      }
+    }
+    return sum;
+  }
+
+  double TwoBody(
+      std::size_t i,
+      std::size_t j,
+      std::size_t k,
+      std::size_t l) const {
+    const std::size_t n = n_;
+    double sum = 0.0;
+    for (std::size_t x = 0; x < n; x += 1) {
+      sum += One(a_, i, x) * Two(b_, x, j, k, l) -
+             One(b_, i, x) * Two(a_, x, j, k, l) -
+             One(a_, j, x) * Two(b_, x, i, k, l) +
+             One(b_, j, x) * Two(a_, x, i, k, l);
+      sum -= One(a_, x, k) * Two(b_, i, j, x, l) -
+             One(b_, x, k) * Two(a_, i, j, x, l) -
+             One(a_, x, l) * Two(b_, i, j, x, k) +
+             One(b_, x, l) * Two(a_, i, j, x, k);
+      for (std::size_t y = 0; y < n; y += 1) {
+        sum += 0.5 * (1.0 - occ_[x] - occ_[y]) *
+               (Two(a_, i, j, x, y) * Two(b_, x, y, k, l) -
+                Two(b_, i, j, x, y) * Two(a_, x, y, k, l));
+      }
+    }
+    return sum + ParticleHole(i, j, k, l) - ParticleHole(j, i, k, l) -
+           ParticleHole(i, j, l, k) + ParticleHole(j, i, l, k);
+  }
+
+ private:
+  double Nbar(std::size_t p) const { return 1.0 - occ_[p]; }
+
+  double One(const MOperator& x, std::size_t p, std::size_t q) const {
+    return x.one_body[p * n_ + q];
+  }
+
+  double Two(
+      const MOperator& x,
+      std::size_t p,
+      std::size_t q,
+      std::size_t r,
+      std::size_t s) const {
+    return x.two_body[((p * n_ + q) * n_ + r) * n_ + s];
+  }
+
+  // Get sum_ab (n_a - n_b) A_aibk B_bjal.
+  double ParticleHole(
+      std::size_t i,
+      std::size_t j,
+      std::size_t k,
+      std::size_t l) const {
+    double sum = 0.0;
+    for (std::size_t x = 0; x < n_; x += 1) {
+      for (std::size_t y = 0; y < n_; y += 1) {
+        if (occ_[x] != occ_[y]) {
+          sum += (occ_[x] - occ_[y]) * Two(a_, x, i, y, k) *
+                 Two(b_, y, j, x, l);
+        }
+      }
+    }
+    return sum;
+  }
+
+  const MOperator& a_;
+  const MOperator& b_;
+  const std::vector<double>& occ_;
+  std::size_t n_;
+};
+
+void CheckCommutator(
+    Hermiticity ha,
+    Hermiticity hb,
+    Hermiticity hc,
+    bool packed,
+    bool fractional) {
+  const auto ms =
+      MakeTwoBodyModelSpace(2, nui::Reference::HOEqualFilling(2, 2));
+  const nui::SPModelSpace& sp = ms->SP();
+  const std::vector<double> occupations =
+      fractional ? nui::testing::MakeOccupations(sp, 1) : sp.Occupations();
+  nui::Operator a(ms, ha, packed);
+  nui::Operator b(ms, hb, packed);
+  Fill(1.0, a);
+  Fill(2.0, b);
+  nui::Operator c(ms, hc, packed);
+  nui::CommutatorEngine engine(ms, occupations);
+  REQUIRE(engine.AddCommutator(a, b, 0.5, c));
+
+  const std::vector<MState> states = MakeMStates(sp);
+  const std::size_t n = states.size();
+  std::vector<double> occ(n);
+  for (std::size_t p = 0; p < n; p += 1) {
+    occ[p] = occupations[states[p].orbital.idx()];
+  }
+  const MOperator ma = MScheme(a, states);
+  const MOperator mb = MScheme(b, states);
+  const MCommutator expected(ma, mb, occ);
+  const MOperator actual = MScheme(c, states);
+  REQUIRE(
+      actual.zero_body ==
+      Catch::Approx(0.5 * expected.ZeroBody()).margin(1e-10));
+  double norm = 0.0;
+  for (std::size_t i = 0; i < n; i += 1) {
+    for (std::size_t j = 0; j < n; j += 1) {
+      const double x =
+          states[i].two_m == states[j].two_m ? expected.OneBody(i, j) : 0.0;
+      REQUIRE(
+          actual.one_body[i * n + j] == Catch::Approx(0.5 * x).margin(1e-10));
+      norm += x * x;
+    }
+  }
+  REQUIRE(norm > 1.0);
+  norm = 0.0;
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < n; i += 1) {
+    for (std::size_t j = 0; j < n; j += 1) {
+      for (std::size_t k = 0; k < n; k += 1) {
+        for (std::size_t l = 0; l < n; l += 1) {
+          if (states[i].two_m + states[j].two_m !=
+              states[k].two_m + states[l].two_m) {
+            continue;
+          }
+          count += 1;
+          if (count % 23 != 0) {
+            continue;
+          }
+          const double x = expected.TwoBody(i, j, k, l);
+          REQUIRE(
+              actual.two_body[((i * n + j) * n + k) * n + l] ==
+              Catch::Approx(0.5 * x).margin(1e-10));
+          norm += x * x;
+        }
+      }
+    }
+  }
+  REQUIRE(norm > 1.0);
+}
+
+}  // namespace
+
+TEST_CASE("CommutatorEngine, Test against m-scheme.") {
+  CheckCommutator(
+      Hermiticity::kAntihermitian,
+      Hermiticity::kHermitian,
+      Hermiticity::kHermitian,
+      true,
+      false);
+  CheckCommutator(
+      Hermiticity::kHermitian,
+      Hermiticity::kHermitian,
+      Hermiticity::kAntihermitian,
+      false,
+      false);
+  CheckCommutator(
+      Hermiticity::kNone,
+      Hermiticity::kAntihermitian,
+      Hermiticity::kNone,
+      true,
+      false);
+}
+
+TEST_CASE("CommutatorEngine, Test fractional occupations.") {
+  CheckCommutator(
+      Hermiticity::kAntihermitian,
+      Hermiticity::kHermitian,
+      Hermiticity::kHermitian,
+      true,
+      true);
+  CheckCommutator(
+      Hermiticity::kNone,
+      Hermiticity::kNone,
+      Hermiticity::kNone,
+      false,
+      true);
+}
+
+TEST_CASE("CommutatorEngine, Test statistics and reuse.") {
+  const auto ms =
+      MakeTwoBodyModelSpace(2, nui::Reference::HOEqualFilling(2, 2));
+  nui::Operator a(ms, Hermiticity::kAntihermitian);
+  nui::Operator b(ms, Hermiticity::kHermitian);
+  Fill(3.0, a);
+  Fill(4.0, b);
+  nui::CommutatorEngine engine(ms);
+  nui::Operator c(ms, Hermiticity::kHermitian);
+  nui::Operator d(ms, Hermiticity::kHermitian);
+  REQUIRE(engine.AddCommutator(a, b, 1.0, c));
+  const std::size_t load = engine.MemoryLoad();
+  REQUIRE(engine.AddCommutator(a, b, 1.0, d));
+  REQUIRE(engine.MemoryLoad() == load);
+  REQUIRE(d.ZeroBody() == c.ZeroBody());
+  for (const auto ch : ms->ChannelIndices()) {
+    for (std::size_t i = 0; i < c.TwoBody().ChannelSize(ch); i += 1) {
+      REQUIRE(d.TwoBody().Block(ch)[i] == c.TwoBody().Block(ch)[i]);
+    }
+  }
+
+  const nui::CommutatorStatistics& stats = engine.Statistics();
+  REQUIRE(stats.num_commutators == 2);
+  for (std::size_t t = 0; t < nui::kNumCommutatorTerms; t += 1) {
+    REQUIRE(stats.flops[t] > 0.0);
+    REQUIRE(stats.seconds[t] >= 0.0);
+  }
+  REQUIRE(nui::ToString(nui::CommutatorTerm::kParticleHole) == "[2,2] ph");
+  engine.ResetStatistics();
+  REQUIRE(engine.Statistics().num_commutators == 0);
+}
+
+TEST_CASE("CommutatorEngine, Test shared plans.") {
+  const auto ms =
+      MakeTwoBodyModelSpace(2, nui::Reference::HOEqualFilling(2, 2));
+  nui::Operator a(ms, Hermiticity::kAntihermitian);
+  nui::Operator b(ms, Hermiticity::kHermitian);
+  Fill(3.0, a);
+  Fill(4.0, b);
+  nui::CommutatorEngine engine(ms, ms->SP().Occupations(), {0.0});
+  nui::CommutatorEngine shared = engine.Share();
+  REQUIRE(shared.Options().screening_threshold == 0.0);
+  REQUIRE(shared.Occupations() == engine.Occupations());
+  REQUIRE(engine.PlanMemoryLoad() == 0);
+
+  // Plans built by one engine are used by the other.
+  nui::Operator c(ms, Hermiticity::kHermitian);
+  nui::Operator d(ms, Hermiticity::kHermitian);
+  REQUIRE(engine.AddCommutator(a, b, 1.0, c));
+  const std::size_t plans = engine.PlanMemoryLoad();
+  REQUIRE(plans > 0);
+  REQUIRE(shared.PlanMemoryLoad() == plans);
+  REQUIRE(shared.AddCommutator(a, b, 1.0, d));
+  REQUIRE(engine.PlanMemoryLoad() == plans);
+  REQUIRE(shared.Statistics().num_commutators == 1);
+  REQUIRE(d.ZeroBody() == Catch::Approx(c.ZeroBody()));
+  REQUIRE(nui::Axpy(-1.0, c, d));
+  REQUIRE(nui::Norm(d) < 1e-12);
+}
+
+TEST_CASE("CommutatorEngine, Test low-rank factors.") {
+  const auto ms =
+      MakeTwoBodyModelSpace(2, nui::Reference::HOEqualFilling(2, 2));
+  // Blocks of a are sin(c + 0.37 i + 0.23 j), of rank 2.
+  nui::Operator a(ms, Hermiticity::kNone);
+  nui::Operator b(ms, Hermiticity::kHermitian);
+  Fill(1.0, a);
+  Fill(2.0, b);
+  nui::LowRankOptions options;
+  options.tolerance = 1e-12;
+  options.max_rank_fraction = 0.5;
+  const nui::LowRankTwoBodyOperator factors(a.TwoBody(), options);
+  REQUIRE(factors.Statistics().factored_channels > 0);
+
+  nui::CommutatorEngine engine(ms);
+  nui::Operator expected(ms, Hermiticity::kNone);
+  nui::Operator actual(ms, Hermiticity::kNone);
+  REQUIRE(engine.AddCommutator(a, b, 0.5, expected));
+  REQUIRE(engine.Statistics().factored_blocks[2] == 0);
+  REQUIRE(engine.AddCommutator(a, factors, b, 0.5, actual));
+  REQUIRE(engine.Statistics().factored_blocks[2] > 0);
+  REQUIRE(
+      actual.ZeroBody() ==
+      Catch::Approx(expected.ZeroBody()).margin(1e-10));
+  REQUIRE(nui::Axpy(-1.0, expected, actual));
+  REQUIRE(nui::Norm(actual) < 1e-10);
+
+  nui::Operator c(ms, Hermiticity::kAntihermitian);
+  const nui::LowRankTwoBodyOperator other(c.TwoBody());
+  REQUIRE_FALSE(engine.AddCommutator(a, other, b, 0.5, actual));
+}
+
+TEST_CASE("CommutatorEngine, Test screening.") {
+  const auto ms =
+      MakeTwoBodyModelSpace(2, nui::Reference::HOEqualFilling(2, 2));
+  nui::Operator a(ms, Hermiticity::kAntihermitian);
+  nui::Operator b(ms, Hermiticity::kHermitian);
+  Fill(1.0, a);
+  Fill(2.0, b);
+  nui::CommutatorEngine engine(ms);
+  nui::Operator c(ms, Hermiticity::kHermitian);
+  REQUIRE(engine.AddCommutator(a, b, 0.5, c));
+  // Only vanishing blocks (e.g., antihermitian 1 x 1 blocks) are skipped.
+  for (std::size_t t = 1; t < nui::kNumCommutatorTerms; t += 1) {
+    REQUIRE(
+        engine.Statistics().skipped_blocks[t] <
+        engine.Statistics().num_blocks[t]);
+    REQUIRE(engine.Statistics().error_bound[t] == 0.0);
+  }
+
+  SECTION("zero blocks are skipped without error") {
+    // Zero every other channel of a.
+    for (const auto ch : ms->ChannelIndices()) {
+      if (ch.idx() % 2 == 0) {
+        double* block = a.TwoBody().MutableBlock(ch);
+        std::fill_n(block, a.TwoBody().ChannelSize(ch), 0.0);
+      }
+    }
+    nui::Operator expected(ms, Hermiticity::kHermitian);
+    nui::Operator actual(ms, Hermiticity::kHermitian);
+    engine.SetOptions({0.0});
+    engine.ResetStatistics();
+    REQUIRE(engine.AddCommutator(a, b, 0.5, expected));
+    REQUIRE(engine.Statistics().skipped_blocks[2] == 0);
+    engine.SetOptions({1e-300});
+    engine.ResetStatistics();
+    REQUIRE(engine.AddCommutator(a, b, 0.5, actual));
+    const nui::CommutatorStatistics& stats = engine.Statistics();
+    REQUIRE(stats.skipped_blocks[2] > 0);
+    REQUIRE(stats.skipped_flops[2] > 0.0);
+    for (std::size_t t = 0; t < nui::kNumCommutatorTerms; t += 1) {
+      REQUIRE(stats.error_bound[t] == 0.0);
+    }
+    REQUIRE(
+        actual.ZeroBody() ==
+        Catch::Approx(expected.ZeroBody()).margin(1e-12));
+    REQUIRE(nui::Axpy(-1.0, expected, actual));
+    REQUIRE(nui::Norm(actual.OneBody()) < 1e-12);
+    REQUIRE(nui::Norm(actual.TwoBody()) < 1e-12);
+  }
+
+  SECTION("skipped contributions are bounded") {
+    // All blocks of a small generator are skipped.
+    nui::Scale(1e-6, a);
+    nui::Operator expected(ms, Hermiticity::kHermitian);
+    nui::Operator actual(ms, Hermiticity::kHermitian);
+    engine.SetOptions({0.0});
+    REQUIRE(engine.AddCommutator(a, b, 0.5, expected));
+    engine.SetOptions({1.0});
+    engine.ResetStatistics();
+    REQUIRE(engine.AddCommutator(a, b, 0.5, actual));
+    const nui::CommutatorStatistics& stats = engine.Statistics();
+    double bound = 0.0;
+    for (std::size_t t = 1; t < nui::kNumCommutatorTerms; t += 1) {
+      REQUIRE(stats.skipped_blocks[t] == stats.num_blocks[t]);
+      REQUIRE(stats.flops[t] == 0.0);
+      REQUIRE(stats.error_bound[t] > 0.0);
+      bound += stats.error_bound[t];
+    }
+    REQUIRE(nui::Axpy(-1.0, expected, actual));
+    REQUIRE(nui::Norm(actual.TwoBody()) > 0.0);
+    REQUIRE(nui::Norm(actual.TwoBody()) <= bound);
+  }
+}
+
+TEST_CASE("CommutatorEngine, Test batches.") {
+  const auto ms =
+      MakeTwoBodyModelSpace(2, nui::Reference::HOEqualFilling(2, 2));
+  // Operators of mixed hermiticity and layout, one of them zero (all its
+  // blocks are skipped).
+  std::vector<nui::Operator> bs;
+  bs.emplace_back(ms, Hermiticity::kHermitian);
+  bs.emplace_back(ms, Hermiticity::kAntihermitian);
+  bs.emplace_back(ms, Hermiticity::kNone);
+  bs.emplace_back(ms, Hermiticity::kHermitian, false);
+  bs.emplace_back(ms, Hermiticity::kHermitian);
+  for (std::size_t k = 0; k + 1 < bs.size(); k += 1) {
+    Fill(2.0 + k, bs[k]);
+  }
+  std::vector<const nui::Operator*> inputs;
+  for (const auto& b : bs) {
+    inputs.push_back(&b);
+  }
+
+  for (const Hermiticity h :
+       {Hermiticity::kAntihermitian, Hermiticity::kNone}) {
+    nui::Operator a(ms, h);
+    Fill(1.0, a);
+    nui::CommutatorEngine single(ms);
+    nui::CommutatorEngine batch(ms);
+    std::vector<nui::Operator> expected;
+    std::vector<nui::Operator> actual;
+    std::vector<nui::Operator*> outs;
+    for (const auto& b : bs) {
+      expected.emplace_back(ms, Hermiticity::kNone);
+      actual.emplace_back(ms, Hermiticity::kNone);
+      REQUIRE(single.AddCommutator(a, b, 0.5, expected.back()));
+    }
+    for (auto& out : actual) {
+      outs.push_back(&out);
+    }
+    REQUIRE(batch.AddCommutators(a, inputs, 0.5, outs));
+    REQUIRE(batch.Statistics().num_commutators == bs.size());
+    for (std::size_t k = 0; k < bs.size(); k += 1) {
+      REQUIRE(
+          actual[k].ZeroBody() ==
+          Catch::Approx(expected[k].ZeroBody()).margin(1e-12));
+      REQUIRE(nui::Axpy(-1.0, expected[k], actual[k]));
+      REQUIRE(nui::Norm(actual[k]) < 1e-12);
+    }
+    REQUIRE(nui::Norm(expected.back()) == 0.0);
+  }
+
+  nui::CommutatorEngine engine(ms);
+  nui::Operator a(ms, Hermiticity::kAntihermitian);
+  nui::Operator c(ms, Hermiticity::kHermitian);
+  nui::Operator anti(ms, Hermiticity::kAntihermitian);
+  REQUIRE(engine.AddCommutators(a, {}, 1.0, {}));
+  REQUIRE_FALSE(engine.AddCommutators(a, {&bs[0]}, 1.0, {}));
+  REQUIRE_FALSE(engine.AddCommutators(a, {&bs[0], &bs[0]}, 1.0, {&c, &anti}));
+  REQUIRE(engine.Statistics().num_commutators == 0);
+}
+
+TEST_CASE("CommutatorEngine, Test argument checks.") {
+  const auto ms =
+      MakeTwoBodyModelSpace(2, nui::Reference::HOEqualFilling(2, 2));
+  nui::Operator a(ms, Hermiticity::kAntihermitian);
+  nui::Operator b(ms, Hermiticity::kHermitian);
+  nui::Operator anti(ms, Hermiticity::kAntihermitian);
+  nui::Operator other(
+      nui::TwoBodyModelSpace::Make(ms->SPShared(), nui::TwoBodyTruncation{1}),
+      Hermiticity::kHermitian);
+  nui::CommutatorEngine engine(ms);
+  REQUIRE_FALSE(engine.AddCommutator(a, b, 1.0, anti));
+  REQUIRE_FALSE(engine.AddCommutator(a, b, 1.0, other));
+  REQUIRE_FALSE(engine.AddCommutator(a, other, 1.0, b));
+  nui::CommutatorEngine wrong(ms, {1.0});
+  nui::Operator c(ms, Hermiticity::kHermitian);
+  REQUIRE_FALSE(wrong.AddCommutator(a, b, 1.0, c));
+  REQUIRE(engine.AddCommutator(a, b, 1.0, c));
+}
@@ -0,0 +1,213 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/actions/full/ensemble.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "nui/core/basics/basics.h"
+#include "nui/info/profiling/profiling.h"
+#include "nui/info/runtime/runtime.h"
+#include "nui/physics/operators/actions/full/commutator.h"
+#include "nui/physics/operators/actions/full/magnus.h"
+#include "nui/physics/operators/storage/full/op_full.h"
+
+namespace nui {
+
+namespace {
+
+// Joins threads when leaving scope, also during unwinding.
+class JoinGuard {
+ public:
+  explicit JoinGuard(std::vector<std::thread>& threads) : threads_(threads) {}
+
+  JoinGuard(const JoinGuard&) = delete;
+  JoinGuard& operator=(const JoinGuard&) = delete;
+
+  ~JoinGuard() {
+    for (auto& thread : threads_) {
+      if (thread.joinable()) {
+        thread.join();
+      }
+    }
+  }
+
+ private:
+  std::vector<std::thread>& threads_;
+};
+
+// Load member, nullptr if the loader fails or throws.
+std::unique_ptr<Operator> Load(
+    const EnsembleLoader& loader,
+    std::size_t member) {
+  try {
+    return loader(member);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+}  // namespace
+
+MagnusEnsemble::MagnusEnsemble(
+    CommutatorEngine engine,
+    MagnusOptions options,
+    EnsembleOptions ensemble_options)
+    : engine_(std::move(engine)),
+      options_(options),
+      ensemble_options_(ensemble_options) {}
+
+EnsembleSchedule MagnusEnsemble::Schedule(
+    std::size_t num_members,
+    std::size_t operator_memory) const {
+  EnsembleSchedule schedule;
+  schedule.flow_memory = kEnsembleFlowOperators * operator_memory;
+  const std::size_t num_threads =
+      ensemble_options_.num_threads > 0
+          ? ensemble_options_.num_threads
+          : static_cast<std::size_t>(NumParallelThreads());
+  std::size_t concurrency = std::max<std::size_t>(
+      num_threads / std::max<std::size_t>(
+                        ensemble_options_.min_threads_per_flow,
+                        1),
+      1);
+  concurrency = std::min(concurrency, std::max<std::size_t>(num_members, 1));
+  if (ensemble_options_.max_concurrency > 0) {
+    concurrency = std::min(concurrency, ensemble_options_.max_concurrency);
+  }
+  if (ensemble_options_.memory_budget > 0 && schedule.flow_memory > 0) {
+    concurrency = std::min(
+        concurrency,
+        std::max<std::size_t>(
+            ensemble_options_.memory_budget / schedule.flow_memory,
+            1));
+  }
+  // Spread threads evenly, the remainder over the first workers.
+  schedule.threads.assign(concurrency, num_threads / concurrency);
+  for (std::size_t w = 0; w < num_threads % concurrency; w += 1) {
+    schedule.threads[w] += 1;
+  }
+  for (auto& threads : schedule.threads) {
+    threads = std::max<std::size_t>(threads, 1);
+  }
+  return schedule;
+}
+
+bool MagnusEnsemble::Run(
+    std::size_t num_members,
+    const EnsembleLoader& loader,
+    const MagnusGenerator& generator,
+    const EnsembleCallback& callback) {
+  results_.assign(num_members, EnsembleResult());
+  schedule_ = {};
+  seconds_ = 0.0;
+  const auto start = std::chrono::steady_clock::now();
+
+  // Members are claimed in order. The calling thread loads them until one
+  // succeeds, whose storage sizes the flows, and then is worker 0.
+  std::atomic<std::size_t> next(0);
+  std::size_t first = next.fetch_add(1);
+  std::unique_ptr<Operator> first_h;
+  for (; first < num_members; first = next.fetch_add(1)) {
+    first_h = Load(loader, first);
+    if (first_h != nullptr) {
+      break;
+    }
+  }
+  if (first_h == nullptr) {
+    seconds_ = SecondsSince(start);
+    return num_members == 0;
+  }
+  schedule_ = Schedule(num_members - first, first_h->MemoryLoad());
+
+  // Evolve member i, then release its Hamiltonian.
+  const auto evolve = [&](std::size_t worker,
+                          MagnusSolver& solver,
+                          std::size_t i,
+                          std::unique_ptr<Operator> h) {
+    NUI_PROFILE_REGION("ensemble member");
+    EnsembleResult& result = results_[i];
+    result.worker = worker;
+    if (h == nullptr) {
+      return;
+    }
+    const auto member_start = std::chrono::steady_clock::now();
+    const std::size_t commutators =
+        solver.Engine().Statistics().num_commutators;
+    try {
+      result.ok = solver.Run(*h, generator) &&
+                  (!callback || callback(i, solver, *h));
+    } catch (...) {
+      result.ok = false;
+    }
+    result.seconds = SecondsSince(member_start);
+    result.s = solver.S();
+    result.energy = h->ZeroBody();
+    result.steps = solver.Steps().size();
+    result.segments = solver.Omegas().size();
+    result.commutators =
+        solver.Engine().Statistics().num_commutators - commutators;
+  };
+  const auto work = [&](std::size_t worker, std::unique_ptr<Operator> h) {
+    try {
+      const ScopedThreadLimit limit(schedule_.threads[worker]);
+      MagnusSolver solver(engine_.Share(), options_);
+      if (h != nullptr) {
+        evolve(worker, solver, first, std::move(h));
+      }
+      for (std::size_t i = next.fetch_add(1); i < num_members;
+           i = next.fetch_add(1)) {
+        evolve(worker, solver, i, Load(loader, i));
+      }
+    } catch (...) {
+      // Members claimed by a worker that fails outside a flow stay failed.
+    }
+  };
+
+  std::vector<std::thread> workers;
+  {
+    const JoinGuard join(workers);
+    for (std::size_t w = 1; w < schedule_.threads.size(); w += 1) {
+      try {
+        workers.emplace_back(work, w, nullptr);
+      } catch (const std::system_error&) {
+        // The running workers take the members of the missing ones.
+        break;
+      }
+    }
+    work(0, std::move(first_h));
+  }
+  seconds_ = SecondsSince(start);
+  return std::all_of(
+      results_.begin(),
+      results_.end(),
+      [](const EnsembleResult& result) { return result.ok; });
+}
+
+}  // namespace nui
@@ -0,0 +1,168 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_OPERATORS_ACTIONS_FULL_ENSEMBLE_H_
+#define NUI_PHYSICS_OPERATORS_ACTIONS_FULL_ENSEMBLE_H_
+
+// IWYU pragma: private, include "nui/physics/operators/actions/full/op_actions_full.h"
+// IWYU pragma: friend "nui/physics/operators/actions/full/.*\.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/operators/actions/full/commutator.h"
+#include "nui/physics/operators/actions/full/magnus.h"
+#include "nui/physics/operators/storage/full/op_full.h"
+
+// Ensembles of Magnus flows of Hamiltonians in one model space, e.g.,
+// samples of low-energy constants for uncertainty quantification.
+//
+// The model space, its channels, and the Pandya plans are built once and
+// shared by all flows (see CommutatorEngine::Share). Flows run on worker
+// threads, each with its own engine scratch and solver, and parallel
+// regions sized by a per-thread ScopedThreadLimit. Workers load the next
+// Hamiltonian once their flow is done and release it after its callback,
+// so only one Hamiltonian per worker is held at a time. Commutators in
+// small model spaces do not scale to all cores of a node, so several
+// concurrent flows with a few threads each finish more Hamiltonians per
+// hour than one flow with all threads.
+//
+// The number of concurrent flows is limited by the threads, the memory
+// budget, and the number of Hamiltonians. Each flow needs about
+// kEnsembleFlowOperators operators of the size of a Hamiltonian (H, the
+// start of the current segment, Omega, eta, two scratch operators of the
+// series being evaluated, and engine scratch); shared plans are not
+// included.
+
+namespace nui {
+
+// Estimated number of operators of memory per flow.
+inline constexpr std::size_t kEnsembleFlowOperators = 9;
+
+// Options of ensembles.
+struct EnsembleOptions {
+  // Total number of threads (0 for omp_get_max_threads()).
+  std::size_t num_threads = 0;
+  // Memory budget of all flows in bytes (0 for no limit).
+  std::size_t memory_budget = 0;
+  // Maximum number of concurrent flows (0 for no limit, 1 runs the flows
+  // in sequence with all threads).
+  std::size_t max_concurrency = 0;
+  // Minimum number of threads per flow.
+  std::size_t min_threads_per_flow = 1;
+};
+
+// Assignment of threads to concurrent flows.
+struct EnsembleSchedule {
+  // Threads by worker (one worker per concurrent flow).
+  std::vector<std::size_t> threads;
+  // Estimated memory per flow in bytes.
+  std::size_t flow_memory = 0;
+};
+
+// Result of the flow of one Hamiltonian.
+struct EnsembleResult {
+  // Whether the load, the flow, and the callback succeeded.
+  bool ok = false;
+  // Worker that ran the flow and wall time in seconds.
+  std::size_t worker = 0;
+  double seconds = 0.0;
+  // Flow parameter and 0-body part of H(s) at the end.
+  double s = 0.0;
+  double energy = 0.0;
+  // Number of steps, segments, and commutators.
+  std::size_t steps = 0;
+  std::size_t segments = 0;
+  std::size_t commutators = 0;
+};
+
+// Loader of Hamiltonian member, e.g., from a file or by sampling couplings.
+// Runs on the worker thread that evolves the member; nullptr marks the
+// member as failed.
+using EnsembleLoader =
+    std::function<std::unique_ptr<Operator>(std::size_t member)>;
+
+// Callback after the flow of Hamiltonian member with the solver (holding
+// the Omegas) and H(s), e.g., to transform observables. Runs on the worker
+// thread before H(s) is released; false marks the member as failed.
+using EnsembleCallback =
+    std::function<bool(std::size_t member, MagnusSolver& solver, Operator& h)>;
+
+// Runner of Magnus flows of many Hamiltonians.
+class MagnusEnsemble {
+ public:
+  // Build ensemble with engine, whose plans are shared by all flows.
+  explicit MagnusEnsemble(
+      CommutatorEngine engine,
+      MagnusOptions options = {},
+      EnsembleOptions ensemble_options = {});
+
+  // Get engine whose plans the flows share.
+  CommutatorEngine& Engine() { return engine_; }
+
+  // Get options of flows.
+  const MagnusOptions& Options() const { return options_; }
+
+  // Get options of the ensemble.
+  const EnsembleOptions& Ensemble() const { return ensemble_options_; }
+
+  // Get schedule of num_members Hamiltonians of operator_memory bytes.
+  EnsembleSchedule Schedule(
+      std::size_t num_members,
+      std::size_t operator_memory) const;
+
+  // Load and evolve num_members Hamiltonians to H(s) with generator.
+  //
+  // loader, generator, and callback are called concurrently from all
+  // workers. The first Hamiltonian that loads sizes the schedule. Returns
+  // true if all loads, flows, and callbacks succeed. Results() has the
+  // outcome of each member; a member whose loader, flow, or callback fails
+  // (or throws) is marked as failed and the workers continue.
+  bool Run(
+      std::size_t num_members,
+      const EnsembleLoader& loader,
+      const MagnusGenerator& generator,
+      const EnsembleCallback& callback = {});
+
+  // Get results of the last run by member.
+  const std::vector<EnsembleResult>& Results() const { return results_; }
+
+  // Get schedule of the last run.
+  const EnsembleSchedule& LastSchedule() const { return schedule_; }
+
+  // Get wall time of the last run in seconds.
+  double Seconds() const { return seconds_; }
+
+ private:
+  CommutatorEngine engine_;
+  MagnusOptions options_;
+  EnsembleOptions ensemble_options_;
+  std::vector<EnsembleResult> results_;
+  EnsembleSchedule schedule_;
+  double seconds_ = 0.0;
+};
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_OPERATORS_ACTIONS_FULL_ENSEMBLE_H_
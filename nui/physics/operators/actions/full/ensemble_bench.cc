@@ -0,0 +1,108 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "fmt/core.h"
+#include "nui/core/basics/basics.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/actions/full/op_actions_full.h"
+#include "nui/physics/operators/storage/full/op_full.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+#include "nui/physics/operators/storage/testing/op_testing.h"
+
+// Benchmark of ensembles of Magnus flows.
+//
+// Usage: nui_..._ensemble_bench [emax] [members] [threads per flow]
+//                                [s_max]
+//
+// The Hamiltonians have shell energies of about 10 e and 2-body elements
+// whose size varies by member. The ensemble runs once with all threads per
+// flow (one flow at a time) and once with the given threads per flow. The
+// table shows the schedule, wall time, and Hamiltonians per hour of both
+// runs.
+
+int main(int argc, char** argv) {
+  const int emax = argc > 1 ? std::atoi(argv[1]) : 3;
+  const int members = argc > 2 ? std::atoi(argv[2]) : 8;
+  const int threads_per_flow = argc > 3 ? std::atoi(argv[3]) : 1;
+  nui::MagnusOptions options;
+  options.s_max = argc > 4 ? std::atof(argv[4]) : 5.0;
+
+  const auto sp = nui::SPModelSpace::Make(
+      nui::SPTruncation(emax),
+      nui::Reference::HOEqualFilling(8, 8));
+  const auto ms = nui::TwoBodyModelSpace::Make(sp);
+  const nui::EnsembleLoader loader = [&ms](std::size_t member) {
+    return std::make_unique<nui::Operator>(
+        nui::testing::MakeHamiltonian(ms, 0.0, 0.5 + 0.05 * member));
+  };
+  fmt::print(
+      "emax = {}, members = {}, s_max = {}, orbitals = {}\n",
+      emax,
+      members,
+      options.s_max,
+      sp->NumOrbitals());
+  fmt::print(
+      "{:<12} {:>8} {:>8} {:>10} {:>12} {:>14}\n",
+      "run",
+      "flows",
+      "threads",
+      "seconds",
+      "per hour",
+      "flow MB");
+
+  const std::vector<double>& n = sp->Occupations();
+  const auto generator = [&n](const nui::Operator& h, nui::Operator& eta) {
+    return nui::WhiteGenerator(h, n, eta);
+  };
+  for (const bool sequential : {true, false}) {
+    nui::EnsembleOptions ensemble_options;
+    if (sequential) {
+      ensemble_options.max_concurrency = 1;
+    } else {
+      ensemble_options.min_threads_per_flow =
+          static_cast<std::size_t>(threads_per_flow);
+    }
+    nui::MagnusEnsemble ensemble(
+        nui::CommutatorEngine(ms),
+        options,
+        ensemble_options);
+    if (!ensemble.Run(static_cast<std::size_t>(members), loader, generator)) {
+      fmt::print("flow failed\n");
+      return 1;
+    }
+    const nui::EnsembleSchedule& schedule = ensemble.LastSchedule();
+    fmt::print(
+        "{:<12} {:>8} {:>8} {:>10.3f} {:>12.1f} {:>14.1f}\n",
+        sequential ? "sequential" : "concurrent",
+        schedule.threads.size(),
+        schedule.threads.front(),
+        ensemble.Seconds(),
+        members * 3600.0 / ensemble.Seconds(),
+        schedule.flow_memory * 1e-6);
+  }
+  return 0;
+}
@@ -0,0 +1,243 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/actions/full/ensemble.h"
+
+#include <omp.h>
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "catch2/catch_approx.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "nui/core/basics/basics.h"
+#include "nui/info/runtime/runtime.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/actions/full/commutator.h"
+#include "nui/physics/operators/actions/full/generator.h"
+#include "nui/physics/operators/actions/full/magnus.h"
+#include "nui/physics/operators/storage/full/op_full.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+#include "nui/physics/operators/storage/testing/op_testing.h"
+
+// Ensembles of flows in a small model space (emax = 2, 4He reference) must
+// reproduce flows of the same Hamiltonians run one by one.
+
+namespace {
+
+using nui::Hermiticity;
+using nui::testing::MakeHamiltonian;
+using nui::testing::MakeTwoBodyModelSpace;
+
+nui::MagnusGenerator White(const std::vector<double>& occupations) {
+  return [&occupations](const nui::Operator& h, nui::Operator& eta) {
+    return nui::WhiteGenerator(h, occupations, eta);
+  };
+}
+
+double Strength(std::size_t member) { return 0.1 + 0.05 * member; }
+
+nui::EnsembleLoader Loader(
+    const std::shared_ptr<const nui::TwoBodyModelSpace>& ms) {
+  return [ms](std::size_t member) {
+    return std::make_unique<nui::Operator>(
+        MakeHamiltonian(ms, 0.0, Strength(member)));
+  };
+}
+
+}  // namespace
+
+TEST_CASE("MagnusEnsemble, Test against single flows.") {
+  const auto ms =
+      MakeTwoBodyModelSpace(2, nui::Reference::HOEqualFilling(2, 2));
+  const std::vector<double>& n = ms->SP().Occupations();
+  nui::MagnusOptions options;
+  options.s_max = 2.0;
+  const std::size_t num_members = 5;
+  std::vector<double> expected;
+  for (std::size_t i = 0; i < num_members; i += 1) {
+    nui::MagnusSolver solver(nui::CommutatorEngine(ms), options);
+    nui::Operator h = MakeHamiltonian(ms, 0.0, Strength(i));
+    REQUIRE(solver.Run(h, White(n)));
+    expected.push_back(h.ZeroBody());
+  }
+
+  for (const std::size_t max_concurrency : {1, 0}) {
+    nui::EnsembleOptions ensemble_options;
+    ensemble_options.num_threads = 4;
+    ensemble_options.max_concurrency = max_concurrency;
+    nui::MagnusEnsemble ensemble(
+        nui::CommutatorEngine(ms),
+        options,
+        ensemble_options);
+    std::vector<double> energies(num_members, 0.0);
+    std::atomic<std::size_t> calls(0);
+    REQUIRE(ensemble.Run(
+        num_members,
+        Loader(ms),
+        White(n),
+        [&](std::size_t i, nui::MagnusSolver& solver, nui::Operator& h) {
+          calls += 1;
+          energies[i] = h.ZeroBody();
+          return !solver.Omegas().empty();
+        }));
+    REQUIRE(calls == num_members);
+    const nui::EnsembleSchedule& schedule = ensemble.LastSchedule();
+    REQUIRE(schedule.threads.size() == (max_concurrency == 1 ? 1 : 4));
+    for (std::size_t i = 0; i < num_members; i += 1) {
+      const nui::EnsembleResult& result = ensemble.Results()[i];
+      REQUIRE(result.ok);
+      REQUIRE(result.worker < schedule.threads.size());
+      REQUIRE(result.s == Catch::Approx(options.s_max));
+      REQUIRE(result.commutators > 0);
+      REQUIRE(result.energy == energies[i]);
+      REQUIRE(result.energy == Catch::Approx(expected[i]).epsilon(1e-10));
+    }
+    // The plans are built once, by the shared engines.
+    REQUIRE(ensemble.Engine().PlanMemoryLoad() > 0);
+  }
+}
+
+TEST_CASE("MagnusEnsemble, Test schedule.") {
+  const auto ms =
+      MakeTwoBodyModelSpace(2, nui::Reference::HOEqualFilling(2, 2));
+  const nui::Operator h = MakeHamiltonian(ms, 0.0, 0.1);
+  const std::size_t flow = nui::kEnsembleFlowOperators * h.MemoryLoad();
+  nui::EnsembleOptions options;
+  options.num_threads = 10;
+  options.min_threads_per_flow = 3;
+
+  nui::MagnusEnsemble ensemble(nui::CommutatorEngine(ms), {}, options);
+  nui::EnsembleSchedule schedule = ensemble.Schedule(100, h.MemoryLoad());
+  REQUIRE(schedule.flow_memory == flow);
+  REQUIRE(schedule.threads == std::vector<std::size_t>{4, 3, 3});
+  // Not more workers than Hamiltonians.
+  REQUIRE(
+      ensemble.Schedule(2, h.MemoryLoad()).threads ==
+      std::vector<std::size_t>{5, 5});
+
+  // Memory for two flows.
+  options.memory_budget = 2 * flow + 1;
+  nui::MagnusEnsemble limited(nui::CommutatorEngine(ms), {}, options);
+  REQUIRE(
+      limited.Schedule(100, h.MemoryLoad()).threads ==
+      std::vector<std::size_t>{5, 5});
+  // At least one flow runs with too little memory.
+  options.memory_budget = 1;
+  nui::MagnusEnsemble tiny(nui::CommutatorEngine(ms), {}, options);
+  REQUIRE(
+      tiny.Schedule(100, h.MemoryLoad()).threads ==
+      std::vector<std::size_t>{10});
+
+  REQUIRE(ensemble.Run(0, Loader(ms), White(ms->SP().Occupations())));
+  REQUIRE(ensemble.Results().empty());
+}
+
+TEST_CASE("MagnusEnsemble, Test threads of workers.") {
+  const auto ms =
+      MakeTwoBodyModelSpace(2, nui::Reference::HOEqualFilling(2, 2));
+  const std::vector<double>& n = ms->SP().Occupations();
+  nui::MagnusOptions options;
+  options.s_max = 0.5;
+  nui::EnsembleOptions ensemble_options;
+  ensemble_options.num_threads = 5;
+  ensemble_options.min_threads_per_flow = 2;
+  nui::MagnusEnsemble ensemble(
+      nui::CommutatorEngine(ms),
+      options,
+      ensemble_options);
+
+  // Parallel regions started in a worker have its share of the threads.
+  const std::size_t num_members = 4;
+  std::vector<int> limits(num_members, 0);
+  std::vector<int> teams(num_members, 0);
+  const nui::EnsembleCallback callback =
+      [&](std::size_t i, nui::MagnusSolver&, nui::Operator&) {
+        limits[i] = nui::NumParallelThreads();
+#pragma omp parallel num_threads(nui::NumParallelThreads())
+        {
+#pragma omp single
+          teams[i] = omp_get_num_threads();
+        }
+        return true;
+      };
+  REQUIRE(ensemble.Run(num_members, Loader(ms), White(n), callback));
+  const nui::EnsembleSchedule& schedule = ensemble.LastSchedule();
+  REQUIRE(schedule.threads == std::vector<std::size_t>{3, 2});
+  for (std::size_t i = 0; i < num_members; i += 1) {
+    const auto threads =
+        static_cast<int>(schedule.threads[ensemble.Results()[i].worker]);
+    REQUIRE(limits[i] == threads);
+    REQUIRE(teams[i] == threads);
+  }
+}
+
+TEST_CASE("MagnusEnsemble, Test failed members.") {
+  const auto ms =
+      MakeTwoBodyModelSpace(2, nui::Reference::HOEqualFilling(2, 2));
+  const std::vector<double>& n = ms->SP().Occupations();
+  nui::MagnusOptions options;
+  options.s_max = 0.5;
+  nui::EnsembleOptions ensemble_options;
+  ensemble_options.num_threads = 3;
+  nui::MagnusEnsemble ensemble(
+      nui::CommutatorEngine(ms),
+      options,
+      ensemble_options);
+
+  // Member 0 does not load, 1 throws while loading, 3 throws in the
+  // callback, and 4 fails in the callback.
+  const nui::EnsembleLoader loader =
+      [&ms](std::size_t member) -> std::unique_ptr<nui::Operator> {
+    if (member == 0) {
+      return nullptr;
+    }
+    if (member == 1) {
+      throw std::runtime_error("load");
+    }
+    return std::make_unique<nui::Operator>(
+        MakeHamiltonian(ms, 0.0, Strength(member)));
+  };
+  const nui::EnsembleCallback callback =
+      [](std::size_t member, nui::MagnusSolver&, nui::Operator&) {
+        if (member == 3) {
+          throw std::runtime_error("callback");
+        }
+        return member != 4;
+      };
+  REQUIRE_FALSE(ensemble.Run(6, loader, White(n), callback));
+  const std::vector<bool> ok = {false, false, true, false, false, true};
+  for (std::size_t i = 0; i < ok.size(); i += 1) {
+    REQUIRE(ensemble.Results()[i].ok == ok[i]);
+  }
+  REQUIRE(ensemble.Results()[2].s == Catch::Approx(options.s_max));
+
+  // Nothing loads.
+  REQUIRE_FALSE(ensemble.Run(
+      2,
+      [](std::size_t) { return std::unique_ptr<nui::Operator>(); },
+      White(n)));
+  REQUIRE(ensemble.LastSchedule().threads.empty());
+}
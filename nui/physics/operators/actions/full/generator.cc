@@ -0,0 +1,94 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/actions/full/generator.h"
+
+#include <vector>
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/storage/full/op_full.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+
+namespace nui {
+
+bool WhiteGenerator(
+    const Operator& h,
+    const std::vector<double>& occupations,
+    Operator& eta) {
+  const TwoBodyModelSpace& ms = h.TwoBody().ModelSpace();
+  const SPModelSpace& sp = ms.SP();
+  if (eta.Symmetry() != Hermiticity::kAntihermitian ||
+      &eta.TwoBody().ModelSpace() != &ms ||
+      occupations.size() != sp.NumOrbitals()) {
+    return false;
+  }
+  const auto particle = [&occupations](OrbitalIndex a) {
+    return occupations[a.idx()] == 0.0;
+  };
+  const auto hole = [&occupations](OrbitalIndex a) {
+    return occupations[a.idx()] == 1.0;
+  };
+  const OneBodyOperator& f = h.OneBody();
+
+  Scale(0.0, eta);
+  for (const auto a : sp.OrbitalIndices()) {
+    if (!particle(a)) {
+      continue;
+    }
+    for (const auto i : sp.PartialWaveOrbitals(sp.PartialWaveOf(a))) {
+      const double denominator = f.Get(a, a) - f.Get(i, i);
+      if (hole(i) && denominator != 0.0) {
+        eta.OneBody().Set(a, i, f.Get(a, i) / denominator);
+      }
+    }
+  }
+
+  TwoBodyOperator& eta2 = eta.TwoBody();
+  eta2.PrepareWrites();
+  for (const auto ch : ms.ChannelIndices()) {
+    const TwoBodyChannel& channel = ms.Channel(ch);
+    for (const auto ab : channel.StateIndices()) {
+      const OrbitalIndex a = channel.First(ab);
+      const OrbitalIndex b = channel.Second(ab);
+      if (!particle(a) || !particle(b)) {
+        continue;
+      }
+      for (const auto ij : channel.StateIndices()) {
+        const OrbitalIndex i = channel.First(ij);
+        const OrbitalIndex j = channel.Second(ij);
+        if (!hole(i) || !hole(j)) {
+          continue;
+        }
+        const double denominator =
+            f.Get(a, a) + f.Get(b, b) - f.Get(i, i) - f.Get(j, j);
+        if (denominator != 0.0) {
+          eta2.Set(ch, ab, ij, h.TwoBody().Get(ch, ab, ij) / denominator);
+        }
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace nui
@@ -0,0 +1,56 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_OPERATORS_ACTIONS_FULL_GENERATOR_H_
+#define NUI_PHYSICS_OPERATORS_ACTIONS_FULL_GENERATOR_H_
+
+// IWYU pragma: private, include "nui/physics/operators/actions/full/op_actions_full.h"
+// IWYU pragma: friend "nui/physics/operators/actions/full/.*\.h"
+
+#include <vector>
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/operators/storage/full/op_full.h"
+
+namespace nui {
+
+// Set eta to the White generator of h with Moller-Plesset denominators,
+//
+//   eta_ai   = f_ai / (f_aa - f_ii),
+//   eta_abij = Gamma_abij / (f_aa + f_bb - f_ii - f_jj),
+//
+// for particles a, b (n = 0) and holes i, j (n = 1), with eta_ia = -eta_ai
+// and eta_ijab = -eta_abij. All other elements of eta are set to zero, as
+// are elements with vanishing denominators. Orbitals with fractional
+// occupations are neither particles nor holes.
+//
+// Returns false (and does nothing) if eta is not antihermitian, h and eta
+// have different 2-body model spaces, or occupations does not have one
+// entry per orbital.
+bool WhiteGenerator(
+    const Operator& h,
+    const std::vector<double>& occupations,
+    Operator& eta);
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_OPERATORS_ACTIONS_FULL_GENERATOR_H_
@@ -0,0 +1,109 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/actions/full/generator.h"
+
+#include <vector>
+
+#include "catch2/catch_approx.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "nui/core/basics/basics.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/storage/full/op_full.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+#include "nui/physics/operators/storage/testing/op_testing.h"
+
+namespace {
+
+using nui::Hermiticity;
+using nui::testing::MakeHamiltonian;
+using nui::testing::MakeTwoBodyModelSpace;
+
+}  // namespace
+
+TEST_CASE("WhiteGenerator, Test elements.") {
+  const auto ms =
+      MakeTwoBodyModelSpace(2, nui::Reference::HOEqualFilling(2, 2));
+  const nui::SPModelSpace& sp = ms->SP();
+  const std::vector<double>& n = sp.Occupations();
+  const nui::Operator h = MakeHamiltonian(ms, 1.0, 1.0);
+  nui::Operator eta(ms, Hermiticity::kAntihermitian);
+  REQUIRE(nui::WhiteGenerator(h, n, eta));
+  REQUIRE(eta.ZeroBody() == 0.0);
+
+  const nui::OneBodyOperator& f = h.OneBody();
+  std::size_t count = 0;
+  for (const auto a : sp.OrbitalIndices()) {
+    for (const auto b : sp.PartialWaveOrbitals(sp.PartialWaveOf(a))) {
+      if (n[a.idx()] == 0.0 && n[b.idx()] == 1.0) {
+        const double expected = f.Get(a, b) / (f.Get(a, a) - f.Get(b, b));
+        REQUIRE(eta.OneBody().Get(a, b) == Catch::Approx(expected));
+        REQUIRE(eta.OneBody().Get(b, a) == Catch::Approx(-expected));
+        count += 1;
+      } else if (!(n[a.idx()] == 1.0 && n[b.idx()] == 0.0)) {
+        REQUIRE(eta.OneBody().Get(a, b) == 0.0);
+      }
+    }
+  }
+  REQUIRE(count > 0);
+
+  count = 0;
+  for (const auto ch : ms->ChannelIndices()) {
+    const nui::TwoBodyChannel& channel = ms->Channel(ch);
+    for (const auto i : channel.StateIndices()) {
+      const auto a = channel.First(i);
+      const auto b = channel.Second(i);
+      const double ni = n[a.idx()] + n[b.idx()];
+      for (const auto j : channel.StateIndices()) {
+        const auto c = channel.First(j);
+        const auto d = channel.Second(j);
+        const double nj = n[c.idx()] + n[d.idx()];
+        const double value = eta.TwoBody().Get(ch, i, j);
+        if (ni == 0.0 && nj == 2.0) {
+          const double denominator =
+              f.Get(a, a) + f.Get(b, b) - f.Get(c, c) - f.Get(d, d);
+          REQUIRE(
+              value ==
+              Catch::Approx(h.TwoBody().Get(ch, i, j) / denominator));
+          REQUIRE(eta.TwoBody().Get(ch, j, i) == Catch::Approx(-value));
+          count += 1;
+        } else if (!(ni == 2.0 && nj == 0.0)) {
+          REQUIRE(value == 0.0);
+        }
+      }
+    }
+  }
+  REQUIRE(count > 0);
+}
+
+TEST_CASE("WhiteGenerator, Test argument checks.") {
+  const auto ms =
+      MakeTwoBodyModelSpace(2, nui::Reference::HOEqualFilling(2, 2));
+  nui::Operator h(ms, Hermiticity::kHermitian);
+  nui::Operator hermitian(ms, Hermiticity::kHermitian);
+  nui::Operator eta(ms, Hermiticity::kAntihermitian);
+  REQUIRE_FALSE(
+      nui::WhiteGenerator(h, ms->SP().Occupations(), hermitian));
+  REQUIRE_FALSE(nui::WhiteGenerator(h, {1.0}, eta));
+  REQUIRE(nui::WhiteGenerator(h, ms->SP().Occupations(), eta));
+}
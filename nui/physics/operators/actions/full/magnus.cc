@@ -0,0 +1,319 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/actions/full/magnus.h"
+
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <vector>
+
+#include "nui/core/basics/basics.h"
+#include "nui/info/profiling/profiling.h"
+#include "nui/physics/operators/actions/full/commutator.h"
+#include "nui/physics/operators/storage/full/op_full.h"
+
+namespace nui {
+
+namespace {
+
+// Bernoulli numbers B_0 to B_20 (B_1 = -1/2).
+constexpr std::array<double, 21> kBernoulli = {
+    1.0,
+    -1.0 / 2.0,
+    1.0 / 6.0,
+    0.0,
+    -1.0 / 30.0,
+    0.0,
+    1.0 / 42.0,
+    0.0,
+    -1.0 / 30.0,
+    0.0,
+    5.0 / 66.0,
+    0.0,
+    -691.0 / 2730.0,
+    0.0,
+    7.0 / 6.0,
+    0.0,
+    -3617.0 / 510.0,
+    0.0,
+    43867.0 / 798.0,
+    0.0,
+    -174611.0 / 330.0,
+};
+
+// Set out = sum_k c_k ad_omega^k(x) / k! with coefficients c of k, with
+// scratch term and next compatible with x, profiled as region name.
+//
+// out may alias x: x is only read until the first commutator is done.
+// Returns false if a commutator is rejected.
+template <typename Coefficient>
+bool AddSeries(
+    const char* name,
+    CommutatorEngine& engine,
+    const Operator& omega,
+    const Operator& x,
+    Coefficient coefficient,
+    double tolerance,
+    std::size_t max_terms,
+    Operator& term,
+    Operator& next,
+    Operator& out) {
+  NUI_PROFILE_REGION(name);
+  const double norm_x = Norm(x);
+  if (Norm(omega) == 0.0 || norm_x == 0.0 || max_terms == 0) {
+    Axpby(coefficient(0), x, 0.0, out);
+    return true;
+  }
+  const Operator* previous = &x;
+  for (std::size_t k = 1; k <= max_terms; k += 1) {
+    // next = ad_omega^k(x) / k!.
+    Scale(0.0, next);
+    if (!engine.AddCommutator(omega, *previous, 1.0 / k, next)) {
+      return false;
+    }
+    if (k == 1) {
+      Axpby(coefficient(0), x, 0.0, out);
+    }
+    const double c = coefficient(k);
+    if (c != 0.0) {
+      Axpy(c, next, out);
+    }
+    if (Norm(next) < tolerance * norm_x) {
+      break;
+    }
+    swap(term, next);
+    previous = &term;
+  }
+  return true;
+}
+
+}  // namespace
+
+bool BCHTransform(
+    CommutatorEngine& engine,
+    const Operator& omega,
+    const Operator& op,
+    double tolerance,
+    std::size_t max_terms,
+    Operator& out) {
+  return BCHTransform(engine, omega, {&op}, tolerance, max_terms, {&out});
+}
+
+bool BCHTransform(
+    CommutatorEngine& engine,
+    const Operator& omega,
+    const std::vector<const Operator*>& ops,
+    double tolerance,
+    std::size_t max_terms,
+    const std::vector<Operator*>& outs) {
+  NUI_PROFILE_REGION("BCH transform");
+  const std::size_t num_ops = ops.size();
+  if (outs.size() != num_ops) {
+    return false;
+  }
+  for (std::size_t i = 0; i < num_ops; i += 1) {
+    if (!outs[i]->IsCompatible(*ops[i])) {
+      return false;
+    }
+  }
+  // Previous and next nested commutators and results by operator.
+  std::vector<Operator> terms;
+  std::vector<Operator> nexts;
+  std::vector<Operator> results;
+  std::vector<double> norms(num_ops);
+  // Operators with unconverged series.
+  std::vector<std::size_t> active;
+  const bool zero_omega = Norm(omega) == 0.0;
+  for (std::size_t i = 0; i < num_ops; i += 1) {
+    terms.push_back(ops[i]->ZeroLike());
+    nexts.push_back(ops[i]->ZeroLike());
+    results.push_back(ops[i]->Clone());
+    norms[i] = Norm(*ops[i]);
+    if (!zero_omega && norms[i] != 0.0) {
+      active.push_back(i);
+    }
+  }
+
+  std::vector<const Operator*> previous;
+  std::vector<Operator*> next;
+  for (std::size_t k = 1; k <= max_terms && !active.empty(); k += 1) {
+    // next = ad_omega^k(op) / k!.
+    previous.clear();
+    next.clear();
+    for (const std::size_t i : active) {
+      Scale(0.0, nexts[i]);
+      previous.push_back(k == 1 ? ops[i] : &terms[i]);
+      next.push_back(&nexts[i]);
+    }
+    if (!engine.AddCommutators(omega, previous, 1.0 / k, next)) {
+      return false;
+    }
+    std::size_t num_active = 0;
+    for (const std::size_t i : active) {
+      Axpy(1.0, nexts[i], results[i]);
+      if (Norm(nexts[i]) < tolerance * norms[i]) {
+        continue;
+      }
+      swap(terms[i], nexts[i]);
+      active[num_active] = i;
+      num_active += 1;
+    }
+    active.resize(num_active);
+  }
+  for (std::size_t i = 0; i < num_ops; i += 1) {
+    swap(*outs[i], results[i]);
+  }
+  return true;
+}
+
+MagnusSolver::MagnusSolver(CommutatorEngine engine, MagnusOptions options)
+    : engine_(std::move(engine)), options_(options) {}
+
+bool MagnusSolver::Run(Operator& h, const MagnusGenerator& generator) {
+  NUI_PROFILE_REGION("Magnus flow");
+  omegas_.clear();
+  steps_.clear();
+  s_ = 0.0;
+  // Generator of the step, which becomes the derivative of Omega in place.
+  Operator eta(
+      h.TwoBody().ModelSpaceShared(),
+      Hermiticity::kAntihermitian,
+      h.TwoBody().IsPacked());
+  // H at the start of the segment.
+  Operator h_segment = h.Clone();
+  // Whether the engine rejects a commutator only depends on the model spaces
+  // and hermiticities, so checking once means that steps can only fail in
+  // the generator, before they change anything.
+  if (!engine_.Accepts(eta, eta, eta) || !engine_.Accepts(eta, h, h)) {
+    return false;
+  }
+  omegas_.push_back(eta.ZeroLike());
+  const std::size_t max_terms =
+      std::min(options_.max_series_terms, kBernoulli.size() - 1);
+  const auto count = [this]() {
+    return engine_.Statistics().num_commutators;
+  };
+
+  while (steps_.size() < options_.max_steps && s_ < options_.s_max) {
+    NUI_PROFILE_REGION("step");
+    if (!generator(h, eta)) {
+      return false;
+    }
+    MagnusStep step;
+    step.generator_norm = Norm(eta);
+    if (step.generator_norm < options_.generator_tolerance) {
+      break;
+    }
+    step.ds = std::min(
+        {options_.max_step,
+         options_.max_step_norm / step.generator_norm,
+         options_.s_max - s_});
+
+    // Scratch of each series only lives while the series is evaluated, so at
+    // most six operators as large as H are alive at a time.
+    Operator& omega = omegas_.back();
+    const std::size_t start = count();
+    {
+      Operator term = eta.ZeroLike();
+      Operator next = eta.ZeroLike();
+      if (!AddSeries(
+              "Omega derivative",
+              engine_,
+              omega,
+              eta,
+              [](std::size_t k) { return kBernoulli[k]; },
+              options_.series_tolerance,
+              max_terms,
+              term,
+              next,
+              eta)) {
+        return false;
+      }
+    }
+    step.derivative_commutators = count() - start;
+    Axpy(step.ds, eta, omega);
+
+    {
+      Operator term = h.ZeroLike();
+      Operator next = h.ZeroLike();
+      if (!AddSeries(
+              "BCH series",
+              engine_,
+              omega,
+              h_segment,
+              [](std::size_t) { return 1.0; },
+              options_.series_tolerance,
+              options_.max_series_terms,
+              term,
+              next,
+              h)) {
+        return false;
+      }
+    }
+    step.bch_commutators = count() - start - step.derivative_commutators;
+    s_ += step.ds;
+    step.s = s_;
+    step.omega_norm = Norm(omega);
+    step.energy = h.ZeroBody();
+    if (options_.max_omega_norm > 0.0 &&
+        step.omega_norm > options_.max_omega_norm) {
+      step.new_segment = true;
+      h_segment = h.Clone();
+      omegas_.push_back(eta.ZeroLike());
+    }
+    steps_.push_back(step);
+  }
+  return true;
+}
+
+bool MagnusSolver::Transform(
+    const std::vector<const Operator*>& ops,
+    const std::vector<Operator*>& outs) {
+  NUI_PROFILE_REGION("Magnus transform");
+  if (ops.size() != outs.size()) {
+    return false;
+  }
+  std::vector<const Operator*> inputs = ops;
+  for (const Operator& omega : omegas_) {
+    if (!BCHTransform(
+            engine_,
+            omega,
+            inputs,
+            options_.series_tolerance,
+            options_.max_series_terms,
+            outs)) {
+      return false;
+    }
+    inputs.assign(outs.begin(), outs.end());
+  }
+  if (omegas_.empty()) {
+    for (std::size_t i = 0; i < ops.size(); i += 1) {
+      if (!Axpby(1.0, *ops[i], 0.0, *outs[i])) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace nui
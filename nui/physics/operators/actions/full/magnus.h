@@ -0,0 +1,186 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_OPERATORS_ACTIONS_FULL_MAGNUS_H_
+#define NUI_PHYSICS_OPERATORS_ACTIONS_FULL_MAGNUS_H_
+
+// IWYU pragma: private, include "nui/physics/operators/actions/full/op_actions_full.h"
+// IWYU pragma: friend "nui/physics/operators/actions/full/.*\.h"
+
+#include <functional>
+#include <vector>
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/operators/actions/full/commutator.h"
+#include "nui/physics/operators/storage/full/op_full.h"
+
+// Magnus formulation of IMSRG flows.
+//
+// The unitary transformation is U(s) = exp(Omega(s)) with antihermitian
+// Omega, evolved as
+//
+//   dOmega/ds = sum_k B_k / k! ad_Omega^k(eta),   ad_Omega(X) = [Omega, X],
+//
+// with Bernoulli numbers B_k, and H(s) follows from the BCH series
+//
+//   H(s) = sum_k 1 / k! ad_Omega^k(H).
+//
+// Both series are evaluated term by term with two scratch operators (the
+// previous and the next nested commutator) and truncated at the first term
+// with a norm below a relative tolerance, so small Omega need few
+// commutators. The dOmega/ds series is summed into eta itself.
+//
+// Once |Omega| exceeds a threshold, the flow starts a new segment: H(s)
+// becomes the operator that later steps transform, and Omega restarts at
+// zero. All nested commutators up to that point are folded into H(s) and
+// reused instead of being recomputed with a growing Omega, which keeps
+// the series short. The total transformation is the product of the
+// exponentials of all segments.
+//
+// Observables are transformed after the flow with the stored Omegas. All
+// observables are transformed together: each order of the BCH series is one
+// batch of commutators with Omega (see CommutatorEngine::AddCommutators),
+// and observables drop out of the batch once their series has converged.
+
+namespace nui {
+
+// Options of Magnus flows.
+struct MagnusOptions {
+  // Flow parameter at which the flow stops.
+  double s_max = 50.0;
+  // Stop once the norm of the generator is below this.
+  double generator_tolerance = 1e-6;
+  // Step size ds = min(max_step, max_step_norm / |eta|), so every step adds
+  // at most max_step_norm to the norm of Omega.
+  double max_step = 1.0;
+  double max_step_norm = 0.5;
+  // Truncate series at the first nested commutator with a norm below
+  // series_tolerance times the norm of the first term, or after
+  // max_series_terms commutators.
+  double series_tolerance = 1e-10;
+  std::size_t max_series_terms = 20;
+  // Start a new segment once |Omega| exceeds this (0 never starts one).
+  double max_omega_norm = 1.0;
+  // Maximum number of steps.
+  std::size_t max_steps = 10000;
+};
+
+// Record of one flow step.
+struct MagnusStep {
+  // Flow parameter after the step and step size.
+  double s = 0.0;
+  double ds = 0.0;
+  // Norm of the generator of the step and of Omega after it.
+  double generator_norm = 0.0;
+  double omega_norm = 0.0;
+  // 0-body part of H(s).
+  double energy = 0.0;
+  // Commutators of the dOmega/ds series and of the BCH series.
+  std::size_t derivative_commutators = 0;
+  std::size_t bch_commutators = 0;
+  // Whether a new segment starts after the step.
+  bool new_segment = false;
+};
+
+// Generator of flows: set antihermitian eta from H(s), false on failure.
+using MagnusGenerator = std::function<bool(const Operator& h, Operator& eta)>;
+
+// Set out = exp(omega) op exp(-omega) by the BCH series.
+//
+// The series is truncated at the first nested commutator with a norm below
+// tolerance * |op|, or after max_terms commutators. out must not alias op
+// or omega. Returns false (and does nothing) if out is not compatible with
+// op or a commutator is rejected by engine.
+bool BCHTransform(
+    CommutatorEngine& engine,
+    const Operator& omega,
+    const Operator& op,
+    double tolerance,
+    std::size_t max_terms,
+    Operator& out);
+
+// Set outs[k] = exp(omega) ops[k] exp(-omega) for all k by the BCH series.
+//
+// Each series is truncated as in the single-operator version, and the
+// nested commutators of all unconverged series of one order are evaluated
+// as one batch. outs[k] may alias ops[k], but no other operator. Returns
+// false (and does nothing) if ops and outs differ in size, an out is not
+// compatible with its op, or a commutator is rejected by engine.
+bool BCHTransform(
+    CommutatorEngine& engine,
+    const Operator& omega,
+    const std::vector<const Operator*>& ops,
+    double tolerance,
+    std::size_t max_terms,
+    const std::vector<Operator*>& outs);
+
+// Solver of Magnus flows with adaptive step size.
+class MagnusSolver {
+ public:
+  // Build solver with engine for the commutators.
+  explicit MagnusSolver(CommutatorEngine engine, MagnusOptions options = {});
+
+  // Get commutator engine.
+  CommutatorEngine& Engine() { return engine_; }
+
+  // Get options.
+  const MagnusOptions& Options() const { return options_; }
+
+  // Evolve h to H(s) with generator.
+  //
+  // The flow starts at s = 0 and updates h to H(s) after every step. Returns
+  // false (and does nothing) if engine rejects commutators of h, or false if
+  // the generator fails. h, Omegas(), Steps(), and S() are then left at the
+  // last completed step.
+  bool Run(Operator& h, const MagnusGenerator& generator);
+
+  // Set outs[k] to ops[k] transformed with the Omegas of all segments.
+  //
+  // All operators are transformed in one batch per segment and series order.
+  // outs[k] may alias ops[k]. Returns false if ops and outs differ in size,
+  // an out is not compatible with its op, or a commutator is rejected.
+  bool Transform(
+      const std::vector<const Operator*>& ops,
+      const std::vector<Operator*>& outs);
+
+  // Get Omega of all segments, in order, so that
+  //
+  //   H(s) = ... exp(Omega_2) exp(Omega_1) H exp(-Omega_1) exp(-Omega_2) ...
+  const std::vector<Operator>& Omegas() const { return omegas_; }
+
+  // Get records of all steps.
+  const std::vector<MagnusStep>& Steps() const { return steps_; }
+
+  // Get flow parameter.
+  double S() const { return s_; }
+
+ private:
+  CommutatorEngine engine_;
+  MagnusOptions options_;
+  std::vector<Operator> omegas_;
+  std::vector<MagnusStep> steps_;
+  double s_ = 0.0;
+};
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_OPERATORS_ACTIONS_FULL_MAGNUS_H_
@@ -0,0 +1,165 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "fmt/core.h"
+#include "nui/core/basics/basics.h"
+#include "nui/info/profiling/profiling.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/actions/full/op_actions_full.h"
+#include "nui/physics/operators/storage/full/op_full.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+#include "nui/physics/operators/storage/testing/op_testing.h"
+
+// Benchmark of a Magnus flow with the White generator.
+//
+// Usage: nui_..._magnus_bench [emax] [max Omega norm] [strength]
+//                              [observables] [profile prefix]
+//
+// The Hamiltonian has shell energies of about 10 e and 2-body elements of
+// size strength. The table shows for each step the flow parameter, norms,
+// energy, and commutators of the dOmega/ds and BCH series. Runs with max
+// Omega norm 0 (no new segments) show how many commutators restarting
+// Omega saves. After the flow, copies of the initial Hamiltonian are
+// transformed as observables, once in one batch and once one by one.
+// Finally, the profile of flow and transforms is shown by stage and
+// commutator term, and written to files with the profile prefix.
+
+int main(int argc, char** argv) {
+  const int emax = argc > 1 ? std::atoi(argv[1]) : 4;
+  nui::MagnusOptions options;
+  if (argc > 2) {
+    options.max_omega_norm = std::atof(argv[2]);
+  }
+  const double strength = argc > 3 ? std::atof(argv[3]) : 1.0;
+  const int num_observables = argc > 4 ? std::atoi(argv[4]) : 4;
+  const std::string prefix = argc > 5 ? argv[5] : "";
+
+  const auto sp = nui::SPModelSpace::Make(
+      nui::SPTruncation(emax),
+      nui::Reference::HOEqualFilling(8, 8));
+  const auto ms = nui::TwoBodyModelSpace::Make(sp);
+  nui::Operator h = nui::testing::MakeHamiltonian(ms, 0.0, strength);
+  const nui::Operator h0 = h.Clone();
+  fmt::print(
+      "emax = {}, max |Omega| = {}, strength = {}, orbitals = {}\n",
+      emax,
+      options.max_omega_norm,
+      strength,
+      sp->NumOrbitals());
+
+  nui::Profiler::Global().Enable();
+  nui::MagnusSolver solver(nui::CommutatorEngine(ms), options);
+  const std::vector<double>& n = sp->Occupations();
+  bool ok = false;
+  const double seconds = nui::TimeSeconds([&]() {
+    ok = solver.Run(h, [&n](const nui::Operator& x, nui::Operator& eta) {
+      return nui::WhiteGenerator(x, n, eta);
+    });
+  });
+  if (!ok) {
+    fmt::print("flow failed\n");
+    return 1;
+  }
+
+  fmt::print(
+      "{:>5} {:>10} {:>10} {:>10} {:>10} {:>18} {:>6} {:>6}\n",
+      "step",
+      "s",
+      "ds",
+      "|eta|",
+      "|Omega|",
+      "E",
+      "dOmega",
+      "BCH");
+  std::size_t commutators = 0;
+  for (std::size_t i = 0; i < solver.Steps().size(); i += 1) {
+    const nui::MagnusStep& step = solver.Steps()[i];
+    fmt::print(
+        "{:>5} {:>10.4f} {:>10.4f} {:>10.3e} {:>10.3e} {:>18.10f} {:>6} {:>6}"
+        "{}\n",
+        i,
+        step.s,
+        step.ds,
+        step.generator_norm,
+        step.omega_norm,
+        step.energy,
+        step.derivative_commutators,
+        step.bch_commutators,
+        step.new_segment ? "  new segment" : "");
+    commutators += step.derivative_commutators + step.bch_commutators;
+  }
+  fmt::print(
+      "{} steps, {} segments, {} commutators ({:.1f} per step), {:.3f} s\n",
+      solver.Steps().size(),
+      solver.Omegas().size(),
+      commutators,
+      solver.Steps().empty()
+          ? 0.0
+          : static_cast<double>(commutators) / solver.Steps().size(),
+      seconds);
+
+  std::vector<nui::Operator> observables;
+  std::vector<nui::Operator> outs;
+  for (int i = 0; i < num_observables; i += 1) {
+    observables.push_back(h0.Clone());
+    nui::Scale(1.0 + i, observables.back());
+    outs.push_back(h0.ZeroLike());
+  }
+  std::vector<const nui::Operator*> ops;
+  std::vector<nui::Operator*> out_ptrs;
+  for (int i = 0; i < num_observables; i += 1) {
+    ops.push_back(&observables[i]);
+    out_ptrs.push_back(&outs[i]);
+  }
+  const double batched =
+      nui::TimeSeconds([&]() { ok = solver.Transform(ops, out_ptrs); });
+  const double single = nui::TimeSeconds([&]() {
+    for (int i = 0; i < num_observables && ok; i += 1) {
+      ok = solver.Transform({ops[i]}, {out_ptrs[i]});
+    }
+  });
+  if (!ok) {
+    fmt::print("transform failed\n");
+    return 1;
+  }
+  fmt::print(
+      "{} observables: batched {:.3f} s, one by one {:.3f} s ({:.2f}x)\n",
+      num_observables,
+      batched,
+      single,
+      batched > 0.0 ? single / batched : 0.0);
+
+  nui::Profiler::Global().Disable();
+  const std::vector<nui::ThreadProfile> profiles =
+      nui::Profiler::Global().Snapshot();
+  fmt::print("\n{}", nui::ProfileReport(profiles).ToText());
+  if (!prefix.empty() && !nui::WriteProfile(prefix, profiles)) {
+    fmt::print("writing profile {} failed\n", prefix);
+    return 1;
+  }
+  return 0;
+}
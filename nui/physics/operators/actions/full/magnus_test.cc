@@ -0,0 +1,319 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/actions/full/magnus.h"
+
+#include <cmath>
+#include <vector>
+
+#include "catch2/catch_approx.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "nui/core/basics/basics.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/actions/full/commutator.h"
+#include "nui/physics/operators/actions/full/generator.h"
+#include "nui/physics/operators/storage/full/op_full.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+#include "nui/physics/operators/storage/testing/op_testing.h"
+
+// Flows in a small model space (emax = 2, 4He reference). Without 2-body
+// part, the IMSRG(2) flow is exact and must reach the energy of the lowest
+// eigenstates of the 1-body Hamiltonian; with a weak 2-body part, it must
+// reproduce second-order perturbation theory.
+
+namespace {
+
+using nui::Hermiticity;
+using nui::testing::MakeHamiltonian;
+using nui::testing::MakeTwoBodyModelSpace;
+
+nui::MagnusGenerator White(const std::vector<double>& occupations) {
+  return [&occupations](const nui::Operator& h, nui::Operator& eta) {
+    return nui::WhiteGenerator(h, occupations, eta);
+  };
+}
+
+// Get energy of the Slater determinant of the lowest 1-body eigenstates.
+//
+// With emax = 2, only s-wave blocks (0s, 1s) have more than one orbital,
+// and 0s is occupied.
+double LowestEnergy(const nui::Operator& h) {
+  const nui::SPModelSpace& sp = h.SP();
+  double energy = h.ZeroBody();
+  for (const auto pw : sp.PartialWaveIndices()) {
+    const auto orbitals = sp.PartialWaveOrbitals(pw);
+    if (sp.PartialWaveSize(pw) != 2) {
+      continue;
+    }
+    const auto a = *orbitals.begin();
+    const auto b = nui::OrbitalIndex(a.idx() + 1);
+    const double faa = h.OneBody().Get(a, a);
+    const double fbb = h.OneBody().Get(b, b);
+    const double fab = h.OneBody().Get(a, b);
+    const double lowest = 0.5 * (faa + fbb) -
+                          std::sqrt(0.25 * (faa - fbb) * (faa - fbb) +
+                                    fab * fab);
+    energy += (sp.Orbital(a).TwoJ() + 1) * (lowest - faa);
+  }
+  return energy;
+}
+
+}  // namespace
+
+TEST_CASE("MagnusSolver, Test 1-body flow is exact.") {
+  const auto ms =
+      MakeTwoBodyModelSpace(2, nui::Reference::HOEqualFilling(2, 2));
+  const std::vector<double>& n = ms->SP().Occupations();
+  nui::Operator h = MakeHamiltonian(ms, 3.0, 0.0);
+  const double expected = LowestEnergy(h);
+
+  for (const double max_omega_norm : {0.0, 0.1}) {
+    nui::MagnusOptions options;
+    options.generator_tolerance = 1e-8;
+    options.max_omega_norm = max_omega_norm;
+    nui::MagnusSolver solver(nui::CommutatorEngine(ms), options);
+    nui::Operator hs = h.Clone();
+    REQUIRE(solver.Run(hs, White(n)));
+    REQUIRE(hs.ZeroBody() == Catch::Approx(expected).epsilon(1e-10));
+
+    const std::vector<nui::MagnusStep>& steps = solver.Steps();
+    REQUIRE(steps.size() > 2);
+    REQUIRE(steps.back().s == solver.S());
+    REQUIRE(steps.front().derivative_commutators == 0);
+    std::size_t segments = 1;
+    std::size_t commutators = 0;
+    for (const auto& step : steps) {
+      REQUIRE(step.ds > 0.0);
+      REQUIRE(step.ds * step.generator_norm <= options.max_step_norm + 1e-12);
+      REQUIRE(step.bch_commutators > 0);
+      segments += step.new_segment ? 1 : 0;
+      commutators += step.derivative_commutators + step.bch_commutators;
+    }
+    REQUIRE(solver.Omegas().size() == segments);
+    REQUIRE(solver.Engine().Statistics().num_commutators == commutators);
+    if (max_omega_norm > 0.0) {
+      REQUIRE(segments > 1);
+    } else {
+      REQUIRE(segments == 1);
+    }
+  }
+}
+
+TEST_CASE("MagnusSolver, Test second-order energy.") {
+  const auto ms =
+      MakeTwoBodyModelSpace(2, nui::Reference::HOEqualFilling(2, 2));
+  const std::vector<double>& n = ms->SP().Occupations();
+  const double strength = 0.05;
+  nui::Operator h = MakeHamiltonian(ms, 0.0, strength);
+
+  // E2 = sum_J (2J + 1) sum_{ab, ij} |Gamma_abij|^2 / (f_ii + f_jj - f_aa
+  // - f_bb) over normalized pp and hh states.
+  double e2 = 0.0;
+  for (const auto ch : ms->ChannelIndices()) {
+    const nui::TwoBodyChannel& channel = ms->Channel(ch);
+    const double degeneracy = channel.QuantumNumbers().TwoJ() + 1.0;
+    for (const auto i : channel.StateIndices()) {
+      const auto a = channel.First(i);
+      const auto b = channel.Second(i);
+      for (const auto j : channel.StateIndices()) {
+        const auto c = channel.First(j);
+        const auto d = channel.Second(j);
+        if (n[a.idx()] + n[b.idx()] != 0.0 ||
+            n[c.idx()] + n[d.idx()] != 2.0) {
+          continue;
+        }
+        const double denominator =
+            h.OneBody().Get(c, c) + h.OneBody().Get(d, d) -
+            h.OneBody().Get(a, a) - h.OneBody().Get(b, b);
+        e2 += degeneracy * std::pow(h.TwoBody().Get(ch, i, j), 2) /
+              denominator;
+      }
+    }
+  }
+  REQUIRE(e2 < 0.0);
+
+  nui::MagnusSolver solver{nui::CommutatorEngine(ms)};
+  nui::Operator hs = h.Clone();
+  REQUIRE(solver.Run(hs, White(n)));
+  REQUIRE(hs.ZeroBody() - h.ZeroBody() == Catch::Approx(e2).epsilon(0.02));
+  REQUIRE(solver.Steps().back().generator_norm > 0.0);
+}
+
+TEST_CASE("MagnusSolver, Test BCH transform.") {
+  const auto ms =
+      MakeTwoBodyModelSpace(2, nui::Reference::HOEqualFilling(2, 2));
+  const std::vector<double>& n = ms->SP().Occupations();
+  nui::Operator h = MakeHamiltonian(ms, 1.0, 0.5);
+  nui::MagnusOptions options;
+  options.s_max = 0.5;
+  nui::MagnusSolver solver(nui::CommutatorEngine(ms), options);
+  nui::Operator hs = h.Clone();
+  REQUIRE(solver.Run(hs, White(n)));
+  REQUIRE(solver.Omegas().size() == 1);
+  REQUIRE(solver.S() == Catch::Approx(0.5));
+
+  // BCH of the final Omega reproduces H(s).
+  nui::Operator out = h.ZeroLike();
+  REQUIRE(nui::BCHTransform(
+      solver.Engine(),
+      solver.Omegas().front(),
+      h,
+      1e-10,
+      20,
+      out));
+  REQUIRE(out.ZeroBody() == Catch::Approx(hs.ZeroBody()));
+  REQUIRE(nui::Axpy(-1.0, hs, out));
+  REQUIRE(nui::Norm(out) < 1e-10 * nui::Norm(hs));
+
+  nui::Operator anti(ms, Hermiticity::kAntihermitian);
+  REQUIRE_FALSE(nui::BCHTransform(
+      solver.Engine(),
+      solver.Omegas().front(),
+      h,
+      1e-10,
+      20,
+      anti));
+}
+
+TEST_CASE("MagnusSolver, Test batched transforms.") {
+  const auto ms =
+      MakeTwoBodyModelSpace(2, nui::Reference::HOEqualFilling(2, 2));
+  const std::vector<double>& n = ms->SP().Occupations();
+  nui::Operator h = MakeHamiltonian(ms, 1.0, 0.5);
+  nui::MagnusOptions options;
+  options.s_max = 1.0;
+  options.max_omega_norm = 0.05;
+  nui::MagnusSolver solver(nui::CommutatorEngine(ms), options);
+  nui::Operator hs = h.Clone();
+  REQUIRE(solver.Run(hs, White(n)));
+  REQUIRE(solver.Omegas().size() > 1);
+
+  // Observables: h itself, a scaled copy, and an operator without 2-body
+  // part (whose series converges first).
+  nui::Operator scaled = h.Clone();
+  nui::Scale(2.0, scaled);
+  nui::Operator one_body = MakeHamiltonian(ms, 1.0, 0.0);
+  const std::vector<const nui::Operator*> ops = {&h, &scaled, &one_body};
+  std::vector<nui::Operator> outs;
+  std::vector<nui::Operator*> out_ptrs;
+  for (const auto* op : ops) {
+    outs.push_back(op->ZeroLike());
+  }
+  for (auto& out : outs) {
+    out_ptrs.push_back(&out);
+  }
+
+  SECTION("batched BCH matches single transforms") {
+    const nui::Operator& omega = solver.Omegas().front();
+    REQUIRE(nui::BCHTransform(
+        solver.Engine(),
+        omega,
+        ops,
+        1e-10,
+        20,
+        out_ptrs));
+    for (std::size_t i = 0; i < ops.size(); i += 1) {
+      nui::Operator expected = ops[i]->ZeroLike();
+      REQUIRE(nui::BCHTransform(
+          solver.Engine(),
+          omega,
+          *ops[i],
+          1e-10,
+          20,
+          expected));
+      REQUIRE(nui::Axpy(-1.0, expected, outs[i]));
+      REQUIRE(nui::Norm(outs[i]) < 1e-12 * nui::Norm(expected));
+    }
+  }
+
+  SECTION("all segments reproduce H(s)") {
+    REQUIRE(solver.Transform(ops, out_ptrs));
+    REQUIRE(outs[0].ZeroBody() == Catch::Approx(hs.ZeroBody()));
+    REQUIRE(nui::Axpy(-1.0, hs, outs[0]));
+    REQUIRE(nui::Norm(outs[0]) < 1e-8 * nui::Norm(hs));
+    REQUIRE(nui::Axpy(-2.0, hs, outs[1]));
+    REQUIRE(nui::Norm(outs[1]) < 1e-8 * nui::Norm(hs));
+
+    // In place.
+    nui::Operator copy = h.Clone();
+    REQUIRE(solver.Transform({&copy}, {&copy}));
+    REQUIRE(nui::Axpy(-1.0, hs, copy));
+    REQUIRE(nui::Norm(copy) < 1e-8 * nui::Norm(hs));
+  }
+
+  nui::Operator anti(ms, Hermiticity::kAntihermitian);
+  REQUIRE_FALSE(solver.Transform(ops, {&anti}));
+  REQUIRE_FALSE(solver.Transform({&h}, {&anti}));
+}
+
+TEST_CASE("MagnusSolver, Test failing generator.") {
+  const auto ms =
+      MakeTwoBodyModelSpace(2, nui::Reference::HOEqualFilling(2, 2));
+  const std::vector<double>& n = ms->SP().Occupations();
+  const nui::Operator h = MakeHamiltonian(ms, 1.0, 0.5);
+  nui::MagnusOptions options;
+  options.max_step_norm = 0.1;
+  options.max_omega_norm = 0.15;
+  const std::size_t num_steps = 3;
+
+  // The generator fails in step num_steps + 1.
+  std::size_t calls = 0;
+  nui::MagnusSolver solver(nui::CommutatorEngine(ms), options);
+  nui::Operator hs = h.Clone();
+  REQUIRE_FALSE(solver.Run(
+      hs,
+      [&](const nui::Operator& x, nui::Operator& eta) {
+        calls += 1;
+        return calls <= num_steps && nui::WhiteGenerator(x, n, eta);
+      }));
+
+  // Everything is left at the last completed step.
+  options.max_steps = num_steps;
+  nui::MagnusSolver expected(nui::CommutatorEngine(ms), options);
+  nui::Operator expected_hs = h.Clone();
+  REQUIRE(expected.Run(expected_hs, White(n)));
+  REQUIRE(expected.Omegas().size() > 1);
+  REQUIRE(solver.Steps().size() == num_steps);
+  REQUIRE(solver.S() == expected.S());
+  REQUIRE(hs.ZeroBody() == expected_hs.ZeroBody());
+  REQUIRE(nui::Axpy(-1.0, expected_hs, hs));
+  REQUIRE(nui::Norm(hs) == 0.0);
+  REQUIRE(solver.Omegas().size() == expected.Omegas().size());
+  for (std::size_t i = 0; i < solver.Omegas().size(); i += 1) {
+    nui::Operator diff = solver.Omegas()[i].Clone();
+    REQUIRE(nui::Axpy(-1.0, expected.Omegas()[i], diff));
+    REQUIRE(nui::Norm(diff) == 0.0);
+  }
+
+  // Operators of another model space are rejected before the first step.
+  const auto smaller = nui::TwoBodyModelSpace::Make(nui::SPModelSpace::Make(
+      nui::SPTruncation(1),
+      nui::Reference::HOEqualFilling(2, 2)));
+  nui::MagnusSolver other{nui::CommutatorEngine(smaller)};
+  nui::Operator unchanged = h.Clone();
+  REQUIRE_FALSE(other.Run(unchanged, White(n)));
+  REQUIRE(other.Omegas().empty());
+  REQUIRE(other.Steps().empty());
+  REQUIRE(nui::Axpy(-1.0, h, unchanged));
+  REQUIRE(nui::Norm(unchanged) == 0.0);
+}
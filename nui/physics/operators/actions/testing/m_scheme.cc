@@ -0,0 +1,137 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/actions/testing/m_scheme.h"
+
+#include <cmath>
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/coupling/coupling.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+
+namespace nui {
+namespace testing {
+
+std::vector<double> MakeOccupations(const SPModelSpace& sp, int e_open) {
+  std::vector<double> occupations = sp.Occupations();
+  for (const auto a : sp.OrbitalIndices()) {
+    if (sp.Orbital(a).E() == e_open) {
+      occupations[a.idx()] = 0.1 * (1 + a.idx() % 4);
+    }
+  }
+  return occupations;
+}
+
+std::vector<MState> MakeMStates(const SPModelSpace& sp) {
+  std::vector<MState> states;
+  for (const auto a : sp.OrbitalIndices()) {
+    const int two_j = sp.Orbital(a).TwoJ();
+    for (int two_m = -two_j; two_m <= two_j; two_m += 2) {
+      states.push_back({a, two_j, two_m});
+    }
+  }
+  return states;
+}
+
+TwoBodyChannelIndex PairChannel(
+    const TwoBodyModelSpace& ms,
+    OrbitalIndex a,
+    OrbitalIndex b,
+    int two_j) {
+  const auto oa = ms.SP().Orbital(a);
+  const auto ob = ms.SP().Orbital(b);
+  return ms.ChannelIndex(PackedChannel(
+      two_j,
+      (oa.L() + ob.L()) % 2,
+      oa.TwoTz() + ob.TwoTz()));
+}
+
+std::vector<double> MScheme(
+    const TwoBodyOperator& op,
+    const std::vector<MState>& ms) {
+  const TwoBodyModelSpace& ms2 = op.ModelSpace();
+  const std::size_t n = ms.size();
+  // Clebsch-Gordan coefficients <p q | J M> (times sqrt(2) for p and q of
+  // the same orbital) by pair and J.
+  int two_jmax = 0;
+  for (const MState& x : ms) {
+    two_jmax = std::max(two_jmax, 2 * x.two_j);
+  }
+  const std::size_t nj = static_cast<std::size_t>(two_jmax / 2 + 1);
+  std::vector<double> cg(n * n * nj, 0.0);
+  for (std::size_t p = 0; p < n; p += 1) {
+    for (std::size_t q = 0; q < n; q += 1) {
+      const double norm = ms[p].orbital == ms[q].orbital ? std::sqrt(2.0) : 1.0;
+      for (std::size_t j = 0; j < nj; j += 1) {
+        cg[(p * n + q) * nj + j] =
+            norm * ClebschGordan(
+                       ms[p].two_j,
+                       ms[p].two_m,
+                       ms[q].two_j,
+                       ms[q].two_m,
+                       static_cast<int>(2 * j),
+                       ms[p].two_m + ms[q].two_m);
+      }
+    }
+  }
+
+  std::vector<double> out(n * n * n * n, 0.0);
+  for (std::size_t p = 0; p < n; p += 1) {
+    for (std::size_t q = 0; q < n; q += 1) {
+      for (std::size_t r = 0; r < n; r += 1) {
+        for (std::size_t s = 0; s < n; s += 1) {
+          if (ms[p].two_m + ms[q].two_m != ms[r].two_m + ms[s].two_m) {
+            continue;
+          }
+          double sum = 0.0;
+          for (std::size_t j = 0; j < nj; j += 1) {
+            const double x =
+                cg[(p * n + q) * nj + j] * cg[(r * n + s) * nj + j];
+            if (x == 0.0) {
+              continue;
+            }
+            const int two_j = static_cast<int>(2 * j);
+            const auto ch =
+                PairChannel(ms2, ms[p].orbital, ms[q].orbital, two_j);
+            if (ch == TwoBodyChannelIndex::Invalid() ||
+                PairChannel(ms2, ms[r].orbital, ms[s].orbital, two_j) != ch) {
+              continue;
+            }
+            sum += x * op.Get(
+                           ch,
+                           ms[p].orbital,
+                           ms[q].orbital,
+                           ms[r].orbital,
+                           ms[s].orbital);
+          }
+          out[((p * n + q) * n + r) * n + s] = sum;
+        }
+      }
+    }
+  }
+  return out;
+}
+
+}  // namespace testing
+}  // namespace nui
@@ -0,0 +1,75 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_OPERATORS_ACTIONS_TESTING_M_SCHEME_H_
+#define NUI_PHYSICS_OPERATORS_ACTIONS_TESTING_M_SCHEME_H_
+
+// IWYU pragma: private, include "nui/physics/operators/actions/testing/op_actions_testing.h"
+// IWYU pragma: friend "nui/physics/operators/actions/testing/.*\.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+
+// Fixtures shared by the tests of operator actions, which check J-scheme
+// kernels against dense m-scheme formulas in small model spaces.
+
+namespace nui {
+namespace testing {
+
+// Get fractional occupations.
+//
+// Orbitals of shell e_open get occupations between 0.1 and 0.4, all other
+// orbitals keep their reference occupation.
+std::vector<double> MakeOccupations(const SPModelSpace& sp, int e_open);
+
+// Single-particle m-state.
+struct MState {
+  OrbitalIndex orbital;
+  int two_j = 0;
+  int two_m = 0;
+};
+
+// Get m-states of all orbitals (by orbital, then ascending m).
+std::vector<MState> MakeMStates(const SPModelSpace& sp);
+
+// Get channel of |ab; J>.
+//
+// Returns TwoBodyChannelIndex::Invalid() if channel is not in model space.
+TwoBodyChannelIndex PairChannel(
+    const TwoBodyModelSpace& ms,
+    OrbitalIndex a,
+    OrbitalIndex b,
+    int two_j);
+
+// Get antisymmetrized m-scheme elements <pq| V |rs> of op.
+//
+// Elements are dense in m-states, stored at ((p * n + q) * n + r) * n + s.
+std::vector<double> MScheme(
+    const TwoBodyOperator& op,
+    const std::vector<MState>& ms);
+
+}  // namespace testing
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_OPERATORS_ACTIONS_TESTING_M_SCHEME_H_
@@ -0,0 +1,231 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/1b/one_body_kernels.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/storage/1b/one_body_operator.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+
+namespace nui {
+
+namespace {
+
+// Row-major n x n product, out = x * y.
+void MultiplyBlock(
+    const double* x,
+    const double* y,
+    std::size_t n,
+    double* out) {
+  std::fill(out, out + n * n, 0.0);
+  for (std::size_t i = 0; i < n; i += 1) {
+    double* out_row = out + i * n;
+    for (std::size_t k = 0; k < n; k += 1) {
+      const double x_ik = x[i * n + k];
+      const double* y_row = y + k * n;
+#pragma omp simd
+      for (std::size_t j = 0; j < n; j += 1) {
+        out_row[j] += x_ik * y_row[j];
+      }
+    }
+  }
+}
+
+std::size_t MaxBlockDimension(const SPModelSpace& sp) {
+  std::size_t n = 0UL;
+  for (const auto pw : sp.PartialWaveIndices()) {
+    n = std::max(n, sp.PartialWaveSize(pw));
+  }
+  return n;
+}
+
+}  // namespace
+
+double Norm(const OneBodyOperator& op) {
+  const bool packed = IsSymmetric(op.Symmetry());
+  double norm2 = 0.0;
+  for (const auto pw : op.SP().PartialWaveIndices()) {
+    const double* block = op.Block(pw);
+    const std::size_t size = op.BlockSize(pw);
+    double sum = 0.0;
+#pragma omp simd reduction(+ : sum)
+    for (std::size_t i = 0; i < size; i += 1) {
+      sum += block[i] * block[i];
+    }
+    if (packed) {
+      // Off-diagonal elements appear twice in the full block.
+      double diag = 0.0;
+      for (std::size_t i = 0; i < op.BlockDimension(pw); i += 1) {
+        diag += block[PackedIndex(i, i)] * block[PackedIndex(i, i)];
+      }
+      sum = 2.0 * sum - diag;
+    }
+    norm2 += (op.SP().PartialWave(pw).TwoJ() + 1) * sum;
+  }
+  return std::sqrt(norm2);
+}
+
+void Scale(double alpha, OneBodyOperator& op) {
+  op.PrepareWrites();
+  for (const auto pw : op.SP().PartialWaveIndices()) {
+    double* block = op.MutableBlock(pw);
+    const std::size_t size = op.BlockSize(pw);
+#pragma omp simd
+    for (std::size_t i = 0; i < size; i += 1) {
+      block[i] *= alpha;
+    }
+  }
+}
+
+bool Axpy(double alpha, const OneBodyOperator& x, OneBodyOperator& y) {
+  if (!x.IsCompatible(y)) {
+    return false;
+  }
+  y.PrepareWrites();
+  for (const auto pw : y.SP().PartialWaveIndices()) {
+    const double* x_block = x.Block(pw);
+    double* y_block = y.MutableBlock(pw);
+    const std::size_t size = y.BlockSize(pw);
+#pragma omp simd
+    for (std::size_t i = 0; i < size; i += 1) {
+      y_block[i] += alpha * x_block[i];
+    }
+  }
+  return true;
+}
+
+bool Axpby(
+    double alpha,
+    const OneBodyOperator& x,
+    double beta,
+    OneBodyOperator& y) {
+  if (!x.IsCompatible(y)) {
+    return false;
+  }
+  y.PrepareWrites();
+  for (const auto pw : y.SP().PartialWaveIndices()) {
+    const double* x_block = x.Block(pw);
+    double* y_block = y.MutableBlock(pw);
+    const std::size_t size = y.BlockSize(pw);
+#pragma omp simd
+    for (std::size_t i = 0; i < size; i += 1) {
+      y_block[i] = alpha * x_block[i] + beta * y_block[i];
+    }
+  }
+  return true;
+}
+
+bool LinearCombination(
+    const std::vector<double>& alphas,
+    const std::vector<const OneBodyOperator*>& xs,
+    double beta,
+    OneBodyOperator& y) {
+  if (alphas.size() != xs.size()) {
+    return false;
+  }
+  std::vector<double> term_alphas;
+  std::vector<const OneBodyOperator*> terms;
+  for (std::size_t k = 0; k < xs.size(); k += 1) {
+    if (xs[k] == &y) {
+      beta += alphas[k];
+    } else if (!xs[k]->IsCompatible(y)) {
+      return false;
+    } else {
+      term_alphas.push_back(alphas[k]);
+      terms.push_back(xs[k]);
+    }
+  }
+  y.PrepareWrites();
+  std::vector<const double*> blocks(terms.size());
+  for (const auto pw : y.SP().PartialWaveIndices()) {
+    for (std::size_t k = 0; k < terms.size(); k += 1) {
+      blocks[k] = terms[k]->Block(pw);
+    }
+    CombineBlocks(
+        terms.size(),
+        term_alphas.data(),
+        blocks.data(),
+        beta,
+        y.MutableBlock(pw),
+        y.BlockSize(pw));
+  }
+  return true;
+}
+
+bool AddCommutator(
+    double alpha,
+    const OneBodyOperator& a,
+    const OneBodyOperator& b,
+    OneBodyOperator& c) {
+  const Hermiticity result = CommutatorHermiticity(a.Symmetry(), b.Symmetry());
+  if (a.SPShared() != b.SPShared() || a.SPShared() != c.SPShared() ||
+      (c.Symmetry() != result && c.Symmetry() != Hermiticity::kNone)) {
+    return false;
+  }
+  // If a and b have definite symmetry, (ab)^T = s_a s_b ba, so one product
+  // suffices.
+  const bool one_product = IsSymmetric(result);
+  const double sign = HermiticitySign(a.Symmetry()) *
+                      HermiticitySign(b.Symmetry());
+
+  const std::size_t n_max = MaxBlockDimension(a.SP());
+  std::vector<double> scratch(4 * n_max * n_max);
+  c.PrepareWrites();
+  for (const auto pw : a.SP().PartialWaveIndices()) {
+    const std::size_t n = a.BlockDimension(pw);
+    double* a_full = scratch.data();
+    double* b_full = a_full + n * n;
+    double* ab = b_full + n * n;
+    double* ba = ab + n * n;
+    UnpackBlock(a.Block(pw), n, a.Symmetry(), a_full);
+    UnpackBlock(b.Block(pw), n, b.Symmetry(), b_full);
+    MultiplyBlock(a_full, b_full, n, ab);
+    if (one_product) {
+      for (std::size_t i = 0; i < n; i += 1) {
+        for (std::size_t j = 0; j < n; j += 1) {
+          ba[i * n + j] = sign * ab[j * n + i];
+        }
+      }
+    } else {
+      MultiplyBlock(b_full, a_full, n, ba);
+    }
+
+    double* c_block = c.MutableBlock(pw);
+    if (IsSymmetric(c.Symmetry())) {
+      for (std::size_t j = 0; j < n; j += 1) {
+        double* col = c_block + PackedIndex(0, j);
+        for (std::size_t i = 0; i <= j; i += 1) {
+          col[i] += alpha * (ab[i * n + j] - ba[i * n + j]);
+        }
+      }
+    } else {
+#pragma omp simd
+      for (std::size_t i = 0; i < n * n; i += 1) {
+        c_block[i] += alpha * (ab[i] - ba[i]);
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace nui
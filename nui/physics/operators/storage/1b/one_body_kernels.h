@@ -0,0 +1,85 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_OPERATORS_STORAGE_1B_ONE_BODY_KERNELS_H_
+#define NUI_PHYSICS_OPERATORS_STORAGE_1B_ONE_BODY_KERNELS_H_
+
+// IWYU pragma: private, include "nui/physics/operators/storage/1b/op_1b.h"
+// IWYU pragma: friend "nui/physics/operators/storage/1b/.*\.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/operators/storage/1b/one_body_operator.h"
+
+// Kernels on one-body operators.
+//
+// All kernels work block by block directly on the stored (full or packed)
+// blocks. Element-wise loops are single fused passes vectorized with
+// `omp simd`. Kernels never allocate, except AddCommutator, which uses one
+// scratch buffer per call.
+
+namespace nui {
+
+// Get m-scheme Frobenius norm, sqrt(sum_ab (2 j_a + 1) o_ab^2).
+double Norm(const OneBodyOperator& op);
+
+// Scale operator, op *= alpha.
+void Scale(double alpha, OneBodyOperator& op);
+
+// Add scaled operator, y += alpha * x.
+//
+// Returns false (and does nothing) if x and y are not compatible.
+bool Axpy(double alpha, const OneBodyOperator& x, OneBodyOperator& y);
+
+// Set linear combination, y = alpha * x + beta * y.
+//
+// Returns false (and does nothing) if x and y are not compatible.
+bool Axpby(
+    double alpha,
+    const OneBodyOperator& x,
+    double beta,
+    OneBodyOperator& y);
+
+// Set linear combination, y = beta * y + sum_k alphas[k] * xs[k].
+//
+// This is a single fused pass: every x is read once and y is written once.
+// Terms with xs[k] == &y are folded into beta. Returns false (and does
+// nothing) if sizes differ or any x is not compatible with y.
+bool LinearCombination(
+    const std::vector<double>& alphas,
+    const std::vector<const OneBodyOperator*>& xs,
+    double beta,
+    OneBodyOperator& y);
+
+// Add scaled commutator, c += alpha * [a, b].
+//
+// c must share the model space of a and b and either have hermiticity
+// CommutatorHermiticity(a, b) or none. Otherwise, returns false (and does
+// nothing).
+bool AddCommutator(
+    double alpha,
+    const OneBodyOperator& a,
+    const OneBodyOperator& b,
+    OneBodyOperator& c);
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_OPERATORS_STORAGE_1B_ONE_BODY_KERNELS_H_
@@ -0,0 +1,140 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/1b/one_body_kernels.h"
+
+#include "catch2/catch_approx.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "nui/core/basics/basics.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/storage/1b/one_body_operator.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+#include "nui/physics/operators/storage/testing/op_testing.h"
+
+namespace {
+
+using nui::Hermiticity;
+using nui::testing::MakeOneBodyOperator;
+using nui::testing::MakeSP;
+
+// Dense norb x norb matrix of operator.
+std::vector<double> Dense(const nui::OneBodyOperator& op) {
+  const std::size_t n = op.SP().NumOrbitals();
+  std::vector<double> out(n * n);
+  for (const auto a : op.SP().OrbitalIndices()) {
+    for (const auto b : op.SP().OrbitalIndices()) {
+      out[a.idx() * n + b.idx()] = op.Get(a, b);
+    }
+  }
+  return out;
+}
+
+const std::vector<Hermiticity> kAll = {
+    Hermiticity::kNone,
+    Hermiticity::kHermitian,
+    Hermiticity::kAntihermitian};
+
+}  // namespace
+
+TEST_CASE("OneBodyKernels, Test norm.") {
+  const auto sp = MakeSP(5);
+  for (const auto h : kAll) {
+    const auto op = MakeOneBodyOperator(sp, h, 0.7);
+    const auto dense = Dense(op);
+    const std::size_t n = sp->NumOrbitals();
+    double ref = 0.0;
+    for (const auto a : sp->OrbitalIndices()) {
+      for (std::size_t b = 0; b < n; b += 1) {
+        const double x = dense[a.idx() * n + b];
+        ref += (sp->Orbital(a).TwoJ() + 1) * x * x;
+      }
+    }
+    REQUIRE(nui::Norm(op) == Catch::Approx(std::sqrt(ref)));
+  }
+}
+
+TEST_CASE("OneBodyKernels, Test scale, axpy, and axpby.") {
+  const auto sp = MakeSP(5);
+  for (const auto h : kAll) {
+    const auto x = MakeOneBodyOperator(sp, h, 0.3);
+    auto y = MakeOneBodyOperator(sp, h, 1.1);
+    const auto dx = Dense(x);
+    const auto dy = Dense(y);
+
+    REQUIRE(nui::Axpy(2.0, x, y));
+    auto dz = Dense(y);
+    for (std::size_t i = 0; i < dz.size(); i += 1) {
+      REQUIRE(dz[i] == Catch::Approx(dy[i] + 2.0 * dx[i]));
+    }
+
+    REQUIRE(nui::Axpby(-1.0, x, 0.5, y));
+    dz = Dense(y);
+    for (std::size_t i = 0; i < dz.size(); i += 1) {
+      REQUIRE(
+          dz[i] == Catch::Approx(0.5 * (dy[i] + 2.0 * dx[i]) - dx[i]));
+    }
+
+    nui::Scale(3.0, y);
+    for (std::size_t i = 0; i < dz.size(); i += 1) {
+      REQUIRE(Dense(y)[i] == Catch::Approx(3.0 * dz[i]));
+    }
+  }
+
+  auto y = MakeOneBodyOperator(sp, Hermiticity::kHermitian, 0.1);
+  REQUIRE_FALSE(
+      nui::Axpy(1.0, MakeOneBodyOperator(sp, Hermiticity::kNone, 0.1), y));
+}
+
+TEST_CASE("OneBodyKernels, Test commutator.") {
+  const auto sp = MakeSP(5);
+  const std::size_t n = sp->NumOrbitals();
+  for (const auto ha : kAll) {
+    for (const auto hb : kAll) {
+      const auto a = MakeOneBodyOperator(sp, ha, 0.4);
+      const auto b = MakeOneBodyOperator(sp, hb, 0.9);
+      const auto da = Dense(a);
+      const auto db = Dense(b);
+      for (const auto hc :
+           {nui::CommutatorHermiticity(ha, hb), Hermiticity::kNone}) {
+        auto c = MakeOneBodyOperator(sp, hc, 1.3);
+        const auto dc = Dense(c);
+        REQUIRE(nui::AddCommutator(0.5, a, b, c));
+        const auto result = Dense(c);
+        for (std::size_t i = 0; i < n; i += 1) {
+          for (std::size_t j = 0; j < n; j += 1) {
+            double ref = dc[i * n + j];
+            for (std::size_t k = 0; k < n; k += 1) {
+              ref += 0.5 * (da[i * n + k] * db[k * n + j] -
+                            db[i * n + k] * da[k * n + j]);
+            }
+            REQUIRE(
+                result[i * n + j] == Catch::Approx(ref).margin(1e-12));
+          }
+        }
+      }
+    }
+  }
+
+  auto c = MakeOneBodyOperator(sp, Hermiticity::kHermitian, 0.1);
+  const auto h = MakeOneBodyOperator(sp, Hermiticity::kHermitian, 0.2);
+  REQUIRE_FALSE(nui::AddCommutator(1.0, h, h, c));
+}
@@ -0,0 +1,89 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/1b/one_body_operator.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+
+namespace nui {
+
+namespace {
+
+std::vector<std::size_t> MakeBlockSizes(
+    const SPModelSpace& sp,
+    Hermiticity hermiticity) {
+  std::vector<std::size_t> sizes;
+  sizes.reserve(sp.NumPartialWaves());
+  for (const auto pw : sp.PartialWaveIndices()) {
+    sizes.push_back(StoredBlockSize(sp.PartialWaveSize(pw), hermiticity));
+  }
+  return sizes;
+}
+
+}  // namespace
+
+OneBodyOperator::OneBodyOperator(
+    std::shared_ptr<const SPModelSpace> sp,
+    Hermiticity hermiticity)
+    : sp_(std::move(sp)),
+      hermiticity_(hermiticity),
+      blocks_(MakeBlockSizes(*sp_, hermiticity_)) {}
+
+double OneBodyOperator::Get(OrbitalIndex a, OrbitalIndex b) const {
+  const PartialWaveIndex pw = sp_->PartialWaveOf(a);
+  if (sp_->PartialWaveOf(b) != pw) {
+    return 0.0;
+  }
+  const std::size_t begin = sp_->PartialWaveBegin(pw).idx();
+  return BlockElement(
+      Block(pw),
+      BlockDimension(pw),
+      hermiticity_,
+      a.idx() - begin,
+      b.idx() - begin);
+}
+
+bool OneBodyOperator::Set(OrbitalIndex a, OrbitalIndex b, double value) {
+  const PartialWaveIndex pw = sp_->PartialWaveOf(a);
+  if (sp_->PartialWaveOf(b) != pw) {
+    return false;
+  }
+  if (a == b && hermiticity_ == Hermiticity::kAntihermitian && value != 0.0) {
+    return false;
+  }
+  const std::size_t begin = sp_->PartialWaveBegin(pw).idx();
+  const std::size_t i = a.idx() - begin;
+  const std::size_t j = b.idx() - begin;
+  double* block = MutableBlock(pw);
+  if (!IsSymmetric(hermiticity_)) {
+    block[i * BlockDimension(pw) + j] = value;
+  } else if (i <= j) {
+    block[PackedIndex(i, j)] = value;
+  } else {
+    block[PackedIndex(j, i)] = HermiticitySign(hermiticity_) * value;
+  }
+  return true;
+}
+
+}  // namespace nui
@@ -0,0 +1,130 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_OPERATORS_STORAGE_1B_ONE_BODY_OPERATOR_H_
+#define NUI_PHYSICS_OPERATORS_STORAGE_1B_ONE_BODY_OPERATOR_H_
+
+// IWYU pragma: private, include "nui/physics/operators/storage/1b/op_1b.h"
+// IWYU pragma: friend "nui/physics/operators/storage/1b/.*\.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+
+namespace nui {
+
+// Scalar one-body operator o_ab in a single-particle model space.
+//
+// Scalar operators only couple orbitals of the same partial wave (l, j, tz),
+// so the operator is stored as one dense block per partial wave. Since
+// orbitals of a partial wave are contiguous in the model space, block
+// element (i, j) is o_ab with a = PartialWaveBegin(pw) + i and
+// b = PartialWaveBegin(pw) + j. Blocks of (anti)hermitian operators are
+// packed upper triangles (see packed_layout.h).
+//
+// Blocks are held in CowBlocks, so copies are O(1) and only blocks that are
+// written afterwards are duplicated.
+class OneBodyOperator {
+ public:
+  // Construct zero operator.
+  OneBodyOperator(
+      std::shared_ptr<const SPModelSpace> sp,
+      Hermiticity hermiticity);
+
+  // Get single-particle model space.
+  const SPModelSpace& SP() const { return *sp_; }
+
+  // Get shared single-particle model space.
+  const std::shared_ptr<const SPModelSpace>& SPShared() const { return sp_; }
+
+  // Get symmetry under transposition.
+  Hermiticity Symmetry() const { return hermiticity_; }
+
+  // Get number of blocks (partial waves).
+  std::size_t NumBlocks() const { return blocks_.NumBlocks(); }
+
+  // Get dimension n of n x n block.
+  std::size_t BlockDimension(PartialWaveIndex pw) const {
+    return sp_->PartialWaveSize(pw);
+  }
+
+  // Get number of stored elements in block.
+  std::size_t BlockSize(PartialWaveIndex pw) const {
+    return blocks_.BlockSize(pw.idx());
+  }
+
+  // Get read-only stored block.
+  const double* Block(PartialWaveIndex pw) const {
+    return blocks_.Block(pw.idx());
+  }
+
+  // Get writable stored block (duplicated first if shared).
+  double* MutableBlock(PartialWaveIndex pw) {
+    return blocks_.MutableBlock(pw.idx());
+  }
+
+  // Get matrix element o_ab (zero if a and b are in different partial waves).
+  double Get(OrbitalIndex a, OrbitalIndex b) const;
+
+  // Set matrix element o_ab (and o_ba consistent with hermiticity).
+  //
+  // Returns false (and does nothing) if a and b are in different partial
+  // waves, or if a == b and the operator is antihermitian with value != 0.
+  bool Set(OrbitalIndex a, OrbitalIndex b, double value);
+
+  // Make block table unique, so that MutableBlock may be called in parallel
+  // on distinct blocks.
+  void PrepareWrites() { blocks_.PrepareWrites(); }
+
+  // Get underlying block storage.
+  const CowBlocks<double>& Blocks() const { return blocks_; }
+
+  // Check if other operator has same model space and hermiticity.
+  bool IsCompatible(const OneBodyOperator& other) const {
+    return sp_ == other.sp_ && hermiticity_ == other.hermiticity_;
+  }
+
+  // Get size of operator in dynamic memory (including shared blocks).
+  std::size_t MemoryLoad() const { return blocks_.MemoryLoad(); }
+
+  // Swap with other operator.
+  void swap(OneBodyOperator& other) noexcept {
+    using std::swap;
+    swap(sp_, other.sp_);
+    swap(hermiticity_, other.hermiticity_);
+    swap(blocks_, other.blocks_);
+  }
+
+ private:
+  std::shared_ptr<const SPModelSpace> sp_;
+  Hermiticity hermiticity_ = Hermiticity::kNone;
+  CowBlocks<double> blocks_;
+};
+
+// Swap two operators.
+inline void swap(OneBodyOperator& a, OneBodyOperator& b) noexcept {
+  a.swap(b);
+}
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_OPERATORS_STORAGE_1B_ONE_BODY_OPERATOR_H_
@@ -0,0 +1,101 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/1b/one_body_operator.h"
+
+#include "catch2/catch_test_macros.hpp"
+#include "nui/core/basics/basics.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+
+namespace {
+
+std::shared_ptr<const nui::SPModelSpace> MakeSP() {
+  return nui::SPModelSpace::Make(
+      nui::SPTruncation(4),
+      nui::Reference::HOEqualFilling(8, 8));
+}
+
+}  // namespace
+
+TEST_CASE("OneBodyOperator, Test block sizes.") {
+  const auto sp = MakeSP();
+  const nui::OneBodyOperator full(sp, nui::Hermiticity::kNone);
+  const nui::OneBodyOperator herm(sp, nui::Hermiticity::kHermitian);
+  REQUIRE(full.NumBlocks() == sp->NumPartialWaves());
+  std::size_t size_full = 0;
+  std::size_t size_herm = 0;
+  for (const auto pw : sp->PartialWaveIndices()) {
+    const std::size_t n = sp->PartialWaveSize(pw);
+    REQUIRE(full.BlockSize(pw) == n * n);
+    REQUIRE(herm.BlockSize(pw) == n * (n + 1) / 2);
+    size_full += full.BlockSize(pw);
+    size_herm += herm.BlockSize(pw);
+  }
+  REQUIRE(full.MemoryLoad() == size_full * sizeof(double));
+  REQUIRE(herm.MemoryLoad() == size_herm * sizeof(double));
+}
+
+TEST_CASE("OneBodyOperator, Test get and set.") {
+  const auto sp = MakeSP();
+  // 0s1/2 and 1s1/2 protons.
+  const auto a = sp->Index(nui::PackedOrbital(0, 0, 1, -1));
+  const auto b = sp->Index(nui::PackedOrbital(1, 0, 1, -1));
+  // 0p1/2 proton.
+  const auto c = sp->Index(nui::PackedOrbital(0, 1, 1, -1));
+
+  for (const auto h :
+       {nui::Hermiticity::kNone,
+        nui::Hermiticity::kHermitian,
+        nui::Hermiticity::kAntihermitian}) {
+    nui::OneBodyOperator op(sp, h);
+    REQUIRE(op.Set(a, b, 2.0));
+    REQUIRE(op.Get(a, b) == 2.0);
+    if (nui::IsSymmetric(h)) {
+      REQUIRE(op.Get(b, a) == nui::HermiticitySign(h) * 2.0);
+    } else {
+      REQUIRE(op.Get(b, a) == 0.0);
+    }
+    REQUIRE_FALSE(op.Set(a, c, 1.0));
+    REQUIRE(op.Get(a, c) == 0.0);
+    REQUIRE(
+        op.Set(a, a, 3.0) == (h != nui::Hermiticity::kAntihermitian));
+  }
+}
+
+TEST_CASE("OneBodyOperator, Test copies are copy-on-write.") {
+  const auto sp = MakeSP();
+  const auto a = sp->Index(nui::PackedOrbital(0, 0, 1, -1));
+  const auto b = sp->Index(nui::PackedOrbital(0, 1, 1, 1));
+  nui::OneBodyOperator op(sp, nui::Hermiticity::kHermitian);
+  op.Set(a, a, 1.0);
+  op.Set(b, b, 2.0);
+
+  nui::ResetCowStatistics();
+  nui::OneBodyOperator copy = op;
+  REQUIRE(copy.Block(sp->PartialWaveOf(a)) == op.Block(sp->PartialWaveOf(a)));
+  copy.Set(a, a, 5.0);
+  REQUIRE(nui::GetCowStatistics().faults == 1);
+  REQUIRE(op.Get(a, a) == 1.0);
+  REQUIRE(copy.Get(a, a) == 5.0);
+  REQUIRE(copy.Block(sp->PartialWaveOf(b)) == op.Block(sp->PartialWaveOf(b)));
+}
@@ -0,0 +1,485 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/2b/low_rank_operator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/memory/memory.h"
+#include "nui/info/runtime/runtime.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/operators/storage/2b/two_body_operator.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+#include "nui/tensor/contraction/tensor_contraction.h"
+
+namespace nui {
+
+namespace {
+
+// Maximum number of Jacobi sweeps.
+constexpr std::size_t kMaxSweeps = 50;
+
+// Orthogonalize the rows of row-major p x n matrix b by one-sided Jacobi
+// rotations, b <- w b with orthogonal p x p matrix w.
+//
+// On return, the norms of the rows of b are the singular values of the
+// original b. Unlike the eigenvalues of b b^T, they are accurate for
+// singular values far below sqrt(epsilon) times the largest one.
+void OrthogonalizeRows(
+    std::size_t p,
+    std::size_t n,
+    double* b,
+    std::vector<double>& w) {
+  w.assign(p * p, 0.0);
+  for (std::size_t i = 0; i < p; i += 1) {
+    w[i * p + i] = 1.0;
+  }
+  // x, y <- c x - s y, s x + c y for rows of length m.
+  const auto rotate =
+      [](double* x, double* y, std::size_t m, double c, double s) {
+        for (std::size_t k = 0; k < m; k += 1) {
+          const double xk = x[k];
+          const double yk = y[k];
+          x[k] = c * xk - s * yk;
+          y[k] = s * xk + c * yk;
+        }
+      };
+  for (std::size_t sweep = 0; sweep < kMaxSweeps; sweep += 1) {
+    bool rotated = false;
+    for (std::size_t i = 0; i < p; i += 1) {
+      for (std::size_t j = i + 1; j < p; j += 1) {
+        double* bi = b + i * n;
+        double* bj = b + j * n;
+        double alpha = 0.0;
+        double beta = 0.0;
+        double gamma = 0.0;
+        for (std::size_t k = 0; k < n; k += 1) {
+          alpha += bi[k] * bi[k];
+          beta += bj[k] * bj[k];
+          gamma += bi[k] * bj[k];
+        }
+        if (std::abs(gamma) <= 1e-15 * std::sqrt(alpha * beta)) {
+          continue;
+        }
+        // Rotation with (c b_i - s b_j) . (s b_i + c b_j) = 0.
+        rotated = true;
+        const double zeta = (beta - alpha) / (2.0 * gamma);
+        const double t = (zeta >= 0.0 ? 1.0 : -1.0) /
+                         (std::abs(zeta) + std::sqrt(1.0 + zeta * zeta));
+        const double c = 1.0 / std::sqrt(1.0 + t * t);
+        rotate(bi, bj, n, c, c * t);
+        rotate(w.data() + i * p, w.data() + j * p, p, c, c * t);
+      }
+    }
+    if (!rotated) {
+      return;
+    }
+  }
+}
+
+// Compressed channel block.
+//
+// Blocks that stay dense have rank n and no factors.
+struct Compressed {
+  std::size_t rank = 0;
+  double error = 0.0;
+  AlignedVector<double> block;
+};
+
+// Compress full row-major n x n matrix m (see LowRankTwoBodyOperator).
+//
+// Factors are only kept if they are smaller than the dense block, which has
+// dense_size elements.
+Compressed Compress(
+    const double* m,
+    std::size_t n,
+    std::size_t dense_size,
+    const LowRankOptions& options,
+    std::uint64_t seed) {
+  Compressed result;
+  const auto dense = [&]() {
+    result.rank = n;
+    result.error = 0.0;
+    result.block.clear();
+    return result;
+  };
+  double norm2 = 0.0;
+  for (std::size_t i = 0; i < n * n; i += 1) {
+    norm2 += m[i] * m[i];
+  }
+  if (n == 0 || norm2 == 0.0) {
+    return result;
+  }
+  // Factors save memory only for 2 n r < dense_size.
+  const std::size_t max_rank = std::min(
+      static_cast<std::size_t>(options.max_rank_fraction * n),
+      (dense_size - 1) / (2 * n));
+  if (max_rank == 0) {
+    return dense();
+  }
+  const double tolerance2 = options.tolerance * options.tolerance * norm2;
+  const std::size_t block_size = std::max<std::size_t>(options.block_size, 1);
+  const std::size_t limit = std::min(n, max_rank + block_size);
+
+  // Rows of qt are an orthonormal basis of the sampled range, b = qt m.
+  AlignedVector<double> qt(limit * n);
+  AlignedVector<double> b(limit * n);
+  AlignedVector<double> y;
+  AlignedVector<double> c;
+  AlignedVector<double> e;
+  std::size_t p = 0;
+  double residual2 = norm2;
+  std::mt19937_64 rng(seed);
+  std::normal_distribution<double> normal;
+  // Rows below this norm after orthogonalization are in the sampled range.
+  const double threshold = 1e-12 * std::sqrt(norm2 * n);
+  while (p < limit) {
+    const std::size_t k = std::min(block_size, limit - p);
+    AlignedVector<double> omega(k * n);
+    for (auto& x : omega) {
+      x = normal(rng);
+    }
+    // y = omega m^T (rows m omega_i).
+    y.resize(k * n);
+    Gemm(
+        GemmOp::kNormal,
+        GemmOp::kTranspose,
+        k,
+        n,
+        n,
+        1.0,
+        omega.data(),
+        n,
+        m,
+        n,
+        0.0,
+        y.data(),
+        n);
+    // Orthogonalize against the basis twice.
+    c.resize(k * std::max<std::size_t>(p, 1));
+    for (std::size_t pass = 0; pass < 2 && p > 0; pass += 1) {
+      Gemm(
+          GemmOp::kNormal,
+          GemmOp::kTranspose,
+          k,
+          p,
+          n,
+          1.0,
+          y.data(),
+          n,
+          qt.data(),
+          n,
+          0.0,
+          c.data(),
+          p);
+      Gemm(
+          GemmOp::kNormal,
+          GemmOp::kNormal,
+          k,
+          n,
+          p,
+          -1.0,
+          c.data(),
+          p,
+          qt.data(),
+          n,
+          1.0,
+          y.data(),
+          n);
+    }
+    // Orthonormalize the new rows among themselves.
+    const std::size_t first = p;
+    for (std::size_t i = 0; i < k; i += 1) {
+      double* row = y.data() + i * n;
+      for (std::size_t pass = 0; pass < 2; pass += 1) {
+        for (std::size_t j = first; j < p; j += 1) {
+          const double* q = qt.data() + j * n;
+          double dot = 0.0;
+          for (std::size_t e = 0; e < n; e += 1) {
+            dot += row[e] * q[e];
+          }
+          for (std::size_t e = 0; e < n; e += 1) {
+            row[e] -= dot * q[e];
+          }
+        }
+      }
+      double norm = 0.0;
+      for (std::size_t e = 0; e < n; e += 1) {
+        norm += row[e] * row[e];
+      }
+      norm = std::sqrt(norm);
+      if (norm <= threshold) {
+        continue;
+      }
+      double* q = qt.data() + p * n;
+      for (std::size_t e = 0; e < n; e += 1) {
+        q[e] = row[e] / norm;
+      }
+      p += 1;
+    }
+    if (p == first) {
+      break;
+    }
+    Gemm(
+        GemmOp::kNormal,
+        GemmOp::kNormal,
+        p - first,
+        n,
+        n,
+        1.0,
+        qt.data() + first * n,
+        n,
+        m,
+        n,
+        0.0,
+        b.data() + first * n,
+        n);
+    // Residual m - qt^T b (explicitly, norm2 - |b|^2 cancels).
+    e.assign(m, m + n * n);
+    Gemm(
+        GemmOp::kTranspose,
+        GemmOp::kNormal,
+        n,
+        n,
+        p,
+        -1.0,
+        qt.data(),
+        n,
+        b.data(),
+        n,
+        1.0,
+        e.data(),
+        n);
+    residual2 = 0.0;
+    for (const double x : e) {
+      residual2 += x * x;
+    }
+    if (residual2 <= 0.25 * tolerance2) {
+      break;
+    }
+  }
+  if (residual2 > tolerance2) {
+    return dense();
+  }
+
+  // Truncate with the singular values of b: w b has orthogonal rows, and
+  // m ~ qt^T b = (w qt)^T (w b).
+  std::vector<double> w;
+  OrthogonalizeRows(p, n, b.data(), w);
+  std::vector<double> sigma2(p, 0.0);
+  for (std::size_t i = 0; i < p; i += 1) {
+    for (std::size_t k = 0; k < n; k += 1) {
+      sigma2[i] += b[i * n + k] * b[i * n + k];
+    }
+  }
+  std::vector<std::size_t> order(p);
+  std::iota(order.begin(), order.end(), 0UL);
+  std::sort(order.begin(), order.end(), [&](std::size_t i, std::size_t j) {
+    return sigma2[i] > sigma2[j];
+  });
+  // Smallest rank r with residual + sum_{i >= r} sigma_i^2 <= tolerance^2.
+  std::size_t rank = p;
+  double tail = residual2;
+  while (rank > 0 && tail + sigma2[order[rank - 1]] <= tolerance2) {
+    tail += sigma2[order[rank - 1]];
+    rank -= 1;
+  }
+  if (rank > max_rank) {
+    return dense();
+  }
+
+  // l = (w_r qt)^T with the rows w_r of w of the kept singular values, and
+  // r = the kept rows of w b.
+  AlignedVector<double> wr(rank * p);
+  for (std::size_t j = 0; j < rank; j += 1) {
+    std::copy_n(w.data() + order[j] * p, p, wr.data() + j * p);
+  }
+  result.rank = rank;
+  result.error = std::sqrt(tail);
+  result.block.resize(2 * n * rank);
+  if (rank == 0) {
+    return result;
+  }
+  Gemm(
+      GemmOp::kTranspose,
+      GemmOp::kTranspose,
+      n,
+      rank,
+      p,
+      1.0,
+      qt.data(),
+      n,
+      wr.data(),
+      p,
+      0.0,
+      result.block.data(),
+      rank);
+  for (std::size_t j = 0; j < rank; j += 1) {
+    std::copy_n(
+        b.data() + order[j] * n,
+        n,
+        result.block.data() + n * rank + j * n);
+  }
+  return result;
+}
+
+}  // namespace
+
+LowRankTwoBodyOperator::LowRankTwoBodyOperator(
+    const TwoBodyOperator& op,
+    LowRankOptions options)
+    : ms_(op.ModelSpaceShared()),
+      hermiticity_(op.Symmetry()),
+      layout_(ChooseLayout(op.Symmetry(), true)),
+      options_(options) {
+  const std::size_t num_channels = op.NumChannels();
+  dims_.resize(num_channels);
+  ranks_.resize(num_channels);
+  errors_.resize(num_channels);
+  blocks_.resize(num_channels);
+  for (const auto ch : ms_->ChannelIndices()) {
+    dims_[ch.idx()] = op.ChannelDimension(ch);
+    source_bytes_ += op.ChannelSize(ch) * sizeof(double);
+  }
+
+#pragma omp parallel num_threads(NumParallelThreads())
+  {
+    AlignedVector<double> full;
+#pragma omp for schedule(dynamic)
+    for (std::size_t c = 0; c < num_channels; c += 1) {
+      const TwoBodyChannelIndex ch(c);
+      const std::size_t n = dims_[c];
+      full.resize(n * n);
+      op.UnpackChannel(ch, full.data());
+      const std::size_t dense_size = StoredBlockSize(n, layout_);
+      Compressed compressed = Compress(
+          full.data(),
+          n,
+          dense_size,
+          options_,
+          options_.seed + 0x9e3779b97f4a7c15ULL * (c + 1));
+      ranks_[c] = compressed.rank;
+      errors_[c] = compressed.error;
+      blocks_[c] = std::move(compressed.block);
+      if (!IsFactored(ch)) {
+        blocks_[c].resize(dense_size);
+        PackBlock(full.data(), n, StoredSymmetry(), blocks_[c].data());
+      }
+    }
+  }
+}
+
+void LowRankTwoBodyOperator::UnpackChannel(
+    TwoBodyChannelIndex ch,
+    double* full) const {
+  const std::size_t n = ChannelDimension(ch);
+  const std::size_t r = Rank(ch);
+  if (!IsFactored(ch)) {
+    UnpackBlock(Dense(ch), n, StoredSymmetry(), full);
+    return;
+  }
+  if (r == 0) {
+    std::fill_n(full, n * n, 0.0);
+    return;
+  }
+  Gemm(
+      GemmOp::kNormal,
+      GemmOp::kNormal,
+      n,
+      n,
+      r,
+      1.0,
+      Left(ch),
+      r,
+      Right(ch),
+      n,
+      0.0,
+      full,
+      n);
+}
+
+bool LowRankTwoBodyOperator::Decompress(TwoBodyOperator& out) const {
+  if (out.ModelSpaceShared() != ms_ || out.Symmetry() != hermiticity_) {
+    return false;
+  }
+  out.PrepareWrites();
+  const std::size_t num_channels = NumChannels();
+#pragma omp parallel num_threads(NumParallelThreads())
+  {
+    AlignedVector<double> full;
+#pragma omp for schedule(dynamic)
+    for (std::size_t c = 0; c < num_channels; c += 1) {
+      const TwoBodyChannelIndex ch(c);
+      if (!IsFactored(ch) && out.Layout() == layout_) {
+        std::copy_n(Dense(ch), out.ChannelSize(ch), out.MutableBlock(ch));
+        continue;
+      }
+      full.resize(dims_[c] * dims_[c]);
+      UnpackChannel(ch, full.data());
+      out.PackChannel(ch, full.data());
+    }
+  }
+  return true;
+}
+
+LowRankStatistics LowRankTwoBodyOperator::Statistics() const {
+  LowRankStatistics stats;
+  stats.num_channels = NumChannels();
+  stats.source_bytes = source_bytes_;
+  std::size_t ranks = 0;
+  std::size_t dims = 0;
+  double error2 = 0.0;
+  for (const auto ch : ms_->ChannelIndices()) {
+    stats.compressed_bytes += blocks_[ch.idx()].size() * sizeof(double);
+    const double degeneracy = ms_->ChannelQuantumNumbers(ch).TwoJ() + 1.0;
+    error2 += degeneracy * Error(ch) * Error(ch);
+    if (!IsFactored(ch)) {
+      continue;
+    }
+    stats.factored_channels += 1;
+    stats.max_rank = std::max(stats.max_rank, Rank(ch));
+    ranks += Rank(ch);
+    dims += ChannelDimension(ch);
+  }
+  stats.rank_fraction =
+      dims > 0 ? static_cast<double>(ranks) / static_cast<double>(dims) : 0.0;
+  stats.error = std::sqrt(error2);
+  return stats;
+}
+
+std::size_t LowRankTwoBodyOperator::MemoryLoad() const {
+  std::size_t load = (dims_.capacity() + ranks_.capacity()) *
+                         sizeof(std::size_t) +
+                     errors_.capacity() * sizeof(double);
+  for (const auto& block : blocks_) {
+    load += block.capacity() * sizeof(double);
+  }
+  return load;
+}
+
+}  // namespace nui
@@ -0,0 +1,184 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_OPERATORS_STORAGE_2B_LOW_RANK_OPERATOR_H_
+#define NUI_PHYSICS_OPERATORS_STORAGE_2B_LOW_RANK_OPERATOR_H_
+
+// IWYU pragma: private, include "nui/physics/operators/storage/2b/op_2b.h"
+// IWYU pragma: friend "nui/physics/operators/storage/2b/.*\.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/memory/memory.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/operators/storage/2b/two_body_operator.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+
+// Low-rank compression of two-body operators.
+//
+// Each channel block M (n x n) is approximated by factors M ~ L R with L
+// n x r (orthonormal columns) and R r x n. The range of M is found with
+// random test vectors in blocks of block_size (Gaussian, seeded per channel
+// so results do not depend on threads), orthonormalized by Gram-Schmidt
+// with reorthogonalization, until the residual |M - Q Q^T M| is below the
+// tolerance. The sampled range is then truncated optimally via the singular
+// values of Q^T M (one-sided Jacobi rotations): the rank r is the smallest
+// with
+//
+//   |M - L R|_F <= tolerance * |M|_F.
+//
+// Blocks of larger rank than max_rank_fraction * n stay dense, as do blocks
+// where the factors would not save memory. Dense blocks of (anti)hermitian
+// operators are packed upper triangles as in TwoBodyOperator. Products with
+// factored blocks cost O(n^2 r) instead of O(n^3) (see CommutatorEngine).
+
+namespace nui {
+
+// Options of low-rank compression.
+struct LowRankOptions {
+  // Relative Frobenius error of each channel block.
+  double tolerance = 1e-8;
+  // Keep blocks dense if the rank exceeds this fraction of the dimension.
+  double max_rank_fraction = 0.25;
+  // Number of random test vectors per range-finder pass.
+  std::size_t block_size = 8;
+  // Seed of test vectors (combined with the channel index).
+  std::uint64_t seed = 1;
+};
+
+// Summary of a compressed operator.
+struct LowRankStatistics {
+  // Number of channels and of factored channels.
+  std::size_t num_channels = 0;
+  std::size_t factored_channels = 0;
+  // Largest rank of factored channels and sum of ranks over the sum of
+  // dimensions of factored channels.
+  std::size_t max_rank = 0;
+  double rank_fraction = 0.0;
+  // Bytes of the compressed blocks and of the stored blocks of the source.
+  std::size_t compressed_bytes = 0;
+  std::size_t source_bytes = 0;
+  // Truncation error, sqrt(sum_J (2J + 1) |M_J - L_J R_J|^2).
+  double error = 0.0;
+};
+
+// Two-body operator with factored or dense full channel blocks.
+class LowRankTwoBodyOperator {
+ public:
+  // Compress op channel by channel (in parallel over channels).
+  explicit LowRankTwoBodyOperator(
+      const TwoBodyOperator& op,
+      LowRankOptions options = {});
+
+  // Get two-body model space.
+  const TwoBodyModelSpace& ModelSpace() const { return *ms_; }
+
+  // Get shared two-body model space.
+  const std::shared_ptr<const TwoBodyModelSpace>& ModelSpaceShared() const {
+    return ms_;
+  }
+
+  // Get symmetry under transposition of the source.
+  Hermiticity Symmetry() const { return hermiticity_; }
+
+  // Get layout of dense channel blocks.
+  BlockLayout Layout() const { return layout_; }
+
+  // Check if dense channel blocks are packed upper triangles.
+  bool IsPacked() const { return layout_ == BlockLayout::kPackedUpper; }
+
+  // Get options.
+  const LowRankOptions& Options() const { return options_; }
+
+  // Get number of channels.
+  std::size_t NumChannels() const { return dims_.size(); }
+
+  // Get dimension n of n x n channel block.
+  std::size_t ChannelDimension(TwoBodyChannelIndex ch) const {
+    return dims_[ch.idx()];
+  }
+
+  // Check if channel block is factored.
+  bool IsFactored(TwoBodyChannelIndex ch) const {
+    return ranks_[ch.idx()] < dims_[ch.idx()];
+  }
+
+  // Get rank of channel block (the dimension for dense blocks).
+  std::size_t Rank(TwoBodyChannelIndex ch) const { return ranks_[ch.idx()]; }
+
+  // Get Frobenius norm of the truncation error of channel block.
+  double Error(TwoBodyChannelIndex ch) const { return errors_[ch.idx()]; }
+
+  // Get row-major n x r left factor of factored channel block.
+  const double* Left(TwoBodyChannelIndex ch) const {
+    return blocks_[ch.idx()].data();
+  }
+
+  // Get row-major r x n right factor of factored channel block.
+  const double* Right(TwoBodyChannelIndex ch) const {
+    return blocks_[ch.idx()].data() + dims_[ch.idx()] * ranks_[ch.idx()];
+  }
+
+  // Get stored dense channel block (see Layout()).
+  const double* Dense(TwoBodyChannelIndex ch) const {
+    return blocks_[ch.idx()].data();
+  }
+
+  // Unpack channel into full row-major n x n matrix.
+  void UnpackChannel(TwoBodyChannelIndex ch, double* full) const;
+
+  // Overwrite out with the approximated operator.
+  //
+  // Returns false (and does nothing) if out has another model space or
+  // hermiticity.
+  bool Decompress(TwoBodyOperator& out) const;
+
+  // Get summary of ranks, memory, and error.
+  LowRankStatistics Statistics() const;
+
+  // Get size of compressed blocks in dynamic memory.
+  std::size_t MemoryLoad() const;
+
+ private:
+  // Hermiticity describing the layout of dense blocks (none for full blocks).
+  Hermiticity StoredSymmetry() const {
+    return IsPacked() ? hermiticity_ : Hermiticity::kNone;
+  }
+
+  std::shared_ptr<const TwoBodyModelSpace> ms_;
+  Hermiticity hermiticity_ = Hermiticity::kNone;
+  BlockLayout layout_ = BlockLayout::kFull;
+  LowRankOptions options_;
+  std::vector<std::size_t> dims_;
+  std::vector<std::size_t> ranks_;
+  std::vector<double> errors_;
+  std::size_t source_bytes_ = 0;
+  // Factors L and R (in this order) or dense blocks by channel.
+  std::vector<AlignedVector<double>> blocks_;
+};
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_OPERATORS_STORAGE_2B_LOW_RANK_OPERATOR_H_
@@ -0,0 +1,192 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/2b/low_rank_operator.h"
+
+#include <cmath>
+#include <vector>
+
+#include "catch2/catch_approx.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "nui/core/basics/basics.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/storage/2b/two_body_kernels.h"
+#include "nui/physics/operators/storage/2b/two_body_operator.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+#include "nui/physics/operators/storage/testing/op_testing.h"
+
+namespace {
+
+using nui::Hermiticity;
+using nui::testing::MakeTwoBodyModelSpace;
+
+double F(std::size_t i) { return std::cos(0.3 * i); }
+double G(std::size_t i) { return std::sin(0.7 * i + 0.2); }
+double H(std::size_t i) { return 1.0 / (1.0 + i); }
+
+// Get operator with blocks of rank at most 3 (2 if (anti)hermitian), plus
+// diagonal * identity.
+nui::TwoBodyOperator MakeLowRank(
+    const std::shared_ptr<const nui::TwoBodyModelSpace>& ms,
+    Hermiticity h,
+    double diagonal) {
+  nui::TwoBodyOperator op(ms, h);
+  for (const auto ch : ms->ChannelIndices()) {
+    const auto& channel = ms->Channel(ch);
+    const double scale = 1.0 + 0.1 * ch.idx();
+    for (const auto i : channel.StateIndices()) {
+      for (const auto j : channel.StateIndices()) {
+        const std::size_t a = i.idx();
+        const std::size_t b = j.idx();
+        if (nui::IsSymmetric(h) && a > b) {
+          continue;
+        }
+        double value = 0.0;
+        if (h == Hermiticity::kHermitian) {
+          value = F(a) * F(b) + G(a) * G(b) + (a == b ? diagonal : 0.0);
+        } else if (h == Hermiticity::kAntihermitian) {
+          value = F(a) * G(b) - G(a) * F(b);
+        } else {
+          value = F(a) * G(b) + G(a) * H(b) + H(a) * F(b) +
+                  (a == b ? diagonal : 0.0);
+        }
+        op.Set(ch, i, j, scale * value);
+      }
+    }
+  }
+  return op;
+}
+
+// Get largest Frobenius norm of channel errors relative to channel norms.
+double RelativeError(
+    const nui::TwoBodyOperator& op,
+    const nui::TwoBodyOperator& approx) {
+  double error = 0.0;
+  std::vector<double> x;
+  std::vector<double> y;
+  for (const auto ch : op.ModelSpace().ChannelIndices()) {
+    const std::size_t n = op.ChannelDimension(ch);
+    x.resize(n * n);
+    y.resize(n * n);
+    op.UnpackChannel(ch, x.data());
+    approx.UnpackChannel(ch, y.data());
+    double diff = 0.0;
+    double norm = 0.0;
+    for (std::size_t i = 0; i < n * n; i += 1) {
+      diff += (x[i] - y[i]) * (x[i] - y[i]);
+      norm += x[i] * x[i];
+    }
+    if (norm > 0.0) {
+      error = std::max(error, std::sqrt(diff / norm));
+    }
+  }
+  return error;
+}
+
+}  // namespace
+
+TEST_CASE("LowRankTwoBodyOperator, Test exact low rank.") {
+  const auto ms = MakeTwoBodyModelSpace(3);
+  for (const Hermiticity h :
+       {Hermiticity::kHermitian,
+        Hermiticity::kAntihermitian,
+        Hermiticity::kNone}) {
+    const nui::TwoBodyOperator op = MakeLowRank(ms, h, 0.0);
+    nui::LowRankOptions options;
+    options.tolerance = 1e-10;
+    const nui::LowRankTwoBodyOperator compressed(op, options);
+    REQUIRE(compressed.Symmetry() == h);
+    REQUIRE(compressed.NumChannels() == op.NumChannels());
+    const std::size_t expected_rank = h == Hermiticity::kNone ? 3 : 2;
+    std::size_t factored = 0;
+    for (const auto ch : ms->ChannelIndices()) {
+      const std::size_t n = compressed.ChannelDimension(ch);
+      REQUIRE(n == op.ChannelDimension(ch));
+      if (4 * (expected_rank + 1) <= n) {
+        REQUIRE(compressed.IsFactored(ch));
+      }
+      if (compressed.IsFactored(ch)) {
+        factored += 1;
+        REQUIRE(compressed.Rank(ch) <= expected_rank);
+        REQUIRE(compressed.Error(ch) <= 1e-10 * (1.0 + 0.1 * ch.idx()) * n);
+      } else {
+        REQUIRE(compressed.Rank(ch) == n);
+        REQUIRE(compressed.Error(ch) == 0.0);
+      }
+    }
+    REQUIRE(factored > 0);
+
+    nui::TwoBodyOperator approx(ms, h, h != Hermiticity::kHermitian);
+    REQUIRE(compressed.Decompress(approx));
+    REQUIRE(RelativeError(op, approx) < 1e-9);
+
+    const nui::LowRankStatistics stats = compressed.Statistics();
+    REQUIRE(stats.num_channels == op.NumChannels());
+    REQUIRE(stats.factored_channels == factored);
+    REQUIRE(stats.max_rank <= expected_rank);
+    REQUIRE(stats.rank_fraction < 0.25);
+    REQUIRE(stats.compressed_bytes < stats.source_bytes);
+    REQUIRE(stats.error < 1e-8);
+    REQUIRE(compressed.MemoryLoad() >= stats.compressed_bytes);
+  }
+}
+
+TEST_CASE("LowRankTwoBodyOperator, Test tolerance and dense blocks.") {
+  const auto ms = MakeTwoBodyModelSpace(3);
+  // A small identity part is dropped above its norm, kept below.
+  const nui::TwoBodyOperator op =
+      MakeLowRank(ms, Hermiticity::kHermitian, 1e-4);
+  nui::LowRankOptions options;
+  options.tolerance = 1e-2;
+  const nui::LowRankTwoBodyOperator loose(op, options);
+  nui::TwoBodyOperator approx(ms, Hermiticity::kHermitian);
+  REQUIRE(loose.Decompress(approx));
+  REQUIRE(RelativeError(op, approx) <= 1e-2);
+  REQUIRE(loose.Statistics().max_rank <= 2);
+  REQUIRE(loose.Statistics().error > 0.0);
+
+  options.tolerance = 1e-10;
+  const nui::LowRankTwoBodyOperator tight(op, options);
+  REQUIRE(tight.Statistics().factored_channels == 0);
+
+  // Dense blocks are packed like those of op.
+  REQUIRE(tight.IsPacked());
+  const nui::LowRankStatistics tight_stats = tight.Statistics();
+  REQUIRE(tight_stats.compressed_bytes == tight_stats.source_bytes);
+  REQUIRE(tight.Decompress(approx));
+  REQUIRE(RelativeError(op, approx) == 0.0);
+
+  // Zero blocks have rank 0.
+  const nui::TwoBodyOperator zero(ms, Hermiticity::kNone);
+  const nui::LowRankTwoBodyOperator compressed(zero);
+  for (const auto ch : ms->ChannelIndices()) {
+    if (compressed.ChannelDimension(ch) > 0) {
+      REQUIRE(compressed.IsFactored(ch));
+      REQUIRE(compressed.Rank(ch) == 0);
+    }
+  }
+  REQUIRE(compressed.Statistics().compressed_bytes == 0);
+
+  nui::TwoBodyOperator anti(ms, Hermiticity::kAntihermitian);
+  REQUIRE_FALSE(loose.Decompress(anti));
+}
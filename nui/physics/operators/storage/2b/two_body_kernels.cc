@@ -0,0 +1,163 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/2b/two_body_kernels.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/info/runtime/runtime.h"
+#include "nui/physics/operators/storage/2b/two_body_operator.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+
+namespace nui {
+
+namespace {
+
+// Get sum_ij O_ij^2 over the full block of channel ch.
+double ChannelNorm2(const TwoBodyOperator& op, TwoBodyChannelIndex ch) {
+  const double* block = op.Block(ch);
+  const std::size_t size = op.ChannelSize(ch);
+  double sum = 0.0;
+#pragma omp simd reduction(+ : sum)
+  for (std::size_t i = 0; i < size; i += 1) {
+    sum += block[i] * block[i];
+  }
+  if (op.IsPacked()) {
+    // Off-diagonal elements appear twice in the full block.
+    double diag = 0.0;
+    for (std::size_t i = 0; i < op.ChannelDimension(ch); i += 1) {
+      diag += block[PackedIndex(i, i)] * block[PackedIndex(i, i)];
+    }
+    sum = 2.0 * sum - diag;
+  }
+  return sum;
+}
+
+}  // namespace
+
+double Norm(const TwoBodyOperator& op) {
+  const std::ptrdiff_t num_channels =
+      static_cast<std::ptrdiff_t>(op.NumChannels());
+  double norm2 = 0.0;
+#pragma omp parallel for schedule(dynamic) reduction(+ : norm2) \
+    num_threads(NumParallelThreads())
+  for (std::ptrdiff_t c = 0; c < num_channels; c += 1) {
+    const TwoBodyChannelIndex ch(static_cast<std::size_t>(c));
+    norm2 += (op.ModelSpace().ChannelQuantumNumbers(ch).TwoJ() + 1) *
+             ChannelNorm2(op, ch);
+  }
+  return std::sqrt(norm2);
+}
+
+double ChannelNorm(const TwoBodyOperator& op, TwoBodyChannelIndex ch) {
+  return std::sqrt(ChannelNorm2(op, ch));
+}
+
+void Scale(double alpha, TwoBodyOperator& op) {
+  op.PrepareWrites();
+  const std::ptrdiff_t num_channels =
+      static_cast<std::ptrdiff_t>(op.NumChannels());
+#pragma omp parallel for schedule(dynamic) num_threads(NumParallelThreads())
+  for (std::ptrdiff_t c = 0; c < num_channels; c += 1) {
+    const TwoBodyChannelIndex ch(static_cast<std::size_t>(c));
+    double* block = op.MutableBlock(ch);
+    const std::size_t size = op.ChannelSize(ch);
+#pragma omp simd
+    for (std::size_t i = 0; i < size; i += 1) {
+      block[i] *= alpha;
+    }
+  }
+}
+
+bool Axpy(double alpha, const TwoBodyOperator& x, TwoBodyOperator& y) {
+  return Axpby(alpha, x, 1.0, y);
+}
+
+bool Axpby(
+    double alpha,
+    const TwoBodyOperator& x,
+    double beta,
+    TwoBodyOperator& y) {
+  if (!x.IsCompatible(y)) {
+    return false;
+  }
+  y.PrepareWrites();
+  const std::ptrdiff_t num_channels =
+      static_cast<std::ptrdiff_t>(y.NumChannels());
+#pragma omp parallel for schedule(dynamic) num_threads(NumParallelThreads())
+  for (std::ptrdiff_t c = 0; c < num_channels; c += 1) {
+    const TwoBodyChannelIndex ch(static_cast<std::size_t>(c));
+    const double* x_block = x.Block(ch);
+    double* y_block = y.MutableBlock(ch);
+    const std::size_t size = y.ChannelSize(ch);
+#pragma omp simd
+    for (std::size_t i = 0; i < size; i += 1) {
+      y_block[i] = alpha * x_block[i] + beta * y_block[i];
+    }
+  }
+  return true;
+}
+
+bool LinearCombination(
+    const std::vector<double>& alphas,
+    const std::vector<const TwoBodyOperator*>& xs,
+    double beta,
+    TwoBodyOperator& y) {
+  if (alphas.size() != xs.size()) {
+    return false;
+  }
+  std::vector<double> term_alphas;
+  std::vector<const TwoBodyOperator*> terms;
+  for (std::size_t k = 0; k < xs.size(); k += 1) {
+    if (xs[k] == &y) {
+      beta += alphas[k];
+    } else if (!xs[k]->IsCompatible(y)) {
+      return false;
+    } else {
+      term_alphas.push_back(alphas[k]);
+      terms.push_back(xs[k]);
+    }
+  }
+  y.PrepareWrites();
+  const std::ptrdiff_t num_channels =
+      static_cast<std::ptrdiff_t>(y.NumChannels());
+#pragma omp parallel num_threads(NumParallelThreads())
+  {
+    std::vector<const double*> blocks(terms.size());
+#pragma omp for schedule(dynamic)
+    for (std::ptrdiff_t c = 0; c < num_channels; c += 1) {
+      const TwoBodyChannelIndex ch(static_cast<std::size_t>(c));
+      for (std::size_t k = 0; k < terms.size(); k += 1) {
+        blocks[k] = terms[k]->Block(ch);
+      }
+      CombineBlocks(
+          terms.size(),
+          term_alphas.data(),
+          blocks.data(),
+          beta,
+          y.MutableBlock(ch),
+          y.ChannelSize(ch));
+    }
+  }
+  return true;
+}
+
+}  // namespace nui
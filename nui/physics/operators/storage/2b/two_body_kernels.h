@@ -0,0 +1,79 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_OPERATORS_STORAGE_2B_TWO_BODY_KERNELS_H_
+#define NUI_PHYSICS_OPERATORS_STORAGE_2B_TWO_BODY_KERNELS_H_
+
+// IWYU pragma: private, include "nui/physics/operators/storage/2b/op_2b.h"
+// IWYU pragma: friend "nui/physics/operators/storage/2b/.*\.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/operators/storage/2b/two_body_operator.h"
+
+// Element-wise kernels on two-body operators.
+//
+// Kernels run in parallel over channels and work directly on the stored
+// (full or packed) blocks with `omp simd` loops, so packed operators move
+// half the data.
+
+namespace nui {
+
+// Get Frobenius norm, sqrt(sum_J (2J + 1) sum_ij O_ij^2).
+double Norm(const TwoBodyOperator& op);
+
+// Get Frobenius norm of the full block of channel ch, sqrt(sum_ij O_ij^2).
+//
+// This is one pass over the stored block, cheap enough to screen products
+// of blocks before unpacking them.
+double ChannelNorm(const TwoBodyOperator& op, TwoBodyChannelIndex ch);
+
+// Scale operator, op *= alpha.
+void Scale(double alpha, TwoBodyOperator& op);
+
+// Add scaled operator, y += alpha * x.
+//
+// Returns false (and does nothing) if x and y are not compatible.
+bool Axpy(double alpha, const TwoBodyOperator& x, TwoBodyOperator& y);
+
+// Set linear combination, y = alpha * x + beta * y.
+//
+// Returns false (and does nothing) if x and y are not compatible.
+bool Axpby(
+    double alpha,
+    const TwoBodyOperator& x,
+    double beta,
+    TwoBodyOperator& y);
+
+// Set linear combination, y = beta * y + sum_k alphas[k] * xs[k].
+//
+// This is a single fused pass: every x is read once and y is written once.
+// Terms with xs[k] == &y are folded into beta. Returns false (and does
+// nothing) if sizes differ or any x is not compatible with y.
+bool LinearCombination(
+    const std::vector<double>& alphas,
+    const std::vector<const TwoBodyOperator*>& xs,
+    double beta,
+    TwoBodyOperator& y);
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_OPERATORS_STORAGE_2B_TWO_BODY_KERNELS_H_
@@ -0,0 +1,100 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/2b/two_body_kernels.h"
+
+#include "catch2/catch_approx.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "nui/core/basics/basics.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/storage/2b/two_body_operator.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+#include "nui/physics/operators/storage/testing/op_testing.h"
+
+namespace {
+
+using nui::Hermiticity;
+using nui::testing::MakeTwoBodyModelSpace;
+using nui::testing::MakeTwoBodyOperator;
+
+}  // namespace
+
+TEST_CASE("TwoBodyKernels, Test packed and full kernels agree.") {
+  const auto ms = MakeTwoBodyModelSpace(3);
+  for (const auto h :
+       {Hermiticity::kNone,
+        Hermiticity::kHermitian,
+        Hermiticity::kAntihermitian}) {
+    auto x_full = MakeTwoBodyOperator(ms, h, 0.3, false);
+    auto y_full = MakeTwoBodyOperator(ms, h, 0.8, false);
+    auto x_packed = MakeTwoBodyOperator(ms, h, 0.3, true);
+    auto y_packed = MakeTwoBodyOperator(ms, h, 0.8, true);
+    const auto y_ref = y_full;
+
+    // Reference norm from element access.
+    double ref = 0.0;
+    for (const auto ch : ms->ChannelIndices()) {
+      const auto& channel = ms->Channel(ch);
+      for (const auto i : channel.StateIndices()) {
+        for (const auto j : channel.StateIndices()) {
+          ref += (channel.QuantumNumbers().TwoJ() + 1) *
+                 std::pow(x_full.Get(ch, i, j), 2);
+        }
+      }
+    }
+    REQUIRE(nui::Norm(x_full) == Catch::Approx(std::sqrt(ref)));
+    REQUIRE(nui::Norm(x_packed) == Catch::Approx(std::sqrt(ref)));
+    double channel_ref = 0.0;
+    for (const auto ch : ms->ChannelIndices()) {
+      const double norm = nui::ChannelNorm(x_packed, ch);
+      REQUIRE(nui::ChannelNorm(x_full, ch) == Catch::Approx(norm));
+      channel_ref += (ms->ChannelQuantumNumbers(ch).TwoJ() + 1) * norm * norm;
+    }
+    REQUIRE(channel_ref == Catch::Approx(ref));
+
+    REQUIRE(nui::Axpby(0.5, x_full, -2.0, y_full));
+    REQUIRE(nui::Axpby(0.5, x_packed, -2.0, y_packed));
+    REQUIRE(nui::Axpy(1.5, x_full, y_full));
+    REQUIRE(nui::Axpy(1.5, x_packed, y_packed));
+    nui::Scale(0.25, y_full);
+    nui::Scale(0.25, y_packed);
+    for (const auto ch : ms->ChannelIndices()) {
+      for (const auto i : ms->Channel(ch).StateIndices()) {
+        for (const auto j : ms->Channel(ch).StateIndices()) {
+          const double expected =
+              0.5 * (x_full.Get(ch, i, j) - y_ref.Get(ch, i, j));
+          REQUIRE(y_full.Get(ch, i, j) == Catch::Approx(expected));
+          REQUIRE(y_packed.Get(ch, i, j) == Catch::Approx(expected));
+        }
+      }
+    }
+    REQUIRE(nui::Axpy(1.0, x_full, x_full));
+  }
+}
+
+TEST_CASE("TwoBodyKernels, Test incompatible operators are rejected.") {
+  const auto ms = MakeTwoBodyModelSpace(3);
+  const auto x = MakeTwoBodyOperator(ms, Hermiticity::kHermitian, 0.1, false);
+  auto y = MakeTwoBodyOperator(ms, Hermiticity::kHermitian, 0.1, true);
+  REQUIRE_FALSE(nui::Axpy(1.0, x, y));
+}
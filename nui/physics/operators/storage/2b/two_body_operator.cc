@@ -0,0 +1,141 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/2b/two_body_operator.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/coupling/coupling.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+
+namespace nui {
+
+namespace {
+
+std::vector<std::size_t> MakeDimensions(const TwoBodyModelSpace& ms) {
+  ms.BuildAllChannels();
+  std::vector<std::size_t> dims;
+  dims.reserve(ms.NumChannels());
+  for (const auto ch : ms.ChannelIndices()) {
+    dims.push_back(ms.Channel(ch).Dimension());
+  }
+  return dims;
+}
+
+std::vector<std::size_t> MakeBlockSizes(
+    const std::vector<std::size_t>& dims,
+    BlockLayout layout) {
+  std::vector<std::size_t> sizes;
+  sizes.reserve(dims.size());
+  for (const auto n : dims) {
+    sizes.push_back(StoredBlockSize(n, layout));
+  }
+  return sizes;
+}
+
+}  // namespace
+
+TwoBodyOperator::TwoBodyOperator(
+    std::shared_ptr<const TwoBodyModelSpace> ms,
+    Hermiticity hermiticity,
+    bool packed)
+    : ms_(std::move(ms)),
+      hermiticity_(hermiticity),
+      layout_(ChooseLayout(hermiticity, packed)),
+      dims_(MakeDimensions(*ms_)),
+      blocks_(MakeBlockSizes(dims_, layout_)) {}
+
+bool TwoBodyOperator::ReplaceBlocks(CowBlocks<double> blocks) {
+  if (blocks.NumBlocks() != blocks_.NumBlocks()) {
+    return false;
+  }
+  for (std::size_t b = 0; b < blocks.NumBlocks(); b += 1) {
+    if (blocks.BlockSize(b) != blocks_.BlockSize(b)) {
+      return false;
+    }
+  }
+  blocks_ = std::move(blocks);
+  return true;
+}
+
+bool TwoBodyOperator::Set(
+    TwoBodyChannelIndex ch,
+    TwoBodyStateIndex i,
+    TwoBodyStateIndex j,
+    double value) {
+  if (i == j && hermiticity_ == Hermiticity::kAntihermitian && value != 0.0) {
+    return false;
+  }
+  const std::size_t n = ChannelDimension(ch);
+  double* block = MutableBlock(ch);
+  if (IsPacked()) {
+    if (i <= j) {
+      block[PackedIndex(i.idx(), j.idx())] = value;
+    } else {
+      block[PackedIndex(j.idx(), i.idx())] =
+          HermiticitySign(hermiticity_) * value;
+    }
+    return true;
+  }
+  block[i.idx() * n + j.idx()] = value;
+  if (IsSymmetric(hermiticity_)) {
+    block[j.idx() * n + i.idx()] = HermiticitySign(hermiticity_) * value;
+  }
+  return true;
+}
+
+double TwoBodyOperator::Get(
+    TwoBodyChannelIndex ch,
+    OrbitalIndex a,
+    OrbitalIndex b,
+    OrbitalIndex c,
+    OrbitalIndex d) const {
+  const int two_j = ms_->ChannelQuantumNumbers(ch).TwoJ();
+  const auto& sp = ms_->SP();
+  double phase = 1.0;
+  if (a > b) {
+    std::swap(a, b);
+    phase *= SwapPhase(sp.Orbital(a).TwoJ(), sp.Orbital(b).TwoJ(), two_j);
+  }
+  if (c > d) {
+    std::swap(c, d);
+    phase *= SwapPhase(sp.Orbital(c).TwoJ(), sp.Orbital(d).TwoJ(), two_j);
+  }
+  const TwoBodyStateIndex i = ms_->StateIndex(ch, a, b);
+  const TwoBodyStateIndex j = ms_->StateIndex(ch, c, d);
+  if (i == TwoBodyStateIndex::Invalid() || j == TwoBodyStateIndex::Invalid()) {
+    return 0.0;
+  }
+  return phase * Get(ch, i, j);
+}
+
+void TwoBodyOperator::UnpackChannel(
+    TwoBodyChannelIndex ch,
+    double* full) const {
+  UnpackBlock(Block(ch), ChannelDimension(ch), StoredSymmetry(), full);
+}
+
+void TwoBodyOperator::PackChannel(TwoBodyChannelIndex ch, const double* full) {
+  PackBlock(full, ChannelDimension(ch), StoredSymmetry(), MutableBlock(ch));
+}
+
+}  // namespace nui
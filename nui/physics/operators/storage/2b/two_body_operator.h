@@ -0,0 +1,193 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_OPERATORS_STORAGE_2B_TWO_BODY_OPERATOR_H_
+#define NUI_PHYSICS_OPERATORS_STORAGE_2B_TWO_BODY_OPERATOR_H_
+
+// IWYU pragma: private, include "nui/physics/operators/storage/2b/op_2b.h"
+// IWYU pragma: friend "nui/physics/operators/storage/2b/.*\.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+
+namespace nui {
+
+// Scalar two-body operator <ab; J| O |cd; J> in a J-scheme two-body model
+// space.
+//
+// There is one dense block per (J, parity, Tz) channel, indexed by the
+// channel's state indices. All blocks of a fresh operator live in one
+// contiguous slab (see CowBlocks), so copies are O(1) and only written
+// channels are duplicated.
+//
+// (Anti)hermitian operators may store each block as a packed upper triangle
+// (BlockLayout::kPackedUpper), halving memory and traffic in element-wise
+// kernels. Contractions that need full matrices unpack one channel at a time
+// via UnpackChannel() and write results back via PackChannel().
+class TwoBodyOperator {
+ public:
+  // Construct zero operator.
+  //
+  // If packed and the operator is (anti)hermitian, only upper triangles are
+  // stored. This builds all channels of the model space.
+  TwoBodyOperator(
+      std::shared_ptr<const TwoBodyModelSpace> ms,
+      Hermiticity hermiticity,
+      bool packed = true);
+
+  // Get two-body model space.
+  const TwoBodyModelSpace& ModelSpace() const { return *ms_; }
+
+  // Get shared two-body model space.
+  const std::shared_ptr<const TwoBodyModelSpace>& ModelSpaceShared() const {
+    return ms_;
+  }
+
+  // Get symmetry under transposition.
+  Hermiticity Symmetry() const { return hermiticity_; }
+
+  // Get layout of stored blocks.
+  BlockLayout Layout() const { return layout_; }
+
+  // Check if blocks are packed upper triangles.
+  bool IsPacked() const { return layout_ == BlockLayout::kPackedUpper; }
+
+  // Get number of channels.
+  std::size_t NumChannels() const { return blocks_.NumBlocks(); }
+
+  // Get dimension n of n x n channel block.
+  std::size_t ChannelDimension(TwoBodyChannelIndex ch) const {
+    return dims_[ch.idx()];
+  }
+
+  // Get number of stored elements of channel block.
+  std::size_t ChannelSize(TwoBodyChannelIndex ch) const {
+    return blocks_.BlockSize(ch.idx());
+  }
+
+  // Get read-only stored channel block.
+  const double* Block(TwoBodyChannelIndex ch) const {
+    return blocks_.Block(ch.idx());
+  }
+
+  // Get writable stored channel block (duplicated first if shared).
+  double* MutableBlock(TwoBodyChannelIndex ch) {
+    return blocks_.MutableBlock(ch.idx());
+  }
+
+  // Get matrix element <i| O |j> of channel by state indices.
+  double Get(
+      TwoBodyChannelIndex ch,
+      TwoBodyStateIndex i,
+      TwoBodyStateIndex j) const {
+    return BlockElement(
+        Block(ch),
+        ChannelDimension(ch),
+        StoredSymmetry(),
+        i.idx(),
+        j.idx());
+  }
+
+  // Set matrix element <i| O |j> (and <j| O |i> consistent with hermiticity).
+  //
+  // Returns false (and does nothing) if i == j, the operator is
+  // antihermitian, and value != 0.
+  bool Set(
+      TwoBodyChannelIndex ch,
+      TwoBodyStateIndex i,
+      TwoBodyStateIndex j,
+      double value);
+
+  // Get <ab; J| O |cd; J> for any orbital order in channel ch.
+  //
+  // Orbitals are reordered with the phase of |ba; J> = -(-1)^(j_a + j_b - J)
+  // |ab; J>. Returns zero for states not in the channel.
+  double Get(
+      TwoBodyChannelIndex ch,
+      OrbitalIndex a,
+      OrbitalIndex b,
+      OrbitalIndex c,
+      OrbitalIndex d) const;
+
+  // Unpack channel into full row-major n x n matrix.
+  void UnpackChannel(TwoBodyChannelIndex ch, double* full) const;
+
+  // Overwrite channel with full row-major n x n matrix.
+  //
+  // For packed operators, only the upper triangle of full is read.
+  void PackChannel(TwoBodyChannelIndex ch, const double* full);
+
+  // Make block table unique, so that MutableBlock may be called in parallel
+  // on distinct channels.
+  void PrepareWrites() { blocks_.PrepareWrites(); }
+
+  // Get underlying block storage.
+  const CowBlocks<double>& Blocks() const { return blocks_; }
+
+  // Replace block storage (e.g., by blocks viewing a mapped file).
+  //
+  // Returns false (and does nothing) if block sizes do not match.
+  bool ReplaceBlocks(CowBlocks<double> blocks);
+
+  // Check if other operator has same model space, hermiticity, and layout.
+  bool IsCompatible(const TwoBodyOperator& other) const {
+    return ms_ == other.ms_ && hermiticity_ == other.hermiticity_ &&
+           layout_ == other.layout_;
+  }
+
+  // Get size of operator in dynamic memory (including shared blocks).
+  std::size_t MemoryLoad() const {
+    return blocks_.MemoryLoad() + dims_.size() * sizeof(std::size_t);
+  }
+
+  // Swap with other operator.
+  void swap(TwoBodyOperator& other) noexcept {
+    using std::swap;
+    swap(ms_, other.ms_);
+    swap(hermiticity_, other.hermiticity_);
+    swap(layout_, other.layout_);
+    swap(dims_, other.dims_);
+    swap(blocks_, other.blocks_);
+  }
+
+ private:
+  // Hermiticity describing the stored layout (none for full blocks).
+  Hermiticity StoredSymmetry() const {
+    return IsPacked() ? hermiticity_ : Hermiticity::kNone;
+  }
+
+  std::shared_ptr<const TwoBodyModelSpace> ms_;
+  Hermiticity hermiticity_ = Hermiticity::kNone;
+  BlockLayout layout_ = BlockLayout::kFull;
+  std::vector<std::size_t> dims_;
+  CowBlocks<double> blocks_;
+};
+
+// Swap two operators.
+inline void swap(TwoBodyOperator& a, TwoBodyOperator& b) noexcept {
+  a.swap(b);
+}
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_OPERATORS_STORAGE_2B_TWO_BODY_OPERATOR_H_
@@ -0,0 +1,138 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/2b/two_body_operator.h"
+
+#include "catch2/catch_test_macros.hpp"
+#include "nui/core/basics/basics.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+#include "nui/physics/operators/storage/testing/op_testing.h"
+
+namespace {
+
+using nui::Hermiticity;
+using nui::testing::Fill;
+using nui::testing::MakeTwoBodyModelSpace;
+
+}  // namespace
+
+TEST_CASE("TwoBodyOperator, Test packed storage halves memory.") {
+  const auto ms = MakeTwoBodyModelSpace(3);
+  const nui::TwoBodyOperator full(ms, Hermiticity::kHermitian, false);
+  const nui::TwoBodyOperator packed(ms, Hermiticity::kHermitian);
+  const nui::TwoBodyOperator general(ms, Hermiticity::kNone);
+  REQUIRE_FALSE(full.IsPacked());
+  REQUIRE(packed.IsPacked());
+  REQUIRE_FALSE(general.IsPacked());
+
+  std::size_t size_full = 0;
+  std::size_t size_packed = 0;
+  for (const auto ch : ms->ChannelIndices()) {
+    const std::size_t n = ms->Channel(ch).Dimension();
+    REQUIRE(full.ChannelDimension(ch) == n);
+    REQUIRE(full.ChannelSize(ch) == n * n);
+    REQUIRE(packed.ChannelSize(ch) == n * (n + 1) / 2);
+    size_full += full.ChannelSize(ch);
+    size_packed += packed.ChannelSize(ch);
+  }
+  REQUIRE(2 * size_packed > size_full);
+  REQUIRE(2 * size_packed < size_full + size_full / 10);
+  REQUIRE(packed.Blocks().TotalSize() == size_packed);
+}
+
+TEST_CASE("TwoBodyOperator, Test packed and full agree.") {
+  const auto ms = MakeTwoBodyModelSpace(3);
+  for (const auto h : {Hermiticity::kHermitian, Hermiticity::kAntihermitian}) {
+    nui::TwoBodyOperator full(ms, h, false);
+    nui::TwoBodyOperator packed(ms, h);
+    Fill(1.0, full);
+    Fill(1.0, packed);
+    for (const auto ch : ms->ChannelIndices()) {
+      const std::size_t n = ms->Channel(ch).Dimension();
+      std::vector<double> a(n * n);
+      std::vector<double> b(n * n);
+      full.UnpackChannel(ch, a.data());
+      packed.UnpackChannel(ch, b.data());
+      REQUIRE(a == b);
+      for (const auto i : ms->Channel(ch).StateIndices()) {
+        for (const auto j : ms->Channel(ch).StateIndices()) {
+          REQUIRE(full.Get(ch, i, j) == packed.Get(ch, i, j));
+          REQUIRE(
+              full.Get(ch, j, i) ==
+              nui::HermiticitySign(h) * full.Get(ch, i, j));
+        }
+      }
+
+      // Round trip through full block.
+      nui::TwoBodyOperator copy(ms, h);
+      copy.PackChannel(ch, b.data());
+      REQUIRE(
+          std::equal(
+              copy.Block(ch),
+              copy.Block(ch) + copy.ChannelSize(ch),
+              packed.Block(ch)));
+    }
+  }
+}
+
+TEST_CASE("TwoBodyOperator, Test orbital access with exchange phase.") {
+  const auto ms = MakeTwoBodyModelSpace(3);
+  nui::TwoBodyOperator op(ms, Hermiticity::kHermitian);
+  Fill(1.0, op);
+  for (const auto ch : ms->ChannelIndices()) {
+    const auto& channel = ms->Channel(ch);
+    const int two_j = channel.QuantumNumbers().TwoJ();
+    for (const auto i : channel.StateIndices()) {
+      const auto a = channel.First(i);
+      const auto b = channel.Second(i);
+      const int phase_ab =
+          ((ms->SP().Orbital(a).TwoJ() + ms->SP().Orbital(b).TwoJ() - two_j) /
+           2) % 2 == 0
+              ? -1
+              : 1;
+      for (const auto j : channel.StateIndices()) {
+        const auto c = channel.First(j);
+        const auto d = channel.Second(j);
+        REQUIRE(op.Get(ch, a, b, c, d) == op.Get(ch, i, j));
+        if (a != b) {
+          REQUIRE(op.Get(ch, b, a, c, d) == phase_ab * op.Get(ch, i, j));
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("TwoBodyOperator, Test copies are copy-on-write.") {
+  const auto ms = MakeTwoBodyModelSpace(3);
+  nui::TwoBodyOperator op(ms, Hermiticity::kHermitian);
+  Fill(1.0, op);
+  nui::ResetCowStatistics();
+  nui::TwoBodyOperator copy = op;
+  const nui::TwoBodyChannelIndex ch(0);
+  copy.Set(ch, 0UL, 0UL, -1.0);
+  REQUIRE(nui::GetCowStatistics().faults == 1);
+  REQUIRE(op.Get(ch, 0UL, 0UL) != -1.0);
+  REQUIRE(copy.Block(nui::TwoBodyChannelIndex(1)) ==
+          op.Block(nui::TwoBodyChannelIndex(1)));
+}
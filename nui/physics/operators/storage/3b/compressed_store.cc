@@ -0,0 +1,142 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/3b/compressed_store.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/memory/memory.h"
+#include "nui/info/runtime/runtime.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/operators/storage/3b/float_codec.h"
+#include "nui/physics/operators/storage/3b/three_body_operator.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+
+namespace nui {
+
+CompressedThreeBodyStore::CompressedThreeBodyStore(
+    std::shared_ptr<const ThreeBodyModelSpace> ms,
+    Hermiticity hermiticity,
+    BlockLayout layout,
+    FloatCodecOptions options)
+    : ms_(std::move(ms)),
+      hermiticity_(hermiticity),
+      layout_(layout),
+      options_(options),
+      sizes_(ms_->NumChannels()),
+      encoded_(ms_->NumChannels()) {}
+
+CompressedThreeBodyStore CompressedThreeBodyStore::FromOperator(
+    const ThreeBodyOperator& op,
+    FloatCodecOptions options) {
+  CompressedThreeBodyStore store(
+      op.ModelSpaceShared(),
+      op.Symmetry(),
+      op.Layout(),
+      options);
+  for (const auto ch : op.ModelSpace().ChannelIndices()) {
+    store.sizes_[ch.idx()] = op.ChannelSize(ch);
+  }
+
+  const std::ptrdiff_t num_channels =
+      static_cast<std::ptrdiff_t>(op.NumChannels());
+#pragma omp parallel for schedule(dynamic) num_threads(NumParallelThreads())
+  for (std::ptrdiff_t c = 0; c < num_channels; c += 1) {
+    const ThreeBodyChannelIndex ch(static_cast<std::size_t>(c));
+    if (!op.IsMaterialized(ch) || op.ChannelSize(ch) == 0) {
+      continue;
+    }
+    const ThreeBodyChannelView view = op.Read(ch);
+    CompressDoubles(
+        view.Data(),
+        op.ChannelSize(ch),
+        options,
+        store.encoded_[ch.idx()]);
+    store.encoded_[ch.idx()].shrink_to_fit();
+  }
+  return store;
+}
+
+std::size_t CompressedThreeBodyStore::TotalCompressedBytes() const {
+  std::size_t bytes = 0UL;
+  for (const auto ch : ms_->ChannelIndices()) {
+    bytes += CompressedBytes(ch);
+  }
+  return bytes;
+}
+
+std::size_t CompressedThreeBodyStore::TotalUncompressedBytes() const {
+  std::size_t bytes = 0UL;
+  for (const auto ch : ms_->ChannelIndices()) {
+    bytes += UncompressedBytes(ch);
+  }
+  return bytes;
+}
+
+double CompressedThreeBodyStore::CompressionRatio() const {
+  const std::size_t compressed = TotalCompressedBytes();
+  if (compressed == 0) {
+    return 1.0;
+  }
+  return static_cast<double>(TotalUncompressedBytes()) / compressed;
+}
+
+bool CompressedThreeBodyStore::DecodeChannel(
+    ThreeBodyChannelIndex ch,
+    double* out,
+    std::vector<std::uint8_t>& scratch) const {
+  const std::size_t size = ChannelSize(ch);
+  if (!HasChannel(ch)) {
+    std::fill(out, out + size, 0.0);
+    return true;
+  }
+  const auto& encoded = encoded_[ch.idx()];
+  return DecompressDoubles(encoded.data(), encoded.size(), out, size, scratch);
+}
+
+bool CompressedThreeBodyStore::ToOperator(ThreeBodyOperator& op) const {
+  if (op.ModelSpaceShared() != ms_ || op.Symmetry() != hermiticity_ ||
+      op.Layout() != layout_) {
+    return false;
+  }
+  bool ok = true;
+  const std::ptrdiff_t num_channels =
+      static_cast<std::ptrdiff_t>(NumChannels());
+#pragma omp parallel for schedule(dynamic) reduction(&& : ok) \
+    num_threads(NumParallelThreads())
+  for (std::ptrdiff_t c = 0; c < num_channels; c += 1) {
+    const ThreeBodyChannelIndex ch(static_cast<std::size_t>(c));
+    if (!HasChannel(ch)) {
+      continue;
+    }
+    std::vector<std::uint8_t> scratch;
+    const ThreeBodyChannelRef ref = op.Write(ch);
+    ok = DecodeChannel(ch, ref.MutableData(), scratch) && ok;
+  }
+  return ok;
+}
+
+std::size_t CompressedThreeBodyStore::MemoryLoad() const {
+  return TotalCompressedBytes() + sizes_.size() * sizeof(std::size_t) +
+         encoded_.size() * sizeof(std::vector<std::uint8_t>);
+}
+
+}  // namespace nui
@@ -0,0 +1,155 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_OPERATORS_STORAGE_3B_COMPRESSED_STORE_H_
+#define NUI_PHYSICS_OPERATORS_STORAGE_3B_COMPRESSED_STORE_H_
+
+// IWYU pragma: private, include "nui/physics/operators/storage/3b/op_3b.h"
+// IWYU pragma: friend "nui/physics/operators/storage/3b/.*\.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/memory/memory.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/operators/storage/3b/float_codec.h"
+#include "nui/physics/operators/storage/3b/three_body_operator.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+
+namespace nui {
+
+// Read-only three-body operator with every channel block compressed by the
+// float codec (see float_codec.h).
+//
+// The store keeps the layout (full or packed) of the operator it was built
+// from. Kernels stream through it with StreamChannels(), which decodes one
+// channel at a time into a reused buffer, so only the compressed data and one
+// decoded channel are in memory.
+class CompressedThreeBodyStore {
+ public:
+  // Compress all materialized channels of op (in parallel).
+  static CompressedThreeBodyStore FromOperator(
+      const ThreeBodyOperator& op,
+      FloatCodecOptions options = {});
+
+  // Get three-body model space.
+  const ThreeBodyModelSpace& ModelSpace() const { return *ms_; }
+
+  // Get symmetry under transposition.
+  Hermiticity Symmetry() const { return hermiticity_; }
+
+  // Get layout of decoded blocks.
+  BlockLayout Layout() const { return layout_; }
+
+  // Check if decoded blocks are packed upper triangles.
+  bool IsPacked() const { return layout_ == BlockLayout::kPackedUpper; }
+
+  // Get codec options used for compression.
+  const FloatCodecOptions& Options() const { return options_; }
+
+  // Get number of channels.
+  std::size_t NumChannels() const { return sizes_.size(); }
+
+  // Get number of stored elements of decoded channel block.
+  std::size_t ChannelSize(ThreeBodyChannelIndex ch) const {
+    return sizes_[ch.idx()];
+  }
+
+  // Check if channel holds data (was materialized in the source operator).
+  bool HasChannel(ThreeBodyChannelIndex ch) const {
+    return !encoded_[ch.idx()].empty();
+  }
+
+  // Get compressed size of channel in bytes.
+  std::size_t CompressedBytes(ThreeBodyChannelIndex ch) const {
+    return encoded_[ch.idx()].size();
+  }
+
+  // Get decoded size of channel in bytes (0 if channel holds no data).
+  std::size_t UncompressedBytes(ThreeBodyChannelIndex ch) const {
+    return HasChannel(ch) ? sizes_[ch.idx()] * sizeof(double) : 0UL;
+  }
+
+  // Get compressed size of all channels in bytes.
+  std::size_t TotalCompressedBytes() const;
+
+  // Get decoded size of all channels with data in bytes.
+  std::size_t TotalUncompressedBytes() const;
+
+  // Get ratio of decoded to compressed size.
+  double CompressionRatio() const;
+
+  // Decode channel into out (ChannelSize(ch) elements, zero if no data).
+  //
+  // scratch is reused between calls to avoid allocations. Returns false if
+  // the encoding is corrupt.
+  bool DecodeChannel(
+      ThreeBodyChannelIndex ch,
+      double* out,
+      std::vector<std::uint8_t>& scratch) const;
+
+  // Decode all channels into op, which must match model space, hermiticity,
+  // and layout. Returns false (after decoding what it can) on mismatch or
+  // corrupt data.
+  bool ToOperator(ThreeBodyOperator& op) const;
+
+  // Visit all channels with data in storage order.
+  //
+  // f(ThreeBodyChannelIndex ch, const double* block) is called with the
+  // decoded block, which is only valid during the call. Returns false if a
+  // channel could not be decoded.
+  template <typename F>
+  bool StreamChannels(F&& f) const {
+    AlignedVector<double> block;
+    std::vector<std::uint8_t> scratch;
+    for (const auto ch : ms_->ChannelIndices()) {
+      if (!HasChannel(ch)) {
+        continue;
+      }
+      block.resize(ChannelSize(ch));
+      if (!DecodeChannel(ch, block.data(), scratch)) {
+        return false;
+      }
+      f(ch, static_cast<const double*>(block.data()));
+    }
+    return true;
+  }
+
+  // Get size of store in dynamic memory.
+  std::size_t MemoryLoad() const;
+
+ private:
+  CompressedThreeBodyStore(
+      std::shared_ptr<const ThreeBodyModelSpace> ms,
+      Hermiticity hermiticity,
+      BlockLayout layout,
+      FloatCodecOptions options);
+
+  std::shared_ptr<const ThreeBodyModelSpace> ms_;
+  Hermiticity hermiticity_ = Hermiticity::kNone;
+  BlockLayout layout_ = BlockLayout::kFull;
+  FloatCodecOptions options_;
+  std::vector<std::size_t> sizes_;
+  std::vector<std::vector<std::uint8_t>> encoded_;
+};
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_OPERATORS_STORAGE_3B_COMPRESSED_STORE_H_
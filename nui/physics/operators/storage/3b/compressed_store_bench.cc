@@ -0,0 +1,146 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+
+#include "fmt/core.h"
+#include "nui/core/basics/basics.h"
+#include "nui/core/memory/memory.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/storage/3b/op_3b.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+
+// Benchmark of compressed three-body storage.
+//
+// Usage: nui_..._compressed_store_bench [emax] [e3max] [repeats]
+//
+// Fills a three-body operator with synthetic matrix elements (70% exact
+// zeros, magnitudes spread over a few decades) and reports compression ratio
+// and single-threaded decode throughput per channel, for the lossless codec
+// and a few error bounds.
+
+namespace {
+
+void FillSynthetic(nui::ThreeBodyOperator& op) {
+  std::mt19937_64 rng(1234);
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+  for (const auto ch : op.ModelSpace().ChannelIndices()) {
+    const auto ref = op.Write(ch);
+    double* data = ref.MutableData();
+    for (std::size_t i = 0; i < op.ChannelSize(ch); i += 1) {
+      data[i] = u(rng) < 0.3 ? (u(rng) - 0.5) * std::pow(10.0, -4.0 * u(rng))
+                             : 0.0;
+    }
+  }
+}
+
+double DecodeSeconds(
+    const nui::CompressedThreeBodyStore& store,
+    nui::ThreeBodyChannelIndex ch,
+    int repeats) {
+  nui::AlignedVector<double> block(store.ChannelSize(ch));
+  std::vector<std::uint8_t> scratch;
+  store.DecodeChannel(ch, block.data(), scratch);
+  const auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < repeats; r += 1) {
+    store.DecodeChannel(ch, block.data(), scratch);
+  }
+  const auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(stop - start).count() / repeats;
+}
+
+void Report(
+    const nui::ThreeBodyOperator& op,
+    double error_bound,
+    int repeats) {
+  const auto t0 = std::chrono::steady_clock::now();
+  const auto store =
+      nui::CompressedThreeBodyStore::FromOperator(op, {error_bound});
+  const auto t1 = std::chrono::steady_clock::now();
+
+  fmt::print("\nerror bound = {:g}\n", error_bound);
+  fmt::print(
+      "{:>6} {:>8} {:>12} {:>12} {:>8} {:>10}\n",
+      "ch",
+      "dim",
+      "raw [B]",
+      "comp [B]",
+      "ratio",
+      "dec GB/s");
+  double total_seconds = 0.0;
+  for (const auto ch : store.ModelSpace().ChannelIndices()) {
+    if (!store.HasChannel(ch)) {
+      continue;
+    }
+    const double seconds = DecodeSeconds(store, ch, repeats);
+    total_seconds += seconds;
+    const double raw = static_cast<double>(store.UncompressedBytes(ch));
+    fmt::print(
+        "{:>6} {:>8} {:>12} {:>12} {:>8.2f} {:>10.2f}\n",
+        ch.idx(),
+        op.ChannelDimension(ch),
+        store.UncompressedBytes(ch),
+        store.CompressedBytes(ch),
+        raw / store.CompressedBytes(ch),
+        raw / seconds * 1e-9);
+  }
+  const double raw = static_cast<double>(store.TotalUncompressedBytes());
+  fmt::print(
+      "total: raw = {} B, compressed = {} B, ratio = {:.2f}, "
+      "encode = {:.2f} GB/s, decode = {:.2f} GB/s\n",
+      store.TotalUncompressedBytes(),
+      store.TotalCompressedBytes(),
+      store.CompressionRatio(),
+      raw / std::chrono::duration<double>(t1 - t0).count() * 1e-9,
+      raw / total_seconds * 1e-9);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int emax = argc > 1 ? std::atoi(argv[1]) : 4;
+  const int e3max = argc > 2 ? std::atoi(argv[2]) : 6;
+  const int repeats = argc > 3 ? std::atoi(argv[3]) : 5;
+
+  const auto ms = nui::ThreeBodyModelSpace::Make(
+      nui::SPModelSpace::Make(
+          nui::SPTruncation(emax),
+          nui::Reference::HOEqualFilling(8, 8)),
+      nui::ThreeBodyTruncation(e3max));
+  nui::ThreeBodyOperator op(ms, nui::Hermiticity::kHermitian);
+  FillSynthetic(op);
+  fmt::print(
+      "emax = {}, e3max = {}, channels = {}, elements = {}\n",
+      emax,
+      e3max,
+      op.NumChannels(),
+      op.TotalSize());
+
+  for (const double error_bound : {0.0, 1e-10, 1e-8, 1e-6}) {
+    Report(op, error_bound, repeats);
+  }
+  return 0;
+}
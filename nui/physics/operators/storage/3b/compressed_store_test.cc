@@ -0,0 +1,117 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/3b/compressed_store.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "catch2/catch_test_macros.hpp"
+#include "nui/core/basics/basics.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/storage/3b/three_body_operator.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+#include "nui/physics/operators/storage/testing/op_testing.h"
+
+namespace {
+
+using nui::Hermiticity;
+using nui::testing::MakeThreeBodyModelSpace;
+
+// Fill every third element of every other channel.
+void FillSparse(nui::ThreeBodyOperator& op) {
+  for (const auto ch : op.ModelSpace().ChannelIndices()) {
+    if (ch.idx() % 2 == 1) {
+      continue;
+    }
+    const auto ref = op.Write(ch);
+    double* data = ref.MutableData();
+    for (std::size_t i = 0; i < op.ChannelSize(ch); i += 3) {
+      data[i] = 1e-3 * std::sin(1.0 + ch.idx() + 0.1 * i);
+    }
+  }
+}
+
+}  // namespace
+
+TEST_CASE("CompressedThreeBodyStore, Test lossless round trip.") {
+  const auto ms = MakeThreeBodyModelSpace(2, 4);
+  for (const bool packed : {true, false}) {
+    nui::ThreeBodyOperator op(ms, Hermiticity::kHermitian, {packed});
+    FillSparse(op);
+    const auto store = nui::CompressedThreeBodyStore::FromOperator(op);
+    REQUIRE(store.IsPacked() == packed);
+    REQUIRE(store.NumChannels() == op.NumChannels());
+    REQUIRE(store.CompressionRatio() > 1.0);
+
+    nui::ThreeBodyOperator copy(ms, Hermiticity::kHermitian, {packed});
+    REQUIRE(store.ToOperator(copy));
+    for (const auto ch : ms->ChannelIndices()) {
+      REQUIRE(store.HasChannel(ch) == op.IsMaterialized(ch));
+      if (!op.IsMaterialized(ch)) {
+        REQUIRE_FALSE(copy.IsMaterialized(ch));
+        continue;
+      }
+      REQUIRE(store.UncompressedBytes(ch) ==
+              op.ChannelSize(ch) * sizeof(double));
+      REQUIRE(std::memcmp(
+                  op.Read(ch).Data(),
+                  copy.Read(ch).Data(),
+                  op.ChannelSize(ch) * sizeof(double)) == 0);
+    }
+  }
+}
+
+TEST_CASE("CompressedThreeBodyStore, Test streaming channels.") {
+  const auto ms = MakeThreeBodyModelSpace(2, 4);
+  nui::ThreeBodyOperator op(ms, Hermiticity::kHermitian);
+  FillSparse(op);
+  const auto store =
+      nui::CompressedThreeBodyStore::FromOperator(op, {1e-10});
+
+  std::size_t visited = 0;
+  REQUIRE(store.StreamChannels(
+      [&](nui::ThreeBodyChannelIndex ch, const double* block) {
+        const auto view = op.Read(ch);
+        for (std::size_t i = 0; i < op.ChannelSize(ch); i += 1) {
+          REQUIRE(std::abs(view.Data()[i] - block[i]) <= 1e-10);
+        }
+        visited += 1;
+      }));
+  std::size_t materialized = 0;
+  for (const auto ch : ms->ChannelIndices()) {
+    materialized += op.IsMaterialized(ch) ? 1 : 0;
+  }
+  REQUIRE(visited == materialized);
+}
+
+TEST_CASE("CompressedThreeBodyStore, Test incompatible target.") {
+  const auto ms = MakeThreeBodyModelSpace(2, 4);
+  nui::ThreeBodyOperator op(ms, Hermiticity::kHermitian);
+  FillSparse(op);
+  const auto store = nui::CompressedThreeBodyStore::FromOperator(op);
+  nui::ThreeBodyOperator full(ms, Hermiticity::kHermitian, {false});
+  REQUIRE_FALSE(store.ToOperator(full));
+  nui::ThreeBodyOperator anti(ms, Hermiticity::kAntihermitian);
+  REQUIRE_FALSE(store.ToOperator(anti));
+}
@@ -0,0 +1,272 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/3b/float_codec.h"
+
+#include <cstring>
+
+#include "nui/core/basics/basics.h"
+
+namespace nui {
+
+namespace {
+
+constexpr std::size_t kMaxLiteral = 128;
+constexpr std::size_t kMinRun = 3;
+constexpr std::size_t kMaxRun = 130;
+
+template <typename T>
+void Append(std::vector<std::uint8_t>& out, const T& value) {
+  const auto* bytes = reinterpret_cast<const std::uint8_t*>(&value);
+  out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+bool Take(const std::uint8_t*& in, const std::uint8_t* end, T& value) {
+  if (static_cast<std::size_t>(end - in) < sizeof(T)) {
+    return false;
+  }
+  std::memcpy(&value, in, sizeof(T));
+  in += sizeof(T);
+  return true;
+}
+
+// Append size-prefixed run-length encoding of bytes.
+void EncodeRuns(
+    const std::uint8_t* bytes,
+    std::size_t n,
+    std::vector<std::uint8_t>& out) {
+  const std::size_t size_pos = out.size();
+  Append<std::uint64_t>(out, 0);
+  std::size_t i = 0;
+  std::size_t literal_begin = 0;
+  auto flush_literals = [&](std::size_t end) {
+    while (literal_begin < end) {
+      const std::size_t len = std::min(end - literal_begin, kMaxLiteral);
+      out.push_back(static_cast<std::uint8_t>(len - 1));
+      out.insert(
+          out.end(),
+          bytes + literal_begin,
+          bytes + literal_begin + len);
+      literal_begin += len;
+    }
+  };
+  while (i < n) {
+    std::size_t run = 1;
+    while (i + run < n && run < kMaxRun && bytes[i + run] == bytes[i]) {
+      run += 1;
+    }
+    if (run >= kMinRun) {
+      flush_literals(i);
+      out.push_back(static_cast<std::uint8_t>(128 + run - kMinRun));
+      out.push_back(bytes[i]);
+      i += run;
+      literal_begin = i;
+    } else {
+      i += run;
+    }
+  }
+  flush_literals(n);
+  const std::uint64_t size = out.size() - size_pos - sizeof(std::uint64_t);
+  std::memcpy(out.data() + size_pos, &size, sizeof(size));
+}
+
+// Decode size-prefixed run-length encoding of exactly n bytes.
+bool DecodeRuns(
+    const std::uint8_t*& in,
+    const std::uint8_t* end,
+    std::uint8_t* bytes,
+    std::size_t n) {
+  std::uint64_t size = 0;
+  if (!Take(in, end, size) || size > static_cast<std::size_t>(end - in)) {
+    return false;
+  }
+  const std::uint8_t* p = in;
+  const std::uint8_t* p_end = in + size;
+  std::size_t i = 0;
+  while (p < p_end) {
+    const std::uint8_t c = *p++;
+    if (c < 128) {
+      const std::size_t len = c + 1UL;
+      if (len > static_cast<std::size_t>(p_end - p) || len > n - i) {
+        return false;
+      }
+      std::memcpy(bytes + i, p, len);
+      p += len;
+      i += len;
+    } else {
+      const std::size_t len = c - 128UL + kMinRun;
+      if (p == p_end || len > n - i) {
+        return false;
+      }
+      std::memset(bytes + i, *p++, len);
+      i += len;
+    }
+  }
+  in = p_end;
+  return i == n;
+}
+
+// Round x to coarsest mantissa grid with |x - x'| <= error_bound.
+std::uint64_t Quantize(double x, double error_bound, int log2_bound) {
+  std::uint64_t bits = 0;
+  std::memcpy(&bits, &x, sizeof(x));
+  if (!std::isfinite(x)) {
+    return bits;
+  }
+  int exponent = 0;
+  std::frexp(x, &exponent);
+  // Spacing of the grid after dropping d bits is 2^(exponent - 53 + d).
+  const int drop = std::clamp(log2_bound - exponent + 54, 0, 52);
+  if (drop == 0) {
+    return bits;
+  }
+  const std::uint64_t half = 1ULL << (drop - 1);
+  const std::uint64_t mask = ~((1ULL << drop) - 1);
+  const std::uint64_t rounded = (bits + half) & mask;
+  double y = 0.0;
+  std::memcpy(&y, &rounded, sizeof(y));
+  return std::abs(y - x) <= error_bound ? rounded : bits;
+}
+
+}  // namespace
+
+void CompressDoubles(
+    const double* x,
+    std::size_t n,
+    FloatCodecOptions options,
+    std::vector<std::uint8_t>& out) {
+  const bool lossy = options.error_bound > 0.0;
+  const int log2_bound =
+      lossy ? static_cast<int>(std::floor(std::log2(options.error_bound)))
+            : 0;
+
+  std::vector<std::uint8_t> bitmap((n + 7) / 8, 0);
+  std::vector<std::uint64_t> values;
+  values.reserve(n);
+  for (std::size_t i = 0; i < n; i += 1) {
+    std::uint64_t bits = 0;
+    std::memcpy(&bits, &x[i], sizeof(bits));
+    if (lossy) {
+      if (std::abs(x[i]) <= options.error_bound) {
+        continue;
+      }
+      bits = Quantize(x[i], options.error_bound, log2_bound);
+    }
+    if (bits == 0) {
+      continue;
+    }
+    bitmap[i / 8] |= static_cast<std::uint8_t>(1U << (i % 8));
+    values.push_back(bits);
+  }
+
+  Append<std::uint64_t>(out, n);
+  Append<std::uint64_t>(out, values.size());
+  EncodeRuns(bitmap.data(), bitmap.size(), out);
+
+  const std::size_t nnz = values.size();
+  std::vector<std::uint8_t> plane(nnz);
+  for (std::size_t k = 0; k < sizeof(std::uint64_t); k += 1) {
+    for (std::size_t i = 0; i < nnz; i += 1) {
+      plane[i] = static_cast<std::uint8_t>(values[i] >> (8 * k));
+    }
+    EncodeRuns(plane.data(), nnz, out);
+  }
+}
+
+bool DecompressDoubles(
+    const std::uint8_t* in,
+    std::size_t size,
+    double* x,
+    std::size_t n,
+    std::vector<std::uint8_t>& scratch) {
+  const std::uint8_t* end = in + size;
+  std::uint64_t stored_n = 0;
+  std::uint64_t nnz = 0;
+  if (!Take(in, end, stored_n) || !Take(in, end, nnz) || stored_n != n ||
+      nnz > n) {
+    return false;
+  }
+  const std::size_t bitmap_size = (n + 7) / 8;
+  scratch.resize(bitmap_size + 16 * nnz);
+  std::uint8_t* bitmap = scratch.data();
+  std::uint8_t* planes = bitmap + bitmap_size;
+  std::uint8_t* values = planes + 8 * nnz;
+  if (!DecodeRuns(in, end, bitmap, bitmap_size)) {
+    return false;
+  }
+  for (std::size_t k = 0; k < 8; k += 1) {
+    if (!DecodeRuns(in, end, planes + k * nnz, nnz)) {
+      return false;
+    }
+  }
+  if (in != end) {
+    return false;
+  }
+
+  // Undo byte-plane shuffle.
+  for (std::size_t k = 0; k < 8; k += 1) {
+    const std::uint8_t* plane = planes + k * nnz;
+#pragma omp simd
+    for (std::size_t i = 0; i < nnz; i += 1) {
+      values[8 * i + k] = plane[i];
+    }
+  }
+
+  // Scatter by bitmap, copying whole bytes of the bitmap at once.
+  std::size_t next = 0;
+  for (std::size_t byte = 0; byte < bitmap_size; byte += 1) {
+    const std::size_t begin = 8 * byte;
+    const std::size_t len = std::min<std::size_t>(8, n - begin);
+    const std::uint8_t bits = bitmap[byte];
+    if (bits == 0) {
+      std::fill(x + begin, x + begin + len, 0.0);
+      continue;
+    }
+    const std::size_t count =
+        static_cast<std::size_t>(__builtin_popcount(bits));
+    if (count > nnz - next) {
+      return false;
+    }
+    if (bits == 0xFF && len == 8) {
+      std::memcpy(x + begin, values + 8 * next, 8 * sizeof(double));
+      next += 8;
+      continue;
+    }
+    for (std::size_t i = 0; i < len; i += 1) {
+      if ((bits >> i) & 0x1) {
+        std::memcpy(x + begin + i, values + 8 * next, sizeof(double));
+        next += 1;
+      } else {
+        x[begin + i] = 0.0;
+      }
+    }
+  }
+  return next == nnz;
+}
+
+std::size_t EncodedLength(const std::uint8_t* in, std::size_t size) {
+  std::uint64_t n = 0;
+  return Take(in, in + size, n) ? n : 0UL;
+}
+
+}  // namespace nui
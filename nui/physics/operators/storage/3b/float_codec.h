@@ -0,0 +1,84 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_OPERATORS_STORAGE_3B_FLOAT_CODEC_H_
+#define NUI_PHYSICS_OPERATORS_STORAGE_3B_FLOAT_CODEC_H_
+
+// IWYU pragma: private, include "nui/physics/operators/storage/3b/op_3b.h"
+// IWYU pragma: friend "nui/physics/operators/storage/3b/.*\.h"
+
+#include "nui/core/basics/basics.h"
+
+// Fast codec for arrays of doubles with many zeros and clustered exponents.
+//
+// Encoding runs in three stages:
+//
+// 1. A sparsity bitmap marks nonzero values (by bit pattern, so -0.0 and NaN
+//    survive). Only nonzero values are kept.
+// 2. The kept values are split into 8 byte planes (byte k of every value is
+//    stored contiguously), so sign/exponent bytes, which cluster strongly,
+//    form long runs.
+// 3. The bitmap and each plane are run-length encoded: a control byte c < 128
+//    is followed by c + 1 literal bytes, c >= 128 repeats the next byte
+//    c - 125 times.
+//
+// With a positive error bound, values with |x| <= error_bound are dropped
+// and the mantissa of the others is rounded to the coarsest grid with
+// |x - x'| <= error_bound, which zeroes the low mantissa planes. This is
+// lossy, but the error of every element is bounded.
+//
+// Decoding only needs a few passes over byte arrays and no tables, so it runs
+// at memory bandwidth rates.
+
+namespace nui {
+
+// Options for the float codec.
+struct FloatCodecOptions {
+  // Maximum absolute error per element (0 for lossless).
+  double error_bound = 0.0;
+};
+
+// Compress n doubles and append the encoding to out.
+void CompressDoubles(
+    const double* x,
+    std::size_t n,
+    FloatCodecOptions options,
+    std::vector<std::uint8_t>& out);
+
+// Decompress encoding of n doubles into x.
+//
+// scratch is resized as needed and can be reused between calls to avoid
+// allocations. Returns false if the encoding is malformed or does not hold n
+// values.
+bool DecompressDoubles(
+    const std::uint8_t* in,
+    std::size_t size,
+    double* x,
+    std::size_t n,
+    std::vector<std::uint8_t>& scratch);
+
+// Get number of values of encoding (0 if malformed).
+std::size_t EncodedLength(const std::uint8_t* in, std::size_t size);
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_OPERATORS_STORAGE_3B_FLOAT_CODEC_H_
@@ -0,0 +1,149 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/3b/float_codec.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+
+#include "catch2/catch_test_macros.hpp"
+#include "nui/core/basics/basics.h"
+
+namespace {
+
+std::vector<double> MakeSparse(std::size_t n, double density) {
+  std::mt19937_64 rng(42);
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+  std::vector<double> x(n, 0.0);
+  for (std::size_t i = 0; i < n; i += 1) {
+    if (u(rng) < density) {
+      x[i] = (u(rng) - 0.5) * std::pow(10.0, -6.0 * u(rng));
+    }
+  }
+  return x;
+}
+
+bool BitIdentical(const std::vector<double>& a, const std::vector<double>& b) {
+  return a.size() == b.size() &&
+         std::memcmp(a.data(), b.data(), a.size() * sizeof(double)) == 0;
+}
+
+}  // namespace
+
+TEST_CASE("FloatCodec, Test lossless round trip.") {
+  for (const std::size_t n : {0UL, 1UL, 7UL, 8UL, 9UL, 1000UL, 4097UL}) {
+    for (const double density : {0.0, 0.1, 0.5, 1.0}) {
+      const auto x = MakeSparse(n, density);
+      std::vector<std::uint8_t> encoded;
+      nui::CompressDoubles(x.data(), n, {}, encoded);
+      REQUIRE(nui::EncodedLength(encoded.data(), encoded.size()) == n);
+
+      std::vector<double> y(n, 1.0);
+      std::vector<std::uint8_t> scratch;
+      REQUIRE(nui::DecompressDoubles(
+          encoded.data(),
+          encoded.size(),
+          y.data(),
+          n,
+          scratch));
+      REQUIRE(BitIdentical(x, y));
+    }
+  }
+}
+
+TEST_CASE("FloatCodec, Test special values survive.") {
+  const std::vector<double> x = {
+      0.0,
+      -0.0,
+      std::numeric_limits<double>::quiet_NaN(),
+      std::numeric_limits<double>::infinity(),
+      -std::numeric_limits<double>::denorm_min(),
+      1.0,
+      0.0,
+      0.0,
+      0.0,
+      -1.0};
+  std::vector<std::uint8_t> encoded;
+  nui::CompressDoubles(x.data(), x.size(), {}, encoded);
+  std::vector<double> y(x.size());
+  std::vector<std::uint8_t> scratch;
+  REQUIRE(nui::DecompressDoubles(
+      encoded.data(),
+      encoded.size(),
+      y.data(),
+      y.size(),
+      scratch));
+  REQUIRE(BitIdentical(x, y));
+}
+
+TEST_CASE("FloatCodec, Test lossy error bound.") {
+  const std::size_t n = 5000;
+  const auto x = MakeSparse(n, 0.6);
+  for (const double eps : {1e-12, 1e-9, 1e-7}) {
+    std::vector<std::uint8_t> lossless;
+    std::vector<std::uint8_t> lossy;
+    nui::CompressDoubles(x.data(), n, {}, lossless);
+    nui::CompressDoubles(x.data(), n, {eps}, lossy);
+    REQUIRE(lossy.size() < lossless.size());
+
+    std::vector<double> y(n);
+    std::vector<std::uint8_t> scratch;
+    REQUIRE(nui::DecompressDoubles(
+        lossy.data(),
+        lossy.size(),
+        y.data(),
+        n,
+        scratch));
+    for (std::size_t i = 0; i < n; i += 1) {
+      REQUIRE(std::abs(x[i] - y[i]) <= eps);
+    }
+  }
+}
+
+TEST_CASE("FloatCodec, Test malformed input is rejected.") {
+  const auto x = MakeSparse(300, 0.5);
+  std::vector<std::uint8_t> encoded;
+  nui::CompressDoubles(x.data(), x.size(), {}, encoded);
+  std::vector<double> y(x.size());
+  std::vector<std::uint8_t> scratch;
+
+  // Wrong length.
+  REQUIRE_FALSE(nui::DecompressDoubles(
+      encoded.data(),
+      encoded.size(),
+      y.data(),
+      x.size() - 1,
+      scratch));
+
+  // Truncated.
+  for (const std::size_t size : {0UL, 4UL, 16UL, encoded.size() - 1}) {
+    REQUIRE_FALSE(nui::DecompressDoubles(
+        encoded.data(),
+        size,
+        y.data(),
+        x.size(),
+        scratch));
+  }
+  REQUIRE(nui::EncodedLength(encoded.data(), 4) == 0);
+}
@@ -0,0 +1,134 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/3b/three_body_kernels.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/info/runtime/runtime.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/operators/storage/3b/three_body_operator.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+
+namespace nui {
+
+double Norm(const ThreeBodyOperator& op) {
+  const std::ptrdiff_t num_channels =
+      static_cast<std::ptrdiff_t>(op.NumChannels());
+  double norm2 = 0.0;
+#pragma omp parallel for schedule(dynamic) reduction(+ : norm2) \
+    num_threads(NumParallelThreads())
+  for (std::ptrdiff_t c = 0; c < num_channels; c += 1) {
+    const ThreeBodyChannelIndex ch(static_cast<std::size_t>(c));
+    if (!op.IsMaterialized(ch)) {
+      continue;
+    }
+    const ThreeBodyChannelView view = op.Read(ch);
+    const double* block = view.Data();
+    const std::size_t size = op.ChannelSize(ch);
+    double sum = 0.0;
+#pragma omp simd reduction(+ : sum)
+    for (std::size_t i = 0; i < size; i += 1) {
+      sum += block[i] * block[i];
+    }
+    if (op.IsPacked()) {
+      // Off-diagonal elements appear twice in the full block.
+      double diag = 0.0;
+      for (std::size_t i = 0; i < op.ChannelDimension(ch); i += 1) {
+        diag += block[PackedIndex(i, i)] * block[PackedIndex(i, i)];
+      }
+      sum = 2.0 * sum - diag;
+    }
+    norm2 += (op.ModelSpace().Channel(ch).QuantumNumbers().TwoJ() + 1) * sum;
+  }
+  return std::sqrt(norm2);
+}
+
+void Scale(double alpha, ThreeBodyOperator& op) {
+  LinearCombination({}, {}, alpha, op);
+}
+
+bool Axpy(double alpha, const ThreeBodyOperator& x, ThreeBodyOperator& y) {
+  return LinearCombination({alpha}, {&x}, 1.0, y);
+}
+
+bool LinearCombination(
+    const std::vector<double>& alphas,
+    const std::vector<const ThreeBodyOperator*>& xs,
+    double beta,
+    ThreeBodyOperator& y) {
+  if (alphas.size() != xs.size()) {
+    return false;
+  }
+  std::vector<double> term_alphas;
+  std::vector<const ThreeBodyOperator*> terms;
+  for (std::size_t k = 0; k < xs.size(); k += 1) {
+    if (xs[k] == &y) {
+      beta += alphas[k];
+    } else if (!xs[k]->IsCompatible(y)) {
+      return false;
+    } else {
+      term_alphas.push_back(alphas[k]);
+      terms.push_back(xs[k]);
+    }
+  }
+
+  const std::ptrdiff_t num_channels =
+      static_cast<std::ptrdiff_t>(y.NumChannels());
+#pragma omp parallel num_threads(NumParallelThreads())
+  {
+    std::vector<double> active_alphas;
+    std::vector<ThreeBodyChannelView> views;
+    std::vector<const double*> blocks;
+#pragma omp for schedule(dynamic)
+    for (std::ptrdiff_t c = 0; c < num_channels; c += 1) {
+      const ThreeBodyChannelIndex ch(static_cast<std::size_t>(c));
+      active_alphas.clear();
+      views.clear();
+      blocks.clear();
+      for (std::size_t k = 0; k < terms.size(); k += 1) {
+        if (terms[k]->IsMaterialized(ch)) {
+          active_alphas.push_back(term_alphas[k]);
+          views.push_back(terms[k]->Read(ch));
+          blocks.push_back(views.back().Data());
+        }
+      }
+      if (blocks.empty() && !y.IsMaterialized(ch)) {
+        continue;
+      }
+      const ThreeBodyChannelRef ref = y.Write(ch);
+      CombineBlocks(
+          blocks.size(),
+          active_alphas.data(),
+          blocks.data(),
+          beta,
+          ref.MutableData(),
+          y.ChannelSize(ch));
+    }
+  }
+  return true;
+}
+
+bool Copy(const ThreeBodyOperator& x, ThreeBodyOperator& y) {
+  return LinearCombination({1.0}, {&x}, 0.0, y);
+}
+
+}  // namespace nui
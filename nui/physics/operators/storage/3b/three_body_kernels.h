@@ -0,0 +1,70 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_OPERATORS_STORAGE_3B_THREE_BODY_KERNELS_H_
+#define NUI_PHYSICS_OPERATORS_STORAGE_3B_THREE_BODY_KERNELS_H_
+
+// IWYU pragma: private, include "nui/physics/operators/storage/3b/op_3b.h"
+// IWYU pragma: friend "nui/physics/operators/storage/3b/.*\.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/operators/storage/3b/three_body_operator.h"
+
+// Element-wise kernels on three-body operators.
+//
+// Kernels run in parallel over channels and only touch materialized
+// channels: a channel of the result is materialized only if one of the
+// inputs contributes to it. Each thread pins only the channels it currently
+// works on, so a memory budget is respected.
+
+namespace nui {
+
+// Get Frobenius norm, sqrt(sum_J (2J + 1) sum_ij O_ij^2).
+double Norm(const ThreeBodyOperator& op);
+
+// Scale operator, op *= alpha.
+void Scale(double alpha, ThreeBodyOperator& op);
+
+// Add scaled operator, y += alpha * x.
+//
+// Returns false (and does nothing) if x and y are not compatible.
+bool Axpy(double alpha, const ThreeBodyOperator& x, ThreeBodyOperator& y);
+
+// Set linear combination, y = beta * y + sum_k alphas[k] * xs[k].
+//
+// This is a single fused pass: every x is read once and y is written once.
+// Terms with xs[k] == &y are folded into beta. Returns false (and does
+// nothing) if sizes differ or any x is not compatible with y.
+bool LinearCombination(
+    const std::vector<double>& alphas,
+    const std::vector<const ThreeBodyOperator*>& xs,
+    double beta,
+    ThreeBodyOperator& y);
+
+// Copy matrix elements, y = x.
+//
+// Returns false (and does nothing) if x and y are not compatible.
+bool Copy(const ThreeBodyOperator& x, ThreeBodyOperator& y);
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_OPERATORS_STORAGE_3B_THREE_BODY_KERNELS_H_
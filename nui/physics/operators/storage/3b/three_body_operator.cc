@@ -0,0 +1,280 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/3b/three_body_operator.h"
+
+#include <mutex>
+#include <stdexcept>
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/io/io.h"
+#include "nui/core/memory/memory.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+
+namespace nui {
+
+ThreeBodyChannelView::~ThreeBodyChannelView() {
+  if (op_ != nullptr) {
+    op_->Unpin(ch_);
+  }
+}
+
+ThreeBodyOperator::ThreeBodyOperator(
+    std::shared_ptr<const ThreeBodyModelSpace> ms,
+    Hermiticity hermiticity,
+    ThreeBodyStorageOptions options)
+    : ms_(std::move(ms)),
+      hermiticity_(hermiticity),
+      layout_(ChooseLayout(hermiticity, options.packed)),
+      offsets_(ms_->NumChannels() + 1, 0UL),
+      channels_(ms_->NumChannels()),
+      memory_budget_(options.memory_budget),
+      spill_directory_(std::move(options.spill_directory)) {
+  for (const auto ch : ms_->ChannelIndices()) {
+    offsets_[ch.idx() + 1] =
+        offsets_[ch.idx()] +
+        StoredBlockSize(ms_->Channel(ch).Dimension(), layout_);
+  }
+}
+
+ThreeBodyStorageOptions ThreeBodyOperator::Options() const {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return {IsPacked(), memory_budget_, spill_directory_};
+}
+
+bool ThreeBodyOperator::IsMaterialized(ThreeBodyChannelIndex ch) const {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return channels_[ch.idx()].materialized;
+}
+
+bool ThreeBodyOperator::IsResident(ThreeBodyChannelIndex ch) const {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return channels_[ch.idx()].resident;
+}
+
+ThreeBodyChannelView ThreeBodyOperator::Read(ThreeBodyChannelIndex ch) const {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return ThreeBodyChannelView(this, ch, PinLocked(ch, false));
+}
+
+ThreeBodyChannelRef ThreeBodyOperator::Write(ThreeBodyChannelIndex ch) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return ThreeBodyChannelRef(this, ch, PinLocked(ch, true));
+}
+
+double ThreeBodyOperator::Get(
+    ThreeBodyChannelIndex ch,
+    ThreeBodyStateIndex i,
+    ThreeBodyStateIndex j) const {
+  if (!IsMaterialized(ch)) {
+    return 0.0;
+  }
+  const ThreeBodyChannelView view = Read(ch);
+  return BlockElement(
+      view.Data(),
+      ChannelDimension(ch),
+      IsPacked() ? hermiticity_ : Hermiticity::kNone,
+      i.idx(),
+      j.idx());
+}
+
+bool ThreeBodyOperator::Set(
+    ThreeBodyChannelIndex ch,
+    ThreeBodyStateIndex i,
+    ThreeBodyStateIndex j,
+    double value) {
+  if (i == j && hermiticity_ == Hermiticity::kAntihermitian && value != 0.0) {
+    return false;
+  }
+  const std::size_t n = ChannelDimension(ch);
+  const ThreeBodyChannelRef ref = Write(ch);
+  double* block = ref.MutableData();
+  if (IsPacked()) {
+    if (i <= j) {
+      block[PackedIndex(i.idx(), j.idx())] = value;
+    } else {
+      block[PackedIndex(j.idx(), i.idx())] =
+          HermiticitySign(hermiticity_) * value;
+    }
+    return true;
+  }
+  block[i.idx() * n + j.idx()] = value;
+  if (IsSymmetric(hermiticity_)) {
+    block[j.idx() * n + i.idx()] = HermiticitySign(hermiticity_) * value;
+  }
+  return true;
+}
+
+bool ThreeBodyOperator::Evict(ThreeBodyChannelIndex ch) const {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return EvictLocked(ch);
+}
+
+void ThreeBodyOperator::EvictAll() const {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto ch : ms_->ChannelIndices()) {
+    EvictLocked(ch);
+  }
+}
+
+void ThreeBodyOperator::SetMemoryBudget(std::size_t bytes) const {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  memory_budget_ = bytes;
+  EnforceBudgetLocked();
+}
+
+std::size_t ThreeBodyOperator::ResidentMemory() const {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return resident_bytes_;
+}
+
+ThreeBodyStorageStats ThreeBodyOperator::Statistics() const {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+std::size_t ThreeBodyOperator::MemoryLoad() const {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return resident_bytes_ + offsets_.size() * sizeof(std::size_t) +
+         channels_.size() * sizeof(ChannelState);
+}
+
+double* ThreeBodyOperator::PinLocked(
+    ThreeBodyChannelIndex ch,
+    bool write) const {
+  ChannelState& state = channels_[ch.idx()];
+  const std::size_t size = ChannelSize(ch);
+  if (!state.resident) {
+    state.data.assign(size, 0.0);
+    if (state.spilled) {
+      if (!spill_.ReadAt(
+              ChannelOffset(ch) * sizeof(double),
+              state.data.data(),
+              size * sizeof(double))) {
+        AlignedVector<double>().swap(state.data);
+        throw std::runtime_error(
+            "Failed to read three-body channel back from spill file.");
+      }
+      stats_.reloads += 1;
+    } else {
+      stats_.materializations += 1;
+    }
+    state.materialized = true;
+    state.resident = true;
+    resident_bytes_ += size * sizeof(double);
+  }
+  UnlistLocked(ch.idx());
+  state.pins += 1;
+  state.dirty = state.dirty || write || !state.spilled;
+  EnforceBudgetLocked();
+  return state.data.data();
+}
+
+void ThreeBodyOperator::Unpin(ThreeBodyChannelIndex ch) const {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  ChannelState& state = channels_[ch.idx()];
+  state.pins -= 1;
+  if (state.pins == 0 && ChannelSize(ch) > 0) {
+    ListLocked(ch.idx());
+  }
+  EnforceBudgetLocked();
+}
+
+bool ThreeBodyOperator::EvictLocked(ThreeBodyChannelIndex ch) const {
+  ChannelState& state = channels_[ch.idx()];
+  if (!state.resident || state.pins > 0) {
+    return true;
+  }
+  const std::size_t bytes = ChannelSize(ch) * sizeof(double);
+  if (state.dirty) {
+    if (!EnsureSpillFileLocked() ||
+        !spill_.WriteAt(
+            ChannelOffset(ch) * sizeof(double),
+            state.data.data(),
+            bytes)) {
+      return false;
+    }
+    stats_.bytes_spilled += bytes;
+    state.spilled = true;
+    state.dirty = false;
+  }
+  UnlistLocked(ch.idx());
+  AlignedVector<double>().swap(state.data);
+  state.resident = false;
+  resident_bytes_ -= bytes;
+  stats_.evictions += 1;
+  return true;
+}
+
+void ThreeBodyOperator::EnforceBudgetLocked() const {
+  if (memory_budget_ == 0) {
+    return;
+  }
+  while (resident_bytes_ > memory_budget_) {
+    if (lru_head_ == kNoChannel || !EvictLocked(lru_head_)) {
+      return;
+    }
+  }
+}
+
+void ThreeBodyOperator::ListLocked(std::size_t c) const {
+  ChannelState& state = channels_[c];
+  state.lru_prev = lru_tail_;
+  state.lru_next = kNoChannel;
+  state.listed = true;
+  if (lru_tail_ == kNoChannel) {
+    lru_head_ = c;
+  } else {
+    channels_[lru_tail_].lru_next = c;
+  }
+  lru_tail_ = c;
+}
+
+void ThreeBodyOperator::UnlistLocked(std::size_t c) const {
+  ChannelState& state = channels_[c];
+  if (!state.listed) {
+    return;
+  }
+  if (state.lru_prev == kNoChannel) {
+    lru_head_ = state.lru_next;
+  } else {
+    channels_[state.lru_prev].lru_next = state.lru_next;
+  }
+  if (state.lru_next == kNoChannel) {
+    lru_tail_ = state.lru_prev;
+  } else {
+    channels_[state.lru_next].lru_prev = state.lru_prev;
+  }
+  state.lru_prev = kNoChannel;
+  state.lru_next = kNoChannel;
+  state.listed = false;
+}
+
+bool ThreeBodyOperator::EnsureSpillFileLocked() const {
+  if (!spill_.IsValid()) {
+    spill_ = SpillFile(spill_directory_);
+  }
+  return spill_.IsValid();
+}
+
+}  // namespace nui
@@ -0,0 +1,326 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_OPERATORS_STORAGE_3B_THREE_BODY_OPERATOR_H_
+#define NUI_PHYSICS_OPERATORS_STORAGE_3B_THREE_BODY_OPERATOR_H_
+
+// IWYU pragma: private, include "nui/physics/operators/storage/3b/op_3b.h"
+// IWYU pragma: friend "nui/physics/operators/storage/3b/.*\.h"
+
+#include <mutex>
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/io/io.h"
+#include "nui/core/memory/memory.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+
+namespace nui {
+
+// Options for three-body operator storage.
+struct ThreeBodyStorageOptions {
+  // Store packed upper triangles for (anti)hermitian operators.
+  bool packed = true;
+  // Maximum bytes of channel data kept in memory (0 for no limit).
+  std::size_t memory_budget = 0UL;
+  // Directory for the spill file of evicted channels.
+  std::string spill_directory = TempDirectoryRoot();
+};
+
+// Counters of three-body channel residency.
+struct ThreeBodyStorageStats {
+  // Channels allocated (zero-filled) on first touch.
+  std::size_t materializations = 0UL;
+  // Channels evicted from memory.
+  std::size_t evictions = 0UL;
+  // Bytes written to the spill file.
+  std::size_t bytes_spilled = 0UL;
+  // Channels read back from the spill file.
+  std::size_t reloads = 0UL;
+};
+
+class ThreeBodyOperator;
+
+// Pinned, read-only view of a three-body channel block.
+//
+// The channel stays in memory while any pin on it exists.
+class ThreeBodyChannelView {
+ public:
+  ThreeBodyChannelView(const ThreeBodyChannelView&) = delete;
+  ThreeBodyChannelView& operator=(const ThreeBodyChannelView&) = delete;
+  ThreeBodyChannelView(ThreeBodyChannelView&& other) noexcept
+      : op_(other.op_), ch_(other.ch_), data_(other.data_) {
+    other.op_ = nullptr;
+  }
+  ThreeBodyChannelView& operator=(ThreeBodyChannelView&&) = delete;
+  ~ThreeBodyChannelView();
+
+  // Get channel index.
+  ThreeBodyChannelIndex Channel() const { return ch_; }
+
+  // Get stored block (full or packed, see ThreeBodyOperator::IsPacked()).
+  const double* Data() const { return data_; }
+
+ protected:
+  friend class ThreeBodyOperator;
+  ThreeBodyChannelView(
+      const ThreeBodyOperator* op,
+      ThreeBodyChannelIndex ch,
+      double* data)
+      : op_(op), ch_(ch), data_(data) {}
+
+  const ThreeBodyOperator* op_ = nullptr;
+  ThreeBodyChannelIndex ch_;
+  double* data_ = nullptr;
+};
+
+// Pinned, writable view of a three-body channel block.
+class ThreeBodyChannelRef : public ThreeBodyChannelView {
+ public:
+  ThreeBodyChannelRef(ThreeBodyChannelRef&&) noexcept = default;
+
+  // Get writable stored block.
+  double* MutableData() const { return data_; }
+
+ private:
+  friend class ThreeBodyOperator;
+  ThreeBodyChannelRef(
+      const ThreeBodyOperator* op,
+      ThreeBodyChannelIndex ch,
+      double* data)
+      : ThreeBodyChannelView(op, ch, data) {}
+};
+
+// Scalar three-body operator in a J-scheme three-body model space.
+//
+// Matrix elements are stored between the antisymmetrized,
+// permutation-canonical states |(ab) J_ab, c; J> of the model space, one
+// dense (full or packed upper) block per channel. Channel sizes and offsets
+// in storage order are computed once at construction.
+//
+// Channels are materialized lazily: no memory is allocated for a channel
+// before it is first accessed through Read() or Write(). With a memory
+// budget, the least recently used unpinned channels are evicted to an
+// anonymous spill file (at their storage offset) once the resident data
+// exceeds the budget, and are read back transparently on the next access.
+// Unpinned resident channels are kept in a least recently used list, so
+// choosing the next channel to evict takes constant time.
+// Pins (ThreeBodyChannelView/Ref) keep a channel resident, so the budget may
+// be exceeded temporarily while many channels are pinned.
+//
+// Residency bookkeeping and spill I/O are serialized by one mutex; access to
+// pinned data is not. Threads may write distinct channels concurrently.
+//
+// Kernels should stream through channels in storage order with
+// StreamChannels() and skip channels that were never materialized.
+class ThreeBodyOperator {
+ public:
+  // Construct zero operator (no channel is allocated).
+  ThreeBodyOperator(
+      std::shared_ptr<const ThreeBodyModelSpace> ms,
+      Hermiticity hermiticity,
+      ThreeBodyStorageOptions options = {});
+
+  ThreeBodyOperator(const ThreeBodyOperator&) = delete;
+  ThreeBodyOperator& operator=(const ThreeBodyOperator&) = delete;
+
+  // Get three-body model space.
+  const ThreeBodyModelSpace& ModelSpace() const { return *ms_; }
+
+  // Get shared three-body model space.
+  const std::shared_ptr<const ThreeBodyModelSpace>& ModelSpaceShared() const {
+    return ms_;
+  }
+
+  // Get symmetry under transposition.
+  Hermiticity Symmetry() const { return hermiticity_; }
+
+  // Check if blocks are packed upper triangles.
+  bool IsPacked() const { return layout_ == BlockLayout::kPackedUpper; }
+
+  // Get layout of stored blocks.
+  BlockLayout Layout() const { return layout_; }
+
+  // Get storage options (with the current memory budget).
+  ThreeBodyStorageOptions Options() const;
+
+  // Get number of channels.
+  std::size_t NumChannels() const { return channels_.size(); }
+
+  // Get dimension n of n x n channel block.
+  std::size_t ChannelDimension(ThreeBodyChannelIndex ch) const {
+    return ms_->Channel(ch).Dimension();
+  }
+
+  // Get number of stored elements of channel block.
+  std::size_t ChannelSize(ThreeBodyChannelIndex ch) const {
+    return offsets_[ch.idx() + 1] - offsets_[ch.idx()];
+  }
+
+  // Get offset (in elements) of channel block in storage order.
+  std::size_t ChannelOffset(ThreeBodyChannelIndex ch) const {
+    return offsets_[ch.idx()];
+  }
+
+  // Get number of stored elements of all channels.
+  std::size_t TotalSize() const { return offsets_.back(); }
+
+  // Check if other has the same model space, hermiticity, and layout.
+  bool IsCompatible(const ThreeBodyOperator& other) const {
+    return ms_ == other.ms_ && hermiticity_ == other.hermiticity_ &&
+           layout_ == other.layout_;
+  }
+
+  // Check if channel has been touched (it may be resident or spilled).
+  bool IsMaterialized(ThreeBodyChannelIndex ch) const;
+
+  // Check if channel is currently in memory.
+  bool IsResident(ThreeBodyChannelIndex ch) const;
+
+  // Get pinned read-only view of channel, materializing it if needed.
+  //
+  // Throws std::runtime_error if the channel was evicted and cannot be read
+  // back from the spill file. The channel then stays evicted.
+  ThreeBodyChannelView Read(ThreeBodyChannelIndex ch) const;
+
+  // Get pinned writable view of channel, materializing it if needed.
+  //
+  // Throws std::runtime_error like Read().
+  ThreeBodyChannelRef Write(ThreeBodyChannelIndex ch);
+
+  // Get matrix element <i| O |j> of channel (zero if not materialized).
+  double Get(
+      ThreeBodyChannelIndex ch,
+      ThreeBodyStateIndex i,
+      ThreeBodyStateIndex j) const;
+
+  // Set matrix element <i| O |j> (and <j| O |i> consistent with hermiticity).
+  //
+  // Returns false (and does nothing) if i == j, the operator is
+  // antihermitian, and value != 0.
+  bool Set(
+      ThreeBodyChannelIndex ch,
+      ThreeBodyStateIndex i,
+      ThreeBodyStateIndex j,
+      double value);
+
+  // Visit all materialized channels in storage order.
+  //
+  // f(ThreeBodyChannelIndex ch, const double* block) is called with the
+  // channel pinned only for the duration of the call, so a memory budget is
+  // respected while streaming.
+  template <typename F>
+  void StreamChannels(F&& f) const {
+    for (const auto ch : ms_->ChannelIndices()) {
+      if (!IsMaterialized(ch)) {
+        continue;
+      }
+      const ThreeBodyChannelView view = Read(ch);
+      f(ch, view.Data());
+    }
+  }
+
+  // Visit all channels in storage order for writing, materializing them.
+  //
+  // f(ThreeBodyChannelIndex ch, double* block) is called with the channel
+  // pinned only for the duration of the call.
+  template <typename F>
+  void StreamChannelsMutable(F&& f) {
+    for (const auto ch : ms_->ChannelIndices()) {
+      const ThreeBodyChannelRef ref = Write(ch);
+      f(ch, ref.MutableData());
+    }
+  }
+
+  // Evict channel to the spill file (no effect if pinned or not resident).
+  //
+  // Returns false if the channel had to be kept in memory because the spill
+  // file could not be written.
+  bool Evict(ThreeBodyChannelIndex ch) const;
+
+  // Evict all unpinned resident channels.
+  void EvictAll() const;
+
+  // Set memory budget in bytes (0 for no limit) and evict to meet it.
+  void SetMemoryBudget(std::size_t bytes) const;
+
+  // Get bytes of channel data currently in memory.
+  std::size_t ResidentMemory() const;
+
+  // Get residency counters.
+  ThreeBodyStorageStats Statistics() const;
+
+  // Get size of operator in dynamic memory (resident channels and metadata).
+  std::size_t MemoryLoad() const;
+
+ private:
+  friend class ThreeBodyChannelView;
+
+  static constexpr std::size_t kNoChannel = SIZE_MAX;
+
+  struct ChannelState {
+    AlignedVector<double> data;
+    bool materialized = false;
+    bool resident = false;
+    // Spill file holds the current content.
+    bool spilled = false;
+    // Resident content differs from spilled content.
+    bool dirty = false;
+    int pins = 0;
+    // Neighbors in the least recently used list of unpinned resident
+    // channels (kNoChannel at the ends or if not listed).
+    std::size_t lru_prev = kNoChannel;
+    std::size_t lru_next = kNoChannel;
+    bool listed = false;
+  };
+
+  // All private members below expect mutex_ to be held.
+  double* PinLocked(ThreeBodyChannelIndex ch, bool write) const;
+  void Unpin(ThreeBodyChannelIndex ch) const;
+  bool EvictLocked(ThreeBodyChannelIndex ch) const;
+  void EnforceBudgetLocked() const;
+  bool EnsureSpillFileLocked() const;
+  // Append channel as most recently used to the list.
+  void ListLocked(std::size_t c) const;
+  // Remove channel from the list (no effect if not listed).
+  void UnlistLocked(std::size_t c) const;
+
+  std::shared_ptr<const ThreeBodyModelSpace> ms_;
+  Hermiticity hermiticity_ = Hermiticity::kNone;
+  BlockLayout layout_ = BlockLayout::kFull;
+  std::vector<std::size_t> offsets_;
+
+  mutable std::mutex mutex_;
+  mutable std::vector<ChannelState> channels_;
+  mutable std::size_t memory_budget_ = 0UL;
+  mutable std::size_t resident_bytes_ = 0UL;
+  // Least recently used unpinned resident channel, and most recently used.
+  mutable std::size_t lru_head_ = kNoChannel;
+  mutable std::size_t lru_tail_ = kNoChannel;
+  std::string spill_directory_;
+  mutable SpillFile spill_;
+  mutable ThreeBodyStorageStats stats_;
+};
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_OPERATORS_STORAGE_3B_THREE_BODY_OPERATOR_H_
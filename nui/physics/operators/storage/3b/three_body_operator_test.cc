@@ -0,0 +1,220 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/3b/three_body_operator.h"
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <stdexcept>
+
+#include "catch2/catch_test_macros.hpp"
+#include "nui/core/basics/basics.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+#include "nui/physics/operators/storage/testing/op_testing.h"
+
+namespace {
+
+using nui::Hermiticity;
+using nui::testing::Element;
+using nui::testing::Fill;
+using nui::testing::MakeThreeBodyModelSpace;
+
+// Truncate all open spill files of this process to zero bytes.
+std::size_t TruncateSpillFiles() {
+  std::size_t num = 0;
+  for (const auto& entry :
+       std::filesystem::directory_iterator("/proc/self/fd")) {
+    std::error_code ec;
+    const auto target = std::filesystem::read_symlink(entry.path(), ec);
+    if (ec || target.filename().string().rfind("nui_spill_", 0) != 0) {
+      continue;
+    }
+    const int fd = std::stoi(entry.path().filename().string());
+    num += ::ftruncate(fd, 0) == 0 ? 1 : 0;
+  }
+  return num;
+}
+
+}  // namespace
+
+TEST_CASE("ThreeBodyOperator, Test offsets and sizes.") {
+  const auto ms = MakeThreeBodyModelSpace(2, 4);
+  const nui::ThreeBodyOperator packed(ms, Hermiticity::kHermitian);
+  const nui::ThreeBodyOperator full(ms, Hermiticity::kHermitian, {false});
+  REQUIRE(packed.IsPacked());
+  REQUIRE_FALSE(full.IsPacked());
+  std::size_t offset = 0;
+  for (const auto ch : ms->ChannelIndices()) {
+    const std::size_t n = ms->Channel(ch).Dimension();
+    REQUIRE(packed.ChannelOffset(ch) == offset);
+    REQUIRE(packed.ChannelSize(ch) == n * (n + 1) / 2);
+    REQUIRE(full.ChannelSize(ch) == n * n);
+    offset += packed.ChannelSize(ch);
+  }
+  REQUIRE(packed.TotalSize() == offset);
+}
+
+TEST_CASE("ThreeBodyOperator, Test lazy materialization.") {
+  const auto ms = MakeThreeBodyModelSpace(2, 4);
+  nui::ThreeBodyOperator op(ms, Hermiticity::kHermitian);
+  REQUIRE(op.ResidentMemory() == 0);
+  const nui::ThreeBodyChannelIndex ch(1);
+  REQUIRE(op.Get(ch, 0UL, 0UL) == 0.0);
+  REQUIRE_FALSE(op.IsMaterialized(ch));
+
+  REQUIRE(op.Set(ch, 0UL, 1UL, 2.0));
+  REQUIRE(op.IsMaterialized(ch));
+  REQUIRE(op.ResidentMemory() == op.ChannelSize(ch) * sizeof(double));
+  REQUIRE(op.Get(ch, 1UL, 0UL) == 2.0);
+  REQUIRE(op.Statistics().materializations == 1);
+
+  std::size_t visited = 0;
+  op.StreamChannels([&](nui::ThreeBodyChannelIndex c, const double*) {
+    REQUIRE(c == ch);
+    visited += 1;
+  });
+  REQUIRE(visited == 1);
+}
+
+TEST_CASE("ThreeBodyOperator, Test eviction under memory budget.") {
+  const auto ms = MakeThreeBodyModelSpace(2, 4);
+  nui::ThreeBodyOperator op(ms, Hermiticity::kAntihermitian);
+  std::size_t max_channel = 0;
+  for (const auto ch : ms->ChannelIndices()) {
+    op.Write(ch);
+    max_channel = std::max(max_channel, op.ChannelSize(ch) * sizeof(double));
+    const std::size_t n = op.ChannelDimension(ch);
+    for (std::size_t i = 0; i < n; i += 1) {
+      for (std::size_t j = i + 1; j < n; j += 1) {
+        op.Set(ch, i, j, Element(1.0, ch.idx(), i, j));
+      }
+    }
+  }
+  const std::size_t total = op.TotalSize() * sizeof(double);
+  REQUIRE(op.ResidentMemory() == total);
+
+  const std::size_t budget = total / 4;
+  op.SetMemoryBudget(budget);
+  REQUIRE(op.ResidentMemory() <= budget);
+  REQUIRE(op.Statistics().evictions > 0);
+
+  // Streaming respects the budget and reads spilled data back.
+  std::size_t max_resident = 0;
+  op.StreamChannels([&](nui::ThreeBodyChannelIndex ch, const double*) {
+    const std::size_t n = op.ChannelDimension(ch);
+    for (std::size_t i = 0; i < n; i += 1) {
+      for (std::size_t j = i + 1; j < n; j += 1) {
+        REQUIRE(op.Get(ch, i, j) == Element(1.0, ch.idx(), i, j));
+        REQUIRE(op.Get(ch, j, i) == -Element(1.0, ch.idx(), i, j));
+      }
+    }
+    max_resident = std::max(max_resident, op.ResidentMemory());
+  });
+  REQUIRE(op.Statistics().reloads > 0);
+  REQUIRE(max_resident <= budget + max_channel);
+
+  op.EvictAll();
+  REQUIRE(op.ResidentMemory() == 0);
+  REQUIRE(op.Get(0UL, 0UL, 1UL) == Element(1.0, 0, 0, 1));
+}
+
+TEST_CASE("ThreeBodyOperator, Test pinned channels are not evicted.") {
+  const auto ms = MakeThreeBodyModelSpace(2, 4);
+  nui::ThreeBodyOperator op(ms, Hermiticity::kHermitian);
+  Fill(1.0, op);
+  const nui::ThreeBodyChannelIndex ch(0);
+  {
+    const auto view = op.Read(ch);
+    const std::vector<double> before(
+        view.Data(),
+        view.Data() + op.ChannelSize(ch));
+    op.EvictAll();
+    REQUIRE(op.IsResident(ch));
+    REQUIRE(std::equal(before.begin(), before.end(), view.Data()));
+  }
+  op.EvictAll();
+  REQUIRE_FALSE(op.IsResident(ch));
+  REQUIRE(op.IsMaterialized(ch));
+}
+
+TEST_CASE("ThreeBodyOperator, Test concurrent writes with budget.") {
+  const auto ms = MakeThreeBodyModelSpace(2, 4);
+  nui::ThreeBodyOperator op(ms, Hermiticity::kNone);
+  op.SetMemoryBudget(op.TotalSize() * sizeof(double) / 8);
+  const std::ptrdiff_t num_channels =
+      static_cast<std::ptrdiff_t>(op.NumChannels());
+#pragma omp parallel for schedule(dynamic)
+  for (std::ptrdiff_t c = 0; c < num_channels; c += 1) {
+    const auto ref = op.Write(static_cast<std::size_t>(c));
+    const std::size_t size = op.ChannelSize(static_cast<std::size_t>(c));
+    for (std::size_t i = 0; i < size; i += 1) {
+      ref.MutableData()[i] = static_cast<double>(c) + i;
+    }
+  }
+  bool ok = true;
+  op.StreamChannels([&](nui::ThreeBodyChannelIndex ch, const double* data) {
+    for (std::size_t i = 0; i < op.ChannelSize(ch); i += 1) {
+      ok = ok && data[i] == static_cast<double>(ch.idx()) + i;
+    }
+  });
+  REQUIRE(ok);
+}
+
+TEST_CASE("ThreeBodyOperator, Test truncated spill file.") {
+  const auto ms = MakeThreeBodyModelSpace(2, 4);
+  nui::ThreeBodyOperator op(ms, Hermiticity::kHermitian);
+  Fill(1.0, op);
+  op.EvictAll();
+  const auto before = op.Statistics();
+  REQUIRE(before.bytes_spilled > 0);
+  REQUIRE(TruncateSpillFiles() == 1);
+
+  const nui::ThreeBodyChannelIndex ch(0);
+  REQUIRE_THROWS_AS(op.Read(ch), std::runtime_error);
+  REQUIRE_THROWS_AS(op.Get(ch, 0UL, 1UL), std::runtime_error);
+  REQUIRE_FALSE(op.IsResident(ch));
+  REQUIRE(op.IsMaterialized(ch));
+  REQUIRE(op.ResidentMemory() == 0);
+  REQUIRE(op.Statistics().reloads == before.reloads);
+}
+
+TEST_CASE("ThreeBodyOperator, Test least recently used eviction.") {
+  const auto ms = MakeThreeBodyModelSpace(2, 4);
+  nui::ThreeBodyOperator op(ms, Hermiticity::kHermitian);
+  Fill(1.0, op);
+  const nui::ThreeBodyChannelIndex first(0);
+  const nui::ThreeBodyChannelIndex last(op.NumChannels() - 1);
+  // Touch the first channel last, so it is evicted last.
+  op.Read(first);
+  op.SetMemoryBudget(
+      std::max(op.ChannelSize(first), op.ChannelSize(last)) * sizeof(double));
+  REQUIRE(op.IsResident(first));
+  REQUIRE_FALSE(op.IsResident(last));
+  REQUIRE(op.ResidentMemory() == op.ChannelSize(first) * sizeof(double));
+
+  op.Read(last);
+  REQUIRE(op.IsResident(last));
+  REQUIRE_FALSE(op.IsResident(first));
+}
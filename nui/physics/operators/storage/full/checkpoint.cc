@@ -0,0 +1,552 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/full/checkpoint.h"
+
+#include <dirent.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/io/io.h"
+#include "nui/info/profiling/profiling.h"
+#include "nui/info/runtime/runtime.h"
+#include "nui/physics/operators/storage/1b/op_1b.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+#include "nui/physics/operators/storage/3b/op_3b.h"
+#include "nui/physics/operators/storage/full/operator.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+
+namespace nui {
+
+namespace {
+
+constexpr char kMagic[8] = "NUICKP1";
+constexpr std::uint32_t kFormatVersion = 1;
+constexpr std::string_view kExtension = ".nuickpt";
+constexpr std::size_t kNameSize = 32;
+
+// Table entry of an operator. Its blocks are the 1-body blocks, then the
+// 2-body channels, then the 3-body channels.
+struct OperatorEntry {
+  char name[kNameSize];
+  double zero_body;
+  std::uint8_t hermiticity;
+  std::uint8_t layout_2b;
+  std::uint8_t has_three_body;
+  std::uint8_t layout_3b;
+  std::uint32_t padding;
+  std::uint64_t first_block;
+  std::uint64_t num_one_body;
+  std::uint64_t num_two_body;
+  std::uint64_t num_three_body;
+};
+
+static_assert(sizeof(OperatorEntry) == 80);
+
+// Table entry of a block (stored == 0 for 3-body channels never touched).
+struct BlockEntry {
+  std::uint64_t offset;
+  std::uint64_t size;
+  std::uint64_t checksum;
+  std::uint64_t stored;
+};
+
+static_assert(sizeof(BlockEntry) == 32);
+
+// Fixed-size footer at the end of the file. Blocks start at offset 0 and
+// are followed by the operator table and the block table.
+struct Footer {
+  char magic[8];
+  std::uint32_t format_version;
+  std::uint32_t padding;
+  std::uint64_t step;
+  double s;
+  std::uint64_t num_operators;
+  std::uint64_t num_blocks;
+  std::uint64_t table_offset;
+  std::uint64_t table_checksum;
+};
+
+static_assert(sizeof(Footer) == 64);
+
+using Clock = std::chrono::steady_clock;
+
+std::string CheckpointPath(
+    const CheckpointOptions& options,
+    std::uint64_t step) {
+  return fmt::format(
+      "{}/{}_{:012}{}",
+      options.directory,
+      options.prefix,
+      step,
+      kExtension);
+}
+
+std::uint64_t TableChecksum(
+    const std::vector<OperatorEntry>& operators,
+    const std::vector<BlockEntry>& blocks) {
+  return Checksum64(
+      blocks.data(),
+      blocks.size() * sizeof(BlockEntry),
+      Checksum64(operators.data(), operators.size() * sizeof(OperatorEntry)));
+}
+
+// Checkpoint file mapped and validated up to the block checksums.
+struct CheckpointFile {
+  MappedFile file;
+  Footer footer;
+  std::vector<OperatorEntry> operators;
+  std::vector<BlockEntry> blocks;
+
+  const double* Data(const BlockEntry& block) const {
+    return reinterpret_cast<const double*>(file.Data() + block.offset);
+  }
+};
+
+bool OpenCheckpoint(const std::string& path, CheckpointFile& out) {
+  out.file = MappedFile(path);
+  const std::size_t size = out.file.Size();
+  if (!out.file.IsValid() || size < sizeof(Footer)) {
+    return false;
+  }
+  Footer& footer = out.footer;
+  std::memcpy(&footer, out.file.Data() + size - sizeof(Footer), sizeof(Footer));
+  const std::size_t table_end = size - sizeof(Footer);
+  if (std::memcmp(footer.magic, kMagic, sizeof(kMagic)) != 0 ||
+      footer.format_version != kFormatVersion ||
+      footer.table_offset > table_end ||
+      footer.num_operators >
+          (table_end - footer.table_offset) / sizeof(OperatorEntry)) {
+    return false;
+  }
+  const std::size_t blocks_offset =
+      footer.table_offset + footer.num_operators * sizeof(OperatorEntry);
+  if (footer.num_blocks != (table_end - blocks_offset) / sizeof(BlockEntry) ||
+      blocks_offset + footer.num_blocks * sizeof(BlockEntry) != table_end) {
+    return false;
+  }
+  out.operators.resize(footer.num_operators);
+  out.blocks.resize(footer.num_blocks);
+  std::memcpy(
+      out.operators.data(),
+      out.file.Data() + footer.table_offset,
+      out.operators.size() * sizeof(OperatorEntry));
+  std::memcpy(
+      out.blocks.data(),
+      out.file.Data() + blocks_offset,
+      out.blocks.size() * sizeof(BlockEntry));
+  if (footer.table_checksum != TableChecksum(out.operators, out.blocks)) {
+    return false;
+  }
+  for (const BlockEntry& block : out.blocks) {
+    if (block.stored != 0 &&
+        (block.offset % sizeof(double) != 0 ||
+         block.offset > footer.table_offset ||
+         block.size > (footer.table_offset - block.offset) / sizeof(double))) {
+      return false;
+    }
+  }
+  for (const OperatorEntry& entry : out.operators) {
+    const std::uint64_t num =
+        entry.num_one_body + entry.num_two_body + entry.num_three_body;
+    if (entry.first_block > out.blocks.size() ||
+        num > out.blocks.size() - entry.first_block) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Check that blocks [first, first + sizes.size()) match sizes.
+bool MatchBlocks(
+    const CheckpointFile& file,
+    std::size_t first,
+    const std::vector<std::size_t>& sizes,
+    bool allow_missing) {
+  for (std::size_t b = 0; b < sizes.size(); b += 1) {
+    const BlockEntry& block = file.blocks[first + b];
+    if (block.size != sizes[b] || (block.stored == 0 && !allow_missing)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Get entry of operator matching op, or nullptr.
+const OperatorEntry* FindOperator(
+    const CheckpointFile& file,
+    const std::string& name,
+    const Operator& op) {
+  const OperatorEntry* entry = nullptr;
+  for (const OperatorEntry& e : file.operators) {
+    if (std::string_view(e.name, strnlen(e.name, kNameSize)) == name) {
+      entry = &e;
+    }
+  }
+  if (entry == nullptr ||
+      entry->hermiticity != static_cast<std::uint8_t>(op.Symmetry()) ||
+      entry->layout_2b != static_cast<std::uint8_t>(op.TwoBody().Layout()) ||
+      (entry->has_three_body != 0) != op.HasThreeBody()) {
+    return nullptr;
+  }
+  std::vector<std::size_t> sizes;
+  for (const auto pw : op.SP().PartialWaveIndices()) {
+    sizes.push_back(op.OneBody().BlockSize(pw));
+  }
+  if (entry->num_one_body != sizes.size() ||
+      !MatchBlocks(file, entry->first_block, sizes, false)) {
+    return nullptr;
+  }
+  std::size_t first = entry->first_block + sizes.size();
+  sizes.clear();
+  for (const auto ch : op.TwoBody().ModelSpace().ChannelIndices()) {
+    sizes.push_back(op.TwoBody().ChannelSize(ch));
+  }
+  if (entry->num_two_body != sizes.size() ||
+      !MatchBlocks(file, first, sizes, false)) {
+    return nullptr;
+  }
+  first += sizes.size();
+  sizes.clear();
+  if (op.HasThreeBody()) {
+    const ThreeBodyOperator& three_body = op.ThreeBody();
+    for (const auto ch : three_body.ModelSpace().ChannelIndices()) {
+      sizes.push_back(three_body.ChannelSize(ch));
+    }
+    if (entry->layout_3b != static_cast<std::uint8_t>(three_body.Layout()) ||
+        entry->num_three_body != sizes.size() ||
+        !MatchBlocks(file, first, sizes, true)) {
+      return nullptr;
+    }
+  } else if (entry->num_three_body != 0) {
+    return nullptr;
+  }
+  return entry;
+}
+
+bool VerifyBlocks(
+    const CheckpointFile& file,
+    const std::vector<std::size_t>& blocks) {
+  bool valid = true;
+  const std::size_t num_blocks = blocks.size();
+#pragma omp parallel for schedule(dynamic) reduction(&& : valid) \
+    num_threads(NumParallelThreads())
+  for (std::size_t k = 0; k < num_blocks; k += 1) {
+    const BlockEntry& block = file.blocks[blocks[k]];
+    const std::size_t bytes = block.size * sizeof(double);
+    valid = valid && Checksum64(file.Data(block), bytes) == block.checksum;
+  }
+  return valid;
+}
+
+void Restore(
+    const CheckpointFile& file,
+    const OperatorEntry& entry,
+    Operator& op) {
+  op.SetZeroBody(entry.zero_body);
+  const BlockEntry* blocks = file.blocks.data() + entry.first_block;
+
+  OneBodyOperator& one_body = op.OneBody();
+  one_body.PrepareWrites();
+  const std::size_t num_one_body = entry.num_one_body;
+#pragma omp parallel for schedule(dynamic) num_threads(NumParallelThreads())
+  for (std::size_t b = 0; b < num_one_body; b += 1) {
+    std::memcpy(
+        one_body.MutableBlock(PartialWaveIndex(b)),
+        file.Data(blocks[b]),
+        blocks[b].size * sizeof(double));
+  }
+  blocks += num_one_body;
+
+  TwoBodyOperator& two_body = op.TwoBody();
+  two_body.PrepareWrites();
+  const std::size_t num_two_body = entry.num_two_body;
+#pragma omp parallel for schedule(dynamic) num_threads(NumParallelThreads())
+  for (std::size_t b = 0; b < num_two_body; b += 1) {
+    std::memcpy(
+        two_body.MutableBlock(TwoBodyChannelIndex(b)),
+        file.Data(blocks[b]),
+        blocks[b].size * sizeof(double));
+  }
+  blocks += num_two_body;
+
+  if (!op.HasThreeBody()) {
+    return;
+  }
+  ThreeBodyOperator& three_body = op.ThreeBody();
+  const std::size_t num_three_body = entry.num_three_body;
+#pragma omp parallel for schedule(dynamic) num_threads(NumParallelThreads())
+  for (std::size_t b = 0; b < num_three_body; b += 1) {
+    if (blocks[b].stored == 0) {
+      continue;
+    }
+    const auto ref = three_body.Write(ThreeBodyChannelIndex(b));
+    std::memcpy(
+        ref.MutableData(),
+        file.Data(blocks[b]),
+        blocks[b].size * sizeof(double));
+  }
+}
+
+}  // namespace
+
+struct Checkpointer::Snapshot {
+  std::uint64_t step = 0;
+  double s = 0.0;
+  std::vector<std::pair<std::string, Operator>> operators;
+};
+
+Checkpointer::Checkpointer(CheckpointOptions options)
+    : options_(std::move(options)) {}
+
+Checkpointer::~Checkpointer() { Wait(); }
+
+bool Checkpointer::Save(
+    std::uint64_t step,
+    double s,
+    const std::vector<CheckpointEntry>& operators) {
+  for (std::size_t i = 0; i < operators.size(); i += 1) {
+    const std::string& name = operators[i].first;
+    if (name.empty() || name.size() >= kNameSize) {
+      return false;
+    }
+    for (std::size_t j = 0; j < i; j += 1) {
+      if (operators[j].first == name) {
+        return false;
+      }
+    }
+  }
+
+  auto start = Clock::now();
+  Wait();
+  const double wait_seconds = SecondsSince(start);
+
+  start = Clock::now();
+  auto snapshot = std::make_shared<Snapshot>();
+  snapshot->step = step;
+  snapshot->s = s;
+  snapshot->operators.reserve(operators.size());
+  for (const auto& [name, op] : operators) {
+    snapshot->operators.emplace_back(name, op->Clone());
+  }
+  const double snapshot_seconds = SecondsSince(start);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.wait_seconds += wait_seconds;
+    stats_.snapshot_seconds += snapshot_seconds;
+  }
+
+  writer_ = std::thread([this, snapshot = std::move(snapshot)]() {
+    last_ok_ = Write(*snapshot);
+  });
+  return true;
+}
+
+bool Checkpointer::Wait() {
+  if (writer_.joinable()) {
+    writer_.join();
+  }
+  return last_ok_;
+}
+
+CheckpointStats Checkpointer::Statistics() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+bool Checkpointer::Write(const Snapshot& snapshot) {
+  const auto start = Clock::now();
+  DirectFileWriter writer;
+  bool ok = EnsureDirectory(options_.directory) &&
+            writer.Open(
+                CheckpointPath(options_, snapshot.step),
+                options_.direct_io);
+
+  std::vector<OperatorEntry> entries;
+  std::vector<BlockEntry> blocks;
+  const auto add_block = [&](const double* data, std::size_t size) {
+    BlockEntry block = {writer.Size(), size, 0, data != nullptr};
+    if (data != nullptr) {
+      block.checksum = Checksum64(data, size * sizeof(double));
+      ok = ok && writer.Write(data, size * sizeof(double));
+    }
+    blocks.push_back(block);
+  };
+
+  for (const auto& [name, op] : snapshot.operators) {
+    OperatorEntry entry;
+    std::memset(&entry, 0, sizeof(entry));
+    std::memcpy(entry.name, name.data(), name.size());
+    entry.zero_body = op.ZeroBody();
+    entry.hermiticity = static_cast<std::uint8_t>(op.Symmetry());
+    entry.layout_2b = static_cast<std::uint8_t>(op.TwoBody().Layout());
+    entry.first_block = blocks.size();
+    for (const auto pw : op.SP().PartialWaveIndices()) {
+      add_block(op.OneBody().Block(pw), op.OneBody().BlockSize(pw));
+      entry.num_one_body += 1;
+    }
+    for (const auto ch : op.TwoBody().ModelSpace().ChannelIndices()) {
+      add_block(op.TwoBody().Block(ch), op.TwoBody().ChannelSize(ch));
+      entry.num_two_body += 1;
+    }
+    if (op.HasThreeBody()) {
+      const ThreeBodyOperator& three_body = op.ThreeBody();
+      entry.has_three_body = 1;
+      entry.layout_3b = static_cast<std::uint8_t>(three_body.Layout());
+      for (const auto ch : three_body.ModelSpace().ChannelIndices()) {
+        if (three_body.IsMaterialized(ch)) {
+          const auto view = three_body.Read(ch);
+          add_block(view.Data(), three_body.ChannelSize(ch));
+        } else {
+          add_block(nullptr, three_body.ChannelSize(ch));
+        }
+        entry.num_three_body += 1;
+      }
+    }
+    entries.push_back(entry);
+  }
+
+  Footer footer;
+  std::memset(&footer, 0, sizeof(footer));
+  std::memcpy(footer.magic, kMagic, sizeof(kMagic));
+  footer.format_version = kFormatVersion;
+  footer.step = snapshot.step;
+  footer.s = snapshot.s;
+  footer.num_operators = entries.size();
+  footer.num_blocks = blocks.size();
+  footer.table_offset = writer.Size();
+  footer.table_checksum = TableChecksum(entries, blocks);
+  ok = ok &&
+       writer.Write(entries.data(), entries.size() * sizeof(OperatorEntry)) &&
+       writer.Write(blocks.data(), blocks.size() * sizeof(BlockEntry)) &&
+       writer.Write(&footer, sizeof(footer));
+  const std::size_t bytes = writer.Size();
+  ok = ok && writer.Commit();
+  writer.Abort();
+
+  if (ok) {
+    auto files = ListCheckpoints(options_);
+    for (std::size_t i = 0; i + options_.keep < files.size(); i += 1) {
+      std::remove(files[i].path.c_str());
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (ok) {
+    stats_.checkpoints += 1;
+    stats_.bytes += bytes;
+  } else {
+    stats_.failures += 1;
+  }
+  stats_.write_seconds += SecondsSince(start);
+  return ok;
+}
+
+std::vector<CheckpointInfo> ListCheckpoints(const CheckpointOptions& options) {
+  std::vector<CheckpointInfo> files;
+  DIR* dir = ::opendir(options.directory.c_str());
+  if (dir == nullptr) {
+    return files;
+  }
+  const std::string prefix = options.prefix + "_";
+  while (const dirent* entry = ::readdir(dir)) {
+    const std::string_view name(entry->d_name);
+    if (name.size() <= prefix.size() + kExtension.size() ||
+        name.substr(0, prefix.size()) != prefix ||
+        name.substr(name.size() - kExtension.size()) != kExtension) {
+      continue;
+    }
+    const std::string_view digits = name.substr(
+        prefix.size(),
+        name.size() - prefix.size() - kExtension.size());
+    if (!std::all_of(digits.begin(), digits.end(), [](char c) {
+          return c >= '0' && c <= '9';
+        })) {
+      continue;
+    }
+    CheckpointInfo info;
+    info.path = fmt::format("{}/{}", options.directory, name);
+    info.step = std::stoull(std::string(digits));
+    files.push_back(info);
+  }
+  ::closedir(dir);
+  std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) {
+    return a.step < b.step;
+  });
+  return files;
+}
+
+bool LoadCheckpoint(
+    const std::string& path,
+    const std::vector<CheckpointTarget>& operators,
+    CheckpointInfo* info) {
+  CheckpointFile file;
+  if (!OpenCheckpoint(path, file)) {
+    return false;
+  }
+  std::vector<const OperatorEntry*> entries;
+  std::vector<std::size_t> stored;
+  for (const auto& [name, op] : operators) {
+    const OperatorEntry* entry = FindOperator(file, name, *op);
+    if (entry == nullptr) {
+      return false;
+    }
+    entries.push_back(entry);
+    const std::size_t num_blocks =
+        entry->num_one_body + entry->num_two_body + entry->num_three_body;
+    for (std::size_t b = 0; b < num_blocks; b += 1) {
+      if (file.blocks[entry->first_block + b].stored != 0) {
+        stored.push_back(entry->first_block + b);
+      }
+    }
+  }
+  if (!VerifyBlocks(file, stored)) {
+    return false;
+  }
+  for (std::size_t i = 0; i < operators.size(); i += 1) {
+    Restore(file, *entries[i], *operators[i].second);
+  }
+  if (info != nullptr) {
+    info->path = path;
+    info->step = file.footer.step;
+    info->s = file.footer.s;
+  }
+  return true;
+}
+
+bool LoadLatestCheckpoint(
+    const CheckpointOptions& options,
+    const std::vector<CheckpointTarget>& operators,
+    CheckpointInfo* info) {
+  const auto files = ListCheckpoints(options);
+  for (auto it = files.rbegin(); it != files.rend(); ++it) {
+    if (LoadCheckpoint(it->path, operators, info)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace nui
@@ -0,0 +1,158 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_OPERATORS_STORAGE_FULL_CHECKPOINT_H_
+#define NUI_PHYSICS_OPERATORS_STORAGE_FULL_CHECKPOINT_H_
+
+// IWYU pragma: private, include "nui/physics/operators/storage/full/op_full.h"
+// IWYU pragma: friend "nui/physics/operators/storage/full/.*\.h"
+
+#include <mutex>
+#include <thread>
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/operators/storage/full/operator.h"
+
+namespace nui {
+
+// Options of checkpoints.
+struct CheckpointOptions {
+  // Directory of checkpoint files.
+  std::string directory = ".";
+  // Prefix of checkpoint file names (<prefix>_<step>.nuickpt).
+  std::string prefix = "nui_checkpoint";
+  // Number of complete checkpoints kept (older ones are removed).
+  std::size_t keep = 2;
+  // Bypass the page cache (O_DIRECT) where supported.
+  bool direct_io = true;
+};
+
+// Flow position of a checkpoint.
+struct CheckpointInfo {
+  std::string path;
+  std::uint64_t step = 0;
+  double s = 0.0;
+};
+
+// Counters of a Checkpointer.
+struct CheckpointStats {
+  // Checkpoints written completely.
+  std::size_t checkpoints = 0UL;
+  // Checkpoints that could not be written.
+  std::size_t failures = 0UL;
+  // Bytes written.
+  std::size_t bytes = 0UL;
+  // Time in Save() taking snapshots (compute stall).
+  double snapshot_seconds = 0.0;
+  // Time in Save() waiting for the previous write (compute stall).
+  double wait_seconds = 0.0;
+  // Time of background writes.
+  double write_seconds = 0.0;
+};
+
+// Named operator to save.
+using CheckpointEntry = std::pair<std::string, const Operator*>;
+
+// Named operator to load into.
+using CheckpointTarget = std::pair<std::string, Operator*>;
+
+// Asynchronous writer of flow checkpoints.
+//
+// Save() takes a snapshot of the operators with Operator::Clone(), which
+// shares all 1- and 2-body blocks (copy-on-write), and returns. A background
+// thread then streams the snapshot to a new file with large aligned writes,
+// computing a checksum per block, and renames it into place once complete.
+// The flow only pays for the 3-body copy (if any) and for duplicating blocks
+// it writes while the snapshot is alive.
+//
+// At most one write is in flight: Save() waits for the previous one first.
+class Checkpointer {
+ public:
+  explicit Checkpointer(CheckpointOptions options);
+
+  // Wait for pending write.
+  ~Checkpointer();
+
+  Checkpointer(const Checkpointer&) = delete;
+  Checkpointer& operator=(const Checkpointer&) = delete;
+
+  // Get options.
+  const CheckpointOptions& Options() const { return options_; }
+
+  // Snapshot operators at flow step and parameter s and write them in the
+  // background.
+  //
+  // Returns false (and writes nothing) if names are empty, too long (> 31
+  // characters), or not unique.
+  bool Save(
+      std::uint64_t step,
+      double s,
+      const std::vector<CheckpointEntry>& operators);
+
+  // Wait for pending write. Returns false if it failed.
+  bool Wait();
+
+  // Get counters.
+  CheckpointStats Statistics() const;
+
+ private:
+  struct Snapshot;
+
+  // Write snapshot to file and remove old checkpoints (background thread).
+  bool Write(const Snapshot& snapshot);
+
+  CheckpointOptions options_;
+  std::thread writer_;
+  bool last_ok_ = true;
+  mutable std::mutex mutex_;
+  CheckpointStats stats_;
+};
+
+// Get complete checkpoint files of options, oldest first.
+//
+// Files are identified by name, their contents are not validated.
+std::vector<CheckpointInfo> ListCheckpoints(const CheckpointOptions& options);
+
+// Load checkpoint file into named operators.
+//
+// Each operator must exist in the file with the same structure (hermiticity,
+// layouts, block sizes, and presence of a 3-body part); the file may hold
+// more operators. All block checksums are verified before any operator is
+// modified, so operators are left untouched on failure. Matrix elements are
+// restored bit for bit, including which 3-body channels are materialized
+// (operators should be zero).
+bool LoadCheckpoint(
+    const std::string& path,
+    const std::vector<CheckpointTarget>& operators,
+    CheckpointInfo* info = nullptr);
+
+// Load newest checkpoint of options that loads successfully.
+//
+// Returns false if there is none.
+bool LoadLatestCheckpoint(
+    const CheckpointOptions& options,
+    const std::vector<CheckpointTarget>& operators,
+    CheckpointInfo* info = nullptr);
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_OPERATORS_STORAGE_FULL_CHECKPOINT_H_
@@ -0,0 +1,114 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "fmt/core.h"
+#include "nui/core/basics/basics.h"
+#include "nui/core/io/io.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/storage/full/op_full.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+
+// Benchmark of asynchronous checkpoints.
+//
+// Usage: nui_..._checkpoint_bench [emax] [steps] [directory]
+//
+// Runs a mock flow that rewrites H and Omega every step and saves a
+// checkpoint every step, and compares the compute stall per checkpoint
+// (snapshot and waiting) with the background write time.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Stand-in for one flow step: rewrite all 2-body blocks.
+void Step(nui::Operator& op, double x) {
+  for (const auto ch : op.TwoBody().ModelSpace().ChannelIndices()) {
+    double* block = op.TwoBody().MutableBlock(ch);
+    for (std::size_t i = 0; i < op.TwoBody().ChannelSize(ch); i += 1) {
+      block[i] = 0.999 * block[i] + x;
+    }
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int emax = argc > 1 ? std::atoi(argv[1]) : 6;
+  const int steps = argc > 2 ? std::atoi(argv[2]) : 5;
+  // Checkpoints go to a temporary directory unless one is given.
+  nui::TempDirectory scratch;
+  nui::CheckpointOptions options;
+  if (argc > 3) {
+    options.directory = argv[3];
+  } else {
+    scratch = nui::TempDirectory("nui_checkpoint_bench");
+    options.directory = scratch.Path();
+  }
+
+  const auto ms = nui::TwoBodyModelSpace::Make(nui::SPModelSpace::Make(
+      nui::SPTruncation(emax),
+      nui::Reference::HOEqualFilling(8, 8)));
+  nui::Operator h(ms, nui::Hermiticity::kHermitian);
+  nui::Operator omega(ms, nui::Hermiticity::kAntihermitian);
+  fmt::print(
+      "emax = {}, checkpoint size = {:.1f} MB\n",
+      emax,
+      (h.StoredBytes() + omega.StoredBytes()) * 1e-6);
+
+  double step_seconds = 0.0;
+  {
+    nui::Checkpointer checkpointer(options);
+    for (int s = 0; s < steps; s += 1) {
+      const auto start = Clock::now();
+      Step(h, 1e-3 * s);
+      Step(omega, 2e-3 * s);
+      step_seconds +=
+          std::chrono::duration<double>(Clock::now() - start).count();
+      checkpointer.Save(s, 0.1 * s, {{"H", &h}, {"Omega", &omega}});
+    }
+    checkpointer.Wait();
+    const auto stats = checkpointer.Statistics();
+    fmt::print(
+        "checkpoints = {}, failures = {}, written = {:.1f} MB\n"
+        "per checkpoint: snapshot = {:.3f} ms, wait = {:.3f} ms, "
+        "write = {:.3f} ms ({:.1f} MB/s)\n"
+        "per step: compute = {:.3f} ms\n",
+        stats.checkpoints,
+        stats.failures,
+        stats.bytes * 1e-6,
+        stats.snapshot_seconds / steps * 1e3,
+        stats.wait_seconds / steps * 1e3,
+        stats.write_seconds / steps * 1e3,
+        stats.bytes / stats.write_seconds * 1e-6,
+        step_seconds / steps * 1e3);
+  }
+  for (const auto& info : nui::ListCheckpoints(options)) {
+    std::remove(info.path.c_str());
+  }
+  return EXIT_SUCCESS;
+}
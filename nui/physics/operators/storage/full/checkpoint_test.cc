@@ -0,0 +1,174 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/full/checkpoint.h"
+
+#include <cstdio>
+
+#include "catch2/catch_test_macros.hpp"
+#include "nui/core/basics/basics.h"
+#include "nui/core/io/io.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/storage/3b/op_3b.h"
+#include "nui/physics/operators/storage/full/operator.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+#include "nui/physics/operators/storage/testing/op_testing.h"
+
+namespace {
+
+using nui::Hermiticity;
+using nui::testing::FillStored;
+using nui::testing::MakeSP;
+using nui::testing::MakeTwoBodyModelSpace;
+
+// Get options that keep checkpoints in a directory the checkpointer creates
+// below dir.
+nui::CheckpointOptions MakeOptions(const nui::TempDirectory& dir) {
+  nui::CheckpointOptions options;
+  options.directory = dir.File("checkpoints");
+  return options;
+}
+
+bool Identical(const nui::Operator& a, const nui::Operator& b) {
+  if (a.ZeroBody() != b.ZeroBody()) {
+    return false;
+  }
+  for (const auto pw : a.SP().PartialWaveIndices()) {
+    for (std::size_t i = 0; i < a.OneBody().BlockSize(pw); i += 1) {
+      if (a.OneBody().Block(pw)[i] != b.OneBody().Block(pw)[i]) {
+        return false;
+      }
+    }
+  }
+  for (const auto ch : a.TwoBody().ModelSpace().ChannelIndices()) {
+    for (std::size_t i = 0; i < a.TwoBody().ChannelSize(ch); i += 1) {
+      if (a.TwoBody().Block(ch)[i] != b.TwoBody().Block(ch)[i]) {
+        return false;
+      }
+    }
+  }
+  if (a.HasThreeBody() != b.HasThreeBody()) {
+    return false;
+  }
+  if (!a.HasThreeBody()) {
+    return true;
+  }
+  for (const auto ch : a.ThreeBody().ModelSpace().ChannelIndices()) {
+    if (a.ThreeBody().IsMaterialized(ch) != b.ThreeBody().IsMaterialized(ch)) {
+      return false;
+    }
+    if (!a.ThreeBody().IsMaterialized(ch)) {
+      continue;
+    }
+    const auto x = a.ThreeBody().Read(ch);
+    const auto y = b.ThreeBody().Read(ch);
+    for (std::size_t i = 0; i < a.ThreeBody().ChannelSize(ch); i += 1) {
+      if (x.Data()[i] != y.Data()[i]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+TEST_CASE("Checkpointer, Test asynchronous save and bit-identical load.") {
+  const nui::TempDirectory dir("nui_checkpoint_test");
+  const auto options = MakeOptions(dir);
+  const auto sp = MakeSP(2);
+  const auto ms = nui::TwoBodyModelSpace::Make(sp);
+  nui::Operator h(ms, Hermiticity::kHermitian);
+  nui::Operator omega(ms, Hermiticity::kHermitian);
+  REQUIRE(h.AddThreeBody(
+      nui::ThreeBodyModelSpace::Make(sp, nui::ThreeBodyTruncation(4))));
+  // Every other 3-body channel stays unmaterialized.
+  FillStored(0.3, h, 2);
+  FillStored(1.7, omega);
+  const nui::Operator h_saved = h.Clone();
+
+  nui::Checkpointer checkpointer(options);
+  REQUIRE(checkpointer.Save(7, 0.25, {{"H", &h}, {"Omega", &omega}}));
+  // Writes after Save() do not reach the checkpoint.
+  FillStored(2.9, h, 2);
+  REQUIRE(checkpointer.Wait());
+  const auto stats = checkpointer.Statistics();
+  REQUIRE(stats.checkpoints == 1);
+  REQUIRE(stats.failures == 0);
+  REQUIRE(stats.bytes > h.StoredBytes() + omega.StoredBytes());
+
+  nui::Operator h_loaded = h.ZeroLike();
+  nui::Operator omega_loaded = omega.ZeroLike();
+  nui::CheckpointInfo info;
+  REQUIRE(nui::LoadLatestCheckpoint(
+      options,
+      {{"Omega", &omega_loaded}, {"H", &h_loaded}},
+      &info));
+  REQUIRE(info.step == 7);
+  REQUIRE(info.s == 0.25);
+  REQUIRE(Identical(h_loaded, h_saved));
+  REQUIRE(Identical(omega_loaded, omega));
+
+  // Operators must match in name and structure.
+  nui::Operator target(ms, Hermiticity::kHermitian);
+  REQUIRE_FALSE(nui::LoadCheckpoint(info.path, {{"H", &target}}));
+  REQUIRE_FALSE(nui::LoadCheckpoint(info.path, {{"eta", &target}}));
+  REQUIRE(nui::LoadCheckpoint(info.path, {{"Omega", &target}}));
+
+  REQUIRE_FALSE(checkpointer.Save(8, 0.5, {{"", &h}}));
+  REQUIRE_FALSE(checkpointer.Save(8, 0.5, {{"H", &h}, {"H", &omega}}));
+}
+
+TEST_CASE("Checkpointer, Test rotation and corrupt checkpoints.") {
+  const nui::TempDirectory dir("nui_checkpoint_test");
+  auto options = MakeOptions(dir);
+  options.keep = 2;
+  nui::Operator op(MakeTwoBodyModelSpace(2), Hermiticity::kHermitian);
+  {
+    nui::Checkpointer checkpointer(options);
+    for (std::uint64_t step = 1; step <= 3; step += 1) {
+      FillStored(1.0 * step, op);
+      REQUIRE(checkpointer.Save(step, 0.1 * step, {{"H", &op}}));
+    }
+  }
+  const auto files = nui::ListCheckpoints(options);
+  REQUIRE(files.size() == 2);
+  REQUIRE(files[0].step == 2);
+  REQUIRE(files[1].step == 3);
+
+  // Flip a byte in the first block of the newest checkpoint.
+  std::FILE* f = std::fopen(files[1].path.c_str(), "r+b");
+  REQUIRE(f != nullptr);
+  const int c = std::fgetc(f);
+  std::fseek(f, 0, SEEK_SET);
+  std::fputc(c ^ 0x1, f);
+  std::fclose(f);
+
+  nui::Operator loaded = op.ZeroLike();
+  nui::CheckpointInfo info;
+  REQUIRE(nui::LoadLatestCheckpoint(options, {{"H", &loaded}}, &info));
+  REQUIRE(info.step == 2);
+  FillStored(2.0, op);
+  REQUIRE(Identical(loaded, op));
+}
@@ -0,0 +1,90 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/full/operator.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/operators/storage/1b/op_1b.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+#include "nui/physics/operators/storage/3b/op_3b.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+
+namespace nui {
+
+Operator::Operator(
+    std::shared_ptr<const TwoBodyModelSpace> ms,
+    Hermiticity hermiticity,
+    bool packed)
+    : one_body_(ms->SPShared(), hermiticity),
+      two_body_(std::move(ms), hermiticity, packed) {}
+
+Operator Operator::Clone() const {
+  Operator copy(zero_body_, one_body_, two_body_);
+  if (HasThreeBody()) {
+    copy.AddThreeBody(three_body_->ModelSpaceShared(), three_body_->Options());
+    Copy(*three_body_, *copy.three_body_);
+  }
+  return copy;
+}
+
+Operator Operator::ZeroLike() const {
+  Operator zero(two_body_.ModelSpaceShared(), Symmetry(), two_body_.IsPacked());
+  if (HasThreeBody()) {
+    zero.AddThreeBody(three_body_->ModelSpaceShared(), three_body_->Options());
+  }
+  return zero;
+}
+
+bool Operator::AddThreeBody(
+    std::shared_ptr<const ThreeBodyModelSpace> ms,
+    ThreeBodyStorageOptions options) {
+  if (HasThreeBody() || ms->SPShared() != one_body_.SPShared()) {
+    return false;
+  }
+  three_body_ = std::make_unique<ThreeBodyOperator>(
+      std::move(ms),
+      Symmetry(),
+      std::move(options));
+  return true;
+}
+
+std::size_t Operator::StoredBytes() const {
+  std::size_t size =
+      one_body_.Blocks().TotalSize() + two_body_.Blocks().TotalSize();
+  if (HasThreeBody()) {
+    for (const auto ch : three_body_->ModelSpace().ChannelIndices()) {
+      if (three_body_->IsMaterialized(ch)) {
+        size += three_body_->ChannelSize(ch);
+      }
+    }
+  }
+  return size * sizeof(double);
+}
+
+std::size_t Operator::MemoryLoad() const {
+  return one_body_.MemoryLoad() + two_body_.MemoryLoad() +
+         (HasThreeBody() ? three_body_->MemoryLoad() : 0UL);
+}
+
+}  // namespace nui
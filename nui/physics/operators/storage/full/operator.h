@@ -0,0 +1,156 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_OPERATORS_STORAGE_FULL_OPERATOR_H_
+#define NUI_PHYSICS_OPERATORS_STORAGE_FULL_OPERATOR_H_
+
+// IWYU pragma: private, include "nui/physics/operators/storage/full/op_full.h"
+// IWYU pragma: friend "nui/physics/operators/storage/full/.*\.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/storage/1b/op_1b.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+#include "nui/physics/operators/storage/3b/op_3b.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+
+namespace nui {
+
+// Scalar operator with 0-, 1-, 2-, and optionally 3-body parts.
+//
+// All parts share one hermiticity and one single-particle model space. The
+// 1- and 2-body parts are copy-on-write, the 3-body part is owned uniquely,
+// so operators are move-only: copies must be made explicitly with Clone().
+// Moves never touch matrix elements.
+class Operator {
+ public:
+  // Construct zero operator without 3-body part.
+  Operator(
+      std::shared_ptr<const TwoBodyModelSpace> ms,
+      Hermiticity hermiticity,
+      bool packed = true);
+
+  Operator(const Operator&) = delete;
+  Operator& operator=(const Operator&) = delete;
+  Operator(Operator&&) noexcept = default;
+  Operator& operator=(Operator&&) noexcept = default;
+
+  // Get copy of operator.
+  //
+  // 1- and 2-body blocks are shared until written, the 3-body part (if any)
+  // is copied channel by channel.
+  Operator Clone() const;
+
+  // Get zero operator with the same parts and storage as this operator.
+  Operator ZeroLike() const;
+
+  // Add zero 3-body part.
+  //
+  // Returns false (and does nothing) if the operator already has a 3-body
+  // part or ms has a different single-particle model space.
+  bool AddThreeBody(
+      std::shared_ptr<const ThreeBodyModelSpace> ms,
+      ThreeBodyStorageOptions options = {});
+
+  // Remove 3-body part.
+  void DropThreeBody() { three_body_.reset(); }
+
+  // Get single-particle model space.
+  const SPModelSpace& SP() const { return one_body_.SP(); }
+
+  // Get symmetry under transposition.
+  Hermiticity Symmetry() const { return one_body_.Symmetry(); }
+
+  // Get 0-body part.
+  double ZeroBody() const { return zero_body_; }
+
+  // Set 0-body part.
+  void SetZeroBody(double value) { zero_body_ = value; }
+
+  // Get 1-body part.
+  const OneBodyOperator& OneBody() const { return one_body_; }
+
+  // Get mutable 1-body part.
+  OneBodyOperator& OneBody() { return one_body_; }
+
+  // Get 2-body part.
+  const TwoBodyOperator& TwoBody() const { return two_body_; }
+
+  // Get mutable 2-body part.
+  TwoBodyOperator& TwoBody() { return two_body_; }
+
+  // Check if operator has 3-body part.
+  bool HasThreeBody() const { return three_body_ != nullptr; }
+
+  // Get 3-body part (only valid if HasThreeBody()).
+  const ThreeBodyOperator& ThreeBody() const { return *three_body_; }
+
+  // Get mutable 3-body part (only valid if HasThreeBody()).
+  ThreeBodyOperator& ThreeBody() { return *three_body_; }
+
+  // Check if 0-, 1-, and 2-body parts of other have the same model spaces,
+  // hermiticity, and layout as this operator.
+  //
+  // 3-body parts are not compared.
+  bool IsCompatible(const Operator& other) const {
+    return one_body_.IsCompatible(other.one_body_) &&
+           two_body_.IsCompatible(other.two_body_);
+  }
+
+  // Get bytes of stored matrix elements (materialized 3-body channels only).
+  //
+  // An element-wise pass over the operator streams this many bytes.
+  std::size_t StoredBytes() const;
+
+  // Get size of operator in dynamic memory.
+  std::size_t MemoryLoad() const;
+
+  // Swap with other operator.
+  void swap(Operator& other) noexcept {
+    using std::swap;
+    swap(zero_body_, other.zero_body_);
+    swap(one_body_, other.one_body_);
+    swap(two_body_, other.two_body_);
+    swap(three_body_, other.three_body_);
+  }
+
+ private:
+  Operator(
+      double zero_body,
+      const OneBodyOperator& one_body,
+      const TwoBodyOperator& two_body)
+      : zero_body_(zero_body), one_body_(one_body), two_body_(two_body) {}
+
+  double zero_body_ = 0.0;
+  OneBodyOperator one_body_;
+  TwoBodyOperator two_body_;
+  std::unique_ptr<ThreeBodyOperator> three_body_;
+};
+
+// Swap two operators.
+inline void swap(Operator& a, Operator& b) noexcept { a.swap(b); }
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_OPERATORS_STORAGE_FULL_OPERATOR_H_
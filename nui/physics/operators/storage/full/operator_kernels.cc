@@ -0,0 +1,107 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/full/operator_kernels.h"
+
+#include <cmath>
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/operators/storage/1b/op_1b.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+#include "nui/physics/operators/storage/3b/op_3b.h"
+#include "nui/physics/operators/storage/full/operator.h"
+
+namespace nui {
+
+double Norm(const Operator& op) {
+  const double n1 = Norm(op.OneBody());
+  const double n2 = Norm(op.TwoBody());
+  const double n3 = op.HasThreeBody() ? Norm(op.ThreeBody()) : 0.0;
+  return std::sqrt(
+      op.ZeroBody() * op.ZeroBody() + n1 * n1 + n2 * n2 + n3 * n3);
+}
+
+void Scale(double alpha, Operator& op) {
+  LinearCombination({}, {}, alpha, op);
+}
+
+bool Axpy(double alpha, const Operator& x, Operator& y) {
+  return LinearCombination({alpha}, {&x}, 1.0, y);
+}
+
+bool Axpby(double alpha, const Operator& x, double beta, Operator& y) {
+  return LinearCombination({alpha}, {&x}, beta, y);
+}
+
+bool LinearCombination(
+    const std::vector<double>& alphas,
+    const std::vector<const Operator*>& xs,
+    double beta,
+    Operator& y) {
+  if (alphas.size() != xs.size()) {
+    return false;
+  }
+  for (const Operator* x : xs) {
+    if (!x->IsCompatible(y) || (x->HasThreeBody() && !y.HasThreeBody()) ||
+        (x->HasThreeBody() && !x->ThreeBody().IsCompatible(y.ThreeBody()))) {
+      return false;
+    }
+  }
+
+  std::vector<const OneBodyOperator*> xs_1b;
+  std::vector<const TwoBodyOperator*> xs_2b;
+  std::vector<double> alphas_3b;
+  std::vector<const ThreeBodyOperator*> xs_3b;
+  double zero_body = beta * y.ZeroBody();
+  for (std::size_t k = 0; k < xs.size(); k += 1) {
+    zero_body += alphas[k] * xs[k]->ZeroBody();
+    xs_1b.push_back(&xs[k]->OneBody());
+    xs_2b.push_back(&xs[k]->TwoBody());
+    if (xs[k]->HasThreeBody()) {
+      alphas_3b.push_back(alphas[k]);
+      xs_3b.push_back(&xs[k]->ThreeBody());
+    }
+  }
+
+  y.SetZeroBody(zero_body);
+  LinearCombination(alphas, xs_1b, beta, y.OneBody());
+  LinearCombination(alphas, xs_2b, beta, y.TwoBody());
+  if (y.HasThreeBody()) {
+    LinearCombination(alphas_3b, xs_3b, beta, y.ThreeBody());
+  }
+  return true;
+}
+
+std::size_t LinearCombinationTraffic(
+    const std::vector<const Operator*>& xs,
+    double beta,
+    const Operator& y) {
+  std::size_t bytes = (beta == 0.0 ? 1UL : 2UL) * y.StoredBytes();
+  for (const Operator* x : xs) {
+    if (x != &y) {
+      bytes += x->StoredBytes();
+    }
+  }
+  return bytes;
+}
+
+}  // namespace nui
@@ -0,0 +1,83 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_OPERATORS_STORAGE_FULL_OPERATOR_KERNELS_H_
+#define NUI_PHYSICS_OPERATORS_STORAGE_FULL_OPERATOR_KERNELS_H_
+
+// IWYU pragma: private, include "nui/physics/operators/storage/full/op_full.h"
+// IWYU pragma: friend "nui/physics/operators/storage/full/.*\.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/operators/storage/full/operator.h"
+
+// In-place arithmetic on full operators.
+//
+// Every kernel is one fused pass over each part (0- through 3-body), in
+// parallel over channels, without temporary operators. Flow steps such as
+// H += dt * eta or Omega += c1 * A + c2 * B map to a single call.
+//
+// 3-body parts are treated as zero where they are missing, but a 3-body
+// contribution to an operator without 3-body part is an error.
+
+namespace nui {
+
+// Get norm, sqrt(|O_0|^2 + |O_1|^2 + |O_2|^2 + |O_3|^2) with the Frobenius
+// norms of the parts.
+double Norm(const Operator& op);
+
+// Scale operator, op *= alpha.
+void Scale(double alpha, Operator& op);
+
+// Add scaled operator, y += alpha * x.
+//
+// Returns false (and does nothing) if x and y are not compatible.
+bool Axpy(double alpha, const Operator& x, Operator& y);
+
+// Set linear combination, y = alpha * x + beta * y.
+//
+// Returns false (and does nothing) if x and y are not compatible.
+bool Axpby(double alpha, const Operator& x, double beta, Operator& y);
+
+// Set linear combination, y = beta * y + sum_k alphas[k] * xs[k].
+//
+// Every x is read once and y is written once. Terms with xs[k] == &y are
+// folded into beta. Returns false (and does nothing) if sizes differ, any x
+// is not compatible with y, or any x has a 3-body part but y does not.
+bool LinearCombination(
+    const std::vector<double>& alphas,
+    const std::vector<const Operator*>& xs,
+    double beta,
+    Operator& y);
+
+// Get bytes moved by LinearCombination(alphas, xs, beta, y).
+//
+// This is the traffic model for the fused kernel: each x is read once, y is
+// read (unless beta == 0) and written once. Dividing by the run time of the
+// kernel gives the achieved memory bandwidth.
+std::size_t LinearCombinationTraffic(
+    const std::vector<const Operator*>& xs,
+    double beta,
+    const Operator& y);
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_OPERATORS_STORAGE_FULL_OPERATOR_KERNELS_H_
@@ -0,0 +1,121 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdlib>
+
+#include "fmt/core.h"
+#include "nui/core/basics/basics.h"
+#include "nui/info/profiling/profiling.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/storage/full/op_full.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+#include "nui/physics/operators/storage/testing/op_testing.h"
+
+// Benchmark of in-place arithmetic on full operators.
+//
+// Usage: nui_..._operator_kernels_bench [emax] [e3max] [repeats]
+//
+// e3max < 0 disables the 3-body part. Reports run time, modeled memory
+// traffic, and achieved bandwidth of Scale, Axpy, and N-term linear
+// combinations, and compares the fused linear combination with N Axpy calls.
+
+namespace {
+
+void Report(const char* name, double seconds, std::size_t bytes) {
+  fmt::print(
+      "{:<28} {:>10.3f} ms {:>10.1f} MB {:>8.2f} GB/s\n",
+      name,
+      seconds * 1e3,
+      bytes * 1e-6,
+      bytes / seconds * 1e-9);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int emax = argc > 1 ? std::atoi(argv[1]) : 6;
+  const int e3max = argc > 2 ? std::atoi(argv[2]) : -1;
+  const int repeats = argc > 3 ? std::atoi(argv[3]) : 10;
+
+  const auto sp = nui::SPModelSpace::Make(
+      nui::SPTruncation(emax),
+      nui::Reference::HOEqualFilling(8, 8));
+  const auto ms2 = nui::TwoBodyModelSpace::Make(sp);
+  std::shared_ptr<const nui::ThreeBodyModelSpace> ms3;
+  if (e3max >= 0) {
+    ms3 = nui::ThreeBodyModelSpace::Make(sp, nui::ThreeBodyTruncation(e3max));
+  }
+
+  constexpr std::size_t kMaxTerms = 6;
+  std::vector<nui::Operator> xs;
+  for (std::size_t k = 0; k < kMaxTerms; k += 1) {
+    xs.emplace_back(ms2, nui::Hermiticity::kHermitian);
+    if (ms3 != nullptr) {
+      xs.back().AddThreeBody(ms3);
+    }
+    nui::testing::FillStored(1.0 / (k + 1), xs.back());
+  }
+  nui::Operator y = xs[0].ZeroLike();
+  nui::testing::FillStored(0.5, y);
+
+  fmt::print(
+      "emax = {}, e3max = {}, operator = {:.1f} MB\n",
+      emax,
+      e3max,
+      y.StoredBytes() * 1e-6);
+
+  Report(
+      "Scale",
+      nui::TimeSeconds(repeats, [&]() { nui::Scale(0.999, y); }),
+      2 * y.StoredBytes());
+  Report(
+      "Axpy (H += dt * eta)",
+      nui::TimeSeconds(repeats, [&]() { nui::Axpy(1e-3, xs[0], y); }),
+      nui::LinearCombinationTraffic({&xs[0]}, 1.0, y));
+
+  for (std::size_t n = 2; n <= kMaxTerms; n += 2) {
+    std::vector<double> alphas(n, 1e-3);
+    std::vector<const nui::Operator*> terms;
+    for (std::size_t k = 0; k < n; k += 1) {
+      terms.push_back(&xs[k]);
+    }
+    const double fused = nui::TimeSeconds(repeats, [&]() {
+      nui::LinearCombination(alphas, terms, 1.0, y);
+    });
+    const double naive = nui::TimeSeconds(repeats, [&]() {
+      for (std::size_t k = 0; k < n; k += 1) {
+        nui::Axpy(alphas[k], *terms[k], y);
+      }
+    });
+    Report(
+        fmt::format("LinearCombination n = {}", n).c_str(),
+        fused,
+        nui::LinearCombinationTraffic(terms, 1.0, y));
+    Report(
+        fmt::format("{} x Axpy", n).c_str(),
+        naive,
+        n * nui::LinearCombinationTraffic({terms[0]}, 1.0, y));
+  }
+  return 0;
+}
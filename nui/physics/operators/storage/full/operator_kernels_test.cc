@@ -0,0 +1,192 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/full/operator_kernels.h"
+
+#include <cmath>
+
+#include "catch2/catch_approx.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "nui/core/basics/basics.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/storage/3b/op_3b.h"
+#include "nui/physics/operators/storage/full/operator.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+#include "nui/physics/operators/storage/testing/op_testing.h"
+
+namespace {
+
+using nui::Hermiticity;
+using nui::testing::FillStored;
+using nui::testing::MakeSP;
+using nui::testing::StoredElement;
+
+struct Spaces {
+  std::shared_ptr<const nui::TwoBodyModelSpace> ms2;
+  std::shared_ptr<const nui::ThreeBodyModelSpace> ms3;
+};
+
+Spaces MakeSpaces() {
+  const auto sp = MakeSP(2);
+  return {
+      nui::TwoBodyModelSpace::Make(sp),
+      nui::ThreeBodyModelSpace::Make(sp, nui::ThreeBodyTruncation(4))};
+}
+
+// Get hermitian operator filled by FillStored(seed, ...), with a 3-body part
+// (in every stride-th channel) if three_body.
+nui::Operator MakeFilled(
+    const Spaces& spaces,
+    double seed,
+    bool three_body,
+    std::size_t stride) {
+  nui::Operator op(spaces.ms2, Hermiticity::kHermitian);
+  if (three_body) {
+    op.AddThreeBody(spaces.ms3);
+  }
+  FillStored(seed, op, stride);
+  return op;
+}
+
+}  // namespace
+
+TEST_CASE("OperatorKernels, Test linear combination.") {
+  const auto spaces = MakeSpaces();
+  const auto a = MakeFilled(spaces, 0.3, true, 2);
+  const auto b = MakeFilled(spaces, 0.7, false, 1);
+  const auto c = MakeFilled(spaces, 1.1, true, 3);
+  auto y = MakeFilled(spaces, 1.9, true, 5);
+  const auto y_ref = y.Clone();
+
+  const std::vector<double> alphas = {0.5, -1.0, 2.0, 0.25};
+  REQUIRE(nui::LinearCombination(alphas, {&a, &b, &c, &y}, -2.0, y));
+
+  const double beta = -2.0 + 0.25;
+  REQUIRE(
+      y.ZeroBody() ==
+      Catch::Approx(0.5 * 0.3 - 0.7 + 2.0 * 1.1 + beta * 1.9));
+  for (const auto pw : y.SP().PartialWaveIndices()) {
+    for (std::size_t i = 0; i < y.OneBody().BlockSize(pw); i += 1) {
+      const double expected = 0.5 * a.OneBody().Block(pw)[i] -
+                              b.OneBody().Block(pw)[i] +
+                              2.0 * c.OneBody().Block(pw)[i] +
+                              beta * y_ref.OneBody().Block(pw)[i];
+      REQUIRE(y.OneBody().Block(pw)[i] == Catch::Approx(expected));
+    }
+  }
+  for (const auto ch : spaces.ms2->ChannelIndices()) {
+    for (std::size_t i = 0; i < y.TwoBody().ChannelSize(ch); i += 1) {
+      const double expected = 0.5 * a.TwoBody().Block(ch)[i] -
+                              b.TwoBody().Block(ch)[i] +
+                              2.0 * c.TwoBody().Block(ch)[i] +
+                              beta * y_ref.TwoBody().Block(ch)[i];
+      REQUIRE(y.TwoBody().Block(ch)[i] == Catch::Approx(expected));
+    }
+  }
+  for (const auto ch : spaces.ms3->ChannelIndices()) {
+    const bool touched =
+        ch.idx() % 2 == 0 || ch.idx() % 3 == 0 || ch.idx() % 5 == 0;
+    REQUIRE(y.ThreeBody().IsMaterialized(ch) == touched);
+    if (!touched) {
+      continue;
+    }
+    const auto view = y.ThreeBody().Read(ch);
+    for (std::size_t i = 0; i < y.ThreeBody().ChannelSize(ch); i += 1) {
+      double expected = 0.0;
+      if (ch.idx() % 2 == 0) {
+        expected += 0.5 * StoredElement(0.3, ch.idx(), i);
+      }
+      if (ch.idx() % 3 == 0) {
+        expected += 2.0 * StoredElement(1.1, ch.idx(), i);
+      }
+      if (ch.idx() % 5 == 0) {
+        expected += beta * StoredElement(1.9, ch.idx(), i);
+      }
+      REQUIRE(view.Data()[i] == Catch::Approx(expected).margin(1e-14));
+    }
+  }
+}
+
+TEST_CASE("OperatorKernels, Test scale, axpy, and axpby.") {
+  const auto spaces = MakeSpaces();
+  const auto x = MakeFilled(spaces, 0.4, true, 1);
+  auto y = MakeFilled(spaces, 0.9, true, 1);
+  const auto y_ref = y.Clone();
+
+  REQUIRE(nui::Axpby(2.0, x, 0.5, y));
+  REQUIRE(nui::Axpy(-1.0, x, y));
+  nui::Scale(4.0, y);
+  // y = 4 * (x + 0.5 * y_ref).
+  REQUIRE(y.ZeroBody() == Catch::Approx(4.0 * (0.4 + 0.5 * 0.9)));
+  const nui::TwoBodyChannelIndex ch2(3);
+  REQUIRE(
+      y.TwoBody().Block(ch2)[1] ==
+      Catch::Approx(
+          4.0 * (x.TwoBody().Block(ch2)[1] +
+                 0.5 * y_ref.TwoBody().Block(ch2)[1])));
+  const nui::ThreeBodyChannelIndex ch3(2);
+  REQUIRE(
+      y.ThreeBody().Read(ch3).Data()[0] ==
+      Catch::Approx(
+          4.0 * (x.ThreeBody().Read(ch3).Data()[0] +
+                 0.5 * y_ref.ThreeBody().Read(ch3).Data()[0])));
+}
+
+TEST_CASE("OperatorKernels, Test norm.") {
+  const auto spaces = MakeSpaces();
+  const auto x = MakeFilled(spaces, 0.4, true, 3);
+  const double n1 = nui::Norm(x.OneBody());
+  const double n2 = nui::Norm(x.TwoBody());
+  const double n3 = nui::Norm(x.ThreeBody());
+  REQUIRE(n3 > 0.0);
+  REQUIRE(
+      nui::Norm(x) ==
+      Catch::Approx(std::sqrt(0.4 * 0.4 + n1 * n1 + n2 * n2 + n3 * n3)));
+  auto y = x.Clone();
+  y.DropThreeBody();
+  REQUIRE(
+      nui::Norm(y) == Catch::Approx(std::sqrt(0.4 * 0.4 + n1 * n1 + n2 * n2)));
+}
+
+TEST_CASE("OperatorKernels, Test incompatible operators are rejected.") {
+  const auto spaces = MakeSpaces();
+  const auto x = MakeFilled(spaces, 0.4, true, 1);
+  auto y = MakeFilled(spaces, 0.9, false, 1);
+  REQUIRE_FALSE(nui::Axpy(1.0, x, y));
+  REQUIRE(y.ZeroBody() == 0.9);
+  REQUIRE_FALSE(nui::LinearCombination({1.0, 2.0}, {&x}, 1.0, y));
+
+  nui::Operator full(spaces.ms2, Hermiticity::kHermitian, false);
+  REQUIRE_FALSE(nui::Axpy(1.0, full, y));
+}
+
+TEST_CASE("OperatorKernels, Test traffic model.") {
+  const auto spaces = MakeSpaces();
+  const auto x = MakeFilled(spaces, 0.4, false, 1);
+  auto y = MakeFilled(spaces, 0.9, false, 1);
+  const std::size_t bytes = y.StoredBytes();
+  REQUIRE(nui::LinearCombinationTraffic({&x}, 1.0, y) == 3 * bytes);
+  REQUIRE(nui::LinearCombinationTraffic({&x, &x}, 0.0, y) == 3 * bytes);
+  REQUIRE(nui::LinearCombinationTraffic({&x, &y}, 1.0, y) == 3 * bytes);
+}
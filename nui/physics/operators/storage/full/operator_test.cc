@@ -0,0 +1,118 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/full/operator.h"
+
+#include "catch2/catch_test_macros.hpp"
+#include "nui/core/basics/basics.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/storage/3b/op_3b.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+#include "nui/physics/operators/storage/testing/op_testing.h"
+
+namespace {
+
+using nui::Hermiticity;
+using nui::testing::MakeSP;
+
+}  // namespace
+
+TEST_CASE("Operator, Test construction and 3-body part.") {
+  const auto sp = MakeSP(2);
+  const auto ms2 = nui::TwoBodyModelSpace::Make(sp);
+  nui::Operator op(ms2, Hermiticity::kHermitian);
+  REQUIRE(op.ZeroBody() == 0.0);
+  REQUIRE(op.Symmetry() == Hermiticity::kHermitian);
+  REQUIRE(op.TwoBody().IsPacked());
+  REQUIRE_FALSE(op.HasThreeBody());
+
+  const auto other_ms3 = nui::ThreeBodyModelSpace::Make(
+      MakeSP(2),
+      nui::ThreeBodyTruncation(4));
+  REQUIRE_FALSE(op.AddThreeBody(other_ms3));
+  REQUIRE_FALSE(op.HasThreeBody());
+
+  const auto ms3 =
+      nui::ThreeBodyModelSpace::Make(sp, nui::ThreeBodyTruncation(4));
+  REQUIRE(op.AddThreeBody(ms3));
+  REQUIRE(op.HasThreeBody());
+  REQUIRE(op.ThreeBody().Symmetry() == Hermiticity::kHermitian);
+  REQUIRE_FALSE(op.AddThreeBody(ms3));
+
+  // Unmaterialized 3-body channels do not count.
+  const std::size_t bytes = op.StoredBytes();
+  REQUIRE(bytes == (op.OneBody().Blocks().TotalSize() +
+                    op.TwoBody().Blocks().TotalSize()) *
+                       sizeof(double));
+  const nui::ThreeBodyChannelIndex ch(0);
+  op.ThreeBody().Write(ch);
+  REQUIRE(op.StoredBytes() ==
+          bytes + op.ThreeBody().ChannelSize(ch) * sizeof(double));
+
+  op.DropThreeBody();
+  REQUIRE_FALSE(op.HasThreeBody());
+}
+
+TEST_CASE("Operator, Test clone and move.") {
+  const auto sp = MakeSP(2);
+  const auto ms2 = nui::TwoBodyModelSpace::Make(sp);
+  const auto ms3 =
+      nui::ThreeBodyModelSpace::Make(sp, nui::ThreeBodyTruncation(4));
+  nui::Operator op(ms2, Hermiticity::kNone);
+  REQUIRE(op.AddThreeBody(ms3));
+  op.SetZeroBody(-3.0);
+  op.OneBody().MutableBlock(nui::PartialWaveIndex(0))[0] = 1.0;
+  op.TwoBody().MutableBlock(nui::TwoBodyChannelIndex(0))[0] = 2.0;
+  const nui::ThreeBodyChannelIndex ch3(1);
+  op.ThreeBody().Write(ch3).MutableData()[0] = 3.0;
+
+  nui::Operator copy = op.Clone();
+  REQUIRE(copy.ZeroBody() == -3.0);
+  REQUIRE(copy.OneBody().Block(nui::PartialWaveIndex(0))[0] == 1.0);
+  REQUIRE(copy.TwoBody().Block(nui::TwoBodyChannelIndex(0))[0] == 2.0);
+  REQUIRE(copy.ThreeBody().Read(ch3).Data()[0] == 3.0);
+  REQUIRE_FALSE(
+      copy.ThreeBody().IsMaterialized(nui::ThreeBodyChannelIndex(0)));
+
+  // Writes to the clone do not leak into the original.
+  copy.OneBody().MutableBlock(nui::PartialWaveIndex(0))[0] = 10.0;
+  copy.TwoBody().MutableBlock(nui::TwoBodyChannelIndex(0))[0] = 20.0;
+  copy.ThreeBody().Write(ch3).MutableData()[0] = 30.0;
+  REQUIRE(op.OneBody().Block(nui::PartialWaveIndex(0))[0] == 1.0);
+  REQUIRE(op.TwoBody().Block(nui::TwoBodyChannelIndex(0))[0] == 2.0);
+  REQUIRE(op.ThreeBody().Read(ch3).Data()[0] == 3.0);
+
+  // Moves keep the storage.
+  const double* block = op.TwoBody().Block(nui::TwoBodyChannelIndex(0));
+  const nui::ThreeBodyOperator* three_body = &op.ThreeBody();
+  nui::Operator moved = std::move(op);
+  REQUIRE(moved.TwoBody().Block(nui::TwoBodyChannelIndex(0)) == block);
+  REQUIRE(&moved.ThreeBody() == three_body);
+
+  const nui::Operator zero = moved.ZeroLike();
+  REQUIRE(zero.ZeroBody() == 0.0);
+  REQUIRE(zero.HasThreeBody());
+  REQUIRE(zero.TwoBody().Block(nui::TwoBodyChannelIndex(0))[0] == 0.0);
+  REQUIRE(zero.IsCompatible(moved));
+}
@@ -0,0 +1,218 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/io/darmstadt_layout.h"
+
+#include <array>
+
+#include "nui/core/basics/basics.h"
+
+namespace nui {
+
+namespace {
+
+// Get doubled J profile of coupling (j_ab in [j_ab_min, j_ab_max]) with
+// two_jc: profile[(2J - 1) / 2] counts J_ab values that reach 2J.
+void AddThreeBodyProfile(
+    int j_ab_min,
+    int j_ab_max,
+    int two_jc,
+    std::vector<std::size_t>& profile) {
+  for (int j_ab = j_ab_min; j_ab <= j_ab_max; j_ab += 1) {
+    const int two_j_min = std::abs(2 * j_ab - two_jc);
+    const int two_j_max = 2 * j_ab + two_jc;
+    for (int two_j = two_j_min; two_j <= two_j_max; two_j += 2) {
+      const std::size_t idx = static_cast<std::size_t>((two_j - 1) / 2);
+      if (idx >= profile.size()) {
+        profile.resize(idx + 1, 0UL);
+      }
+      profile[idx] += 1;
+    }
+  }
+}
+
+}  // namespace
+
+std::vector<FileOrbit> MakeFileOrbits(int emax) {
+  std::vector<FileOrbit> orbits;
+  for (int e = 0; e <= emax; e += 1) {
+    for (int l = e % 2; l <= e; l += 2) {
+      const int n = (e - l) / 2;
+      if (l > 0) {
+        orbits.push_back({n, l, 2 * l - 1});
+      }
+      orbits.push_back({n, l, 2 * l + 1});
+    }
+  }
+  return orbits;
+}
+
+Me2jLayout::Me2jLayout(int emax, int e2max)
+    : emax_(emax), e2max_(e2max), orbits_(MakeFileOrbits(emax)) {
+  const std::size_t num_orbits = orbits_.size();
+  for (std::size_t a = 0; a < num_orbits; a += 1) {
+    const FileOrbit& oa = orbits_[a];
+    for (std::size_t b = 0; b <= a; b += 1) {
+      const FileOrbit& ob = orbits_[b];
+      if (oa.E() + ob.E() > e2max_) {
+        break;
+      }
+      pairs_.push_back(
+          {static_cast<std::uint16_t>(a),
+           static_cast<std::uint16_t>(b),
+           (oa.l + ob.l) % 2,
+           std::abs(oa.two_j - ob.two_j) / 2,
+           (oa.two_j + ob.two_j) / 2});
+    }
+  }
+
+  // Records of bra p are sum_J n_p(J) * sum_{q <= p, same parity} n_q(J),
+  // where n_p(J) is 1 if J is in the range of p.
+  std::array<std::vector<std::size_t>, 2> prefix;
+  offsets_.reserve(pairs_.size() + 1);
+  offsets_.push_back(0UL);
+  for (const Pair& p : pairs_) {
+    std::vector<std::size_t>& s = prefix[static_cast<std::size_t>(p.parity)];
+    if (s.size() <= static_cast<std::size_t>(p.j_max)) {
+      s.resize(static_cast<std::size_t>(p.j_max) + 1, 0UL);
+    }
+    for (int j = p.j_min; j <= p.j_max; j += 1) {
+      s[static_cast<std::size_t>(j)] += 1;
+    }
+    std::size_t num = 0UL;
+    for (int j = p.j_min; j <= p.j_max; j += 1) {
+      num += s[static_cast<std::size_t>(j)];
+    }
+    offsets_.push_back(offsets_.back() + num);
+  }
+}
+
+Me2jRecord Me2jLayout::Record(std::size_t r) const {
+  Me2jRecord record;
+  VisitRecords(r, r + 1, [&record](std::size_t, const Me2jRecord& x) {
+    record = x;
+  });
+  return record;
+}
+
+Me3jLayout::Me3jLayout(int emax, int e2max, int e3max)
+    : emax_(emax),
+      e2max_(e2max),
+      e3max_(e3max),
+      orbits_(MakeFileOrbits(emax)) {
+  const std::size_t num_orbits = orbits_.size();
+  for (std::size_t a = 0; a < num_orbits; a += 1) {
+    const FileOrbit& oa = orbits_[a];
+    for (std::size_t b = 0; b <= a; b += 1) {
+      const FileOrbit& ob = orbits_[b];
+      if (oa.E() + ob.E() > e2max_) {
+        break;
+      }
+      for (std::size_t c = 0; c <= b; c += 1) {
+        const FileOrbit& oc = orbits_[c];
+        if (oa.E() + ob.E() + oc.E() > e3max_) {
+          break;
+        }
+        triples_.push_back(
+            {static_cast<std::uint16_t>(a),
+             static_cast<std::uint16_t>(b),
+             static_cast<std::uint16_t>(c),
+             (oa.l + ob.l + oc.l) % 2,
+             std::abs(oa.two_j - ob.two_j) / 2,
+             (oa.two_j + ob.two_j) / 2,
+             oc.two_j});
+      }
+    }
+  }
+
+  // Records of bra p are sum_J n_p(J) * sum_{q <= p, same parity} n_q(J),
+  // where n_p(J) is the number of J_ab of p that couple to J.
+  std::array<std::vector<std::size_t>, 2> prefix;
+  std::vector<std::size_t> profile;
+  offsets_.reserve(triples_.size() + 1);
+  offsets_.push_back(0UL);
+  for (const Triple& p : triples_) {
+    std::vector<std::size_t>& s = prefix[static_cast<std::size_t>(p.parity)];
+    profile.clear();
+    AddThreeBodyProfile(p.j_ab_min, p.j_ab_max, p.two_jc, profile);
+    if (s.size() < profile.size()) {
+      s.resize(profile.size(), 0UL);
+    }
+    std::size_t num = 0UL;
+    for (std::size_t i = 0; i < profile.size(); i += 1) {
+      s[i] += profile[i];
+      num += profile[i] * s[i];
+    }
+    offsets_.push_back(offsets_.back() + num);
+  }
+}
+
+Me3jRecord Me3jLayout::Record(std::size_t r) const {
+  Me3jRecord record;
+  VisitRecords(r, r + 1, [&record](std::size_t, const Me3jRecord& x) {
+    record = x;
+  });
+  return record;
+}
+
+std::size_t Me3jLayout::TripleIndex(
+    std::size_t a,
+    std::size_t b,
+    std::size_t c) const {
+  const auto key = [](std::size_t x, std::size_t y, std::size_t z) {
+    return (static_cast<std::uint64_t>(x) << 32) |
+           (static_cast<std::uint64_t>(y) << 16) |
+           static_cast<std::uint64_t>(z);
+  };
+  const std::uint64_t k = key(a, b, c);
+  const auto it = std::lower_bound(
+      triples_.begin(),
+      triples_.end(),
+      k,
+      [&key](const Triple& t, std::uint64_t x) {
+        return key(t.a, t.b, t.c) < x;
+      });
+  if (it == triples_.end() || key(it->a, it->b, it->c) != k) {
+    return triples_.size();
+  }
+  return static_cast<std::size_t>(it - triples_.begin());
+}
+
+std::size_t Me3jLayout::NumRecords(const Triple& bra, const Triple& ket)
+    const {
+  std::size_t num = 0UL;
+  for (int j_ab = bra.j_ab_min; j_ab <= bra.j_ab_max; j_ab += 1) {
+    for (int j_de = ket.j_ab_min; j_de <= ket.j_ab_max; j_de += 1) {
+      const int two_j_min = std::max(
+          std::abs(2 * j_ab - bra.two_jc),
+          std::abs(2 * j_de - ket.two_jc));
+      const int two_j_max =
+          std::min(2 * j_ab + bra.two_jc, 2 * j_de + ket.two_jc);
+      if (two_j_min <= two_j_max) {
+        num += static_cast<std::size_t>((two_j_max - two_j_min) / 2 + 1);
+      }
+    }
+  }
+  return num;
+}
+
+}  // namespace nui
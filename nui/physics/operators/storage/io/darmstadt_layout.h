@@ -0,0 +1,295 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_OPERATORS_STORAGE_IO_DARMSTADT_LAYOUT_H_
+#define NUI_PHYSICS_OPERATORS_STORAGE_IO_DARMSTADT_LAYOUT_H_
+
+// IWYU pragma: private, include "nui/physics/operators/storage/io/op_io.h"
+// IWYU pragma: friend "nui/physics/operators/storage/io/.*\.h"
+
+#include "nui/core/basics/basics.h"
+
+// Value order of isospin-coupled me2j/me3j interaction files.
+//
+// Files list the orbits nlj (without tz) ordered by e = 2n + l, then l, then
+// j. Bra tuples run over a >= b (>= c) in this order, ket tuples over all
+// tuples that are lexicographically <= the bra, both subject to the energy
+// truncation. For each (bra, ket) of equal parity the angular momenta and
+// isospins follow (see Me2jLayout and Me3jLayout).
+//
+// Record offsets are computed with prefix sums over per-tuple J profiles,
+// so layouts are cheap to build even for large files. Records of a range of
+// the value stream are visited without scanning from the start.
+
+namespace nui {
+
+// Orbit nlj of an interaction file.
+struct FileOrbit {
+  int n = 0;
+  int l = 0;
+  int two_j = 0;
+
+  int E() const { return 2 * n + l; }
+};
+
+// Get orbits of an interaction file up to emax in file order.
+std::vector<FileOrbit> MakeFileOrbits(int emax);
+
+// Record of a me2j file: <ab| V |cd>_J with 4 values.
+//
+// The values are, in order: T = 0, T = 1 nn, T = 1 pn, T = 1 pp.
+struct Me2jRecord {
+  std::uint16_t a = 0;
+  std::uint16_t b = 0;
+  std::uint16_t c = 0;
+  std::uint16_t d = 0;
+  int j = 0;
+};
+
+// Compare two records.
+inline bool operator==(const Me2jRecord& x, const Me2jRecord& y) {
+  return x.a == y.a && x.b == y.b && x.c == y.c && x.d == y.d && x.j == y.j;
+}
+
+// Layout of me2j files with e_a <= emax and e_a + e_b <= e2max.
+//
+// For each bra (a, b) and ket (c, d) of equal parity, J runs over the common
+// range of both pairs, and every J has 4 values.
+class Me2jLayout {
+ public:
+  // Number of values per record.
+  static constexpr std::size_t kValuesPerRecord = 4;
+
+  Me2jLayout(int emax, int e2max);
+
+  int Emax() const { return emax_; }
+  int E2max() const { return e2max_; }
+
+  // Get orbits in file order.
+  const std::vector<FileOrbit>& Orbits() const { return orbits_; }
+
+  // Get number of records.
+  std::size_t NumRecords() const { return offsets_.back(); }
+
+  // Get number of values.
+  std::size_t NumValues() const { return kValuesPerRecord * NumRecords(); }
+
+  // Get record.
+  Me2jRecord Record(std::size_t r) const;
+
+  // Visit records [begin, end) in order with f(std::size_t r, Me2jRecord).
+  template <typename F>
+  void VisitRecords(std::size_t begin, std::size_t end, F&& f) const;
+
+ private:
+  struct Pair {
+    std::uint16_t a = 0;
+    std::uint16_t b = 0;
+    int parity = 0;
+    int j_min = 0;
+    int j_max = 0;
+  };
+
+  int emax_ = 0;
+  int e2max_ = 0;
+  std::vector<FileOrbit> orbits_;
+  std::vector<Pair> pairs_;
+  // First record of each bra pair (and total as last entry).
+  std::vector<std::size_t> offsets_;
+};
+
+// Record of a me3j file: <(ab) J_ab, c| V |(de) J_de, f>_J with 5 values.
+//
+// The values are, in order, (T_ab, T_de, 2T) = (0, 0, 1), (0, 1, 1),
+// (1, 0, 1), (1, 1, 1), (1, 1, 3).
+struct Me3jRecord {
+  std::uint16_t a = 0;
+  std::uint16_t b = 0;
+  std::uint16_t c = 0;
+  std::uint16_t d = 0;
+  std::uint16_t e = 0;
+  std::uint16_t f = 0;
+  int j_ab = 0;
+  int j_de = 0;
+  int two_j = 0;
+};
+
+// Compare two records.
+inline bool operator==(const Me3jRecord& x, const Me3jRecord& y) {
+  return x.a == y.a && x.b == y.b && x.c == y.c && x.d == y.d &&
+         x.e == y.e && x.f == y.f && x.j_ab == y.j_ab && x.j_de == y.j_de &&
+         x.two_j == y.two_j;
+}
+
+// Layout of me3j files with e_a <= emax, e_a + e_b <= e2max, and
+// e_a + e_b + e_c <= e3max.
+//
+// For each bra (a, b, c) and ket (d, e, f) of equal parity, J_ab, J_de, and
+// then 2J run over their allowed ranges, and every (J_ab, J_de, 2J) has 5
+// values.
+class Me3jLayout {
+ public:
+  // Number of values per record.
+  static constexpr std::size_t kValuesPerRecord = 5;
+
+  Me3jLayout(int emax, int e2max, int e3max);
+
+  int Emax() const { return emax_; }
+  int E2max() const { return e2max_; }
+  int E3max() const { return e3max_; }
+
+  // Get orbits in file order.
+  const std::vector<FileOrbit>& Orbits() const { return orbits_; }
+
+  // Get number of records.
+  std::size_t NumRecords() const { return offsets_.back(); }
+
+  // Get number of values.
+  std::size_t NumValues() const { return kValuesPerRecord * NumRecords(); }
+
+  // Get record.
+  Me3jRecord Record(std::size_t r) const;
+
+  // Visit records [begin, end) in order with f(std::size_t r, Me3jRecord).
+  template <typename F>
+  void VisitRecords(std::size_t begin, std::size_t end, F&& f) const;
+
+  // Get number of orbit triples.
+  std::size_t NumTriples() const { return triples_.size(); }
+
+  // Get index of orbit triple (a >= b >= c) in file order.
+  //
+  // Returns NumTriples() if the triple is not in the file.
+  std::size_t TripleIndex(std::size_t a, std::size_t b, std::size_t c) const;
+
+ private:
+  struct Triple {
+    std::uint16_t a = 0;
+    std::uint16_t b = 0;
+    std::uint16_t c = 0;
+    int parity = 0;
+    int j_ab_min = 0;
+    int j_ab_max = 0;
+    int two_jc = 0;
+  };
+
+  // Get number of records of bra with ket.
+  std::size_t NumRecords(const Triple& bra, const Triple& ket) const;
+
+  int emax_ = 0;
+  int e2max_ = 0;
+  int e3max_ = 0;
+  std::vector<FileOrbit> orbits_;
+  std::vector<Triple> triples_;
+  // First record of each bra triple (and total as last entry).
+  std::vector<std::size_t> offsets_;
+};
+
+template <typename F>
+void Me2jLayout::VisitRecords(std::size_t begin, std::size_t end, F&& f)
+    const {
+  if (begin >= end) {
+    return;
+  }
+  std::size_t bra = static_cast<std::size_t>(
+      std::upper_bound(offsets_.begin(), offsets_.end(), begin) -
+      offsets_.begin() - 1);
+  std::size_t r = offsets_[bra];
+  for (; bra < pairs_.size(); bra += 1) {
+    const Pair& p = pairs_[bra];
+    for (std::size_t ket = 0; ket <= bra; ket += 1) {
+      const Pair& q = pairs_[ket];
+      if (q.parity != p.parity) {
+        continue;
+      }
+      const int j_min = std::max(p.j_min, q.j_min);
+      const int j_max = std::min(p.j_max, q.j_max);
+      if (j_min > j_max) {
+        continue;
+      }
+      const std::size_t num = static_cast<std::size_t>(j_max - j_min + 1);
+      if (r + num <= begin) {
+        r += num;
+        continue;
+      }
+      for (int j = j_min; j <= j_max; j += 1, r += 1) {
+        if (r < begin) {
+          continue;
+        }
+        if (r >= end) {
+          return;
+        }
+        f(r, Me2jRecord{p.a, p.b, q.a, q.b, j});
+      }
+    }
+  }
+}
+
+template <typename F>
+void Me3jLayout::VisitRecords(std::size_t begin, std::size_t end, F&& f)
+    const {
+  if (begin >= end) {
+    return;
+  }
+  std::size_t bra = static_cast<std::size_t>(
+      std::upper_bound(offsets_.begin(), offsets_.end(), begin) -
+      offsets_.begin() - 1);
+  std::size_t r = offsets_[bra];
+  for (; bra < triples_.size(); bra += 1) {
+    const Triple& p = triples_[bra];
+    for (std::size_t ket = 0; ket <= bra; ket += 1) {
+      const Triple& q = triples_[ket];
+      if (q.parity != p.parity) {
+        continue;
+      }
+      const std::size_t num = NumRecords(p, q);
+      if (r + num <= begin) {
+        r += num;
+        continue;
+      }
+      for (int j_ab = p.j_ab_min; j_ab <= p.j_ab_max; j_ab += 1) {
+        for (int j_de = q.j_ab_min; j_de <= q.j_ab_max; j_de += 1) {
+          const int two_j_min = std::max(
+              std::abs(2 * j_ab - p.two_jc),
+              std::abs(2 * j_de - q.two_jc));
+          const int two_j_max =
+              std::min(2 * j_ab + p.two_jc, 2 * j_de + q.two_jc);
+          for (int two_j = two_j_min; two_j <= two_j_max;
+               two_j += 2, r += 1) {
+            if (r < begin) {
+              continue;
+            }
+            if (r >= end) {
+              return;
+            }
+            f(r,
+              Me3jRecord{p.a, p.b, p.c, q.a, q.b, q.c, j_ab, j_de, two_j});
+          }
+        }
+      }
+    }
+  }
+}
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_OPERATORS_STORAGE_IO_DARMSTADT_LAYOUT_H_
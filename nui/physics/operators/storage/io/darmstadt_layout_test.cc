@@ -0,0 +1,202 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/io/darmstadt_layout.h"
+
+#include "catch2/catch_test_macros.hpp"
+#include "nui/core/basics/basics.h"
+
+namespace {
+
+using nui::FileOrbit;
+
+// Get all me2j records by direct enumeration of the file loops.
+std::vector<nui::Me2jRecord> EnumerateMe2j(int emax, int e2max) {
+  const auto orbits = nui::MakeFileOrbits(emax);
+  const std::size_t n = orbits.size();
+  std::vector<nui::Me2jRecord> records;
+  for (std::size_t a = 0; a < n; a += 1) {
+    for (std::size_t b = 0; b <= a; b += 1) {
+      if (orbits[a].E() + orbits[b].E() > e2max) {
+        continue;
+      }
+      for (std::size_t c = 0; c <= a; c += 1) {
+        for (std::size_t d = 0; d <= (c == a ? b : c); d += 1) {
+          const FileOrbit& oa = orbits[a];
+          const FileOrbit& ob = orbits[b];
+          const FileOrbit& oc = orbits[c];
+          const FileOrbit& od = orbits[d];
+          if (oc.E() + od.E() > e2max ||
+              (oa.l + ob.l + oc.l + od.l) % 2 != 0) {
+            continue;
+          }
+          const int j_min = std::max(
+              std::abs(oa.two_j - ob.two_j),
+              std::abs(oc.two_j - od.two_j)) / 2;
+          const int j_max =
+              std::min(oa.two_j + ob.two_j, oc.two_j + od.two_j) / 2;
+          for (int j = j_min; j <= j_max; j += 1) {
+            records.push_back(
+                {static_cast<std::uint16_t>(a),
+                 static_cast<std::uint16_t>(b),
+                 static_cast<std::uint16_t>(c),
+                 static_cast<std::uint16_t>(d),
+                 j});
+          }
+        }
+      }
+    }
+  }
+  return records;
+}
+
+}  // namespace
+
+TEST_CASE("Darmstadt layout, Test file orbits.") {
+  const auto orbits = nui::MakeFileOrbits(2);
+  REQUIRE(orbits.size() == 6);
+  // 0s1/2, 0p1/2, 0p3/2, 1s1/2, 0d3/2, 0d5/2
+  REQUIRE(orbits[0].two_j == 1);
+  REQUIRE(orbits[1].l == 1);
+  REQUIRE(orbits[1].two_j == 1);
+  REQUIRE(orbits[2].two_j == 3);
+  REQUIRE(orbits[3].n == 1);
+  REQUIRE(orbits[3].l == 0);
+  REQUIRE(orbits[4].l == 2);
+  REQUIRE(orbits[4].two_j == 3);
+  REQUIRE(orbits[5].two_j == 5);
+}
+
+TEST_CASE("Darmstadt layout, Test me2j records.") {
+  for (const auto& [emax, e2max] :
+       std::vector<std::pair<int, int>>{{0, 0}, {2, 4}, {3, 4}}) {
+    const nui::Me2jLayout layout(emax, e2max);
+    const auto expected = EnumerateMe2j(emax, e2max);
+    REQUIRE(layout.NumRecords() == expected.size());
+    REQUIRE(layout.NumValues() == 4 * expected.size());
+
+    std::size_t count = 0;
+    layout.VisitRecords(
+        0,
+        layout.NumRecords(),
+        [&](std::size_t r, const nui::Me2jRecord& record) {
+          REQUIRE(r == count);
+          REQUIRE(record == expected[r]);
+          count += 1;
+        });
+    REQUIRE(count == expected.size());
+
+    // Ranges starting in the middle of a bra.
+    const std::size_t begin = expected.size() / 3;
+    const std::size_t end = 2 * expected.size() / 3 + 1;
+    count = begin;
+    layout.VisitRecords(
+        begin,
+        end,
+        [&](std::size_t r, const nui::Me2jRecord& record) {
+          REQUIRE(r == count);
+          REQUIRE(record == expected[r]);
+          count += 1;
+        });
+    REQUIRE(count == end);
+    REQUIRE(layout.Record(expected.size() - 1) == expected.back());
+  }
+}
+
+TEST_CASE("Darmstadt layout, Test me3j records.") {
+  const int emax = 2;
+  const int e2max = 4;
+  const int e3max = 4;
+  const nui::Me3jLayout layout(emax, e2max, e3max);
+  const auto& orbits = layout.Orbits();
+
+  // Direct enumeration of the file loops.
+  struct Triple {
+    std::size_t a, b, c;
+  };
+  std::vector<Triple> triples;
+  for (std::size_t a = 0; a < orbits.size(); a += 1) {
+    for (std::size_t b = 0; b <= a; b += 1) {
+      for (std::size_t c = 0; c <= b; c += 1) {
+        if (orbits[a].E() + orbits[b].E() <= e2max &&
+            orbits[a].E() + orbits[b].E() + orbits[c].E() <= e3max) {
+          triples.push_back({a, b, c});
+        }
+      }
+    }
+  }
+  std::vector<nui::Me3jRecord> expected;
+  for (std::size_t p = 0; p < triples.size(); p += 1) {
+    for (std::size_t q = 0; q <= p; q += 1) {
+      const FileOrbit& a = orbits[triples[p].a];
+      const FileOrbit& b = orbits[triples[p].b];
+      const FileOrbit& c = orbits[triples[p].c];
+      const FileOrbit& d = orbits[triples[q].a];
+      const FileOrbit& e = orbits[triples[q].b];
+      const FileOrbit& f = orbits[triples[q].c];
+      if ((a.l + b.l + c.l + d.l + e.l + f.l) % 2 != 0) {
+        continue;
+      }
+      for (int j_ab = std::abs(a.two_j - b.two_j) / 2;
+           j_ab <= (a.two_j + b.two_j) / 2;
+           j_ab += 1) {
+        for (int j_de = std::abs(d.two_j - e.two_j) / 2;
+             j_de <= (d.two_j + e.two_j) / 2;
+             j_de += 1) {
+          for (int two_j = 1; two_j <= 2 * j_ab + c.two_j; two_j += 2) {
+            if (std::abs(2 * j_ab - c.two_j) <= two_j &&
+                std::abs(2 * j_de - f.two_j) <= two_j &&
+                two_j <= 2 * j_de + f.two_j) {
+              expected.push_back(
+                  {static_cast<std::uint16_t>(triples[p].a),
+                   static_cast<std::uint16_t>(triples[p].b),
+                   static_cast<std::uint16_t>(triples[p].c),
+                   static_cast<std::uint16_t>(triples[q].a),
+                   static_cast<std::uint16_t>(triples[q].b),
+                   static_cast<std::uint16_t>(triples[q].c),
+                   j_ab,
+                   j_de,
+                   two_j});
+            }
+          }
+        }
+      }
+    }
+  }
+
+  REQUIRE(layout.NumRecords() == expected.size());
+  REQUIRE(layout.NumValues() == 5 * expected.size());
+  std::size_t count = 0;
+  layout.VisitRecords(
+      0,
+      layout.NumRecords(),
+      [&](std::size_t r, const nui::Me3jRecord& record) {
+        REQUIRE(r == count);
+        REQUIRE(record == expected[r]);
+        count += 1;
+      });
+  REQUIRE(count == expected.size());
+  for (const std::size_t r :
+       {std::size_t{0}, expected.size() / 2, expected.size() - 1}) {
+    REQUIRE(layout.Record(r) == expected[r]);
+  }
+}
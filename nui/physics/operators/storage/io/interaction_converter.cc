@@ -0,0 +1,148 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdlib>
+#include <string>
+
+#include "fmt/core.h"
+#include "nui/core/basics/basics.h"
+#include "nui/core/io/io.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+#include "nui/physics/operators/storage/3b/op_3b.h"
+#include "nui/physics/operators/storage/io/op_io.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+
+// Converter of interaction files to the native format.
+//
+// Usage:
+//   nui_interaction_converter me2j <input> <output> <emax> [e2max]
+//   nui_interaction_converter me3j <input> <output> <emax> <e2max> <e3max>
+//
+// me2j files are converted to a hermitian two-body operator in the model
+// space with truncations emax and e2max (default 2 * emax), which must be
+// used again when reading the native file. me3j files are converted to a
+// hermitian three-body operator in the model space with truncations emax and
+// e3max (e2max only describes the file). Inputs may be gzip-compressed and
+// start with one header line.
+
+namespace {
+
+nui::TextStreamOptions ReadOptions() {
+  nui::TextStreamOptions options;
+  options.skip_lines = 1;
+  return options;
+}
+
+void PrintStats(const nui::TextStreamStats& stats) {
+  fmt::print(
+      "read {} values ({} B on disk, {} B text) in {:.3f} s: "
+      "{:.1f} MB/s on disk, {:.1f} MB/s text\n",
+      stats.values,
+      stats.file_bytes,
+      stats.text_bytes,
+      stats.seconds,
+      stats.file_bytes / stats.seconds * 1e-6,
+      stats.text_bytes / stats.seconds * 1e-6);
+}
+
+int ConvertMe2j(
+    const std::string& input,
+    const std::string& output,
+    int emax,
+    int e2max) {
+  const auto ms = nui::TwoBodyModelSpace::Make(
+      nui::SPModelSpace::Make(nui::SPTruncation(emax), nui::Reference()),
+      nui::TwoBodyTruncation{e2max});
+  nui::TwoBodyOperator op(ms, nui::Hermiticity::kHermitian);
+  nui::TextStreamStats stats;
+  if (!nui::ReadMe2j(
+          input,
+          nui::Me2jLayout(emax, e2max),
+          ReadOptions(),
+          op,
+          &stats)) {
+    fmt::print(stderr, "error: could not read me2j file {}\n", input);
+    return EXIT_FAILURE;
+  }
+  PrintStats(stats);
+  if (!nui::WriteNativeOperator(output, op)) {
+    fmt::print(stderr, "error: could not write {}\n", output);
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+int ConvertMe3j(
+    const std::string& input,
+    const std::string& output,
+    int emax,
+    int e2max,
+    int e3max) {
+  const auto ms = nui::ThreeBodyModelSpace::Make(
+      nui::SPModelSpace::Make(nui::SPTruncation(emax), nui::Reference()),
+      nui::ThreeBodyTruncation(e3max));
+  nui::ThreeBodyOperator op(ms, nui::Hermiticity::kHermitian);
+  nui::TextStreamStats stats;
+  if (!nui::ReadMe3j(
+          input,
+          nui::Me3jLayout(emax, e2max, e3max),
+          ReadOptions(),
+          op,
+          &stats)) {
+    fmt::print(stderr, "error: could not read me3j file {}\n", input);
+    return EXIT_FAILURE;
+  }
+  PrintStats(stats);
+  if (!nui::WriteNativeOperator(output, op)) {
+    fmt::print(stderr, "error: could not write {}\n", output);
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::string format = argc > 1 ? argv[1] : "";
+  if (format == "me2j" && (argc == 5 || argc == 6)) {
+    const int emax = std::atoi(argv[4]);
+    const int e2max = argc > 5 ? std::atoi(argv[5]) : 2 * emax;
+    return ConvertMe2j(argv[2], argv[3], emax, e2max);
+  }
+  if (format == "me3j" && argc == 7) {
+    return ConvertMe3j(
+        argv[2],
+        argv[3],
+        std::atoi(argv[4]),
+        std::atoi(argv[5]),
+        std::atoi(argv[6]));
+  }
+  fmt::print(
+      stderr,
+      "usage: {0} me2j <input> <output> <emax> [e2max]\n"
+      "       {0} me3j <input> <output> <emax> <e2max> <e3max>\n",
+      argv[0]);
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,187 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+#include "fmt/core.h"
+#include "nui/core/basics/basics.h"
+#include "nui/core/io/io.h"
+#include "nui/info/profiling/profiling.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+#include "nui/physics/operators/storage/io/op_io.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+
+// Benchmark of interaction file formats.
+//
+// Usage: nui_..._interaction_io_bench [emax] [e2max] [directory]
+//
+// Writes a synthetic me2j file (plain and gzip) and reports throughput of
+// a naive single-threaded parse, the streaming reader, and writing and
+// mapping the native format, in MB/s of file size.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::size_t FileSize(const std::string& path) {
+  std::ifstream in(path, std::ios::binary | std::ios::ate);
+  return in ? static_cast<std::size_t>(in.tellg()) : 0UL;
+}
+
+void Report(std::string_view name, std::size_t bytes, double seconds) {
+  fmt::print(
+      "{:<28} {:>14} {:>10.3f} {:>10.1f}\n",
+      name,
+      bytes,
+      seconds,
+      bytes / seconds * 1e-6);
+}
+
+std::string MakeText(std::size_t n) {
+  std::string text = "synthetic me2j file\n";
+  text.reserve(n * 16);
+  for (std::size_t k = 0; k < n; k += 1) {
+    text += fmt::format(
+        "{:.8f}{}",
+        1e-1 * std::sin(1.0 + 0.37 * k),
+        k % 10 == 9 ? "\n" : " ");
+  }
+  return text;
+}
+
+// Parse with std::ifstream on one thread (the usual approach).
+double NaiveParse(const std::string& path, std::size_t n) {
+  const auto start = Clock::now();
+  std::ifstream in(path);
+  std::string header;
+  std::getline(in, header);
+  std::vector<double> values;
+  values.reserve(n);
+  double x = 0.0;
+  while (in >> x) {
+    values.push_back(x);
+  }
+  const double seconds = nui::SecondsSince(start);
+  if (values.size() != n) {
+    fmt::print(stderr, "naive parse read {} of {} values\n", values.size(), n);
+  }
+  return seconds;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int emax = argc > 1 ? std::atoi(argv[1]) : 6;
+  const int e2max = argc > 2 ? std::atoi(argv[2]) : 2 * emax;
+  const nui::TempDirectory dir(
+      "nui_interaction_io_bench",
+      argc > 3 ? argv[3] : nui::TempDirectoryRoot());
+  if (!dir.IsValid()) {
+    fmt::print(stderr, "error: could not create a directory\n");
+    return EXIT_FAILURE;
+  }
+  const std::string plain = dir.File("interaction.me2j");
+  const std::string gz = dir.File("interaction.me2j.gz");
+  const std::string native = dir.File("interaction.nui");
+
+  const nui::Me2jLayout layout(emax, e2max);
+  const auto ms = nui::TwoBodyModelSpace::Make(
+      nui::SPModelSpace::Make(nui::SPTruncation(emax), nui::Reference()),
+      nui::TwoBodyTruncation{e2max});
+  ms->BuildAllChannels();
+  {
+    const std::string text = MakeText(layout.NumValues());
+    if (!nui::WriteFileAtomically(plain, {{text.data(), text.size()}}) ||
+        !nui::WriteGzipFile(gz, text, 6)) {
+      fmt::print(stderr, "error: could not write files to {}\n", dir.Path());
+      return EXIT_FAILURE;
+    }
+  }
+  fmt::print(
+      "emax = {}, e2max = {}, values = {}, text = {} B, gzip = {} B\n\n",
+      emax,
+      e2max,
+      layout.NumValues(),
+      FileSize(plain),
+      FileSize(gz));
+  fmt::print(
+      "{:<28} {:>14} {:>10} {:>10}\n",
+      "format",
+      "bytes",
+      "time [s]",
+      "MB/s");
+
+  Report(
+      "me2j text, naive",
+      FileSize(plain),
+      NaiveParse(plain, layout.NumValues()));
+
+  nui::TextStreamOptions options;
+  options.skip_lines = 1;
+  nui::TwoBodyOperator op(ms, nui::Hermiticity::kHermitian);
+  for (const auto& [name, path] :
+       {std::pair<std::string_view, std::string>{"me2j text, streaming", plain},
+        {"me2j gzip, streaming", gz}}) {
+    nui::TwoBodyOperator x(ms, nui::Hermiticity::kHermitian);
+    nui::TextStreamStats stats;
+    if (!nui::ReadMe2j(path, layout, options, x, &stats)) {
+      fmt::print(stderr, "error: could not read {}\n", path);
+      return EXIT_FAILURE;
+    }
+    Report(name, stats.file_bytes, stats.seconds);
+    op = std::move(x);
+  }
+
+  auto start = Clock::now();
+  nui::WriteNativeOperator(native, op);
+  const std::size_t native_bytes = FileSize(native);
+  Report("native, write", native_bytes, nui::SecondsSince(start));
+
+  for (const bool verify : {false, true}) {
+    nui::TwoBodyOperator x(ms, nui::Hermiticity::kHermitian);
+    start = Clock::now();
+    nui::ReadNativeOperator(native, x, verify);
+    // Touch all blocks, so that page faults are included.
+    double sum = 0.0;
+    for (const auto ch : ms->ChannelIndices()) {
+      const double* block = x.Block(ch);
+      for (std::size_t i = 0; i < x.ChannelSize(ch); i += 1) {
+        sum += block[i];
+      }
+    }
+    Report(
+        verify ? "native, map + verify" : "native, map",
+        native_bytes,
+        nui::SecondsSince(start));
+    if (!std::isfinite(sum)) {
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,571 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/io/interaction_reader.h"
+
+#include <array>
+#include <tuple>
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/io/io.h"
+#include "nui/info/runtime/runtime.h"
+#include "nui/physics/coupling/coupling.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+#include "nui/physics/operators/storage/3b/op_3b.h"
+#include "nui/physics/operators/storage/io/darmstadt_layout.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+
+namespace nui {
+
+namespace {
+
+// Scatters me2j records into the blocks of a two-body operator.
+class Me2jScatter {
+ public:
+  Me2jScatter(const Me2jLayout& layout, TwoBodyOperator& op)
+      : layout_(layout),
+        ms_(op.ModelSpace()),
+        packed_(op.IsPacked()),
+        blocks_(op.NumChannels(), nullptr),
+        dims_(op.NumChannels(), 0UL) {
+    ms_.BuildAllChannels();
+    op.PrepareWrites();
+    for (const auto ch : ms_.ChannelIndices()) {
+      blocks_[ch.idx()] = op.MutableBlock(ch);
+      dims_[ch.idx()] = op.ChannelDimension(ch);
+    }
+    const SPModelSpace& sp = ms_.SP();
+    for (const FileOrbit& o : layout_.Orbits()) {
+      for (const int two_tz : {-1, 1}) {
+        orbitals_.push_back(sp.Index(PackedOrbital(o.n, o.l, o.two_j, two_tz)));
+      }
+    }
+  }
+
+  // Scatter values [first, first + count) of the stream.
+  void operator()(std::size_t first, const double* values, std::size_t count)
+      const {
+    constexpr std::size_t kNum = Me2jLayout::kValuesPerRecord;
+    const std::size_t last = std::min(first + count, layout_.NumValues());
+    layout_.VisitRecords(
+        first / kNum,
+        (last + kNum - 1) / kNum,
+        [&](std::size_t r, const Me2jRecord& record) {
+          const std::size_t begin = std::max(r * kNum, first);
+          const std::size_t end = std::min((r + 1) * kNum, last);
+          for (std::size_t k = begin; k < end; k += 1) {
+            ScatterValue(record, k % kNum, values[k - first]);
+          }
+        });
+  }
+
+ private:
+  static constexpr int kProton = 0;
+  static constexpr int kNeutron = 1;
+
+  // Get coefficient of isospin T in pn pair (a, b) with first orbital t.
+  static double PnCoefficient(bool same_orbit, int j, int t, int first_t) {
+    const double sigma = first_t == kProton ? 1.0 : -1.0;
+    if (same_orbit) {
+      if ((j + t) % 2 == 0) {
+        return 0.0;
+      }
+      return t == 1 ? 1.0 : sigma;
+    }
+    return (t == 1 ? 1.0 : sigma) * M_SQRT1_2;
+  }
+
+  void ScatterValue(const Me2jRecord& r, std::size_t slot, double v) const {
+    if (v == 0.0) {
+      return;
+    }
+    if (slot == 1 || slot == 3) {
+      const int t = slot == 1 ? kNeutron : kProton;
+      Add(r, t, t, t, t, v);
+      return;
+    }
+    const int iso_t = slot == 0 ? 0 : 1;
+    const bool same_bra = r.a == r.b;
+    const bool same_ket = r.c == r.d;
+    for (const int ta : {kProton, kNeutron}) {
+      if (same_bra && ta == kNeutron) {
+        continue;
+      }
+      const double c_bra = PnCoefficient(same_bra, r.j, iso_t, ta);
+      for (const int tc : {kProton, kNeutron}) {
+        if (same_ket && tc == kNeutron) {
+          continue;
+        }
+        const double c_ket = PnCoefficient(same_ket, r.j, iso_t, tc);
+        if (c_bra != 0.0 && c_ket != 0.0) {
+          Add(r, ta, 1 - ta, tc, 1 - tc, c_bra * c_ket * v);
+        }
+      }
+    }
+  }
+
+  // Add v to <a b; J| V |c d; J> with orbitals of isospin projections t.
+  void Add(const Me2jRecord& r, int ta, int tb, int tc, int td, double v)
+      const {
+    OrbitalIndex a = orbitals_[2 * r.a + ta];
+    OrbitalIndex b = orbitals_[2 * r.b + tb];
+    OrbitalIndex c = orbitals_[2 * r.c + tc];
+    OrbitalIndex d = orbitals_[2 * r.d + td];
+    if (a == OrbitalIndex::Invalid() || b == OrbitalIndex::Invalid() ||
+        c == OrbitalIndex::Invalid() || d == OrbitalIndex::Invalid()) {
+      return;
+    }
+    const FileOrbit& oa = layout_.Orbits()[r.a];
+    const FileOrbit& ob = layout_.Orbits()[r.b];
+    const FileOrbit& oc = layout_.Orbits()[r.c];
+    const FileOrbit& od = layout_.Orbits()[r.d];
+    const int two_j = 2 * r.j;
+    const TwoBodyChannelIndex ch = ms_.ChannelIndex(PackedChannel(
+        two_j,
+        (oa.l + ob.l) % 2,
+        2 * (ta + tb) - 2));
+    if (ch == TwoBodyChannelIndex::Invalid()) {
+      return;
+    }
+    if (a > b) {
+      std::swap(a, b);
+      v *= SwapPhase(oa.two_j, ob.two_j, two_j);
+    }
+    if (c > d) {
+      std::swap(c, d);
+      v *= SwapPhase(oc.two_j, od.two_j, two_j);
+    }
+    const TwoBodyStateIndex i = ms_.StateIndex(ch, a, b);
+    const TwoBodyStateIndex j = ms_.StateIndex(ch, c, d);
+    if (i == TwoBodyStateIndex::Invalid() ||
+        j == TwoBodyStateIndex::Invalid()) {
+      return;
+    }
+    // Combinations of the same file pair in bra and ket are transposes of
+    // each other, so only one of them is added.
+    if (r.a == r.c && r.b == r.d && i > j) {
+      return;
+    }
+    double* block = blocks_[ch.idx()];
+    const std::size_t n = dims_[ch.idx()];
+    const std::size_t x = std::min(i.idx(), j.idx());
+    const std::size_t y = std::max(i.idx(), j.idx());
+    if (packed_) {
+      double& e = block[PackedIndex(x, y)];
+#pragma omp atomic
+      e += v;
+      return;
+    }
+    double& e = block[x * n + y];
+#pragma omp atomic
+    e += v;
+    if (x != y) {
+      double& f = block[y * n + x];
+#pragma omp atomic
+      f += v;
+    }
+  }
+
+  const Me2jLayout& layout_;
+  const TwoBodyModelSpace& ms_;
+  bool packed_ = false;
+  std::vector<double*> blocks_;
+  std::vector<std::size_t> dims_;
+  // Model space orbital of file orbit f and tz (proton, neutron) at 2f + t.
+  std::vector<OrbitalIndex> orbitals_;
+};
+
+// State |(xy) J_xy, z; J> with the orbitals of a state |(ab) J_ab, c; J>
+// at positions order (0 for a, 1 for b, 2 for c), with coefficient.
+struct OrderedTerm {
+  std::array<int, 3> order;
+  int two_jxy = 0;
+  double coefficient = 0.0;
+};
+
+// Append expansion of |(ab) J_ab, c; J> in states |(xy) J_xy, z; J> with
+// keys[x] >= keys[y] >= keys[z] to terms.
+void ExpandInKeyOrder(
+    const std::array<int, 3>& keys,
+    const std::array<int, 3>& two_js,
+    int two_jab,
+    int two_j,
+    std::vector<OrderedTerm>& terms) {
+  const int two_ja = two_js[0];
+  const int two_jb = two_js[1];
+  const int two_jc = two_js[2];
+  if (keys[2] <= keys[0] && keys[2] <= keys[1]) {
+    if (keys[0] >= keys[1]) {
+      terms.push_back({{0, 1, 2}, two_jab, 1.0});
+    } else {
+      terms.push_back(
+          {{1, 0, 2}, two_jab, SwapPhase(two_ja, two_jb, two_jab)});
+    }
+    return;
+  }
+  if (keys[0] <= keys[1]) {
+    // |(ab) J_ab, c> = sum_J' R |(bc) J', a>.
+    for (int two_jp = std::abs(two_jb - two_jc); two_jp <= two_jb + two_jc;
+         two_jp += 2) {
+      double coefficient =
+          CyclicRecoupling(two_ja, two_jb, two_jc, two_jab, two_jp, two_j);
+      if (coefficient == 0.0) {
+        continue;
+      }
+      if (keys[1] >= keys[2]) {
+        terms.push_back({{1, 2, 0}, two_jp, coefficient});
+      } else {
+        coefficient *= SwapPhase(two_jb, two_jc, two_jp);
+        terms.push_back({{2, 1, 0}, two_jp, coefficient});
+      }
+    }
+    return;
+  }
+  // |(ab) J_ab, c> = P |(ba) J_ab, c> = P sum_J' R |(ac) J', b>.
+  const double phase = SwapPhase(two_ja, two_jb, two_jab);
+  for (int two_jp = std::abs(two_ja - two_jc); two_jp <= two_ja + two_jc;
+       two_jp += 2) {
+    double coefficient =
+        phase *
+        CyclicRecoupling(two_jb, two_ja, two_jc, two_jab, two_jp, two_j);
+    if (coefficient == 0.0) {
+      continue;
+    }
+    if (keys[0] >= keys[2]) {
+      terms.push_back({{0, 2, 1}, two_jp, coefficient});
+    } else {
+      coefficient *= SwapPhase(two_ja, two_jc, two_jp);
+      terms.push_back({{2, 0, 1}, two_jp, coefficient});
+    }
+  }
+}
+
+// Scatters me3j records into the channels of a three-body operator.
+//
+// A file state is a proton-neutron state |(xy) J_xy, z; J> whose orbits are
+// a triple of the file in file order, with isospin projections given by a
+// pattern (bit k set for a neutron in position k). For each file triple, the
+// canonical states of op are listed by the file states they contain.
+class Me3jScatter {
+ public:
+  Me3jScatter(const Me3jLayout& layout, ThreeBodyOperator& op)
+      : layout_(layout),
+        packed_(op.IsPacked()),
+        terms_(layout.NumTriples()) {
+    const ThreeBodyModelSpace& ms = op.ModelSpace();
+    const SPModelSpace& sp = ms.SP();
+    keys_.assign(sp.NumOrbitals(), -1);
+    for (std::size_t f = 0; f < layout_.Orbits().size(); f += 1) {
+      const FileOrbit& o = layout_.Orbits()[f];
+      for (const int t : {kProton, kNeutron}) {
+        const OrbitalIndex i =
+            sp.Index(PackedOrbital(o.n, o.l, o.two_j, 2 * t - 1));
+        if (i != OrbitalIndex::Invalid()) {
+          keys_[i.idx()] = static_cast<int>(2 * f) + t;
+        }
+      }
+    }
+    for (int pattern = 0; pattern < 8; pattern += 1) {
+      const int two_ta = 2 * (pattern & 1) - 1;
+      const int two_tb = (pattern & 2) - 1;
+      const int two_tc = (pattern & 4) / 2 - 1;
+      for (std::size_t k = 0; k < 3; k += 1) {
+        const int two_tab = k == 0 ? 0 : 2;
+        const int two_t = k == 2 ? 3 : 1;
+        isospin_[pattern][k] =
+            ClebschGordan(1, two_ta, 1, two_tb, two_tab, two_ta + two_tb) *
+            ClebschGordan(
+                two_tab,
+                two_ta + two_tb,
+                1,
+                two_tc,
+                two_t,
+                two_ta + two_tb + two_tc);
+      }
+    }
+
+    refs_.reserve(op.NumChannels());
+    for (const auto ch : ms.ChannelIndices()) {
+      refs_.push_back(op.Write(ch));
+      blocks_.push_back(refs_.back().MutableData());
+      dims_.push_back(op.ChannelDimension(ch));
+    }
+    BuildTerms(ms);
+  }
+
+  // Scatter values [first, first + count) of the stream.
+  void operator()(std::size_t first, const double* values, std::size_t count)
+      const {
+    constexpr std::size_t kNum = Me3jLayout::kValuesPerRecord;
+    const std::size_t last = std::min(first + count, layout_.NumValues());
+    layout_.VisitRecords(
+        first / kNum,
+        (last + kNum - 1) / kNum,
+        [&](std::size_t r, const Me3jRecord& record) {
+          const std::size_t bra =
+              layout_.TripleIndex(record.a, record.b, record.c);
+          const std::size_t ket =
+              layout_.TripleIndex(record.d, record.e, record.f);
+          const std::size_t begin = std::max(r * kNum, first);
+          const std::size_t end = std::min((r + 1) * kNum, last);
+          for (std::size_t k = begin; k < end; k += 1) {
+            ScatterValue(record, bra, ket, k % kNum, values[k - first]);
+          }
+        });
+  }
+
+ private:
+  static constexpr int kProton = 0;
+  static constexpr int kNeutron = 1;
+
+  // Canonical state of op in a file state (J, J_xy, pattern) of a triple.
+  struct Term {
+    int two_j = 0;
+    int j_xy = 0;
+    int pattern = 0;
+    std::uint32_t channel = 0;
+    std::uint32_t state = 0;
+    double coefficient = 0.0;
+  };
+
+  // Get order of terms by file state.
+  static bool Before(const Term& x, const Term& y) {
+    return std::make_tuple(x.two_j, x.j_xy, x.pattern) <
+           std::make_tuple(y.two_j, y.j_xy, y.pattern);
+  }
+
+  void BuildTerms(const ThreeBodyModelSpace& ms) {
+    const SPModelSpace& sp = ms.SP();
+    std::vector<std::vector<std::pair<std::size_t, Term>>> channel_terms(
+        ms.NumChannels());
+#pragma omp parallel num_threads(NumParallelThreads())
+    {
+      std::vector<OrderedTerm> ordered;
+#pragma omp for schedule(dynamic)
+      for (std::size_t c = 0; c < ms.NumChannels(); c += 1) {
+        const ThreeBodyChannel& channel =
+            ms.Channel(ThreeBodyChannelIndex(c));
+        const int two_j = channel.QuantumNumbers().TwoJ();
+        for (const auto i : channel.StateIndices()) {
+          const ThreeBodyState st = channel.State(i);
+          const std::array<std::uint16_t, 3> orbitals = {st.a, st.b, st.c};
+          std::array<int, 3> keys;
+          std::array<int, 3> two_js;
+          for (std::size_t k = 0; k < 3; k += 1) {
+            keys[k] = keys_[orbitals[k]];
+            two_js[k] = sp.Orbital(OrbitalIndex(orbitals[k])).TwoJ();
+          }
+          if (std::min({keys[0], keys[1], keys[2]}) < 0) {
+            continue;
+          }
+          ordered.clear();
+          ExpandInKeyOrder(keys, two_js, st.two_jab, two_j, ordered);
+          for (const OrderedTerm& o : ordered) {
+            const int x = keys[o.order[0]];
+            const int y = keys[o.order[1]];
+            const int z = keys[o.order[2]];
+            const std::size_t triple = layout_.TripleIndex(
+                static_cast<std::size_t>(x / 2),
+                static_cast<std::size_t>(y / 2),
+                static_cast<std::size_t>(z / 2));
+            if (triple == layout_.NumTriples()) {
+              break;
+            }
+            Term term;
+            term.two_j = two_j;
+            term.j_xy = o.two_jxy / 2;
+            term.pattern = x % 2 + 2 * (y % 2) + 4 * (z % 2);
+            term.channel = static_cast<std::uint32_t>(c);
+            term.state = static_cast<std::uint32_t>(i.idx());
+            term.coefficient = o.coefficient;
+            channel_terms[c].push_back({triple, term});
+          }
+        }
+      }
+    }
+    for (auto& list : channel_terms) {
+      for (const auto& [triple, term] : list) {
+        terms_[triple].push_back(term);
+      }
+      std::vector<std::pair<std::size_t, Term>>().swap(list);
+    }
+#pragma omp parallel for schedule(dynamic) num_threads(NumParallelThreads())
+    for (std::size_t t = 0; t < terms_.size(); t += 1) {
+      std::sort(terms_[t].begin(), terms_[t].end(), Before);
+    }
+  }
+
+  // Get terms of file states (J, J_xy, any pattern) of triple.
+  std::pair<const Term*, const Term*> Terms(
+      std::size_t triple,
+      int two_j,
+      int j_xy) const {
+    const std::vector<Term>& terms = terms_[triple];
+    const auto lo = std::lower_bound(
+        terms.begin(),
+        terms.end(),
+        std::make_pair(two_j, j_xy),
+        [](const Term& x, const std::pair<int, int>& key) {
+          return std::make_pair(x.two_j, x.j_xy) < key;
+        });
+    auto hi = lo;
+    while (hi != terms.end() && hi->two_j == two_j && hi->j_xy == j_xy) {
+      ++hi;
+    }
+    return {terms.data() + (lo - terms.begin()),
+            terms.data() + (hi - terms.begin())};
+  }
+
+  void ScatterValue(
+      const Me3jRecord& r,
+      std::size_t bra,
+      std::size_t ket,
+      std::size_t slot,
+      double v) const {
+    // Isospin couplings (T_ab, 2T) of bra and ket: (0, 1), (1, 1), (1, 3).
+    constexpr std::size_t kBra[] = {0, 0, 1, 1, 2};
+    constexpr std::size_t kKet[] = {0, 1, 0, 1, 2};
+    if (v == 0.0 || bra == layout_.NumTriples() ||
+        ket == layout_.NumTriples()) {
+      return;
+    }
+    const auto [bra_begin, bra_end] = Terms(bra, r.two_j, r.j_ab);
+    const auto [ket_begin, ket_end] = Terms(ket, r.two_j, r.j_de);
+    for (const Term* x = bra_begin; x != bra_end; ++x) {
+      const double vx =
+          x->coefficient * isospin_[x->pattern][kBra[slot]] * v;
+      if (vx == 0.0) {
+        continue;
+      }
+      for (const Term* y = ket_begin; y != ket_end; ++y) {
+        if (y->channel != x->channel) {
+          continue;
+        }
+        const double vy = y->coefficient * isospin_[y->pattern][kKet[slot]];
+        if (vy != 0.0) {
+          Add(x->channel, x->state, y->state, bra == ket, vx * vy);
+        }
+      }
+    }
+  }
+
+  // Add v to element (i, j) of channel.
+  //
+  // Elements between two triples are listed once in the file and are added
+  // to the stored triangle. Within a triple both orders are listed, so only
+  // i <= j is added.
+  void Add(
+      std::uint32_t ch,
+      std::uint32_t i,
+      std::uint32_t j,
+      bool same_triple,
+      double v) const {
+    if (same_triple && i > j) {
+      return;
+    }
+    double* block = blocks_[ch];
+    const std::size_t n = dims_[ch];
+    const std::size_t x = std::min(i, j);
+    const std::size_t y = std::max(i, j);
+    if (packed_) {
+      double& e = block[PackedIndex(x, y)];
+#pragma omp atomic
+      e += v;
+      return;
+    }
+    double& e = block[x * n + y];
+#pragma omp atomic
+    e += v;
+    if (x != y) {
+      double& f = block[y * n + x];
+#pragma omp atomic
+      f += v;
+    }
+  }
+
+  const Me3jLayout& layout_;
+  bool packed_ = false;
+  // File orbit f and isospin projection t of each orbital as 2f + t (or -1).
+  std::vector<int> keys_;
+  // Isospin Clebsch-Gordan coefficients of each pattern in (T_ab, 2T).
+  double isospin_[8][3] = {};
+  std::vector<ThreeBodyChannelRef> refs_;
+  std::vector<double*> blocks_;
+  std::vector<std::size_t> dims_;
+  // Terms of each file triple, sorted by file state.
+  std::vector<std::vector<Term>> terms_;
+};
+
+}  // namespace
+
+bool ReadMe2j(
+    const std::string& path,
+    const Me2jLayout& layout,
+    const TextStreamOptions& options,
+    TwoBodyOperator& op,
+    TextStreamStats* stats) {
+  if (op.Symmetry() == Hermiticity::kAntihermitian) {
+    return false;
+  }
+  const Me2jScatter scatter(layout, op);
+  TextStreamStats local_stats;
+  const bool success = StreamNumbers(
+      path,
+      options,
+      [&scatter](std::size_t first, const double* values, std::size_t count) {
+        scatter(first, values, count);
+      },
+      &local_stats);
+  if (stats != nullptr) {
+    *stats = local_stats;
+  }
+  return success && local_stats.values == layout.NumValues();
+}
+
+bool ReadMe3j(
+    const std::string& path,
+    const Me3jLayout& layout,
+    const TextStreamOptions& options,
+    ThreeBodyOperator& op,
+    TextStreamStats* stats) {
+  if (op.Symmetry() == Hermiticity::kAntihermitian) {
+    return false;
+  }
+  const Me3jScatter scatter(layout, op);
+  TextStreamStats local_stats;
+  const bool success = StreamNumbers(
+      path,
+      options,
+      [&scatter](std::size_t first, const double* values, std::size_t count) {
+        scatter(first, values, count);
+      },
+      &local_stats);
+  if (stats != nullptr) {
+    *stats = local_stats;
+  }
+  return success && local_stats.values == layout.NumValues();
+}
+
+}  // namespace nui
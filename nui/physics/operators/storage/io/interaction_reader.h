@@ -0,0 +1,77 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_OPERATORS_STORAGE_IO_INTERACTION_READER_H_
+#define NUI_PHYSICS_OPERATORS_STORAGE_IO_INTERACTION_READER_H_
+
+// IWYU pragma: private, include "nui/physics/operators/storage/io/op_io.h"
+// IWYU pragma: friend "nui/physics/operators/storage/io/.*\.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/io/io.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+#include "nui/physics/operators/storage/3b/op_3b.h"
+#include "nui/physics/operators/storage/io/darmstadt_layout.h"
+
+namespace nui {
+
+// Read me2j file (plain or gzip) into two-body operator.
+//
+// The file is streamed with StreamNumbers(), and values are scattered into
+// op as they are parsed: T = 1 nn and pp values are stored directly, pn
+// elements are accumulated from their T = 0 and T = 1 parts. Elements with
+// orbitals outside the model space of op are skipped. op must be zero and
+// not antihermitian; for Hermiticity::kNone both triangles are written.
+//
+// Returns false if the file cannot be read, holds invalid numbers, or does
+// not hold exactly layout.NumValues() numbers.
+bool ReadMe2j(
+    const std::string& path,
+    const Me2jLayout& layout,
+    const TextStreamOptions& options,
+    TwoBodyOperator& op,
+    TextStreamStats* stats = nullptr);
+
+// Read me3j file (plain or gzip) into three-body operator.
+//
+// Records hold elements between antisymmetrized isospin-coupled states
+// |(ab) J_ab T_ab, c; J T> with the orbits in file order. Every canonical
+// state of op is expanded once in proton-neutron states of the same orbitals
+// in file order (one swap phase or one 6j recoupling), and those are
+// isospin-decoupled with Clebsch-Gordan coefficients. The expansion is kept
+// per file triple, so values are scattered into op as they are parsed.
+// Elements with orbitals outside the model space of op or triples outside
+// the file are skipped. op must be zero and not antihermitian; all its
+// channels are materialized and stay pinned while the file is read.
+//
+// Returns false if the file cannot be read, holds invalid numbers, or does
+// not hold exactly layout.NumValues() numbers.
+bool ReadMe3j(
+    const std::string& path,
+    const Me3jLayout& layout,
+    const TextStreamOptions& options,
+    ThreeBodyOperator& op,
+    TextStreamStats* stats = nullptr);
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_OPERATORS_STORAGE_IO_INTERACTION_READER_H_
@@ -0,0 +1,458 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/io/interaction_reader.h"
+
+#include <array>
+#include <cmath>
+#include <map>
+#include <tuple>
+
+#include "catch2/catch_approx.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "nui/core/basics/basics.h"
+#include "nui/core/io/io.h"
+#include "nui/physics/coupling/coupling.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+#include "nui/physics/operators/storage/3b/op_3b.h"
+#include "nui/physics/operators/storage/io/darmstadt_layout.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+#include "nui/physics/operators/storage/testing/op_testing.h"
+
+namespace {
+
+using nui::Hermiticity;
+using nui::OrbitalIndex;
+using nui::testing::MakeThreeBodyModelSpace;
+using nui::testing::MakeTwoBodyModelSpace;
+
+double Value(std::size_t k) { return std::sin(1.0 + 0.37 * k); }
+
+// Get text of file with n synthetic values after one header line.
+std::string MakeText(std::size_t n) {
+  std::string text = "header line\n";
+  for (std::size_t k = 0; k < n; k += 1) {
+    text += fmt::format("{:.17g}{}", Value(k), k % 10 == 9 ? "\n" : " ");
+  }
+  return text;
+}
+
+bool WriteText(const std::string& path, const std::string& text) {
+  return nui::WriteFileAtomically(path, {{text.data(), text.size()}});
+}
+
+nui::TextStreamOptions HeaderOptions(std::size_t chunk_bytes) {
+  nui::TextStreamOptions options;
+  options.chunk_bytes = chunk_bytes;
+  options.skip_lines = 1;
+  return options;
+}
+
+// Get coefficient of isospin t in pn pair with proton (first_proton) first.
+double PnCoefficient(bool same_orbit, int j, int t, bool first_proton) {
+  const double sigma = first_proton ? 1.0 : -1.0;
+  if (same_orbit) {
+    return (j + t) % 2 == 0 ? 0.0 : (t == 1 ? 1.0 : sigma);
+  }
+  return (t == 1 ? 1.0 : sigma) / std::sqrt(2.0);
+}
+
+// Antisymmetrized 3-body state in the basis of Slater determinants of
+// m-states, keyed by their sorted m-states.
+using Determinants = std::map<std::array<int, 3>, double>;
+
+// Get m-state of file orbit f with doubled projections two_m and two_tz.
+int MState(std::size_t f, int two_m, int two_tz) {
+  return (static_cast<int>(f) * 32 + (two_m + 31) / 2) * 2 + (two_tz + 1) / 2;
+}
+
+// Add coefficient times the antisymmetrized product of m-states.
+void AddProduct(std::array<int, 3> m, double coefficient, Determinants& x) {
+  if (coefficient == 0.0) {
+    return;
+  }
+  for (std::size_t i = 0; i < 3; i += 1) {
+    for (std::size_t k = 0; k + 1 < 3 - i; k += 1) {
+      if (m[k] == m[k + 1]) {
+        return;
+      }
+      if (m[k] > m[k + 1]) {
+        std::swap(m[k], m[k + 1]);
+        coefficient = -coefficient;
+      }
+    }
+  }
+  x[m] += coefficient;
+}
+
+// Get |(ab) J_ab T_ab, c; J T> with M = J and T_z = 1/2, or with fixed
+// isospin projections two_tz (if nonzero) and no isospin coupling.
+Determinants MakeState(
+    const std::vector<nui::FileOrbit>& orbits,
+    std::array<std::size_t, 3> f,
+    int two_jab,
+    int two_j,
+    int two_tab,
+    int two_t,
+    std::array<int, 3> two_tz = {0, 0, 0}) {
+  const int ja = orbits[f[0]].two_j;
+  const int jb = orbits[f[1]].two_j;
+  const int jc = orbits[f[2]].two_j;
+  const bool coupled = two_tz[0] == 0;
+  Determinants x;
+  for (int ma = -ja; ma <= ja; ma += 2) {
+    for (int mb = -jb; mb <= jb; mb += 2) {
+      const int mc = two_j - ma - mb;
+      const double cg_j =
+          nui::ClebschGordan(ja, ma, jb, mb, two_jab, ma + mb) *
+          nui::ClebschGordan(two_jab, ma + mb, jc, mc, two_j, two_j);
+      if (cg_j == 0.0) {
+        continue;
+      }
+      for (const int ta : {-1, 1}) {
+        for (const int tb : {-1, 1}) {
+          for (const int tc : {-1, 1}) {
+            double cg_t = 0.0;
+            if (coupled) {
+              cg_t = nui::ClebschGordan(1, ta, 1, tb, two_tab, ta + tb) *
+                     nui::ClebschGordan(two_tab, ta + tb, 1, tc, two_t, 1);
+            } else if (std::array<int, 3>{ta, tb, tc} == two_tz) {
+              cg_t = 1.0;
+            }
+            AddProduct(
+                {MState(f[0], ma, ta),
+                 MState(f[1], mb, tb),
+                 MState(f[2], mc, tc)},
+                cg_j * cg_t,
+                x);
+          }
+        }
+      }
+    }
+  }
+  return x;
+}
+
+// Get W |y> for the rotation and isospin invariant weight
+//
+//   W = sum_i (1 + 0.3 e_i + 0.05 two_j_i) / 3
+//       + sum_{i<j} (0.1 P_ij + 0.07 Q_ij),
+//
+// where P_ij exchanges the orbits of particles i and j if they have the same
+// j, keeping their projections, and Q_ij moves particles i and j in the same
+// orbit to another orbit with the same j.
+Determinants ApplyWeight(
+    const std::vector<nui::FileOrbit>& orbits,
+    const Determinants& y) {
+  Determinants x;
+  for (const auto& [m, value] : y) {
+    double weight = 0.0;
+    for (const int k : m) {
+      const nui::FileOrbit& o = orbits[static_cast<std::size_t>(k / 64)];
+      weight += (1.0 + 0.3 * o.E() + 0.05 * o.two_j) / 3.0;
+    }
+    x[m] += weight * value;
+    for (std::size_t k = 0; k < 3; k += 1) {
+      for (std::size_t l = k + 1; l < 3; l += 1) {
+        const int f_k = m[k] / 64;
+        const int f_l = m[l] / 64;
+        for (int f = 0; f < static_cast<int>(orbits.size()); f += 1) {
+          if (f == f_k || orbits[static_cast<std::size_t>(f)].two_j !=
+                              orbits[static_cast<std::size_t>(f_k)].two_j) {
+            continue;
+          }
+          std::array<int, 3> moved = m;
+          if (f == f_l) {
+            moved[k] = f_l * 64 + m[k] % 64;
+            moved[l] = f_k * 64 + m[l] % 64;
+            AddProduct(moved, 0.1 * value, x);
+          } else if (f_k == f_l) {
+            moved[k] = f * 64 + m[k] % 64;
+            moved[l] = f * 64 + m[l] % 64;
+            AddProduct(moved, 0.07 * value, x);
+          }
+        }
+      }
+    }
+  }
+  return x;
+}
+
+// Get <x| W |y>.
+double Element(
+    const std::vector<nui::FileOrbit>& orbits,
+    const Determinants& x,
+    const Determinants& y) {
+  double sum = 0.0;
+  for (const auto& [m, value] : ApplyWeight(orbits, y)) {
+    const auto it = x.find(m);
+    if (it != x.end()) {
+      sum += it->second * value;
+    }
+  }
+  return sum;
+}
+
+// Get text of me3j file of W.
+std::string MakeMe3jText(const nui::Me3jLayout& layout) {
+  const auto& orbits = layout.Orbits();
+  std::map<std::tuple<int, int, int, int, int, int, int>, Determinants> cache;
+  const auto state = [&](std::size_t a,
+                         std::size_t b,
+                         std::size_t c,
+                         int j_ab,
+                         int t_ab,
+                         int two_j,
+                         int two_t) -> const Determinants& {
+    const auto key = std::make_tuple(
+        static_cast<int>(a),
+        static_cast<int>(b),
+        static_cast<int>(c),
+        j_ab,
+        t_ab,
+        two_j,
+        two_t);
+    auto it = cache.find(key);
+    if (it == cache.end()) {
+      it = cache
+               .emplace(
+                   key,
+                   MakeState(orbits, {a, b, c}, 2 * j_ab, two_j, 2 * t_ab,
+                             two_t))
+               .first;
+    }
+    return it->second;
+  };
+  std::string text = "header line\n";
+  layout.VisitRecords(
+      0,
+      layout.NumRecords(),
+      [&](std::size_t, const nui::Me3jRecord& r) {
+        for (const auto& [t_ab, t_de, two_t] :
+             std::vector<std::tuple<int, int, int>>{
+                 {0, 0, 1},
+                 {0, 1, 1},
+                 {1, 0, 1},
+                 {1, 1, 1},
+                 {1, 1, 3}}) {
+          const double value = Element(
+              orbits,
+              state(r.a, r.b, r.c, r.j_ab, t_ab, r.two_j, two_t),
+              state(r.d, r.e, r.f, r.j_de, t_de, r.two_j, two_t));
+          text += fmt::format("{:.17g}\n", value);
+        }
+      });
+  return text;
+}
+
+// Check all elements of op against W in the m-scheme.
+void CheckElements(
+    const nui::Me3jLayout& layout,
+    const nui::ThreeBodyOperator& op) {
+  const auto& orbits = layout.Orbits();
+  const auto& ms = op.ModelSpace();
+  const auto& sp = ms.SP();
+  std::size_t nonzero = 0;
+  for (const auto ch : ms.ChannelIndices()) {
+    const auto& channel = ms.Channel(ch);
+    const int two_j = channel.QuantumNumbers().TwoJ();
+    std::vector<Determinants> states;
+    for (const auto& st : channel.States()) {
+      std::array<std::size_t, 3> f;
+      std::array<int, 3> two_tz;
+      const std::array<std::uint16_t, 3> orbitals = {st.a, st.b, st.c};
+      for (std::size_t k = 0; k < 3; k += 1) {
+        const auto o = sp.Orbital(OrbitalIndex(orbitals[k]));
+        f[k] = static_cast<std::size_t>(
+            std::find_if(
+                orbits.begin(),
+                orbits.end(),
+                [&o](const nui::FileOrbit& x) {
+                  return x.n == o.N() && x.l == o.L() && x.two_j == o.TwoJ();
+                }) -
+            orbits.begin());
+        two_tz[k] = o.TwoTz();
+      }
+      states.push_back(MakeState(orbits, f, st.two_jab, two_j, 0, 0, two_tz));
+    }
+    for (const auto i : channel.StateIndices()) {
+      for (const auto j : channel.StateIndices()) {
+        if (j < i) {
+          continue;
+        }
+        const double expected =
+            Element(orbits, states[i.idx()], states[j.idx()]);
+        REQUIRE(
+            op.Get(ch, i, j) == Catch::Approx(expected).margin(1e-12));
+        nonzero += expected != 0.0 ? 1 : 0;
+      }
+    }
+  }
+  REQUIRE(nonzero > 100);
+}
+
+void CheckElements(
+    const nui::Me2jLayout& layout,
+    const nui::TwoBodyOperator& op) {
+  const auto& ms = op.ModelSpace();
+  const auto& sp = ms.SP();
+  const auto& orbits = layout.Orbits();
+  const auto orbital = [&](std::size_t f, int two_tz) {
+    const auto& o = orbits[f];
+    return sp.Index(nui::PackedOrbital(o.n, o.l, o.two_j, two_tz));
+  };
+  std::size_t checked = 0;
+  layout.VisitRecords(
+      0,
+      layout.NumRecords(),
+      [&](std::size_t r, const nui::Me2jRecord& x) {
+        const int parity = (orbits[x.a].l + orbits[x.b].l) % 2;
+        const bool odd_j = x.j % 2 == 1;
+        // T = 1 nn and pp.
+        for (const auto& [two_tz, slot] :
+             std::vector<std::pair<int, std::size_t>>{{1, 1}, {-1, 3}}) {
+          if ((x.a == x.b || x.c == x.d) && odd_j) {
+            continue;
+          }
+          const auto ch = ms.ChannelIndex(
+              nui::PackedChannel(2 * x.j, parity, 2 * two_tz));
+          REQUIRE(
+              op.Get(
+                  ch,
+                  orbital(x.a, two_tz),
+                  orbital(x.b, two_tz),
+                  orbital(x.c, two_tz),
+                  orbital(x.d, two_tz)) ==
+              Catch::Approx(Value(4 * r + slot)).margin(1e-14));
+          checked += 1;
+        }
+        // pn (all combinations of the proton position).
+        const auto ch =
+            ms.ChannelIndex(nui::PackedChannel(2 * x.j, parity, 0));
+        for (const bool pa : {true, false}) {
+          for (const bool pc : {true, false}) {
+            if ((x.a == x.b && !pa) || (x.c == x.d && !pc)) {
+              continue;
+            }
+            double expected = 0.0;
+            for (const auto& [t, slot] :
+                 std::vector<std::pair<int, std::size_t>>{{0, 0}, {1, 2}}) {
+              expected += PnCoefficient(x.a == x.b, x.j, t, pa) *
+                          PnCoefficient(x.c == x.d, x.j, t, pc) *
+                          Value(4 * r + slot);
+            }
+            REQUIRE(
+                op.Get(
+                    ch,
+                    orbital(x.a, pa ? -1 : 1),
+                    orbital(x.b, pa ? 1 : -1),
+                    orbital(x.c, pc ? -1 : 1),
+                    orbital(x.d, pc ? 1 : -1)) ==
+                Catch::Approx(expected).margin(1e-14));
+            checked += 1;
+          }
+        }
+      });
+  REQUIRE(checked > layout.NumRecords());
+}
+
+}  // namespace
+
+TEST_CASE("ReadMe2j, Test isospin to pn conversion.") {
+  const nui::TempDirectory dir("nui_interaction_reader_test");
+  const nui::Me2jLayout layout(2, 4);
+  const std::string path = dir.File("me2j.txt");
+  REQUIRE(WriteText(path, MakeText(layout.NumValues())));
+
+  const auto ms = MakeTwoBodyModelSpace(2, nui::Reference());
+  for (const bool packed : {true, false}) {
+    nui::TwoBodyOperator op(ms, Hermiticity::kHermitian, packed);
+    nui::TextStreamStats stats;
+    REQUIRE(nui::ReadMe2j(path, layout, HeaderOptions(1 << 20), op, &stats));
+    REQUIRE(stats.values == layout.NumValues());
+    CheckElements(layout, op);
+  }
+}
+
+TEST_CASE("ReadMe2j, Test chunking, gzip, and truncation.") {
+  const nui::TempDirectory dir("nui_interaction_reader_test");
+  const nui::Me2jLayout layout(2, 4);
+  const std::string text = MakeText(layout.NumValues());
+  const std::string path = dir.File("me2j_chunks.txt");
+  const std::string gz_path = dir.File("me2j_chunks.gz");
+  REQUIRE(WriteText(path, text));
+  REQUIRE(nui::WriteGzipFile(gz_path, text, 1));
+
+  const auto ms = MakeTwoBodyModelSpace(2, nui::Reference());
+  nui::TwoBodyOperator ref(ms, Hermiticity::kHermitian);
+  REQUIRE(nui::ReadMe2j(path, layout, HeaderOptions(1 << 20), ref));
+  for (const auto& p : {path, gz_path}) {
+    // Tiny chunks split records between batches.
+    nui::TwoBodyOperator op(ms, Hermiticity::kHermitian);
+    REQUIRE(nui::ReadMe2j(p, layout, HeaderOptions(64), op));
+    for (const auto ch : op.ModelSpace().ChannelIndices()) {
+      for (std::size_t i = 0; i < op.ChannelSize(ch); i += 1) {
+        REQUIRE(op.Block(ch)[i] == ref.Block(ch)[i]);
+      }
+    }
+  }
+
+  // Smaller model space than the file.
+  nui::TwoBodyOperator small(
+      MakeTwoBodyModelSpace(1, nui::Reference()),
+      Hermiticity::kHermitian);
+  REQUIRE(nui::ReadMe2j(path, layout, HeaderOptions(1 << 20), small));
+
+  // Missing values.
+  REQUIRE(WriteText(path, MakeText(layout.NumValues() - 1)));
+  nui::TwoBodyOperator op(ms, Hermiticity::kHermitian);
+  REQUIRE_FALSE(nui::ReadMe2j(path, layout, HeaderOptions(1 << 20), op));
+  nui::TwoBodyOperator anti(ms, Hermiticity::kAntihermitian);
+  REQUIRE_FALSE(nui::ReadMe2j(gz_path, layout, HeaderOptions(1 << 20), anti));
+}
+
+TEST_CASE("ReadMe3j, Test recoupling against m-scheme.") {
+  const nui::TempDirectory dir("nui_interaction_reader_test");
+  const nui::Me3jLayout layout(1, 2, 3);
+  const std::string path = dir.File("me3j.gz");
+  REQUIRE(nui::WriteGzipFile(path, MakeMe3jText(layout), 6));
+  const auto ms = MakeThreeBodyModelSpace(1, 3, nui::Reference());
+
+  for (const bool packed : {true, false}) {
+    nui::ThreeBodyStorageOptions options;
+    options.packed = packed;
+    nui::ThreeBodyOperator op(ms, Hermiticity::kHermitian, options);
+    nui::TextStreamStats stats;
+    REQUIRE(nui::ReadMe3j(path, layout, HeaderOptions(4096), op, &stats));
+    REQUIRE(stats.values == layout.NumValues());
+    CheckElements(layout, op);
+  }
+
+  nui::ThreeBodyOperator anti(ms, Hermiticity::kAntihermitian);
+  REQUIRE_FALSE(nui::ReadMe3j(path, layout, HeaderOptions(4096), anti));
+  REQUIRE(WriteText(path, MakeText(layout.NumValues() - 1)));
+  nui::ThreeBodyOperator missing(ms, Hermiticity::kHermitian);
+  REQUIRE_FALSE(nui::ReadMe3j(path, layout, HeaderOptions(4096), missing));
+}
@@ -0,0 +1,384 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/io/native_format.h"
+
+#include <cstring>
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/io/io.h"
+#include "nui/core/memory/memory.h"
+#include "nui/info/runtime/runtime.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+#include "nui/physics/operators/storage/3b/op_3b.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+
+namespace nui {
+
+namespace {
+
+constexpr char kMagic[8] = "NUIOPN1";
+constexpr std::uint32_t kFormatVersion = 1;
+
+enum class NativeKind : std::uint32_t {
+  kTwoBody = 2,
+  kThreeBody = 3,
+};
+
+// Fixed-size file header, followed by the block table.
+struct NativeHeader {
+  char magic[8];
+  std::uint32_t format_version;
+  std::uint32_t kind;
+  std::uint8_t hermiticity;
+  std::uint8_t layout;
+  std::uint8_t padding[6];
+  std::uint64_t num_blocks;
+  // Checksum64 of all block sizes expected by the operator.
+  std::uint64_t layout_hash;
+  std::uint64_t data_offset;
+  std::uint64_t data_size;
+  std::uint64_t table_checksum;
+};
+
+static_assert(sizeof(NativeHeader) == 64);
+
+// Entry of the block table (size 0 for blocks not stored).
+struct NativeBlockEntry {
+  std::uint64_t size;
+  std::uint64_t checksum;
+};
+
+// Blocks to be written, with metadata.
+struct NativeContents {
+  NativeKind kind = NativeKind::kTwoBody;
+  Hermiticity hermiticity = Hermiticity::kNone;
+  BlockLayout layout = BlockLayout::kFull;
+  // Sizes of all blocks expected by the operator.
+  std::vector<std::size_t> full_sizes;
+  // Sizes of stored blocks (0 or full size).
+  std::vector<std::size_t> sizes;
+  std::vector<const double*> blocks;
+};
+
+// Mapped native file with validated header and block table.
+struct NativeFile {
+  MappedFile file;
+  NativeHeader header;
+  std::vector<NativeBlockEntry> table;
+  std::vector<std::size_t> sizes;
+  std::vector<std::size_t> offsets;
+
+  const double* Block(std::size_t b) const {
+    return reinterpret_cast<const double*>(
+        file.Data() + header.data_offset + offsets[b]);
+  }
+};
+
+std::uint64_t LayoutHash(const std::vector<std::size_t>& sizes) {
+  const std::vector<std::uint64_t> words(sizes.begin(), sizes.end());
+  return Checksum64(words.data(), words.size() * sizeof(std::uint64_t));
+}
+
+bool WriteNativeFile(const std::string& path, const NativeContents& contents) {
+  const std::size_t num_blocks = contents.sizes.size();
+  const auto offsets = CowBlocks<double>::SlabOffsets(contents.sizes);
+
+  std::vector<NativeBlockEntry> table(num_blocks);
+#pragma omp parallel for schedule(dynamic) num_threads(NumParallelThreads())
+  for (std::size_t b = 0; b < num_blocks; b += 1) {
+    const std::size_t bytes = contents.sizes[b] * sizeof(double);
+    table[b].size = contents.sizes[b];
+    table[b].checksum = Checksum64(contents.blocks[b], bytes);
+  }
+
+  NativeHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.format_version = kFormatVersion;
+  header.kind = static_cast<std::uint32_t>(contents.kind);
+  header.hermiticity = static_cast<std::uint8_t>(contents.hermiticity);
+  header.layout = static_cast<std::uint8_t>(contents.layout);
+  header.num_blocks = num_blocks;
+  header.layout_hash = LayoutHash(contents.full_sizes);
+  header.data_offset = AlignUp(
+      sizeof(header) + num_blocks * sizeof(NativeBlockEntry),
+      kNativeDataAlignment);
+  header.data_size = offsets.back();
+  header.table_checksum =
+      Checksum64(table.data(), table.size() * sizeof(NativeBlockEntry));
+
+  std::vector<char> head(header.data_offset, 0);
+  std::memcpy(head.data(), &header, sizeof(header));
+  std::memcpy(
+      head.data() + sizeof(header),
+      table.data(),
+      table.size() * sizeof(NativeBlockEntry));
+
+  static const char kZeros[kDefaultAlignment] = {};
+  std::vector<ByteChunk> chunks = {{head.data(), head.size()}};
+  for (std::size_t b = 0; b < num_blocks; b += 1) {
+    const std::size_t bytes = contents.sizes[b] * sizeof(double);
+    if (bytes > 0) {
+      chunks.push_back({contents.blocks[b], bytes});
+    }
+    const std::size_t padding = offsets[b + 1] - offsets[b] - bytes;
+    if (padding > 0) {
+      chunks.push_back({kZeros, padding});
+    }
+  }
+  return WriteFileAtomically(path, chunks);
+}
+
+// Map file and validate header and block table.
+bool OpenNativeFile(
+    const std::string& path,
+    NativeKind kind,
+    NativeFile& out) {
+  out.file = MappedFile(path);
+  if (!out.file.IsValid() || out.file.Size() < sizeof(NativeHeader)) {
+    return false;
+  }
+  NativeHeader& header = out.header;
+  std::memcpy(&header, out.file.Data(), sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.format_version != kFormatVersion ||
+      header.kind != static_cast<std::uint32_t>(kind) ||
+      header.num_blocks >
+          (out.file.Size() - sizeof(header)) / sizeof(NativeBlockEntry) ||
+      header.data_offset % kNativeDataAlignment != 0 ||
+      header.data_offset > out.file.Size() ||
+      header.data_size != out.file.Size() - header.data_offset) {
+    return false;
+  }
+  out.table.resize(header.num_blocks);
+  std::memcpy(
+      out.table.data(),
+      out.file.Data() + sizeof(header),
+      out.table.size() * sizeof(NativeBlockEntry));
+  if (header.table_checksum !=
+      Checksum64(
+          out.table.data(),
+          out.table.size() * sizeof(NativeBlockEntry))) {
+    return false;
+  }
+  out.sizes.resize(out.table.size());
+  for (std::size_t b = 0; b < out.table.size(); b += 1) {
+    out.sizes[b] = out.table[b].size;
+  }
+  out.offsets = CowBlocks<double>::SlabOffsets(out.sizes);
+  return out.offsets.back() == header.data_size;
+}
+
+// Check that stored blocks match the expected sizes (or are missing if
+// allowed).
+bool MatchesLayout(
+    const NativeFile& file,
+    Hermiticity hermiticity,
+    BlockLayout layout,
+    const std::vector<std::size_t>& full_sizes,
+    bool allow_missing) {
+  if (file.header.hermiticity != static_cast<std::uint8_t>(hermiticity) ||
+      file.header.layout != static_cast<std::uint8_t>(layout) ||
+      file.header.layout_hash != LayoutHash(full_sizes) ||
+      file.sizes.size() != full_sizes.size()) {
+    return false;
+  }
+  for (std::size_t b = 0; b < full_sizes.size(); b += 1) {
+    if (file.sizes[b] != full_sizes[b] &&
+        !(allow_missing && file.sizes[b] == 0)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool VerifyBlocks(const NativeFile& file) {
+  bool valid = true;
+  const std::size_t num_blocks = file.sizes.size();
+#pragma omp parallel for schedule(dynamic) reduction(&& : valid) \
+    num_threads(NumParallelThreads())
+  for (std::size_t b = 0; b < num_blocks; b += 1) {
+    const std::size_t bytes = file.sizes[b] * sizeof(double);
+    valid = valid &&
+            Checksum64(file.Block(b), bytes) == file.table[b].checksum;
+  }
+  return valid;
+}
+
+template <typename Op>
+std::vector<std::size_t> ChannelSizes(const Op& op) {
+  std::vector<std::size_t> sizes;
+  sizes.reserve(op.NumChannels());
+  for (const auto ch : op.ModelSpace().ChannelIndices()) {
+    sizes.push_back(op.ChannelSize(ch));
+  }
+  return sizes;
+}
+
+}  // namespace
+
+bool WriteNativeOperator(const std::string& path, const TwoBodyOperator& op) {
+  NativeContents contents;
+  contents.kind = NativeKind::kTwoBody;
+  contents.hermiticity = op.Symmetry();
+  contents.layout = op.Layout();
+  contents.full_sizes = ChannelSizes(op);
+  contents.sizes = contents.full_sizes;
+  for (const auto ch : op.ModelSpace().ChannelIndices()) {
+    contents.blocks.push_back(op.Block(ch));
+  }
+  return WriteNativeFile(path, contents);
+}
+
+bool ReadNativeOperator(
+    const std::string& path,
+    TwoBodyOperator& op,
+    bool verify) {
+  auto file = std::make_shared<NativeFile>();
+  if (!OpenNativeFile(path, NativeKind::kTwoBody, *file) ||
+      !MatchesLayout(
+          *file,
+          op.Symmetry(),
+          op.Layout(),
+          ChannelSizes(op),
+          false) ||
+      (verify && !VerifyBlocks(*file))) {
+    return false;
+  }
+  const double* data = reinterpret_cast<const double*>(
+      file->file.Data() + file->header.data_offset);
+  const std::vector<std::size_t> sizes = file->sizes;
+  return op.ReplaceBlocks(
+      CowBlocks<double>::Adopt(std::move(file), data, sizes));
+}
+
+bool WriteNativeOperator(
+    const std::string& path,
+    const ThreeBodyOperator& op) {
+  NativeContents contents;
+  contents.kind = NativeKind::kThreeBody;
+  contents.hermiticity = op.Symmetry();
+  contents.layout = op.Layout();
+  contents.full_sizes = ChannelSizes(op);
+  contents.sizes.assign(op.NumChannels(), 0UL);
+  contents.blocks.assign(op.NumChannels(), nullptr);
+  std::vector<ThreeBodyChannelView> views;
+  for (const auto ch : op.ModelSpace().ChannelIndices()) {
+    if (op.IsMaterialized(ch)) {
+      views.push_back(op.Read(ch));
+      contents.sizes[ch.idx()] = op.ChannelSize(ch);
+      contents.blocks[ch.idx()] = views.back().Data();
+    }
+  }
+  return WriteNativeFile(path, contents);
+}
+
+bool ReadNativeOperator(
+    const std::string& path,
+    ThreeBodyOperator& op,
+    bool verify) {
+  NativeFile file;
+  if (!OpenNativeFile(path, NativeKind::kThreeBody, file) ||
+      !MatchesLayout(
+          file,
+          op.Symmetry(),
+          op.Layout(),
+          ChannelSizes(op),
+          true) ||
+      (verify && !VerifyBlocks(file))) {
+    return false;
+  }
+  const std::size_t num_channels = op.NumChannels();
+#pragma omp parallel for schedule(dynamic) num_threads(NumParallelThreads())
+  for (std::size_t c = 0; c < num_channels; c += 1) {
+    if (file.sizes[c] == 0) {
+      continue;
+    }
+    const auto ref = op.Write(ThreeBodyChannelIndex(c));
+    std::memcpy(
+        ref.MutableData(),
+        file.Block(c),
+        file.sizes[c] * sizeof(double));
+  }
+  return true;
+}
+
+bool NativeThreeBodyFile::Open(
+    const std::string& path,
+    const ThreeBodyModelSpace& ms) {
+  *this = NativeThreeBodyFile();
+  NativeFile file;
+  if (!OpenNativeFile(path, NativeKind::kThreeBody, file) ||
+      file.header.hermiticity >
+          static_cast<std::uint8_t>(Hermiticity::kAntihermitian) ||
+      file.header.layout >
+          static_cast<std::uint8_t>(BlockLayout::kPackedUpper)) {
+    return false;
+  }
+  const auto hermiticity = static_cast<Hermiticity>(file.header.hermiticity);
+  const auto layout = static_cast<BlockLayout>(file.header.layout);
+  if (layout == BlockLayout::kPackedUpper && !IsSymmetric(hermiticity)) {
+    return false;
+  }
+  std::vector<std::size_t> full_sizes;
+  full_sizes.reserve(ms.NumChannels());
+  for (const auto ch : ms.ChannelIndices()) {
+    full_sizes.push_back(
+        StoredBlockSize(ms.Channel(ch).Dimension(), layout));
+  }
+  if (!MatchesLayout(file, hermiticity, layout, full_sizes, true)) {
+    return false;
+  }
+  hermiticity_ = hermiticity;
+  layout_ = layout;
+  data_offset_ = file.header.data_offset;
+  sizes_ = std::move(file.sizes);
+  offsets_ = std::move(file.offsets);
+  checksums_.reserve(file.table.size());
+  for (const auto& entry : file.table) {
+    checksums_.push_back(entry.checksum);
+  }
+  file_ = std::move(file.file);
+  return true;
+}
+
+const double* NativeThreeBodyFile::Channel(ThreeBodyChannelIndex ch) const {
+  if (sizes_[ch.idx()] == 0) {
+    return nullptr;
+  }
+  return reinterpret_cast<const double*>(
+      file_.Data() + data_offset_ + offsets_[ch.idx()]);
+}
+
+bool NativeThreeBodyFile::VerifyChannel(ThreeBodyChannelIndex ch) const {
+  return Checksum64(Channel(ch), sizes_[ch.idx()] * sizeof(double)) ==
+         checksums_[ch.idx()];
+}
+
+void NativeThreeBodyFile::Release(ThreeBodyChannelIndex ch) const {
+  file_.Release(
+      data_offset_ + offsets_[ch.idx()],
+      sizes_[ch.idx()] * sizeof(double));
+}
+
+}  // namespace nui
@@ -0,0 +1,140 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_OPERATORS_STORAGE_IO_NATIVE_FORMAT_H_
+#define NUI_PHYSICS_OPERATORS_STORAGE_IO_NATIVE_FORMAT_H_
+
+// IWYU pragma: private, include "nui/physics/operators/storage/io/op_io.h"
+// IWYU pragma: friend "nui/physics/operators/storage/io/.*\.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/io/io.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+#include "nui/physics/operators/storage/3b/op_3b.h"
+
+// Native binary format for operator blocks.
+//
+// A file holds a header, a table with size and checksum of every block, and
+// the blocks themselves at a page-aligned data offset, laid out like a
+// CowBlocks slab (each block aligned to kDefaultAlignment). A two-body file
+// can thus be memory mapped and its blocks used in place: they are only
+// copied when written (copy-on-write). Blocks are native-endian doubles.
+//
+// Files are tied to the model space through a hash of all block sizes and
+// are rejected if it does not match the operator they are read into.
+
+namespace nui {
+
+// Alignment of the data section of native files.
+constexpr std::size_t kNativeDataAlignment = 4096;
+
+// Write two-body operator to native file. Returns false on I/O error.
+bool WriteNativeOperator(const std::string& path, const TwoBodyOperator& op);
+
+// Read two-body operator from native file.
+//
+// The file is mapped and its blocks replace those of op without copying.
+// If verify, all block checksums are checked first (in parallel). Returns
+// false (leaving op untouched) if the file cannot be read, is corrupt, or
+// does not match the model space, hermiticity, or layout of op.
+bool ReadNativeOperator(
+    const std::string& path,
+    TwoBodyOperator& op,
+    bool verify = true);
+
+// Write three-body operator to native file.
+//
+// Only materialized channels are stored. They are all pinned while the file
+// is written. Returns false on I/O error.
+bool WriteNativeOperator(const std::string& path, const ThreeBodyOperator& op);
+
+// Read three-body operator from native file into zero operator op.
+//
+// Stored channels are copied into op in parallel. Returns false if the file
+// cannot be read, is corrupt, or does not match op.
+bool ReadNativeOperator(
+    const std::string& path,
+    ThreeBodyOperator& op,
+    bool verify = true);
+
+// Native three-body file read channel by channel in place.
+//
+// The file is mapped and channels are only paged in when they are accessed,
+// so a reader that releases each channel after use streams through files
+// larger than memory with only the channels in use resident. Hermiticity and
+// layout are taken from the file. Channels may be accessed concurrently.
+class NativeThreeBodyFile {
+ public:
+  // Construct closed file.
+  NativeThreeBodyFile() {}
+
+  NativeThreeBodyFile(const NativeThreeBodyFile&) = delete;
+  NativeThreeBodyFile& operator=(const NativeThreeBodyFile&) = delete;
+  NativeThreeBodyFile(NativeThreeBodyFile&&) noexcept = default;
+  NativeThreeBodyFile& operator=(NativeThreeBodyFile&&) noexcept = default;
+
+  // Open file of operator in model space ms.
+  //
+  // Only the header and block table are read. Returns false (leaving the file
+  // closed) if the file cannot be read, is corrupt, or does not match ms.
+  bool Open(const std::string& path, const ThreeBodyModelSpace& ms);
+
+  // Check if file is open.
+  bool IsOpen() const { return file_.IsValid(); }
+
+  // Get symmetry under transposition of stored operator.
+  Hermiticity Symmetry() const { return hermiticity_; }
+
+  // Get layout of stored blocks.
+  BlockLayout Layout() const { return layout_; }
+
+  // Get number of channels.
+  std::size_t NumChannels() const { return sizes_.size(); }
+
+  // Get number of stored elements of channel (0 if not stored).
+  std::size_t ChannelSize(ThreeBodyChannelIndex ch) const {
+    return sizes_[ch.idx()];
+  }
+
+  // Get stored block of channel (nullptr if not stored).
+  const double* Channel(ThreeBodyChannelIndex ch) const;
+
+  // Check checksum of channel (reads it).
+  bool VerifyChannel(ThreeBodyChannelIndex ch) const;
+
+  // Drop channel from memory (it is read again on the next access).
+  void Release(ThreeBodyChannelIndex ch) const;
+
+ private:
+  MappedFile file_;
+  Hermiticity hermiticity_ = Hermiticity::kNone;
+  BlockLayout layout_ = BlockLayout::kFull;
+  std::size_t data_offset_ = 0UL;
+  std::vector<std::size_t> sizes_;
+  std::vector<std::size_t> offsets_;
+  std::vector<std::uint64_t> checksums_;
+};
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_OPERATORS_STORAGE_IO_NATIVE_FORMAT_H_
@@ -0,0 +1,159 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/io/native_format.h"
+
+#include <cstdio>
+
+#include "catch2/catch_test_macros.hpp"
+#include "nui/core/basics/basics.h"
+#include "nui/core/io/io.h"
+#include "nui/core/memory/memory.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+#include "nui/physics/operators/storage/3b/op_3b.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+#include "nui/physics/operators/storage/testing/op_testing.h"
+
+namespace {
+
+using nui::Hermiticity;
+using nui::testing::FillStored;
+using nui::testing::MakeThreeBodyModelSpace;
+using nui::testing::MakeTwoBodyModelSpace;
+
+bool Equal(const nui::TwoBodyOperator& a, const nui::TwoBodyOperator& b) {
+  for (const auto ch : a.ModelSpace().ChannelIndices()) {
+    for (std::size_t i = 0; i < a.ChannelSize(ch); i += 1) {
+      if (a.Block(ch)[i] != b.Block(ch)[i]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void FlipByte(const std::string& path, long offset) {
+  std::FILE* f = std::fopen(path.c_str(), "r+b");
+  REQUIRE(f != nullptr);
+  REQUIRE(std::fseek(f, offset, SEEK_SET) == 0);
+  const int c = std::fgetc(f);
+  REQUIRE(std::fseek(f, offset, SEEK_SET) == 0);
+  std::fputc(c ^ 0x1, f);
+  std::fclose(f);
+}
+
+}  // namespace
+
+TEST_CASE("Native format, Test three-body operator.") {
+  const nui::TempDirectory dir("nui_native_format_test");
+  const auto ms = MakeThreeBodyModelSpace(2, 4);
+  nui::ThreeBodyOperator op(ms, Hermiticity::kHermitian);
+  FillStored(0.5, op, 3);
+  const std::string path = dir.File("op_3b.bin");
+  REQUIRE(nui::WriteNativeOperator(path, op));
+
+  nui::ThreeBodyOperator copy(ms, Hermiticity::kHermitian);
+  REQUIRE(nui::ReadNativeOperator(path, copy));
+  for (const auto ch : ms->ChannelIndices()) {
+    REQUIRE(copy.IsMaterialized(ch) == op.IsMaterialized(ch));
+    if (!op.IsMaterialized(ch)) {
+      continue;
+    }
+    const auto x = op.Read(ch);
+    const auto y = copy.Read(ch);
+    for (std::size_t i = 0; i < op.ChannelSize(ch); i += 1) {
+      REQUIRE(x.Data()[i] == y.Data()[i]);
+    }
+  }
+
+  nui::NativeThreeBodyFile file;
+  REQUIRE(file.Open(path, *ms));
+  REQUIRE(file.Symmetry() == Hermiticity::kHermitian);
+  REQUIRE(file.Layout() == nui::BlockLayout::kPackedUpper);
+  for (const auto ch : ms->ChannelIndices()) {
+    if (!op.IsMaterialized(ch)) {
+      REQUIRE(file.Channel(ch) == nullptr);
+      continue;
+    }
+    REQUIRE(file.ChannelSize(ch) == op.ChannelSize(ch));
+    REQUIRE(file.VerifyChannel(ch));
+    const auto x = op.Read(ch);
+    for (std::size_t i = 0; i < op.ChannelSize(ch); i += 1) {
+      REQUIRE(x.Data()[i] == file.Channel(ch)[i]);
+    }
+    file.Release(ch);
+    REQUIRE(x.Data()[0] == file.Channel(ch)[0]);
+  }
+  REQUIRE_FALSE(file.Open(
+      path,
+      *MakeThreeBodyModelSpace(2, 3)));
+  REQUIRE_FALSE(file.IsOpen());
+
+  nui::ThreeBodyOperator unpacked(ms, Hermiticity::kHermitian, {false});
+  REQUIRE_FALSE(nui::ReadNativeOperator(path, unpacked));
+  nui::TwoBodyOperator two_body(
+      MakeTwoBodyModelSpace(2),
+      Hermiticity::kHermitian);
+  REQUIRE_FALSE(nui::ReadNativeOperator(path, two_body));
+}
+
+TEST_CASE("Native format, Test two-body operator.") {
+  const nui::TempDirectory dir("nui_native_format_test");
+  const auto ms = MakeTwoBodyModelSpace(2);
+  nui::TwoBodyOperator op(ms, Hermiticity::kHermitian);
+  FillStored(1.0, op);
+  const std::string path = dir.File("op_2b.bin");
+  REQUIRE(nui::WriteNativeOperator(path, op));
+
+  nui::TwoBodyOperator copy(ms, Hermiticity::kHermitian);
+  REQUIRE(nui::ReadNativeOperator(path, copy));
+  REQUIRE(Equal(op, copy));
+  // Blocks view the mapped file until written.
+  REQUIRE(copy.Blocks().MemoryLoad() == 0);
+  REQUIRE(copy.Blocks().IsBlockShared(0));
+  copy.MutableBlock(nui::TwoBodyChannelIndex(0))[0] += 1.0;
+  REQUIRE(copy.Blocks().MemoryLoad() > 0);
+  nui::TwoBodyOperator again(ms, Hermiticity::kHermitian);
+  REQUIRE(nui::ReadNativeOperator(path, again));
+  REQUIRE(Equal(op, again));
+
+  // Mismatching operators.
+  nui::TwoBodyOperator unpacked(ms, Hermiticity::kHermitian, false);
+  REQUIRE_FALSE(nui::ReadNativeOperator(path, unpacked));
+  nui::TwoBodyOperator anti(ms, Hermiticity::kAntihermitian);
+  REQUIRE_FALSE(nui::ReadNativeOperator(path, anti));
+  nui::TwoBodyOperator other(
+      MakeTwoBodyModelSpace(1),
+      Hermiticity::kHermitian);
+  REQUIRE_FALSE(nui::ReadNativeOperator(path, other));
+
+  // Corrupt first block.
+  REQUIRE(op.ChannelSize(nui::TwoBodyChannelIndex(0)) > 0);
+  FlipByte(path, static_cast<long>(nui::kNativeDataAlignment));
+  nui::TwoBodyOperator corrupt(ms, Hermiticity::kHermitian);
+  REQUIRE_FALSE(nui::ReadNativeOperator(path, corrupt));
+  REQUIRE(nui::ReadNativeOperator(path, corrupt, false));
+  REQUIRE_FALSE(Equal(op, corrupt));
+}
@@ -0,0 +1,98 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/shared/block_kernels.h"
+
+#include "nui/core/basics/basics.h"
+
+namespace nui {
+
+namespace {
+
+// Elements per tile (16 KiB of y).
+constexpr std::size_t kTileSize = 2048UL;
+
+}  // namespace
+
+void CombineBlocks(
+    std::size_t num_terms,
+    const double* alphas,
+    const double* const* xs,
+    double beta,
+    double* y,
+    std::size_t size) {
+  for (std::size_t start = 0; start < size; start += kTileSize) {
+    const std::size_t stop = std::min(size, start + kTileSize);
+    double* y_tile = y + start;
+    const std::size_t n = stop - start;
+
+    // First pass initializes the tile with up to two terms.
+    const double a0 = num_terms > 0 ? alphas[0] : 0.0;
+    const double a1 = num_terms > 1 ? alphas[1] : 0.0;
+    const double* x0 = num_terms > 0 ? xs[0] + start : nullptr;
+    const double* x1 = num_terms > 1 ? xs[1] + start : nullptr;
+    if (beta == 0.0) {
+      if (num_terms == 0) {
+        std::fill(y_tile, y_tile + n, 0.0);
+      } else if (num_terms == 1) {
+#pragma omp simd
+        for (std::size_t i = 0; i < n; i += 1) {
+          y_tile[i] = a0 * x0[i];
+        }
+      } else {
+#pragma omp simd
+        for (std::size_t i = 0; i < n; i += 1) {
+          y_tile[i] = a0 * x0[i] + a1 * x1[i];
+        }
+      }
+    } else {
+      if (num_terms == 0) {
+#pragma omp simd
+        for (std::size_t i = 0; i < n; i += 1) {
+          y_tile[i] *= beta;
+        }
+      } else if (num_terms == 1) {
+#pragma omp simd
+        for (std::size_t i = 0; i < n; i += 1) {
+          y_tile[i] = beta * y_tile[i] + a0 * x0[i];
+        }
+      } else {
+#pragma omp simd
+        for (std::size_t i = 0; i < n; i += 1) {
+          y_tile[i] = beta * y_tile[i] + a0 * x0[i] + a1 * x1[i];
+        }
+      }
+    }
+
+    // Remaining terms accumulate into the cached tile.
+    for (std::size_t k = 2; k < num_terms; k += 1) {
+      const double a = alphas[k];
+      const double* x = xs[k] + start;
+#pragma omp simd
+      for (std::size_t i = 0; i < n; i += 1) {
+        y_tile[i] += a * x[i];
+      }
+    }
+  }
+}
+
+}  // namespace nui
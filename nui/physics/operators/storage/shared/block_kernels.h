@@ -0,0 +1,49 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_OPERATORS_STORAGE_SHARED_BLOCK_KERNELS_H_
+#define NUI_PHYSICS_OPERATORS_STORAGE_SHARED_BLOCK_KERNELS_H_
+
+// IWYU pragma: private, include "nui/physics/operators/storage/shared/op_common.h"
+// IWYU pragma: friend "nui/physics/operators/storage/shared/.*\.h"
+
+#include "nui/core/basics/basics.h"
+
+namespace nui {
+
+// Set linear combination of blocks,
+// y = beta * y + sum_k alphas[k] * xs[k], with size elements each.
+//
+// Every x block is read once and y is read (unless beta == 0) and written
+// once: y is processed in tiles that stay in L1 cache while the terms are
+// accumulated. With beta == 0, y is not read, so it may hold garbage.
+void CombineBlocks(
+    std::size_t num_terms,
+    const double* alphas,
+    const double* const* xs,
+    double beta,
+    double* y,
+    std::size_t size);
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_OPERATORS_STORAGE_SHARED_BLOCK_KERNELS_H_
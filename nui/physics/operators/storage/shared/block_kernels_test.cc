@@ -0,0 +1,82 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/shared/block_kernels.h"
+
+#include <cmath>
+#include <limits>
+
+#include "catch2/catch_approx.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "nui/core/basics/basics.h"
+
+TEST_CASE("CombineBlocks, Test against term-by-term sum.") {
+  // Sizes cover partial tiles and more than one tile.
+  for (const std::size_t size : {0UL, 5UL, 2048UL, 5000UL}) {
+    for (std::size_t num_terms = 0; num_terms < 6; num_terms += 1) {
+      for (const double beta : {0.0, -0.5}) {
+        std::vector<std::vector<double>> xs(num_terms);
+        std::vector<const double*> ptrs;
+        std::vector<double> alphas;
+        for (std::size_t k = 0; k < num_terms; k += 1) {
+          xs[k].resize(size);
+          for (std::size_t i = 0; i < size; i += 1) {
+            xs[k][i] = std::sin(1.0 + k + 0.01 * i);
+          }
+          ptrs.push_back(xs[k].data());
+          alphas.push_back(0.5 + k);
+        }
+        std::vector<double> y(size);
+        for (std::size_t i = 0; i < size; i += 1) {
+          y[i] = std::cos(0.02 * i);
+        }
+        const std::vector<double> y_ref = y;
+
+        nui::CombineBlocks(
+            num_terms,
+            alphas.data(),
+            ptrs.data(),
+            beta,
+            y.data(),
+            size);
+        for (std::size_t i = 0; i < size; i += 1) {
+          double expected = beta * y_ref[i];
+          for (std::size_t k = 0; k < num_terms; k += 1) {
+            expected += alphas[k] * xs[k][i];
+          }
+          REQUIRE(y[i] == Catch::Approx(expected).margin(1e-14));
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("CombineBlocks, Test y is not read for beta = 0.") {
+  std::vector<double> y(10, std::numeric_limits<double>::quiet_NaN());
+  const std::vector<double> x(10, 2.0);
+  const double* xs[] = {x.data()};
+  const double alphas[] = {1.5};
+  nui::CombineBlocks(1, alphas, xs, 0.0, y.data(), y.size());
+  for (const double v : y) {
+    REQUIRE(v == 3.0);
+  }
+}
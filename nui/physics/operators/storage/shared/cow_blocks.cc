@@ -0,0 +1,66 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/shared/cow_blocks.h"
+
+#include <atomic>
+
+#include "nui/core/basics/basics.h"
+
+namespace nui {
+
+namespace {
+
+std::atomic<std::size_t> num_faults{0};
+std::atomic<std::size_t> num_bytes_copied{0};
+std::atomic<std::size_t> num_table_copies{0};
+
+}  // namespace
+
+CowStatistics GetCowStatistics() {
+  CowStatistics stats;
+  stats.faults = num_faults.load(std::memory_order_relaxed);
+  stats.bytes_copied = num_bytes_copied.load(std::memory_order_relaxed);
+  stats.table_copies = num_table_copies.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void ResetCowStatistics() {
+  num_faults.store(0, std::memory_order_relaxed);
+  num_bytes_copied.store(0, std::memory_order_relaxed);
+  num_table_copies.store(0, std::memory_order_relaxed);
+}
+
+namespace cow_impl {
+
+void RecordFault(std::size_t bytes) noexcept {
+  num_faults.fetch_add(1, std::memory_order_relaxed);
+  num_bytes_copied.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void RecordTableCopy() noexcept {
+  num_table_copies.fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace cow_impl
+
+}  // namespace nui
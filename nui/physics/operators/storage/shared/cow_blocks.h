@@ -0,0 +1,408 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_OPERATORS_STORAGE_SHARED_COW_BLOCKS_H_
+#define NUI_PHYSICS_OPERATORS_STORAGE_SHARED_COW_BLOCKS_H_
+
+// IWYU pragma: private, include "nui/physics/operators/storage/shared/op_common.h"
+// IWYU pragma: friend "nui/physics/operators/storage/shared/.*\.h"
+
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/memory/memory.h"
+#include "nui/info/runtime/runtime.h"
+
+namespace nui {
+
+// Counters of copy-on-write activity (summed over all CowBlocks).
+struct CowStatistics {
+  // Number of blocks duplicated because a shared block was written.
+  std::size_t faults = 0UL;
+  // Number of bytes duplicated by faults.
+  std::size_t bytes_copied = 0UL;
+  // Number of block tables duplicated because a shared handle was written.
+  std::size_t table_copies = 0UL;
+};
+
+// Get copy-on-write counters.
+CowStatistics GetCowStatistics();
+
+// Reset copy-on-write counters.
+void ResetCowStatistics();
+
+namespace cow_impl {
+
+void RecordFault(std::size_t bytes) noexcept;
+void RecordTableCopy() noexcept;
+
+}  // namespace cow_impl
+
+// Reference-counted, copy-on-write storage of a list of dense blocks.
+//
+// Copying a CowBlocks is O(1): both copies share a reference-counted block
+// table. The first write through a shared handle duplicates the table (one
+// pointer per block), and writing a block that is still referenced by
+// another handle duplicates only that block (a "COW fault"). Operators that
+// start as copies of H or Omega and are only partially modified thus only
+// pay for the blocks they touch.
+//
+// All blocks of a fresh storage live in one contiguous, zero-initialized
+// slab, each block aligned to kDefaultAlignment. Blocks duplicated by faults
+// are allocated individually. Storage may also view external memory with the
+// same layout (e.g., a mapped file), which is never written: every block
+// counts as shared and is duplicated on its first write.
+//
+// Reference counts are atomic. Handles may be copied and read concurrently
+// from any number of threads. Writes through one handle to distinct blocks
+// may run in parallel after PrepareWrites() (as for std::vector elements);
+// writes through a handle must not race with copying that handle.
+template <typename T>
+class CowBlocks {
+  static_assert(std::is_trivially_copyable_v<T>);
+
+ public:
+  // Construct storage without blocks.
+  CowBlocks() {}
+
+  // Construct zero-initialized storage with given block sizes (in elements).
+  explicit CowBlocks(const std::vector<std::size_t>& block_sizes);
+
+  // Construct storage viewing external memory with slab layout (see
+  // SlabOffsets()). owner is kept alive as long as any block is viewed.
+  static CowBlocks Adopt(
+      std::shared_ptr<const void> owner,
+      const T* data,
+      const std::vector<std::size_t>& block_sizes);
+
+  // Get byte offsets of blocks in a slab (and total size as last entry).
+  static std::vector<std::size_t> SlabOffsets(
+      const std::vector<std::size_t>& block_sizes);
+
+  ~CowBlocks() { ReleaseTable(table_); }
+
+  CowBlocks(const CowBlocks& other) noexcept : table_(other.table_) {
+    if (table_ != nullptr) {
+      table_->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  CowBlocks& operator=(const CowBlocks& other) noexcept {
+    CowBlocks tmp(other);
+    swap(tmp);
+    return *this;
+  }
+  CowBlocks(CowBlocks&& other) noexcept { swap(other); }
+  CowBlocks& operator=(CowBlocks&& other) noexcept {
+    CowBlocks tmp(std::move(other));
+    swap(tmp);
+    return *this;
+  }
+
+  // Get number of blocks.
+  std::size_t NumBlocks() const {
+    return table_ == nullptr ? 0UL : table_->slots.size();
+  }
+
+  // Get number of elements in block.
+  std::size_t BlockSize(std::size_t b) const { return table_->slots[b].size; }
+
+  // Get total number of elements in all blocks.
+  std::size_t TotalSize() const;
+
+  // Get read-only pointer to block (never copies).
+  const T* Block(std::size_t b) const { return table_->slots[b].data; }
+
+  // Get writable pointer to block, duplicating it if it is shared.
+  //
+  // Pointers to the block previously obtained from this handle are
+  // invalidated if a fault occurs.
+  T* MutableBlock(std::size_t b);
+
+  // Check if block is shared with another handle (or external).
+  bool IsBlockShared(std::size_t b) const {
+    return table_->refs.load(std::memory_order_acquire) > 1 ||
+           IsSlotShared(table_->slots[b]);
+  }
+
+  // Get number of blocks shared with another handle.
+  std::size_t NumSharedBlocks() const;
+
+  // Make block table unique, so that MutableBlock may be called in parallel
+  // on distinct blocks.
+  void PrepareWrites();
+
+  // Make all blocks unique (deep copy, in parallel).
+  void Detach();
+
+  // Get size of all referenced blocks in dynamic memory
+  // (including blocks shared with other handles, excluding external memory).
+  std::size_t MemoryLoad() const;
+
+  // Get size of blocks referenced only by this handle in dynamic memory.
+  std::size_t UniqueMemoryLoad() const;
+
+  // Swap with other storage.
+  void swap(CowBlocks& other) noexcept {
+    using std::swap;
+    swap(table_, other.table_);
+  }
+
+ private:
+  // Allocation holding one or more blocks.
+  //
+  // block_refs counts the slots (in any table) referencing each block, refs
+  // their sum. The slab is freed when refs drops to zero.
+  struct Slab {
+    std::atomic<std::size_t> refs{0};
+    std::unique_ptr<std::atomic<std::uint32_t>[]> block_refs;
+    T* data = nullptr;
+    std::size_t bytes = 0UL;
+    // Owner of external memory (nullptr if data is owned).
+    std::shared_ptr<const void> owner;
+
+    ~Slab() {
+      if (owner == nullptr) {
+        AlignedFree(data);
+      }
+    }
+  };
+
+  struct Slot {
+    Slab* slab = nullptr;
+    std::uint32_t index = 0;
+    T* data = nullptr;
+    std::size_t size = 0UL;
+  };
+
+  struct Table {
+    std::atomic<std::size_t> refs{1};
+    std::vector<Slot> slots;
+  };
+
+  static bool IsSlotShared(const Slot& slot) noexcept {
+    return slot.slab->owner != nullptr ||
+           slot.slab->block_refs[slot.index].load(std::memory_order_acquire) >
+               1;
+  }
+
+  // Set up table of blocks in slab (which is released to the table).
+  void InstallSlab(
+      std::unique_ptr<Slab> slab,
+      const std::vector<std::size_t>& block_sizes,
+      const std::vector<std::size_t>& offsets);
+
+  static void AcquireSlot(const Slot& slot) noexcept {
+    slot.slab->block_refs[slot.index].fetch_add(1, std::memory_order_relaxed);
+    slot.slab->refs.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  static void ReleaseSlot(const Slot& slot) noexcept {
+    slot.slab->block_refs[slot.index].fetch_sub(1, std::memory_order_acq_rel);
+    if (slot.slab->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete slot.slab;
+    }
+  }
+
+  static void ReleaseTable(Table* table) noexcept {
+    if (table == nullptr ||
+        table->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+      return;
+    }
+    for (const auto& slot : table->slots) {
+      ReleaseSlot(slot);
+    }
+    delete table;
+  }
+
+  Table* table_ = nullptr;
+};
+
+// Swap two storages.
+template <typename T>
+void swap(CowBlocks<T>& a, CowBlocks<T>& b) noexcept {
+  a.swap(b);
+}
+
+template <typename T>
+CowBlocks<T>::CowBlocks(const std::vector<std::size_t>& block_sizes) {
+  auto slab = std::make_unique<Slab>();
+  const std::vector<std::size_t> offsets = SlabOffsets(block_sizes);
+  slab->bytes = offsets.back();
+  slab->data = static_cast<T*>(AlignedAllocate(slab->bytes));
+  if (slab->bytes > 0) {
+    std::memset(static_cast<void*>(slab->data), 0, slab->bytes);
+  }
+  InstallSlab(std::move(slab), block_sizes, offsets);
+}
+
+template <typename T>
+CowBlocks<T> CowBlocks<T>::Adopt(
+    std::shared_ptr<const void> owner,
+    const T* data,
+    const std::vector<std::size_t>& block_sizes) {
+  auto slab = std::make_unique<Slab>();
+  const std::vector<std::size_t> offsets = SlabOffsets(block_sizes);
+  slab->bytes = offsets.back();
+  slab->data = const_cast<T*>(data);
+  slab->owner = std::move(owner);
+  CowBlocks blocks;
+  blocks.InstallSlab(std::move(slab), block_sizes, offsets);
+  return blocks;
+}
+
+template <typename T>
+std::vector<std::size_t> CowBlocks<T>::SlabOffsets(
+    const std::vector<std::size_t>& block_sizes) {
+  std::vector<std::size_t> offsets(block_sizes.size() + 1, 0UL);
+  for (std::size_t b = 0; b < block_sizes.size(); b += 1) {
+    offsets[b + 1] = offsets[b] + AlignUp(block_sizes[b] * sizeof(T));
+  }
+  return offsets;
+}
+
+template <typename T>
+void CowBlocks<T>::InstallSlab(
+    std::unique_ptr<Slab> slab,
+    const std::vector<std::size_t>& block_sizes,
+    const std::vector<std::size_t>& offsets) {
+  slab->block_refs =
+      std::make_unique<std::atomic<std::uint32_t>[]>(block_sizes.size());
+  for (std::size_t b = 0; b < block_sizes.size(); b += 1) {
+    slab->block_refs[b].store(1, std::memory_order_relaxed);
+  }
+  slab->refs.store(block_sizes.size(), std::memory_order_relaxed);
+
+  table_ = new Table;
+  table_->slots.resize(block_sizes.size());
+  char* bytes = reinterpret_cast<char*>(slab->data);
+  for (std::size_t b = 0; b < block_sizes.size(); b += 1) {
+    table_->slots[b] = {
+        slab.get(),
+        static_cast<std::uint32_t>(b),
+        reinterpret_cast<T*>(bytes + offsets[b]),
+        block_sizes[b]};
+  }
+  if (block_sizes.empty()) {
+    // Nothing references the slab.
+    return;
+  }
+  slab.release();
+}
+
+template <typename T>
+std::size_t CowBlocks<T>::TotalSize() const {
+  std::size_t size = 0UL;
+  for (std::size_t b = 0; b < NumBlocks(); b += 1) {
+    size += table_->slots[b].size;
+  }
+  return size;
+}
+
+template <typename T>
+T* CowBlocks<T>::MutableBlock(std::size_t b) {
+  PrepareWrites();
+  Slot& slot = table_->slots[b];
+  if (slot.size == 0 || !IsSlotShared(slot)) {
+    return slot.data;
+  }
+
+  const std::size_t bytes = slot.size * sizeof(T);
+  auto slab = std::make_unique<Slab>();
+  slab->bytes = AlignUp(bytes);
+  slab->data = static_cast<T*>(AlignedAllocate(slab->bytes));
+  std::memcpy(
+      static_cast<void*>(slab->data),
+      static_cast<const void*>(slot.data),
+      bytes);
+  slab->block_refs = std::make_unique<std::atomic<std::uint32_t>[]>(1);
+  slab->block_refs[0].store(1, std::memory_order_relaxed);
+  slab->refs.store(1, std::memory_order_relaxed);
+
+  ReleaseSlot(slot);
+  slot = {slab.get(), 0, slab->data, slot.size};
+  slab.release();
+  cow_impl::RecordFault(bytes);
+  return slot.data;
+}
+
+template <typename T>
+std::size_t CowBlocks<T>::NumSharedBlocks() const {
+  std::size_t num = 0UL;
+  for (std::size_t b = 0; b < NumBlocks(); b += 1) {
+    num += IsBlockShared(b);
+  }
+  return num;
+}
+
+template <typename T>
+void CowBlocks<T>::PrepareWrites() {
+  if (table_ == nullptr ||
+      table_->refs.load(std::memory_order_acquire) == 1) {
+    return;
+  }
+  Table* table = new Table;
+  table->slots = table_->slots;
+  for (const auto& slot : table->slots) {
+    AcquireSlot(slot);
+  }
+  ReleaseTable(table_);
+  table_ = table;
+  cow_impl::RecordTableCopy();
+}
+
+template <typename T>
+void CowBlocks<T>::Detach() {
+  PrepareWrites();
+  const std::ptrdiff_t num_blocks = static_cast<std::ptrdiff_t>(NumBlocks());
+#pragma omp parallel for schedule(dynamic) num_threads(NumParallelThreads())
+  for (std::ptrdiff_t b = 0; b < num_blocks; b += 1) {
+    MutableBlock(static_cast<std::size_t>(b));
+  }
+}
+
+template <typename T>
+std::size_t CowBlocks<T>::MemoryLoad() const {
+  std::size_t load = 0UL;
+  for (std::size_t b = 0; b < NumBlocks(); b += 1) {
+    if (table_->slots[b].slab->owner == nullptr) {
+      load += table_->slots[b].size * sizeof(T);
+    }
+  }
+  return load;
+}
+
+template <typename T>
+std::size_t CowBlocks<T>::UniqueMemoryLoad() const {
+  std::size_t load = 0UL;
+  for (std::size_t b = 0; b < NumBlocks(); b += 1) {
+    if (!IsBlockShared(b)) {
+      load += table_->slots[b].size * sizeof(T);
+    }
+  }
+  return load;
+}
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_OPERATORS_STORAGE_SHARED_COW_BLOCKS_H_
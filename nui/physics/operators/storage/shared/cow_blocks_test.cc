@@ -0,0 +1,200 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/shared/cow_blocks.h"
+
+#include <thread>
+
+#include "catch2/catch_test_macros.hpp"
+#include "nui/core/basics/basics.h"
+#include "nui/core/memory/memory.h"
+
+namespace {
+
+using Blocks = nui::CowBlocks<double>;
+
+Blocks MakeFilled(const std::vector<std::size_t>& sizes) {
+  Blocks blocks(sizes);
+  for (std::size_t b = 0; b < sizes.size(); b += 1) {
+    double* data = blocks.MutableBlock(b);
+    for (std::size_t i = 0; i < sizes[b]; i += 1) {
+      data[i] = 100.0 * b + i;
+    }
+  }
+  return blocks;
+}
+
+}  // namespace
+
+TEST_CASE("CowBlocks, Test construction.") {
+  const Blocks blocks({3, 0, 17});
+  REQUIRE(blocks.NumBlocks() == 3);
+  REQUIRE(blocks.BlockSize(0) == 3);
+  REQUIRE(blocks.BlockSize(1) == 0);
+  REQUIRE(blocks.TotalSize() == 20);
+  for (const std::size_t b : {0UL, 2UL}) {
+    REQUIRE(
+        reinterpret_cast<std::uintptr_t>(blocks.Block(b)) %
+            nui::kDefaultAlignment ==
+        0);
+    for (std::size_t i = 0; i < blocks.BlockSize(b); i += 1) {
+      REQUIRE(blocks.Block(b)[i] == 0.0);
+    }
+  }
+  REQUIRE(blocks.NumSharedBlocks() == 0);
+  REQUIRE(Blocks().NumBlocks() == 0);
+}
+
+TEST_CASE("CowBlocks, Test copies share blocks.") {
+  nui::ResetCowStatistics();
+  const Blocks a = MakeFilled({4, 5, 6});
+  const Blocks b = a;
+  REQUIRE(b.Block(1) == a.Block(1));
+  REQUIRE(a.NumSharedBlocks() == 3);
+  REQUIRE(a.UniqueMemoryLoad() == 0);
+  REQUIRE(a.MemoryLoad() == 15 * sizeof(double));
+  REQUIRE(nui::GetCowStatistics().faults == 0);
+}
+
+TEST_CASE("CowBlocks, Test write duplicates only modified block.") {
+  nui::ResetCowStatistics();
+  const Blocks a = MakeFilled({4, 5, 6});
+  Blocks b = a;
+
+  b.MutableBlock(1)[2] = -1.0;
+  REQUIRE(a.Block(1)[2] == 102.0);
+  REQUIRE(b.Block(1)[2] == -1.0);
+  REQUIRE(b.Block(0) == a.Block(0));
+  REQUIRE(b.Block(2) == a.Block(2));
+  REQUIRE(b.Block(1) != a.Block(1));
+  REQUIRE(b.Block(1)[3] == 103.0);
+  REQUIRE(
+      reinterpret_cast<std::uintptr_t>(b.Block(1)) % nui::kDefaultAlignment ==
+      0);
+
+  auto stats = nui::GetCowStatistics();
+  REQUIRE(stats.faults == 1);
+  REQUIRE(stats.bytes_copied == 5 * sizeof(double));
+  REQUIRE(stats.table_copies == 1);
+
+  // Second write to the same block does not fault.
+  b.MutableBlock(1)[0] = -2.0;
+  REQUIRE(nui::GetCowStatistics().faults == 1);
+  REQUIRE(b.NumSharedBlocks() == 2);
+  REQUIRE(a.NumSharedBlocks() == 2);
+  REQUIRE(b.UniqueMemoryLoad() == 5 * sizeof(double));
+}
+
+TEST_CASE("CowBlocks, Test unshared blocks are written in place.") {
+  Blocks a = MakeFilled({4, 5});
+  Blocks b = a;
+  b.MutableBlock(0);
+  b.MutableBlock(1);
+  a = Blocks();
+
+  nui::ResetCowStatistics();
+  const double* before = b.Block(0);
+  b.MutableBlock(0)[0] = 1.0;
+  REQUIRE(b.Block(0) == before);
+  REQUIRE(nui::GetCowStatistics().faults == 0);
+}
+
+TEST_CASE("CowBlocks, Test original outlives copies.") {
+  Blocks a = MakeFilled({8, 8});
+  {
+    Blocks b = a;
+    Blocks c = std::move(b);
+    c.MutableBlock(0)[0] = 5.0;
+  }
+  REQUIRE(a.NumSharedBlocks() == 0);
+  REQUIRE(a.Block(0)[0] == 0.0);
+  a.MutableBlock(1)[1] = 3.0;
+  REQUIRE(a.Block(1)[1] == 3.0);
+}
+
+TEST_CASE("CowBlocks, Test detach.") {
+  const Blocks a = MakeFilled({3, 4, 5});
+  Blocks b = a;
+  b.Detach();
+  REQUIRE(b.NumSharedBlocks() == 0);
+  REQUIRE(a.NumSharedBlocks() == 0);
+  for (std::size_t blk = 0; blk < 3; blk += 1) {
+    REQUIRE(b.Block(blk) != a.Block(blk));
+    for (std::size_t i = 0; i < a.BlockSize(blk); i += 1) {
+      REQUIRE(b.Block(blk)[i] == a.Block(blk)[i]);
+    }
+  }
+}
+
+TEST_CASE("CowBlocks, Test concurrent copies and writes.") {
+  const Blocks a = MakeFilled(std::vector<std::size_t>(16, 32));
+  std::vector<std::thread> threads;
+  std::vector<int> ok(8, 0);
+  for (int t = 0; t < 8; t += 1) {
+    threads.emplace_back([&a, &ok, t]() {
+      bool good = true;
+      for (int iter = 0; iter < 200; iter += 1) {
+        Blocks b = a;
+        const std::size_t blk = static_cast<std::size_t>(t + iter) % 16;
+        b.MutableBlock(blk)[0] = -1.0;
+        good = good && a.Block(blk)[0] == 100.0 * blk;
+      }
+      ok[t] = good;
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (const int x : ok) {
+    REQUIRE(x == 1);
+  }
+  REQUIRE(a.NumSharedBlocks() == 0);
+}
+
+TEST_CASE("CowBlocks, Test adopted external memory.") {
+  const std::vector<std::size_t> sizes = {3, 0, 20};
+  const auto offsets = Blocks::SlabOffsets(sizes);
+  REQUIRE(offsets.size() == sizes.size() + 1);
+  REQUIRE(offsets[1] % nui::kDefaultAlignment == 0);
+  REQUIRE(offsets.back() == offsets[2] + nui::AlignUp(20 * sizeof(double)));
+
+  auto memory = std::make_shared<nui::AlignedVector<double>>(
+      offsets.back() / sizeof(double),
+      7.0);
+  const double* data = memory->data();
+  std::weak_ptr<nui::AlignedVector<double>> watch = memory;
+  {
+    Blocks a = Blocks::Adopt(std::move(memory), data, sizes);
+    REQUIRE(a.Block(2) == data + offsets[2] / sizeof(double));
+    REQUIRE(a.IsBlockShared(0));
+    REQUIRE(a.MemoryLoad() == 0);
+
+    a.MutableBlock(2)[0] = -1.0;
+    REQUIRE(a.Block(2)[0] == -1.0);
+    REQUIRE(a.Block(2)[1] == 7.0);
+    REQUIRE(data[offsets[2] / sizeof(double)] == 7.0);
+    REQUIRE_FALSE(a.IsBlockShared(2));
+    REQUIRE(a.MemoryLoad() == 20 * sizeof(double));
+    REQUIRE_FALSE(watch.expired());
+  }
+  REQUIRE(watch.expired());
+}
@@ -0,0 +1,74 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_OPERATORS_STORAGE_SHARED_HERMITICITY_H_
+#define NUI_PHYSICS_OPERATORS_STORAGE_SHARED_HERMITICITY_H_
+
+// IWYU pragma: private, include "nui/physics/operators/storage/shared/op_common.h"
+// IWYU pragma: friend "nui/physics/operators/storage/shared/.*\.h"
+
+#include "nui/core/basics/basics.h"
+
+namespace nui {
+
+// Symmetry of a real operator under transposition.
+enum class Hermiticity : std::uint8_t {
+  // No symmetry, all matrix elements are stored.
+  kNone = 0,
+  // O^T = O.
+  kHermitian = 1,
+  // O^T = -O.
+  kAntihermitian = 2,
+};
+
+// Get sign s with O^T = s O (0 for Hermiticity::kNone).
+constexpr int HermiticitySign(Hermiticity h) noexcept {
+  return h == Hermiticity::kHermitian       ? 1
+         : h == Hermiticity::kAntihermitian ? -1
+                                            : 0;
+}
+
+// Check if only one triangle of each block is stored.
+constexpr bool IsSymmetric(Hermiticity h) noexcept {
+  return h != Hermiticity::kNone;
+}
+
+// Get hermiticity of commutator [A, B].
+//
+// [A, B]^T = s_A s_B [B, A] = -s_A s_B [A, B].
+constexpr Hermiticity CommutatorHermiticity(
+    Hermiticity a,
+    Hermiticity b) noexcept {
+  if (!IsSymmetric(a) || !IsSymmetric(b)) {
+    return Hermiticity::kNone;
+  }
+  return HermiticitySign(a) * HermiticitySign(b) == 1
+             ? Hermiticity::kAntihermitian
+             : Hermiticity::kHermitian;
+}
+
+// Get string representation of hermiticity.
+std::string_view ToString(Hermiticity h);
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_OPERATORS_STORAGE_SHARED_HERMITICITY_H_
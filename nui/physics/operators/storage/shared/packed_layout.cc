@@ -0,0 +1,64 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/shared/packed_layout.h"
+
+#include <cstring>
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/operators/storage/shared/hermiticity.h"
+
+namespace nui {
+
+void UnpackBlock(
+    const double* packed,
+    std::size_t n,
+    Hermiticity h,
+    double* full) {
+  if (!IsSymmetric(h)) {
+    std::memcpy(full, packed, n * n * sizeof(double));
+    return;
+  }
+  const double sign = HermiticitySign(h);
+  for (std::size_t j = 0; j < n; j += 1) {
+    const double* col = packed + PackedIndex(0, j);
+    for (std::size_t i = 0; i <= j; i += 1) {
+      full[i * n + j] = col[i];
+      full[j * n + i] = sign * col[i];
+    }
+  }
+}
+
+void PackBlock(const double* full, std::size_t n, Hermiticity h, double* out) {
+  if (!IsSymmetric(h)) {
+    std::memcpy(out, full, n * n * sizeof(double));
+    return;
+  }
+  for (std::size_t j = 0; j < n; j += 1) {
+    double* col = out + PackedIndex(0, j);
+    for (std::size_t i = 0; i <= j; i += 1) {
+      col[i] = full[i * n + j];
+    }
+  }
+}
+
+}  // namespace nui
@@ -0,0 +1,111 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_OPERATORS_STORAGE_SHARED_PACKED_LAYOUT_H_
+#define NUI_PHYSICS_OPERATORS_STORAGE_SHARED_PACKED_LAYOUT_H_
+
+// IWYU pragma: private, include "nui/physics/operators/storage/shared/op_common.h"
+// IWYU pragma: friend "nui/physics/operators/storage/shared/.*\.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/operators/storage/shared/hermiticity.h"
+
+// Layouts of dense operator blocks.
+//
+// Full blocks are row-major n x n matrices. Blocks of (anti)hermitian
+// operators store only the upper triangle (including the diagonal) in the
+// BLAS/LAPACK packed format (uplo = 'U', column-major), which is identical
+// to the lower triangle in row-major order:
+//
+//   element (i, j) with i <= j is at i + j (j + 1) / 2.
+//
+// Packed blocks can thus be passed to BLAS routines like dspmv directly.
+
+namespace nui {
+
+// Layout of stored operator blocks.
+enum class BlockLayout : std::uint8_t {
+  // Row-major n x n.
+  kFull = 0,
+  // Packed upper triangle (only valid for (anti)hermitian operators).
+  kPackedUpper = 1,
+};
+
+// Get layout for hermiticity h, using packed blocks if allowed and requested.
+constexpr BlockLayout ChooseLayout(Hermiticity h, bool packed) noexcept {
+  return IsSymmetric(h) && packed ? BlockLayout::kPackedUpper
+                                  : BlockLayout::kFull;
+}
+
+// Get number of stored elements of packed n x n block.
+constexpr std::size_t PackedSize(std::size_t n) noexcept {
+  return n * (n + 1) / 2;
+}
+
+// Get position of (i, j), i <= j, in packed block.
+constexpr std::size_t PackedIndex(std::size_t i, std::size_t j) noexcept {
+  return i + j * (j + 1) / 2;
+}
+
+// Get number of stored elements of n x n block with given hermiticity.
+constexpr std::size_t StoredBlockSize(std::size_t n, Hermiticity h) noexcept {
+  return IsSymmetric(h) ? PackedSize(n) : n * n;
+}
+
+// Get number of stored elements of n x n block with given layout.
+constexpr std::size_t StoredBlockSize(
+    std::size_t n,
+    BlockLayout layout) noexcept {
+  return layout == BlockLayout::kPackedUpper ? PackedSize(n) : n * n;
+}
+
+// Unpack block with hermiticity h into full row-major n x n matrix.
+void UnpackBlock(
+    const double* packed,
+    std::size_t n,
+    Hermiticity h,
+    double* full);
+
+// Pack full row-major n x n matrix into block with hermiticity h.
+//
+// For symmetric h, only the upper triangle of full is read.
+void PackBlock(const double* full, std::size_t n, Hermiticity h, double* out);
+
+// Get element (i, j) of stored n x n block with hermiticity h.
+inline double BlockElement(
+    const double* block,
+    std::size_t n,
+    Hermiticity h,
+    std::size_t i,
+    std::size_t j) {
+  if (!IsSymmetric(h)) {
+    return block[i * n + j];
+  }
+  if (i <= j) {
+    return block[PackedIndex(i, j)];
+  }
+  return HermiticitySign(h) * block[PackedIndex(j, i)];
+}
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_OPERATORS_STORAGE_SHARED_PACKED_LAYOUT_H_
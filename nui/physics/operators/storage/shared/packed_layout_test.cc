@@ -0,0 +1,93 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/shared/packed_layout.h"
+
+#include "catch2/catch_test_macros.hpp"
+#include "nui/core/basics/basics.h"
+#include "nui/physics/operators/storage/shared/hermiticity.h"
+
+TEST_CASE("PackedIndex, Test layout is BLAS upper packed.") {
+  REQUIRE(nui::PackedSize(4) == 10);
+  REQUIRE(nui::PackedIndex(0, 0) == 0);
+  REQUIRE(nui::PackedIndex(0, 1) == 1);
+  REQUIRE(nui::PackedIndex(1, 1) == 2);
+  REQUIRE(nui::PackedIndex(0, 2) == 3);
+  REQUIRE(nui::PackedIndex(3, 3) == 9);
+  REQUIRE(nui::StoredBlockSize(4, nui::Hermiticity::kNone) == 16);
+  REQUIRE(nui::StoredBlockSize(4, nui::Hermiticity::kAntihermitian) == 10);
+}
+
+TEST_CASE("PackBlock, Test round trip.") {
+  const std::size_t n = 5;
+  for (const auto h :
+       {nui::Hermiticity::kNone,
+        nui::Hermiticity::kHermitian,
+        nui::Hermiticity::kAntihermitian}) {
+    const double sign = nui::HermiticitySign(h);
+    std::vector<double> full(n * n);
+    for (std::size_t i = 0; i < n; i += 1) {
+      for (std::size_t j = 0; j < n; j += 1) {
+        const double x = 1.0 + i + 10.0 * j;
+        if (!nui::IsSymmetric(h)) {
+          full[i * n + j] = x;
+        } else if (i < j) {
+          full[i * n + j] = x;
+          full[j * n + i] = sign * x;
+        } else if (i == j) {
+          full[i * n + i] = sign > 0 ? x : 0.0;
+        }
+      }
+    }
+    std::vector<double> packed(nui::StoredBlockSize(n, h));
+    std::vector<double> unpacked(n * n);
+    nui::PackBlock(full.data(), n, h, packed.data());
+    nui::UnpackBlock(packed.data(), n, h, unpacked.data());
+    REQUIRE(unpacked == full);
+    for (std::size_t i = 0; i < n; i += 1) {
+      for (std::size_t j = 0; j < n; j += 1) {
+        REQUIRE(
+            nui::BlockElement(packed.data(), n, h, i, j) == full[i * n + j]);
+      }
+    }
+  }
+}
+
+TEST_CASE("CommutatorHermiticity, Test signs.") {
+  using nui::Hermiticity;
+  REQUIRE(
+      nui::CommutatorHermiticity(
+          Hermiticity::kHermitian,
+          Hermiticity::kHermitian) == Hermiticity::kAntihermitian);
+  REQUIRE(
+      nui::CommutatorHermiticity(
+          Hermiticity::kAntihermitian,
+          Hermiticity::kHermitian) == Hermiticity::kHermitian);
+  REQUIRE(
+      nui::CommutatorHermiticity(
+          Hermiticity::kAntihermitian,
+          Hermiticity::kAntihermitian) == Hermiticity::kAntihermitian);
+  REQUIRE(
+      nui::CommutatorHermiticity(
+          Hermiticity::kNone,
+          Hermiticity::kHermitian) == Hermiticity::kNone);
+}
@@ -0,0 +1,223 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/operators/storage/testing/fixtures.h"
+
+#include <cmath>
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/storage/1b/op_1b.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+#include "nui/physics/operators/storage/3b/op_3b.h"
+#include "nui/physics/operators/storage/full/op_full.h"
+#include "nui/physics/operators/storage/shared/op_common.h"
+
+namespace nui {
+namespace testing {
+
+namespace {
+
+// Check if (i, j) is stored and allowed to be nonzero for hermiticity h.
+bool IsFree(Hermiticity h, std::size_t i, std::size_t j) {
+  return !(IsSymmetric(h) && j < i) &&
+         !(h == Hermiticity::kAntihermitian && i == j);
+}
+
+}  // namespace
+
+std::shared_ptr<const SPModelSpace> MakeSP(
+    int emax,
+    const Reference& reference) {
+  return SPModelSpace::Make(SPTruncation(emax), reference);
+}
+
+std::shared_ptr<const TwoBodyModelSpace> MakeTwoBodyModelSpace(
+    int emax,
+    const Reference& reference) {
+  return TwoBodyModelSpace::Make(MakeSP(emax, reference));
+}
+
+std::shared_ptr<const ThreeBodyModelSpace> MakeThreeBodyModelSpace(
+    int emax,
+    int e3max,
+    const Reference& reference) {
+  return ThreeBodyModelSpace::Make(
+      MakeSP(emax, reference),
+      ThreeBodyTruncation(e3max));
+}
+
+double Element(double seed, std::size_t block, std::size_t i, std::size_t j) {
+  return std::sin(seed + 0.7 * block + 0.37 * i + 0.23 * j);
+}
+
+void Fill(double seed, OneBodyOperator& op) {
+  const SPModelSpace& sp = op.SP();
+  for (const auto a : sp.OrbitalIndices()) {
+    const PartialWaveIndex pw = sp.PartialWaveOf(a);
+    for (const auto b : sp.PartialWaveOrbitals(pw)) {
+      if (IsFree(op.Symmetry(), a.idx(), b.idx())) {
+        op.Set(a, b, Element(seed, pw.idx(), a.idx(), b.idx()));
+      }
+    }
+  }
+}
+
+void Fill(double seed, TwoBodyOperator& op) {
+  const TwoBodyModelSpace& ms = op.ModelSpace();
+  for (const auto ch : ms.ChannelIndices()) {
+    for (const auto i : ms.Channel(ch).StateIndices()) {
+      for (const auto j : ms.Channel(ch).StateIndices()) {
+        if (IsFree(op.Symmetry(), i.idx(), j.idx())) {
+          op.Set(ch, i, j, Element(seed, ch.idx(), i.idx(), j.idx()));
+        }
+      }
+    }
+  }
+}
+
+void Fill(double seed, ThreeBodyOperator& op) {
+  const ThreeBodyModelSpace& ms = op.ModelSpace();
+  op.StreamChannelsMutable([&](ThreeBodyChannelIndex ch, double*) {
+    const auto& channel = ms.Channel(ch);
+    for (const auto i : channel.StateIndices()) {
+      if (channel.State(i).b == channel.State(i).c) {
+        continue;
+      }
+      for (const auto j : channel.StateIndices()) {
+        if (IsFree(op.Symmetry(), i.idx(), j.idx()) &&
+            channel.State(j).b != channel.State(j).c) {
+          op.Set(ch, i, j, Element(seed, ch.idx(), i.idx(), j.idx()));
+        }
+      }
+    }
+  });
+}
+
+void Fill(double seed, Operator& op) {
+  op.SetZeroBody(seed);
+  Fill(seed, op.OneBody());
+  Fill(seed, op.TwoBody());
+  if (op.HasThreeBody()) {
+    Fill(seed, op.ThreeBody());
+  }
+}
+
+OneBodyOperator MakeOneBodyOperator(
+    std::shared_ptr<const SPModelSpace> sp,
+    Hermiticity h,
+    double seed) {
+  OneBodyOperator op(std::move(sp), h);
+  Fill(seed, op);
+  return op;
+}
+
+TwoBodyOperator MakeTwoBodyOperator(
+    std::shared_ptr<const TwoBodyModelSpace> ms,
+    Hermiticity h,
+    double seed,
+    bool packed) {
+  TwoBodyOperator op(std::move(ms), h, packed);
+  Fill(seed, op);
+  return op;
+}
+
+double StoredElement(double seed, std::size_t block, std::size_t k) {
+  return std::sin(seed * (1.0 + block) + 0.01 * k);
+}
+
+void FillStored(double seed, TwoBodyOperator& op) {
+  for (const auto ch : op.ModelSpace().ChannelIndices()) {
+    double* block = op.MutableBlock(ch);
+    for (std::size_t k = 0; k < op.ChannelSize(ch); k += 1) {
+      block[k] = StoredElement(seed, ch.idx(), k);
+    }
+  }
+}
+
+void FillStored(double seed, ThreeBodyOperator& op, std::size_t stride) {
+  for (const auto ch : op.ModelSpace().ChannelIndices()) {
+    if (ch.idx() % stride != 0) {
+      continue;
+    }
+    const auto ref = op.Write(ch);
+    double* block = ref.MutableData();
+    for (std::size_t k = 0; k < op.ChannelSize(ch); k += 1) {
+      block[k] = StoredElement(seed, ch.idx(), k);
+    }
+  }
+}
+
+void FillStored(double seed, Operator& op, std::size_t stride) {
+  op.SetZeroBody(seed);
+  for (const auto pw : op.SP().PartialWaveIndices()) {
+    double* block = op.OneBody().MutableBlock(pw);
+    for (std::size_t k = 0; k < op.OneBody().BlockSize(pw); k += 1) {
+      block[k] = StoredElement(seed, pw.idx(), k);
+    }
+  }
+  FillStored(seed, op.TwoBody());
+  if (op.HasThreeBody()) {
+    FillStored(seed, op.ThreeBody(), stride);
+  }
+}
+
+Operator MakeHamiltonian(
+    std::shared_ptr<const TwoBodyModelSpace> ms,
+    double coupling,
+    double strength) {
+  Operator h(std::move(ms), Hermiticity::kHermitian);
+  const SPModelSpace& sp = h.SP();
+  for (const auto a : sp.OrbitalIndices()) {
+    const PartialWaveIndex pw = sp.PartialWaveOf(a);
+    for (const auto b : sp.PartialWaveOrbitals(pw)) {
+      if (b == a) {
+        h.OneBody().Set(a, a, 10.0 * sp.Orbital(a).E() + 0.1 * a.idx());
+      } else if (b > a) {
+        h.OneBody().Set(
+            a,
+            b,
+            coupling * Element(1.0, pw.idx(), a.idx(), b.idx()));
+      }
+    }
+  }
+  const TwoBodyModelSpace& ms2 = h.TwoBody().ModelSpace();
+  for (const auto ch : ms2.ChannelIndices()) {
+    for (const auto i : ms2.Channel(ch).StateIndices()) {
+      for (const auto j : ms2.Channel(ch).StateIndices()) {
+        if (j >= i) {
+          h.TwoBody().Set(
+              ch,
+              i,
+              j,
+              strength * Element(1.0, ch.idx(), i.idx(), j.idx()));
+        }
+      }
+    }
+  }
+  return h;
+}
+
+}  // namespace testing
+}  // namespace nui
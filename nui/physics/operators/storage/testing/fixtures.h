@@ -0,0 +1,118 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_OPERATORS_STORAGE_TESTING_FIXTURES_H_
+#define NUI_PHYSICS_OPERATORS_STORAGE_TESTING_FIXTURES_H_
+
+// IWYU pragma: private, include "nui/physics/operators/storage/testing/op_testing.h"
+// IWYU pragma: friend "nui/physics/operators/storage/testing/.*\.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/model_space/2b/model_space_2b.h"
+#include "nui/physics/model_space/3b/model_space_3b.h"
+#include "nui/physics/model_space/sp/model_space_sp.h"
+#include "nui/physics/operators/storage/1b/op_1b.h"
+#include "nui/physics/operators/storage/2b/op_2b.h"
+#include "nui/physics/operators/storage/3b/op_3b.h"
+#include "nui/physics/operators/storage/full/op_full.h"
+
+// Fixtures shared by the tests and benchmarks of operators: small model
+// spaces and operators filled with smooth, seed-dependent elements.
+
+namespace nui {
+namespace testing {
+
+// Get single-particle model space with e <= emax.
+std::shared_ptr<const SPModelSpace> MakeSP(
+    int emax,
+    const Reference& reference = Reference::HOEqualFilling(8, 8));
+
+// Get 2-body model space of MakeSP(emax, reference).
+std::shared_ptr<const TwoBodyModelSpace> MakeTwoBodyModelSpace(
+    int emax,
+    const Reference& reference = Reference::HOEqualFilling(8, 8));
+
+// Get 3-body model space of MakeSP(emax, reference) with e_a + e_b + e_c
+// <= e3max.
+std::shared_ptr<const ThreeBodyModelSpace> MakeThreeBodyModelSpace(
+    int emax,
+    int e3max,
+    const Reference& reference = Reference::HOEqualFilling(8, 8));
+
+// Get element (i, j) of block of the operator with seed.
+//
+// Elements are of order 1, and operators with different seeds are linearly
+// independent.
+double Element(double seed, std::size_t block, std::size_t i, std::size_t j);
+
+// Set all elements allowed by the symmetry of op to Element(seed, ...).
+//
+// Only the upper triangle of (anti)hermitian operators is set, and the
+// diagonal of antihermitian operators is left zero. Blocks are partial waves
+// (with orbitals as i and j) or channels (with states as i and j).
+void Fill(double seed, OneBodyOperator& op);
+void Fill(double seed, TwoBodyOperator& op);
+
+// Same for 3-body operators.
+//
+// States |(ab) J_ab, b> are overcomplete, so elements involving them are only
+// consistent for genuinely antisymmetric operators. They are left zero.
+// Channels are streamed, so op may have a memory budget.
+void Fill(double seed, ThreeBodyOperator& op);
+
+// Set 0-body part of op to seed and fill all other parts.
+void Fill(double seed, Operator& op);
+
+// Get operator with hermiticity h filled by Fill(seed, ...).
+OneBodyOperator MakeOneBodyOperator(
+    std::shared_ptr<const SPModelSpace> sp,
+    Hermiticity h,
+    double seed);
+TwoBodyOperator MakeTwoBodyOperator(
+    std::shared_ptr<const TwoBodyModelSpace> ms,
+    Hermiticity h,
+    double seed,
+    bool packed = true);
+
+// Get stored element k of block of the operator with seed.
+double StoredElement(double seed, std::size_t block, std::size_t k);
+
+// Set stored elements of blocks directly to StoredElement(seed, ...).
+//
+// This is cheap for large operators, but does not respect the symmetry of
+// (unpacked) blocks. Only every stride-th 3-body channel is written.
+void FillStored(double seed, TwoBodyOperator& op);
+void FillStored(double seed, ThreeBodyOperator& op, std::size_t stride = 1);
+void FillStored(double seed, Operator& op, std::size_t stride = 1);
+
+// Get hermitian Hamiltonian with shell energies 10 e_a + 0.1 a on the 1-body
+// diagonal, other 1-body elements coupling * Element(...), and 2-body
+// elements strength * Element(...).
+Operator MakeHamiltonian(
+    std::shared_ptr<const TwoBodyModelSpace> ms,
+    double coupling,
+    double strength);
+
+}  // namespace testing
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_OPERATORS_STORAGE_TESTING_FIXTURES_H_
@@ -0,0 +1,304 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_QUANTUM_NUMBERS_BATCH_FILTERS_H_
+#define NUI_PHYSICS_QUANTUM_NUMBERS_BATCH_FILTERS_H_
+
+// IWYU pragma: private, include "nui/physics/quantum_numbers/quantum_numbers.h"
+// IWYU pragma: friend "nui/physics/quantum_numbers/.*\.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/quantum_numbers/packed_channel.h"
+#include "nui/physics/quantum_numbers/packed_state.h"
+
+// Batch predicates over arrays of packed quantum numbers.
+//
+// Each predicate writes 0 or 1 into mask[i] for i in [0, n) and returns the
+// number of entries that passed. The loops are branchless and work directly on
+// the packed words, so they are vectorized by the compiler (guided by
+// `omp simd`). Model space construction filters candidate tuples with these
+// instead of unpacking quantum numbers one state at a time.
+//
+// PackedT may be PackedOrbital or PackedSPState. All predicates only read
+// orbital bits.
+
+namespace nui {
+
+namespace batch_filters_impl {
+
+template <typename PackedT>
+inline std::uint32_t Word(PackedT x) noexcept {
+  return x.Word();
+}
+
+inline std::int32_t L(std::uint32_t w) noexcept {
+  return static_cast<std::int32_t>((w >> qn_packing::kLShift) &
+                                   qn_packing::kLMask);
+}
+
+inline std::int32_t N(std::uint32_t w) noexcept {
+  return static_cast<std::int32_t>((w >> qn_packing::kNShift) &
+                                   qn_packing::kNMask);
+}
+
+inline std::int32_t TwoJ(std::uint32_t w) noexcept {
+  return static_cast<std::int32_t>((w >> qn_packing::kTwoJShift) &
+                                   qn_packing::kTwoJMask);
+}
+
+// Number of tz = +1/2 particles (0 or 1).
+inline std::int32_t TzUp(std::uint32_t w) noexcept {
+  return static_cast<std::int32_t>((w >> qn_packing::kTzShift) &
+                                   qn_packing::kTzMask);
+}
+
+inline std::int32_t E(std::uint32_t w) noexcept { return 2 * N(w) + L(w); }
+
+// |j1 - j2| <= j3 <= j1 + j2 for doubled angular momenta.
+inline std::uint8_t Triangle(
+    std::int32_t j1,
+    std::int32_t j2,
+    std::int32_t j3) noexcept {
+  return static_cast<std::uint8_t>(
+      (j3 <= j1 + j2) & (j1 - j2 <= j3) & (j2 - j1 <= j3));
+}
+
+// Doubled total Tz of n particles with num_up neutrons.
+inline std::int32_t TwoTz(std::int32_t num_up, std::int32_t n) noexcept {
+  return 2 * num_up - n;
+}
+
+}  // namespace batch_filters_impl
+
+// Mask pairs with (l_a + l_b) % 2 == parity.
+template <typename PackedT>
+std::size_t MaskParity(
+    const PackedT* a,
+    const PackedT* b,
+    std::size_t n,
+    int parity,
+    std::uint8_t* mask) {
+  namespace impl = batch_filters_impl;
+  std::size_t count = 0UL;
+#pragma omp simd reduction(+ : count)
+  for (std::size_t i = 0; i < n; i += 1) {
+    const std::uint32_t wa = impl::Word(a[i]);
+    const std::uint32_t wb = impl::Word(b[i]);
+    const std::uint8_t pass = static_cast<std::uint8_t>(
+        ((impl::L(wa) + impl::L(wb)) & 0x1) == parity);
+    mask[i] = pass;
+    count += pass;
+  }
+  return count;
+}
+
+// Mask pairs with 2 * (tz_a + tz_b) == two_tz.
+template <typename PackedT>
+std::size_t MaskTwoTz(
+    const PackedT* a,
+    const PackedT* b,
+    std::size_t n,
+    int two_tz,
+    std::uint8_t* mask) {
+  namespace impl = batch_filters_impl;
+  std::size_t count = 0UL;
+#pragma omp simd reduction(+ : count)
+  for (std::size_t i = 0; i < n; i += 1) {
+    const std::int32_t up =
+        impl::TzUp(impl::Word(a[i])) + impl::TzUp(impl::Word(b[i]));
+    const std::uint8_t pass =
+        static_cast<std::uint8_t>(impl::TwoTz(up, 2) == two_tz);
+    mask[i] = pass;
+    count += pass;
+  }
+  return count;
+}
+
+// Mask pairs with |j_a - j_b| <= J <= j_a + j_b.
+template <typename PackedT>
+std::size_t MaskTriangle(
+    const PackedT* a,
+    const PackedT* b,
+    std::size_t n,
+    int two_j,
+    std::uint8_t* mask) {
+  namespace impl = batch_filters_impl;
+  std::size_t count = 0UL;
+#pragma omp simd reduction(+ : count)
+  for (std::size_t i = 0; i < n; i += 1) {
+    const std::uint8_t pass = impl::Triangle(
+        impl::TwoJ(impl::Word(a[i])),
+        impl::TwoJ(impl::Word(b[i])),
+        two_j);
+    mask[i] = pass;
+    count += pass;
+  }
+  return count;
+}
+
+// Mask pairs with e_a + e_b <= e2max.
+template <typename PackedT>
+std::size_t MaskEnergySum(
+    const PackedT* a,
+    const PackedT* b,
+    std::size_t n,
+    int e2max,
+    std::uint8_t* mask) {
+  namespace impl = batch_filters_impl;
+  std::size_t count = 0UL;
+#pragma omp simd reduction(+ : count)
+  for (std::size_t i = 0; i < n; i += 1) {
+    const std::uint8_t pass = static_cast<std::uint8_t>(
+        impl::E(impl::Word(a[i])) + impl::E(impl::Word(b[i])) <= e2max);
+    mask[i] = pass;
+    count += pass;
+  }
+  return count;
+}
+
+// Mask triples with e_a + e_b + e_c <= e3max.
+template <typename PackedT>
+std::size_t MaskEnergySum(
+    const PackedT* a,
+    const PackedT* b,
+    const PackedT* c,
+    std::size_t n,
+    int e3max,
+    std::uint8_t* mask) {
+  namespace impl = batch_filters_impl;
+  std::size_t count = 0UL;
+#pragma omp simd reduction(+ : count)
+  for (std::size_t i = 0; i < n; i += 1) {
+    const std::uint8_t pass = static_cast<std::uint8_t>(
+        impl::E(impl::Word(a[i])) + impl::E(impl::Word(b[i])) +
+            impl::E(impl::Word(c[i])) <=
+        e3max);
+    mask[i] = pass;
+    count += pass;
+  }
+  return count;
+}
+
+// Mask pairs that couple to channel and satisfy e_a + e_b <= e2max.
+//
+// This fuses parity, Tz, triangle, and energy checks into a single pass.
+template <typename PackedT>
+std::size_t MaskTwoBodyChannel(
+    const PackedT* a,
+    const PackedT* b,
+    std::size_t n,
+    PackedChannel channel,
+    int e2max,
+    std::uint8_t* mask) {
+  namespace impl = batch_filters_impl;
+  const std::int32_t two_j = channel.TwoJ();
+  const std::int32_t parity = channel.Parity();
+  const std::int32_t two_tz = channel.TwoTz();
+  std::size_t count = 0UL;
+#pragma omp simd reduction(+ : count)
+  for (std::size_t i = 0; i < n; i += 1) {
+    const std::uint32_t wa = impl::Word(a[i]);
+    const std::uint32_t wb = impl::Word(b[i]);
+    const std::uint8_t pass = static_cast<std::uint8_t>(
+        impl::Triangle(impl::TwoJ(wa), impl::TwoJ(wb), two_j) &
+        (((impl::L(wa) + impl::L(wb)) & 0x1) == parity) &
+        (impl::TwoTz(impl::TzUp(wa) + impl::TzUp(wb), 2) == two_tz) &
+        (impl::E(wa) + impl::E(wb) <= e2max));
+    mask[i] = pass;
+    count += pass;
+  }
+  return count;
+}
+
+// Mask pairs (a, b[i]) that couple to channel and satisfy e_a + e_b <= e2max.
+template <typename PackedT>
+std::size_t MaskTwoBodyChannel(
+    PackedT a,
+    const PackedT* b,
+    std::size_t n,
+    PackedChannel channel,
+    int e2max,
+    std::uint8_t* mask) {
+  namespace impl = batch_filters_impl;
+  const std::uint32_t wa = impl::Word(a);
+  const std::int32_t two_j = channel.TwoJ();
+  const std::int32_t parity = (channel.Parity() + impl::L(wa)) & 0x1;
+  const std::int32_t two_tz = channel.TwoTz();
+  const std::int32_t ja = impl::TwoJ(wa);
+  const std::int32_t up_a = impl::TzUp(wa);
+  const std::int32_t e_lim = e2max - impl::E(wa);
+  std::size_t count = 0UL;
+#pragma omp simd reduction(+ : count)
+  for (std::size_t i = 0; i < n; i += 1) {
+    const std::uint32_t wb = impl::Word(b[i]);
+    const std::uint8_t pass = static_cast<std::uint8_t>(
+        impl::Triangle(ja, impl::TwoJ(wb), two_j) &
+        ((impl::L(wb) & 0x1) == parity) &
+        (impl::TwoTz(up_a + impl::TzUp(wb), 2) == two_tz) &
+        (impl::E(wb) <= e_lim));
+    mask[i] = pass;
+    count += pass;
+  }
+  return count;
+}
+
+// Mask triples ((a b) J_ab, c) that couple to channel
+// and satisfy e_a + e_b + e_c <= e3max.
+//
+// two_jab[i] is the doubled coupled angular momentum of a[i] and b[i].
+// The triangle condition on (j_a, j_b, J_ab) is checked as well.
+template <typename PackedT>
+std::size_t MaskThreeBodyChannel(
+    const PackedT* a,
+    const PackedT* b,
+    const PackedT* c,
+    const std::int32_t* two_jab,
+    std::size_t n,
+    PackedChannel channel,
+    int e3max,
+    std::uint8_t* mask) {
+  namespace impl = batch_filters_impl;
+  const std::int32_t two_j = channel.TwoJ();
+  const std::int32_t parity = channel.Parity();
+  const std::int32_t two_tz = channel.TwoTz();
+  std::size_t count = 0UL;
+#pragma omp simd reduction(+ : count)
+  for (std::size_t i = 0; i < n; i += 1) {
+    const std::uint32_t wa = impl::Word(a[i]);
+    const std::uint32_t wb = impl::Word(b[i]);
+    const std::uint32_t wc = impl::Word(c[i]);
+    const std::int32_t up = impl::TzUp(wa) + impl::TzUp(wb) + impl::TzUp(wc);
+    const std::uint8_t pass = static_cast<std::uint8_t>(
+        impl::Triangle(impl::TwoJ(wa), impl::TwoJ(wb), two_jab[i]) &
+        impl::Triangle(two_jab[i], impl::TwoJ(wc), two_j) &
+        (((impl::L(wa) + impl::L(wb) + impl::L(wc)) & 0x1) == parity) &
+        (impl::TwoTz(up, 3) == two_tz) &
+        (impl::E(wa) + impl::E(wb) + impl::E(wc) <= e3max));
+    mask[i] = pass;
+    count += pass;
+  }
+  return count;
+}
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_QUANTUM_NUMBERS_BATCH_FILTERS_H_
@@ -0,0 +1,231 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/quantum_numbers/batch_filters.h"
+
+#include <random>
+
+#include "catch2/catch_test_macros.hpp"
+
+#include "nui/core/basics/basics.h"
+#include "nui/physics/quantum_numbers/quantum_numbers.h"
+
+using nui::PackedChannel;
+using nui::PackedOrbital;
+
+inline std::vector<PackedOrbital> MakeRandomOrbitals(
+    std::size_t n,
+    unsigned seed) {
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<int> dist_nl(0, 7);
+  std::uniform_int_distribution<int> dist_bit(0, 1);
+  std::vector<PackedOrbital> orbitals;
+  orbitals.reserve(n);
+  for (std::size_t i = 0; i < n; i += 1) {
+    const int l = dist_nl(gen);
+    const int two_j = (l == 0 || dist_bit(gen)) ? 2 * l + 1 : 2 * l - 1;
+    const int two_tz = dist_bit(gen) ? 1 : -1;
+    orbitals.push_back(PackedOrbital(dist_nl(gen), l, two_j, two_tz));
+  }
+  return orbitals;
+}
+
+inline bool Triangle(int j1, int j2, int j3) {
+  return (std::abs(j1 - j2) <= j3) && (j3 <= j1 + j2);
+}
+
+// Odd size to exercise vector remainder loops.
+constexpr std::size_t kNumCandidates = 1001;
+
+TEST_CASE("MaskParity, Test against scalar predicate.") {
+  const auto a = MakeRandomOrbitals(kNumCandidates, 1);
+  const auto b = MakeRandomOrbitals(kNumCandidates, 2);
+  std::vector<std::uint8_t> mask(kNumCandidates);
+  for (const int parity : {0, 1}) {
+    const auto count =
+        nui::MaskParity(a.data(), b.data(), a.size(), parity, mask.data());
+    std::size_t expected = 0UL;
+    for (std::size_t i = 0; i < a.size(); i += 1) {
+      const bool pass = (a[i].Parity() + b[i].Parity()) % 2 == parity;
+      REQUIRE(mask[i] == pass);
+      expected += pass;
+    }
+    REQUIRE(count == expected);
+  }
+}
+
+TEST_CASE("MaskTwoTz, Test against scalar predicate.") {
+  const auto a = MakeRandomOrbitals(kNumCandidates, 3);
+  const auto b = MakeRandomOrbitals(kNumCandidates, 4);
+  std::vector<std::uint8_t> mask(kNumCandidates);
+  for (const int two_tz : {-2, 0, 2}) {
+    const auto count =
+        nui::MaskTwoTz(a.data(), b.data(), a.size(), two_tz, mask.data());
+    std::size_t expected = 0UL;
+    for (std::size_t i = 0; i < a.size(); i += 1) {
+      const bool pass = a[i].TwoTz() + b[i].TwoTz() == two_tz;
+      REQUIRE(mask[i] == pass);
+      expected += pass;
+    }
+    REQUIRE(count == expected);
+  }
+}
+
+TEST_CASE("MaskTriangle, Test against scalar predicate.") {
+  const auto a = MakeRandomOrbitals(kNumCandidates, 5);
+  const auto b = MakeRandomOrbitals(kNumCandidates, 6);
+  std::vector<std::uint8_t> mask(kNumCandidates);
+  for (const int two_j : {0, 2, 6, 14}) {
+    const auto count =
+        nui::MaskTriangle(a.data(), b.data(), a.size(), two_j, mask.data());
+    std::size_t expected = 0UL;
+    for (std::size_t i = 0; i < a.size(); i += 1) {
+      const bool pass = Triangle(a[i].TwoJ(), b[i].TwoJ(), two_j);
+      REQUIRE(mask[i] == pass);
+      expected += pass;
+    }
+    REQUIRE(count == expected);
+  }
+}
+
+TEST_CASE("MaskEnergySum, Test against scalar predicate.") {
+  const auto a = MakeRandomOrbitals(kNumCandidates, 7);
+  const auto b = MakeRandomOrbitals(kNumCandidates, 8);
+  const auto c = MakeRandomOrbitals(kNumCandidates, 9);
+  std::vector<std::uint8_t> mask(kNumCandidates);
+  SECTION("two-body") {
+    for (const int emax : {0, 8, 20}) {
+      const auto count =
+          nui::MaskEnergySum(a.data(), b.data(), a.size(), emax, mask.data());
+      std::size_t expected = 0UL;
+      for (std::size_t i = 0; i < a.size(); i += 1) {
+        const bool pass = a[i].E() + b[i].E() <= emax;
+        REQUIRE(mask[i] == pass);
+        expected += pass;
+      }
+      REQUIRE(count == expected);
+    }
+  }
+  SECTION("three-body") {
+    for (const int emax : {0, 12, 30}) {
+      const auto count = nui::MaskEnergySum(
+          a.data(),
+          b.data(),
+          c.data(),
+          a.size(),
+          emax,
+          mask.data());
+      std::size_t expected = 0UL;
+      for (std::size_t i = 0; i < a.size(); i += 1) {
+        const bool pass = a[i].E() + b[i].E() + c[i].E() <= emax;
+        REQUIRE(mask[i] == pass);
+        expected += pass;
+      }
+      REQUIRE(count == expected);
+    }
+  }
+}
+
+TEST_CASE("MaskTwoBodyChannel, Test against scalar predicate.") {
+  const auto a = MakeRandomOrbitals(kNumCandidates, 10);
+  const auto b = MakeRandomOrbitals(kNumCandidates, 11);
+  std::vector<std::uint8_t> mask(kNumCandidates);
+  std::vector<std::uint8_t> mask_fixed(kNumCandidates);
+  for (const PackedChannel chan :
+       {PackedChannel(0, 0, 0), PackedChannel(4, 1, -2),
+        PackedChannel(6, 0, 2)}) {
+    const auto count = nui::MaskTwoBodyChannel(
+        a.data(),
+        b.data(),
+        a.size(),
+        chan,
+        24,
+        mask.data());
+    std::size_t expected = 0UL;
+    for (std::size_t i = 0; i < a.size(); i += 1) {
+      const bool pass =
+          Triangle(a[i].TwoJ(), b[i].TwoJ(), chan.TwoJ()) &&
+          ((a[i].Parity() + b[i].Parity()) % 2 == chan.Parity()) &&
+          (a[i].TwoTz() + b[i].TwoTz() == chan.TwoTz()) &&
+          (a[i].E() + b[i].E() <= 24);
+      REQUIRE(mask[i] == pass);
+      expected += pass;
+    }
+    REQUIRE(count == expected);
+
+    const auto count_fixed = nui::MaskTwoBodyChannel(
+        a[0],
+        b.data(),
+        b.size(),
+        chan,
+        24,
+        mask_fixed.data());
+    std::size_t expected_fixed = 0UL;
+    for (std::size_t i = 0; i < b.size(); i += 1) {
+      const bool pass =
+          Triangle(a[0].TwoJ(), b[i].TwoJ(), chan.TwoJ()) &&
+          ((a[0].Parity() + b[i].Parity()) % 2 == chan.Parity()) &&
+          (a[0].TwoTz() + b[i].TwoTz() == chan.TwoTz()) &&
+          (a[0].E() + b[i].E() <= 24);
+      REQUIRE(mask_fixed[i] == pass);
+      expected_fixed += pass;
+    }
+    REQUIRE(count_fixed == expected_fixed);
+  }
+}
+
+TEST_CASE("MaskThreeBodyChannel, Test against scalar predicate.") {
+  const auto a = MakeRandomOrbitals(kNumCandidates, 12);
+  const auto b = MakeRandomOrbitals(kNumCandidates, 13);
+  const auto c = MakeRandomOrbitals(kNumCandidates, 14);
+  std::vector<std::int32_t> two_jab(kNumCandidates);
+  for (std::size_t i = 0; i < kNumCandidates; i += 1) {
+    two_jab[i] = 2 * static_cast<std::int32_t>(i % 9);
+  }
+  std::vector<std::uint8_t> mask(kNumCandidates);
+  for (const PackedChannel chan :
+       {PackedChannel(1, 0, -1), PackedChannel(5, 1, 1),
+        PackedChannel(9, 0, 3)}) {
+    const auto count = nui::MaskThreeBodyChannel(
+        a.data(),
+        b.data(),
+        c.data(),
+        two_jab.data(),
+        a.size(),
+        chan,
+        30,
+        mask.data());
+    std::size_t expected = 0UL;
+    for (std::size_t i = 0; i < a.size(); i += 1) {
+      const bool pass =
+          Triangle(a[i].TwoJ(), b[i].TwoJ(), two_jab[i]) &&
+          Triangle(two_jab[i], c[i].TwoJ(), chan.TwoJ()) &&
+          ((a[i].Parity() + b[i].Parity() + c[i].Parity()) % 2 ==
+           chan.Parity()) &&
+          (a[i].TwoTz() + b[i].TwoTz() + c[i].TwoTz() == chan.TwoTz()) &&
+          (a[i].E() + b[i].E() + c[i].E() <= 30);
+      REQUIRE(mask[i] == pass);
+      expected += pass;
+    }
+    REQUIRE(count == expected);
+  }
+}
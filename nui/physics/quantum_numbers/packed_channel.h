@@ -0,0 +1,114 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_QUANTUM_NUMBERS_PACKED_CHANNEL_H_
+#define NUI_PHYSICS_QUANTUM_NUMBERS_PACKED_CHANNEL_H_
+
+// IWYU pragma: private, include "nui/physics/quantum_numbers/quantum_numbers.h"
+// IWYU pragma: friend "nui/physics/quantum_numbers/.*\.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/indexing/indexing.h"
+
+namespace nui {
+class ChannelKey;
+}  // namespace nui
+
+// Dense key of a J-scheme channel (J, parity, Tz).
+NUI_MAKE_INDEX_TYPE(ChannelKey);
+
+namespace nui {
+
+// Quantum numbers (J, parity, Tz) of a J-scheme many-body channel
+// packed into a single 32-bit word.
+//
+// J and Tz are stored doubled, so the same type serves 2- and 3-body
+// channels. The packed word is also the dense key:
+//
+// | bits | field     |
+// | ---- | --------- |
+// | 0    | parity    |
+// | 1-4  | 2Tz + 8   |
+// | 5-12 | 2J        |
+class PackedChannel {
+ public:
+  // Construct channel with J = 0, positive parity, and Tz = 0.
+  constexpr PackedChannel() noexcept : PackedChannel(0, 0, 0) {}
+
+  // Construct channel from doubled J, parity (0 or 1), and doubled Tz.
+  constexpr PackedChannel(int two_j, int parity, int two_tz) noexcept
+      : w_((static_cast<std::uint32_t>(two_j) << 5) |
+           (static_cast<std::uint32_t>(two_tz + 8) << 1) |
+           static_cast<std::uint32_t>(parity & 0x1)) {}
+
+  // Construct channel from dense key.
+  constexpr static PackedChannel FromKey(ChannelKey key) noexcept {
+    PackedChannel c;
+    c.w_ = static_cast<std::uint32_t>(key.idx());
+    return c;
+  }
+
+  constexpr int TwoJ() const noexcept { return static_cast<int>(w_ >> 5); }
+  constexpr int Parity() const noexcept {
+    return static_cast<int>(w_ & 0x1);
+  }
+  constexpr int TwoTz() const noexcept {
+    return static_cast<int>((w_ >> 1) & 0xF) - 8;
+  }
+
+  // Get raw packed word.
+  constexpr std::uint32_t Word() const noexcept { return w_; }
+
+  // Get dense key for lookups.
+  constexpr ChannelKey Key() const noexcept { return w_; }
+
+  // Swap with other channel.
+  void swap(PackedChannel& other) noexcept {
+    using std::swap;
+    swap(w_, other.w_);
+  }
+
+ private:
+  std::uint32_t w_ = 0U;
+};
+
+static_assert(sizeof(PackedChannel) == sizeof(std::uint32_t));
+
+// Swap two channels.
+inline void swap(PackedChannel& a, PackedChannel& b) noexcept { a.swap(b); }
+
+// Compare two channels.
+constexpr bool operator==(PackedChannel a, PackedChannel b) noexcept {
+  return a.Word() == b.Word();
+}
+// Compare two channels.
+constexpr bool operator!=(PackedChannel a, PackedChannel b) noexcept {
+  return a.Word() != b.Word();
+}
+// Compare two channels (by packed word).
+constexpr bool operator<(PackedChannel a, PackedChannel b) noexcept {
+  return a.Word() < b.Word();
+}
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_QUANTUM_NUMBERS_PACKED_CHANNEL_H_
@@ -0,0 +1,341 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_QUANTUM_NUMBERS_PACKED_STATE_H_
+#define NUI_PHYSICS_QUANTUM_NUMBERS_PACKED_STATE_H_
+
+// IWYU pragma: private, include "nui/physics/quantum_numbers/quantum_numbers.h"
+// IWYU pragma: friend "nui/physics/quantum_numbers/.*\.h"
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/indexing/indexing.h"
+
+namespace nui {
+class OrbitalKey;
+class SPStateKey;
+}  // namespace nui
+
+// Dense key of a J-scheme orbital (n, l, j, tz).
+//
+// All orbitals with n, l < 64 have keys in [0, 2^14), small orbitals have
+// small keys. This makes keys suitable as inputs to IndexConversion.
+NUI_MAKE_INDEX_TYPE(OrbitalKey);
+
+// Dense key of an m-scheme single-particle state (n, l, j, m, tz).
+//
+// Keys are the orbital key shifted by 7 bits with (j + m) in the lower bits,
+// so all 2j <= 127 are supported.
+NUI_MAKE_INDEX_TYPE(SPStateKey);
+
+namespace nui {
+
+// Bit layout shared by PackedOrbital and PackedSPState.
+//
+// All angular momenta and isospin projections are stored doubled,
+// so half-integer quantum numbers are exact integers.
+//
+// | bits  | field     |
+// | ----- | --------- |
+// | 0-5   | n         |
+// | 6-11  | l         |
+// | 12-18 | 2j        |
+// | 19    | 2tz == +1 |
+// | 20-27 | 2m + 127  |
+// | 28-31 | unused    |
+namespace qn_packing {
+
+constexpr std::uint32_t kNShift = 0;
+constexpr std::uint32_t kLShift = 6;
+constexpr std::uint32_t kTwoJShift = 12;
+constexpr std::uint32_t kTzShift = 19;
+constexpr std::uint32_t kTwoMShift = 20;
+
+constexpr std::uint32_t kNMask = 0x3F;
+constexpr std::uint32_t kLMask = 0x3F;
+constexpr std::uint32_t kTwoJMask = 0x7F;
+constexpr std::uint32_t kTzMask = 0x1;
+constexpr std::uint32_t kTwoMMask = 0xFF;
+
+constexpr int kTwoMOffset = 127;
+
+// Bits of (j + m) in the lower part of SPStateKey.
+constexpr std::size_t kSPStateKeyShift = 7;
+constexpr std::size_t kSPStateKeyMask = 0x7F;
+
+// Largest representable values.
+constexpr int kMaxN = 63;
+constexpr int kMaxL = 63;
+constexpr int kMaxTwoJ = 127;
+
+static_assert(
+    static_cast<std::size_t>(kMaxTwoJ) <= kSPStateKeyMask,
+    "(j + m) must fit into the lower bits of SPStateKey.");
+
+// Mask for all bits belonging to the J-scheme orbital.
+constexpr std::uint32_t kOrbitalBits = (kNMask << kNShift) |
+                                       (kLMask << kLShift) |
+                                       (kTwoJMask << kTwoJShift) |
+                                       (kTzMask << kTzShift);
+
+constexpr int ExtractN(std::uint32_t w) noexcept {
+  return static_cast<int>((w >> kNShift) & kNMask);
+}
+constexpr int ExtractL(std::uint32_t w) noexcept {
+  return static_cast<int>((w >> kLShift) & kLMask);
+}
+constexpr int ExtractTwoJ(std::uint32_t w) noexcept {
+  return static_cast<int>((w >> kTwoJShift) & kTwoJMask);
+}
+constexpr int ExtractTwoTz(std::uint32_t w) noexcept {
+  return 2 * static_cast<int>((w >> kTzShift) & kTzMask) - 1;
+}
+constexpr int ExtractTwoM(std::uint32_t w) noexcept {
+  return static_cast<int>((w >> kTwoMShift) & kTwoMMask) - kTwoMOffset;
+}
+constexpr int ExtractParity(std::uint32_t w) noexcept {
+  return static_cast<int>((w >> kLShift) & 0x1);
+}
+constexpr int ExtractE(std::uint32_t w) noexcept {
+  return 2 * ExtractN(w) + ExtractL(w);
+}
+
+constexpr std::uint32_t PackOrbital(
+    int n,
+    int l,
+    int two_j,
+    int two_tz) noexcept {
+  return ((static_cast<std::uint32_t>(n) & kNMask) << kNShift) |
+         ((static_cast<std::uint32_t>(l) & kLMask) << kLShift) |
+         ((static_cast<std::uint32_t>(two_j) & kTwoJMask) << kTwoJShift) |
+         ((two_tz > 0 ? 1U : 0U) << kTzShift);
+}
+
+constexpr std::uint32_t PackTwoM(int two_m) noexcept {
+  return (static_cast<std::uint32_t>(two_m + kTwoMOffset) & kTwoMMask)
+         << kTwoMShift;
+}
+
+// Dense orbital key: n in bits 8-13, l in bits 2-7, (j == l + 1/2) in bit 1,
+// (tz == +1/2) in bit 0.
+constexpr std::size_t OrbitalKeyFromWord(std::uint32_t w) noexcept {
+  const std::size_t j_up = ExtractTwoJ(w) > 2 * ExtractL(w) ? 1UL : 0UL;
+  const std::size_t tz_up = (w >> kTzShift) & kTzMask;
+  return (static_cast<std::size_t>(ExtractN(w)) << 8) |
+         (static_cast<std::size_t>(ExtractL(w)) << 2) | (j_up << 1) | tz_up;
+}
+
+constexpr std::uint32_t WordFromOrbitalKey(std::size_t key) noexcept {
+  const int n = static_cast<int>((key >> 8) & kNMask);
+  const int l = static_cast<int>((key >> 2) & kLMask);
+  const int two_j = ((key >> 1) & 0x1) ? 2 * l + 1 : 2 * l - 1;
+  const int two_tz = (key & 0x1) ? 1 : -1;
+  return PackOrbital(n, l, two_j, two_tz);
+}
+
+}  // namespace qn_packing
+
+// Quantum numbers (n, l, j, tz) of a J-scheme harmonic oscillator orbital
+// packed into a single 32-bit word.
+//
+// Supports n, l <= 63 and 2j <= 127.
+class PackedOrbital {
+ public:
+  // Construct orbital with all bits zero (not a physical orbital).
+  constexpr PackedOrbital() noexcept {}
+
+  // Construct orbital from quantum numbers (with doubled j and tz).
+  constexpr PackedOrbital(int n, int l, int two_j, int two_tz) noexcept
+      : w_(qn_packing::PackOrbital(n, l, two_j, two_tz)) {}
+
+  // Construct orbital from raw packed word.
+  //
+  // Bits belonging to m-scheme quantum numbers are dropped.
+  constexpr static PackedOrbital FromWord(std::uint32_t w) noexcept {
+    PackedOrbital o;
+    o.w_ = w & qn_packing::kOrbitalBits;
+    return o;
+  }
+
+  // Construct orbital from dense key.
+  constexpr static PackedOrbital FromKey(OrbitalKey key) noexcept {
+    return FromWord(qn_packing::WordFromOrbitalKey(key.idx()));
+  }
+
+  constexpr int N() const noexcept { return qn_packing::ExtractN(w_); }
+  constexpr int L() const noexcept { return qn_packing::ExtractL(w_); }
+  constexpr int TwoJ() const noexcept { return qn_packing::ExtractTwoJ(w_); }
+  constexpr int TwoTz() const noexcept {
+    return qn_packing::ExtractTwoTz(w_);
+  }
+  // Get parity as 0 (even) or 1 (odd).
+  constexpr int Parity() const noexcept {
+    return qn_packing::ExtractParity(w_);
+  }
+  // Get harmonic oscillator energy quantum number e = 2n + l.
+  constexpr int E() const noexcept { return qn_packing::ExtractE(w_); }
+
+  // Get raw packed word.
+  constexpr std::uint32_t Word() const noexcept { return w_; }
+
+  // Get dense key for lookups.
+  constexpr OrbitalKey Key() const noexcept {
+    return qn_packing::OrbitalKeyFromWord(w_);
+  }
+
+  // Check that j = l +- 1/2.
+  constexpr bool IsPhysical() const noexcept {
+    return (TwoJ() == 2 * L() + 1) || (L() > 0 && TwoJ() == 2 * L() - 1);
+  }
+
+  // Swap with other orbital.
+  void swap(PackedOrbital& other) noexcept {
+    using std::swap;
+    swap(w_, other.w_);
+  }
+
+ private:
+  std::uint32_t w_ = 0U;
+};
+
+static_assert(sizeof(PackedOrbital) == sizeof(std::uint32_t));
+
+// Quantum numbers (n, l, j, m, tz) of an m-scheme harmonic oscillator state
+// packed into a single 32-bit word.
+//
+// Shares the layout of PackedOrbital, so Orbital() is a single mask.
+class PackedSPState {
+ public:
+  // Construct state with all bits zero (not a physical state).
+  constexpr PackedSPState() noexcept {}
+
+  // Construct state from quantum numbers (with doubled j, m, and tz).
+  constexpr PackedSPState(
+      int n,
+      int l,
+      int two_j,
+      int two_m,
+      int two_tz) noexcept
+      : w_(qn_packing::PackOrbital(n, l, two_j, two_tz) |
+           qn_packing::PackTwoM(two_m)) {}
+
+  // Construct state from orbital and doubled m.
+  constexpr PackedSPState(PackedOrbital orbital, int two_m) noexcept
+      : w_(orbital.Word() | qn_packing::PackTwoM(two_m)) {}
+
+  // Construct state from raw packed word.
+  constexpr static PackedSPState FromWord(std::uint32_t w) noexcept {
+    PackedSPState s;
+    s.w_ = w;
+    return s;
+  }
+
+  // Construct state from dense key.
+  constexpr static PackedSPState FromKey(SPStateKey key) noexcept {
+    const PackedOrbital o =
+        PackedOrbital::FromKey(key.idx() >> qn_packing::kSPStateKeyShift);
+    const int two_m =
+        2 * static_cast<int>(key.idx() & qn_packing::kSPStateKeyMask) -
+        o.TwoJ();
+    return PackedSPState(o, two_m);
+  }
+
+  constexpr int N() const noexcept { return qn_packing::ExtractN(w_); }
+  constexpr int L() const noexcept { return qn_packing::ExtractL(w_); }
+  constexpr int TwoJ() const noexcept { return qn_packing::ExtractTwoJ(w_); }
+  constexpr int TwoM() const noexcept { return qn_packing::ExtractTwoM(w_); }
+  constexpr int TwoTz() const noexcept {
+    return qn_packing::ExtractTwoTz(w_);
+  }
+  // Get parity as 0 (even) or 1 (odd).
+  constexpr int Parity() const noexcept {
+    return qn_packing::ExtractParity(w_);
+  }
+  // Get harmonic oscillator energy quantum number e = 2n + l.
+  constexpr int E() const noexcept { return qn_packing::ExtractE(w_); }
+
+  // Get J-scheme orbital of state.
+  constexpr PackedOrbital Orbital() const noexcept {
+    return PackedOrbital::FromWord(w_);
+  }
+
+  // Get raw packed word.
+  constexpr std::uint32_t Word() const noexcept { return w_; }
+
+  // Get dense key for lookups.
+  constexpr SPStateKey Key() const noexcept {
+    return (Orbital().Key().idx() << qn_packing::kSPStateKeyShift) |
+           static_cast<std::size_t>((TwoJ() + TwoM()) / 2);
+  }
+
+  // Check that orbital is physical and |m| <= j.
+  constexpr bool IsPhysical() const noexcept {
+    return Orbital().IsPhysical() && (TwoM() <= TwoJ()) &&
+           (-TwoM() <= TwoJ()) && ((TwoJ() + TwoM()) % 2 == 0);
+  }
+
+  // Swap with other state.
+  void swap(PackedSPState& other) noexcept {
+    using std::swap;
+    swap(w_, other.w_);
+  }
+
+ private:
+  std::uint32_t w_ = 0U;
+};
+
+static_assert(sizeof(PackedSPState) == sizeof(std::uint32_t));
+
+// Swap two orbitals.
+inline void swap(PackedOrbital& a, PackedOrbital& b) noexcept { a.swap(b); }
+
+// Swap two states.
+inline void swap(PackedSPState& a, PackedSPState& b) noexcept { a.swap(b); }
+
+// Compare two orbitals.
+constexpr bool operator==(PackedOrbital a, PackedOrbital b) noexcept {
+  return a.Word() == b.Word();
+}
+// Compare two orbitals.
+constexpr bool operator!=(PackedOrbital a, PackedOrbital b) noexcept {
+  return a.Word() != b.Word();
+}
+// Compare two orbitals (by packed word).
+constexpr bool operator<(PackedOrbital a, PackedOrbital b) noexcept {
+  return a.Word() < b.Word();
+}
+
+// Compare two states.
+constexpr bool operator==(PackedSPState a, PackedSPState b) noexcept {
+  return a.Word() == b.Word();
+}
+// Compare two states.
+constexpr bool operator!=(PackedSPState a, PackedSPState b) noexcept {
+  return a.Word() != b.Word();
+}
+// Compare two states (by packed word).
+constexpr bool operator<(PackedSPState a, PackedSPState b) noexcept {
+  return a.Word() < b.Word();
+}
+
+}  // namespace nui
+
+#endif  // NUI_PHYSICS_QUANTUM_NUMBERS_PACKED_STATE_H_
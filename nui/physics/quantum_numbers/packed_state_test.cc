@@ -0,0 +1,143 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/physics/quantum_numbers/packed_state.h"
+
+#include "catch2/catch_test_macros.hpp"
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/indexing/indexing.h"
+#include "nui/physics/quantum_numbers/quantum_numbers.h"
+
+using nui::OrbitalKey;
+using nui::PackedOrbital;
+using nui::PackedSPState;
+using nui::SPStateKey;
+
+inline std::vector<PackedOrbital> MakeOrbitals(int emax) {
+  std::vector<PackedOrbital> orbitals;
+  for (int e = 0; e <= emax; e += 1) {
+    for (int l = e % 2; l <= e; l += 2) {
+      const int n = (e - l) / 2;
+      for (int two_j = std::abs(2 * l - 1); two_j <= 2 * l + 1; two_j += 2) {
+        for (const int two_tz : {-1, 1}) {
+          orbitals.push_back(PackedOrbital(n, l, two_j, two_tz));
+        }
+      }
+    }
+  }
+  return orbitals;
+}
+
+TEST_CASE("PackedOrbital, Test round trip of quantum numbers.") {
+  for (const int n : {0, 1, 7, 63}) {
+    for (const int l : {0, 1, 6, 63}) {
+      for (int two_j = std::abs(2 * l - 1); two_j <= 2 * l + 1; two_j += 2) {
+        for (const int two_tz : {-1, 1}) {
+          const PackedOrbital o(n, l, two_j, two_tz);
+          REQUIRE(o.N() == n);
+          REQUIRE(o.L() == l);
+          REQUIRE(o.TwoJ() == two_j);
+          REQUIRE(o.TwoTz() == two_tz);
+          REQUIRE(o.Parity() == l % 2);
+          REQUIRE(o.E() == 2 * n + l);
+          REQUIRE(o.IsPhysical());
+          REQUIRE(PackedOrbital::FromWord(o.Word()) == o);
+          REQUIRE(PackedOrbital::FromKey(o.Key()) == o);
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("PackedOrbital, Test keys are unique and dense.") {
+  const auto orbitals = MakeOrbitals(14);
+  std::vector<OrbitalKey> keys;
+  for (const auto& o : orbitals) {
+    keys.push_back(o.Key());
+    REQUIRE(o.Key() < (1UL << 14));
+  }
+  REQUIRE(nui::AreVectorElementsUnique(keys));
+
+  const nui::IndexConversion<OrbitalKey, nui::GenericIndex> table(keys);
+  REQUIRE(table.CheckInvariants());
+  REQUIRE(table.TableSize() <= 8 * 256);
+}
+
+TEST_CASE("PackedOrbital, Test unphysical orbitals.") {
+  REQUIRE_FALSE(PackedOrbital().IsPhysical());
+  REQUIRE_FALSE(PackedOrbital(0, 1, 5, 1).IsPhysical());
+  REQUIRE_FALSE(PackedOrbital(0, 0, 3, 1).IsPhysical());
+}
+
+TEST_CASE("PackedSPState, Test round trip of quantum numbers.") {
+  for (const auto& o : MakeOrbitals(6)) {
+    for (int two_m = -o.TwoJ(); two_m <= o.TwoJ(); two_m += 2) {
+      const PackedSPState s(o.N(), o.L(), o.TwoJ(), two_m, o.TwoTz());
+      REQUIRE(s.N() == o.N());
+      REQUIRE(s.L() == o.L());
+      REQUIRE(s.TwoJ() == o.TwoJ());
+      REQUIRE(s.TwoM() == two_m);
+      REQUIRE(s.TwoTz() == o.TwoTz());
+      REQUIRE(s.Orbital() == o);
+      REQUIRE(s.IsPhysical());
+      REQUIRE(s == PackedSPState(o, two_m));
+      REQUIRE(PackedSPState::FromWord(s.Word()) == s);
+      REQUIRE(PackedSPState::FromKey(s.Key()) == s);
+    }
+  }
+}
+
+TEST_CASE("PackedSPState, Test keys are unique.") {
+  std::vector<SPStateKey> keys;
+  for (const auto& o : MakeOrbitals(10)) {
+    for (int two_m = -o.TwoJ(); two_m <= o.TwoJ(); two_m += 2) {
+      keys.push_back(PackedSPState(o, two_m).Key());
+    }
+  }
+  REQUIRE(nui::AreVectorElementsUnique(keys));
+}
+
+TEST_CASE("PackedSPState, Test keys of largest j.") {
+  const PackedOrbital o(0, 63, 127, 1);
+  std::vector<SPStateKey> keys;
+  for (int two_m = -o.TwoJ(); two_m <= o.TwoJ(); two_m += 2) {
+    const PackedSPState s(o, two_m);
+    REQUIRE(PackedSPState::FromKey(s.Key()) == s);
+    keys.push_back(s.Key());
+  }
+  REQUIRE(nui::AreVectorElementsUnique(keys));
+}
+
+TEST_CASE("PackedChannel, Test round trip of quantum numbers.") {
+  for (const int two_j : {0, 1, 4, 13, 40}) {
+    for (const int parity : {0, 1}) {
+      for (const int two_tz : {-3, -2, 0, 1, 3}) {
+        const nui::PackedChannel c(two_j, parity, two_tz);
+        REQUIRE(c.TwoJ() == two_j);
+        REQUIRE(c.Parity() == parity);
+        REQUIRE(c.TwoTz() == two_tz);
+        REQUIRE(nui::PackedChannel::FromKey(c.Key()) == c);
+      }
+    }
+  }
+}
@@ -0,0 +1,34 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_PHYSICS_QUANTUM_NUMBERS_QUANTUM_NUMBERS_H_
+#define NUI_PHYSICS_QUANTUM_NUMBERS_QUANTUM_NUMBERS_H_
+
+// IWYU pragma: begin_exports
+
+#include "nui/physics/quantum_numbers/batch_filters.h"
+#include "nui/physics/quantum_numbers/packed_channel.h"
+#include "nui/physics/quantum_numbers/packed_state.h"
+
+// IWYU pragma: end_exports
+
+#endif  // NUI_PHYSICS_QUANTUM_NUMBERS_QUANTUM_NUMBERS_H_
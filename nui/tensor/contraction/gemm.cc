@@ -0,0 +1,249 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/tensor/contraction/gemm.h"
+
+#include <algorithm>
+
+#include "nui/core/basics/basics.h"
+#include "nui/core/memory/memory.h"
+
+namespace nui {
+
+namespace {
+
+// Register tile of C.
+constexpr std::size_t kMR = 4;
+constexpr std::size_t kNR = 8;
+// Panels of A (MC x KC, L2) and B (KC x NC, L3).
+constexpr std::size_t kMC = 128;
+constexpr std::size_t kKC = 256;
+constexpr std::size_t kNC = 1024;
+// Below this m * n * k, packing does not pay off.
+constexpr std::size_t kSmall = 16 * 16 * 16;
+
+double Element(
+    const double* x,
+    std::size_t ld,
+    GemmOp op,
+    std::size_t i,
+    std::size_t j) {
+  return op == GemmOp::kNormal ? x[i * ld + j] : x[j * ld + i];
+}
+
+// C = beta * C (without reading C for beta == 0).
+void ScaleC(
+    std::size_t m,
+    std::size_t n,
+    double beta,
+    double* c,
+    std::size_t ldc) {
+  for (std::size_t i = 0; i < m; i += 1) {
+    double* row = c + i * ldc;
+    if (beta == 0.0) {
+      std::fill(row, row + n, 0.0);
+    } else if (beta != 1.0) {
+      for (std::size_t j = 0; j < n; j += 1) {
+        row[j] *= beta;
+      }
+    }
+  }
+}
+
+// Pack rows [i0, i0 + mc) and columns [p0, p0 + kc) of op(A) into slivers
+// of kMR rows stored column by column (zero padded).
+void PackA(
+    const double* a,
+    std::size_t lda,
+    GemmOp op,
+    std::size_t i0,
+    std::size_t mc,
+    std::size_t p0,
+    std::size_t kc,
+    double* out) {
+  for (std::size_t ir = 0; ir < mc; ir += kMR) {
+    const std::size_t mr = std::min(kMR, mc - ir);
+    for (std::size_t p = 0; p < kc; p += 1) {
+      for (std::size_t r = 0; r < kMR; r += 1) {
+        out[r] = r < mr ? Element(a, lda, op, i0 + ir + r, p0 + p) : 0.0;
+      }
+      out += kMR;
+    }
+  }
+}
+
+// Pack rows [p0, p0 + kc) and columns [j0, j0 + nc) of op(B) into slivers
+// of kNR columns stored row by row (zero padded).
+void PackB(
+    const double* b,
+    std::size_t ldb,
+    GemmOp op,
+    std::size_t p0,
+    std::size_t kc,
+    std::size_t j0,
+    std::size_t nc,
+    double* out) {
+  for (std::size_t jr = 0; jr < nc; jr += kNR) {
+    const std::size_t nr = std::min(kNR, nc - jr);
+    for (std::size_t p = 0; p < kc; p += 1) {
+      if (op == GemmOp::kNormal && nr == kNR) {
+        const double* row = b + (p0 + p) * ldb + j0 + jr;
+        std::copy(row, row + kNR, out);
+      } else {
+        for (std::size_t c = 0; c < kNR; c += 1) {
+          out[c] = c < nr ? Element(b, ldb, op, p0 + p, j0 + jr + c) : 0.0;
+        }
+      }
+      out += kNR;
+    }
+  }
+}
+
+// C tile (mr x nr) = alpha * A sliver * B sliver + beta * C tile.
+void MicroKernel(
+    std::size_t kc,
+    const double* ap,
+    const double* bp,
+    std::size_t mr,
+    std::size_t nr,
+    double alpha,
+    double beta,
+    double* c,
+    std::size_t ldc) {
+  alignas(kDefaultAlignment) double acc[kMR * kNR] = {};
+  for (std::size_t p = 0; p < kc; p += 1) {
+    const double* x = ap + p * kMR;
+    const double* y = bp + p * kNR;
+    for (std::size_t r = 0; r < kMR; r += 1) {
+#pragma omp simd
+      for (std::size_t j = 0; j < kNR; j += 1) {
+        acc[r * kNR + j] += x[r] * y[j];
+      }
+    }
+  }
+  for (std::size_t r = 0; r < mr; r += 1) {
+    double* row = c + r * ldc;
+    for (std::size_t j = 0; j < nr; j += 1) {
+      row[j] = beta == 0.0 ? alpha * acc[r * kNR + j]
+                           : alpha * acc[r * kNR + j] + beta * row[j];
+    }
+  }
+}
+
+// Unpacked triple loop for small products.
+void SmallGemm(
+    GemmOp op_a,
+    GemmOp op_b,
+    std::size_t m,
+    std::size_t n,
+    std::size_t k,
+    double alpha,
+    const double* a,
+    std::size_t lda,
+    const double* b,
+    std::size_t ldb,
+    double beta,
+    double* c,
+    std::size_t ldc) {
+  ScaleC(m, n, beta, c, ldc);
+  for (std::size_t i = 0; i < m; i += 1) {
+    double* row = c + i * ldc;
+    for (std::size_t p = 0; p < k; p += 1) {
+      const double x = alpha * Element(a, lda, op_a, i, p);
+      if (op_b == GemmOp::kNormal) {
+        const double* y = b + p * ldb;
+#pragma omp simd
+        for (std::size_t j = 0; j < n; j += 1) {
+          row[j] += x * y[j];
+        }
+      } else {
+        for (std::size_t j = 0; j < n; j += 1) {
+          row[j] += x * b[j * ldb + p];
+        }
+      }
+    }
+  }
+}
+
+}  // namespace
+
+void Gemm(
+    GemmOp op_a,
+    GemmOp op_b,
+    std::size_t m,
+    std::size_t n,
+    std::size_t k,
+    double alpha,
+    const double* a,
+    std::size_t lda,
+    const double* b,
+    std::size_t ldb,
+    double beta,
+    double* c,
+    std::size_t ldc) {
+  if (m == 0 || n == 0) {
+    return;
+  }
+  if (k == 0 || alpha == 0.0) {
+    ScaleC(m, n, beta, c, ldc);
+    return;
+  }
+  if (m * n * k <= kSmall) {
+    SmallGemm(op_a, op_b, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+    return;
+  }
+
+  thread_local AlignedVector<double> pack_a;
+  thread_local AlignedVector<double> pack_b;
+  pack_a.resize(AlignUp(std::min(m, kMC), kMR) * std::min(k, kKC));
+  pack_b.resize(AlignUp(std::min(n, kNC), kNR) * std::min(k, kKC));
+
+  for (std::size_t jc = 0; jc < n; jc += kNC) {
+    const std::size_t nc = std::min(kNC, n - jc);
+    for (std::size_t pc = 0; pc < k; pc += kKC) {
+      const std::size_t kc = std::min(kKC, k - pc);
+      // Later panels of k accumulate into C.
+      const double beta_eff = pc == 0 ? beta : 1.0;
+      PackB(b, ldb, op_b, pc, kc, jc, nc, pack_b.data());
+      for (std::size_t ic = 0; ic < m; ic += kMC) {
+        const std::size_t mc = std::min(kMC, m - ic);
+        PackA(a, lda, op_a, ic, mc, pc, kc, pack_a.data());
+        for (std::size_t jr = 0; jr < nc; jr += kNR) {
+          for (std::size_t ir = 0; ir < mc; ir += kMR) {
+            MicroKernel(
+                kc,
+                pack_a.data() + ir * kc,
+                pack_b.data() + jr * kc,
+                std::min(kMR, mc - ir),
+                std::min(kNR, nc - jr),
+                alpha,
+                beta_eff,
+                c + (ic + ir) * ldc + jc + jr,
+                ldc);
+          }
+        }
+      }
+    }
+  }
+}
+
+}  // namespace nui
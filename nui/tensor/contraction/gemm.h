@@ -0,0 +1,74 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUI_TENSOR_CONTRACTION_GEMM_H_
+#define NUI_TENSOR_CONTRACTION_GEMM_H_
+
+// IWYU pragma: private, include "nui/tensor/contraction/tensor_contraction.h"
+// IWYU pragma: friend "nui/tensor/contraction/.*\.h"
+
+#include "nui/core/basics/basics.h"
+
+// General matrix multiplication of row-major double matrices.
+//
+// Gemm follows the BLAS dgemm interface with row-major storage: operands are
+// copied block by block into contiguous panels that fit the caches, and a
+// register-blocked kernel updates MR x NR tiles of C from them. Gemm is
+// serial and thread-safe (panels are thread-local), so callers parallelize
+// over independent multiplications, e.g., over channels.
+
+namespace nui {
+
+// Operation applied to a Gemm operand.
+enum class GemmOp : std::uint8_t {
+  kNormal = 0,
+  kTranspose = 1,
+};
+
+// C = alpha * op(A) * op(B) + beta * C.
+//
+// op(A) is m x k, op(B) is k x n, and C is m x n, all row-major with leading
+// dimensions lda, ldb, and ldc. C is not read if beta == 0.
+void Gemm(
+    GemmOp op_a,
+    GemmOp op_b,
+    std::size_t m,
+    std::size_t n,
+    std::size_t k,
+    double alpha,
+    const double* a,
+    std::size_t lda,
+    const double* b,
+    std::size_t ldb,
+    double beta,
+    double* c,
+    std::size_t ldc);
+
+// Get number of floating point operations of a Gemm call (2 m n k).
+constexpr double GemmFlops(std::size_t m, std::size_t n, std::size_t k) {
+  return 2.0 * static_cast<double>(m) * static_cast<double>(n) *
+         static_cast<double>(k);
+}
+
+}  // namespace nui
+
+#endif  // NUI_TENSOR_CONTRACTION_GEMM_H_
@@ -0,0 +1,97 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdlib>
+#include <vector>
+
+#include "fmt/core.h"
+#include "nui/core/basics/basics.h"
+#include "nui/core/memory/memory.h"
+#include "nui/info/profiling/profiling.h"
+#include "nui/tensor/contraction/tensor_contraction.h"
+
+// Benchmark of Gemm against a plain triple loop.
+//
+// Usage: nui_tensor_contraction_gemm_bench [n] [naive]
+//
+// Multiplies n x n matrices (all four operand transpositions).
+
+int main(int argc, char** argv) {
+  const std::size_t n = argc > 1 ? std::atoi(argv[1]) : 1000;
+  const bool naive = argc > 2 ? std::atoi(argv[2]) != 0 : true;
+
+  nui::AlignedVector<double> a(n * n);
+  nui::AlignedVector<double> b(n * n);
+  nui::AlignedVector<double> c(n * n);
+  for (std::size_t i = 0; i < n * n; i += 1) {
+    a[i] = 1.0 / (1.0 + static_cast<double>(i % 97));
+    b[i] = 1.0 / (2.0 + static_cast<double>(i % 89));
+  }
+  const double flops = nui::GemmFlops(n, n, n);
+  fmt::print("n = {}, {:.2f} GFLOP per product\n", n, flops * 1e-9);
+
+  for (const auto op_a : {nui::GemmOp::kNormal, nui::GemmOp::kTranspose}) {
+    for (const auto op_b : {nui::GemmOp::kNormal, nui::GemmOp::kTranspose}) {
+      const double seconds = nui::TimeSeconds([&]() {
+        nui::Gemm(
+            op_a,
+            op_b,
+            n,
+            n,
+            n,
+            1.0,
+            a.data(),
+            n,
+            b.data(),
+            n,
+            0.0,
+            c.data(),
+            n);
+      });
+      fmt::print(
+          "Gemm {}{} {:>10.3f} ms {:>8.2f} GFLOP/s\n",
+          op_a == nui::GemmOp::kNormal ? 'N' : 'T',
+          op_b == nui::GemmOp::kNormal ? 'N' : 'T',
+          seconds * 1e3,
+          flops / seconds * 1e-9);
+    }
+  }
+
+  if (naive) {
+    const double seconds = nui::TimeSeconds([&]() {
+      for (std::size_t i = 0; i < n; i += 1) {
+        for (std::size_t j = 0; j < n; j += 1) {
+          double sum = 0.0;
+          for (std::size_t p = 0; p < n; p += 1) {
+            sum += a[i * n + p] * b[p * n + j];
+          }
+          c[i * n + j] = sum;
+        }
+      }
+    });
+    fmt::print(
+        "Naive NN {:>10.3f} ms {:>8.2f} GFLOP/s\n",
+        seconds * 1e3,
+        flops / seconds * 1e-9);
+  }
+  return 0;
+}
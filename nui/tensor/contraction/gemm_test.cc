@@ -0,0 +1,121 @@
+// MIT License
+//
+// Copyright (c) 2023 Matthias Heinz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "nui/tensor/contraction/gemm.h"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "catch2/catch_approx.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "nui/core/basics/basics.h"
+
+namespace {
+
+using nui::GemmOp;
+
+std::vector<double> MakeMatrix(std::size_t rows, std::size_t cols, double x) {
+  std::vector<double> m(rows * cols);
+  for (std::size_t i = 0; i < m.size(); i += 1) {
+    m[i] = std::sin(x + 0.37 * i);
+  }
+  return m;
+}
+
+double Element(
+    const std::vector<double>& x,
+    std::size_t ld,
+    GemmOp op,
+    std::size_t i,
+    std::size_t j) {
+  return op == GemmOp::kNormal ? x[i * ld + j] : x[j * ld + i];
+}
+
+// Compare Gemm with a triple loop (with padded leading dimensions).
+void Check(
+    GemmOp op_a,
+    GemmOp op_b,
+    std::size_t m,
+    std::size_t n,
+    std::size_t k,
+    double beta) {
+  const double alpha = 0.7;
+  const std::size_t lda = (op_a == GemmOp::kNormal ? k : m) + 3;
+  const std::size_t ldb = (op_b == GemmOp::kNormal ? n : k) + 1;
+  const std::size_t ldc = n + 2;
+  const auto a = MakeMatrix(op_a == GemmOp::kNormal ? m : k, lda, 1.0);
+  const auto b = MakeMatrix(op_b == GemmOp::kNormal ? k : n, ldb, 2.0);
+  auto c = MakeMatrix(m, ldc, 3.0);
+  if (beta == 0.0) {
+    // C must not be read.
+    c.assign(c.size(), std::numeric_limits<double>::quiet_NaN());
+  }
+  const auto c0 = c;
+  nui::Gemm(
+      op_a,
+      op_b,
+      m,
+      n,
+      k,
+      alpha,
+      a.data(),
+      lda,
+      b.data(),
+      ldb,
+      beta,
+      c.data(),
+      ldc);
+  for (std::size_t i = 0; i < m; i += 1) {
+    for (std::size_t j = 0; j < n; j += 1) {
+      double expected = 0.0;
+      for (std::size_t p = 0; p < k; p += 1) {
+        expected += Element(a, lda, op_a, i, p) * Element(b, ldb, op_b, p, j);
+      }
+      expected *= alpha;
+      if (beta != 0.0) {
+        expected += beta * c0[i * ldc + j];
+      }
+      REQUIRE(c[i * ldc + j] == Catch::Approx(expected).margin(1e-12));
+    }
+    // Padding is untouched.
+    REQUIRE(std::isnan(c[i * ldc + n]) == (beta == 0.0));
+  }
+}
+
+}  // namespace
+
+TEST_CASE("Gemm, Test against triple loop.") {
+  for (const auto op_a : {GemmOp::kNormal, GemmOp::kTranspose}) {
+    for (const auto op_b : {GemmOp::kNormal, GemmOp::kTranspose}) {
+      for (const std::size_t m : {1UL, 7UL, 133UL}) {
+        for (const std::size_t n : {1UL, 9UL, 1030UL}) {
+          for (const std::size_t k : {0UL, 5UL, 300UL}) {
+            for (const double beta : {0.0, 1.0, -0.5}) {
+              Check(op_a, op_b, m, n, k, beta);
+            }
+          }
+        }
+      }
+    }
+  }
+}